@@ -0,0 +1,1249 @@
+#include "define.h"
+#include "platform/platform.h"
+#include "directory.h"
+#include "file_operations.h"
+#include "search.h"
+#include "content_search.h"
+#include "content_index.h"
+#include "thread_queue.h"
+#include "sync.h"
+#include "texture.h"
+#include "opengl_util.h"
+#include "random.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Headless benchmarks for the directory, search and sort code. Synthetic
+// trees are written to a temporary folder, measured and removed again. The
+// results are written as JSON to stdout or to the path given with --out.
+//
+//     FileTicBench [--out results.json] [--scale 2] [--iterations 10] [--keep]
+
+// One synthetic tree. Every folder down to depth gets folders_per_level sub
+// folders and files_per_folder files, depth 0 is a single flat folder.
+typedef struct BenchTree
+{
+    const char* name;
+    u32 depth;
+    u32 folders_per_level;
+    u32 files_per_folder;
+    u32 max_file_size;
+
+    char* path;
+    u64 folder_count;
+    u64 file_count;
+    u64 total_size;
+} BenchTree;
+
+typedef struct BenchTimer
+{
+    u32 iterations;
+    f64 total;
+    f64 min;
+    f64 max;
+} BenchTimer;
+
+typedef struct BenchOutput
+{
+    FILE* file;
+    u32 result_count;
+} BenchOutput;
+
+global const char* file_extensions[] = { "txt", "c", "h", "cpp", "java", "pdf", "obj", "md" };
+
+#define THUMBNAIL_COUNT 32
+#define THUMBNAIL_WIDTH 640
+#define THUMBNAIL_HEIGHT 480
+#define THUMBNAIL_SIZE 128
+
+#define BENCH_CORPUS_FILE_COUNT 32
+#define BENCH_CORPUS_FILE_SIZE (4 * 1024 * 1024)
+// Planted about once every BENCH_CORPUS_NEEDLE_RATE lines.
+#define BENCH_CORPUS_NEEDLE "TicNeedle"
+#define BENCH_CORPUS_NEEDLE_RATE 4096
+// Added to one file of the corpus, what the index should find without
+// scanning the others.
+#define BENCH_CORPUS_PROBE "TicIndexProbe"
+#define BENCH_INDEX_QUERY_COUNT 1000
+#define BENCH_QUAD_COUNT 200000
+#define BENCH_SMALL_FILE_COUNT 4000
+#define BENCH_SMALL_FILE_SIZE (8 * 1024)
+#define BENCH_HUGE_FILE_COUNT 4
+// At FILE_OPERATION_LARGE_FILE_SIZE, so they are copied unbuffered.
+#define BENCH_HUGE_FILE_SIZE (256ULL * 1024 * 1024)
+#define BENCH_DELETE_FOLDER_COUNT 64
+#define BENCH_DELETE_FILES_PER_FOLDER 500
+#define BENCH_SYNC_LOCK_COUNT 1000000
+#define BENCH_SYNC_TASK_COUNT 50000
+
+internal void bench_timer_add(BenchTimer* timer, f64 seconds)
+{
+    const f64 ms = seconds * 1000.0;
+    if (!timer->iterations)
+    {
+        timer->min = ms;
+        timer->max = ms;
+    }
+    timer->min = ftic_min(timer->min, ms);
+    timer->max = ftic_max(timer->max, ms);
+    timer->total += ms;
+    timer->iterations++;
+}
+
+internal void bench_output_result(BenchOutput* output, const char* name, const char* tree,
+                                  const BenchTimer* timer, u64 items)
+{
+    const f64 mean = timer->iterations ? timer->total / timer->iterations : 0.0;
+    const f64 items_per_second = mean > 0.0 ? (f64)items / (mean / 1000.0) : 0.0;
+    fprintf(output->file,
+            "%s\n    { \"name\": \"%s\", \"tree\": \"%s\", \"iterations\": %u, \"items\": %llu, "
+            "\"min_ms\": %.4f, \"mean_ms\": %.4f, \"max_ms\": %.4f, \"items_per_second\": %.1f }",
+            output->result_count++ ? "," : "", name, tree, timer->iterations,
+            (unsigned long long)items, timer->min, mean, timer->max, items_per_second);
+    fprintf(stderr, "  %-28s %-14s %9.3f ms (min %.3f)\n", name, tree, mean, timer->min);
+}
+
+//////////////// Tree generation ////////////////////
+
+internal void bench_write_file(const char* path, u32 size, u32 seed)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return;
+    }
+    char buffer[512];
+    for (u32 i = 0; i < sizeof(buffer); ++i)
+    {
+        buffer[i] = (char)('a' + random_u32s(seed + i) % 26);
+    }
+    for (u32 written = 0; written < size;)
+    {
+        const u32 count = ftic_min(size - written, (u32)sizeof(buffer));
+        fwrite(buffer, 1, count, file);
+        written += count;
+    }
+    fclose(file);
+}
+
+// Lines of indented made up words, roughly like source code. Returns the
+// number of lines the needle was put in.
+internal u32 bench_write_text_file(const char* path, u32 size, u32 seed)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return 0;
+    }
+    u32 needles = 0;
+    char line[256];
+    for (u32 written = 0; written < size;)
+    {
+        u32 length = (random_u32s(seed++) % 4) * 4;
+        memset(line, ' ', length);
+        const u32 word_count = 2 + random_u32s(seed++) % 12;
+        for (u32 i = 0; i < word_count; ++i)
+        {
+            const u32 word_length = 2 + random_u32s(seed++) % 9;
+            for (u32 j = 0; j < word_length; ++j)
+            {
+                line[length++] = (char)('a' + random_u32s(seed++) % 26);
+            }
+            line[length++] = ' ';
+        }
+        if (random_u32s(seed++) % BENCH_CORPUS_NEEDLE_RATE == 0)
+        {
+            memcpy(line + length, BENCH_CORPUS_NEEDLE, sizeof(BENCH_CORPUS_NEEDLE) - 1);
+            length += sizeof(BENCH_CORPUS_NEEDLE) - 1;
+            needles++;
+        }
+        line[length++] = '\n';
+        fwrite(line, 1, length, file);
+        written += length;
+    }
+    fclose(file);
+    return needles;
+}
+
+internal void bench_generate_folder(BenchTree* tree, const char* path, u32 depth, u32* seed)
+{
+    platform_create_directory(path);
+    tree->folder_count++;
+
+    char child[FTIC_MAX_PATH * 4];
+    for (u32 i = 0; i < tree->files_per_folder; ++i)
+    {
+        const u32 value = random_u32s((*seed)++);
+        const char* extension = file_extensions[value % static_array_size(file_extensions)];
+        snprintf(child, sizeof(child), "%s/file_%08x_%u.%s", path, value, i, extension);
+        const u32 size = tree->max_file_size ? random_u32s(value) % tree->max_file_size : 0;
+        bench_write_file(child, size, value);
+        tree->file_count++;
+        tree->total_size += size;
+    }
+    if (depth == 0)
+    {
+        return;
+    }
+    for (u32 i = 0; i < tree->folders_per_level; ++i)
+    {
+        snprintf(child, sizeof(child), "%s/folder_%04u", path, i);
+        bench_generate_folder(tree, child, depth - 1, seed);
+    }
+}
+
+internal void bench_remove_tree(const char* path)
+{
+    PlatformFileEntryArray entries = { 0 };
+    array_create(&entries, 64);
+    platform_list_directory_entries(path, &entries);
+    for (u32 i = 0; i < entries.size; ++i)
+    {
+        PlatformFileEntry* entry = entries.data + i;
+        if (entry->directory && !entry->link)
+        {
+            bench_remove_tree(entry->path);
+        }
+        else
+        {
+            platform_delete_file(entry->path);
+        }
+        free(entry->path);
+    }
+    array_free(&entries);
+    platform_remove_directory(path);
+}
+
+// Search paths are passed as "<dir>\*" like in the application.
+internal char* bench_search_path(const char* path, u32* length)
+{
+    const u32 path_length = (u32)strlen(path);
+    char* result = string_copy(path, path_length, 2);
+    result[path_length] = '\\';
+    result[path_length + 1] = '*';
+    *length = path_length + 2;
+    return result;
+}
+
+//////////////// Thumbnails ////////////////////
+
+// Uncompressed PNG, deflate stored blocks. Decoding still goes through the
+// whole PNG path of stb_image, unfiltering and all, just not the inflate.
+internal u32 png_crc(u32 crc, const u8* data, u32 size)
+{
+    crc = ~crc;
+    for (u32 i = 0; i < size; ++i)
+    {
+        crc ^= data[i];
+        for (u32 j = 0; j < 8; ++j)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+internal void png_write_u32(FILE* file, u32 value)
+{
+    const u8 bytes[4] = { (u8)(value >> 24), (u8)(value >> 16), (u8)(value >> 8), (u8)value };
+    fwrite(bytes, 1, 4, file);
+}
+
+internal void png_write_chunk(FILE* file, const char* type, const u8* data, u32 size)
+{
+    png_write_u32(file, size);
+    fwrite(type, 1, 4, file);
+    fwrite(data, 1, size, file);
+    png_write_u32(file, png_crc(png_crc(0, (const u8*)type, 4), data, size));
+}
+
+internal void bench_write_png(const char* path, u32 width, u32 height, u32 seed)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return;
+    }
+    const u32 row_size = width * 3 + 1;
+    const u32 raw_size = row_size * height;
+    u8* raw = (u8*)malloc(raw_size);
+    for (u32 y = 0; y < height; ++y)
+    {
+        u8* row = raw + y * row_size;
+        row[0] = 0;
+        for (u32 x = 0; x < width; ++x)
+        {
+            row[1 + x * 3 + 0] = (u8)(x + seed);
+            row[1 + x * 3 + 1] = (u8)(y * 2);
+            row[1 + x * 3 + 2] = (u8)random_u32s(seed + x * height + y);
+        }
+    }
+
+    const u32 block_count = (raw_size + 0xFFFF - 1) / 0xFFFF;
+    const u32 zlib_size = 2 + raw_size + block_count * 5 + 4;
+    u8* zlib = (u8*)malloc(zlib_size);
+    u8* out = zlib;
+    *out++ = 0x78;
+    *out++ = 0x01;
+    u32 a = 1;
+    u32 b = 0;
+    for (u32 offset = 0; offset < raw_size;)
+    {
+        const u32 count = ftic_min(raw_size - offset, 0xFFFFu);
+        *out++ = offset + count == raw_size;
+        *out++ = (u8)count;
+        *out++ = (u8)(count >> 8);
+        *out++ = (u8)~count;
+        *out++ = (u8)(~count >> 8);
+        memcpy(out, raw + offset, count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            a = (a + out[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        out += count;
+        offset += count;
+    }
+    const u32 adler = (b << 16) | a;
+    *out++ = (u8)(adler >> 24);
+    *out++ = (u8)(adler >> 16);
+    *out++ = (u8)(adler >> 8);
+    *out++ = (u8)adler;
+
+    const u8 header[13] = {
+        (u8)(width >> 24), (u8)(width >> 16), (u8)(width >> 8), (u8)width,
+        (u8)(height >> 24), (u8)(height >> 16), (u8)(height >> 8), (u8)height,
+        8, 2, 0, 0, 0,
+    };
+    const u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+    png_write_chunk(file, "IHDR", header, sizeof(header));
+    png_write_chunk(file, "IDAT", zlib, zlib_size);
+    png_write_chunk(file, "IEND", NULL, 0);
+    fclose(file);
+    free(zlib);
+    free(raw);
+}
+
+//////////////// Benchmarks ////////////////////
+
+internal void bench_enumerate(BenchOutput* output, const BenchTree* tree, u32 iterations)
+{
+    u32 length = 0;
+    char* search_path = bench_search_path(tree->path, &length);
+    BenchTimer timer = { 0 };
+    u64 items = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        const f64 start = platform_get_time();
+        Directory directory = platform_get_directory(search_path, length, true);
+        bench_timer_add(&timer, platform_get_time() - start);
+        items = directory.items.size;
+        platform_reset_directory(&directory, false);
+    }
+    free(search_path);
+    bench_output_result(output, "enumerate_root", tree->name, &timer, items);
+}
+
+internal u64 bench_walk(const char* search_path, u32 length)
+{
+    Directory directory = platform_get_directory(search_path, length, true);
+    u64 items = directory.items.size;
+    for (u32 i = 0; i < directory.items.size; ++i)
+    {
+        const DirectoryItem* item = directory.items.data + i;
+        if (item->type == FOLDER_DEFAULT)
+        {
+            u32 child_length = 0;
+            char* child = bench_search_path(item->path, &child_length);
+            items += bench_walk(child, child_length);
+            free(child);
+        }
+    }
+    platform_reset_directory(&directory, false);
+    return items;
+}
+
+internal void bench_enumerate_recursive(BenchOutput* output, const BenchTree* tree,
+                                        u32 iterations)
+{
+    u32 length = 0;
+    char* search_path = bench_search_path(tree->path, &length);
+    BenchTimer timer = { 0 };
+    u64 items = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        const f64 start = platform_get_time();
+        items = bench_walk(search_path, length);
+        bench_timer_add(&timer, platform_get_time() - start);
+    }
+    free(search_path);
+    bench_output_result(output, "enumerate_recursive", tree->name, &timer, items);
+}
+
+internal void bench_sort(BenchOutput* output, const BenchTree* tree, u32 iterations)
+{
+    struct
+    {
+        const char* name;
+        SortBy sort_by;
+        u32 sort_count;
+    } modes[] = {
+        { "sort_folders_first", SORT_NONE, 0 },
+        { "sort_name", SORT_NAME, 1 },
+        { "sort_name_descending", SORT_NAME, 2 },
+        { "sort_size", SORT_SIZE, 1 },
+        { "sort_size_descending", SORT_SIZE, 2 },
+        { "sort_date", SORT_DATE, 1 },
+        { "sort_date_descending", SORT_DATE, 2 },
+    };
+
+    u32 length = 0;
+    char* search_path = bench_search_path(tree->path, &length);
+    Directory directory = platform_get_directory(search_path, length, true);
+    free(search_path);
+    const DirectoryItemArray original = directory.items;
+
+    for (u32 mode = 0; mode < static_array_size(modes); ++mode)
+    {
+        BenchTimer timer = { 0 };
+        for (u32 i = 0; i < iterations; ++i)
+        {
+            DirectoryPage page = {
+                .sort_by = modes[mode].sort_by,
+                .sort_count = modes[mode].sort_count,
+            };
+            array_create(&page.directory.items, original.size);
+            memcpy(page.directory.items.data, original.data,
+                   original.size * sizeof(original.data[0]));
+            page.directory.items.size = original.size;
+
+            const f64 start = platform_get_time();
+            directory_sort(&page);
+            bench_timer_add(&timer, platform_get_time() - start);
+            array_free(&page.directory.items);
+        }
+        bench_output_result(output, modes[mode].name, tree->name, &timer, original.size);
+    }
+    platform_reset_directory(&directory, false);
+}
+
+internal void bench_output_memory(BenchOutput* output, const char* name, u64 items, u64 bytes)
+{
+    fprintf(output->file,
+            "%s\n    { \"name\": \"%s\", \"tree\": \"synthetic\", \"items\": %llu, "
+            "\"bytes\": %llu, \"bytes_per_item\": %.1f }",
+            output->result_count++ ? "," : "", name, (unsigned long long)items,
+            (unsigned long long)bytes, items ? (f64)bytes / items : 0.0);
+    fprintf(stderr, "  %-28s %-14s %9.1f bytes per item\n", name, "synthetic",
+            items ? (f64)bytes / items : 0.0);
+}
+
+internal void bench_output_throughput(BenchOutput* output, const char* name, const char* tree,
+                                      const BenchTimer* timer, u64 bytes)
+{
+    const f64 mean = timer->iterations ? timer->total / timer->iterations : 0.0;
+    const f64 gb_per_second = mean > 0.0 ? (f64)bytes / (mean / 1000.0) / 1e9 : 0.0;
+    fprintf(output->file,
+            "%s\n    { \"name\": \"%s\", \"tree\": \"%s\", \"iterations\": %u, \"bytes\": %llu, "
+            "\"min_ms\": %.4f, \"mean_ms\": %.4f, \"max_ms\": %.4f, \"gb_per_second\": %.3f }",
+            output->result_count++ ? "," : "", name, tree, timer->iterations,
+            (unsigned long long)bytes, timer->min, mean, timer->max, gb_per_second);
+    fprintf(stderr, "  %-28s %-14s %9.3f ms %7.2f GB/s\n", name, tree, mean, gb_per_second);
+}
+
+// Copies a folder of count files through the file operation queue, into a
+// new destination every iteration.
+internal void bench_copy(BenchOutput* output, const char* root, ThreadQueue* thread_queue,
+                         const char* name, u32 count, u64 size, u32 iterations)
+{
+    char source[FTIC_MAX_PATH * 4];
+    snprintf(source, sizeof(source), "%s/%s", root, name);
+    platform_create_directory(source);
+    u8* chunk = (u8*)malloc(1024 * 1024);
+    for (u32 i = 0; i < 1024 * 1024; ++i)
+    {
+        chunk[i] = (u8)random_u32s(i);
+    }
+    for (u32 i = 0; i < count; ++i)
+    {
+        char path[FTIC_MAX_PATH * 4];
+        snprintf(path, sizeof(path), "%s/file_%u.bin", source, i);
+        FILE* file = fopen(path, "wb");
+        if (file)
+        {
+            for (u64 written = 0; written < size;)
+            {
+                const u64 to_write = ftic_min(size - written, 1024ull * 1024);
+                fwrite(chunk, 1, (size_t)to_write, file);
+                written += to_write;
+            }
+            fclose(file);
+        }
+    }
+    free(chunk);
+
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue->task_queue, &queue);
+    char* source_path = source;
+    CharPtrArray paths = { .size = 1, .capacity = 1, .data = &source_path };
+    BenchTimer timer = { 0 };
+    u32 failed = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        char destination[FTIC_MAX_PATH * 4];
+        snprintf(destination, sizeof(destination), "%s/%s_copy_%u", root, name, i);
+        platform_create_directory(destination);
+
+        const f64 start = platform_get_time();
+        FileOperation* operation = file_operation_copy(&queue, &paths, destination);
+        while (!file_operation_done(operation))
+        {
+            platform_sleep(1);
+        }
+        bench_timer_add(&timer, platform_get_time() - start);
+        failed += (u32)operation->failed_count;
+        file_operation_queue_update(&queue);
+        bench_remove_tree(destination);
+    }
+    file_operation_queue_destroy(&queue);
+    bench_remove_tree(source);
+
+    char result_name[64];
+    snprintf(result_name, sizeof(result_name), "copy_%s", name);
+    bench_output_throughput(output, result_name, "synthetic", &timer, (u64)count * size);
+    snprintf(result_name, sizeof(result_name), "copy_%s_files", name);
+    bench_output_result(output, result_name, "synthetic", &timer, count);
+    if (failed)
+    {
+        fprintf(stderr, "  %u copies failed\n", failed);
+    }
+}
+
+// Permanently deletes a tree of folder_count folders with a nested folder of
+// files_per_folder small files each.
+internal void bench_permanent_delete(BenchOutput* output, const char* root,
+                                     ThreadQueue* thread_queue, u32 folder_count,
+                                     u32 files_per_folder, u32 iterations)
+{
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue->task_queue, &queue);
+    BenchTimer timer = { 0 };
+    u32 failed = 0;
+    const u32 entry_count = folder_count * (files_per_folder + 2) + 1;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        char tree[FTIC_MAX_PATH * 4];
+        snprintf(tree, sizeof(tree), "%s/delete_%u", root, i);
+        platform_create_directory(tree);
+        for (u32 j = 0; j < folder_count; ++j)
+        {
+            char path[FTIC_MAX_PATH * 4];
+            snprintf(path, sizeof(path), "%s/folder_%u", tree, j);
+            platform_create_directory(path);
+            snprintf(path, sizeof(path), "%s/folder_%u/nested", tree, j);
+            platform_create_directory(path);
+            for (u32 k = 0; k < files_per_folder; ++k)
+            {
+                snprintf(path, sizeof(path), "%s/folder_%u/nested/file_%u.txt", tree, j, k);
+                bench_write_file(path, 64, k);
+            }
+        }
+
+        char* tree_path = tree;
+        CharPtrArray paths = { .size = 1, .capacity = 1, .data = &tree_path };
+        const f64 start = platform_get_time();
+        FileOperation* operation = file_operation_delete(&queue, &paths, true);
+        while (!file_operation_done(operation))
+        {
+            platform_sleep(1);
+        }
+        bench_timer_add(&timer, platform_get_time() - start);
+        failed += (u32)operation->failed_count;
+        file_operation_queue_update(&queue);
+        bench_remove_tree(tree);
+    }
+    file_operation_queue_destroy(&queue);
+
+    bench_output_result(output, "permanent_delete", "synthetic", &timer, entry_count);
+    if (failed)
+    {
+        fprintf(stderr, "  %u deletes failed\n", failed);
+    }
+}
+
+// The CPU half of a frame with many quads: filling the instance array that
+// is uploaded, against expanding every quad to four vertices and six indices
+// the way it was done before instancing. Nothing is drawn, the draw itself
+// needs a context.
+typedef struct BenchVertexArray
+{
+    u32 size;
+    u32 capacity;
+    Vertex* data;
+} BenchVertexArray;
+
+internal void bench_quads(BenchOutput* output, u32 quad_count, u32 iterations)
+{
+    QuadArray quads = { 0 };
+    array_create(&quads, quad_count);
+    BenchVertexArray vertices = { 0 };
+    array_create(&vertices, quad_count * 4);
+    IndexArray indices = { 0 };
+    array_create(&indices, quad_count * 6);
+
+    BenchTimer instance_timer = { 0 };
+    BenchTimer vertex_timer = { 0 };
+    u64 checksum = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        quads.size = 0;
+        f64 start = platform_get_time();
+        for (u32 j = 0; j < quad_count; ++j)
+        {
+            const V2 position = v2f((f32)(j % 1000) * 2.0f, (f32)(j / 1000) * 2.0f);
+            quad(&quads, position, v2f(16.0f, 16.0f), v4f(1.0f, 0.5f, 0.25f, 1.0f), 0.0f);
+        }
+        bench_timer_add(&instance_timer, platform_get_time() - start);
+        checksum += quads.size;
+
+        vertices.size = 0;
+        indices.size = 0;
+        start = platform_get_time();
+        for (u32 j = 0; j < quad_count; ++j)
+        {
+            const V2 position = round_v2(v2f((f32)(j % 1000) * 2.0f, (f32)(j / 1000) * 2.0f));
+            const V2 size = v2f(16.0f, 16.0f);
+            const V2 corners[4] = {
+                position,
+                v2f(position.x, position.y + size.y),
+                v2_add(position, size),
+                v2f(position.x + size.x, position.y),
+            };
+            const TextureCoordinates texture_coordinates = default_texture_coordinates();
+            for (u32 k = 0; k < 4; ++k)
+            {
+                Vertex vertex = {
+                    .color = v4f(1.0f, 0.5f, 0.25f, 1.0f),
+                    .position = corners[k],
+                    .texture_coordinates = texture_coordinates.coordinates[k],
+                    .texture_index = 0.0f,
+                };
+                array_push(&vertices, vertex);
+            }
+            const u32 first = j * 4;
+            const u32 quad_indices[6] = { first,     first + 1, first + 2,
+                                          first + 2, first + 3, first };
+            for (u32 k = 0; k < 6; ++k)
+            {
+                array_push(&indices, quad_indices[k]);
+            }
+        }
+        bench_timer_add(&vertex_timer, platform_get_time() - start);
+        checksum -= vertices.size / 4;
+    }
+    bench_output_result(output, "quads_instances", "synthetic", &instance_timer, quad_count);
+    bench_output_result(output, "quads_vertices", "synthetic", &vertex_timer, quad_count);
+    bench_output_memory(output, "quads_instance_upload", quad_count,
+                        (u64)quad_count * sizeof(QuadInstance));
+    bench_output_memory(output, "quads_vertex_upload", quad_count,
+                        (u64)quad_count * (4 * sizeof(Vertex) + 6 * sizeof(u32)));
+    if (checksum)
+    {
+        fprintf(stderr, "  quad counts disagree\n");
+    }
+
+    array_free(&quads);
+    array_free(&vertices);
+    array_free(&indices);
+}
+
+// Drains like search_page_update and frees the results right away.
+internal u64 bench_drain_results(ThreadChannel* results)
+{
+    SearchResult drained[64];
+    u64 total = 0;
+    u32 count = 0;
+    do
+    {
+        count = thread_channel_drain(results, drained, static_array_size(drained));
+        for (u32 i = 0; i < count; ++i)
+        {
+            free(drained[i].item.path);
+        }
+        total += count;
+    } while (count == static_array_size(drained));
+    return total;
+}
+
+// Same setup as search_page_search, then drains the results until every task
+// the search spawned has run. Returns the results of the last iteration.
+internal u64 bench_run_search(ThreadQueue* thread_queue, const char* tree_name, const char* path,
+                              const char* string_to_match, b8 match_contents,
+                              const ContentIndex* index, BenchTimer* timer, u32 iterations)
+{
+    ThreadChannel* results =
+        thread_channel_create(sizeof(SearchResult), SEARCH_RESULT_CHANNEL_CAPACITY, NULL);
+    b8 running_callbacks[1] = { true };
+
+    u64 found = 0;
+    long dropped = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        ThreadTaskQueue* task_queue = &thread_queue->task_queue;
+        thread_telemetry_reset(task_queue);
+
+        FindingCallbackAttribute* arguments =
+            (FindingCallbackAttribute*)calloc(1, sizeof(FindingCallbackAttribute));
+        arguments->thread_queue = task_queue;
+        arguments->results = results;
+        thread_channel_retain(results);
+        arguments->start_directory = bench_search_path(path, &arguments->start_directory_length);
+        arguments->string_to_match = string_to_match;
+        arguments->string_to_match_length = (u32)strlen(string_to_match);
+        arguments->running_callbacks = running_callbacks;
+        arguments->match_contents = match_contents;
+
+        const f64 start = platform_get_time();
+        if (!index || !indexed_content_search(index, arguments))
+        {
+            finding_callback(arguments);
+        }
+        found = 0;
+        while (ftic_atomic_load(&task_queue->telemetry.completed) !=
+               ftic_atomic_load(&task_queue->telemetry.pushed))
+        {
+            found += bench_drain_results(results);
+            platform_sleep(0);
+        }
+        found += bench_drain_results(results);
+        bench_timer_add(timer, platform_get_time() - start);
+
+        dropped += task_queue->telemetry.dropped;
+    }
+    if (dropped)
+    {
+        fprintf(stderr, "  search on %s dropped %ld tasks, the queue is too small\n", tree_name,
+                dropped);
+    }
+    thread_channel_release(results);
+    return found;
+}
+
+internal void bench_search(BenchOutput* output, const BenchTree* tree, ThreadQueue* thread_queue,
+                           u32 iterations)
+{
+    BenchTimer timer = { 0 };
+    const u64 found =
+        bench_run_search(thread_queue, tree->name, tree->path, "a1", false, NULL, &timer,
+                         iterations);
+    bench_output_result(output, "search", tree->name, &timer, found);
+}
+
+// Byte by byte, what the name search does, to compare the matcher against.
+internal u64 bench_naive_count(const u8* data, u64 size, const char* pattern, u32 length)
+{
+    u64 count = 0;
+    for (u64 i = 0; i + length <= size; ++i)
+    {
+        u32 j = 0;
+        while (j < length && tolower(data[i + j]) == tolower((u8)pattern[j]))
+        {
+            ++j;
+        }
+        count += j == length;
+    }
+    return count;
+}
+
+internal b8 bench_count_hit(u32 line, const char* text, u32 text_length, void* data)
+{
+    (*(u64*)data)++;
+    return true;
+}
+
+// One file scanned on one thread, naive and with the matcher, then the whole
+// corpus through the content search on the pool. The corpus was just
+// written, so it is read from the page cache.
+internal void bench_content_search(BenchOutput* output, const char* root,
+                                   ThreadQueue* thread_queue, u32 scale, u32 iterations)
+{
+    char folder[FTIC_MAX_PATH * 4];
+    char path[FTIC_MAX_PATH * 4];
+    snprintf(folder, sizeof(folder), "%s/corpus", root);
+    platform_create_directory(folder);
+    const u32 file_size = BENCH_CORPUS_FILE_SIZE * scale;
+    u32 needles = 0;
+    for (u32 i = 0; i < BENCH_CORPUS_FILE_COUNT; ++i)
+    {
+        snprintf(path, sizeof(path), "%s/text_%02u.c", folder, i);
+        needles += bench_write_text_file(path, file_size, i * 7919);
+    }
+    const u32 needle_length = sizeof(BENCH_CORPUS_NEEDLE) - 1;
+
+    snprintf(path, sizeof(path), "%s/text_00.c", folder);
+    PlatformFileMapping mapping = { 0 };
+    platform_map_file(path, &mapping);
+    ContentMatcher matcher = { 0 };
+    content_matcher_create(BENCH_CORPUS_NEEDLE, needle_length, &matcher);
+    BenchTimer naive_timer = { 0 };
+    BenchTimer matcher_timer = { 0 };
+    u64 naive_count = 0;
+    u64 matcher_count = 0;
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        f64 start = platform_get_time();
+        naive_count = bench_naive_count(mapping.data, mapping.size, BENCH_CORPUS_NEEDLE,
+                                        needle_length);
+        bench_timer_add(&naive_timer, platform_get_time() - start);
+
+        start = platform_get_time();
+        matcher_count = 0;
+        content_search_buffer(&matcher, mapping.data, mapping.size, bench_count_hit,
+                              &matcher_count);
+        bench_timer_add(&matcher_timer, platform_get_time() - start);
+    }
+    if (naive_count != matcher_count)
+    {
+        fprintf(stderr, "  content scan found %llu lines, the naive scan %llu\n",
+                (unsigned long long)matcher_count, (unsigned long long)naive_count);
+    }
+    bench_output_throughput(output, "content_scan_naive", "corpus", &naive_timer, mapping.size);
+    bench_output_throughput(output, "content_scan", "corpus", &matcher_timer, mapping.size);
+    platform_unmap_file(&mapping);
+
+    BenchTimer search_timer = { 0 };
+    const u64 found = bench_run_search(thread_queue, "corpus", folder, BENCH_CORPUS_NEEDLE, true,
+                                       NULL, &search_timer, iterations);
+    if (found != needles)
+    {
+        fprintf(stderr, "  content search found %llu lines, %u were planted\n",
+                (unsigned long long)found, needles);
+    }
+    bench_output_throughput(output, "content_search", "corpus", &search_timer,
+                            (u64)file_size * BENCH_CORPUS_FILE_COUNT);
+}
+
+// Indexes the content search corpus, then adds a line to one file and
+// updates the index, which only reads that file again. A search for the
+// added line is timed with and without the index.
+internal void bench_content_index(BenchOutput* output, const char* root,
+                                  ThreadQueue* thread_queue, u32 iterations)
+{
+    char folder[FTIC_MAX_PATH * 4];
+    char path[FTIC_MAX_PATH * 4];
+    char index_path[FTIC_MAX_PATH * 4];
+    char next_index_path[FTIC_MAX_PATH * 4];
+    snprintf(folder, sizeof(folder), "%s/corpus", root);
+    snprintf(index_path, sizeof(index_path), "%s/corpus.index", root);
+    snprintf(next_index_path, sizeof(next_index_path), "%s/corpus_next.index", root);
+
+    FTicAtomic stop = 0;
+    ContentIndexBuildStats stats = { 0 };
+    BenchTimer build_timer = { 0 };
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        const f64 start = platform_get_time();
+        content_index_build(folder, NULL, index_path, &stop, &stats);
+        bench_timer_add(&build_timer, platform_get_time() - start);
+    }
+    bench_output_throughput(output, "content_index_build", "corpus", &build_timer,
+                            stats.bytes_read);
+    ContentIndex index = { 0 };
+    if (!content_index_open(index_path, &index))
+    {
+        fprintf(stderr, "  content index could not be built\n");
+        return;
+    }
+    bench_output_memory(output, "content_index_size", index.header->file_count,
+                        index.mapping.size);
+
+    snprintf(path, sizeof(path), "%s/text_07.c", folder);
+    FILE* file = fopen(path, "ab");
+    if (file)
+    {
+        fprintf(file, "const char* probe = \"%s\";\n", BENCH_CORPUS_PROBE);
+        fclose(file);
+    }
+    BenchTimer update_timer = { 0 };
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        const f64 start = platform_get_time();
+        content_index_build(folder, &index, next_index_path, &stop, &stats);
+        bench_timer_add(&update_timer, platform_get_time() - start);
+    }
+    bench_output_result(output, "content_index_update", "corpus", &update_timer,
+                        stats.files_read);
+    content_index_close(&index);
+    content_index_open(next_index_path, &index);
+
+    const u32 probe_length = sizeof(BENCH_CORPUS_PROBE) - 1;
+    U32Array candidates = { 0 };
+    array_create(&candidates, 16);
+    BenchTimer query_timer = { 0 };
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        const f64 start = platform_get_time();
+        for (u32 j = 0; j < BENCH_INDEX_QUERY_COUNT; ++j)
+        {
+            candidates.size = 0;
+            content_index_query(&index, folder, BENCH_CORPUS_PROBE, probe_length, &candidates);
+        }
+        bench_timer_add(&query_timer,
+                        (platform_get_time() - start) / BENCH_INDEX_QUERY_COUNT);
+    }
+    bench_output_result(output, "content_index_query", "corpus", &query_timer, candidates.size);
+    array_free(&candidates);
+
+    BenchTimer scan_timer = { 0 };
+    BenchTimer indexed_timer = { 0 };
+    const u64 scanned = bench_run_search(thread_queue, "corpus", folder, BENCH_CORPUS_PROBE, true,
+                                         NULL, &scan_timer, iterations);
+    const u64 found = bench_run_search(thread_queue, "corpus", folder, BENCH_CORPUS_PROBE, true,
+                                       &index, &indexed_timer, iterations);
+    if (found != 1 || scanned != 1)
+    {
+        fprintf(stderr, "  probe found %llu times with the index, %llu without\n",
+                (unsigned long long)found, (unsigned long long)scanned);
+    }
+    bench_output_result(output, "content_search_probe", "corpus", &scan_timer, scanned);
+    bench_output_result(output, "content_index_search", "corpus", &indexed_timer, found);
+
+    content_index_close(&index);
+    platform_delete_file(index_path);
+    platform_delete_file(next_index_path);
+}
+
+// The task queue used to lock with a semaphore, kept here to compare against.
+typedef struct BenchLock
+{
+    FTicSemaphore semaphore;
+    SyncMutex mutex;
+    b8 use_mutex;
+    u32 count;
+    u64 counter;
+} BenchLock;
+
+internal thread_return_value bench_lock_thread(void* data)
+{
+    BenchLock* lock = (BenchLock*)data;
+    for (u32 i = 0; i < lock->count; ++i)
+    {
+        if (lock->use_mutex)
+        {
+            sync_mutex_lock(&lock->mutex);
+            lock->counter++;
+            sync_mutex_unlock(&lock->mutex);
+        }
+        else
+        {
+            platform_semaphore_wait_and_decrement(&lock->semaphore);
+            lock->counter++;
+            platform_semaphore_increment(&lock->semaphore, NULL);
+        }
+    }
+    return 0;
+}
+
+internal THREAD_TASK_ENTRY_POINT(bench_empty_task)
+{
+}
+
+internal void bench_wait_for_tasks(ThreadTaskQueue* task_queue)
+{
+    while (ftic_atomic_load(&task_queue->telemetry.completed) !=
+           ftic_atomic_load(&task_queue->telemetry.pushed))
+    {
+        platform_sleep(0);
+    }
+}
+
+// Lock and unlock pairs alone and with every worker fighting over one lock,
+// then tasks through the pool one push at a time and in one batch.
+internal void bench_sync(BenchOutput* output, ThreadQueue* thread_queue, u32 iterations)
+{
+    const u32 thread_count = thread_queue->pool_size;
+    const char* names[2][2] = {
+        { "lock_semaphore", "lock_semaphore_contended" },
+        { "lock_sync_mutex", "lock_sync_mutex_contended" },
+    };
+    FTicThreadHandle* threads = (FTicThreadHandle*)calloc(thread_count, sizeof(FTicThreadHandle));
+    for (u32 mode = 0; mode < 2; ++mode)
+    {
+        BenchLock lock = {
+            .semaphore = platform_semaphore_create(1, 1),
+            .use_mutex = mode == 1,
+            .count = BENCH_SYNC_LOCK_COUNT,
+        };
+        BenchTimer uncontended_timer = { 0 };
+        for (u32 i = 0; i < iterations; ++i)
+        {
+            const f64 start = platform_get_time();
+            bench_lock_thread(&lock);
+            bench_timer_add(&uncontended_timer, platform_get_time() - start);
+        }
+
+        lock.count = BENCH_SYNC_LOCK_COUNT / thread_count;
+        BenchTimer contended_timer = { 0 };
+        for (u32 i = 0; i < iterations; ++i)
+        {
+            const f64 start = platform_get_time();
+            for (u32 j = 0; j < thread_count; ++j)
+            {
+                threads[j] = platform_thread_create(&lock, bench_lock_thread, 0, NULL);
+            }
+            for (u32 j = 0; j < thread_count; ++j)
+            {
+                platform_thread_join(threads[j]);
+                platform_thread_close(threads[j]);
+            }
+            bench_timer_add(&contended_timer, platform_get_time() - start);
+        }
+        if (lock.counter != (u64)iterations * (BENCH_SYNC_LOCK_COUNT + lock.count * thread_count))
+        {
+            fprintf(stderr, "  %s lost increments\n", names[mode][1]);
+        }
+        platform_semaphore_destroy(&lock.semaphore);
+        bench_output_result(output, names[mode][0], "synthetic", &uncontended_timer,
+                            BENCH_SYNC_LOCK_COUNT);
+        bench_output_result(output, names[mode][1], "synthetic", &contended_timer,
+                            (u64)lock.count * thread_count);
+    }
+    free(threads);
+
+    ThreadTaskQueue* task_queue = &thread_queue->task_queue;
+    const u32 task_count = ftic_min((u32)BENCH_SYNC_TASK_COUNT, task_queue->capacity);
+    ThreadTask* tasks = (ThreadTask*)calloc(task_count, sizeof(ThreadTask));
+    for (u32 i = 0; i < task_count; ++i)
+    {
+        tasks[i] = thread_task(bench_empty_task, NULL);
+    }
+    BenchTimer single_timer = { 0 };
+    BenchTimer batch_timer = { 0 };
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        thread_telemetry_reset(task_queue);
+        f64 start = platform_get_time();
+        for (u32 j = 0; j < task_count; ++j)
+        {
+            thread_tasks_push(task_queue, tasks + j, 1, NULL);
+        }
+        bench_wait_for_tasks(task_queue);
+        bench_timer_add(&single_timer, platform_get_time() - start);
+
+        start = platform_get_time();
+        thread_tasks_push(task_queue, tasks, task_count, NULL);
+        bench_wait_for_tasks(task_queue);
+        bench_timer_add(&batch_timer, platform_get_time() - start);
+    }
+    free(tasks);
+    bench_output_result(output, "queue_push_single", "synthetic", &single_timer, task_count);
+    bench_output_result(output, "queue_push_batch", "synthetic", &batch_timer, task_count);
+}
+
+internal void bench_thumbnails(BenchOutput* output, const char* root, u32 iterations)
+{
+    char paths[THUMBNAIL_COUNT][FTIC_MAX_PATH * 4];
+    char folder[FTIC_MAX_PATH * 4];
+    snprintf(folder, sizeof(folder), "%s/thumbnails", root);
+    platform_create_directory(folder);
+    for (u32 i = 0; i < THUMBNAIL_COUNT; ++i)
+    {
+        snprintf(paths[i], sizeof(paths[i]), "%s/image_%02u.png", folder, i);
+        bench_write_png(paths[i], THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT, i * 7919);
+    }
+
+    BenchTimer decode_timer = { 0 };
+    BenchTimer resize_timer = { 0 };
+    for (u32 i = 0; i < iterations; ++i)
+    {
+        f64 decode = 0.0;
+        f64 resize = 0.0;
+        for (u32 j = 0; j < THUMBNAIL_COUNT; ++j)
+        {
+            TextureProperties texture_properties = { 0 };
+            const f64 start = platform_get_time();
+            texture_load_full_path(paths[j], &texture_properties);
+            const f64 decoded = platform_get_time();
+            if (texture_properties.bytes)
+            {
+                texture_resize(&texture_properties, THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+            }
+            resize += platform_get_time() - decoded;
+            decode += decoded - start;
+            free(texture_properties.bytes);
+        }
+        bench_timer_add(&decode_timer, decode);
+        bench_timer_add(&resize_timer, resize);
+    }
+    bench_output_result(output, "thumbnail_decode", "thumbnails", &decode_timer, THUMBNAIL_COUNT);
+    bench_output_result(output, "thumbnail_resize", "thumbnails", &resize_timer, THUMBNAIL_COUNT);
+}
+
+internal char* bench_create_root(void)
+{
+    const char* temp = getenv("TMPDIR");
+#ifndef LINUX
+    if (!temp) temp = getenv("TEMP");
+#endif
+    if (!temp) temp = "/tmp";
+
+    char path[FTIC_MAX_PATH * 4];
+    for (u32 attempt = 0;; ++attempt)
+    {
+        const u32 value = random_u32s((u32)(platform_get_time() * 1000.0) + attempt);
+        snprintf(path, sizeof(path), "%s/filetic_bench_%08x", temp, value);
+        if (!platform_path_exists(path) && platform_create_directory(path))
+        {
+            break;
+        }
+        if (attempt == 16)
+        {
+            return NULL;
+        }
+    }
+    return string_copy(path, (u32)strlen(path), 0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* output_path = NULL;
+    u32 scale = 1;
+    u32 iterations = 5;
+    b8 keep = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--out") && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--scale") && i + 1 < argc)
+        {
+            const int value = atoi(argv[++i]);
+            scale = value > 0 ? (u32)value : 1;
+        }
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+        {
+            const int value = atoi(argv[++i]);
+            iterations = value > 0 ? (u32)value : 1;
+        }
+        else if (!strcmp(argv[i], "--keep"))
+        {
+            keep = true;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "Usage: %s [--out results.json] [--scale n] [--iterations n] [--keep]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    platform_set_executable_directory();
+    char* root = bench_create_root();
+    if (!root)
+    {
+        fprintf(stderr, "Failed to create a temporary folder\n");
+        return 1;
+    }
+
+    BenchTree trees[] = {
+        { .name = "deep", .depth = 64, .folders_per_level = 1, .files_per_folder = 8 * scale,
+          .max_file_size = 4096 },
+        { .name = "wide", .depth = 1, .folders_per_level = 2000 * scale, .files_per_folder = 4,
+          .max_file_size = 4096 },
+        { .name = "many_small", .depth = 2, .folders_per_level = 16, .files_per_folder = 64 * scale,
+          .max_file_size = 256 },
+        { .name = "huge_folder", .depth = 0, .files_per_folder = 50000 * scale,
+          .max_file_size = 64 },
+    };
+
+    fprintf(stderr, "Generating trees in %s\n", root);
+    const f64 generate_start = platform_get_time();
+    for (u32 i = 0; i < static_array_size(trees); ++i)
+    {
+        char path[FTIC_MAX_PATH * 4];
+        snprintf(path, sizeof(path), "%s/%s", root, trees[i].name);
+        trees[i].path = string_copy(path, (u32)strlen(path), 0);
+        u32 seed = i * 1000003;
+        bench_generate_folder(trees + i, trees[i].path, trees[i].depth, &seed);
+    }
+    fprintf(stderr, "Generated in %.2f s\n", platform_get_time() - generate_start);
+
+    BenchOutput output = { .file = stdout };
+    if (output_path)
+    {
+        output.file = fopen(output_path, "wb");
+        if (!output.file)
+        {
+            fprintf(stderr, "Failed to open %s\n", output_path);
+            return 1;
+        }
+    }
+
+    const u32 thread_count = ftic_max(platform_get_core_count() - 1, 1u);
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(100000, thread_count, &thread_queue);
+
+    fprintf(output.file, "{\n  \"cores\": %u,\n  \"threads\": %u,\n  \"scale\": %u,\n",
+            platform_get_core_count(), thread_count, scale);
+    fprintf(output.file, "  \"trees\": [");
+    for (u32 i = 0; i < static_array_size(trees); ++i)
+    {
+        fprintf(output.file,
+                "%s\n    { \"name\": \"%s\", \"folders\": %llu, \"files\": %llu, \"bytes\": %llu }",
+                i ? "," : "", trees[i].name, (unsigned long long)trees[i].folder_count,
+                (unsigned long long)trees[i].file_count, (unsigned long long)trees[i].total_size);
+    }
+    fprintf(output.file, "\n  ],\n  \"results\": [");
+
+    for (u32 i = 0; i < static_array_size(trees); ++i)
+    {
+        fprintf(stderr, "%s: %llu folders, %llu files\n", trees[i].name,
+                (unsigned long long)trees[i].folder_count, (unsigned long long)trees[i].file_count);
+        bench_enumerate(&output, trees + i, iterations);
+        bench_enumerate_recursive(&output, trees + i, iterations);
+        bench_search(&output, trees + i, &thread_queue, iterations);
+    }
+    fprintf(stderr, "sort:\n");
+    bench_sort(&output, trees + 3, iterations);
+    fprintf(stderr, "file operations:\n");
+    bench_copy(&output, root, &thread_queue, "many_small_files",
+               BENCH_SMALL_FILE_COUNT * scale, BENCH_SMALL_FILE_SIZE, iterations);
+    // Writing these dominates the run, they are copied fewer times.
+    bench_copy(&output, root, &thread_queue, "few_huge_files", BENCH_HUGE_FILE_COUNT,
+               BENCH_HUGE_FILE_SIZE, ftic_min(iterations, 2u));
+    bench_permanent_delete(&output, root, &thread_queue, BENCH_DELETE_FOLDER_COUNT * scale,
+                           BENCH_DELETE_FILES_PER_FOLDER, iterations);
+    fprintf(stderr, "quads:\n");
+    bench_quads(&output, BENCH_QUAD_COUNT * scale, iterations);
+    fprintf(stderr, "content search:\n");
+    bench_content_search(&output, root, &thread_queue, scale, iterations);
+    fprintf(stderr, "content index:\n");
+    bench_content_index(&output, root, &thread_queue, iterations);
+    fprintf(stderr, "sync:\n");
+    bench_sync(&output, &thread_queue, iterations);
+    fprintf(stderr, "thumbnails:\n");
+    bench_thumbnails(&output, root, iterations);
+
+    fprintf(output.file, "\n  ]\n}\n");
+    if (output.file != stdout)
+    {
+        fclose(output.file);
+    }
+
+    threads_uninitialize(&thread_queue);
+    if (!keep)
+    {
+        bench_remove_tree(root);
+    }
+    for (u32 i = 0; i < static_array_size(trees); ++i)
+    {
+        free(trees[i].path);
+    }
+    free(root);
+    return 0;
+}
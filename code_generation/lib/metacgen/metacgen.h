@@ -59,6 +59,13 @@ void mcgen_generate_code(Mcgen_Context* const ctx);
 
 #define mcgen_calloc(type, count) (type*)calloc(count, sizeof(type))
 
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
 #define KILOBYTE(n) ((n) * 1024ULL)
 #define MEGABYTE(n) (KILOBYTE((n)) * 1024ULL)
 #define GIGABYTE(n) (MEGABYTE((n)) * 1024ULL)
@@ -491,6 +498,30 @@ internal File_Attrib file_read(const char* const file_path)
         exit(1);
     }
     fclose(file);
+
+    // The parser expects \r\n line endings, files checked out with \n only
+    // are widened here.
+    if (!memchr(file_attrib.buffer, '\r', file_attrib.size))
+    {
+        u32 line_count = 0;
+        for (u32 i = 0; i < file_attrib.size; ++i)
+        {
+            line_count += file_attrib.buffer[i] == '\n';
+        }
+        char* widened = mcgen_calloc(char, file_attrib.size + line_count);
+        u32 size = 0;
+        for (u32 i = 0; i < file_attrib.size; ++i)
+        {
+            if (file_attrib.buffer[i] == '\n')
+            {
+                widened[size++] = '\r';
+            }
+            widened[size++] = file_attrib.buffer[i];
+        }
+        free(file_attrib.buffer);
+        file_attrib.buffer = widened;
+        file_attrib.size = size;
+    }
     return file_attrib;
 }
 
@@ -505,7 +536,35 @@ internal void file_write(const char* const file_path, const char* const content,
         exit(1);
     }
 
-    fwrite(content, 1, (size_t)size, file);
+    // Blanks are only written once something follows them on the line, the
+    // expansion leaves them at the end of most lines otherwise.
+    u32 blanks_start = 0;
+    u32 blank_count = 0;
+    for (u32 i = 0; i < size; ++i)
+    {
+        const char character = content[i];
+#ifndef _WIN32
+        if (character == '\r') continue;
+#endif
+        if (character == ' ' || character == '\t')
+        {
+            if (blank_count++ == 0) blanks_start = i;
+            continue;
+        }
+        if (character != '\n' && character != '\r')
+        {
+            for (u32 j = blanks_start; blank_count; ++j)
+            {
+                if (content[j] == ' ' || content[j] == '\t')
+                {
+                    fputc(content[j], file);
+                    --blank_count;
+                }
+            }
+        }
+        blank_count = 0;
+        fputc(character, file);
+    }
     fclose(file);
 }
 
@@ -1026,7 +1085,8 @@ internal u32 parse_first_token(Hash_Table_Cc* const struct_definition_table,
                                              true);
                 }
             }
-            char* name_of_struct = mcgen_calloc(char, size_of_name);
+            char* name_of_struct =
+                mcgen_calloc(char, size_of_name + NULL_TERMINATOR);
 
             for (u32 i = offset_next, j = 0,
                      iterations = offset_next + size_of_name;
@@ -1701,10 +1761,10 @@ void mcgen_change_working_directory(Mcgen_Context* const ctx,
         ctx_internal->working_directory_len = working_directory_len;
         const char last_char =
             ctx_internal->working_directory[working_directory_len - 1];
-        if (last_char != '\\' || last_char != '/')
+        if (last_char != '\\' && last_char != '/')
         {
-            // TODO: find what is being used
-            ctx_internal->working_directory[working_directory_len] = '\\';
+            // Forward slashes work for both fopen on Windows and Linux.
+            ctx_internal->working_directory[ctx_internal->working_directory_len++] = '/';
         }
     }
     else
@@ -1847,11 +1907,11 @@ void mcgen_link_name_(Mcgen_Context* const ctx, const char* const name,
     Mcgen_Context_Internal* const ctx_internal =
         (Mcgen_Context_Internal* const)ctx;
 
+    Array_Char_Ptr array0;
     Array_Char_Ptr* array =
         hash_table_get_cap(&ctx_internal->linked_names, name);
     if (!array)
     {
-        Array_Char_Ptr array0;
         array_create(&array0, name_count);
         array = &array0;
     }
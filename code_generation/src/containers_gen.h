@@ -0,0 +1,332 @@
+#pragma once
+#include "define.h"
+
+// Vector that keeps its first N elements inside the struct and only goes to
+// the heap when it grows past them. There is no pointer into the struct
+// itself, so a vector still on inline storage can be copied by value.
+template <T, N>
+struct SmallVector
+{
+    u32 size;
+    u32 capacity;
+    T* heap;
+    T inline_data[N];
+};
+
+template <T, N>
+void small_vector_init(SmallVector<T, N>* vector)
+{
+    vector->size = 0;
+    vector->capacity = N;
+    vector->heap = NULL;
+}
+
+template <T, N>
+T* small_vector_data(SmallVector<T, N>* vector)
+{
+    return vector->heap ? vector->heap : vector->inline_data;
+}
+
+template <T, N>
+void small_vector_push(SmallVector<T, N>* vector, T value)
+{
+    if (vector->size == vector->capacity)
+    {
+        const u32 capacity = vector->capacity * 2;
+        if (vector->heap)
+        {
+            vector->heap = (T*)realloc(vector->heap, capacity * sizeof(T));
+        }
+        else
+        {
+            vector->heap = (T*)malloc(capacity * sizeof(T));
+            memcpy(vector->heap, vector->inline_data, vector->size * sizeof(T));
+        }
+        vector->capacity = capacity;
+    }
+    T* data = vector->heap ? vector->heap : vector->inline_data;
+    data[vector->size++] = value;
+}
+
+template <T, N>
+void small_vector_free(SmallVector<T, N>* vector)
+{
+    free(vector->heap);
+    vector->heap = NULL;
+    vector->size = 0;
+    vector->capacity = N;
+}
+
+// Fixed capacity FIFO. head and tail run freely and are masked on access,
+// so the full capacity is usable and size is tail - head.
+template <T>
+struct RingBuffer
+{
+    T* data;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+};
+
+template <T>
+RingBuffer<T> ring_buffer_create(u32 capacity)
+{
+    capacity = ftic_max(round_up_power_of_two(capacity), 2);
+    RingBuffer<T> out = {
+        .data = (T*)calloc(capacity, sizeof(T)),
+        .capacity = capacity,
+    };
+    return out;
+}
+
+template <T>
+b8 ring_buffer_push(RingBuffer<T>* ring, T value)
+{
+    if (ring->tail - ring->head == ring->capacity)
+    {
+        return false;
+    }
+    ring->data[ring->tail++ & (ring->capacity - 1)] = value;
+    return true;
+}
+
+template <T>
+b8 ring_buffer_pop(RingBuffer<T>* ring, T* value)
+{
+    if (ring->tail == ring->head)
+    {
+        return false;
+    }
+    *value = ring->data[ring->head++ & (ring->capacity - 1)];
+    return true;
+}
+
+template <T>
+u32 ring_buffer_size(RingBuffer<T>* ring)
+{
+    return ring->tail - ring->head;
+}
+
+template <T>
+void ring_buffer_free(RingBuffer<T>* ring)
+{
+    free(ring->data);
+    ring->data = NULL;
+    ring->capacity = 0;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+// Doubly linked list whose nodes come from one growing array with a free
+// list. Links are indices, so handles stay valid when the pool grows.
+template <T>
+struct PoolListNode
+{
+    T value;
+    u32 next;
+    u32 prev;
+};
+
+template <T>
+struct PoolList
+{
+    PoolListNode<T>* nodes;
+    u32 size;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+    u32 free_head;
+};
+
+template <T>
+PoolList<T> pool_list_create(u32 capacity)
+{
+    capacity = ftic_max(capacity, 16);
+    PoolList<T> out = {
+        .nodes = (PoolListNode<T>*)calloc(capacity, sizeof(PoolListNode<T>)),
+        .capacity = capacity,
+        .head = POOL_LIST_NONE,
+        .tail = POOL_LIST_NONE,
+        .free_head = 0,
+    };
+    for (u32 i = 0; i < capacity; ++i)
+    {
+        out.nodes[i].next = i + 1 < capacity ? i + 1 : POOL_LIST_NONE;
+    }
+    return out;
+}
+
+template <T>
+u32 pool_list_push_back(PoolList<T>* list, T value)
+{
+    if (list->free_head == POOL_LIST_NONE)
+    {
+        const u32 old_capacity = list->capacity;
+        list->capacity *= 2;
+        list->nodes =
+            (PoolListNode<T>*)realloc(list->nodes, list->capacity * sizeof(PoolListNode<T>));
+        for (u32 i = old_capacity; i < list->capacity; ++i)
+        {
+            list->nodes[i].next = i + 1 < list->capacity ? i + 1 : POOL_LIST_NONE;
+        }
+        list->free_head = old_capacity;
+    }
+    const u32 handle = list->free_head;
+    PoolListNode<T>* node = list->nodes + handle;
+    list->free_head = node->next;
+
+    node->value = value;
+    node->next = POOL_LIST_NONE;
+    node->prev = list->tail;
+    if (list->tail != POOL_LIST_NONE)
+    {
+        list->nodes[list->tail].next = handle;
+    }
+    else
+    {
+        list->head = handle;
+    }
+    list->tail = handle;
+    list->size++;
+    return handle;
+}
+
+template <T>
+void pool_list_remove(PoolList<T>* list, u32 handle)
+{
+    PoolListNode<T>* node = list->nodes + handle;
+    if (node->prev != POOL_LIST_NONE)
+    {
+        list->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        list->head = node->next;
+    }
+    if (node->next != POOL_LIST_NONE)
+    {
+        list->nodes[node->next].prev = node->prev;
+    }
+    else
+    {
+        list->tail = node->prev;
+    }
+    node->next = list->free_head;
+    list->free_head = handle;
+    list->size--;
+}
+
+template <T>
+void pool_list_free(PoolList<T>* list)
+{
+    free(list->nodes);
+    list->nodes = NULL;
+    list->size = 0;
+    list->capacity = 0;
+    list->head = POOL_LIST_NONE;
+    list->tail = POOL_LIST_NONE;
+    list->free_head = POOL_LIST_NONE;
+}
+
+// Map kept sorted by key in two parallel arrays, the binary search only
+// touches keys. Best for small maps that are read far more than written.
+template <Key, Value>
+struct FlatMap
+{
+    Key* keys;
+    Value* values;
+    u32 size;
+    u32 capacity;
+};
+
+template <Key, Value>
+FlatMap<Key, Value> flat_map_create(u32 capacity)
+{
+    capacity = ftic_max(capacity, 16);
+    FlatMap<Key, Value> out = {
+        .keys = (Key*)calloc(capacity, sizeof(Key)),
+        .values = (Value*)calloc(capacity, sizeof(Value)),
+        .capacity = capacity,
+    };
+    return out;
+}
+
+template <Key, Value, Cmp>
+u32 flat_map_lower_bound(FlatMap<Key, Value>* map, const Key key)
+{
+    u32 low = 0;
+    u32 high = map->size;
+    while (low < high)
+    {
+        const u32 middle = low + ((high - low) >> 1);
+        if (Cmp(map->keys[middle], key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+template <Key, Value, Cmp>
+void flat_map_insert(FlatMap<Key, Value>* map, Key key, Value value)
+{
+    const u32 index = flat_map_lower_bound<Key, Value, Cmp>(map, key);
+    if (index < map->size && Cmp(map->keys[index], key) == 0)
+    {
+        map->values[index] = value;
+        return;
+    }
+    if (map->size == map->capacity)
+    {
+        map->capacity *= 2;
+        map->keys = (Key*)realloc(map->keys, map->capacity * sizeof(Key));
+        map->values = (Value*)realloc(map->values, map->capacity * sizeof(Value));
+    }
+    const u32 to_move = map->size - index;
+    memmove(map->keys + index + 1, map->keys + index, to_move * sizeof(Key));
+    memmove(map->values + index + 1, map->values + index, to_move * sizeof(Value));
+    map->keys[index] = key;
+    map->values[index] = value;
+    map->size++;
+}
+
+template <Key, Value, Cmp>
+Value* flat_map_get(FlatMap<Key, Value>* map, const Key key)
+{
+    const u32 index = flat_map_lower_bound<Key, Value, Cmp>(map, key);
+    if (index < map->size && Cmp(map->keys[index], key) == 0)
+    {
+        return map->values + index;
+    }
+    return NULL;
+}
+
+template <Key, Value, Cmp>
+b8 flat_map_remove(FlatMap<Key, Value>* map, const Key key)
+{
+    const u32 index = flat_map_lower_bound<Key, Value, Cmp>(map, key);
+    if (index == map->size || Cmp(map->keys[index], key) != 0)
+    {
+        return false;
+    }
+    const u32 to_move = map->size - index - 1;
+    memmove(map->keys + index, map->keys + index + 1, to_move * sizeof(Key));
+    memmove(map->values + index, map->values + index + 1, to_move * sizeof(Value));
+    map->size--;
+    return true;
+}
+
+template <Key, Value>
+void flat_map_free(FlatMap<Key, Value>* map)
+{
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->size = 0;
+    map->capacity = 0;
+}
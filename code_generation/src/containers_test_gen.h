@@ -0,0 +1,294 @@
+#pragma once
+#include "define.h"
+
+// Every push after the inline storage is full goes to the heap, with what
+// was inline copied over.
+template <T, N>
+void small_vector_test()
+{
+    SmallVector<T, N> vector;
+    small_vector_init<T, N>(&vector);
+    for (u32 i = 0; i < N; ++i)
+    {
+        small_vector_push<T, N>(&vector, (T)i);
+    }
+    T* data = small_vector_data<T, N>(&vector);
+    ASSERT_TRUE(vector.heap == NULL);
+    ASSERT_TRUE(data == vector.inline_data);
+
+    small_vector_push<T, N>(&vector, (T)N);
+    data = small_vector_data<T, N>(&vector);
+    ASSERT_TRUE(vector.heap != NULL);
+    ASSERT_TRUE(data == vector.heap);
+    ASSERT_EQUALS(N * 2, vector.capacity, EQUALS_FORMAT_U32);
+    for (u32 i = N + 1; i < N * 4 + 1; ++i)
+    {
+        small_vector_push<T, N>(&vector, (T)i);
+    }
+    ASSERT_EQUALS(N * 4 + 1, vector.size, EQUALS_FORMAT_U32);
+    data = small_vector_data<T, N>(&vector);
+    b8 kept = true;
+    for (u32 i = 0; i < vector.size; ++i)
+    {
+        kept &= data[i] == (T)i;
+    }
+    ASSERT_TRUE(kept);
+
+    small_vector_free<T, N>(&vector);
+    ASSERT_TRUE(vector.heap == NULL);
+    ASSERT_EQUALS(0, vector.size, EQUALS_FORMAT_U32);
+}
+
+template <T>
+void ring_buffer_test()
+{
+    RingBuffer<T> ring = ring_buffer_create<T>(4);
+    ASSERT_EQUALS(4, ring.capacity, EQUALS_FORMAT_U32);
+    u32 pushed = 0;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        pushed += ring_buffer_push<T>(&ring, (T)i);
+    }
+    ASSERT_EQUALS(4, pushed, EQUALS_FORMAT_U32);
+    b8 result = ring_buffer_push<T>(&ring, (T)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    u32 size = ring_buffer_size<T>(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+
+    // Two out and two more in, the tail wraps to the front of the array.
+    T value;
+    b8 in_order = true;
+    for (u32 i = 0; i < 2; ++i)
+    {
+        result = ring_buffer_pop<T>(&ring, &value);
+        in_order &= result && value == (T)i;
+    }
+    pushed = ring_buffer_push<T>(&ring, (T)4);
+    pushed += ring_buffer_push<T>(&ring, (T)5);
+    ASSERT_EQUALS(2, pushed, EQUALS_FORMAT_U32);
+    result = ring_buffer_push<T>(&ring, (T)6);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    for (u32 i = 2; i < 6; ++i)
+    {
+        result = ring_buffer_pop<T>(&ring, &value);
+        in_order &= result && value == (T)i;
+    }
+    ASSERT_TRUE(in_order);
+    result = ring_buffer_pop<T>(&ring, &value);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+
+    // The free running head and tail overflow without losing the size.
+    ring.head = 0xFFFFFFFEu;
+    ring.tail = 0xFFFFFFFEu;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        ring_buffer_push<T>(&ring, (T)i);
+    }
+    size = ring_buffer_size<T>(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+    result = ring_buffer_push<T>(&ring, (T)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    in_order = true;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        result = ring_buffer_pop<T>(&ring, &value);
+        in_order &= result && value == (T)i;
+    }
+    ASSERT_TRUE(in_order);
+    size = ring_buffer_size<T>(&ring);
+    ASSERT_EQUALS(0, size, EQUALS_FORMAT_U32);
+    ring_buffer_free<T>(&ring);
+}
+
+template <T>
+void pool_list_test()
+{
+    PoolList<T> list = pool_list_create<T>(16);
+    u32 handles[5];
+    for (u32 i = 0; i < 5; ++i)
+    {
+        handles[i] = pool_list_push_back<T>(&list, (T)i);
+    }
+
+    // From the middle, then the head, then the tail. The links have to hold
+    // walking both ways.
+    pool_list_remove<T>(&list, handles[2]);
+    pool_list_remove<T>(&list, handles[0]);
+    pool_list_remove<T>(&list, handles[4]);
+    ASSERT_EQUALS(2, list.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[1], list.head, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[3], list.tail, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.nodes[list.head].prev, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[3], list.nodes[list.head].next, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[1], list.nodes[list.tail].prev, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.nodes[list.tail].next, EQUALS_FORMAT_U32);
+
+    // The last freed node is used first.
+    const u32 handle = pool_list_push_back<T>(&list, (T)5);
+    ASSERT_EQUALS(handles[4], handle, EQUALS_FORMAT_U32);
+
+    // Growing the pool keeps the handles.
+    for (u32 i = 0; i < 40; ++i)
+    {
+        pool_list_push_back<T>(&list, (T)(i + 6));
+    }
+    ASSERT_TRUE(list.capacity > 16);
+    ASSERT_TRUE(list.nodes[handles[1]].value == (T)1);
+    ASSERT_TRUE(list.nodes[handles[3]].value == (T)3);
+    ASSERT_TRUE(list.nodes[handles[4]].value == (T)5);
+    u32 count = 0;
+    for (u32 node = list.head; node != POOL_LIST_NONE; node = list.nodes[node].next)
+    {
+        ++count;
+    }
+    ASSERT_EQUALS(list.size, count, EQUALS_FORMAT_U32);
+    pool_list_free<T>(&list);
+}
+
+template <Key, Value, Cmp>
+void flat_map_test()
+{
+    FlatMap<Key, Value> map = flat_map_create<Key, Value>(16);
+    flat_map_insert<Key, Value, Cmp>(&map, (Key)5, (Value)50);
+    flat_map_insert<Key, Value, Cmp>(&map, (Key)1, (Value)10);
+    flat_map_insert<Key, Value, Cmp>(&map, (Key)3, (Value)30);
+    ASSERT_EQUALS(3, map.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(map.keys[0] == (Key)1 && map.keys[1] == (Key)3 && map.keys[2] == (Key)5);
+
+    // An existing key gets the new value, not a second entry.
+    flat_map_insert<Key, Value, Cmp>(&map, (Key)3, (Value)33);
+    ASSERT_EQUALS(3, map.size, EQUALS_FORMAT_U32);
+    Value* value = flat_map_get<Key, Value, Cmp>(&map, (Key)3);
+    ASSERT_TRUE(value && *value == (Value)33);
+
+    u32 removed = flat_map_remove<Key, Value, Cmp>(&map, (Key)3);
+    removed += flat_map_remove<Key, Value, Cmp>(&map, (Key)3);
+    removed += flat_map_remove<Key, Value, Cmp>(&map, (Key)4);
+    ASSERT_EQUALS(1, removed, EQUALS_FORMAT_U32);
+    value = flat_map_get<Key, Value, Cmp>(&map, (Key)3);
+    ASSERT_TRUE(value == NULL);
+    ASSERT_EQUALS(2, map.size, EQUALS_FORMAT_U32);
+    value = flat_map_get<Key, Value, Cmp>(&map, (Key)5);
+    ASSERT_TRUE(value && *value == (Value)50);
+
+    // First and last.
+    removed = flat_map_remove<Key, Value, Cmp>(&map, (Key)1);
+    removed += flat_map_remove<Key, Value, Cmp>(&map, (Key)5);
+    ASSERT_EQUALS(2, removed, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, map.size, EQUALS_FORMAT_U32);
+
+    // Inserted backwards past the first capacity, still sorted.
+    for (u32 i = 40; i > 0; --i)
+    {
+        flat_map_insert<Key, Value, Cmp>(&map, (Key)i, (Value)(i * 10));
+    }
+    ASSERT_EQUALS(40, map.size, EQUALS_FORMAT_U32);
+    b8 sorted = true;
+    for (u32 i = 0; i < map.size; ++i)
+    {
+        sorted &= map.keys[i] == (Key)(i + 1) && map.values[i] == (Value)((i + 1) * 10);
+    }
+    ASSERT_TRUE(sorted);
+    flat_map_free<Key, Value>(&map);
+}
+
+template <T, N>
+void small_vector_benchmark()
+{
+    u64 sum = 0;
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        SmallVector<T, N> vector;
+        small_vector_init<T, N>(&vector);
+        for (u32 i = 0; i < N; ++i)
+        {
+            small_vector_push<T, N>(&vector, (T)i);
+        }
+        T* data = small_vector_data<T, N>(&vector);
+        for (u32 i = 0; i < vector.size; ++i)
+        {
+            sum += (u64)data[i];
+        }
+        small_vector_free<T, N>(&vector);
+    }
+    containers_test_print("small vector push inline", start, CONTAINERS_TEST_ROUNDS * N);
+    ASSERT_EQUALS((u64)CONTAINERS_TEST_ROUNDS * (N * (N - 1) / 2), sum, EQUALS_FORMAT_U64);
+}
+
+template <T>
+void ring_buffer_benchmark()
+{
+    RingBuffer<T> ring = ring_buffer_create<T>(1024);
+    u64 sum = 0;
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 1024; ++i)
+        {
+            ring_buffer_push<T>(&ring, (T)i);
+        }
+        T value;
+        while (ring_buffer_pop<T>(&ring, &value))
+        {
+            sum += (u64)value;
+        }
+    }
+    containers_test_print("ring buffer push and pop", start, CONTAINERS_TEST_ROUNDS * 1024);
+    ASSERT_EQUALS((u64)CONTAINERS_TEST_ROUNDS * (1024 * 1023 / 2), sum, EQUALS_FORMAT_U64);
+    ring_buffer_free<T>(&ring);
+}
+
+template <T>
+void pool_list_benchmark()
+{
+    PoolList<T> list = pool_list_create<T>(16);
+    u32* handles = (u32*)malloc(1024 * sizeof(u32));
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 1024; ++i)
+        {
+            handles[i] = pool_list_push_back<T>(&list, (T)i);
+        }
+        for (u32 i = 0; i < 1024; i += 2)
+        {
+            pool_list_remove<T>(&list, handles[i]);
+        }
+        for (u32 i = 1; i < 1024; i += 2)
+        {
+            pool_list_remove<T>(&list, handles[i]);
+        }
+    }
+    containers_test_print("pool list push and remove", start, CONTAINERS_TEST_ROUNDS * 1024);
+    ASSERT_EQUALS(0, list.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.head, EQUALS_FORMAT_U32);
+    free(handles);
+    pool_list_free<T>(&list);
+}
+
+template <Key, Value, Cmp>
+void flat_map_benchmark()
+{
+    FlatMap<Key, Value> map = flat_map_create<Key, Value>(16);
+    const f64 start = platform_get_time();
+    for (u32 i = 0; i < 4096; ++i)
+    {
+        // Spread the keys so inserts land all over the map.
+        flat_map_insert<Key, Value, Cmp>(&map, (Key)((i * 2654435761u) & 0xFFFF), (Value)i);
+    }
+    containers_test_print("flat map insert", start, 4096);
+
+    u32 found = 0;
+    const f64 lookup_start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 256; ++i)
+        {
+            found += flat_map_get<Key, Value, Cmp>(&map, (Key)((i * 2654435761u) & 0xFFFF)) != NULL;
+        }
+    }
+    containers_test_print("flat map lookup", lookup_start, CONTAINERS_TEST_ROUNDS * 256);
+    ASSERT_EQUALS(CONTAINERS_TEST_ROUNDS * 256, found, EQUALS_FORMAT_U32);
+    flat_map_free<Key, Value>(&map);
+}
@@ -6,17 +6,23 @@ struct Cell
 {
     Key key;
     Value value;
-    bool active;
-    bool deleted;
 };
 
+// Keys and values live in cells, one control byte per cell lives in control.
+// A control byte is CONTROL_EMPTY or the low 7 bits of the key hash, and the
+// first CONTROL_GROUP_SIZE - 1 bytes are mirrored past the end so a group can
+// always be loaded with one unaligned read.
 template <Key, Value>
 struct HashTable
 {
     Cell<Key, Value>* cells;
+    u8* control;
     u32 size;
     u32 capacity;
 
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    Cell<Key, Value> removed;
+
     u64 (*hash_function)(const void* key, u32 len, u64 seed);
 };
 
@@ -26,6 +32,7 @@ HashTable<Key, Value> hash_table_create(u32 capacity, u64 (*hash_function)(const
     capacity = max(round_up_power_of_two(capacity), 32);
     HashTable<Key, Value> out = {
         .cells = (Cell<Key, Value>*)calloc(capacity, sizeof(Cell<Key, Value>)),
+        .control = control_create(capacity),
         .capacity = capacity,
         .hash_function = hash_function,
     };
@@ -33,136 +40,135 @@ HashTable<Key, Value> hash_table_create(u32 capacity, u64 (*hash_function)(const
 }
 
 template <Key, Value, Len, Cmp>
-void hash_table_insert(HashTable<Key, Value>* table, Key key, Value value)
+u32 hash_table_find(HashTable<Key, Value>* table, const Key key, const u64 hash)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index =
-        table->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
-
-    Cell<Key, Value>* cell = table->cells + hashed_index;
-    if (cell->active)
+    const u32 capacity_mask = table->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(table->cells + index);
+    for (u32 probed = 0; probed < table->capacity; probed += CONTROL_GROUP_SIZE)
     {
-        if (Cmp(cell->key, key) != 0)
+        const u8* group = table->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
         {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 1; i < table->size && cell->active; ++i)
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (Cmp(table->cells[candidate].key, key) == 0)
             {
-                if (Cmp(cell->key, key) == 0)
-                {
-                    goto add_node;
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
+                return candidate;
             }
         }
-        else
+        if (control_match_empty(group))
         {
-            goto add_node;
+            break;
         }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+    return table->capacity;
+}
+
+template <Key, Value, Len, Cmp>
+void hash_table_insert(HashTable<Key, Value>* table, Key key, Value value)
+{
+    const u64 hash = table->hash_function(&key, (u32)Len(key), HASH_SEED);
+    u32 index = hash_table_find<Key, Value, Len, Cmp>(table, key, hash);
+    if (index < table->capacity)
+    {
+        table->cells[index].value = value;
+        return;
     }
-    cell->active = true;
-    cell->deleted = false;
-    cell->key = key;
-add_node:
-    cell->value = value;
-    if (table->size++ >= (u32)(table->capacity * 0.4f))
+
+    if (table->size + 1 > control_max_load(table->capacity))
     {
-        u32 old_capacity = table->capacity;
-        Cell<Key, Value>* old_storage = table->cells;
+        const u32 old_capacity = table->capacity;
+        Cell<Key, Value>* old_cells = table->cells;
+        u8* old_control = table->control;
 
-        table->size = 0;
         table->capacity *= 2;
-        table->cells = (Cell<Key, Value>*)calloc(table->capacity,
-                                                 sizeof(Cell<Key, Value>));
+        table->cells = (Cell<Key, Value>*)calloc(table->capacity, sizeof(Cell<Key, Value>));
+        table->control = control_create(table->capacity);
 
-        for (u32 i = 0; i < old_capacity; i++)
+        const u32 capacity_mask = table->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
         {
-            cell = old_storage + i;
-            if (cell->active)
+            if (control_is_full(old_control[i]))
             {
-                hash_table_insert(table, cell->key, cell->value);
+                Cell<Key, Value>* cell = old_cells + i;
+                const u64 cell_hash =
+                    table->hash_function(&cell->key, (u32)Len(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(table->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(table->control, empty, control_tag(cell_hash), table->capacity);
+                table->cells[empty] = *cell;
             }
         }
-        free(old_storage);
+        free(old_cells);
+        free(old_control);
     }
+
+    const u32 capacity_mask = table->capacity - 1;
+    index = control_find_empty(table->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(table->control, index, control_tag(hash), table->capacity);
+    table->cells[index].key = key;
+    table->cells[index].value = value;
+    table->size++;
 }
 
 template <Key, Value, Len, Cmp>
 Value* hash_table_get(HashTable<Key, Value>* table, const Key key)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index =
-        table->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
-
-    Cell<Key, Value>* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
-    {
-        if (Cmp(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0;
-                 i < table->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (Cmp(cell->key, key) == 0)
-                    {
-                        return &cell->value;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if(cell->active)
-        {
-            return &cell->value;
-        }
-    }
-    return NULL;
+    const u64 hash = table->hash_function(&key, (u32)Len(key), HASH_SEED);
+    const u32 index = hash_table_find<Key, Value, Len, Cmp>(table, key, hash);
+    return index < table->capacity ? &table->cells[index].value : NULL;
 }
 
+// Removal shifts the following cells of the run back instead of leaving a
+// tombstone, so lookups never have to skip deleted cells.
 template <Key, Value, Len, Cmp>
 Cell<Key, Value>* hash_table_remove(HashTable<Key, Value>* table, const Key key)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index =
-        table->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
+    const u64 hash = table->hash_function(&key, (u32)Len(key), HASH_SEED);
+    u32 hole = hash_table_find<Key, Value, Len, Cmp>(table, key, hash);
+    if (hole == table->capacity)
+    {
+        return NULL;
+    }
+    table->removed = table->cells[hole];
 
-    Cell<Key, Value>* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(table->control[next]);
+         next = (next + 1) & capacity_mask)
     {
-        if (Cmp(cell->key, key) != 0)
+        Cell<Key, Value>* cell = table->cells + next;
+        const u64 cell_hash = table->hash_function(&cell->key, (u32)Len(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
         {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0;
-                 i < table->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (Cmp(cell->key, key) == 0)
-                    {
-                        cell->active = false;
-                        cell->deleted = true;
-                        table->size--;
-                        return cell;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if(cell->active)
-        {
-            cell->active = false;
-            cell->deleted = true;
-            table->size--;
-            return cell;
+            table->cells[hole] = *cell;
+            control_set(table->control, hole, table->control[next], table->capacity);
+            hole = next;
         }
     }
-    return NULL;
+    control_set(table->control, hole, CONTROL_EMPTY, table->capacity);
+    table->size--;
+    return &table->removed;
 }
 
 template <Key, Value>
 void hash_table_clear(HashTable<Key, Value>* hash_table)
 {
-    memset(hash_table->cells, 0,
-           hash_table->capacity * sizeof(hash_table->cells[0]));
+    memset(hash_table->control, CONTROL_EMPTY, hash_table->capacity + CONTROL_GROUP_SIZE - 1);
+    hash_table->size = 0;
+}
+
+template <Key, Value>
+void hash_table_free(HashTable<Key, Value>* hash_table)
+{
+    free(hash_table->cells);
+    free(hash_table->control);
+    hash_table->cells = NULL;
+    hash_table->control = NULL;
+    hash_table->size = 0;
+    hash_table->capacity = 0;
 }
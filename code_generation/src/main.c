@@ -1,6 +1,40 @@
 #include "metacgen/metacgen.h"
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
+
+// Root of the repository, all paths below are relative to it. Passed on the
+// command line by the build, the define is a fallback for running by hand.
+#ifndef FTIC_ROOT
+#define FTIC_ROOT "./"
+#endif
+
+// One instantiation of a container template. types are the template
+// arguments, compare is appended for the functions that need an ordering.
+// Tests and benchmarks are generated for every entry, so element types have
+// to be constructible from an integer with a cast and compare with ==.
+typedef struct GenType
+{
+    char* types;
+    char* struct_postfix;
+    char* function_postfix;
+    char* compare;
+} GenType;
+
+//////////////// Container types, one line per instantiation ////////////////
+static const GenType small_vectors[] = {
+    { "u32,16", "U32", "_u32" },
+};
+static const GenType ring_buffers[] = {
+    { "u32", "U32", "_u32" },
+    { "u64", "U64", "_u64" },
+};
+static const GenType pool_lists[] = {
+    { "u64", "U64", "_u64" },
+};
+static const GenType flat_maps[] = {
+    { "u64,u32", "U64U32", "_u64_u32", "value_order" },
+};
 
 static double get_time_sec(void)
 {
@@ -9,20 +43,107 @@ static double get_time_sec(void)
     return now.tv_sec + (now.tv_nsec * 0.000000001);
 }
 
+static void append_gen_types(Mcgen_Context* ctx, char** names, const uint32_t name_count,
+                             const GenType* entries, const uint32_t count, const int is_struct,
+                             const int with_compare)
+{
+    char* types[64] = { 0 };
+    char* postfixs[64] = { 0 };
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        types[i] = entries[i].types;
+        if (with_compare)
+        {
+            static char buffers[64][128];
+            snprintf(buffers[i], sizeof(buffers[i]), "%s,%s", entries[i].types,
+                     entries[i].compare);
+            types[i] = buffers[i];
+        }
+        postfixs[i] = is_struct ? entries[i].struct_postfix : entries[i].function_postfix;
+    }
+    for (uint32_t i = 0; i < name_count; ++i)
+    {
+        mcgen_append_types_and_postfixs(ctx, names[i], types, count, postfixs, count);
+    }
+}
+
+// The runners are plain C so every entry above gets its test and benchmark
+// called without touching the tests.
+static void write_test_runners(const char* root)
+{
+    const size_t root_length = strlen(root);
+    const char* separator = root_length && (root[root_length - 1] == '/' ||
+                                            root[root_length - 1] == '\\')
+                                ? ""
+                                : "/";
+    char path[512];
+    snprintf(path, sizeof(path), "%s%stest/src/containers_test_run.c", root, separator);
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return;
+    }
+    fprintf(file, "#include \"containers_test.h\"\n#include <stdio.h>\n\n");
+    fprintf(file, "// This code is generated, add types in code_generation/src/main.c\n\n");
+
+    struct
+    {
+        const char* name;
+        const char* function;
+        const GenType* entries;
+        uint32_t count;
+    } groups[] = {
+        { "SmallVector", "small_vector", small_vectors,
+          sizeof(small_vectors) / sizeof(small_vectors[0]) },
+        { "RingBuffer", "ring_buffer", ring_buffers,
+          sizeof(ring_buffers) / sizeof(ring_buffers[0]) },
+        { "PoolList", "pool_list", pool_lists, sizeof(pool_lists) / sizeof(pool_lists[0]) },
+        { "FlatMap", "flat_map", flat_maps, sizeof(flat_maps) / sizeof(flat_maps[0]) },
+    };
+    fprintf(file, "void containers_test_run()\n{\n");
+    for (uint32_t i = 0; i < sizeof(groups) / sizeof(groups[0]); ++i)
+    {
+        for (uint32_t j = 0; j < groups[i].count; ++j)
+        {
+            fprintf(file, "    %s_test%s();\n", groups[i].function,
+                    groups[i].entries[j].function_postfix);
+        }
+    }
+    fprintf(file, "}\n\n");
+
+    fprintf(file, "void containers_test_run_benchmarks()\n{\n");
+    for (uint32_t i = 0; i < sizeof(groups) / sizeof(groups[0]); ++i)
+    {
+        for (uint32_t j = 0; j < groups[i].count; ++j)
+        {
+            const GenType* entry = groups[i].entries + j;
+            fprintf(file, "    printf(\"\\t%s%s\\n\");\n", groups[i].name, entry->struct_postfix);
+            fprintf(file, "    %s_benchmark%s();\n", groups[i].function, entry->function_postfix);
+        }
+    }
+    fprintf(file, "}\n");
+    fclose(file);
+}
+
 int main(int argc, char** argv)
 {
-    // TODO: generate this file path through code (Platform specific)
-    Mcgen_Context* ctx =
-        mcgen_context_create("C:\\Users\\linus\\dev\\filetic\\");
+    const char* root = argc > 1 ? argv[1] : FTIC_ROOT;
+    const double start = get_time_sec();
+    Mcgen_Context* ctx = mcgen_context_create(root);
+
+    mcgen_append_type_file(ctx, "code_generation/src/array_gen.h", "src/array.h");
 
-    mcgen_append_type_file(ctx, "code_generation\\src\\array_gen.h",
-                           "src\\array.h");
+    mcgen_append_type_files(ctx, "code_generation/src/hash_table_gen.h", "src/hash_table.h",
+                            "src/hash_table.c");
 
-    mcgen_append_type_files(ctx, "code_generation\\src\\hash_table_gen.h",
-                            "src\\hash_table.h", "src\\hash_table.c");
+    mcgen_append_type_files(ctx, "code_generation/src/set_gen.h", "src/set.h", "src/set.c");
 
-    mcgen_append_type_files(ctx, "code_generation\\src\\set_gen.h",
-                            "src\\set.h", "src\\set.c");
+    mcgen_append_type_files(ctx, "code_generation/src/containers_gen.h", "src/containers.h",
+                            "src/containers.c");
+
+    mcgen_append_type_files(ctx, "code_generation/src/containers_test_gen.h",
+                            "test/src/containers_test.h", "test/src/containers_test.c");
 
     //////////////// Arrays ////////////////////
     {
@@ -53,13 +174,16 @@ int main(int argc, char** argv)
                                         postfixs_functions, postfix_count);
         mcgen_append_types_and_postfixs(ctx, "hash_table_clear", types, type_count,
                                         postfixs_functions, postfix_count);
+        mcgen_append_types_and_postfixs(ctx, "hash_table_free", types, type_count,
+                                        postfixs_functions, postfix_count);
 
         char* types2[] = {
             "u64,u64,sizeof,value_cmp",
             "char*,u32,strlen,strcmp",
             "FticGUID,char*,sizeof,guid_compare",
         };
-        mcgen_link_names(ctx, "hash_table_insert", "hash_table_get", "hash_table_remove");
+        mcgen_link_names(ctx, "hash_table_insert", "hash_table_find", "hash_table_get",
+                         "hash_table_remove");
         mcgen_append_types_and_postfixs(ctx, "hash_table_insert", types2, type_count,
                                         postfixs_functions, postfix_count);
     }
@@ -83,16 +207,65 @@ int main(int argc, char** argv)
                                         postfixs_functions, postfix_count);
         mcgen_append_types_and_postfixs(ctx, "set_clear", types, type_count,
                                         postfixs_functions, postfix_count);
+        mcgen_append_types_and_postfixs(ctx, "set_free", types, type_count,
+                                        postfixs_functions, postfix_count);
 
         char* types2[] = {
             "u64,sizeof,value_cmp",
             "char*,strlen,strcmp",
             "FticGUID,sizeof,guid_compare",
         };
-        mcgen_link_names(ctx, "set_insert", "set_contains", "set_remove");
+        mcgen_link_names(ctx, "set_insert", "set_find", "set_contains", "set_remove");
         mcgen_append_types_and_postfixs(ctx, "set_insert", types2, type_count,
                                         postfixs_functions, postfix_count);
     }
 
+    //////////////// Containers ////////////////////
+    {
+        char* structs[] = { "SmallVector" };
+        char* functions[] = { "small_vector_init", "small_vector_data", "small_vector_push",
+                              "small_vector_free", "small_vector_test",
+                              "small_vector_benchmark" };
+        append_gen_types(ctx, structs, 1, small_vectors,
+                         sizeof(small_vectors) / sizeof(small_vectors[0]), 1, 0);
+        append_gen_types(ctx, functions, sizeof(functions) / sizeof(functions[0]),
+                         small_vectors, sizeof(small_vectors) / sizeof(small_vectors[0]), 0, 0);
+    }
+    {
+        char* structs[] = { "RingBuffer" };
+        char* functions[] = { "ring_buffer_create", "ring_buffer_push", "ring_buffer_pop",
+                              "ring_buffer_size", "ring_buffer_free", "ring_buffer_test",
+                              "ring_buffer_benchmark" };
+        append_gen_types(ctx, structs, 1, ring_buffers,
+                         sizeof(ring_buffers) / sizeof(ring_buffers[0]), 1, 0);
+        append_gen_types(ctx, functions, sizeof(functions) / sizeof(functions[0]),
+                         ring_buffers, sizeof(ring_buffers) / sizeof(ring_buffers[0]), 0, 0);
+    }
+    {
+        char* structs[] = { "PoolListNode", "PoolList" };
+        char* functions[] = { "pool_list_create", "pool_list_push_back", "pool_list_remove",
+                              "pool_list_free", "pool_list_test", "pool_list_benchmark" };
+        append_gen_types(ctx, structs, 2, pool_lists, sizeof(pool_lists) / sizeof(pool_lists[0]),
+                         1, 0);
+        append_gen_types(ctx, functions, sizeof(functions) / sizeof(functions[0]), pool_lists,
+                         sizeof(pool_lists) / sizeof(pool_lists[0]), 0, 0);
+    }
+    {
+        char* structs[] = { "FlatMap" };
+        char* functions[] = { "flat_map_create", "flat_map_free" };
+        char* compare_functions[] = { "flat_map_lower_bound", "flat_map_insert", "flat_map_get",
+                                      "flat_map_remove", "flat_map_test", "flat_map_benchmark" };
+        const uint32_t count = sizeof(flat_maps) / sizeof(flat_maps[0]);
+        append_gen_types(ctx, structs, 1, flat_maps, count, 1, 0);
+        append_gen_types(ctx, functions, sizeof(functions) / sizeof(functions[0]), flat_maps,
+                         count, 0, 0);
+        append_gen_types(ctx, compare_functions,
+                         sizeof(compare_functions) / sizeof(compare_functions[0]), flat_maps,
+                         count, 0, 1);
+    }
+
     mcgen_generate_code(ctx);
+    write_test_runners(root);
+
+    printf("Generated code in %.3f s\n", get_time_sec() - start);
 }
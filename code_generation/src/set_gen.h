@@ -5,17 +5,20 @@ template <Key>
 struct SetCell
 {
     Key key;
-    bool active;
-    bool deleted;
 };
 
+// Same layout as the hash tables, see hash_table_gen.h.
 template <Key>
-struct Set 
+struct Set
 {
     SetCell<Key>* cells;
+    u8* control;
     u32 size;
     u32 capacity;
 
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    SetCell<Key> removed;
+
     u64 (*hash_function)(const void* key, u32 len, u64 seed);
 };
 
@@ -25,6 +28,7 @@ Set<Key> set_create(u32 capacity, u64 (*hash_function)(const void* key, u32 len,
     capacity = max(round_up_power_of_two(capacity), 32);
     Set<Key> out = {
         .cells = (SetCell<Key>*)calloc(capacity, sizeof(SetCell<Key>)),
+        .control = control_create(capacity),
         .capacity = capacity,
         .hash_function = hash_function,
     };
@@ -32,134 +36,130 @@ Set<Key> set_create(u32 capacity, u64 (*hash_function)(const void* key, u32 len,
 }
 
 template <Key, Len, Cmp>
-void set_insert(Set<Key>* set, Key key)
+u32 set_find(Set<Key>* set, const Key key, const u64 hash)
 {
-    u32 capacity_mask = set->capacity - 1;
-    u64 hashed_index =
-        set->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
-
-    SetCell<Key>* cell = set->cells + hashed_index;
-    if (cell->active)
+    const u32 capacity_mask = set->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(set->cells + index);
+    for (u32 probed = 0; probed < set->capacity; probed += CONTROL_GROUP_SIZE)
     {
-        if (Cmp(cell->key, key) != 0)
+        const u8* group = set->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
         {
-            cell = set->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 1; i < set->size && cell->active; ++i)
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (Cmp(set->cells[candidate].key, key) == 0)
             {
-                if (Cmp(cell->key, key) == 0)
-                {
-                    goto add_node;
-                }
-                cell = set->cells + (++hashed_index & capacity_mask);
+                return candidate;
             }
         }
-        else
+        if (control_match_empty(group))
         {
-            goto add_node;
+            break;
         }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+    return set->capacity;
+}
+
+template <Key, Len, Cmp>
+void set_insert(Set<Key>* set, Key key)
+{
+    const u64 hash = set->hash_function(&key, (u32)Len(key), HASH_SEED);
+    if (set_find<Key, Len, Cmp>(set, key, hash) < set->capacity)
+    {
+        return;
     }
-    cell->active = true;
-    cell->deleted = false;
-    cell->key = key;
-add_node:
-    if (set->size++ >= (u32)(set->capacity * 0.4f))
+
+    if (set->size + 1 > control_max_load(set->capacity))
     {
-        u32 old_capacity = set->capacity;
-        SetCell<Key>* old_storage = set->cells;
+        const u32 old_capacity = set->capacity;
+        SetCell<Key>* old_cells = set->cells;
+        u8* old_control = set->control;
 
-        set->size = 0;
         set->capacity *= 2;
-        set->cells = (SetCell<Key>*)calloc(set->capacity,
-                                                 sizeof(SetCell<Key>));
+        set->cells = (SetCell<Key>*)calloc(set->capacity, sizeof(SetCell<Key>));
+        set->control = control_create(set->capacity);
 
-        for (u32 i = 0; i < old_capacity; i++)
+        const u32 capacity_mask = set->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
         {
-            cell = old_storage + i;
-            if (cell->active)
+            if (control_is_full(old_control[i]))
             {
-                set_insert(set, cell->key);
+                SetCell<Key>* cell = old_cells + i;
+                const u64 cell_hash =
+                    set->hash_function(&cell->key, (u32)Len(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(set->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(set->control, empty, control_tag(cell_hash), set->capacity);
+                set->cells[empty] = *cell;
             }
         }
-        free(old_storage);
+        free(old_cells);
+        free(old_control);
     }
+
+    const u32 capacity_mask = set->capacity - 1;
+    const u32 index =
+        control_find_empty(set->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(set->control, index, control_tag(hash), set->capacity);
+    set->cells[index].key = key;
+    set->size++;
 }
 
 template <Key, Len, Cmp>
 b8 set_contains(Set<Key>* set, const Key key)
 {
-    u32 capacity_mask = set->capacity - 1;
-    u64 hashed_index =
-        set->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
-
-    SetCell<Key>* cell = set->cells + hashed_index;
-    if (cell->active || cell->deleted)
-    {
-        if (Cmp(cell->key, key) != 0)
-        {
-            cell = set->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0;
-                 i < set->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (Cmp(cell->key, key) == 0)
-                    {
-                        return true;
-                    }
-                }
-                cell = set->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if(cell->active)
-        {
-            return true;
-        }
-    }
-    return false;
+    const u64 hash = set->hash_function(&key, (u32)Len(key), HASH_SEED);
+    return set_find<Key, Len, Cmp>(set, key, hash) < set->capacity;
 }
 
 template <Key, Len, Cmp>
 SetCell<Key>* set_remove(Set<Key>* set, const Key key)
 {
-    u32 capacity_mask = set->capacity - 1;
-    u64 hashed_index =
-        set->hash_function(&key, (u32)Len(key), HASH_SEED) & capacity_mask;
+    const u64 hash = set->hash_function(&key, (u32)Len(key), HASH_SEED);
+    u32 hole = set_find<Key, Len, Cmp>(set, key, hash);
+    if (hole == set->capacity)
+    {
+        return NULL;
+    }
+    set->removed = set->cells[hole];
 
-    SetCell<Key>* cell = set->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = set->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(set->control[next]);
+         next = (next + 1) & capacity_mask)
     {
-        if (Cmp(cell->key, key) != 0)
+        SetCell<Key>* cell = set->cells + next;
+        const u64 cell_hash = set->hash_function(&cell->key, (u32)Len(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
         {
-            cell = set->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0;
-                 i < set->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (Cmp(cell->key, key) == 0)
-                    {
-                        cell->active = false;
-                        cell->deleted = true;
-                        set->size--;
-                        return cell;
-                    }
-                }
-                cell = set->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if(cell->active)
-        {
-            cell->active = false;
-            cell->deleted = true;
-            set->size--;
-            return cell;
+            set->cells[hole] = *cell;
+            control_set(set->control, hole, set->control[next], set->capacity);
+            hole = next;
         }
     }
-    return NULL;
+    control_set(set->control, hole, CONTROL_EMPTY, set->capacity);
+    set->size--;
+    return &set->removed;
 }
 
 template <Key>
 void set_clear(Set<Key>* set)
 {
-    memset(set->cells, 0, set->capacity * sizeof(set->cells[0]));
+    memset(set->control, CONTROL_EMPTY, set->capacity + CONTROL_GROUP_SIZE - 1);
+    set->size = 0;
+}
+
+template <Key>
+void set_free(Set<Key>* set)
+{
+    free(set->cells);
+    free(set->control);
+    set->cells = NULL;
+    set->control = NULL;
+    set->size = 0;
+    set->capacity = 0;
 }
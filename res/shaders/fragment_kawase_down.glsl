@@ -0,0 +1,26 @@
+#version 450 core
+
+layout(location = 0) in vec4 fColor;
+layout(location = 1) in vec2 fTexCoord;
+layout(location = 2) in flat float fTexIndex;
+
+layout(location = 0) out vec4 finalColor;
+
+uniform sampler2D textures[2];
+uniform float offset;
+
+// Dual Kawase downsample, the center and the four diagonal corners. Every
+// tap lands between four texels so the bilinear filter does most of the work.
+void main()
+{
+    int index = int(fTexIndex);
+    vec2 halfPixel = (0.5 / vec2(textureSize(textures[index], 0))) * offset;
+
+    vec3 colorSum = texture(textures[index], fTexCoord).rgb * 4.0;
+    colorSum += texture(textures[index], fTexCoord - halfPixel).rgb;
+    colorSum += texture(textures[index], fTexCoord + halfPixel).rgb;
+    colorSum += texture(textures[index], fTexCoord + vec2(halfPixel.x, -halfPixel.y)).rgb;
+    colorSum += texture(textures[index], fTexCoord - vec2(halfPixel.x, -halfPixel.y)).rgb;
+
+    finalColor = vec4(colorSum / 8.0, 1.0);
+}
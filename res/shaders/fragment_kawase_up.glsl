@@ -0,0 +1,29 @@
+#version 450 core
+
+layout(location = 0) in vec4 fColor;
+layout(location = 1) in vec2 fTexCoord;
+layout(location = 2) in flat float fTexIndex;
+
+layout(location = 0) out vec4 finalColor;
+
+uniform sampler2D textures[2];
+uniform float offset;
+
+// Dual Kawase upsample, eight taps in a diamond around the pixel. Also used
+// for the frosted window backgrounds, which are the last upsample.
+void main()
+{
+    int index = int(fTexIndex);
+    vec2 halfPixel = (0.5 / vec2(textureSize(textures[index], 0))) * offset;
+
+    vec3 colorSum = texture(textures[index], fTexCoord + vec2(-halfPixel.x * 2.0, 0.0)).rgb;
+    colorSum += texture(textures[index], fTexCoord + vec2(-halfPixel.x, halfPixel.y)).rgb * 2.0;
+    colorSum += texture(textures[index], fTexCoord + vec2(0.0, halfPixel.y * 2.0)).rgb;
+    colorSum += texture(textures[index], fTexCoord + vec2(halfPixel.x, halfPixel.y)).rgb * 2.0;
+    colorSum += texture(textures[index], fTexCoord + vec2(halfPixel.x * 2.0, 0.0)).rgb;
+    colorSum += texture(textures[index], fTexCoord + vec2(halfPixel.x, -halfPixel.y)).rgb * 2.0;
+    colorSum += texture(textures[index], fTexCoord + vec2(0.0, -halfPixel.y * 2.0)).rgb;
+    colorSum += texture(textures[index], fTexCoord + vec2(-halfPixel.x, -halfPixel.y)).rgb * 2.0;
+
+    finalColor = vec4((colorSum / 12.0) * fColor.rgb, 1.0);
+}
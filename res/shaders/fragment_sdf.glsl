@@ -0,0 +1,30 @@
+#version 450 core
+
+layout(location = 0) in vec4 fColor;
+layout(location = 1) in vec2 fTexCoord;
+layout(location = 2) in flat float fTexIndex;
+
+layout(location = 0) out vec4 finalColor;
+
+uniform sampler2D textures[100];
+uniform float sdfTextureIndex;
+uniform float sdfEdge;
+
+void main()
+{
+    int index = int(fTexIndex);
+    vec4 fTexure = texture(textures[index], fTexCoord);
+    if (index == int(sdfTextureIndex))
+    {
+        // Smoothing width follows the screen space derivative, so the edge
+        // stays about one pixel wide at every font size.
+        float distance = fTexure.a;
+        float width = max(fwidth(distance), 0.0001);
+        float alpha = smoothstep(sdfEdge - width, sdfEdge + width, distance);
+        finalColor = vec4(fColor.rgb, fColor.a * alpha);
+    }
+    else
+    {
+        finalColor = fTexure * fColor;
+    }
+}
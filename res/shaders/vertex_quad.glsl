@@ -0,0 +1,33 @@
+#version 450 core
+
+layout(location = 0) in vec2 iPosition;
+layout(location = 1) in vec2 iEdgeX;
+layout(location = 2) in vec2 iEdgeY;
+layout(location = 3) in vec4 iTexCoords;
+layout(location = 4) in uvec4 iColors;
+layout(location = 5) in float iTexIndex;
+
+layout(location = 0) out vec4 fColor;
+layout(location = 1) out vec2 fTexCoord;
+layout(location = 2) out flat float fTexIndex;
+
+uniform mat4 proj;
+uniform mat4 view;
+uniform mat4 model;
+
+// Two triangles per quad, same winding as the old { 0, 1, 2, 2, 3, 0 } index
+// buffer. The corners go top left, bottom left, bottom right, top right.
+const int cornerTable[6] = int[6](0, 1, 2, 2, 3, 0);
+const vec2 cornerWeights[4] = vec2[4](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0));
+
+void main()
+{
+    int corner = cornerTable[gl_VertexID];
+    vec2 weight = cornerWeights[corner];
+    vec2 position = iPosition + (iEdgeX * weight.x) + (iEdgeY * weight.y);
+
+    gl_Position = proj * view * model * vec4(position, 0.0, 1.0);
+    fColor = unpackUnorm4x8(iColors[corner]);
+    fTexCoord = mix(iTexCoords.xy, iTexCoords.zw, weight);
+    fTexIndex = iTexIndex;
+}
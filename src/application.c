@@ -7,6 +7,8 @@
 #include "random.h"
 #include "globals.h"
 #include "theme.h"
+#include "profiler.h"
+#include "thumbnail_cache.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <string.h>
@@ -163,7 +165,7 @@ internal u32 drop_down_layout_add_increment_width_text(DropDownLayout* layout, c
     value_to_string(buffer, "%u", value);
 
     const FontTTF* ui_font = ui_context_get_font();
-    const f32 x_advance = text_x_advance(ui_font->chars, buffer, (u32)strlen(buffer), 1.0f);
+    const f32 x_advance = text_x_advance(ui_font, buffer, (u32)strlen(buffer), 1.0f);
     const f32 row_padding = 10.0f;
     const f32 total_width =
         button1_dim.width + button2_dim.width + x_advance + (row_padding * 2.0f);
@@ -337,191 +339,124 @@ internal void render_3d_initialize(Render* render, const u32 shader, int* light_
 internal void look_for_and_load_image_thumbnails(DirectoryTab* tab)
 {
     DirectoryPage* current = directory_current(&tab->directory_history);
-    platform_mutex_lock(&tab->textures.mutex);
-    for (u32 i = 0; i < tab->textures.array.size; ++i)
+    IdTextureProperties textures[32];
+    u32 count = 0;
+    do
     {
-        IdTextureProperties* texture = tab->textures.array.data + i;
-        DirectoryItem* item = NULL;
-        for (u32 j = 0; j < current->directory.items.size; ++j)
+        count = thread_channel_drain(tab->textures, textures, static_array_size(textures));
+        for (u32 i = 0; i < count; ++i)
         {
-            DirectoryItem* current_item = current->directory.items.data + j;
-            if (!guid_compare(texture->id, current_item->id))
+            IdTextureProperties* texture = textures + i;
+            DirectoryItem* item = NULL;
+            for (u32 j = 0; j < current->directory.items.size; ++j)
             {
-                item = current_item;
-                break;
+                DirectoryItem* current_item = current->directory.items.data + j;
+                if (!guid_compare(texture->id, current_item->id))
+                {
+                    item = current_item;
+                    break;
+                }
             }
-        }
-        if (item)
-        {
-            if (item->texture_id)
+            if (item)
             {
-                texture_delete(item->texture_id);
-                item->texture_id = 0;
+                if (item->texture_id)
+                {
+                    texture_delete(item->texture_id);
+                    item->texture_id = 0;
+                }
+                item->texture_id =
+                    texture_create(&texture->texture_properties, GL_RGBA8, GL_RGBA, GL_LINEAR);
+                item->texture_width = (u16)texture->texture_properties.width;
+                item->texture_height = (u16)texture->texture_properties.height;
+                item->reload_thumbnail = false;
             }
-            item->texture_id =
-                texture_create(&texture->texture_properties, GL_RGBA8, GL_RGBA, GL_LINEAR);
-            item->texture_width = (u16)texture->texture_properties.width;
-            item->texture_height = (u16)texture->texture_properties.height;
-            item->reload_thumbnail = false;
+            free(texture->texture_properties.bytes);
         }
-        free(texture->texture_properties.bytes);
-    }
-    tab->textures.array.size = 0;
-    platform_mutex_unlock(&tab->textures.mutex);
-}
-
-internal u32 mesh_3d_render_to_2d_texture(const Mesh3D* mesh, const AABB3D* mesh_aabb,
-                                          const i32 width, const i32 height,
-                                          const AABB* view_port_before, const u32 shader)
-{
-    u32 resulting_texture = 0;
-
-    u32 fbo;
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-    u32 multisampled_texture;
-    glGenTextures(1, &multisampled_texture);
-    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, multisampled_texture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, (GLsizei)width, (GLsizei)height,
-                            GL_TRUE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE,
-                           multisampled_texture, 0);
-
-    u32 rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH_COMPONENT, (GLsizei)width,
-                                     (GLsizei)height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
-
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
-    {
-        u32 resolve_fbo;
-        glGenFramebuffers(1, &resolve_fbo);
-        glBindFramebuffer(GL_FRAMEBUFFER, resolve_fbo);
-
-        glGenTextures(1, &resulting_texture);
-        glBindTexture(GL_TEXTURE_2D, resulting_texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)width, (GLsizei)height, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                               resulting_texture, 0);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
-        {
-            int light_dir_location = -1;
-            Render temp_render = { 0 };
-            render_3d_initialize(&temp_render, shader, &light_dir_location);
-
-            vertex_buffer_orphan(temp_render.vertex_buffer_id,
-                                 mesh->vertices.size * sizeof(Vertex3D), GL_STATIC_DRAW,
-                                 mesh->vertices.data);
-            index_buffer_orphan(temp_render.index_buffer_id, mesh->indices.size * sizeof(u32),
-                                GL_STATIC_DRAW, mesh->indices.data);
-
-            Camera camera = camera_create_default();
-            camera_set_based_on_mesh_aabb(&camera, mesh_aabb);
-
-            const AABB view_port = { .size = v2i((f32)width) };
-            camera.view_port = view_port;
-            camera.view_projection.projection =
-                perspective(PI * 0.5f, view_port.size.width / view_port.size.height, 0.1f, 100.0f);
-            camera.view_projection.view =
-                view(camera.position, v3_add(camera.position, camera.orientation), camera.up);
-
-            const MVP mvp = {
-                .model = m4d(),
-                .view = camera.view_projection.view,
-                .projection = camera.view_projection.projection,
-            };
-
-            glEnable(GL_DEPTH_TEST);
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-            glViewport(0, 0, (int)round_f32(camera.view_port.size.width),
-                       (int)round_f32(camera.view_port.size.height));
-
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            render_begin_draw(&temp_render, temp_render.shader_properties.shader, &mvp);
-
-            glUniform3f(light_dir_location, -camera.orientation.x, -camera.orientation.y,
-                        -camera.orientation.z);
-
-            render_draw(0, mesh->indices.size, &camera.view_port);
-            render_end_draw(&temp_render);
-
-            glDisable(GL_DEPTH_TEST);
-
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolve_fbo);
-            glBlitFramebuffer(0, 0, (GLsizei)width, (GLsizei)height, 0, 0, (GLsizei)width,
-                              (GLsizei)height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            glViewport((int)round_f32(view_port_before->min.x),
-                       (int)round_f32(view_port_before->min.y),
-                       (int)round_f32(view_port_before->size.width),
-                       (int)round_f32(view_port_before->size.height));
+    } while (count == static_array_size(textures));
+}
 
-            render_destroy(&temp_render);
-        }
-        else
+internal DirectoryItem* find_item_by_id(DirectoryItemArray* items, const FticGUID id)
+{
+    for (u32 j = 0; j < items->size; ++j)
+    {
+        DirectoryItem* current_item = items->data + j;
+        if (!guid_compare(id, current_item->id))
         {
-            texture_delete(resulting_texture);
-            resulting_texture = 0;
+            return current_item;
         }
-        glDeleteFramebuffers(1, &resolve_fbo);
     }
-    glDeleteTextures(1, &multisampled_texture);
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteRenderbuffers(1, &rbo);
+    return NULL;
+}
 
-    return resulting_texture;
+internal void free_object_thumbnail(ObjectThumbnail* object)
+{
+    array_free(&object->mesh.vertices);
+    array_free(&object->mesh.indices);
 }
 
-internal void look_for_and_load_object_thumbnails(const V2 dimensions, const u32 shader,
-                                                  DirectoryTab* tab)
+// Renders the loaded meshes in batches until the frame budget is used up, the
+// rest are left for the next frame.
+internal void look_for_and_load_object_thumbnails(ThumbnailRenderer* renderer, DirectoryTab* tab)
 {
     DirectoryPage* current = directory_current(&tab->directory_history);
-    platform_mutex_lock(&tab->objects.mutex);
-    for (u32 i = 0; i < tab->objects.array.size; ++i)
+    ObjectThumbnailArray* objects = &tab->pending_objects;
+    for (;;)
     {
-        ObjectThumbnail* object = tab->objects.array.data + i;
-        DirectoryItem* item = NULL;
-        for (u32 j = 0; j < current->directory.items.size; ++j)
+        if (objects->size == objects->capacity)
         {
-            DirectoryItem* current_item = current->directory.items.data + j;
-            if (!guid_compare(object->id, current_item->id))
-            {
-                item = current_item;
-                break;
-            }
+            objects->capacity *= 2;
+            objects->data = (ObjectThumbnail*)realloc(objects->data,
+                                                      objects->capacity * sizeof(ObjectThumbnail));
         }
-        if (item)
+        const u32 count = thread_channel_drain(tab->objects, objects->data + objects->size,
+                                               objects->capacity - objects->size);
+        if (!count)
+        {
+            break;
+        }
+        objects->size += count;
+    }
+
+    u32 kept = 0;
+    for (u32 i = 0; i < objects->size; ++i)
+    {
+        if (find_item_by_id(&current->directory.items, objects->data[i].id))
+        {
+            objects->data[kept++] = objects->data[i];
+        }
+        else
         {
+            free_object_thumbnail(objects->data + i);
+        }
+    }
+    objects->size = kept;
+
+    const f64 start_time = platform_get_time();
+    u32 done = 0;
+    while (done < objects->size &&
+           (!done || (platform_get_time() - start_time) < THUMBNAIL_FRAME_BUDGET))
+    {
+        u32 textures[THUMBNAIL_ATLAS_TILE_COUNT] = { 0 };
+        const u32 batch_count = thumbnail_renderer_render(renderer, objects->data + done,
+                                                          objects->size - done, textures);
+        for (u32 i = 0; i < batch_count; ++i)
+        {
+            ObjectThumbnail* object = objects->data + done + i;
+            DirectoryItem* item = find_item_by_id(&current->directory.items, object->id);
             if (item->texture_id)
             {
                 texture_delete(item->texture_id);
-                item->texture_id = 0;
             }
-            AABB view_port_before = { .size = dimensions };
-            item->texture_id =
-                mesh_3d_render_to_2d_texture(&object->mesh, &object->mesh_aabb, item->texture_width,
-                                             item->texture_height, &view_port_before, shader);
-
+            item->texture_id = textures[i];
+            item->texture_width = THUMBNAIL_SIZE;
+            item->texture_height = THUMBNAIL_SIZE;
             item->reload_thumbnail = false;
+            free_object_thumbnail(object);
         }
-        array_free(&object->mesh.vertices);
-        array_free(&object->mesh.indices);
+        done += batch_count;
     }
-    tab->objects.array.size = 0;
-    platform_mutex_unlock(&tab->objects.mutex);
+    memmove(objects->data, objects->data + done, (objects->size - done) * sizeof(ObjectThumbnail));
+    objects->size -= done;
 }
 
 internal void add_arrow_icon(const V2 at, const V2 button_size, const u32 sort_count)
@@ -557,7 +492,7 @@ internal void sort_directory(const SortBy sort_by, DirectoryTab* tab)
             current->sort_by = SORT_NONE;
         }
     }
-    directory_reload(directory_current(&tab->directory_history));
+    directory_refresh(directory_current(&tab->directory_history));
 }
 
 internal b8 application_show_directory_window(ApplicationContext* app, const u32 window,
@@ -567,8 +502,7 @@ internal b8 application_show_directory_window(ApplicationContext* app, const u32
     DirectoryPage* current = directory_current(&tab->directory_history);
 
     look_for_and_load_image_thumbnails(tab);
-    look_for_and_load_object_thumbnails(app->dimensions, app->render_3d.shader_properties.shader,
-                                        tab);
+    look_for_and_load_object_thumbnails(&app->thumbnail_renderer, tab);
 
     if (ui_window_begin(window, get_parent_directory_name(current),
                         UI_WINDOW_TOP_BAR | UI_WINDOW_RESIZEABLE))
@@ -589,7 +523,7 @@ internal b8 application_show_directory_window(ApplicationContext* app, const u32
         {
             selected_item = ui_window_add_directory_item_grid(
                 v2f(0.0f, layout.at.y), &current->directory.items, &app->thread_queue.task_queue,
-                &tab->textures, &tab->objects, &hit_index, &tab->directory_list);
+                tab->textures, tab->objects, &hit_index, &tab->directory_list);
 
             if (selected_item != -1)
             {
@@ -610,8 +544,8 @@ internal b8 application_show_directory_window(ApplicationContext* app, const u32
         else
         {
             selected_item = ui_window_add_directory_item_list(
-                layout.at, list_item_height, &current->directory.items, &tab->directory_list,
-                &hit_index, &layout);
+                layout.at, list_item_height, &current->directory.items, NULL,
+                &tab->directory_list, &hit_index, &layout);
             if (selected_item != -1)
             {
                 DirectoryItem* item = current->directory.items.data + selected_item;
@@ -790,7 +724,7 @@ internal b8 drop_down_menu_add(DropDownMenu2* drop_down_menu, const ApplicationC
             i, drop_down_item_hit, should_close, item_clicked, &text_color, option_data);
 
         *drop_down_menu->index_count += text_generation_color(
-            application->font.chars, drop_down_menu->options.data[i], 1.0f,
+            &application->font, drop_down_menu->options.data[i], 1.0f,
             promt_item_text_position, 1.0f, application->font.pixel_height * precent, text_color,
             NULL, NULL, NULL, &drop_down_menu->render->vertices);
 
@@ -800,64 +734,40 @@ internal b8 drop_down_menu_add(DropDownMenu2* drop_down_menu, const ApplicationC
            event_is_key_clicked(FTIC_KEY_ESCAPE);
 }
 
-internal void get_suggestions(const V2 position, DirectoryPage* current,
-                              InputBuffer* parent_directory_input, DropDownMenu2* suggestions,
-                              SuggestionSelectionData* suggestion_data)
+internal void get_suggestions(ApplicationContext* app, const V2 position)
 {
+    InputBuffer* parent_directory_input = &app->parent_directory_input;
+    DropDownMenu2* suggestions = &app->suggestions;
+    SuggestionSelectionData* suggestion_data = &app->suggestion_data;
+
     char* path = parent_directory_input->buffer.data;
     u32 current_directory_len = get_path_length(path, parent_directory_input->buffer.size);
     if (current_directory_len != 0) current_directory_len--;
 
-    Directory directory = { 0 };
-    char saved_chars[3];
-    saved_chars[0] = path[current_directory_len];
-    path[current_directory_len] = '\0';
-    if (platform_directory_exists(path))
-    {
-        path[current_directory_len++] = '\\';
-        saved_chars[1] = path[current_directory_len];
-        path[current_directory_len++] = '*';
-        saved_chars[2] = path[current_directory_len];
-        path[current_directory_len] = '\0';
-        directory = platform_get_directory(path, current_directory_len, false);
-        path[current_directory_len--] = saved_chars[2];
-        path[current_directory_len--] = saved_chars[1];
-
-        suggestions->tab_index = -1;
-    }
-    path[current_directory_len] = saved_chars[0];
-
-    for (u32 i = 0; i < directory.items.size; ++i)
-    {
-        DirectoryItem* dir_item = directory.items.data + i;
-        dir_item->size =
-            string_span_case_insensitive(item_name(dir_item), path + current_directory_len + 1);
-    }
-    directory_sort_by_size(&directory.items);
-    directory_flip_array(&directory.items);
-
     for (u32 i = 0; i < suggestion_data->items.size; ++i)
     {
         free(suggestion_data->items.data[i].path);
     }
     suggestions->options.size = 0;
     suggestion_data->items.size = 0;
-    const u32 item_count = min(directory.items.size, 6);
-    for (u32 i = 0; i < item_count; ++i)
+
+    // The listing comes from the cache, a directory not seen before is loaded
+    // in the background and the suggestions are asked for again when it is.
+    app->path_suggestion_generation = path_suggestion_service_generation(&app->path_suggestions);
+    const char* query =
+        path + ftic_min(current_directory_len + 1, parent_directory_input->buffer.size);
+    if (path_suggestion_service_query(&app->path_suggestions, path, current_directory_len, query,
+                                      &suggestion_data->items, 6))
     {
-        array_push(&suggestions->options, item_name(directory.items.data + i));
-        array_push(&suggestion_data->items, directory.items.data[i]);
+        suggestions->tab_index = -1;
     }
-
-    for (u32 i = item_count; i < directory.items.size; ++i)
+    for (u32 i = 0; i < suggestion_data->items.size; ++i)
     {
-        free(directory.items.data[i].path);
+        array_push(&suggestions->options, item_name(suggestion_data->items.data + i));
     }
-    array_free(&directory.items);
-    free(directory.parent);
 
     const FontTTF* ui_font = ui_context_get_font();
-    const f32 x_advance = text_x_advance(ui_font->chars, parent_directory_input->buffer.data,
+    const f32 x_advance = text_x_advance(ui_font, parent_directory_input->buffer.data,
                                          parent_directory_input->buffer.size, 1.0f);
 
     suggestions->position = v2f(position.x + x_advance, position.y + ui_font->pixel_height + 20.0f);
@@ -1152,7 +1062,8 @@ internal b8 main_drop_down_selection(u32 index, b8 hit, b8 should_close, b8 item
             {
                 if (item_clicked && hit)
                 {
-                    directory_paste_in_directory(arguments->directory);
+                    directory_paste_in_directory(arguments->directory,
+                                                 arguments->file_operations);
                     should_close = true;
                 }
             }
@@ -1166,8 +1077,7 @@ internal b8 main_drop_down_selection(u32 index, b8 hit, b8 should_close, b8 item
             }
             else if (item_clicked && hit)
             {
-                platform_delete_files(arguments->selected_paths);
-                directory_reload(arguments->directory);
+                file_operation_delete(arguments->file_operations, arguments->selected_paths, false);
 
                 should_close = true;
             }
@@ -1491,8 +1401,11 @@ internal b8 access_panel_open(AccessPanel* panel, const char* title, const f32 l
 
 internal void search_page_initialize(SearchPage* search_page)
 {
-    safe_array_create(&search_page->search_result_file_array, 10);
-    safe_array_create(&search_page->search_result_folder_array, 10);
+    search_page->results =
+        thread_channel_create(sizeof(SearchResult), SEARCH_RESULT_CHANNEL_CAPACITY, NULL);
+    array_create(&search_page->search_result_file_array, 10);
+    array_create(&search_page->search_result_file_labels, 10);
+    array_create(&search_page->search_result_folder_array, 10);
     search_page->input = ui_input_buffer_create();
     search_page->running_id = 0;
     search_page->last_running_id = 0;
@@ -1504,14 +1417,12 @@ internal void main_render_initialize(RenderingProperties* main_render,
     u32 font_texture = texture_create(texture_properties, GL_RGBA8, GL_RGBA, GL_NEAREST);
     free(texture_properties->bytes);
 
-    VertexBufferLayout vertex_buffer_layout = default_vertex_buffer_layout();
-
     u32 default_texture = create_default_texture();
     u32 copy_texture = load_icon("res/icons/copy.png");
     u32 paste_texture = load_icon("res/icons/paste.png");
     u32 delete_texture = load_icon("res/icons/delete.png");
 
-    u32 shader = shader_create("res/shaders/vertex.glsl", "res/shaders/fragment.glsl");
+    u32 shader = shader_create("res/shaders/vertex_quad.glsl", "res/shaders/fragment.glsl");
 
     ftic_assert(shader);
 
@@ -1524,23 +1435,7 @@ internal void main_render_initialize(RenderingProperties* main_render,
     array_push(&textures, paste_texture);
     array_push(&textures, delete_texture);
 
-    array_create(&main_render->vertices, 100 * 4);
-    u32 vertex_buffer_id = vertex_buffer_create();
-    vertex_buffer_orphan(vertex_buffer_id, main_render->vertices.capacity * sizeof(Vertex),
-                         GL_STREAM_DRAW, NULL);
-    main_render->vertex_buffer_capacity = main_render->vertices.capacity;
-
-    array_create(&main_render->indices, 100 * 6);
-    generate_indicies(&main_render->indices, 0, 100);
-    u32 index_buffer_id = index_buffer_create();
-    index_buffer_orphan(index_buffer_id, main_render->indices.size * sizeof(u32), GL_STATIC_DRAW,
-                        main_render->indices.data);
-    free(main_render->indices.data);
-
-    main_render->render =
-        render_create(shader, textures, &vertex_buffer_layout, vertex_buffer_id, index_buffer_id);
-
-    array_free(&vertex_buffer_layout.items);
+    rendering_properties_create(shader, textures, 256, main_render);
 }
 
 internal void application_set_colors(ApplicationContext* app)
@@ -1560,7 +1455,12 @@ void application_initialize(ApplicationContext* app)
     app->window = window_create("FileTic", 1250, 800);
     event_initialize(app->window);
     platform_init_drag_drop();
+    profiler_initialize();
     thread_initialize(100000, platform_get_core_count() - 1, &app->thread_queue);
+    file_operation_queue_create(&app->thread_queue.task_queue, &app->file_operations);
+    folder_size_service_create(&app->thread_queue.task_queue, &app->folder_sizes);
+    path_suggestion_service_create(&app->thread_queue.task_queue, &app->path_suggestions);
+    directory_cache_initialize(&app->thread_queue.task_queue);
     platform_set_executable_directory();
     platform_initialize_filter();
 
@@ -1592,6 +1492,18 @@ void application_initialize(ApplicationContext* app)
     u32 shader = shader_create("res/shaders/vertex3d.glsl", "res/shaders/fragment.glsl");
     ftic_assert(shader);
     render_3d_initialize(&app->render_3d, shader, &app->light_dir_location);
+    thumbnail_renderer_create(shader, &app->thread_queue.task_queue, &app->thumbnail_renderer);
+    {
+        char thumbnail_cache_path[FTIC_MAX_PATH] = { 0 };
+        append_full_path("saved/thumbnails", thumbnail_cache_path);
+        thumbnail_cache_initialize(thumbnail_cache_path);
+    }
+    {
+        char content_index_path[FTIC_MAX_PATH] = { 0 };
+        append_full_path("saved/content_index", content_index_path);
+        content_index_service_create(&app->thread_queue.task_queue, content_index_path,
+                                     &app->content_index);
+    }
 
     array_create(&app->tabs, 10);
     app->tab_index = 0;
@@ -1606,7 +1518,7 @@ void application_initialize(ApplicationContext* app)
 
     search_page_initialize(&app->search_page);
 
-    ui_context_create();
+    ui_context_create(&app->thread_queue.task_queue);
 
     array_create(&app->windows, 20);
     for (u32 i = 0; i < 20; ++i)
@@ -1695,6 +1607,11 @@ void application_initialize(ApplicationContext* app)
     app->color_picker_window = app->windows.data[window_index++];
     app->filter_menu_window = app->windows.data[window_index++];
     app->menu_bar_window = app->windows.data[window_index++];
+    app->profiler_window.menu_item.window = app->windows.data[window_index++];
+    app->thread_pool_window.menu_item.window = app->windows.data[window_index++];
+    app->delete_confirm_window = app->windows.data[window_index++];
+    array_create(&app->delete_confirm_paths, 8);
+    array_create(&app->profiler_window.events, 1024);
 
     theme_set_dark(&app->picker);
     application_set_colors(app);
@@ -1735,6 +1652,15 @@ void application_initialize(ApplicationContext* app)
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+internal void application_clear_delete_confirm(ApplicationContext* app)
+{
+    for (u32 i = 0; i < app->delete_confirm_paths.size; ++i)
+    {
+        free(app->delete_confirm_paths.data[i]);
+    }
+    app->delete_confirm_paths.size = 0;
+}
+
 void application_uninitialize(ApplicationContext* app)
 {
     memset(app->search_page.running_callbacks, 0, sizeof(app->search_page.running_callbacks));
@@ -1760,17 +1686,26 @@ void application_uninitialize(ApplicationContext* app)
     free(app->windows.data);
     free(app->tab_windows.data);
     free(app->free_window_ids.data);
+    application_clear_delete_confirm(app);
+    free(app->delete_confirm_paths.data);
 
     ui_context_destroy();
 
-    render_destroy(&app->main_render.render);
-    free(app->main_render.vertices.data);
+    rendering_properties_destroy(&app->main_render);
+    thumbnail_renderer_destroy(&app->thumbnail_renderer);
 
     access_panel_save(&app->quick_access, "saved/quick_access.txt");
     access_panel_save(&app->recent.panel, "saved/recent.txt");
 
     platform_uninit_drag_drop();
+    file_operation_queue_destroy(&app->file_operations);
+    folder_size_service_destroy(&app->folder_sizes);
+    content_index_service_destroy(&app->content_index);
+    path_suggestion_service_destroy(&app->path_suggestions);
+    directory_cache_uninitialize();
     threads_uninitialize(&app->thread_queue);
+    profiler_uninitialize();
+    array_free(&app->profiler_window.events);
     event_uninitialize();
 }
 
@@ -1838,105 +1773,65 @@ f64 application_get_last_mouse_move_time(const ApplicationContext* app)
     return window_get_time() - app->last_moved_time;
 }
 
-internal void clear_search_result(SafeFileArray* files)
+internal void clear_search_result(DirectoryItemArray* files)
 {
-    platform_mutex_lock(&files->mutex);
-    for (u32 j = 0; j < files->array.size; ++j)
+    for (u32 j = 0; j < files->size; ++j)
     {
-        free(files->array.data[j].path);
+        free(files->data[j].path);
     }
-    memset(files->array.data, 0, files->array.size * sizeof(files->array.data[0]));
-    files->array.size = 0;
-    platform_mutex_unlock(&files->mutex);
+    memset(files->data, 0, files->size * sizeof(files->data[0]));
+    files->size = 0;
 }
 
 void search_page_clear_result(SearchPage* page)
 {
+    search_page_update(page);
     clear_search_result(&page->search_result_file_array);
     clear_search_result(&page->search_result_folder_array);
+    for (u32 i = 0; i < page->search_result_file_labels.size; ++i)
+    {
+        free(page->search_result_file_labels.data[i]);
+    }
+    page->search_result_file_labels.size = 0;
 }
 
 b8 search_page_has_result(const SearchPage* search_page)
 {
-    return search_page->search_result_file_array.array.size > 0 ||
-           search_page->search_result_folder_array.array.size > 0;
-}
-
-internal void safe_add_directory_item(const DirectoryItem* item,
-                                      FindingCallbackAttribute* arguments,
-                                      SafeFileArray* safe_array)
-{
-    const char* name = item_namec(item);
-    char* path = item->path;
-    if (string_contains_case_insensitive(name, arguments->string_to_match))
-    {
-        const u32 name_length = (u32)strlen(name);
-        const u32 path_length = (u32)strlen(path);
-
-        DirectoryItem copy = *item;
-        copy.path = string_copy(path, path_length, 2);
-        copy.name_offset = (u16)(path_length - name_length);
-        safe_array_push(safe_array, copy);
-    }
+    return search_page->search_result_file_array.size > 0 ||
+           search_page->search_result_folder_array.size > 0;
 }
 
-internal void finding_callback(void* data)
+void search_page_update(SearchPage* page)
 {
-    FindingCallbackAttribute* arguments = (FindingCallbackAttribute*)data;
-
-    b8 should_free_directory = false;
-    b8 running = arguments->running_callbacks[arguments->running_id];
-    Directory directory = { 0 };
-    if (running)
-    {
-        directory = platform_get_directory(arguments->start_directory,
-                                           arguments->start_directory_length, true);
-        should_free_directory = true;
-    }
-
-    for (u32 i = 0; i < directory.items.size && running; ++i)
+    SearchResult results[64];
+    u32 count = 0;
+    do
     {
-        DirectoryItem* item = directory.items.data + i;
-        if (item->type == FOLDER_DEFAULT)
-        {
-            safe_add_directory_item(item, arguments, arguments->folder_array);
-
-            FindingCallbackAttribute* next_arguments =
-                (FindingCallbackAttribute*)calloc(1, sizeof(FindingCallbackAttribute));
-
-            char* path = item->path;
-            size_t directory_name_length = strlen(path);
-
-            next_arguments->start_directory = string_copy(path, (u32)directory_name_length, 2);
-            next_arguments->start_directory[directory_name_length++] = '\\';
-            next_arguments->start_directory[directory_name_length++] = '*';
-            next_arguments->file_array = arguments->file_array;
-            next_arguments->folder_array = arguments->folder_array;
-            next_arguments->thread_queue = arguments->thread_queue;
-            next_arguments->start_directory_length = (u32)directory_name_length;
-            next_arguments->string_to_match = arguments->string_to_match;
-            next_arguments->string_to_match_length = arguments->string_to_match_length;
-            next_arguments->running_id = arguments->running_id;
-            next_arguments->running_callbacks = arguments->running_callbacks;
-
-            ThreadTask task = thread_task(finding_callback, next_arguments);
-            thread_tasks_push(next_arguments->thread_queue, &task, 1, NULL);
-        }
-        else
+        count = thread_channel_drain(page->results, results, static_array_size(results));
+        for (u32 i = 0; i < count; ++i)
         {
-            safe_add_directory_item(item, arguments, arguments->file_array);
+            DirectoryItem* item = &results[i].item;
+            if (results[i].running_id != page->last_running_id)
+            {
+                free(item->path);
+                free(results[i].label);
+            }
+            else if (item->type == FOLDER_DEFAULT)
+            {
+                array_push(&page->search_result_folder_array, *item);
+            }
+            else
+            {
+                array_push(&page->search_result_file_array, *item);
+                array_push(&page->search_result_file_labels, results[i].label);
+            }
         }
-    }
-    if (should_free_directory)
-    {
-        platform_reset_directory(&directory, true);
-    }
-    free(arguments->start_directory);
-    free(data);
+    } while (count == static_array_size(results));
 }
 
 void search_page_search(SearchPage* page, DirectoryHistory* directory_history,
-                        ThreadTaskQueue* thread_task_queue)
+                        ThreadTaskQueue* thread_task_queue,
+                        const ContentIndexService* content_index)
 {
     search_page_clear_result(page);
 
@@ -1960,15 +1855,23 @@ void search_page_search(SearchPage* page, DirectoryHistory* directory_history,
         FindingCallbackAttribute* arguments =
             (FindingCallbackAttribute*)calloc(1, sizeof(FindingCallbackAttribute));
         arguments->thread_queue = thread_task_queue;
-        arguments->file_array = &page->search_result_file_array;
-        arguments->folder_array = &page->search_result_folder_array;
+        arguments->results = page->results;
+        thread_channel_retain(page->results);
         arguments->start_directory = dir2;
         arguments->start_directory_length = (u32)parent_length;
         arguments->string_to_match = string_to_match;
         arguments->string_to_match_length = page->input.buffer.size;
         arguments->running_id = page->last_running_id;
         arguments->running_callbacks = page->running_callbacks;
-        finding_callback(arguments);
+        arguments->match_contents = page->match_contents;
+
+        // Inside a pinned folder the index says which files to scan.
+        const ContentIndex* index =
+            page->match_contents ? content_index_service_find(content_index, parent) : NULL;
+        if (!index || !indexed_content_search(index, arguments))
+        {
+            finding_callback(arguments);
+        }
     }
 }
 
@@ -2175,6 +2078,10 @@ internal void application_open_windows_window(ApplicationContext* app, DropDownL
                                   "Recent:", app->dimensions);
         window_open_menu_item_add(&app->search_result_window_item, &layout,
                                   "Search result:", app->dimensions);
+        window_open_menu_item_add(&app->profiler_window.menu_item, &layout, "Profiler:",
+                                  app->dimensions);
+        window_open_menu_item_add(&app->thread_pool_window.menu_item, &layout, "Thread pool:",
+                                  app->dimensions);
 
         ui_window_dock_space_size(app->windows_window, v2f(layout.width, layout.ui_layout.at.y));
         if (ui_window_end() && app->open_windows_window)
@@ -2182,11 +2089,54 @@ internal void application_open_windows_window(ApplicationContext* app, DropDownL
             app->quick_access.menu_item.switch_x = 0.0f;
             app->recent.panel.menu_item.switch_x = 0.0f;
             app->search_result_window_item.switch_x = 0.0f;
+            app->profiler_window.menu_item.switch_x = 0.0f;
+            app->thread_pool_window.menu_item.switch_x = 0.0f;
             app->open_windows_window = false;
         }
     }
 }
 
+internal void application_open_delete_confirm_window(ApplicationContext* app,
+                                                     DropDownLayout layout, const V4 button_color)
+{
+    if (ui_window_begin(app->delete_confirm_window, NULL,
+                        UI_WINDOW_OVERLAY | UI_WINDOW_FROSTED_GLASS))
+    {
+        const u32 count = app->delete_confirm_paths.size;
+        char text[64] = { 0 };
+        sprintf_s(text, sizeof(text), "Permanently delete %u item%s?", count,
+                  count == 1 ? "" : "s");
+        ui_window_add_text(drop_down_layout_text_position(&layout), text, false,
+                           &layout.ui_layout);
+        ui_layout_row(&layout.ui_layout);
+        drop_down_layout_add_line(&layout);
+
+        const b8 confirmed = ui_window_add_button(layout.ui_layout.at, NULL, &button_color,
+                                                  "Delete", &layout.ui_layout) ||
+                             event_is_key_pressed_once(FTIC_KEY_ENTER);
+        ui_layout_column(&layout.ui_layout);
+        const b8 cancelled = ui_window_add_button(layout.ui_layout.at, NULL, &button_color,
+                                                  "Cancel", &layout.ui_layout) ||
+                             event_is_key_pressed_once(FTIC_KEY_ESCAPE);
+        ui_layout_row(&layout.ui_layout);
+
+        const V2 size = v2f(layout.width, layout.ui_layout.at.y);
+        ui_window_set_size(app->delete_confirm_window, size);
+        ui_window_set_position(app->delete_confirm_window,
+                               v2f(middle(app->dimensions.width, size.width),
+                                   middle(app->dimensions.height, size.height)));
+        if (confirmed)
+        {
+            file_operation_delete(&app->file_operations, &app->delete_confirm_paths, true);
+        }
+        if (ui_window_end() || confirmed || cancelled)
+        {
+            application_clear_delete_confirm(app);
+            app->open_delete_confirm_window = false;
+        }
+    }
+}
+
 internal void drop_down_layout_add_color_picker_button(DropDownLayout* layout, const char* text,
                                                        V2 button_size, const V4 button_color,
                                                        const V2 window_position,
@@ -2423,9 +2373,11 @@ internal void application_open_filter_menu_window(ApplicationContext* app, DropD
         }
         if (changed)
         {
+            // The cached listings were made with the old filter.
+            directory_cache_invalidate_all();
             for (u32 i = 0; i < app->tabs.size; ++i)
             {
-                directory_reload(directory_current(&app->tabs.data[i].directory_history));
+                directory_refresh(directory_current(&app->tabs.data[i].directory_history));
             }
         }
 
@@ -2591,6 +2543,7 @@ internal void application_open_context_menu_window(ApplicationContext* app,
                     .selected_paths = &current_tab->directory_list.selected_item_values.paths,
                     .panel = app->panel_right_clicked,
                     .task_queue = &app->thread_queue.task_queue,
+                    .file_operations = &app->file_operations,
                 };
                 V4 text_color = global_get_text_color();
                 if (main_drop_down_selection(i, clicked, false, clicked, &text_color, &data))
@@ -2859,8 +2812,32 @@ internal void application_handle_file_drag(ApplicationContext* app)
     }
 }
 
+internal void application_toggle_window(ApplicationContext* app, WindowOpenMenuItem* item)
+{
+    if (item->show)
+    {
+        // show is cleared when the window has finished closing.
+        ui_window_close(item->window);
+        item->switch_on = false;
+    }
+    else
+    {
+        open_window(app->dimensions, item->window);
+        item->show = true;
+        item->switch_on = true;
+    }
+}
+
 internal void application_handle_keyboard_shortcuts(ApplicationContext* app)
 {
+    if (event_is_key_pressed_once(FTIC_KEY_F3))
+    {
+        application_toggle_window(app, &app->profiler_window.menu_item);
+    }
+    else if (event_is_key_pressed_once(FTIC_KEY_F4))
+    {
+        application_toggle_window(app, &app->thread_pool_window.menu_item);
+    }
     if (!app->use_shortcuts_for_tabs || app->preview_index == 1)
     {
         return;
@@ -2872,6 +2849,29 @@ internal void application_handle_keyboard_shortcuts(ApplicationContext* app)
             platform_copy_to_clipboard(
                 &app->current_tab->directory_list.selected_item_values.paths);
         }
+        else if (event_is_key_pressed_once(FTIC_KEY_DELETE))
+        {
+            const CharPtrArray* paths =
+                &app->current_tab->directory_list.selected_item_values.paths;
+            // Shift skips the recycle bin, like in the explorer. That can not
+            // be undone, so it asks first.
+            if (event_get_key_event()->shift_pressed)
+            {
+                application_clear_delete_confirm(app);
+                for (u32 i = 0; i < paths->size; ++i)
+                {
+                    const char* path = paths->data[i];
+                    array_push(&app->delete_confirm_paths,
+                               string_copy(path, (u32)strlen(path), 0));
+                }
+                app->open_delete_confirm_window = true;
+            }
+            else
+            {
+                file_operation_delete(&app->file_operations, paths, false);
+            }
+            directory_clear_selected_items(&app->current_tab->directory_list.selected_item_values);
+        }
         else if (app->preview_index == -1 &&
                  app->current_tab->directory_list.selected_item_values.paths.size == 1 &&
                  event_is_key_pressed_once(FTIC_KEY_E) && event_get_key_event()->shift_pressed)
@@ -2910,7 +2910,8 @@ internal void application_handle_keyboard_shortcuts(ApplicationContext* app)
 
     if (event_is_ctrl_and_key_pressed(FTIC_KEY_V))
     {
-        directory_paste_in_directory(directory_current(&app->current_tab->directory_history));
+        directory_paste_in_directory(directory_current(&app->current_tab->directory_history),
+                                     &app->file_operations);
     }
 }
 
@@ -2956,42 +2957,391 @@ internal b8 application_show_search_result_window(ApplicationContext* app,
                         UI_WINDOW_TOP_BAR | UI_WINDOW_RESIZEABLE))
     {
         SearchPage* page = &app->search_page;
-        platform_mutex_lock(&page->search_result_file_array.mutex);
-        platform_mutex_lock(&page->search_result_folder_array.mutex);
-
         i32 hit_index = -1;
 
         UiLayout layout = { .at = v2f(10.0f, 10.0f) };
         i32 selected_item = -1;
         selected_item = ui_window_add_directory_item_list(layout.at, list_item_height,
-                                                          &page->search_result_folder_array.array,
-                                                          NULL, &hit_index, &layout);
+                                                          &page->search_result_folder_array,
+                                                          NULL, NULL, &hit_index, &layout);
         if (selected_item != -1)
         {
-            directory_open_folder(page->search_result_folder_array.array.data[selected_item].id,
+            directory_open_folder(page->search_result_folder_array.data[selected_item].id,
                                   &app->current_tab->directory_history);
         }
         else if (hit_index != -1)
         {
-            app->item_hit = page->search_result_folder_array.array.data[hit_index].path;
+            app->item_hit = page->search_result_folder_array.data[hit_index].path;
         }
         ui_layout_row(&layout);
-        selected_item = ui_window_add_directory_item_list(layout.at, list_item_height,
-                                                          &page->search_result_file_array.array,
-                                                          NULL, &hit_index, &layout);
+        selected_item = ui_window_add_directory_item_list(
+            layout.at, list_item_height, &page->search_result_file_array,
+            &page->search_result_file_labels, NULL, &hit_index, &layout);
         if (selected_item != -1)
         {
-            platform_open_file(page->search_result_file_array.array.data[selected_item].path);
+            platform_open_file(page->search_result_file_array.data[selected_item].path);
         }
 
-        platform_mutex_unlock(&page->search_result_file_array.mutex);
-        platform_mutex_unlock(&page->search_result_folder_array.mutex);
-
         return ui_window_end();
     }
     return false;
 }
 
+internal V4 profiler_scope_color(const char* name)
+{
+    // Hashed on the name so a scope keeps its color from frame to frame.
+    const V4 colors[] = {
+        { .r = 0.85f, .g = 0.45f, .b = 0.25f, .a = 1.0f },
+        { .r = 0.30f, .g = 0.60f, .b = 0.85f, .a = 1.0f },
+        { .r = 0.45f, .g = 0.75f, .b = 0.35f, .a = 1.0f },
+        { .r = 0.75f, .g = 0.40f, .b = 0.75f, .a = 1.0f },
+        { .r = 0.85f, .g = 0.70f, .b = 0.25f, .a = 1.0f },
+        { .r = 0.35f, .g = 0.70f, .b = 0.70f, .a = 1.0f },
+    };
+    return colors[hash_djb2(name, (u32)strlen(name), 5381) % static_array_size(colors)];
+}
+
+typedef struct ProfilerScopeTotal
+{
+    const char* name;
+    u64 ticks;
+    u32 count;
+} ProfilerScopeTotal;
+
+internal u32 profiler_scope_totals(const ProfileEventArray* events, ProfilerScopeTotal* totals,
+                                   const u32 capacity)
+{
+    u32 size = 0;
+    for (u32 i = 0; i < events->size; ++i)
+    {
+        const ProfileEvent* event = events->data + i;
+        u32 j = 0;
+        for (; j < size; ++j)
+        {
+            if (totals[j].name == event->name || strcmp(totals[j].name, event->name) == 0)
+            {
+                break;
+            }
+        }
+        if (j == size)
+        {
+            if (size == capacity)
+            {
+                continue;
+            }
+            totals[size++] = (ProfilerScopeTotal){ .name = event->name };
+        }
+        totals[j].ticks += event->end - event->start;
+        ++totals[j].count;
+    }
+    for (u32 i = 1; i < size; ++i)
+    {
+        const ProfilerScopeTotal total = totals[i];
+        i32 j = (i32)i - 1;
+        for (; j >= 0 && totals[j].ticks < total.ticks; --j)
+        {
+            totals[j + 1] = totals[j];
+        }
+        totals[j + 1] = total;
+    }
+    return size;
+}
+
+internal b8 application_show_profiler_window(ApplicationContext* app)
+{
+    ProfilerWindow* profiler_window = &app->profiler_window;
+    if (!ui_window_begin(profiler_window->menu_item.window, "Profiler",
+                         UI_WINDOW_TOP_BAR | UI_WINDOW_RESIZEABLE))
+    {
+        return false;
+    }
+    const UiWindow* window = ui_window_get(profiler_window->menu_item.window);
+    const f32 ui_font_pixel_height = ui_context_get_font_pixel_height();
+    const V4 button_color = v4a(v4_s_multi(global_get_clear_color(), 3.0f), 1.0f);
+    const V2 mouse = v2_sub(app->mouse_position, ui_window_get_first_item_position());
+
+    ProfileFrame frame = { 0 };
+    if (!profiler_window->paused && profiler_get_frame(0, &frame))
+    {
+        profiler_window->frame = frame;
+        profiler_window->events.size = 0;
+        profiler_collect(frame.start, frame.end, &profiler_window->events);
+    }
+    frame = profiler_window->frame;
+    const u64 frame_ticks = ftic_max(frame.end - frame.start, 1);
+
+    UiLayout layout = ui_layout_create(v2i(10.0f));
+    layout.padding = 10.0f;
+    char buffer[128] = { 0 };
+    sprintf_s(buffer, sizeof(buffer), "Frame: %.2f ms, %u scopes",
+              profiler_ticks_to_ms(frame.end - frame.start), profiler_window->events.size);
+    ui_window_add_text(layout.at, buffer, false, &layout);
+    ui_layout_column(&layout);
+    if (ui_window_add_button(layout.at, NULL, &button_color,
+                             profiler_window->paused ? "Resume" : "Pause", &layout))
+    {
+        b_switch(profiler_window->paused);
+    }
+    ui_layout_column(&layout);
+    if (ui_window_add_button(layout.at, NULL, &button_color, "Export trace", &layout))
+    {
+        char path[FTIC_MAX_PATH] = { 0 };
+        append_full_path("saved/trace.json", path);
+        if (!profiler_export_chrome_trace(path))
+        {
+            log_message("failed to export trace", 22);
+        }
+    }
+    ui_layout_row(&layout);
+    ui_layout_reset_column(&layout);
+
+    // Frame times, oldest to the left. The line marks 60 fps.
+    const f32 width = ftic_max(window->size.width - 2.0f * layout.at.x, 1.0f);
+    const f32 graph_height = 50.0f;
+    const f64 graph_ms = 1000.0 / 30.0;
+    const f32 bar_width = width / PROFILER_FRAME_HISTORY;
+    ui_window_add_rectangle(layout.at, v2f(width, graph_height), v4a(v4ic(0.0f), 0.3f), NULL);
+    for (u32 i = 0; i < PROFILER_FRAME_HISTORY; ++i)
+    {
+        ProfileFrame history_frame = { 0 };
+        if (!profiler_get_frame(PROFILER_FRAME_HISTORY - 1 - i, &history_frame))
+        {
+            continue;
+        }
+        const f64 ms = profiler_ticks_to_ms(history_frame.end - history_frame.start);
+        const f32 height = graph_height * (f32)ftic_min(ms / graph_ms, 1.0);
+        const V4 color = ms < graph_ms * 0.5 ? v4f(0.4f, 0.75f, 0.35f, 1.0f)
+                         : ms < graph_ms     ? v4f(0.85f, 0.7f, 0.25f, 1.0f)
+                                             : v4f(0.85f, 0.3f, 0.25f, 1.0f);
+        ui_window_add_rectangle(v2f(layout.at.x + i * bar_width, layout.at.y + graph_height - height),
+                                v2f(ftic_max(bar_width - 1.0f, 1.0f), height), color, NULL);
+    }
+    ui_window_add_rectangle(v2f(layout.at.x, layout.at.y + graph_height * 0.5f), v2f(width, 1.0f),
+                            v4ic(1.0f), NULL);
+    layout.at.y += graph_height + layout.padding;
+
+    // One lane per thread, nested scopes stacked below their parent.
+    const f32 row_height = ui_font_pixel_height + 4.0f;
+    const ProfileEvent* hovered = NULL;
+    const u32 thread_count = profiler_thread_count();
+    for (u32 thread = 0; thread < thread_count; ++thread)
+    {
+        u32 depth_count = 0;
+        for (u32 i = 0; i < profiler_window->events.size; ++i)
+        {
+            const ProfileEvent* event = profiler_window->events.data + i;
+            if (event->thread == thread)
+            {
+                depth_count = ftic_max(depth_count, (u32)event->depth + 1);
+            }
+        }
+        if (depth_count == 0)
+        {
+            continue;
+        }
+        sprintf_s(buffer, sizeof(buffer), thread ? "Worker %u" : "Main", thread);
+        ui_window_add_text(layout.at, buffer, false, &layout);
+        ui_layout_row(&layout);
+
+        for (u32 i = 0; i < profiler_window->events.size; ++i)
+        {
+            const ProfileEvent* event = profiler_window->events.data + i;
+            if (event->thread != thread)
+            {
+                continue;
+            }
+            const u64 start = ftic_max(event->start, frame.start) - frame.start;
+            const u64 end = ftic_min(event->end, frame.end) - frame.start;
+            const V2 position = v2f(layout.at.x + width * ((f32)start / frame_ticks),
+                                    layout.at.y + event->depth * row_height);
+            const V2 size = v2f(ftic_max(width * ((f32)(end - start) / frame_ticks), 1.0f),
+                                row_height - 1.0f);
+            const AABB aabb = { .min = position, .size = size };
+            V4 color = profiler_scope_color(event->name);
+            if (collision_point_in_aabb(mouse, &aabb))
+            {
+                hovered = event;
+                color = v4a(v4_s_multi(color, 1.3f), 1.0f);
+            }
+            ui_window_add_rectangle(position, size, color, NULL);
+
+            f32 text_width = 0.0f;
+            ui_window_get_button_dimensions(v2d(), event->name, &text_width);
+            if (text_width < size.width)
+            {
+                ui_window_add_text(v2f(position.x + 4.0f, position.y), event->name, false, NULL);
+            }
+        }
+        layout.at.y += depth_count * row_height;
+        ui_layout_row(&layout);
+    }
+
+    if (hovered)
+    {
+        sprintf_s(buffer, sizeof(buffer), "%s: %.3f ms", hovered->name,
+                  profiler_ticks_to_ms(hovered->end - hovered->start));
+        ui_window_add_text(layout.at, buffer, false, &layout);
+        ui_layout_row(&layout);
+    }
+
+    ProfilerScopeTotal totals[10] = { 0 };
+    const u32 total_count =
+        profiler_scope_totals(&profiler_window->events, totals, static_array_size(totals));
+    for (u32 i = 0; i < total_count; ++i)
+    {
+        sprintf_s(buffer, sizeof(buffer), "%.3f ms  %s (%u)", profiler_ticks_to_ms(totals[i].ticks),
+                  totals[i].name, totals[i].count);
+        ui_window_add_text(layout.at, buffer, false, &layout);
+        ui_layout_row(&layout);
+    }
+
+    return ui_window_end();
+}
+
+internal void format_microseconds(const f64 us, char* buffer, const u32 buffer_size)
+{
+    if (us < 1000.0)
+    {
+        sprintf_s(buffer, buffer_size, "%.0f us", us);
+    }
+    else if (us < 1000000.0)
+    {
+        sprintf_s(buffer, buffer_size, "%.1f ms", us / 1000.0);
+    }
+    else
+    {
+        sprintf_s(buffer, buffer_size, "%.2f s", us / 1000000.0);
+    }
+}
+
+internal void thread_pool_add_histogram_text(const char* label, const ThreadHistogram* histogram,
+                                             UiLayout* layout)
+{
+    char p50[32] = { 0 };
+    char p95[32] = { 0 };
+    char max[32] = { 0 };
+    format_microseconds(thread_histogram_percentile_us(histogram, 0.5), p50, sizeof(p50));
+    format_microseconds(thread_histogram_percentile_us(histogram, 0.95), p95, sizeof(p95));
+    format_microseconds((f64)histogram->max_us, max, sizeof(max));
+    char buffer[128] = { 0 };
+    sprintf_s(buffer, sizeof(buffer), "%s p50 < %s, p95 < %s, max %s", label, p50, p95, max);
+    ui_window_add_text(layout->at, buffer, false, layout);
+    ui_layout_row(layout);
+}
+
+internal b8 application_show_thread_pool_window(ApplicationContext* app)
+{
+    ThreadPoolWindow* pool_window = &app->thread_pool_window;
+    if (!ui_window_begin(pool_window->menu_item.window, "Thread pool",
+                         UI_WINDOW_TOP_BAR | UI_WINDOW_RESIZEABLE))
+    {
+        return false;
+    }
+    ThreadTaskQueue* task_queue = &app->thread_queue.task_queue;
+    ThreadTelemetry* telemetry = &task_queue->telemetry;
+    const UiWindow* window = ui_window_get(pool_window->menu_item.window);
+    const f32 ui_font_pixel_height = ui_context_get_font_pixel_height();
+    const V4 button_color = v4a(v4_s_multi(global_get_clear_color(), 3.0f), 1.0f);
+    const u32 worker_count = ftic_min(telemetry->worker_count, THREAD_POOL_WINDOW_MAX_WORKERS);
+
+    const f64 now = platform_get_time();
+    if (now - pool_window->last_sample_time >= 1.0)
+    {
+        const f64 elapsed_us = (now - pool_window->last_sample_time) * 1000000.0;
+        for (u32 i = 0; i < worker_count; ++i)
+        {
+            const i64 busy_us = telemetry->workers[i].busy_us;
+            const i64 delta = busy_us - pool_window->last_busy_us[i];
+            pool_window->utilization[i] =
+                pool_window->last_sample_time > 0.0 && delta > 0
+                    ? (f32)ftic_min(delta / elapsed_us, 1.0)
+                    : 0.0f;
+            pool_window->last_busy_us[i] = busy_us;
+        }
+        pool_window->last_sample_time = now;
+    }
+
+    UiLayout layout = ui_layout_create(v2i(10.0f));
+    layout.padding = 5.0f;
+    char buffer[256] = { 0 };
+    sprintf_s(buffer, sizeof(buffer), "Workers: %u, queued: %u (max %ld of %u)", worker_count,
+              thread_get_queue_depth(task_queue), telemetry->max_depth, task_queue->capacity);
+    ui_window_add_text(layout.at, buffer, false, &layout);
+    ui_layout_column(&layout);
+    if (ui_window_add_button(layout.at, NULL, &button_color, "Reset", &layout))
+    {
+        thread_telemetry_reset(task_queue);
+        memset(pool_window->last_busy_us, 0, sizeof(pool_window->last_busy_us));
+        pool_window->last_sample_time = 0.0;
+    }
+    ui_layout_row(&layout);
+    ui_layout_reset_column(&layout);
+
+    sprintf_s(buffer, sizeof(buffer), "Pushed %ld, completed %ld, cleared %ld, empty wakeups %ld",
+              telemetry->pushed, telemetry->completed, telemetry->cleared,
+              telemetry->empty_wakeups);
+    ui_window_add_text(layout.at, buffer, false, &layout);
+    ui_layout_row(&layout);
+    sprintf_s(buffer, sizeof(buffer), "Dropped %ld, the queue was full", telemetry->dropped);
+    if (telemetry->dropped)
+    {
+        ui_window_add_text_c(layout.at, v4f(0.9f, 0.3f, 0.25f, 1.0f), buffer, false, &layout);
+        ui_layout_row(&layout);
+    }
+
+    thread_pool_add_histogram_text("Wait:", &telemetry->wait, &layout);
+    thread_pool_add_histogram_text("Run:", &telemetry->run, &layout);
+
+    // Wait times, one bar per power of two microseconds.
+    const f32 width = ftic_max(window->size.width - 2.0f * layout.at.x, 1.0f);
+    const f32 graph_height = 40.0f;
+    const f32 bar_width = width / THREAD_HISTOGRAM_BUCKETS;
+    long highest = 1;
+    for (u32 i = 0; i < THREAD_HISTOGRAM_BUCKETS; ++i)
+    {
+        highest = ftic_max(highest, telemetry->wait.buckets[i]);
+    }
+    ui_window_add_rectangle(layout.at, v2f(width, graph_height), v4a(v4ic(0.0f), 0.3f), NULL);
+    for (u32 i = 0; i < THREAD_HISTOGRAM_BUCKETS; ++i)
+    {
+        const f32 height = graph_height * ((f32)telemetry->wait.buckets[i] / highest);
+        ui_window_add_rectangle(v2f(layout.at.x + i * bar_width, layout.at.y + graph_height - height),
+                                v2f(ftic_max(bar_width - 1.0f, 1.0f), height),
+                                v4f(0.3f, 0.6f, 0.85f, 1.0f), NULL);
+    }
+    layout.at.y += graph_height + layout.padding;
+
+    const f32 bar_height = ui_font_pixel_height + 2.0f;
+    for (u32 i = 0; i < worker_count; ++i)
+    {
+        const f32 utilization = pool_window->utilization[i];
+        ui_window_add_rectangle(layout.at, v2f(width, bar_height), v4a(v4ic(0.0f), 0.3f), NULL);
+        ui_window_add_rectangle(layout.at, v2f(width * utilization, bar_height),
+                                v4f(0.4f, 0.75f, 0.35f, 1.0f), NULL);
+        sprintf_s(buffer, sizeof(buffer), "Worker %u: %.0f%%, %ld tasks", i, utilization * 100.0f,
+                  telemetry->workers[i].tasks_run);
+        ui_window_add_text(v2f(layout.at.x + 4.0f, layout.at.y), buffer, false, NULL);
+        layout.at.y += bar_height + 2.0f;
+    }
+    layout.at.y += layout.padding;
+
+    const u32 kind_count = (u32)telemetry->kind_count;
+    for (u32 i = 0; i < kind_count; ++i)
+    {
+        const ThreadTaskKind* kind = telemetry->kinds + i;
+        char wait[32] = { 0 };
+        char run[32] = { 0 };
+        format_microseconds(thread_histogram_mean_us(&kind->wait), wait, sizeof(wait));
+        format_microseconds(thread_histogram_mean_us(&kind->run), run, sizeof(run));
+        sprintf_s(buffer, sizeof(buffer), "%s: %ld tasks, mean wait %s, mean run %s", kind->name,
+                  kind->run.count, wait, run);
+        ui_window_add_text(layout.at, buffer, false, &layout);
+        ui_layout_row(&layout);
+    }
+
+    return ui_window_end();
+}
+
 void application_check_and_open_context_menu(ApplicationContext* app)
 {
     if (app->preview_index != 1 && !event_get_key_event()->ctrl_pressed &&
@@ -3010,8 +3360,66 @@ void application_check_and_open_context_menu(ApplicationContext* app)
     }
 }
 
+internal void application_add_file_operation_progress(ApplicationContext* app,
+                                                     const FileOperationProgress* progress,
+                                                     const f32 bottom_bar_height,
+                                                     UiLayout* ui_layout)
+{
+    char done[32] = { 0 };
+    char total[32] = { 0 };
+    char speed[32] = { 0 };
+    char buffer[128] = { 0 };
+    i32 length = 0;
+    if (progress->bytes_total)
+    {
+        file_format_size(progress->bytes_done, done, sizeof(done));
+        file_format_size(progress->bytes_total, total, sizeof(total));
+        file_format_size((u64)progress->bytes_per_second, speed, sizeof(speed));
+        length = sprintf_s(buffer, sizeof(buffer), "%s / %s, %s/s", done, total, speed);
+    }
+    else
+    {
+        length = sprintf_s(buffer, sizeof(buffer), "%u / %u items", progress->files_done,
+                           progress->files_total);
+    }
+    if (progress->paused)
+    {
+        sprintf_s(buffer + length, sizeof(buffer) - length, ", paused");
+    }
+    else if (progress->seconds_left >= 0.0)
+    {
+        const u32 seconds = (u32)progress->seconds_left;
+        sprintf_s(buffer + length, sizeof(buffer) - length, ", %u:%02u left", seconds / 60,
+                  seconds % 60);
+    }
+
+    ui_layout->at.x += 20.0f;
+    ui_layout_column(ui_layout);
+    ui_window_add_text(ui_layout->at, buffer, false, ui_layout);
+
+    const V4 button_color = v4a(v4_s_multi(global_get_clear_color(), 3.0f), 1.0f);
+    const char* pause_text = progress->paused ? "Resume" : "Pause";
+    V2 button_size = ui_window_get_button_dimensions(v2d(), pause_text, NULL);
+    button_size.height = bottom_bar_height - 4.0f;
+
+    ui_layout_column(ui_layout);
+    if (ui_window_add_button(v2f(ui_layout->at.x, 2.0f), &button_size, &button_color, pause_text,
+                             ui_layout))
+    {
+        file_operation_queue_pause(&app->file_operations, !progress->paused);
+    }
+    button_size.width = ui_window_get_button_dimensions(v2d(), "Cancel", NULL).width;
+    ui_layout_column(ui_layout);
+    if (ui_window_add_button(v2f(ui_layout->at.x, 2.0f), &button_size, &button_color, "Cancel",
+                             ui_layout))
+    {
+        file_operation_queue_cancel(&app->file_operations);
+    }
+}
+
 void application_update_ui(ApplicationContext* app)
 {
+    PROFILE_FUNCTION_BEGIN();
     const f32 ui_font_pixel_height = ui_context_get_font_pixel_height();
     const f32 search_bar_width = 250.0f;
     const f32 top_bar_height = 20.0f + ui_font_pixel_height;
@@ -3040,6 +3448,10 @@ void application_update_ui(ApplicationContext* app)
         {
             application_open_windows_window(app, layout, button_color);
         }
+        if (app->open_delete_confirm_window)
+        {
+            application_open_delete_confirm_window(app, layout, button_color);
+        }
         if (app->open_style_menu_window)
         {
             application_open_style_menu_window(app, layout, button_color);
@@ -3063,7 +3475,7 @@ void application_update_ui(ApplicationContext* app)
                 V2 list_position = v2f(10.0f, 10.0f);
                 i32 selected_item = ui_window_add_directory_item_list(
                     list_position, list_item_height, &app->font_change_directory.items, NULL,
-                    &hit_index, NULL);
+                    NULL, &hit_index, NULL);
                 if (selected_item != -1)
                 {
                     const char* path = app->font_change_directory.items.data[selected_item].path;
@@ -3189,12 +3601,12 @@ void application_update_ui(ApplicationContext* app)
 
             b8 active_before = app->parent_directory_input.active;
             if (ui_window_add_input_field(ui_layout.at, bar_size, &app->parent_directory_input,
-                                          &ui_layout))
+                                          &ui_layout) ||
+                (app->parent_directory_input.active &&
+                 path_suggestion_service_generation(&app->path_suggestions) !=
+                     app->path_suggestion_generation))
             {
-                DirectoryPage* current = directory_current(&app->current_tab->directory_history);
-                get_suggestions(v2f(ui_layout.at.x, ui_layout.at.y + top_bar_menu_height), current,
-                                &app->parent_directory_input, &app->suggestions,
-                                &app->suggestion_data);
+                get_suggestions(app, v2f(ui_layout.at.x, ui_layout.at.y + top_bar_menu_height));
             }
 
             if (collision_point_in_aabb(app->mouse_position, &app->suggestions.aabb))
@@ -3241,11 +3653,8 @@ void application_update_ui(ApplicationContext* app)
 
                     app->parent_directory_input.input_index = -1;
                     app->suggestions.tab_index = -1;
-                    DirectoryPage* current =
-                        directory_current(&app->current_tab->directory_history);
-                    get_suggestions(v2f(ui_layout.at.x, ui_layout.at.y + top_bar_menu_height),
-                                    current, &app->parent_directory_input, &app->suggestions,
-                                    &app->suggestion_data);
+                    get_suggestions(app,
+                                    v2f(ui_layout.at.x, ui_layout.at.y + top_bar_menu_height));
                 }
             }
             else
@@ -3281,12 +3690,27 @@ void application_update_ui(ApplicationContext* app)
                     app->search_page.running_callbacks[app->search_page.last_running_id] = false;
                 }
             }
+            else
+            {
+                // Switches between matching names and matching file contents.
+                const char* text = "In files";
+                ui_layout_column(&ui_layout);
+                V2 dim = ui_window_get_button_dimensions(v2d(), text, NULL);
+                const V4 color = app->search_page.match_contents ? global_get_highlight_color()
+                                                                 : button_color;
+                if (ui_window_add_button(v2f(ui_layout.at.x - dim.width - 5.0f,
+                                             ui_layout.at.y + middle(button_size, dim.height)),
+                                         &dim, &color, text, &ui_layout))
+                {
+                    app->search_page.match_contents = !app->search_page.match_contents;
+                }
+            }
             if (app->search_page.input.active)
             {
                 if (event_is_key_pressed_once(FTIC_KEY_ENTER))
                 {
                     search_page_search(&app->search_page, &app->current_tab->directory_history,
-                                       &app->thread_queue.task_queue);
+                                       &app->thread_queue.task_queue, &app->content_index);
                 }
             }
             else
@@ -3311,6 +3735,13 @@ void application_update_ui(ApplicationContext* app)
             sprintf_s(buffer, sizeof(buffer), "Items: %u", current->directory.items.size);
             ui_window_add_text(ui_layout.at, buffer, false, &ui_layout);
 
+            FileOperationProgress progress = { 0 };
+            if (file_operation_queue_progress(&app->file_operations, &progress))
+            {
+                application_add_file_operation_progress(app, &progress, bottom_bar_height,
+                                                        &ui_layout);
+            }
+
             const f32 list_grid_icon_position = size.width - (2.0f * bottom_bar_height + 5.0f);
             if (current->grid_view)
             {
@@ -3366,6 +3797,24 @@ void application_update_ui(ApplicationContext* app)
             }
         }
 
+        if (app->profiler_window.menu_item.show)
+        {
+            app->profiler_window.menu_item.show = !application_show_profiler_window(app);
+            if (!app->profiler_window.menu_item.show)
+            {
+                app->profiler_window.menu_item.switch_on = false;
+            }
+        }
+
+        if (app->thread_pool_window.menu_item.show)
+        {
+            app->thread_pool_window.menu_item.show = !application_show_thread_pool_window(app);
+            if (!app->thread_pool_window.menu_item.show)
+            {
+                app->thread_pool_window.menu_item.switch_on = false;
+            }
+        }
+
         if (app->preview_index != -1)
         {
             application_open_preview(app);
@@ -3460,6 +3909,7 @@ void application_update_ui(ApplicationContext* app)
         }
     }
     ui_context_end();
+    PROFILE_END();
 }
 
 internal void preview_render_3d(ApplicationContext* app)
@@ -3513,7 +3963,7 @@ void application_look_for_dropped_files(ApplicationContext* app)
         }
         if (!same_directory)
         {
-            platform_move_to_directory(dropped_paths, path_to_dropp_in);
+            file_operation_move(&app->file_operations, dropped_paths, path_to_dropp_in);
         }
     }
 }
@@ -3525,6 +3975,9 @@ void application_run()
 
     while (!window_should_close(app.window))
     {
+        // Recording costs nothing to speak of, but only while someone looks.
+        profiler_set_enabled(app.profiler_window.menu_item.show);
+        profiler_frame_begin();
         application_begin_frame(&app);
         app.current_tab = app.tabs.data + app.tab_index;
         application_handle_file_drag(&app);
@@ -3542,39 +3995,52 @@ void application_run()
         app.item_hit = NULL;
         application_update_ui(&app);
 
-        rendering_properties_check_and_grow_vertex_buffer(&app.main_render);
-        rendering_properties_check_and_grow_index_buffer(&app.main_render, app.main_index_count);
-
-        buffer_set_sub_data(app.main_render.render.vertex_buffer_id, GL_ARRAY_BUFFER, 0,
-                            sizeof(Vertex) * app.main_render.vertices.size,
-                            app.main_render.vertices.data);
+        PROFILE_BEGIN("render");
+        rendering_properties_upload(&app.main_render);
 
         AABB whole_screen_scissor = { .size = app.dimensions };
 
         render_begin_draw(&app.main_render.render, app.main_render.render.shader_properties.shader,
                           &app.mvp);
-        render_draw(0, app.main_index_count, &whole_screen_scissor);
+        render_draw_quads(0, app.main_index_count, &whole_screen_scissor);
         render_end_draw(&app.main_render.render);
+        rendering_properties_submit(&app.main_render);
 
         if (app.preview_index == 1)
         {
             preview_render_3d(&app);
         }
+        PROFILE_END();
 
         application_look_for_dropped_files(&app);
+        search_page_update(&app.search_page);
 
-        for (u32 i = 0; i < app.tabs.size; ++i)
+        if (directory_cache_update())
         {
-            DirectoryTab* current = app.tabs.data + i;
-            if (directory_look_for_directory_change(current->directory_history.change_handle))
+            for (u32 i = 0; i < app.tabs.size; ++i)
             {
-                log_message("reload", 6);
-                directory_reload(directory_current(&current->directory_history));
-                directory_history_update_directory_change_handle(&current->directory_history);
+                directory_page_update(directory_current(&app.tabs.data[i].directory_history));
             }
         }
 
+        if (file_operation_queue_update(&app.file_operations))
+        {
+            directory_reload(directory_current(&app.current_tab->directory_history));
+        }
+
+        content_index_service_update(&app.content_index, &app.quick_access.items);
+
+        DirectoryPage* current_page = directory_current(&app.current_tab->directory_history);
+        if (folder_size_service_update(&app.folder_sizes, &current_page->directory.items) &&
+            current_page->sort_by == SORT_SIZE)
+        {
+            directory_sort(current_page);
+        }
+
+        PROFILE_BEGIN("swap_and_poll");
         application_end_frame(&app);
+        PROFILE_END();
+        profiler_frame_end();
     }
 
     // TODO: Cleanup of all
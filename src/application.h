@@ -8,8 +8,14 @@
 #include "shader.h"
 #include "ui.h"
 #include "thread_queue.h"
+#include "file_operations.h"
+#include "folder_size.h"
+#include "path_suggestions.h"
+#include "profiler.h"
+#include "search.h"
 #include "directory.h"
 #include "camera.h"
+#include "thumbnail_renderer.h"
 
 #define COPY_OPTION_INDEX 0
 #define PASTE_OPTION_INDEX 1
@@ -20,12 +26,6 @@
 #define MORE_OPTION_INDEX 6
 #define CONTEXT_ITEM_COUNT 7
 
-typedef struct SafeFileArray
-{
-    DirectoryItemArray array;
-    FTicMutex mutex;
-} SafeFileArray;
-
 typedef struct B8PtrArray
 {
     u32 size;
@@ -42,27 +42,18 @@ typedef struct DirectoryItemList
 typedef struct SearchPage
 {
     InputBuffer input;
-    SafeFileArray search_result_file_array;
-    SafeFileArray search_result_folder_array;
+    // The search tasks publish here, drained into the arrays every frame.
+    ThreadChannel* results; // SearchResult
+    DirectoryItemArray search_result_file_array;
+    CharPtrArray search_result_file_labels; // Per file, NULL unless a content match
+    DirectoryItemArray search_result_folder_array;
 
     u32 running_id;
     u32 last_running_id;
     b8 running_callbacks[100];
+    b8 match_contents; // Lines in files, shown as "<name>:<line>: <text>"
 } SearchPage;
 
-typedef struct FindingCallbackAttribute
-{
-    ThreadTaskQueue* thread_queue;
-    char* start_directory;
-    const char* string_to_match;
-    u32 start_directory_length;
-    u32 string_to_match_length;
-    u32 running_id;
-    SafeFileArray* file_array;
-    SafeFileArray* folder_array;
-    b8* running_callbacks;
-} FindingCallbackAttribute;
-
 typedef struct WindowOpenMenuItem
 {
     u32 window;
@@ -72,6 +63,27 @@ typedef struct WindowOpenMenuItem
     b8 show;
 } WindowOpenMenuItem;
 
+// Recording is only on while the window is shown. Paused keeps the captured
+// frame on screen instead of following the latest one.
+typedef struct ProfilerWindow
+{
+    WindowOpenMenuItem menu_item;
+    ProfileEventArray events;
+    ProfileFrame frame;
+    b8 paused;
+} ProfilerWindow;
+
+#define THREAD_POOL_WINDOW_MAX_WORKERS 64
+
+// Utilization is sampled once a second from the busy time of each worker.
+typedef struct ThreadPoolWindow
+{
+    WindowOpenMenuItem menu_item;
+    i64 last_busy_us[THREAD_POOL_WINDOW_MAX_WORKERS];
+    f32 utilization[THREAD_POOL_WINDOW_MAX_WORKERS];
+    f64 last_sample_time;
+} ThreadPoolWindow;
+
 typedef struct AccessPanel
 {
     DirectoryItemArray items;
@@ -87,6 +99,7 @@ typedef struct MainDropDownSelectionData
     AccessPanel* panel;
     FTicWindow* window;
     ThreadTaskQueue* task_queue;
+    FileOperationQueue* file_operations;
     b8 show_hidden_files;
 } MainDropDownSelectionData;
 
@@ -157,6 +170,11 @@ typedef struct ApplicationContext
     FTicWindow* window;
     FontTTF font;
     ThreadQueue thread_queue;
+    FileOperationQueue file_operations;
+    FolderSizeService folder_sizes;
+    ContentIndexService content_index;
+    ProfilerWindow profiler_window;
+    ThreadPoolWindow thread_pool_window;
 
     CharPtrArray menu_values;
 
@@ -187,6 +205,7 @@ typedef struct ApplicationContext
     Render render_3d;
     u32 index_count_3d;
     int light_dir_location;
+    ThumbnailRenderer thumbnail_renderer;
 
     U32Array free_window_ids;
     U32Array windows;
@@ -204,6 +223,7 @@ typedef struct ApplicationContext
     u32 style_menu_window;
     u32 filter_menu_window;
     u32 menu_bar_window;
+    u32 delete_confirm_window;
 
     f32 context_menu_x;
 
@@ -220,6 +240,7 @@ typedef struct ApplicationContext
     i32 drop_down_tab_index;
 
     CharPtrArray context_menu_options;
+    CharPtrArray delete_confirm_paths; // Deleted permanently once confirmed
 
     ThemeColorPicker picker;
     V4 secondary_color;
@@ -242,6 +263,8 @@ typedef struct ApplicationContext
     InputBuffer parent_directory_input;
     DropDownMenu2 suggestions;
     SuggestionSelectionData suggestion_data;
+    PathSuggestionService path_suggestions;
+    long path_suggestion_generation;
 
     ContextMenu context_menu;
     f32 context_menu_open_position_y;
@@ -256,6 +279,7 @@ typedef struct ApplicationContext
     b8 open_style_menu_window;
     b8 open_filter_menu_window;
     b8 open_color_picker_window;
+    b8 open_delete_confirm_window;
 
     b8 check_collision_in_ui;
     b8 menu_open_this_frame;
@@ -272,4 +296,7 @@ f64 application_get_last_mouse_move_time(const ApplicationContext* appliction);
 
 void search_page_clear_result(SearchPage* page);
 b8 search_page_has_result(const SearchPage* search_page);
-void search_page_search(SearchPage* page, DirectoryHistory* directory_history, ThreadTaskQueue* thread_task_queue);
+void search_page_update(SearchPage* page);
+void search_page_search(SearchPage* page, DirectoryHistory* directory_history,
+                        ThreadTaskQueue* thread_task_queue,
+                        const ContentIndexService* content_index);
@@ -4,27 +4,27 @@
 // @save
 
 // This is a generated file
- 
+
 // @end
 
 typedef struct ArrayChar
-{ 
-    u32 size; 
-    u32 capacity; 
-    char* data; 
+{
+    u32 size;
+    u32 capacity;
+    char* data;
 } ArrayChar;
 
 typedef struct ArrayU32
-{ 
-    u32 size; 
-    u32 capacity; 
-    u32* data; 
+{
+    u32 size;
+    u32 capacity;
+    u32* data;
 } ArrayU32;
 
 typedef struct ArrayVertex
-{ 
-    u32 size; 
-    u32 capacity; 
-    Vertex* data; 
+{
+    u32 size;
+    u32 capacity;
+    Vertex* data;
 } ArrayVertex;
 
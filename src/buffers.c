@@ -1,5 +1,6 @@
 #include "buffers.h"
 #include "util.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <glad/glad.h>
 
@@ -72,18 +73,34 @@ void vertex_buffer_layout_push_float(VertexBufferLayout* vertex_buffer_layout,
     array_push(&vertex_buffer_layout->items, item);
 }
 
-VertexBufferLayout default_vertex_buffer_layout()
+void vertex_buffer_layout_push_uint(VertexBufferLayout* vertex_buffer_layout,
+                                    const u32 count, const u32 offset)
+{
+    const VertexBufferItem item = {
+        .type = GL_UNSIGNED_INT,
+        .count = count,
+        .offset = offset,
+    };
+    array_push(&vertex_buffer_layout->items, item);
+}
+
+VertexBufferLayout quad_instance_buffer_layout()
 {
     VertexBufferLayout vertex_buffer_layout = { 0 };
-    vertex_buffer_layout_create(4, sizeof(Vertex), &vertex_buffer_layout);
-    vertex_buffer_layout_push_float(&vertex_buffer_layout, 4,
-                                    offsetof(Vertex, color));
+    vertex_buffer_layout_create(6, sizeof(QuadInstance), &vertex_buffer_layout);
+    vertex_buffer_layout.divisor = 1;
     vertex_buffer_layout_push_float(&vertex_buffer_layout, 2,
-                                    offsetof(Vertex, position));
+                                    offsetof(QuadInstance, position));
     vertex_buffer_layout_push_float(&vertex_buffer_layout, 2,
-                                    offsetof(Vertex, texture_coordinates));
+                                    offsetof(QuadInstance, edge_x));
+    vertex_buffer_layout_push_float(&vertex_buffer_layout, 2,
+                                    offsetof(QuadInstance, edge_y));
+    vertex_buffer_layout_push_float(&vertex_buffer_layout, 4,
+                                    offsetof(QuadInstance, texture_coordinates));
+    vertex_buffer_layout_push_uint(&vertex_buffer_layout, 4,
+                                   offsetof(QuadInstance, colors));
     vertex_buffer_layout_push_float(&vertex_buffer_layout, 1,
-                                    offsetof(Vertex, texture_index));
+                                    offsetof(QuadInstance, texture_index));
 
     return vertex_buffer_layout;
 }
@@ -130,6 +147,15 @@ void vertex_array_delete(u32 vertex_array)
 
 void vertex_array_add_buffer(const u32 vertex_array, const u32 vertex_buffer,
                              const VertexBufferLayout* vertex_buffer_layout)
+{
+    vertex_array_add_buffer_offset(vertex_array, vertex_buffer,
+                                   vertex_buffer_layout, 0);
+}
+
+void vertex_array_add_buffer_offset(const u32 vertex_array,
+                                    const u32 vertex_buffer,
+                                    const VertexBufferLayout* vertex_buffer_layout,
+                                    const u64 base_offset)
 {
     vertex_array_bind(vertex_array);
     vertex_buffer_bind(vertex_buffer);
@@ -137,10 +163,22 @@ void vertex_array_add_buffer(const u32 vertex_array, const u32 vertex_buffer,
     for (u32 i = 0; i < vertex_buffer_layout->items.size; ++i)
     {
         const VertexBufferItem* item = vertex_buffer_layout->items.data + i;
-        u64 offset = (u64)item->offset;
+        u64 offset = base_offset + (u64)item->offset;
         glEnableVertexAttribArray(i);
-        glVertexAttribPointer(i, item->count, item->type, GL_FALSE,
-                              vertex_buffer_layout->stride, (void*)offset);
+        if (item->type == GL_UNSIGNED_INT)
+        {
+            glVertexAttribIPointer(i, item->count, item->type,
+                                   vertex_buffer_layout->stride, (void*)offset);
+        }
+        else
+        {
+            glVertexAttribPointer(i, item->count, item->type, GL_FALSE,
+                                  vertex_buffer_layout->stride, (void*)offset);
+        }
+        if (vertex_buffer_layout->divisor)
+        {
+            glVertexAttribDivisor(i, vertex_buffer_layout->divisor);
+        }
     }
 }
 
@@ -155,3 +193,73 @@ void buffer_delete(u32 buffer)
 {
     glDeleteBuffers(1, &buffer);
 }
+
+internal void stream_buffer_wait(GLsync* fence)
+{
+    if (*fence)
+    {
+        GLenum result = glClientWaitSync(*fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      1000000);
+        }
+        glDeleteSync(*fence);
+        *fence = NULL;
+    }
+}
+
+StreamBuffer stream_buffer_create(const u64 segment_size)
+{
+    StreamBuffer stream_buffer = { 0 };
+    stream_buffer.segment_size = segment_size;
+
+    const u64 total_size = segment_size * STREAM_BUFFER_SEGMENT_COUNT;
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &stream_buffer.buffer_id);
+    glNamedBufferStorage(stream_buffer.buffer_id, (GLsizeiptr)total_size, NULL,
+                         flags);
+    stream_buffer.mapped = (u8*)glMapNamedBufferRange(
+        stream_buffer.buffer_id, 0, (GLsizeiptr)total_size, flags);
+    ftic_assert(stream_buffer.mapped);
+
+    return stream_buffer;
+}
+
+void* stream_buffer_begin(StreamBuffer* stream_buffer)
+{
+    stream_buffer_wait(
+        (GLsync*)&stream_buffer->fences[stream_buffer->segment_index]);
+    return stream_buffer->mapped + stream_buffer_offset(stream_buffer);
+}
+
+u64 stream_buffer_offset(const StreamBuffer* stream_buffer)
+{
+    return stream_buffer->segment_index * stream_buffer->segment_size;
+}
+
+void stream_buffer_end(StreamBuffer* stream_buffer)
+{
+    GLsync* fence =
+        (GLsync*)&stream_buffer->fences[stream_buffer->segment_index];
+    if (*fence)
+    {
+        glDeleteSync(*fence);
+    }
+    *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stream_buffer->segment_index =
+        (stream_buffer->segment_index + 1) % STREAM_BUFFER_SEGMENT_COUNT;
+}
+
+void stream_buffer_destroy(StreamBuffer* stream_buffer)
+{
+    for (u32 i = 0; i < STREAM_BUFFER_SEGMENT_COUNT; ++i)
+    {
+        stream_buffer_wait((GLsync*)&stream_buffer->fences[i]);
+    }
+    glUnmapNamedBuffer(stream_buffer->buffer_id);
+    buffer_delete(stream_buffer->buffer_id);
+    *stream_buffer = (StreamBuffer){ 0 };
+}
@@ -19,9 +19,24 @@ typedef struct VertexBufferLayout
 {
     u32 size;
     u32 stride;
+    u32 divisor;
     VertexBufferItemArray items;
 } VertexBufferLayout;
 
+#define STREAM_BUFFER_SEGMENT_COUNT 3
+
+// A persistently mapped buffer split into segments that are written in turn.
+// Each segment is fenced when the frame that used it is submitted, so the cpu
+// only waits if it gets a whole ring ahead of the gpu.
+typedef struct StreamBuffer
+{
+    u32 buffer_id;
+    u32 segment_index;
+    u64 segment_size;
+    u8* mapped;
+    void* fences[STREAM_BUFFER_SEGMENT_COUNT];
+} StreamBuffer;
+
 u32  vertex_buffer_create();
 void vertex_buffer_bind(const u32 vertex_buffer);
 void vertex_buffer_unbind();
@@ -34,7 +49,8 @@ void index_buffer_orphan(u32 index_buffer_id, const u32 new_size, const u32 usag
 
 void vertex_buffer_layout_create(const u32 capacity, const u32 type_size, VertexBufferLayout* vertex_buffer_layout);
 void vertex_buffer_layout_push_float(VertexBufferLayout* vertex_buffer_layout, const u32 count, const u32 offset);
-VertexBufferLayout default_vertex_buffer_layout();
+void vertex_buffer_layout_push_uint(VertexBufferLayout* vertex_buffer_layout, const u32 count, const u32 offset);
+VertexBufferLayout quad_instance_buffer_layout();
 VertexBufferLayout default_vertex_3d_buffer_layout();
 
 u32  vertex_array_create();
@@ -42,5 +58,12 @@ void vertex_array_delete(u32 vertex_array);
 void vertex_array_bind(const u32 vertex_array);
 void vertex_array_unbind();
 void vertex_array_add_buffer(const u32 vertex_array, const u32 vertex_buffer, const VertexBufferLayout* vertex_buffer_layout);
+void vertex_array_add_buffer_offset(const u32 vertex_array, const u32 vertex_buffer, const VertexBufferLayout* vertex_buffer_layout, const u64 base_offset);
 void buffer_set_sub_data(u32 vertex_buffer, u32 target, intptr_t offset, signed long long int size, const void* data);
 void buffer_delete(u32 buffer);
+
+StreamBuffer stream_buffer_create(const u64 segment_size);
+void* stream_buffer_begin(StreamBuffer* stream_buffer);
+u64 stream_buffer_offset(const StreamBuffer* stream_buffer);
+void stream_buffer_end(StreamBuffer* stream_buffer);
+void stream_buffer_destroy(StreamBuffer* stream_buffer);
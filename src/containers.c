@@ -0,0 +1,322 @@
+#include "containers.h"
+#include <stdlib.h>
+#include <string.h>
+// @save
+
+// This code is generated
+
+#define value_order(value1, value2) (((value1) > (value2)) - ((value1) < (value2)))
+
+internal u32 round_up_power_of_two(u32 capacity)
+{
+    capacity--;
+    capacity |= capacity >> 1;
+    capacity |= capacity >> 2;
+    capacity |= capacity >> 4;
+    capacity |= capacity >> 8;
+    capacity |= capacity >> 16;
+    return capacity + 1;
+}
+
+// @end
+
+void small_vector_init_u32(SmallVectorU32* vector)
+{
+    vector->size = 0;
+    vector->capacity = 16;
+    vector->heap = NULL;
+}
+
+u32* small_vector_data_u32(SmallVectorU32* vector)
+{
+    return vector->heap ? vector->heap : vector->inline_data;
+}
+
+void small_vector_push_u32(SmallVectorU32* vector, u32 value)
+{
+    if (vector->size == vector->capacity)
+    {
+        const u32 capacity = vector->capacity * 2;
+        if (vector->heap)
+        {
+            vector->heap = (u32*)realloc(vector->heap, capacity * sizeof(u32));
+        }
+        else
+        {
+            vector->heap = (u32*)malloc(capacity * sizeof(u32));
+            memcpy(vector->heap, vector->inline_data, vector->size * sizeof(u32));
+        }
+        vector->capacity = capacity;
+    }
+    u32* data = vector->heap ? vector->heap : vector->inline_data;
+    data[vector->size++] = value;
+}
+
+void small_vector_free_u32(SmallVectorU32* vector)
+{
+    free(vector->heap);
+    vector->heap = NULL;
+    vector->size = 0;
+    vector->capacity = 16;
+}
+
+RingBufferU32 ring_buffer_create_u32(u32 capacity)
+{
+    capacity = ftic_max(round_up_power_of_two(capacity), 2);
+    RingBufferU32 out = {
+        .data = (u32*)calloc(capacity, sizeof(u32)),
+        .capacity = capacity,
+    };
+    return out;
+}
+
+RingBufferU64 ring_buffer_create_u64(u32 capacity)
+{
+    capacity = ftic_max(round_up_power_of_two(capacity), 2);
+    RingBufferU64 out = {
+        .data = (u64*)calloc(capacity, sizeof(u64)),
+        .capacity = capacity,
+    };
+    return out;
+}
+
+b8 ring_buffer_push_u32(RingBufferU32* ring, u32 value)
+{
+    if (ring->tail - ring->head == ring->capacity)
+    {
+        return false;
+    }
+    ring->data[ring->tail++ & (ring->capacity - 1)] = value;
+    return true;
+}
+
+b8 ring_buffer_push_u64(RingBufferU64* ring, u64 value)
+{
+    if (ring->tail - ring->head == ring->capacity)
+    {
+        return false;
+    }
+    ring->data[ring->tail++ & (ring->capacity - 1)] = value;
+    return true;
+}
+
+b8 ring_buffer_pop_u32(RingBufferU32* ring, u32* value)
+{
+    if (ring->tail == ring->head)
+    {
+        return false;
+    }
+    *value = ring->data[ring->head++ & (ring->capacity - 1)];
+    return true;
+}
+
+b8 ring_buffer_pop_u64(RingBufferU64* ring, u64* value)
+{
+    if (ring->tail == ring->head)
+    {
+        return false;
+    }
+    *value = ring->data[ring->head++ & (ring->capacity - 1)];
+    return true;
+}
+
+u32 ring_buffer_size_u32(RingBufferU32* ring)
+{
+    return ring->tail - ring->head;
+}
+
+u32 ring_buffer_size_u64(RingBufferU64* ring)
+{
+    return ring->tail - ring->head;
+}
+
+void ring_buffer_free_u32(RingBufferU32* ring)
+{
+    free(ring->data);
+    ring->data = NULL;
+    ring->capacity = 0;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+void ring_buffer_free_u64(RingBufferU64* ring)
+{
+    free(ring->data);
+    ring->data = NULL;
+    ring->capacity = 0;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+PoolListU64 pool_list_create_u64(u32 capacity)
+{
+    capacity = ftic_max(capacity, 16);
+    PoolListU64 out = {
+        .nodes = (PoolListNodeU64*)calloc(capacity, sizeof(PoolListNodeU64)),
+        .capacity = capacity,
+        .head = POOL_LIST_NONE,
+        .tail = POOL_LIST_NONE,
+        .free_head = 0,
+    };
+    for (u32 i = 0; i < capacity; ++i)
+    {
+        out.nodes[i].next = i + 1 < capacity ? i + 1 : POOL_LIST_NONE;
+    }
+    return out;
+}
+
+u32 pool_list_push_back_u64(PoolListU64* list, u64 value)
+{
+    if (list->free_head == POOL_LIST_NONE)
+    {
+        const u32 old_capacity = list->capacity;
+        list->capacity *= 2;
+        list->nodes =
+            (PoolListNodeU64*)realloc(list->nodes, list->capacity * sizeof(PoolListNodeU64));
+        for (u32 i = old_capacity; i < list->capacity; ++i)
+        {
+            list->nodes[i].next = i + 1 < list->capacity ? i + 1 : POOL_LIST_NONE;
+        }
+        list->free_head = old_capacity;
+    }
+    const u32 handle = list->free_head;
+    PoolListNodeU64* node = list->nodes + handle;
+    list->free_head = node->next;
+
+    node->value = value;
+    node->next = POOL_LIST_NONE;
+    node->prev = list->tail;
+    if (list->tail != POOL_LIST_NONE)
+    {
+        list->nodes[list->tail].next = handle;
+    }
+    else
+    {
+        list->head = handle;
+    }
+    list->tail = handle;
+    list->size++;
+    return handle;
+}
+
+void pool_list_remove_u64(PoolListU64* list, u32 handle)
+{
+    PoolListNodeU64* node = list->nodes + handle;
+    if (node->prev != POOL_LIST_NONE)
+    {
+        list->nodes[node->prev].next = node->next;
+    }
+    else
+    {
+        list->head = node->next;
+    }
+    if (node->next != POOL_LIST_NONE)
+    {
+        list->nodes[node->next].prev = node->prev;
+    }
+    else
+    {
+        list->tail = node->prev;
+    }
+    node->next = list->free_head;
+    list->free_head = handle;
+    list->size--;
+}
+
+void pool_list_free_u64(PoolListU64* list)
+{
+    free(list->nodes);
+    list->nodes = NULL;
+    list->size = 0;
+    list->capacity = 0;
+    list->head = POOL_LIST_NONE;
+    list->tail = POOL_LIST_NONE;
+    list->free_head = POOL_LIST_NONE;
+}
+
+FlatMapU64U32 flat_map_create_u64_u32(u32 capacity)
+{
+    capacity = ftic_max(capacity, 16);
+    FlatMapU64U32 out = {
+        .keys = (u64*)calloc(capacity, sizeof(u64)),
+        .values = (u32*)calloc(capacity, sizeof(u32)),
+        .capacity = capacity,
+    };
+    return out;
+}
+
+void flat_map_free_u64_u32(FlatMapU64U32* map)
+{
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->size = 0;
+    map->capacity = 0;
+}
+
+u32 flat_map_lower_bound_u64_u32(FlatMapU64U32* map, const u64 key)
+{
+    u32 low = 0;
+    u32 high = map->size;
+    while (low < high)
+    {
+        const u32 middle = low + ((high - low) >> 1);
+        if (value_order(map->keys[middle], key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void flat_map_insert_u64_u32(FlatMapU64U32* map, u64 key, u32 value)
+{
+    const u32 index = flat_map_lower_bound_u64_u32(map, key);
+    if (index < map->size && value_order(map->keys[index], key) == 0)
+    {
+        map->values[index] = value;
+        return;
+    }
+    if (map->size == map->capacity)
+    {
+        map->capacity *= 2;
+        map->keys = (u64*)realloc(map->keys, map->capacity * sizeof(u64));
+        map->values = (u32*)realloc(map->values, map->capacity * sizeof(u32));
+    }
+    const u32 to_move = map->size - index;
+    memmove(map->keys + index + 1, map->keys + index, to_move * sizeof(u64));
+    memmove(map->values + index + 1, map->values + index, to_move * sizeof(u32));
+    map->keys[index] = key;
+    map->values[index] = value;
+    map->size++;
+}
+
+u32* flat_map_get_u64_u32(FlatMapU64U32* map, const u64 key)
+{
+    const u32 index = flat_map_lower_bound_u64_u32(map, key);
+    if (index < map->size && value_order(map->keys[index], key) == 0)
+    {
+        return map->values + index;
+    }
+    return NULL;
+}
+
+b8 flat_map_remove_u64_u32(FlatMapU64U32* map, const u64 key)
+{
+    const u32 index = flat_map_lower_bound_u64_u32(map, key);
+    if (index == map->size || value_order(map->keys[index], key) != 0)
+    {
+        return false;
+    }
+    const u32 to_move = map->size - index - 1;
+    memmove(map->keys + index, map->keys + index + 1, to_move * sizeof(u64));
+    memmove(map->values + index, map->values + index + 1, to_move * sizeof(u32));
+    map->size--;
+    return true;
+}
+
@@ -0,0 +1,109 @@
+#pragma once
+#include "define.h"
+#include "ftic_guid.h"
+// @save
+
+// This code is generated, add types in code_generation/src/main.c
+
+#define POOL_LIST_NONE 0xFFFFFFFF
+
+// @end
+
+typedef struct SmallVectorU32
+{
+    u32 size;
+    u32 capacity;
+    u32* heap;
+    u32 inline_data[16];
+} SmallVectorU32;
+
+void small_vector_init_u32(SmallVectorU32* vector);
+
+u32* small_vector_data_u32(SmallVectorU32* vector);
+
+void small_vector_push_u32(SmallVectorU32* vector, u32 value);
+
+void small_vector_free_u32(SmallVectorU32* vector);
+
+typedef struct RingBufferU32
+{
+    u32* data;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+} RingBufferU32;
+
+typedef struct RingBufferU64
+{
+    u64* data;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+} RingBufferU64;
+
+RingBufferU32 ring_buffer_create_u32(u32 capacity);
+
+RingBufferU64 ring_buffer_create_u64(u32 capacity);
+
+b8 ring_buffer_push_u32(RingBufferU32* ring, u32 value);
+
+b8 ring_buffer_push_u64(RingBufferU64* ring, u64 value);
+
+b8 ring_buffer_pop_u32(RingBufferU32* ring, u32* value);
+
+b8 ring_buffer_pop_u64(RingBufferU64* ring, u64* value);
+
+u32 ring_buffer_size_u32(RingBufferU32* ring);
+
+u32 ring_buffer_size_u64(RingBufferU64* ring);
+
+void ring_buffer_free_u32(RingBufferU32* ring);
+
+void ring_buffer_free_u64(RingBufferU64* ring);
+
+typedef struct PoolListNodeU64
+{
+    u64 value;
+    u32 next;
+    u32 prev;
+} PoolListNodeU64;
+
+typedef struct PoolListU64
+{
+    PoolListNodeU64* nodes;
+    u32 size;
+    u32 capacity;
+    u32 head;
+    u32 tail;
+    u32 free_head;
+} PoolListU64;
+
+PoolListU64 pool_list_create_u64(u32 capacity);
+
+u32 pool_list_push_back_u64(PoolListU64* list, u64 value);
+
+void pool_list_remove_u64(PoolListU64* list, u32 handle);
+
+void pool_list_free_u64(PoolListU64* list);
+
+typedef struct FlatMapU64U32
+{
+    u64* keys;
+    u32* values;
+    u32 size;
+    u32 capacity;
+
+} FlatMapU64U32;
+
+FlatMapU64U32 flat_map_create_u64_u32(u32 capacity);
+
+void flat_map_free_u64_u32(FlatMapU64U32* map);
+
+u32 flat_map_lower_bound_u64_u32(FlatMapU64U32* map, const u64 key);
+
+void flat_map_insert_u64_u32(FlatMapU64U32* map, u64 key, u32 value);
+
+u32* flat_map_get_u64_u32(FlatMapU64U32* map, const u64 key);
+
+b8 flat_map_remove_u64_u32(FlatMapU64U32* map, const u64 key);
+
@@ -0,0 +1,1022 @@
+#include "content_index.h"
+#include "content_search.h"
+#include "hash.h"
+#include "hash_table.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONTENT_INDEX_NONE 0xFFFFFFFFu
+#define CONTENT_INDEX_TRIGRAM_COUNT (1u << 24)
+
+typedef struct IndexedFile
+{
+    char* path;
+    u64 size;
+    u64 last_write_time;
+} IndexedFile;
+
+typedef struct IndexedFileArray
+{
+    u32 size;
+    u32 capacity;
+    IndexedFile* data;
+} IndexedFileArray;
+
+// Postings of the files read in a build round, delta coded like on disk.
+typedef struct TrigramPostings
+{
+    u32 trigram;
+    u32 count;
+    u32 last;
+    u32 size;
+    u32 capacity;
+    u8* bytes;
+} TrigramPostings;
+
+typedef struct TrigramPostingsArray
+{
+    u32 size;
+    u32 capacity;
+    TrigramPostings* data;
+} TrigramPostingsArray;
+
+typedef struct ContentIndexTrigramArray
+{
+    u32 size;
+    u32 capacity;
+    ContentIndexTrigram* data;
+} ContentIndexTrigramArray;
+
+typedef struct ContentIndexBuilder
+{
+    HashTableUU64 lookup; // Trigram to index into postings
+    TrigramPostingsArray postings;
+    u64* seen;              // Bit per trigram, for the file being read
+    U32Array file_trigrams; // The bits set in seen
+    u64 posting_bytes;
+} ContentIndexBuilder;
+
+typedef struct PostingReader
+{
+    const u8* at;
+    u32 left;
+    u32 file;
+} PostingReader;
+
+typedef struct ContentIndexBuildTask
+{
+    ContentIndexService* service;
+    ContentIndexRoot* root;
+} ContentIndexBuildTask;
+
+internal u8 trigram_lower(u8 character)
+{
+    return character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+}
+
+internal u32 varint_write(u8* out, u32 value)
+{
+    u32 written = 0;
+    while (value >= 0x80)
+    {
+        out[written++] = (u8)(value | 0x80);
+        value >>= 7;
+    }
+    out[written++] = (u8)value;
+    return written;
+}
+
+internal const u8* varint_read(const u8* in, u32* value)
+{
+    u32 result = 0;
+    u32 shift = 0;
+    while (*in & 0x80)
+    {
+        result |= (u32)(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    *value = result | ((u32)*in++ << shift);
+    return in;
+}
+
+internal PostingReader posting_reader(const u8* postings, const ContentIndexTrigram* trigram)
+{
+    PostingReader reader = { 0 };
+    if (trigram)
+    {
+        reader.at = postings + trigram->offset;
+        reader.left = trigram->count;
+    }
+    return reader;
+}
+
+// Every id is stored as the difference to the one before it, the first as
+// the difference to zero.
+internal b8 posting_next(PostingReader* reader)
+{
+    if (!reader->left)
+    {
+        return false;
+    }
+    u32 delta = 0;
+    reader->at = varint_read(reader->at, &delta);
+    reader->file += delta;
+    --reader->left;
+    return true;
+}
+
+internal int compare_indexed_files(const void* first, const void* second)
+{
+    return strcmp(((const IndexedFile*)first)->path, ((const IndexedFile*)second)->path);
+}
+
+internal int compare_trigram_postings(const void* first, const void* second)
+{
+    const u32 a = ((const TrigramPostings*)first)->trigram;
+    const u32 b = ((const TrigramPostings*)second)->trigram;
+    return (a > b) - (a < b);
+}
+
+internal int compare_trigram_count(const void* first, const void* second)
+{
+    const u32 a = (*(const ContentIndexTrigram**)first)->count;
+    const u32 b = (*(const ContentIndexTrigram**)second)->count;
+    return (a > b) - (a < b);
+}
+
+b8 content_index_open(const char* path, ContentIndex* index)
+{
+    memset(index, 0, sizeof(ContentIndex));
+    if (!platform_map_file(path, &index->mapping))
+    {
+        return false;
+    }
+    const u64 size = index->mapping.size;
+    const ContentIndexHeader* header = (const ContentIndexHeader*)index->mapping.data;
+    const b8 valid =
+        size >= sizeof(ContentIndexHeader) && header->magic == CONTENT_INDEX_MAGIC &&
+        header->version == CONTENT_INDEX_VERSION &&
+        header->paths_offset ==
+            sizeof(ContentIndexHeader) + (u64)header->file_count * sizeof(ContentIndexFile) &&
+        header->paths_offset <= header->postings_offset &&
+        header->postings_offset <= header->trigrams_offset && header->trigrams_offset % 8 == 0 &&
+        header->trigrams_offset + (u64)header->trigram_count * sizeof(ContentIndexTrigram) ==
+            size;
+    if (!valid)
+    {
+        platform_unmap_file(&index->mapping);
+        return false;
+    }
+    index->header = header;
+    index->files = (const ContentIndexFile*)(index->mapping.data + sizeof(ContentIndexHeader));
+    index->paths = (const char*)index->mapping.data + header->paths_offset;
+    index->postings = index->mapping.data + header->postings_offset;
+    index->trigrams = (const ContentIndexTrigram*)(index->mapping.data + header->trigrams_offset);
+    return true;
+}
+
+void content_index_close(ContentIndex* index)
+{
+    if (index->header)
+    {
+        platform_unmap_file(&index->mapping);
+    }
+    memset(index, 0, sizeof(ContentIndex));
+}
+
+const char* content_index_file_path(const ContentIndex* index, u32 file)
+{
+    return index->paths + index->files[file].path_offset;
+}
+
+internal const ContentIndexTrigram* content_index_find_trigram(const ContentIndex* index,
+                                                               u32 trigram)
+{
+    u32 low = 0;
+    u32 high = index->header->trigram_count;
+    while (low < high)
+    {
+        const u32 middle = low + (high - low) / 2;
+        if (index->trigrams[middle].trigram < trigram)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low < index->header->trigram_count && index->trigrams[low].trigram == trigram
+               ? index->trigrams + low
+               : NULL;
+}
+
+// First file whose path compares greater than or equal to (or, with after,
+// greater than) prefix when only its first prefix_length characters count.
+internal u32 content_index_prefix_bound(const ContentIndex* index, const char* prefix,
+                                        u32 prefix_length, b8 after)
+{
+    u32 low = 0;
+    u32 high = index->header->file_count;
+    while (low < high)
+    {
+        const u32 middle = low + (high - low) / 2;
+        const int compare =
+            strncmp(content_index_file_path(index, middle), prefix, prefix_length);
+        if (compare < 0 || (after && compare == 0))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+internal void content_index_walk(const char* root, FTicAtomic* stop, IndexedFileArray* files)
+{
+    CharPtrArray stack = { 0 };
+    array_create(&stack, 32);
+    array_push(&stack, string_copy_d(root));
+
+    PlatformFileEntryArray entries = { 0 };
+    array_create(&entries, 64);
+    while (stack.size && !ftic_atomic_load(stop))
+    {
+        char* path = stack.data[--stack.size];
+        entries.size = 0;
+        platform_list_directory_entries(path, &entries);
+        free(path);
+
+        for (u32 i = 0; i < entries.size; ++i)
+        {
+            PlatformFileEntry* entry = entries.data + i;
+            if (entry->directory && !entry->link)
+            {
+                array_push(&stack, entry->path);
+            }
+            else if (!entry->directory)
+            {
+                const IndexedFile file = {
+                    .path = entry->path,
+                    .size = entry->size,
+                    .last_write_time = entry->last_write_time,
+                };
+                array_push(files, file);
+            }
+            else
+            {
+                free(entry->path);
+            }
+        }
+    }
+    for (u32 i = 0; i < stack.size; ++i)
+    {
+        free(stack.data[i]);
+    }
+    free(stack.data);
+    free(entries.data);
+}
+
+internal void content_index_builder_create(ContentIndexBuilder* builder)
+{
+    builder->lookup = hash_table_create_uu64(4096, hash_u64);
+    array_create(&builder->postings, 4096);
+    builder->seen = (u64*)calloc(CONTENT_INDEX_TRIGRAM_COUNT / 64, sizeof(u64));
+    array_create(&builder->file_trigrams, 4096);
+    builder->posting_bytes = 0;
+}
+
+internal void content_index_builder_clear(ContentIndexBuilder* builder)
+{
+    for (u32 i = 0; i < builder->postings.size; ++i)
+    {
+        free(builder->postings.data[i].bytes);
+    }
+    builder->postings.size = 0;
+    hash_table_clear_uu64(&builder->lookup);
+    builder->posting_bytes = 0;
+}
+
+internal void content_index_builder_destroy(ContentIndexBuilder* builder)
+{
+    content_index_builder_clear(builder);
+    array_free(&builder->postings);
+    hash_table_free_uu64(&builder->lookup);
+    free(builder->seen);
+    array_free(&builder->file_trigrams);
+}
+
+// Files are added in id order, so every list stays sorted.
+internal void content_index_builder_add(ContentIndexBuilder* builder, const u8* data, u64 size,
+                                        u32 file)
+{
+    if (size < 3)
+    {
+        return;
+    }
+    u64* seen = builder->seen;
+    u32 trigram = ((u32)trigram_lower(data[0]) << 8) | trigram_lower(data[1]);
+    for (u64 i = 2; i < size; ++i)
+    {
+        trigram = ((trigram << 8) | trigram_lower(data[i])) & (CONTENT_INDEX_TRIGRAM_COUNT - 1);
+        const u64 bit = 1ull << (trigram & 63);
+        if (!(seen[trigram >> 6] & bit))
+        {
+            seen[trigram >> 6] |= bit;
+            array_push(&builder->file_trigrams, trigram);
+        }
+    }
+
+    for (u32 i = 0; i < builder->file_trigrams.size; ++i)
+    {
+        trigram = builder->file_trigrams.data[i];
+        seen[trigram >> 6] = 0;
+
+        TrigramPostings* postings = NULL;
+        u64* slot = hash_table_get_uu64(&builder->lookup, trigram);
+        if (slot)
+        {
+            postings = builder->postings.data + *slot;
+        }
+        else
+        {
+            const TrigramPostings new_postings = { .trigram = trigram };
+            array_push(&builder->postings, new_postings);
+            hash_table_insert_uu64(&builder->lookup, trigram, builder->postings.size - 1);
+            postings = array_back(&builder->postings);
+        }
+        if (postings->size + 5 > postings->capacity)
+        {
+            postings->capacity = ftic_max(postings->capacity * 2, 16u);
+            postings->bytes = (u8*)realloc(postings->bytes, postings->capacity);
+        }
+        const u32 written = varint_write(postings->bytes + postings->size, file - postings->last);
+        postings->size += written;
+        postings->last = file;
+        ++postings->count;
+        builder->posting_bytes += written;
+    }
+    builder->file_trigrams.size = 0;
+}
+
+typedef struct PostingWriter
+{
+    FILE* file;
+    u8* buffer;
+    u32 size;
+    u32 capacity;
+    u32 count;
+    u32 last;
+    u64 offset;
+    b8 failed;
+} PostingWriter;
+
+internal void posting_writer_add(PostingWriter* writer, u32 file)
+{
+    if (writer->size + 5 > writer->capacity)
+    {
+        writer->capacity = ftic_max(writer->capacity * 2, 4096u);
+        writer->buffer = (u8*)realloc(writer->buffer, writer->capacity);
+    }
+    writer->size += varint_write(writer->buffer + writer->size, file - writer->last);
+    writer->last = file;
+    ++writer->count;
+}
+
+// Writes the list that was added since the last call under trigram.
+internal void posting_writer_end(PostingWriter* writer, u32 trigram,
+                                 ContentIndexTrigramArray* trigrams)
+{
+    if (writer->count)
+    {
+        const ContentIndexTrigram entry = {
+            .trigram = trigram,
+            .count = writer->count,
+            .offset = writer->offset,
+        };
+        array_push(trigrams, entry);
+        writer->failed |= fwrite(writer->buffer, 1, writer->size, writer->file) != writer->size;
+        writer->offset += writer->size;
+    }
+    writer->size = 0;
+    writer->count = 0;
+    writer->last = 0;
+}
+
+// The files carried over get their postings from source, the others from
+// the builder. Both are sorted on path, so mapping the old ids to the new
+// ones keeps the lists sorted and the two sets never share a file.
+internal b8 content_index_write(const char* path, const IndexedFileArray* files,
+                                const u32* carried_from, const b8* unindexed,
+                                const ContentIndex* source, ContentIndexBuilder* builder)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    const u32 source_file_count = source->header ? source->header->file_count : 0;
+    const u32 source_trigram_count = source->header ? source->header->trigram_count : 0;
+    u32* old_to_new = (u32*)malloc((source_file_count + 1) * sizeof(u32));
+    memset(old_to_new, 0xFF, (source_file_count + 1) * sizeof(u32));
+    for (u32 i = 0; i < files->size; ++i)
+    {
+        if (carried_from[i] != CONTENT_INDEX_NONE)
+        {
+            old_to_new[carried_from[i]] = i;
+        }
+    }
+
+    ContentIndexHeader header = {
+        .magic = CONTENT_INDEX_MAGIC,
+        .version = CONTENT_INDEX_VERSION,
+        .file_count = files->size,
+    };
+    b8 failed = fwrite(&header, sizeof(header), 1, file) != 1;
+
+    u32 path_offset = 0;
+    for (u32 i = 0; i < files->size; ++i)
+    {
+        const ContentIndexFile entry = {
+            .last_write_time = files->data[i].last_write_time,
+            .size = files->data[i].size,
+            .path_offset = path_offset,
+            .unindexed = unindexed[i],
+        };
+        failed |= fwrite(&entry, sizeof(entry), 1, file) != 1;
+        path_offset += (u32)strlen(files->data[i].path) + 1;
+    }
+    for (u32 i = 0; i < files->size; ++i)
+    {
+        const char* file_path = files->data[i].path;
+        const size_t length = strlen(file_path) + 1;
+        failed |= fwrite(file_path, 1, length, file) != length;
+    }
+    header.paths_offset = sizeof(header) + (u64)files->size * sizeof(ContentIndexFile);
+    header.postings_offset = header.paths_offset + path_offset;
+
+    qsort(builder->postings.data, builder->postings.size, sizeof(TrigramPostings),
+          compare_trigram_postings);
+
+    ContentIndexTrigramArray trigrams = { 0 };
+    array_create(&trigrams, source_trigram_count + builder->postings.size + 1);
+    PostingWriter writer = { .file = file };
+
+    u32 source_index = 0;
+    u32 builder_index = 0;
+    for (;;)
+    {
+        const ContentIndexTrigram* old_trigram = NULL;
+        if (source_index < source_trigram_count &&
+            source->trigrams[source_index].trigram != CONTENT_INDEX_UNINDEXED)
+        {
+            old_trigram = source->trigrams + source_index;
+        }
+        const TrigramPostings* new_trigram =
+            builder_index < builder->postings.size ? builder->postings.data + builder_index : NULL;
+        if (!old_trigram && !new_trigram)
+        {
+            break;
+        }
+        u32 trigram = 0;
+        if (old_trigram && (!new_trigram || old_trigram->trigram <= new_trigram->trigram))
+        {
+            trigram = old_trigram->trigram;
+            ++source_index;
+        }
+        else
+        {
+            old_trigram = NULL;
+        }
+        if (new_trigram && (!old_trigram || new_trigram->trigram == trigram))
+        {
+            trigram = new_trigram->trigram;
+            ++builder_index;
+        }
+        else
+        {
+            new_trigram = NULL;
+        }
+
+        PostingReader old_reader = posting_reader(source->postings, old_trigram);
+        PostingReader new_reader = { 0 };
+        if (new_trigram)
+        {
+            new_reader.at = new_trigram->bytes;
+            new_reader.left = new_trigram->count;
+        }
+        u32 old_file = CONTENT_INDEX_NONE;
+        while (posting_next(&old_reader))
+        {
+            if ((old_file = old_to_new[old_reader.file]) != CONTENT_INDEX_NONE)
+            {
+                break;
+            }
+        }
+        u32 new_file = posting_next(&new_reader) ? new_reader.file : CONTENT_INDEX_NONE;
+        while (old_file != CONTENT_INDEX_NONE || new_file != CONTENT_INDEX_NONE)
+        {
+            if (old_file < new_file)
+            {
+                posting_writer_add(&writer, old_file);
+                old_file = CONTENT_INDEX_NONE;
+                while (posting_next(&old_reader))
+                {
+                    if ((old_file = old_to_new[old_reader.file]) != CONTENT_INDEX_NONE)
+                    {
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                posting_writer_add(&writer, new_file);
+                new_file = posting_next(&new_reader) ? new_reader.file : CONTENT_INDEX_NONE;
+            }
+        }
+        posting_writer_end(&writer, trigram, &trigrams);
+    }
+    for (u32 i = 0; i < files->size; ++i)
+    {
+        if (unindexed[i])
+        {
+            posting_writer_add(&writer, i);
+        }
+    }
+    posting_writer_end(&writer, CONTENT_INDEX_UNINDEXED, &trigrams);
+
+    const u8 padding[8] = { 0 };
+    const u64 postings_end = header.postings_offset + writer.offset;
+    const u32 padding_size = (u32)((8 - postings_end % 8) % 8);
+    failed |= fwrite(padding, 1, padding_size, file) != padding_size;
+    header.trigrams_offset = postings_end + padding_size;
+    header.trigram_count = trigrams.size;
+    failed |= fwrite(trigrams.data, sizeof(ContentIndexTrigram), trigrams.size, file) !=
+              trigrams.size;
+    failed |= writer.failed;
+    failed |= fseek(file, 0, SEEK_SET) != 0;
+    failed |= fwrite(&header, sizeof(header), 1, file) != 1;
+    failed |= fclose(file) != 0;
+
+    free(writer.buffer);
+    array_free(&trigrams);
+    free(old_to_new);
+    if (failed)
+    {
+        platform_delete_file(path);
+    }
+    return !failed;
+}
+
+// The files to read are read in rounds of at most CONTENT_INDEX_BUILD_BUDGET
+// postings. A round that has to leave files for later writes what it has to
+// a scratch index, which the next round carries over like a previous index.
+b8 content_index_build(const char* root, const ContentIndex* previous, const char* path,
+                       FTicAtomic* stop, ContentIndexBuildStats* stats)
+{
+    PROFILE_FUNCTION_BEGIN();
+    ContentIndexBuildStats build_stats = { 0 };
+
+    IndexedFileArray files = { 0 };
+    array_create(&files, 1024);
+    content_index_walk(root, stop, &files);
+    qsort(files.data, files.size, sizeof(IndexedFile), compare_indexed_files);
+    build_stats.file_count = files.size;
+
+    u32* carried_from = (u32*)malloc((files.size + 1) * sizeof(u32));
+    b8* unindexed = (b8*)calloc(files.size + 1, sizeof(b8));
+    const u32 previous_count = previous && previous->header ? previous->header->file_count : 0;
+    for (u32 i = 0, j = 0; i < files.size; ++i)
+    {
+        carried_from[i] = CONTENT_INDEX_NONE;
+        int compare = -1;
+        while (j < previous_count &&
+               (compare = strcmp(content_index_file_path(previous, j), files.data[i].path)) < 0)
+        {
+            ++j;
+        }
+        if (j < previous_count && compare == 0)
+        {
+            const ContentIndexFile* entry = previous->files + j;
+            if (!entry->unindexed && entry->size == files.data[i].size &&
+                entry->last_write_time == files.data[i].last_write_time)
+            {
+                carried_from[i] = j;
+            }
+        }
+    }
+
+    ContentIndexBuilder builder = { 0 };
+    content_index_builder_create(&builder);
+    ContentIndex source = { 0 };
+    if (previous_count)
+    {
+        source = *previous;
+    }
+    ContentIndex scratch = { 0 };
+    char scratch_paths[2][FTIC_MAX_PATH] = { 0 };
+    sprintf_s(scratch_paths[0], FTIC_MAX_PATH, "%s.0", path);
+    sprintf_s(scratch_paths[1], FTIC_MAX_PATH, "%s.1", path);
+
+    b8 result = false;
+    for (;;)
+    {
+        b8 pending = false;
+        for (u32 i = 0; i < files.size; ++i)
+        {
+            unindexed[i] = false;
+            if (carried_from[i] != CONTENT_INDEX_NONE)
+            {
+                continue;
+            }
+            const IndexedFile* file = files.data + i;
+            if (file->size > CONTENT_INDEX_MAX_FILE_SIZE)
+            {
+                unindexed[i] = true;
+                continue;
+            }
+            if (builder.posting_bytes >= CONTENT_INDEX_BUILD_BUDGET || ftic_atomic_load(stop))
+            {
+                unindexed[i] = true;
+                pending = true;
+                continue;
+            }
+            PlatformFileMapping mapping = { 0 };
+            if (!platform_map_file(file->path, &mapping))
+            {
+                // Locked or gone, the search will try it.
+                unindexed[i] = true;
+                continue;
+            }
+            if (mapping.size && !content_search_is_binary(mapping.data, mapping.size))
+            {
+                content_index_builder_add(&builder, mapping.data, mapping.size, i);
+                build_stats.bytes_read += mapping.size;
+            }
+            platform_unmap_file(&mapping);
+            ++build_stats.files_read;
+        }
+        if (ftic_atomic_load(stop))
+        {
+            break;
+        }
+
+        const char* round_path = pending ? scratch_paths[build_stats.rounds % 2] : path;
+        ++build_stats.rounds;
+        const b8 written =
+            content_index_write(round_path, &files, carried_from, unindexed, &source, &builder);
+        content_index_builder_clear(&builder);
+        content_index_close(&scratch);
+        if (!written || !pending)
+        {
+            result = written;
+            break;
+        }
+        if (!content_index_open(round_path, &scratch))
+        {
+            break;
+        }
+        source = scratch;
+        for (u32 i = 0; i < files.size; ++i)
+        {
+            carried_from[i] = unindexed[i] ? CONTENT_INDEX_NONE : i;
+        }
+    }
+    content_index_close(&scratch);
+    platform_delete_file(scratch_paths[0]);
+    platform_delete_file(scratch_paths[1]);
+    content_index_builder_destroy(&builder);
+
+    for (u32 i = 0; i < files.size; ++i)
+    {
+        free(files.data[i].path);
+    }
+    array_free(&files);
+    free(carried_from);
+    free(unindexed);
+    if (stats)
+    {
+        *stats = build_stats;
+    }
+    PROFILE_END();
+    return result;
+}
+
+b8 content_index_query(const ContentIndex* index, const char* directory, const char* pattern,
+                       u32 pattern_length, U32Array* candidates)
+{
+    if (!index->header || pattern_length < 3 || pattern_length > CONTENT_SEARCH_MAX_PATTERN)
+    {
+        return false;
+    }
+
+    // Only the files below directory, which are next to each other.
+    const u32 directory_length = directory ? (u32)strlen(directory) : 0;
+    u32 first = 0;
+    u32 end = index->header->file_count;
+    b8 needs_separator = false;
+    if (directory_length)
+    {
+        first = content_index_prefix_bound(index, directory, directory_length, false);
+        end = content_index_prefix_bound(index, directory, directory_length, true);
+        const char last = directory[directory_length - 1];
+        needs_separator = last != '\\' && last != '/';
+    }
+
+    const ContentIndexTrigram* lists[CONTENT_SEARCH_MAX_PATTERN] = { 0 };
+    u32 list_count = 0;
+    b8 missing = false;
+    u32 trigram = ((u32)trigram_lower((u8)pattern[0]) << 8) | trigram_lower((u8)pattern[1]);
+    for (u32 i = 2; i < pattern_length && !missing; ++i)
+    {
+        trigram = ((trigram << 8) | trigram_lower((u8)pattern[i])) &
+                  (CONTENT_INDEX_TRIGRAM_COUNT - 1);
+        const ContentIndexTrigram* list = content_index_find_trigram(index, trigram);
+        missing = list == NULL;
+        b8 duplicate = false;
+        for (u32 j = 0; j < list_count && !duplicate; ++j)
+        {
+            duplicate = lists[j] == list;
+        }
+        if (!missing && !duplicate)
+        {
+            lists[list_count++] = list;
+        }
+    }
+
+    const u32 start = candidates->size;
+    if (!missing)
+    {
+        // Shortest list first, the others only have to be read until they
+        // pass the last file still left.
+        qsort(lists, list_count, sizeof(lists[0]), compare_trigram_count);
+        PostingReader reader = posting_reader(index->postings, lists[0]);
+        while (posting_next(&reader) && reader.file < end)
+        {
+            if (reader.file >= first)
+            {
+                array_push(candidates, reader.file);
+            }
+        }
+        for (u32 i = 1; i < list_count && candidates->size > start; ++i)
+        {
+            reader = posting_reader(index->postings, lists[i]);
+            b8 more = posting_next(&reader);
+            u32 kept = start;
+            for (u32 j = start; j < candidates->size && more; ++j)
+            {
+                const u32 candidate = candidates->data[j];
+                while (more && reader.file < candidate)
+                {
+                    more = posting_next(&reader);
+                }
+                if (more && reader.file == candidate)
+                {
+                    candidates->data[kept++] = candidate;
+                }
+            }
+            candidates->size = kept;
+        }
+    }
+
+    PostingReader reader =
+        posting_reader(index->postings, content_index_find_trigram(index, CONTENT_INDEX_UNINDEXED));
+    while (posting_next(&reader) && reader.file < end)
+    {
+        if (reader.file >= first)
+        {
+            array_push(candidates, reader.file);
+        }
+    }
+
+    if (needs_separator)
+    {
+        u32 kept = start;
+        for (u32 i = start; i < candidates->size; ++i)
+        {
+            const char separator =
+                content_index_file_path(index, candidates->data[i])[directory_length];
+            if (separator == '\\' || separator == '/')
+            {
+                candidates->data[kept++] = candidates->data[i];
+            }
+        }
+        candidates->size = kept;
+    }
+    return true;
+}
+
+internal THREAD_TASK_ENTRY_POINT(content_index_build_task)
+{
+    ContentIndexBuildTask* task = (ContentIndexBuildTask*)data;
+    ContentIndexRoot* root = task->root;
+    // Listening before the walk, a change during the build builds again.
+    // Setting up the listener walks the tree as well, which is why it is done
+    // here and not on the thread that updates the service.
+    if (!root->change_handle)
+    {
+        root->change_handle = directory_listen_to_tree_changes(root->path);
+    }
+    ContentIndexBuildStats stats = { 0 };
+    const b8 built = content_index_build(root->path, &root->index, root->built_path,
+                                         &task->service->stop, &stats);
+    // The old index still does not match the folder, it is built again
+    // after the delay.
+    root->dirty = !built;
+    ftic_atomic_store(&root->state, built ? CONTENT_INDEX_BUILT : CONTENT_INDEX_IDLE);
+    ftic_atomic_store(&task->service->building, 0);
+    free(task);
+}
+
+internal b8 content_index_root_contains(const ContentIndexRoot* root, const char* directory)
+{
+    const size_t length = strlen(root->path);
+    if (strncmp(root->path, directory, length) != 0)
+    {
+        return false;
+    }
+    return directory[length] == '\0' || directory[length] == '\\' || directory[length] == '/' ||
+           (length && (root->path[length - 1] == '\\' || root->path[length - 1] == '/'));
+}
+
+internal void content_index_root_free(ContentIndexRoot* root)
+{
+    if (root->change_handle)
+    {
+        directory_unlisten_to_directory_changes(root->change_handle);
+    }
+    content_index_close(&root->index);
+    free(root->path);
+    free(root);
+}
+
+void content_index_service_create(ThreadTaskQueue* task_queue, const char* directory,
+                                  ContentIndexService* service)
+{
+    memset(service, 0, sizeof(ContentIndexService));
+    service->task_queue = task_queue;
+    const size_t length = strlen(directory);
+    if (length + 32 < sizeof(service->directory))
+    {
+        memcpy(service->directory, directory, length + 1);
+        if (!platform_directory_exists(service->directory))
+        {
+            platform_create_directory(service->directory);
+        }
+    }
+    array_create(&service->roots, 8);
+}
+
+void content_index_service_destroy(ContentIndexService* service)
+{
+    ftic_atomic_store(&service->stop, 1);
+    while (ftic_atomic_load(&service->building))
+    {
+        platform_sleep(1);
+    }
+    for (u32 i = 0; i < service->roots.size; ++i)
+    {
+        content_index_root_free(service->roots.data[i]);
+    }
+    array_free(&service->roots);
+}
+
+internal ContentIndexRoot* content_index_root_create(ContentIndexService* service,
+                                                     const char* path)
+{
+    ContentIndexRoot* root = (ContentIndexRoot*)calloc(1, sizeof(ContentIndexRoot));
+    root->path = string_copy_d(path);
+    // The file name is the hash of the root path. Like for the string keys of
+    // the hash tables, hash_murmur is given the address of the pointer.
+    const char* key = root->path;
+    const u32 length = (u32)strlen(key);
+    sprintf_s(root->index_path, sizeof(root->index_path), "%s/%016llx.index", service->directory,
+              (unsigned long long)hash_murmur(&key, length, 0));
+    sprintf_s(root->built_path, sizeof(root->built_path), "%s.build", root->index_path);
+    // The index from the last run does not answer queries, files may have
+    // changed since, but the first build only reads the files that did.
+    content_index_open(root->index_path, &root->index);
+    root->dirty = true;
+    return root;
+}
+
+void content_index_service_update(ContentIndexService* service, const DirectoryItemArray* items)
+{
+    if (!service->directory[0])
+    {
+        return;
+    }
+    ContentIndexRootPtrArray* roots = &service->roots;
+    for (u32 i = 0; i < roots->size; ++i)
+    {
+        ContentIndexRoot* root = roots->data[i];
+        b8 pinned = false;
+        for (u32 j = 0; j < items->size && !pinned; ++j)
+        {
+            pinned = items->data[j].type == FOLDER_DEFAULT &&
+                     strcmp(items->data[j].path, root->path) == 0;
+        }
+        root->removed = !pinned;
+    }
+    for (u32 i = 0; i < items->size; ++i)
+    {
+        const DirectoryItem* item = items->data + i;
+        if (item->type != FOLDER_DEFAULT)
+        {
+            continue;
+        }
+        b8 exists = false;
+        for (u32 j = 0; j < roots->size && !exists; ++j)
+        {
+            exists = strcmp(roots->data[j]->path, item->path) == 0;
+        }
+        if (!exists)
+        {
+            array_push(roots, content_index_root_create(service, item->path));
+        }
+    }
+
+    const f64 now = platform_get_time();
+    for (u32 i = 0; i < roots->size;)
+    {
+        ContentIndexRoot* root = roots->data[i];
+        const long state = ftic_atomic_load(&root->state);
+        if (state == CONTENT_INDEX_BUILDING)
+        {
+            ++i;
+            continue;
+        }
+        if (state == CONTENT_INDEX_BUILT)
+        {
+            content_index_close(&root->index);
+            platform_delete_file(root->index_path);
+            if (!root->removed && platform_rename(root->built_path, root->index_path))
+            {
+                content_index_open(root->index_path, &root->index);
+            }
+            ftic_atomic_store(&root->state, CONTENT_INDEX_IDLE);
+        }
+        if (root->removed)
+        {
+            platform_delete_file(root->built_path);
+            platform_delete_file(root->index_path);
+            content_index_root_free(root);
+            roots->data[i] = roots->data[--roots->size];
+            continue;
+        }
+
+        if (root->change_handle && directory_look_for_directory_change(root->change_handle))
+        {
+            directory_unlisten_to_directory_changes(root->change_handle);
+            root->change_handle = NULL;
+            root->dirty = true;
+        }
+        // One build at a time, it is meant to stay in the background.
+        if (root->dirty && !ftic_atomic_load(&service->building) &&
+            now - root->last_build_time >= CONTENT_INDEX_REBUILD_DELAY)
+        {
+            root->dirty = false;
+            root->last_build_time = now;
+            ftic_atomic_store(&service->building, 1);
+            ftic_atomic_store(&root->state, CONTENT_INDEX_BUILDING);
+            ContentIndexBuildTask* task =
+                (ContentIndexBuildTask*)calloc(1, sizeof(ContentIndexBuildTask));
+            task->service = service;
+            task->root = root;
+            ThreadTask thread_task_data = thread_task(content_index_build_task, task);
+            if (!thread_tasks_push(service->task_queue, &thread_task_data, 1, NULL))
+            {
+                // The queue is full, tried again after the delay.
+                free(task);
+                root->dirty = true;
+                ftic_atomic_store(&root->state, CONTENT_INDEX_IDLE);
+                ftic_atomic_store(&service->building, 0);
+            }
+        }
+        ++i;
+    }
+}
+
+const ContentIndex* content_index_service_find(const ContentIndexService* service,
+                                               const char* directory)
+{
+    for (u32 i = 0; i < service->roots.size; ++i)
+    {
+        ContentIndexRoot* root = service->roots.data[i];
+        if (content_index_root_contains(root, directory))
+        {
+            // An index that is known to be out of date would miss the files
+            // that changed, the search scans the folder instead.
+            const b8 current = ftic_atomic_load(&root->state) == CONTENT_INDEX_IDLE &&
+                               !root->dirty && root->index.header;
+            return current ? &root->index : NULL;
+        }
+    }
+    return NULL;
+}
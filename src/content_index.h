@@ -0,0 +1,140 @@
+#pragma once
+#include "define.h"
+#include "ftic_atomic.h"
+#include "thread_queue.h"
+#include "platform/platform.h"
+
+// Trigram index over the contents of every file below a root. For each
+// three byte sequence (lower case, like the content matcher) the index keeps
+// the sorted ids of the files it occurs in, so a query only has to scan the
+// files that have all the trigrams of the pattern.
+//
+// File layout, read through a read only mapping:
+//     ContentIndexHeader
+//     ContentIndexFile[file_count], sorted on path
+//     paths, zero terminated
+//     postings, per trigram the delta coded file ids as varints
+//     ContentIndexTrigram[trigram_count], sorted on trigram
+#define CONTENT_INDEX_MAGIC 0x49435446 // "FTCI"
+#define CONTENT_INDEX_VERSION 1
+// Files that were not read, either too large or left for a later round of a
+// build, are listed under this key. A query always returns them.
+#define CONTENT_INDEX_UNINDEXED 0xFFFFFFFFu
+#define CONTENT_INDEX_MAX_FILE_SIZE (64ull * 1024 * 1024)
+// Postings a build keeps in memory before it writes out what it has and
+// goes on from there.
+#ifndef CONTENT_INDEX_BUILD_BUDGET
+#define CONTENT_INDEX_BUILD_BUDGET (64 * 1024 * 1024)
+#endif
+// Folders are not reindexed more often than this, a build tool writing to
+// an indexed folder would otherwise keep a build running all the time.
+#define CONTENT_INDEX_REBUILD_DELAY 5.0
+
+typedef struct ContentIndexHeader
+{
+    u32 magic;
+    u32 version;
+    u32 file_count;
+    u32 trigram_count;
+    u64 paths_offset;
+    u64 postings_offset;
+    u64 trigrams_offset;
+} ContentIndexHeader;
+
+typedef struct ContentIndexFile
+{
+    u64 last_write_time;
+    u64 size;
+    u32 path_offset;
+    u32 unindexed;
+} ContentIndexFile;
+
+typedef struct ContentIndexTrigram
+{
+    u32 trigram;
+    u32 count;
+    u64 offset;
+} ContentIndexTrigram;
+
+typedef struct ContentIndex
+{
+    PlatformFileMapping mapping;
+    const ContentIndexHeader* header;
+    const ContentIndexFile* files;
+    const ContentIndexTrigram* trigrams;
+    const char* paths;
+    const u8* postings;
+} ContentIndex;
+
+typedef struct ContentIndexBuildStats
+{
+    u32 file_count;
+    u32 files_read;
+    u32 rounds;
+    u64 bytes_read;
+} ContentIndexBuildStats;
+
+typedef enum ContentIndexState
+{
+    CONTENT_INDEX_IDLE = 0,
+    CONTENT_INDEX_BUILDING,
+    CONTENT_INDEX_BUILT,
+} ContentIndexState;
+
+typedef struct ContentIndexRoot
+{
+    char* path;
+    char index_path[FTIC_MAX_PATH];
+    char built_path[FTIC_MAX_PATH]; // Where the build task writes
+    ContentIndex index;
+    void* change_handle;
+    f64 last_build_time;
+    b8 dirty;
+    b8 removed; // Freed once its build is done
+    FTicAtomic state;
+} ContentIndexRoot;
+
+typedef struct ContentIndexRootPtrArray
+{
+    u32 size;
+    u32 capacity;
+    ContentIndexRoot** data;
+} ContentIndexRootPtrArray;
+
+// Keeps an index for each pinned folder, stored in directory. An index is
+// rebuilt in the background when its folder changes, the files that did not
+// change keep their postings and are not read again.
+typedef struct ContentIndexService
+{
+    ThreadTaskQueue* task_queue;
+    char directory[FTIC_MAX_PATH];
+    ContentIndexRootPtrArray roots;
+    FTicAtomic building;
+    FTicAtomic stop;
+} ContentIndexService;
+
+b8 content_index_open(const char* path, ContentIndex* index);
+void content_index_close(ContentIndex* index);
+const char* content_index_file_path(const ContentIndex* index, u32 file);
+
+// Indexes every file below root into path. The previous index of the same
+// root, if given, provides the postings of the files that did not change.
+// False if it was stopped or the index could not be written.
+b8 content_index_build(const char* root, const ContentIndex* previous, const char* path,
+                       FTicAtomic* stop, ContentIndexBuildStats* stats);
+
+// Appends the files below directory that can contain pattern. False if the
+// pattern is too short for a trigram, the index can not narrow that down.
+b8 content_index_query(const ContentIndex* index, const char* directory, const char* pattern,
+                       u32 pattern_length, U32Array* candidates);
+
+void content_index_service_create(ThreadTaskQueue* task_queue, const char* directory,
+                                  ContentIndexService* service);
+void content_index_service_destroy(ContentIndexService* service);
+// Indexes the folders among items and drops the indexes of folders that are
+// no longer there. Looks for changes and swaps in finished builds.
+void content_index_service_update(ContentIndexService* service, const DirectoryItemArray* items);
+// The index of the root that directory is in. NULL if there is none, or while
+// the folder has changed since it was built.
+const ContentIndex* content_index_service_find(const ContentIndexService* service,
+                                               const char* directory);
@@ -0,0 +1,270 @@
+#include "content_search.h"
+#include "platform/platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTENT_SEARCH_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+internal u8 to_lower_ascii(u8 character)
+{
+    return character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+}
+
+internal b8 is_lower_ascii_letter(u8 character)
+{
+    return character >= 'a' && character <= 'z';
+}
+
+internal b8 content_matches_at(const ContentMatcher* matcher, const u8* data)
+{
+    for (u32 i = 0; i < matcher->length; ++i)
+    {
+        if (to_lower_ascii(data[i]) != matcher->pattern[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+internal u32 content_first_bit(u32 mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctz(mask);
+#endif
+}
+
+internal u32 content_bit_count(u32 mask)
+{
+    mask = mask - ((mask >> 1) & 0x55555555);
+    mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+    return (((mask + (mask >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+internal u32 content_count_newlines(const u8* data, u64 size)
+{
+    u32 count = 0;
+    u64 i = 0;
+#ifdef CONTENT_SEARCH_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        count += content_bit_count((u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+b8 content_matcher_create(const char* pattern, u32 length, ContentMatcher* matcher)
+{
+    if (!length || length > CONTENT_SEARCH_MAX_PATTERN)
+    {
+        return false;
+    }
+    for (u32 i = 0; i < length; ++i)
+    {
+        matcher->pattern[i] = to_lower_ascii((u8)pattern[i]);
+    }
+    matcher->length = length;
+    return true;
+}
+
+// Candidates are the positions where both the first and the last byte of the
+// pattern match, sixteen positions at a time. Letters are compared with the
+// case bit set, which lets a few other bytes through that the full compare
+// then rejects.
+u64 content_matcher_find(const ContentMatcher* matcher, const u8* data, u64 size, u64 from)
+{
+    const u32 length = matcher->length;
+    if (size < length)
+    {
+        return size;
+    }
+    const u64 last_start = size - length;
+    u64 i = from;
+#ifdef CONTENT_SEARCH_SSE2
+    const u8 first = matcher->pattern[0];
+    const u8 last = matcher->pattern[length - 1];
+    const __m128i first_value = _mm_set1_epi8((char)first);
+    const __m128i last_value = _mm_set1_epi8((char)last);
+    const __m128i first_fold = _mm_set1_epi8(is_lower_ascii_letter(first) ? 0x20 : 0);
+    const __m128i last_fold = _mm_set1_epi8(is_lower_ascii_letter(last) ? 0x20 : 0);
+    for (; i + 15 <= last_start; i += 16)
+    {
+        const __m128i first_block =
+            _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i)), first_fold);
+        const __m128i last_block =
+            _mm_or_si128(_mm_loadu_si128((const __m128i*)(data + i + length - 1)), last_fold);
+        u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first_block, first_value),
+                                                        _mm_cmpeq_epi8(last_block, last_value)));
+        while (mask)
+        {
+            const u64 candidate = i + content_first_bit(mask);
+            if (content_matches_at(matcher, data + candidate))
+            {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i <= last_start; ++i)
+    {
+        if (to_lower_ascii(data[i]) == matcher->pattern[0] && content_matches_at(matcher, data + i))
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+b8 content_search_is_binary(const u8* data, u64 size)
+{
+    return memchr(data, 0, (size_t)ftic_min(size, (u64)CONTENT_SEARCH_SNIFF_SIZE)) != NULL;
+}
+
+// Searches data from the 1 based line number in line. Unless it is the last
+// part of the file line is moved past the data, which has to end on a whole
+// line. Returns false once the callback stops the scan.
+internal b8 content_search_lines(const ContentMatcher* matcher, const u8* data, u64 size,
+                                 b8 last, u32* line, u32* hit_count,
+                                 ContentHitCallback callback, void* callback_data)
+{
+    u64 counted = 0;
+    u64 from = 0;
+    while (from < size)
+    {
+        const u64 match = content_matcher_find(matcher, data, size, from);
+        if (match >= size)
+        {
+            break;
+        }
+        *line += content_count_newlines(data + counted, match - counted);
+        counted = match;
+
+        u64 line_start = match;
+        while (line_start > from && data[line_start - 1] != '\n')
+        {
+            --line_start;
+        }
+        const u8* newline = (const u8*)memchr(data + match, '\n', (size_t)(size - match));
+        u64 line_end = newline ? (u64)(newline - data) : size;
+        from = line_end + 1;
+
+        // The preview starts at the line unless the match is too far in.
+        while (line_start < match && (data[line_start] == ' ' || data[line_start] == '\t'))
+        {
+            ++line_start;
+        }
+        if (line_end > line_start && data[line_end - 1] == '\r')
+        {
+            --line_end;
+        }
+        if (match + matcher->length - line_start > CONTENT_SEARCH_PREVIEW_LENGTH)
+        {
+            line_start = match - ftic_min(match - line_start, (u64)32);
+        }
+        const u32 text_length =
+            (u32)ftic_min(line_end - line_start, (u64)CONTENT_SEARCH_PREVIEW_LENGTH);
+
+        ++*hit_count;
+        if (!callback(*line, (const char*)data + line_start, text_length, callback_data))
+        {
+            return false;
+        }
+    }
+    if (!last)
+    {
+        *line += content_count_newlines(data + counted, size - counted);
+    }
+    return true;
+}
+
+u32 content_search_buffer(const ContentMatcher* matcher, const u8* data, u64 size,
+                          ContentHitCallback callback, void* callback_data)
+{
+    u32 hit_count = 0;
+    u32 line = 1;
+    content_search_lines(matcher, data, size, true, &line, &hit_count, callback, callback_data);
+    return hit_count;
+}
+
+// Read instead of mapped, a mapped file that is truncated while it is being
+// searched faults on the pages past its new end.
+u32 content_search_file(const char* path, const ContentMatcher* matcher,
+                        ContentHitCallback callback, void* callback_data, u64* bytes_scanned)
+{
+    u32 hit_count = 0;
+    u64 scanned = 0;
+    FILE* file = fopen(path, "rb");
+    if (file)
+    {
+        setvbuf(file, NULL, _IONBF, 0);
+        u8* buffer = (u8*)malloc(CONTENT_SEARCH_READ_SIZE);
+        u64 size = 0;
+        u32 line = 1;
+        b8 searching = true;
+        for (b8 first = true; searching; first = false)
+        {
+            const u64 read =
+                (u64)fread(buffer + size, 1, (size_t)(CONTENT_SEARCH_READ_SIZE - size), file);
+            const b8 last = read < CONTENT_SEARCH_READ_SIZE - size;
+            size += read;
+            if (first && content_search_is_binary(buffer, size))
+            {
+                break;
+            }
+
+            // The line the block ends in is carried over to the next one. A
+            // line longer than the block is searched in pieces that overlap
+            // by enough for a match across the cut to be found.
+            u64 search_size = size;
+            u64 end = size;
+            if (!last)
+            {
+                while (end > 0 && buffer[end - 1] != '\n')
+                {
+                    --end;
+                }
+                if (end)
+                {
+                    search_size = end;
+                }
+                else
+                {
+                    end = size - (matcher->length - 1);
+                }
+            }
+            searching = content_search_lines(matcher, buffer, search_size, last, &line,
+                                             &hit_count, callback, callback_data) &&
+                        !last;
+            scanned += end;
+            size -= end;
+            memmove(buffer, buffer + end, (size_t)size);
+        }
+        free(buffer);
+        fclose(file);
+    }
+    if (bytes_scanned)
+    {
+        *bytes_scanned = scanned;
+    }
+    return hit_count;
+}
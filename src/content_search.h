@@ -0,0 +1,34 @@
+#pragma once
+#include "define.h"
+
+#define CONTENT_SEARCH_MAX_PATTERN 256
+// A file with a zero byte in its first part is taken to be binary.
+#define CONTENT_SEARCH_SNIFF_SIZE 8192
+// Longest part of a matching line handed to the hit callback.
+#define CONTENT_SEARCH_PREVIEW_LENGTH 160
+// Files are read and searched in blocks of this size.
+#define CONTENT_SEARCH_READ_SIZE (1024 * 1024)
+
+// ASCII case insensitive literal, like the name search.
+typedef struct ContentMatcher
+{
+    u8 pattern[CONTENT_SEARCH_MAX_PATTERN]; // Lower case
+    u32 length;
+} ContentMatcher;
+
+// Called once per matching line with its 1 based number and a preview of it,
+// which is not zero terminated. Returning false stops the scan.
+typedef b8 (*ContentHitCallback)(u32 line, const char* text, u32 text_length, void* data);
+
+// False if the pattern is empty or longer than CONTENT_SEARCH_MAX_PATTERN.
+b8 content_matcher_create(const char* pattern, u32 length, ContentMatcher* matcher);
+// Offset of the first match at or after from, size if there is none.
+u64 content_matcher_find(const ContentMatcher* matcher, const u8* data, u64 size, u64 from);
+b8 content_search_is_binary(const u8* data, u64 size);
+// Returns the number of matching lines reported.
+u32 content_search_buffer(const ContentMatcher* matcher, const u8* data, u64 size,
+                          ContentHitCallback callback, void* callback_data);
+// Reads the file and searches it unless it looks binary. bytes_scanned, if
+// given, gets the size of what was searched.
+u32 content_search_file(const char* path, const ContentMatcher* matcher,
+                        ContentHitCallback callback, void* callback_data, u64* bytes_scanned);
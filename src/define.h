@@ -12,6 +12,18 @@
 #define MICROSECONDS(micro) ((micro) * 0.000001);
 #define NANOSECONDS(nano) ((nano) * 0.000000001);
 
+// The MSVC runtime names used below, for the headless Linux build.
+#ifdef LINUX
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#define sprintf_s snprintf
+#define sscanf_s sscanf
+#endif
+
 #define sysprintf(...) sprintf_s(__VA_ARGS__)
 #define syscanf(...) sscanf_s(__VA_ARGS__)
 #define sy_gcvt(...) _gcvt_s(__VA_ARGS__);
@@ -59,28 +71,6 @@
 
 #define array_free(array) free((array)->data)
 
-#define safe_array_push(arr, value)                                                                \
-    do                                                                                             \
-    {                                                                                              \
-        platform_mutex_lock(&(arr)->mutex);                                                        \
-        array_push(&(arr)->array, value);                                                          \
-        platform_mutex_unlock(&(arr)->mutex);                                                      \
-    } while (0)
-
-#define safe_array_create(arr, array_capacity)                                                     \
-    do                                                                                             \
-    {                                                                                              \
-        array_create(&(arr)->array, array_capacity);                                               \
-        (arr)->mutex = platform_mutex_create();                                                    \
-    } while (0)
-
-#define safe_array_free(arr)                                                                       \
-    do                                                                                             \
-    {                                                                                              \
-        array_free(&(arr)->array);                                                                 \
-        platform_mutex_destroy(&(arr)->mutex);                                                     \
-    } while (0)
-
 #define array_move_to_front(type, array, index)                                                    \
     do                                                                                             \
     {                                                                                              \
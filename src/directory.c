@@ -2,6 +2,7 @@
 #include "hash.h"
 #include "logging.h"
 #include "hash.h"
+#include "profiler.h"
 #include <string.h>
 
 DirectoryPage* directory_current(DirectoryHistory* history)
@@ -12,35 +13,38 @@ DirectoryPage* directory_current(DirectoryHistory* history)
 void load_thumpnails(void* data)
 {
     LoadThumpnailData* arguments = (LoadThumpnailData*)data;
+    PROFILE_BEGIN("load_thumpnails");
 
     IdTextureProperties value = { .id = guid_copy(&arguments->file_id) };
     texture_load_full_path(arguments->file_path, &value.texture_properties);
-    if (!value.texture_properties.bytes)
+    if (value.texture_properties.bytes)
     {
-        free(arguments->file_path);
-        free(arguments);
-        return;
-    }
-
-    if (value.texture_properties.width > arguments->size ||
-        value.texture_properties.height > arguments->size)
-    {
-        texture_resize(&value.texture_properties, arguments->size, arguments->size);
-    }
-
-    platform_mutex_lock(&arguments->array->mutex);
-    if (arguments->array->array.data == NULL)
-    {
-        free(value.texture_properties.bytes);
-        free(arguments->file_path);
-        free(arguments);
-        return;
+        if (value.texture_properties.width > arguments->size ||
+            value.texture_properties.height > arguments->size)
+        {
+            texture_resize(&value.texture_properties, arguments->size, arguments->size);
+        }
+        if (!thread_channel_push(arguments->textures, &value, 1))
+        {
+            free(value.texture_properties.bytes);
+        }
     }
-    array_push(&arguments->array->array, value);
-
-    platform_mutex_unlock(&arguments->array->mutex);
+    thread_channel_release(arguments->textures);
     free(arguments->file_path);
     free(arguments);
+    PROFILE_END();
+}
+
+internal void free_id_texture_properties(void* element)
+{
+    free(((IdTextureProperties*)element)->texture_properties.bytes);
+}
+
+internal void free_object_thumbnail(void* element)
+{
+    ObjectThumbnail* object = (ObjectThumbnail*)element;
+    array_free(&object->mesh.vertices);
+    array_free(&object->mesh.indices);
 }
 
 internal void look_for_same_items(const DirectoryItemArray* existing_items,
@@ -67,276 +71,182 @@ internal void look_for_same_items(const DirectoryItemArray* existing_items,
     }
 }
 
-void directory_reload(DirectoryPage* directory_page)
+internal u32 count_image_obj_files(const DirectoryItemArray* items)
 {
-    char* path = platform_get_path_from_id(directory_page->directory.parent_id);
-    u32 length = (u32)strlen(path);
-    path[length++] = '\\';
-    path[length++] = '*';
-    Directory reloaded_directory = platform_get_directory(path, length, true);
-    path[length - 2] = '\0';
-    path[length - 1] = '\0';
-
-    look_for_same_items(&directory_page->directory.items, &reloaded_directory.items);
-
-    platform_reset_directory(&directory_page->directory, false);
-    directory_page->directory = reloaded_directory;
-    directory_sort(directory_page);
+    u32 count = 0;
+    for (u32 i = 0; i < items->size; ++i)
+    {
+        DirectoryItem* item = items->data + i;
+        count += (item->type == FILE_PNG || item->type == FILE_JPG || item->type == FILE_OBJ);
+    }
+    return count;
 }
 
-void directory_paste_in_directory(DirectoryPage* current_directory)
+internal b8 should_be_grid_view(const DirectoryPage* page)
 {
-    CharPtrArray pasted_paths = { 0 };
-    array_create(&pasted_paths, 10);
-    platform_paste_from_clipboard(&pasted_paths);
-    if (pasted_paths.size)
+    u32 count = count_image_obj_files(&page->directory.items);
+
+    if (count)
     {
-        platform_paste_to_directory(&pasted_paths, current_directory->directory.parent);
-        for (u32 i = 0; i < pasted_paths.size; ++i)
+        if (((f32)count / (f32)(page->directory.items.size)) >= 0.8f)
         {
-            free(pasted_paths.data[i]);
+            return true;
         }
-        directory_reload(current_directory);
     }
-    free(pasted_paths.data);
-}
-
-internal i32 name_compare_function(const DirectoryItem* first, const DirectoryItem* second)
-{
-    return string_compare_case_insensitive(item_namec(first), item_namec(second));
+    return false;
 }
 
-internal i32 date_compare_function(const DirectoryItem* first, const DirectoryItem* second)
+// The page keeps its own copy of the items for its sort order and view state,
+// the paths and the parent are the ones in the listing.
+internal void directory_page_set_listing(DirectoryPage* directory_page, DirectoryListing* listing)
 {
-    PlatformTime first_time = platform_time_from_u64(first->last_write_time);
-    PlatformTime second_time = platform_time_from_u64(second->last_write_time);
-    return platform_time_compare(&first_time, &second_time);
+    const DirectoryItemArray* listed_items = &listing->directory.items;
+    DirectoryItemArray items = { 0 };
+    array_create(&items, ftic_max(listed_items->size, 2));
+    memcpy(items.data, listed_items->data, listed_items->size * sizeof(DirectoryItem));
+    items.size = listed_items->size;
+
+    look_for_same_items(&directory_page->directory.items, &items);
+
+    array_free(&directory_page->directory.items);
+    directory_cache_release(directory_page->listing);
+    directory_page->listing = listing;
+    directory_page->directory = (Directory){
+        .parent_id = listing->directory.parent_id,
+        .parent = listing->directory.parent,
+        .items = items,
+    };
+    directory_page->listed_count = listed_items->size;
+    directory_page->loading = listing->load != NULL;
 }
 
-internal void merge(DirectoryItem* array,
-                    i32 (*compare_function)(const DirectoryItem*, const DirectoryItem*), u32 left,
-                    u32 mid, u32 right)
+// A load nobody else is waiting for is stopped when its page is left, the
+// page lists the folder again if it is shown again.
+internal void directory_page_leave(DirectoryPage* directory_page)
 {
-    u32 n1 = mid - left + 1;
-    u32 n2 = right - mid;
-
-    DirectoryItem* left_array = (DirectoryItem*)malloc(n1 * sizeof(DirectoryItem));
-    DirectoryItem* right_array = (DirectoryItem*)malloc(n2 * sizeof(DirectoryItem));
-
-    for (u32 i = 0; i < n1; ++i)
-    {
-        left_array[i] = array[left + i];
-    }
-    for (u32 i = 0; i < n2; ++i)
+    DirectoryListing* listing = directory_page->listing;
+    if (listing && listing->load && listing->reference_count == 1)
     {
-        right_array[i] = array[mid + 1 + i];
+        directory_cache_invalidate(listing);
     }
+}
 
-    u32 i = 0;
-    u32 j = 0;
-    u32 k = left;
-    while (i < n1 && j < n2)
+void directory_page_release(DirectoryPage* directory_page, b8 delete_textures)
+{
+    if (delete_textures)
     {
-        if (compare_function(left_array + i, right_array + j) <= 0)
+        for (u32 i = 0; i < directory_page->directory.items.size; ++i)
         {
-            array[k] = left_array[i++];
-        }
-        else
-        {
-            array[k] = right_array[j++];
+            const u32 texture_id = directory_page->directory.items.data[i].texture_id;
+            if (texture_id)
+            {
+                texture_delete(texture_id);
+            }
         }
-        ++k;
     }
+    array_free(&directory_page->directory.items);
+    directory_page->directory = (Directory){ 0 };
+    directory_cache_release(directory_page->listing);
+    directory_page->listing = NULL;
+}
 
-    while (i < n1)
+void directory_refresh(DirectoryPage* directory_page)
+{
+    DirectoryListing* listing = directory_page->listing;
+    char* path = NULL;
+    if ((listing && !listing->stale) ||
+        !(path = platform_get_path_from_id(directory_page->directory.parent_id)))
     {
-        array[k++] = left_array[i++];
+        // A folder that is gone keeps showing what it had.
+        if (listing == NULL)
+        {
+            return;
+        }
+        directory_cache_retain(listing);
     }
-
-    while (j < n2)
+    else
     {
-        array[k++] = right_array[j++];
+        u32 length = (u32)strlen(path);
+        path[length++] = '\\';
+        path[length++] = '*';
+        listing = directory_cache_acquire(path, length);
+        free(path);
     }
-
-    free(left_array);
-    free(right_array);
+    directory_page_set_listing(directory_page, listing);
+    directory_sort(directory_page);
 }
 
-internal void merge_sort(DirectoryItem* array,
-                         i32 (*compare_function)(const DirectoryItem*, const DirectoryItem*),
-                         u32 left, u32 right)
+void directory_page_update(DirectoryPage* directory_page)
 {
-    if (left < right)
+    DirectoryListing* listing = directory_page->listing;
+    if (listing == NULL)
     {
-        u32 mid = left + (right - left) / 2;
-        merge_sort(array, compare_function, left, mid);
-        merge_sort(array, compare_function, mid + 1, right);
-        merge(array, compare_function, left, mid, right);
+        return;
     }
-}
-
-void directory_sort_by_name(DirectoryItemArray* array)
-{
-    merge_sort(array->data, name_compare_function, 0, array->size - 1);
-}
-
-void directory_merge_sort_by_date(DirectoryItemArray* array)
-{
-    merge_sort(array->data, date_compare_function, 0, array->size - 1);
-}
-
-void directory_flip_array(DirectoryItemArray* array)
-{
-    const i32 middle = array->size / 2;
-    for (i32 i = 0, j = array->size - 1; i < middle; ++i, --j)
+    if (listing->stale)
     {
-        DirectoryItem temp = array->data[i];
-        array->data[i] = array->data[j];
-        array->data[j] = temp;
+        directory_refresh(directory_page);
+        return;
     }
-}
-
-void directory_sort_by_size(DirectoryItemArray* array)
-{
-    if (array->size <= 1) return;
-
-    DirectoryItem* output = (DirectoryItem*)calloc(array->size, sizeof(DirectoryItem));
-    u32 count[256] = { 0 };
 
-    for (u32 shift = 0, s = 0; shift < 8; ++shift, s += 8)
+    // New items wait until they are at least as many as the page shows, or
+    // the load is done. Each merge then at least doubles the page, so the
+    // moves over a whole load add up to a few times the item count instead
+    // of the page size for every chunk.
+    const DirectoryItemArray* listed_items = &listing->directory.items;
+    const u32 pending = listed_items->size - directory_page->listed_count;
+    if (pending && (!listing->load || pending >= directory_page->directory.items.size))
     {
-        memset(count, 0, sizeof(count));
-
-        for (u32 i = 0; i < array->size; ++i)
-        {
-            count[(array->data[i].size >> s) & 0xff]++;
-        }
-
-        for (u32 i = 1; i < 256; ++i)
-        {
-            count[i] += count[i - 1];
-        }
-
-        for (i32 i = array->size - 1; i >= 0; --i)
-        {
-            u32 index = (array->data[i].size >> s) & 0xff;
-            output[--count[index]] = array->data[i];
-        }
-        DirectoryItem* tmp = array->data;
-        array->data = output;
-        output = tmp;
+        DirectoryItemArray chunk = { 0 };
+        chunk.size = pending;
+        chunk.capacity = chunk.size;
+        chunk.data = (DirectoryItem*)malloc(chunk.size * sizeof(DirectoryItem));
+        memcpy(chunk.data, listed_items->data + directory_page->listed_count,
+               chunk.size * sizeof(DirectoryItem));
+        directory_sort_merge(directory_page, &chunk);
+        array_free(&chunk);
+        directory_page->listed_count = listed_items->size;
+    }
+    if (directory_page->loading && !listing->load)
+    {
+        directory_page->loading = false;
+        directory_page->grid_view = should_be_grid_view(directory_page);
     }
-    free(output);
 }
 
-void directory_sort_by_date(DirectoryItemArray* array)
+void directory_reload(DirectoryPage* directory_page)
 {
-    if (array->size <= 1) return;
-
-    DirectoryItem* output = (DirectoryItem*)calloc(array->size, sizeof(DirectoryItem));
-    u32 count[256] = { 0 };
-
-    for (u32 shift = 0, s = 0; shift < 8; ++shift, s += 8)
+    // Another page showing the folder may already have listed it again, then
+    // that listing is used.
+    if (directory_page->listing)
     {
-        memset(count, 0, sizeof(count));
-
-        for (u32 i = 0; i < array->size; ++i)
-        {
-            count[(array->data[i].last_write_time >> s) & 0xff]++;
-        }
-
-        for (u32 i = 1; i < 256; ++i)
-        {
-            count[i] += count[i - 1];
-        }
-
-        for (i32 i = array->size - 1; i >= 0; --i)
-        {
-            u32 index = (array->data[i].last_write_time >> s) & 0xff;
-            output[--count[index]] = array->data[i];
-        }
-        DirectoryItem* tmp = array->data;
-        array->data = output;
-        output = tmp;
+        directory_cache_invalidate(directory_page->listing);
     }
-    free(output);
+    directory_refresh(directory_page);
 }
 
-void directory_sort(DirectoryPage* directory_page)
+void directory_paste_in_directory(DirectoryPage* current_directory,
+                                  FileOperationQueue* file_operations)
 {
-    DirectoryItemArray* items = &directory_page->directory.items;
-    switch (directory_page->sort_by)
+    CharPtrArray pasted_paths = { 0 };
+    array_create(&pasted_paths, 10);
+    platform_paste_from_clipboard(&pasted_paths);
+    if (pasted_paths.size)
     {
-        case SORT_NAME:
-        {
-            directory_sort_by_name(items);
-            if (directory_page->sort_count == 2)
-            {
-                directory_flip_array(items);
-            }
-            break;
-        }
-        case SORT_SIZE:
-        {
-            directory_sort_by_size(items);
-            if (directory_page->sort_count == 2)
-            {
-                directory_flip_array(items);
-            }
-            break;
-        }
-        case SORT_DATE:
-        {
-            directory_sort_by_date(items);
-            if (directory_page->sort_count == 2)
-            {
-                directory_flip_array(items);
-            }
-            break;
-        }
-        default:
+        // The copy runs on the thread pool, the directory is reloaded by the
+        // change listener and when the operation finishes.
+        file_operation_copy(file_operations, &pasted_paths, current_directory->directory.parent);
+        for (u32 i = 0; i < pasted_paths.size; ++i)
         {
-            directory_sort_by_name(items);
-
-            // NOTE: very inefficient but does not happen very often.
-            DirectoryItemArray temp = { 0 };
-            array_create(&temp, items->size);
-
-            i32 iterations = (i32)items->size;
-            for (i32 i = 0; i < iterations; ++i)
-            {
-                DirectoryItem* item = items->data + i;
-                if (item->type == FOLDER_DEFAULT)
-                {
-                    array_push(&temp, *item);
-                    for (i32 j = i; j < iterations - 1; ++j)
-                    {
-                        items->data[j] = items->data[j + 1];
-                    }
-                    --i;
-                    --iterations;
-                }
-            }
-            u32 files_to_move = items->size - temp.size;
-            memmove(items->data + temp.size, items->data, files_to_move * sizeof(DirectoryItem));
-            memcpy(items->data, temp.data, temp.size * sizeof(DirectoryItem));
-
-            array_free(&temp);
-            break;
+            free(pasted_paths.data[i]);
         }
     }
-}
-
-void directory_history_update_directory_change_handle(DirectoryHistory* directory_history)
-{
-    directory_unlisten_to_directory_changes(directory_history->change_handle);
-    directory_history->change_handle = directory_listen_to_directory_changes(
-        directory_current(directory_history)->directory.parent);
+    free(pasted_paths.data);
 }
 
 internal u32 look_for_and_get_thumbnails(const DirectoryItemArray* files,
                                          ThreadTaskQueue* task_queue,
-                                         SafeIdTexturePropertiesArray* textures)
+                                         ThreadChannel* textures)
 {
     u32 count = 0;
     for (u32 i = 0; i < files->size; ++i)
@@ -349,12 +259,10 @@ internal u32 look_for_and_get_thumbnails(const DirectoryItemArray* files,
             LoadThumpnailData* thump_nail_data =
                 (LoadThumpnailData*)calloc(1, sizeof(LoadThumpnailData));
             thump_nail_data->file_id = guid_copy(&item->id);
-            thump_nail_data->array = textures;
+            thump_nail_data->textures = textures;
             thump_nail_data->file_path = item->path;
-            ThreadTask task = {
-                .data = thump_nail_data,
-                .task_callback = load_thumpnails,
-            };
+            thread_channel_retain(textures);
+            ThreadTask task = thread_task(load_thumpnails, thump_nail_data);
             thread_tasks_push(task_queue, &task, 1, NULL);
             ++count;
         }
@@ -362,31 +270,6 @@ internal u32 look_for_and_get_thumbnails(const DirectoryItemArray* files,
     return count;
 }
 
-internal u32 count_image_obj_files(const DirectoryItemArray* items)
-{
-    u32 count = 0;
-    for (u32 i = 0; i < items->size; ++i)
-    {
-        DirectoryItem* item = items->data + i;
-        count += (item->type == FILE_PNG || item->type == FILE_JPG || item->type == FILE_OBJ);
-    }
-    return count;
-}
-
-internal b8 should_be_grid_view(const DirectoryPage* page)
-{
-    u32 count = count_image_obj_files(&page->directory.items);
-
-    if (count)
-    {
-        if (((f32)count / (f32)(page->directory.items.size)) >= 0.8f)
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
 b8 directory_go_to(char* path, u32 length, DirectoryHistory* directory_history)
 {
     b8 result = false;
@@ -402,12 +285,14 @@ b8 directory_go_to(char* path, u32 length, DirectoryHistory* directory_history)
         path[length++] = '*';
         saved_chars[2] = path[length];
         path[length] = '\0';
+        directory_page_leave(directory_current(directory_history));
         DirectoryPage new_page = { 0 };
-        new_page.directory = platform_get_directory(path, length, true);
+        directory_page_set_listing(&new_page, directory_cache_acquire(path, length));
+        directory_sort(&new_page);
         for (i32 i = directory_history->history.size - 1;
              i >= (i32)directory_history->current_index + 1; --i)
         {
-            platform_reset_directory(&directory_history->history.data[i].directory, true);
+            directory_page_release(directory_history->history.data + i, true);
         }
         directory_history->history.size = ++directory_history->current_index;
         array_push(&directory_history->history, new_page); // size + 1
@@ -418,7 +303,6 @@ b8 directory_go_to(char* path, u32 length, DirectoryHistory* directory_history)
         path[length--] = saved_chars[2];
         path[length--] = saved_chars[1];
         result = true;
-        directory_history_update_directory_change_handle(directory_history);
     }
     path[length] = saved_chars[0];
     return result;
@@ -435,10 +319,11 @@ void directory_open_folder(FticGUID id, DirectoryHistory* directory_history)
 void directory_move_in_history(const i32 index_add, SelectedItemValues* selected_item_values,
                                DirectoryHistory* directory_history)
 {
+    directory_page_leave(directory_current(directory_history));
     directory_history->current_index += index_add;
     DirectoryPage* current = directory_current(directory_history);
     directory_clear_selected_items(selected_item_values);
-    directory_reload(current);
+    directory_refresh(current);
     for (u32 i = 0; i < current->directory.items.size; ++i)
     {
         DirectoryItem* item = current->directory.items.data + i;
@@ -449,7 +334,6 @@ void directory_move_in_history(const i32 index_add, SelectedItemValues* selected
             item->reload_thumbnail = false;
         }
     }
-    directory_history_update_directory_change_handle(directory_history);
 }
 
 b8 directory_can_go_up(char* parent)
@@ -482,14 +366,15 @@ void directory_tab_add(const char* dir, ThreadTaskQueue* task_queue, DirectoryTa
     array_create(&tab->directory_history.history, 10);
 
     DirectoryPage page = { 0 };
-    page.directory = platform_get_directory(dir, (u32)strlen(dir), true);
+    directory_page_set_listing(&page, directory_cache_acquire(dir, (u32)strlen(dir)));
+    directory_sort(&page);
     array_push(&tab->directory_history.history, page);
 
-    tab->directory_history.change_handle =
-        directory_listen_to_directory_changes(page.directory.parent);
-
-    safe_array_create(&tab->textures, 10);
-    safe_array_create(&tab->objects, 10);
+    tab->textures = thread_channel_create(sizeof(IdTextureProperties), THUMBNAIL_CHANNEL_CAPACITY,
+                                          free_id_texture_properties);
+    tab->objects = thread_channel_create(sizeof(ObjectThumbnail), THUMBNAIL_CHANNEL_CAPACITY,
+                                         free_object_thumbnail);
+    array_create(&tab->pending_objects, 10);
 
     array_create(&tab->directory_list.selected_item_values.paths, 10);
     tab->directory_list.selected_item_values.selected_items =
@@ -500,7 +385,7 @@ void directory_tab_add(const char* dir, ThreadTaskQueue* task_queue, DirectoryTa
     DirectoryPage* last_page = array_back(&tab->directory_history.history);
 #if 0
     look_for_and_get_thumbnails(&last_page->directory.files, task_queue,
-                                &tab->textures);
+                                tab->textures);
 #endif
     last_page->grid_view = should_be_grid_view(last_page);
 }
@@ -509,17 +394,21 @@ void directory_tab_clear(DirectoryTab* tab)
 {
     for (u32 i = 0; i < tab->directory_history.history.size; i++)
     {
-        platform_reset_directory(&tab->directory_history.history.data[i].directory, true);
+        directory_page_release(tab->directory_history.history.data + i, true);
     }
     array_free(&tab->directory_history.history);
 
-    platform_mutex_lock(&tab->textures.mutex);
-    free(tab->textures.array.data);
-    tab->textures.array.data = NULL;
-    platform_mutex_unlock(&tab->textures.mutex);
-    platform_mutex_destroy(&tab->textures.mutex);
+    // Tasks still loading thumbnails hold their own references.
+    thread_channel_close(tab->textures);
+    thread_channel_close(tab->objects);
+    thread_channel_release(tab->textures);
+    thread_channel_release(tab->objects);
+    for (u32 i = 0; i < tab->pending_objects.size; ++i)
+    {
+        free_object_thumbnail(tab->pending_objects.data + i);
+    }
+    array_free(&tab->pending_objects);
 
-    directory_unlisten_to_directory_changes(tab->directory_history.change_handle);
     for (u32 i = 0; i < tab->directory_list.inputs.size; ++i)
     {
         ui_input_buffer_delete(tab->directory_list.inputs.data + i);
@@ -4,6 +4,8 @@
 #include "texture.h"
 #include "ftic_guid.h"
 #include "thread_queue.h"
+#include "file_operations.h"
+#include "directory_cache.h"
 
 typedef enum SortBy
 {
@@ -19,6 +21,10 @@ typedef struct DirectoryPage
     u32 sort_count;
     f32 offset;
     Directory directory;
+    DirectoryListing* listing;
+    // Items of the listing already merged into the page.
+    u32 listed_count;
+    b8 loading;
     b8 grid_view;
 } DirectoryPage;
 
@@ -31,16 +37,20 @@ typedef struct DirectoryArray
 
 typedef struct DirectoryHistory
 {
-    void* change_handle;
     u32 current_index;
     DirectoryArray history;
 } DirectoryHistory;
 
+#define THUMBNAIL_CHANNEL_CAPACITY 256
+
 typedef struct DirectoryTab
 {
     u32 window_id;
-    SafeIdTexturePropertiesArray textures;
-    SafeObjectThumbnailArray objects;
+    // Thumbnails loaded by the workers, drained every frame.
+    ThreadChannel* textures; // IdTextureProperties
+    ThreadChannel* objects;  // ObjectThumbnail
+    // Drained meshes waiting for their turn to be rendered.
+    ObjectThumbnailArray pending_objects;
     DirectoryHistory directory_history;
     List directory_list;
 } DirectoryTab;
@@ -56,21 +66,30 @@ typedef struct LoadThumpnailData
 {
     FticGUID file_id;
     char* file_path;
-    SafeIdTexturePropertiesArray* array;
+    ThreadChannel* textures; // Referenced by the task
     i32 size;
 } LoadThumpnailData;
 
 void load_thumpnails(void* data);
 
 DirectoryPage* directory_current(DirectoryHistory* history);
-void directory_paste_in_directory(DirectoryPage* current_directory);
+void directory_paste_in_directory(DirectoryPage* current_directory, FileOperationQueue* file_operations);
+// Lists the folder again, or takes a newer listing another page already made.
 void directory_reload(DirectoryPage* directory_page);
+// Rebuilds the page from its listing, only listing the folder if it changed.
+void directory_refresh(DirectoryPage* directory_page);
+void directory_page_release(DirectoryPage* directory_page, b8 delete_textures);
+// Merges what has been listed since the last call and refreshes the page if
+// its folder changed. Called every frame for the page shown.
+void directory_page_update(DirectoryPage* directory_page);
 void directory_sort(DirectoryPage* directory_page);
 void directory_sort_by_name(DirectoryItemArray* array);
 void directory_sort_by_size(DirectoryItemArray* array);
 void directory_sort_by_date(DirectoryItemArray* array);
 void directory_merge_sort_by_date(DirectoryItemArray* array);
 void directory_flip_array(DirectoryItemArray* array);
+// Sorts chunk and merges it into the already sorted items of the page.
+void directory_sort_merge(DirectoryPage* directory_page, DirectoryItemArray* chunk);
 b8 directory_go_to(char* path, u32 length, DirectoryHistory* directory_history);
 void directory_open_folder(FticGUID id, DirectoryHistory* directory_history);
 void directory_move_in_history(const i32 index_add, SelectedItemValues* selected_item_values, DirectoryHistory* directory_history);
@@ -82,5 +101,3 @@ void directory_tab_clear(DirectoryTab* tab);
 void directory_clear_selected_items(SelectedItemValues* selected_item_values);
 void directory_remove_selected_item(SelectedItemValues* selected_item_values, const FticGUID guid);
 
-
-void directory_history_update_directory_change_handle(DirectoryHistory* directory_history);
@@ -0,0 +1,336 @@
+#include "directory_cache.h"
+#include "hash.h"
+#include "util.h"
+#include <string.h>
+
+global DirectoryCache g_directory_cache = { 0 };
+
+internal u64 directory_cache_key(const FticGUID* id)
+{
+    return hash_guid(id, sizeof(FticGUID), 0);
+}
+
+internal void directory_listing_load_release(DirectoryListingLoad* load)
+{
+    if (ftic_atomic_add(&load->reference_count, -1) != 1)
+    {
+        return;
+    }
+    for (u32 i = 0; i < load->listed.size; ++i)
+    {
+        free(load->listed.data[i].path);
+    }
+    array_free(&load->listed);
+    platform_mutex_destroy(&load->mutex);
+    free(load->directory_path);
+    free(load);
+}
+
+internal b8 directory_listing_load_add_chunk(DirectoryItemArray* chunk, void* data)
+{
+    DirectoryListingLoad* load = (DirectoryListingLoad*)data;
+    if (ftic_atomic_load(&load->cancelled))
+    {
+        for (u32 i = 0; i < chunk->size; ++i)
+        {
+            free(chunk->data[i].path);
+        }
+        return false;
+    }
+    platform_mutex_lock(&load->mutex);
+    for (u32 i = 0; i < chunk->size; ++i)
+    {
+        array_push(&load->listed, chunk->data[i]);
+    }
+    platform_mutex_unlock(&load->mutex);
+    return true;
+}
+
+internal THREAD_TASK_ENTRY_POINT(directory_listing_load)
+{
+    DirectoryListingLoad* load = (DirectoryListingLoad*)data;
+    platform_get_directory_chunked(load->directory_path, load->directory_len, true,
+                                   DIRECTORY_CACHE_CHUNK_SIZE, directory_listing_load_add_chunk,
+                                   load);
+    ftic_atomic_store(&load->done, 1);
+    directory_listing_load_release(load);
+}
+
+internal void directory_listing_remove_loading(DirectoryListing* listing)
+{
+    DirectoryListingPtrArray* loading = &g_directory_cache.loading;
+    for (u32 i = 0; i < loading->size; ++i)
+    {
+        if (loading->data[i] == listing)
+        {
+            loading->data[i] = loading->data[--loading->size];
+            break;
+        }
+    }
+}
+
+internal void directory_listing_cancel(DirectoryListing* listing)
+{
+    if (listing->load)
+    {
+        ftic_atomic_store(&listing->load->cancelled, 1);
+        directory_listing_load_release(listing->load);
+        listing->load = NULL;
+        directory_listing_remove_loading(listing);
+    }
+}
+
+internal void directory_listing_free(DirectoryListing* listing)
+{
+    directory_listing_cancel(listing);
+    if (listing->change_handle)
+    {
+        directory_unlisten_to_directory_changes(listing->change_handle);
+    }
+    platform_reset_directory(&listing->directory, false);
+    free(listing);
+}
+
+internal i32 directory_cache_find(const FticGUID* id)
+{
+    const u64* index = hash_table_get_uu64(&g_directory_cache.index, directory_cache_key(id));
+    if (index &&
+        guid_compare(g_directory_cache.listings.data[*index]->directory.parent_id, *id) == 0)
+    {
+        return (i32)*index;
+    }
+    return -1;
+}
+
+// Takes the listing out of the cache, the pages using it keep it alive.
+internal void directory_cache_detach(const u32 index)
+{
+    DirectoryListingPtrArray* listings = &g_directory_cache.listings;
+    DirectoryListing* listing = listings->data[index];
+    hash_table_remove_uu64(&g_directory_cache.index,
+                           directory_cache_key(&listing->directory.parent_id));
+
+    DirectoryListing* last = listings->data[--listings->size];
+    if (index < listings->size)
+    {
+        listings->data[index] = last;
+        hash_table_insert_uu64(&g_directory_cache.index,
+                               directory_cache_key(&last->directory.parent_id), index);
+    }
+
+    if (listing->change_handle)
+    {
+        directory_unlisten_to_directory_changes(listing->change_handle);
+        listing->change_handle = NULL;
+    }
+    listing->cached = false;
+    listing->stale = true;
+    if (listing->reference_count == 0)
+    {
+        directory_listing_free(listing);
+    }
+}
+
+internal void directory_cache_evict_unused(void)
+{
+    DirectoryListingPtrArray* listings = &g_directory_cache.listings;
+    for (;;)
+    {
+        u32 unused_count = 0;
+        i32 oldest = -1;
+        for (u32 i = 0; i < listings->size; ++i)
+        {
+            const DirectoryListing* listing = listings->data[i];
+            if (listing->reference_count == 0)
+            {
+                ++unused_count;
+                if (oldest < 0 || listing->released_time < listings->data[oldest]->released_time)
+                {
+                    oldest = (i32)i;
+                }
+            }
+        }
+        if (unused_count <= DIRECTORY_CACHE_UNUSED_CAPACITY)
+        {
+            return;
+        }
+        directory_cache_detach((u32)oldest);
+    }
+}
+
+void directory_cache_initialize(ThreadTaskQueue* task_queue)
+{
+    g_directory_cache.task_queue = task_queue;
+    g_directory_cache.index = hash_table_create_uu64(64, hash_u64);
+    array_create(&g_directory_cache.listings, 32);
+    array_create(&g_directory_cache.loading, 8);
+}
+
+void directory_cache_uninitialize(void)
+{
+    while (g_directory_cache.listings.size)
+    {
+        DirectoryListing* listing = g_directory_cache.listings.data[0];
+        listing->reference_count = 0;
+        directory_cache_detach(0);
+    }
+    // Loads of folders that were never cached, the workers free their part.
+    while (g_directory_cache.loading.size)
+    {
+        directory_listing_cancel(g_directory_cache.loading.data[0]);
+    }
+    array_free(&g_directory_cache.listings);
+    array_free(&g_directory_cache.loading);
+    hash_table_free_uu64(&g_directory_cache.index);
+    g_directory_cache = (DirectoryCache){ 0 };
+}
+
+DirectoryListing* directory_cache_acquire(const char* directory_path, const u32 directory_len)
+{
+    DirectoryListing* listing = (DirectoryListing*)calloc(1, sizeof(DirectoryListing));
+    listing->directory.parent = string_copy(directory_path, directory_len - 2, 0);
+    const b8 has_id =
+        platform_get_id_from_path(listing->directory.parent, &listing->directory.parent_id);
+    if (has_id)
+    {
+        const i32 index = directory_cache_find(&listing->directory.parent_id);
+        if (index >= 0)
+        {
+            free(listing->directory.parent);
+            free(listing);
+            listing = g_directory_cache.listings.data[index];
+            listing->reference_count++;
+            return listing;
+        }
+    }
+    array_create(&listing->directory.items, 64);
+    listing->reference_count = 1;
+
+    DirectoryListingLoad* load = (DirectoryListingLoad*)calloc(1, sizeof(DirectoryListingLoad));
+    load->directory_path = string_copy(directory_path, directory_len, 0);
+    load->directory_len = directory_len;
+    load->mutex = platform_mutex_create();
+    load->reference_count = 2;
+    array_create(&load->listed, DIRECTORY_CACHE_CHUNK_SIZE);
+    listing->load = load;
+    array_push(&g_directory_cache.loading, listing);
+    ThreadTask task = thread_task(directory_listing_load, load);
+    thread_tasks_push(g_directory_cache.task_queue, &task, 1, NULL);
+
+    if (!has_id)
+    {
+        return listing;
+    }
+
+    // A guid hash collision replaces the other folder.
+    const u64 key = directory_cache_key(&listing->directory.parent_id);
+    const u64* collision = hash_table_get_uu64(&g_directory_cache.index, key);
+    if (collision)
+    {
+        directory_cache_detach((u32)*collision);
+    }
+    listing->cached = true;
+    listing->change_handle = directory_listen_to_directory_changes(listing->directory.parent);
+    array_push(&g_directory_cache.listings, listing);
+    hash_table_insert_uu64(&g_directory_cache.index, key, g_directory_cache.listings.size - 1);
+    return listing;
+}
+
+void directory_cache_retain(DirectoryListing* listing)
+{
+    listing->reference_count++;
+}
+
+void directory_cache_release(DirectoryListing* listing)
+{
+    if (listing == NULL || --listing->reference_count)
+    {
+        return;
+    }
+    if (!listing->cached)
+    {
+        directory_listing_free(listing);
+        return;
+    }
+    listing->released_time = platform_get_time();
+    directory_cache_evict_unused();
+}
+
+void directory_cache_invalidate(DirectoryListing* listing)
+{
+    directory_listing_cancel(listing);
+    listing->stale = true;
+    if (listing->cached)
+    {
+        directory_cache_detach((u32)directory_cache_find(&listing->directory.parent_id));
+    }
+}
+
+void directory_cache_invalidate_all(void)
+{
+    while (g_directory_cache.listings.size)
+    {
+        directory_listing_cancel(g_directory_cache.listings.data[0]);
+        directory_cache_detach(0);
+    }
+}
+
+b8 directory_cache_update(void)
+{
+    b8 changed = false;
+    DirectoryListingPtrArray* loading = &g_directory_cache.loading;
+    for (u32 i = 0; i < loading->size;)
+    {
+        DirectoryListing* listing = loading->data[i];
+        DirectoryListingLoad* load = listing->load;
+        // Read before taking the items, everything listed before done is set
+        // is taken below.
+        const b8 done = ftic_atomic_load(&load->done) != 0;
+
+        platform_mutex_lock(&load->mutex);
+        for (u32 j = 0; j < load->listed.size; ++j)
+        {
+            array_push(&listing->directory.items, load->listed.data[j]);
+        }
+        changed |= load->listed.size != 0;
+        load->listed.size = 0;
+        platform_mutex_unlock(&load->mutex);
+
+        if (done)
+        {
+            directory_listing_load_release(load);
+            listing->load = NULL;
+            loading->data[i] = loading->data[--loading->size];
+            changed = true;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    DirectoryListingPtrArray* listings = &g_directory_cache.listings;
+    for (u32 i = 0; i < listings->size;)
+    {
+        DirectoryListing* listing = listings->data[i];
+        // A folder that changes while it is listed is listed again once the
+        // load is done, not restarted on every change.
+        if (!listing->load && listing->change_handle &&
+            directory_look_for_directory_change(listing->change_handle))
+        {
+            // The last one is moved into this slot.
+            directory_cache_detach(i);
+            changed = true;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    return changed;
+}
+
+u32 directory_cache_size(void)
+{
+    return g_directory_cache.listings.size;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "define.h"
+#include "hash_table.h"
+#include "platform/platform.h"
+#include "thread_queue.h"
+
+// Listings no page is showing are kept this many, the least recently used
+// one goes first.
+#define DIRECTORY_CACHE_UNUSED_CAPACITY 16
+
+// How many items the worker lists before handing them over.
+#define DIRECTORY_CACHE_CHUNK_SIZE 512
+
+// Shared by a listing being loaded and the worker loading it, whichever lets
+// go last frees it.
+typedef struct DirectoryListingLoad
+{
+    char* directory_path;
+    u32 directory_len;
+    FTicMutex mutex;
+    // Listed by the worker and not yet moved into the listing.
+    DirectoryItemArray listed;
+    FTicAtomic cancelled;
+    FTicAtomic done;
+    FTicAtomic reference_count;
+} DirectoryListingLoad;
+
+// A folder as it was read from disk, shared by every tab and history page
+// showing it. The pages copy the items to keep their own order and view
+// state, the paths and the parent stay here and are only pointed to.
+typedef struct DirectoryListing
+{
+    Directory directory;
+    // Set while the folder is still being listed on the thread pool, the items
+    // grow on every directory_cache_update until it is done.
+    DirectoryListingLoad* load;
+    void* change_handle;
+    f64 released_time;
+    u32 reference_count;
+    // In the cache, a folder without an id is listed without being cached.
+    b8 cached;
+    // Changed on disk or replaced by a newer listing, it is only kept for the
+    // pages still using it.
+    b8 stale;
+} DirectoryListing;
+
+typedef struct DirectoryListingPtrArray
+{
+    u32 size;
+    u32 capacity;
+    DirectoryListing** data;
+} DirectoryListingPtrArray;
+
+// Only used from the main thread.
+typedef struct DirectoryCache
+{
+    ThreadTaskQueue* task_queue;
+    // Guid hash of the folder to the index in listings.
+    HashTableUU64 index;
+    DirectoryListingPtrArray listings;
+    // Every listing with a load, cached or not.
+    DirectoryListingPtrArray loading;
+} DirectoryCache;
+
+void directory_cache_initialize(ThreadTaskQueue* task_queue);
+void directory_cache_uninitialize(void);
+// Takes the search pattern, like platform_get_directory. Returns the cached
+// listing of the folder, or starts listing it on the thread pool if it is not
+// cached or has changed, with a reference added either way. Never waits for
+// the disk beyond reading the folder id.
+DirectoryListing* directory_cache_acquire(const char* directory_path, const u32 directory_len);
+void directory_cache_retain(DirectoryListing* listing);
+void directory_cache_release(DirectoryListing* listing);
+// Marks the listing stale and stops its load if it has one.
+void directory_cache_invalidate(DirectoryListing* listing);
+void directory_cache_invalidate_all(void);
+// Moves what the loads have listed into their listings and checks the change
+// notifications. Returns true if any listing got new items or went stale.
+b8 directory_cache_update(void);
+u32 directory_cache_size(void);
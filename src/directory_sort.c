@@ -0,0 +1,329 @@
+#include "directory.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef i32 (*ItemCompareFunction)(const DirectoryItem* first, const DirectoryItem* second);
+
+internal i32 name_compare_function(const DirectoryItem* first, const DirectoryItem* second)
+{
+    return string_compare_case_insensitive(item_namec(first), item_namec(second));
+}
+
+internal i32 date_compare_function(const DirectoryItem* first, const DirectoryItem* second)
+{
+    PlatformTime first_time = platform_time_from_u64(first->last_write_time);
+    PlatformTime second_time = platform_time_from_u64(second->last_write_time);
+    return platform_time_compare(&first_time, &second_time);
+}
+
+internal i32 name_descending_compare_function(const DirectoryItem* first,
+                                              const DirectoryItem* second)
+{
+    return name_compare_function(second, first);
+}
+
+internal i32 size_compare_function(const DirectoryItem* first, const DirectoryItem* second)
+{
+    return (first->size > second->size) - (first->size < second->size);
+}
+
+internal i32 size_descending_compare_function(const DirectoryItem* first,
+                                              const DirectoryItem* second)
+{
+    return size_compare_function(second, first);
+}
+
+// Same order as the radix sort, the raw write time.
+internal i32 write_time_compare_function(const DirectoryItem* first, const DirectoryItem* second)
+{
+    return (first->last_write_time > second->last_write_time) -
+           (first->last_write_time < second->last_write_time);
+}
+
+internal i32 write_time_descending_compare_function(const DirectoryItem* first,
+                                                    const DirectoryItem* second)
+{
+    return write_time_compare_function(second, first);
+}
+
+internal i32 folders_first_compare_function(const DirectoryItem* first,
+                                            const DirectoryItem* second)
+{
+    const b8 first_folder = first->type == FOLDER_DEFAULT;
+    const b8 second_folder = second->type == FOLDER_DEFAULT;
+    if (first_folder != second_folder)
+    {
+        return first_folder ? -1 : 1;
+    }
+    return name_compare_function(first, second);
+}
+
+internal void merge(DirectoryItem* array,
+                    i32 (*compare_function)(const DirectoryItem*, const DirectoryItem*), u32 left,
+                    u32 mid, u32 right)
+{
+    u32 n1 = mid - left + 1;
+    u32 n2 = right - mid;
+
+    DirectoryItem* left_array = (DirectoryItem*)malloc(n1 * sizeof(DirectoryItem));
+    DirectoryItem* right_array = (DirectoryItem*)malloc(n2 * sizeof(DirectoryItem));
+
+    for (u32 i = 0; i < n1; ++i)
+    {
+        left_array[i] = array[left + i];
+    }
+    for (u32 i = 0; i < n2; ++i)
+    {
+        right_array[i] = array[mid + 1 + i];
+    }
+
+    u32 i = 0;
+    u32 j = 0;
+    u32 k = left;
+    while (i < n1 && j < n2)
+    {
+        if (compare_function(left_array + i, right_array + j) <= 0)
+        {
+            array[k] = left_array[i++];
+        }
+        else
+        {
+            array[k] = right_array[j++];
+        }
+        ++k;
+    }
+
+    while (i < n1)
+    {
+        array[k++] = left_array[i++];
+    }
+
+    while (j < n2)
+    {
+        array[k++] = right_array[j++];
+    }
+
+    free(left_array);
+    free(right_array);
+}
+
+internal void merge_sort(DirectoryItem* array,
+                         i32 (*compare_function)(const DirectoryItem*, const DirectoryItem*),
+                         u32 left, u32 right)
+{
+    if (left < right)
+    {
+        u32 mid = left + (right - left) / 2;
+        merge_sort(array, compare_function, left, mid);
+        merge_sort(array, compare_function, mid + 1, right);
+        merge(array, compare_function, left, mid, right);
+    }
+}
+
+void directory_sort_by_name(DirectoryItemArray* array)
+{
+    merge_sort(array->data, name_compare_function, 0, array->size - 1);
+}
+
+void directory_merge_sort_by_date(DirectoryItemArray* array)
+{
+    merge_sort(array->data, date_compare_function, 0, array->size - 1);
+}
+
+void directory_flip_array(DirectoryItemArray* array)
+{
+    const i32 middle = array->size / 2;
+    for (i32 i = 0, j = array->size - 1; i < middle; ++i, --j)
+    {
+        DirectoryItem temp = array->data[i];
+        array->data[i] = array->data[j];
+        array->data[j] = temp;
+    }
+}
+
+void directory_sort_by_size(DirectoryItemArray* array)
+{
+    if (array->size <= 1) return;
+
+    DirectoryItem* output = (DirectoryItem*)calloc(array->size, sizeof(DirectoryItem));
+    u32 count[256] = { 0 };
+
+    for (u32 shift = 0, s = 0; shift < 8; ++shift, s += 8)
+    {
+        memset(count, 0, sizeof(count));
+
+        for (u32 i = 0; i < array->size; ++i)
+        {
+            count[(array->data[i].size >> s) & 0xff]++;
+        }
+
+        for (u32 i = 1; i < 256; ++i)
+        {
+            count[i] += count[i - 1];
+        }
+
+        for (i32 i = array->size - 1; i >= 0; --i)
+        {
+            u32 index = (array->data[i].size >> s) & 0xff;
+            output[--count[index]] = array->data[i];
+        }
+        DirectoryItem* tmp = array->data;
+        array->data = output;
+        output = tmp;
+    }
+    free(output);
+}
+
+void directory_sort_by_date(DirectoryItemArray* array)
+{
+    if (array->size <= 1) return;
+
+    DirectoryItem* output = (DirectoryItem*)calloc(array->size, sizeof(DirectoryItem));
+    u32 count[256] = { 0 };
+
+    for (u32 shift = 0, s = 0; shift < 8; ++shift, s += 8)
+    {
+        memset(count, 0, sizeof(count));
+
+        for (u32 i = 0; i < array->size; ++i)
+        {
+            count[(array->data[i].last_write_time >> s) & 0xff]++;
+        }
+
+        for (u32 i = 1; i < 256; ++i)
+        {
+            count[i] += count[i - 1];
+        }
+
+        for (i32 i = array->size - 1; i >= 0; --i)
+        {
+            u32 index = (array->data[i].last_write_time >> s) & 0xff;
+            output[--count[index]] = array->data[i];
+        }
+        DirectoryItem* tmp = array->data;
+        array->data = output;
+        output = tmp;
+    }
+    free(output);
+}
+
+void directory_sort(DirectoryPage* directory_page)
+{
+    PROFILE_FUNCTION_BEGIN();
+    DirectoryItemArray* items = &directory_page->directory.items;
+    switch (directory_page->sort_by)
+    {
+        case SORT_NAME:
+        {
+            directory_sort_by_name(items);
+            if (directory_page->sort_count == 2)
+            {
+                directory_flip_array(items);
+            }
+            break;
+        }
+        case SORT_SIZE:
+        {
+            directory_sort_by_size(items);
+            if (directory_page->sort_count == 2)
+            {
+                directory_flip_array(items);
+            }
+            break;
+        }
+        case SORT_DATE:
+        {
+            directory_sort_by_date(items);
+            if (directory_page->sort_count == 2)
+            {
+                directory_flip_array(items);
+            }
+            break;
+        }
+        default:
+        {
+            directory_sort_by_name(items);
+
+            // NOTE: very inefficient but does not happen very often.
+            DirectoryItemArray temp = { 0 };
+            array_create(&temp, items->size);
+
+            i32 iterations = (i32)items->size;
+            for (i32 i = 0; i < iterations; ++i)
+            {
+                DirectoryItem* item = items->data + i;
+                if (item->type == FOLDER_DEFAULT)
+                {
+                    array_push(&temp, *item);
+                    for (i32 j = i; j < iterations - 1; ++j)
+                    {
+                        items->data[j] = items->data[j + 1];
+                    }
+                    --i;
+                    --iterations;
+                }
+            }
+            u32 files_to_move = items->size - temp.size;
+            memmove(items->data + temp.size, items->data, files_to_move * sizeof(DirectoryItem));
+            memcpy(items->data, temp.data, temp.size * sizeof(DirectoryItem));
+
+            array_free(&temp);
+            break;
+        }
+    }
+    PROFILE_END();
+}
+
+// The order directory_sort gives the page.
+internal ItemCompareFunction page_compare_function(const DirectoryPage* directory_page)
+{
+    const b8 descending = directory_page->sort_count == 2;
+    switch (directory_page->sort_by)
+    {
+        case SORT_NAME:
+            return descending ? name_descending_compare_function : name_compare_function;
+        case SORT_SIZE:
+            return descending ? size_descending_compare_function : size_compare_function;
+        case SORT_DATE:
+            return descending ? write_time_descending_compare_function
+                              : write_time_compare_function;
+        default: return folders_first_compare_function;
+    }
+}
+
+void directory_sort_merge(DirectoryPage* directory_page, DirectoryItemArray* chunk)
+{
+    if (chunk->size == 0)
+    {
+        return;
+    }
+    PROFILE_FUNCTION_BEGIN();
+    const ItemCompareFunction compare_function = page_compare_function(directory_page);
+    merge_sort(chunk->data, compare_function, 0, chunk->size - 1);
+
+    // Merged from the back so every item already on the page moves once.
+    DirectoryItemArray* items = &directory_page->directory.items;
+    const u32 total = items->size + chunk->size;
+    if (total > items->capacity)
+    {
+        items->capacity = total + total / 2;
+        items->data = (DirectoryItem*)realloc(items->data, items->capacity * sizeof(DirectoryItem));
+    }
+    i64 item_index = (i64)items->size - 1;
+    i64 chunk_index = (i64)chunk->size - 1;
+    for (i64 to = (i64)total - 1; chunk_index >= 0; --to)
+    {
+        if (item_index >= 0 &&
+            compare_function(items->data + item_index, chunk->data + chunk_index) > 0)
+        {
+            items->data[to] = items->data[item_index--];
+        }
+        else
+        {
+            items->data[to] = chunk->data[chunk_index--];
+        }
+    }
+    items->size = total;
+    PROFILE_END();
+}
@@ -0,0 +1,952 @@
+#include "file_operations.h"
+#include "platform/platform.h"
+#include "logging.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+internal long operation_state(FileOperation* operation)
+{
+    return ftic_atomic_load(&operation->state);
+}
+
+internal b8 operation_cancelled(FileOperation* operation)
+{
+    return operation_state(operation) == FILE_OPERATION_CANCELLED;
+}
+
+internal b8 operation_paused(FileOperation* operation)
+{
+    return operation_state(operation) == FILE_OPERATION_PAUSED;
+}
+
+// A worker that finds the operation paused returns to the pool instead of
+// waiting in it, a paused copy would otherwise hold the threads listing,
+// thumbnails and search need. The state is checked again under the lock, so
+// either the worker sees a resume that came in between or the resume sees
+// the worker. Returns false if it should keep going.
+internal b8 operation_park(FileOperation* operation, const ThreadTask task,
+                           const FileCopyBatch* left)
+{
+    sync_mutex_lock(&operation->park_mutex);
+    const b8 parked = operation_paused(operation);
+    if (parked)
+    {
+        operation->parked_task = task;
+        operation->parked_count++;
+        if (left && left->count)
+        {
+            array_push(&operation->parked_batches, *left);
+        }
+    }
+    sync_mutex_unlock(&operation->park_mutex);
+    return parked;
+}
+
+// Called under park_mutex after the state changed from paused.
+internal void operation_unpark(FileOperation* operation)
+{
+    ThreadTask tasks[64] = { 0 };
+    while (operation->parked_count)
+    {
+        const u32 count = ftic_min(operation->parked_count, (u32)static_array_size(tasks));
+        for (u32 i = 0; i < count; ++i)
+        {
+            tasks[i] = operation->parked_task;
+        }
+        thread_tasks_push(operation->task_queue, tasks, count, NULL);
+        operation->parked_count -= count;
+    }
+}
+
+typedef struct FileCopyProgress
+{
+    FileOperation* operation;
+    u64 bytes; // Of the file being copied
+} FileCopyProgress;
+
+// Stops the copy of the file on pause as well, it is copied again from the
+// start once resumed.
+internal b8 file_copy_progress(u64 bytes_copied, void* data)
+{
+    FileCopyProgress* progress = (FileCopyProgress*)data;
+    ftic_atomic_add64(&progress->operation->bytes_done, (i64)bytes_copied);
+    progress->bytes += bytes_copied;
+    return operation_state(progress->operation) == FILE_OPERATION_RUNNING;
+}
+
+internal char* unique_destination_path(const char* directory, const char* name,
+                                       const u32 name_length)
+{
+    const u32 directory_length = (u32)strlen(directory);
+    char* path = concatinate(directory, directory_length, name, name_length,
+                             PLATFORM_PATH_SEPARATOR, 0, NULL);
+    if (!platform_path_exists(path))
+    {
+        return path;
+    }
+    free(path);
+
+    u32 stem_length = name_length;
+    for (u32 i = name_length; i > 1; --i)
+    {
+        if (name[i - 1] == '.')
+        {
+            stem_length = i - 1;
+            break;
+        }
+    }
+    char* unique_name = (char*)calloc(name_length + 32, sizeof(char));
+    for (u32 i = 1;; ++i)
+    {
+        char suffix[24] = { 0 };
+        if (i == 1)
+        {
+            sprintf_s(suffix, sizeof(suffix), " - Copy");
+        }
+        else
+        {
+            sprintf_s(suffix, sizeof(suffix), " - Copy (%u)", i);
+        }
+        const u32 suffix_length = (u32)strlen(suffix);
+        memcpy(unique_name, name, stem_length);
+        memcpy(unique_name + stem_length, suffix, suffix_length);
+        memcpy(unique_name + stem_length + suffix_length, name + stem_length,
+               name_length - stem_length);
+        unique_name[name_length + suffix_length] = '\0';
+
+        path = concatinate(directory, directory_length, unique_name,
+                           name_length + suffix_length, PLATFORM_PATH_SEPARATOR, 0, NULL);
+        if (!platform_path_exists(path))
+        {
+            break;
+        }
+        free(path);
+    }
+    free(unique_name);
+    return path;
+}
+
+internal b8 path_is_inside(const char* path, const char* directory)
+{
+    const size_t directory_length = strlen(directory);
+    if (strlen(path) <= directory_length)
+    {
+        return false;
+    }
+    char* prefix = string_copy(path, (u32)directory_length, 0);
+    const b8 result = !string_compare_case_insensitive(prefix, directory) &&
+                      (path[directory_length] == '\\' || path[directory_length] == '/');
+    free(prefix);
+    return result;
+}
+
+internal void plan_failed(FileOperation* operation, const u32 path_index)
+{
+    ftic_atomic_add(&operation->failed_count, 1);
+    ftic_atomic_store(&operation->path_failed[path_index], 1);
+}
+
+internal void plan_copy(FileOperation* operation, const u32 path_index, const char* source,
+                        char* destination, const b8 directory, const u64 size)
+{
+    if (operation_cancelled(operation))
+    {
+        free(destination);
+        return;
+    }
+    if (!directory)
+    {
+        FileCopyEntry entry = {
+            .source = string_copy_d(source),
+            .destination = destination,
+            .size = size,
+            .path_index = path_index,
+        };
+        array_push(&operation->entries, entry);
+        return;
+    }
+
+    if (platform_create_directory(destination))
+    {
+        PlatformFileEntryArray children = { 0 };
+        array_create(&children, 16);
+        platform_list_directory_entries(source, &children);
+
+        const u32 destination_length = (u32)strlen(destination);
+        for (u32 i = 0; i < children.size; ++i)
+        {
+            PlatformFileEntry* child = children.data + i;
+            if (child->link && (child->directory || platform_directory_exists(child->path)))
+            {
+                // A link to a folder is not followed, it may point back up
+                // the tree. Left out and counted as failed, a move then keeps
+                // its source.
+                plan_failed(operation, path_index);
+                free(child->path);
+                continue;
+            }
+            const u32 child_length = (u32)strlen(child->path);
+            const u32 name_offset = get_path_length(child->path, child_length);
+            char* child_destination =
+                concatinate(destination, destination_length, child->path + name_offset,
+                            child_length - name_offset, PLATFORM_PATH_SEPARATOR, 0, NULL);
+            plan_copy(operation, path_index, child->path, child_destination, child->directory,
+                      child->size);
+            free(child->path);
+        }
+        free(children.data);
+    }
+    else
+    {
+        plan_failed(operation, path_index);
+    }
+    free(destination);
+}
+
+internal void push_batch(FileOperation* operation, FileCopyBatch* batch, u64* batch_size)
+{
+    if (batch->count)
+    {
+        array_push(&operation->batches, *batch);
+    }
+    batch->first += batch->count;
+    batch->count = 0;
+    *batch_size = 0;
+}
+
+internal void build_batches(FileOperation* operation)
+{
+    FileCopyBatch batch = { 0 };
+    u64 batch_size = 0;
+    u64 bytes_total = 0;
+    for (u32 i = 0; i < operation->entries.size; ++i)
+    {
+        const u64 size = operation->entries.data[i].size;
+        bytes_total += size;
+        if (size >= FILE_OPERATION_LARGE_FILE_SIZE)
+        {
+            push_batch(operation, &batch, &batch_size);
+        }
+        batch.count++;
+        batch_size += size;
+        if (size >= FILE_OPERATION_LARGE_FILE_SIZE || batch_size >= FILE_OPERATION_BATCH_SIZE ||
+            batch.count >= FILE_OPERATION_BATCH_MAX_FILES)
+        {
+            push_batch(operation, &batch, &batch_size);
+        }
+    }
+    push_batch(operation, &batch, &batch_size);
+
+    ftic_atomic_add64(&operation->bytes_total, (i64)bytes_total);
+    ftic_atomic_add(&operation->files_total, (long)operation->entries.size);
+}
+
+internal void move_delete_sources(FileOperation* operation);
+
+// Pushes up to one worker per pool thread, never more than there is work for.
+// running, if given, is raised by the number of workers before they start.
+internal void push_workers(FileOperation* operation, const ThreadTask worker,
+                           const u32 work_count, FTicAtomic* running)
+{
+    ThreadTask tasks[64] = { 0 };
+    const u32 worker_count =
+        ftic_min(ftic_min(ftic_max(global_thread_count, 1), work_count),
+                 (u32)static_array_size(tasks));
+    for (u32 i = 0; i < worker_count; ++i)
+    {
+        tasks[i] = worker;
+    }
+    if (running)
+    {
+        ftic_atomic_add(running, (long)worker_count);
+    }
+    ftic_atomic_add(&operation->pending_tasks, (long)worker_count);
+    const u32 pushed = thread_tasks_push(operation->task_queue, tasks, worker_count, NULL);
+    if (pushed < worker_count)
+    {
+        // The queue is full. The workers that got in take all of the work
+        // between them, without any the operation can not go on.
+        const long dropped = (long)(worker_count - pushed);
+        if (!pushed)
+        {
+            ftic_atomic_store(&operation->state, FILE_OPERATION_CANCELLED);
+        }
+        if (running && ftic_atomic_add(running, -dropped) == dropped && pushed)
+        {
+            // They were all done before this, so none of them was the last.
+            move_delete_sources(operation);
+        }
+        ftic_atomic_add(&operation->pending_tasks, -dropped);
+    }
+}
+
+// What parked workers left goes first.
+internal b8 file_copy_next_batch(FileOperation* operation, FileCopyBatch* batch)
+{
+    b8 found = false;
+    sync_mutex_lock(&operation->park_mutex);
+    if (operation->parked_batches.size)
+    {
+        *batch = operation->parked_batches.data[--operation->parked_batches.size];
+        found = true;
+    }
+    sync_mutex_unlock(&operation->park_mutex);
+    if (!found)
+    {
+        const long batch_index = ftic_atomic_add(&operation->next_batch, 1);
+        found = batch_index < (long)operation->batches.size;
+        if (found)
+        {
+            *batch = operation->batches.data[batch_index];
+        }
+    }
+    return found;
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_copy_worker)
+{
+    FileOperation* operation = (FileOperation*)data;
+    FileCopyBatch batch = { 0 };
+    while (!operation_cancelled(operation) && file_copy_next_batch(operation, &batch))
+    {
+        while (batch.count && !operation_cancelled(operation))
+        {
+            if (operation_paused(operation) &&
+                operation_park(operation, thread_task(file_copy_worker, operation), &batch))
+            {
+                return;
+            }
+            const FileCopyEntry* entry = operation->entries.data + batch.first;
+            FileCopyProgress progress = { .operation = operation };
+            if (!platform_copy_file(entry->source, entry->destination,
+                                    entry->size >= FILE_OPERATION_LARGE_FILE_SIZE,
+                                    file_copy_progress, &progress))
+            {
+                if (operation_paused(operation))
+                {
+                    // Stopped half way, the partial copy is gone.
+                    ftic_atomic_add64(&operation->bytes_done, -(i64)progress.bytes);
+                    continue;
+                }
+                if (!operation_cancelled(operation))
+                {
+                    ftic_atomic_add(&operation->failed_count, 1);
+                    ftic_atomic_store(&operation->path_failed[entry->path_index], 1);
+                }
+            }
+            ftic_atomic_add(&operation->files_done, 1);
+            batch.first++;
+            batch.count--;
+        }
+    }
+    if (operation->type == FILE_OPERATION_MOVE &&
+        ftic_atomic_add(&operation->copy_workers, -1) == 1)
+    {
+        move_delete_sources(operation);
+    }
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+internal void plan_copies(FileOperation* operation, const CharPtrArray* paths)
+{
+    operation->path_failed = (FTicAtomic*)calloc(paths->size, sizeof(FTicAtomic));
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        const char* source = paths->data[i];
+        const u32 source_length = (u32)strlen(source);
+        const u32 name_offset = get_path_length(source, source_length);
+        const b8 directory = platform_directory_exists(source);
+        if (directory && (platform_is_link(source) ||
+                          path_is_inside(operation->destination, source) ||
+                          !string_compare_case_insensitive(operation->destination, source)))
+        {
+            plan_failed(operation, i);
+            continue;
+        }
+        char* destination = unique_destination_path(
+            operation->destination, source + name_offset, source_length - name_offset);
+        const u64 size = directory ? 0 : platform_get_file_size(source);
+        plan_copy(operation, i, source, destination, directory, size);
+    }
+    build_batches(operation);
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_copy_plan)
+{
+    FileOperation* operation = (FileOperation*)data;
+    plan_copies(operation, &operation->paths);
+    if (!operation_cancelled(operation) && operation->batches.size)
+    {
+        push_workers(operation, thread_task(file_copy_worker, operation),
+                     operation->batches.size, NULL);
+    }
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_move)
+{
+    FileOperation* operation = (FileOperation*)data;
+    for (; operation->next_path < operation->paths.size; ++operation->next_path)
+    {
+        if (operation_paused(operation) &&
+            operation_park(operation, thread_task(file_move, operation), NULL))
+        {
+            return;
+        }
+        if (operation_cancelled(operation))
+        {
+            break;
+        }
+        char* source = operation->paths.data[operation->next_path];
+        if (!platform_same_volume(source, operation->destination))
+        {
+            // Counted again file by file as it is copied and deleted.
+            ftic_atomic_add(&operation->files_total, -1);
+            array_push(&operation->volume_paths, source);
+            continue;
+        }
+        // Same volume, the whole tree moves with one rename.
+        const u32 source_length = (u32)strlen(source);
+        const u32 name_offset = get_path_length(source, source_length);
+        if (path_is_inside(operation->destination, source) ||
+            !string_compare_case_insensitive(operation->destination, source))
+        {
+            ftic_atomic_add(&operation->failed_count, 1);
+        }
+        else
+        {
+            char* destination = unique_destination_path(
+                operation->destination, source + name_offset, source_length - name_offset);
+            if (!platform_rename(source, destination))
+            {
+                ftic_atomic_add(&operation->failed_count, 1);
+            }
+            free(destination);
+        }
+        ftic_atomic_add(&operation->files_done, 1);
+    }
+    if (operation->volume_paths.size && !operation_cancelled(operation))
+    {
+        plan_copies(operation, &operation->volume_paths);
+        if (operation->batches.size)
+        {
+            push_workers(operation, thread_task(file_copy_worker, operation),
+                         operation->batches.size, &operation->copy_workers);
+        }
+        else
+        {
+            move_delete_sources(operation);
+        }
+    }
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_recycle)
+{
+    FileOperation* operation = (FileOperation*)data;
+    for (; operation->next_path < operation->paths.size;
+         operation->next_path += FILE_OPERATION_RECYCLE_BATCH)
+    {
+        if (operation_paused(operation) &&
+            operation_park(operation, thread_task(file_recycle, operation), NULL))
+        {
+            return;
+        }
+        if (operation_cancelled(operation))
+        {
+            break;
+        }
+        const u32 i = operation->next_path;
+        CharPtrArray batch = {
+            .size = ftic_min(operation->paths.size - i, FILE_OPERATION_RECYCLE_BATCH),
+            .data = operation->paths.data + i,
+        };
+        batch.capacity = batch.size;
+        platform_delete_files(&batch);
+        ftic_atomic_add(&operation->files_done, (long)batch.size);
+    }
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+// Drops one reference to the folder. The last one removes it and walks up to
+// the parent, which may now be empty as well.
+internal void delete_node_release(FileOperation* operation, DeleteNode* node)
+{
+    while (node && ftic_atomic_add(&node->pending, -1) == 1)
+    {
+        if (!operation_cancelled(operation))
+        {
+            if (platform_remove_directory(node->path))
+            {
+                ftic_atomic_add(&operation->files_done, 1);
+            }
+            else
+            {
+                ftic_atomic_add(&operation->failed_count, 1);
+            }
+        }
+        DeleteNode* parent = node->parent;
+        free(node->path);
+        free(node);
+        node = parent;
+    }
+}
+
+internal DeleteNode* delete_node_create(FileOperation* operation, char* path, DeleteNode* parent)
+{
+    DeleteNode* node = (DeleteNode*)calloc(1, sizeof(DeleteNode));
+    node->path = path;
+    node->parent = parent;
+    node->pending = 1;
+    ftic_atomic_add(&operation->files_total, 1);
+    ftic_atomic_add(&operation->listings_pending, 1);
+    if (parent)
+    {
+        ftic_atomic_add(&parent->pending, 1);
+    }
+    return node;
+}
+
+internal void delete_file(FileOperation* operation, const char* path)
+{
+    if (platform_delete_file(path))
+    {
+        ftic_atomic_add(&operation->files_done, 1);
+    }
+    else
+    {
+        ftic_atomic_add(&operation->failed_count, 1);
+    }
+}
+
+// Removes a junction or symbolic link to a folder without following it.
+internal void delete_link(FileOperation* operation, const char* path)
+{
+    if (platform_remove_link(path))
+    {
+        ftic_atomic_add(&operation->files_done, 1);
+    }
+    else
+    {
+        ftic_atomic_add(&operation->failed_count, 1);
+    }
+}
+
+internal b8 delete_node_progress(u32 deleted, u32 failed, void* data)
+{
+    FileOperation* operation = (FileOperation*)data;
+    ftic_atomic_add(&operation->files_total, (long)(deleted + failed));
+    ftic_atomic_add(&operation->files_done, (long)deleted);
+    ftic_atomic_add(&operation->failed_count, (long)failed);
+    return !operation_cancelled(operation);
+}
+
+// The files go while the folder is listed, only the sub folders come back.
+internal void delete_node_list(FileOperation* operation, DeleteNode* node,
+                               DeleteNodePtrArray* children)
+{
+    CharPtrArray folders = { 0 };
+    array_create(&folders, 8);
+    platform_delete_directory_files(node->path, &folders, delete_node_progress, operation);
+    for (u32 i = 0; i < folders.size; ++i)
+    {
+        array_push(children, delete_node_create(operation, folders.data[i], node));
+    }
+    free(folders.data);
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_delete_worker)
+{
+    FileOperation* operation = (FileOperation*)data;
+    DeleteNodePtrArray children = { 0 };
+    array_create(&children, 32);
+    for (;;)
+    {
+        // A pause takes effect between folders, the one being emptied is
+        // finished first.
+        if (operation_paused(operation) &&
+            operation_park(operation, thread_task(file_delete_worker, operation), NULL))
+        {
+            free(children.data);
+            return;
+        }
+        DeleteNode* node = NULL;
+        platform_mutex_lock(&operation->delete_mutex);
+        if (operation->delete_stack.size)
+        {
+            node = operation->delete_stack.data[--operation->delete_stack.size];
+        }
+        platform_mutex_unlock(&operation->delete_mutex);
+
+        if (node == NULL)
+        {
+            if (ftic_atomic_load(&operation->listings_pending) == 0)
+            {
+                break;
+            }
+            // Another worker is still listing and may push folders. Sleep
+            // until it does, its listing is done or the operation is paused.
+            const u32 key = sync_event_count_prepare_wait(&operation->delete_event);
+            b8 ready = operation_paused(operation) ||
+                       ftic_atomic_load(&operation->listings_pending) == 0;
+            if (!ready)
+            {
+                platform_mutex_lock(&operation->delete_mutex);
+                ready = operation->delete_stack.size != 0;
+                platform_mutex_unlock(&operation->delete_mutex);
+            }
+            if (ready)
+            {
+                sync_event_count_cancel_wait(&operation->delete_event);
+            }
+            else
+            {
+                sync_event_count_wait(&operation->delete_event, key);
+            }
+            continue;
+        }
+
+        children.size = 0;
+        if (!operation_cancelled(operation))
+        {
+            delete_node_list(operation, node, &children);
+        }
+        if (children.size)
+        {
+            platform_mutex_lock(&operation->delete_mutex);
+            for (u32 i = 0; i < children.size; ++i)
+            {
+                array_push(&operation->delete_stack, children.data[i]);
+            }
+            platform_mutex_unlock(&operation->delete_mutex);
+        }
+        // Pushed before the listing is marked done, so no worker sees an empty
+        // stack with nothing pending while there is work left.
+        ftic_atomic_add(&operation->listings_pending, -1);
+        sync_event_count_notify(&operation->delete_event);
+        delete_node_release(operation, node);
+    }
+    free(children.data);
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+internal void delete_plan(FileOperation* operation, const CharPtrArray* paths)
+{
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        const char* path = paths->data[i];
+        const b8 directory = platform_directory_exists(path);
+        if (directory && platform_is_link(path))
+        {
+            ftic_atomic_add(&operation->files_total, 1);
+            delete_link(operation, path);
+        }
+        else if (directory)
+        {
+            DeleteNode* node = delete_node_create(operation, string_copy_d(path), NULL);
+            array_push(&operation->delete_stack, node);
+        }
+        else
+        {
+            ftic_atomic_add(&operation->files_total, 1);
+            delete_file(operation, path);
+        }
+    }
+    if (operation->delete_stack.size)
+    {
+        push_workers(operation, thread_task(file_delete_worker, operation), global_thread_count,
+                     NULL);
+    }
+}
+
+internal THREAD_TASK_ENTRY_POINT(file_delete_plan)
+{
+    FileOperation* operation = (FileOperation*)data;
+    delete_plan(operation, &operation->paths);
+    ftic_atomic_add(&operation->pending_tasks, -1);
+}
+
+// Called once every copy of a move across volumes is done. A source is only
+// deleted if all of it was copied, anything that failed, in the plan or in
+// a copy, leaves the source where it was.
+internal void move_delete_sources(FileOperation* operation)
+{
+    if (operation_cancelled(operation))
+    {
+        return;
+    }
+    CharPtrArray copied = { 0 };
+    array_create(&copied, operation->volume_paths.size);
+    for (u32 i = 0; i < operation->volume_paths.size; ++i)
+    {
+        if (!ftic_atomic_load(&operation->path_failed[i]))
+        {
+            array_push(&copied, operation->volume_paths.data[i]);
+        }
+    }
+    delete_plan(operation, &copied);
+    free(copied.data);
+}
+
+internal FileOperation* file_operation_create(FileOperationQueue* queue,
+                                              const FileOperationType type,
+                                              const CharPtrArray* paths,
+                                              const char* destination)
+{
+    FileOperation* operation = (FileOperation*)calloc(1, sizeof(FileOperation));
+    operation->type = type;
+    operation->task_queue = queue->task_queue;
+    operation->start_time = platform_get_time();
+    operation->pending_tasks = 1;
+    operation->files_total = (long)paths->size;
+
+    // The shell functions want double null terminated paths.
+    array_create(&operation->paths, paths->size);
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        const char* path = paths->data[i];
+        array_push(&operation->paths, string_copy(path, (u32)strlen(path), 1));
+    }
+    if (destination)
+    {
+        operation->destination = string_copy(destination, (u32)strlen(destination), 1);
+    }
+    array_create(&operation->entries, 16);
+    array_create(&operation->batches, 4);
+    array_create(&operation->parked_batches, 4);
+    array_create(&operation->volume_paths, 4);
+    array_create(&operation->delete_stack, 16);
+    operation->delete_mutex = platform_mutex_create();
+
+    array_push(&queue->operations, operation);
+    return operation;
+}
+
+internal void file_operation_free(FileOperation* operation)
+{
+    for (u32 i = 0; i < operation->paths.size; ++i)
+    {
+        free(operation->paths.data[i]);
+    }
+    free(operation->paths.data);
+    for (u32 i = 0; i < operation->entries.size; ++i)
+    {
+        free(operation->entries.data[i].source);
+        free(operation->entries.data[i].destination);
+    }
+    free(operation->entries.data);
+    free(operation->batches.data);
+    free(operation->parked_batches.data);
+    free(operation->volume_paths.data);
+    free(operation->path_failed);
+    free(operation->delete_stack.data);
+    platform_mutex_destroy(&operation->delete_mutex);
+    free(operation->destination);
+    free(operation);
+}
+
+void file_operation_queue_create(ThreadTaskQueue* task_queue, FileOperationQueue* queue)
+{
+    queue->task_queue = task_queue;
+    array_create(&queue->operations, 4);
+}
+
+void file_operation_queue_destroy(FileOperationQueue* queue)
+{
+    file_operation_queue_cancel(queue);
+    for (u32 i = 0; i < queue->operations.size; ++i)
+    {
+        FileOperation* operation = queue->operations.data[i];
+        while (!file_operation_done(operation))
+        {
+            platform_sleep(1);
+        }
+        file_operation_free(operation);
+    }
+    free(queue->operations.data);
+    queue->operations = (FileOperationPtrArray){ 0 };
+}
+
+b8 file_operation_queue_update(FileOperationQueue* queue)
+{
+    b8 finished = false;
+    u32 write = 0;
+    for (u32 i = 0; i < queue->operations.size; ++i)
+    {
+        FileOperation* operation = queue->operations.data[i];
+        if (file_operation_done(operation))
+        {
+            if (operation->failed_count)
+            {
+                log_message("File operation finished with failures",
+                            strlen("File operation finished with failures"));
+            }
+            file_operation_free(operation);
+            finished = true;
+        }
+        else
+        {
+            queue->operations.data[write++] = operation;
+        }
+    }
+    queue->operations.size = write;
+    return finished;
+}
+
+b8 file_operation_queue_progress(const FileOperationQueue* queue, FileOperationProgress* progress)
+{
+    *progress = (FileOperationProgress){ .seconds_left = -1.0, .paused = true };
+    if (!queue->operations.size)
+    {
+        return false;
+    }
+    f64 seconds_left = 0.0;
+    for (u32 i = 0; i < queue->operations.size; ++i)
+    {
+        const FileOperationProgress current =
+            file_operation_get_progress(queue->operations.data[i]);
+        progress->bytes_done += current.bytes_done;
+        progress->bytes_total += current.bytes_total;
+        progress->files_done += current.files_done;
+        progress->files_total += current.files_total;
+        progress->bytes_per_second += current.bytes_per_second;
+        progress->paused &= current.paused;
+        if (current.seconds_left < 0.0)
+        {
+            seconds_left = -1.0;
+        }
+        else if (seconds_left >= 0.0)
+        {
+            // The operations run side by side, so the slowest one decides.
+            seconds_left = ftic_max(seconds_left, current.seconds_left);
+        }
+    }
+    progress->seconds_left = seconds_left;
+    return true;
+}
+
+void file_operation_queue_pause(FileOperationQueue* queue, b8 pause)
+{
+    for (u32 i = 0; i < queue->operations.size; ++i)
+    {
+        file_operation_pause(queue->operations.data[i], pause);
+    }
+}
+
+void file_operation_queue_cancel(FileOperationQueue* queue)
+{
+    for (u32 i = 0; i < queue->operations.size; ++i)
+    {
+        file_operation_cancel(queue->operations.data[i]);
+    }
+}
+
+FileOperation* file_operation_copy(FileOperationQueue* queue, const CharPtrArray* paths,
+                                   const char* destination)
+{
+    FileOperation* operation =
+        file_operation_create(queue, FILE_OPERATION_COPY, paths, destination);
+    operation->files_total = 0;
+    ThreadTask task = thread_task(file_copy_plan, operation);
+    thread_tasks_push(queue->task_queue, &task, 1, NULL);
+    return operation;
+}
+
+FileOperation* file_operation_move(FileOperationQueue* queue, const CharPtrArray* paths,
+                                   const char* destination)
+{
+    FileOperation* operation =
+        file_operation_create(queue, FILE_OPERATION_MOVE, paths, destination);
+    ThreadTask task = thread_task(file_move, operation);
+    thread_tasks_push(queue->task_queue, &task, 1, NULL);
+    return operation;
+}
+
+FileOperation* file_operation_delete(FileOperationQueue* queue, const CharPtrArray* paths,
+                                     b8 permanent)
+{
+    FileOperation* operation = file_operation_create(queue, FILE_OPERATION_DELETE, paths, NULL);
+    operation->permanent = permanent;
+    ThreadTask task = { 0 };
+    if (permanent)
+    {
+        // The total grows as the trees are listed.
+        operation->files_total = 0;
+        task = thread_task(file_delete_plan, operation);
+    }
+    else
+    {
+        task = thread_task(file_recycle, operation);
+    }
+    thread_tasks_push(queue->task_queue, &task, 1, NULL);
+    return operation;
+}
+
+b8 file_operation_done(FileOperation* operation)
+{
+    return ftic_atomic_load(&operation->pending_tasks) == 0;
+}
+
+void file_operation_pause(FileOperation* operation, b8 pause)
+{
+    if (pause)
+    {
+        if (ftic_atomic_compare_exchange(&operation->state, FILE_OPERATION_PAUSED,
+                                                FILE_OPERATION_RUNNING) ==
+            FILE_OPERATION_RUNNING)
+        {
+            operation->pause_time = platform_get_time();
+            sync_event_count_notify(&operation->delete_event);
+        }
+        return;
+    }
+    sync_mutex_lock(&operation->park_mutex);
+    if (ftic_atomic_compare_exchange(&operation->state, FILE_OPERATION_RUNNING,
+                                     FILE_OPERATION_PAUSED) == FILE_OPERATION_PAUSED)
+    {
+        operation->paused_duration += platform_get_time() - operation->pause_time;
+        operation_unpark(operation);
+    }
+    sync_mutex_unlock(&operation->park_mutex);
+}
+
+// Parked workers are pushed again to see the cancel and finish.
+void file_operation_cancel(FileOperation* operation)
+{
+    sync_mutex_lock(&operation->park_mutex);
+    ftic_atomic_store(&operation->state, FILE_OPERATION_CANCELLED);
+    operation_unpark(operation);
+    sync_mutex_unlock(&operation->park_mutex);
+}
+
+FileOperationProgress file_operation_get_progress(FileOperation* operation)
+{
+    FileOperationProgress progress = { .seconds_left = -1.0 };
+    progress.bytes_done = (u64)ftic_atomic_load64(&operation->bytes_done);
+    progress.bytes_total = (u64)ftic_atomic_load64(&operation->bytes_total);
+    progress.files_done = (u32)ftic_atomic_load(&operation->files_done);
+    progress.files_total = (u32)ftic_atomic_load(&operation->files_total);
+    progress.paused = operation_state(operation) == FILE_OPERATION_PAUSED;
+
+    const f64 now = progress.paused ? operation->pause_time : platform_get_time();
+    const f64 elapsed = now - operation->start_time - operation->paused_duration;
+    if (elapsed <= 0.0)
+    {
+        return progress;
+    }
+    progress.bytes_per_second = progress.bytes_done / elapsed;
+
+    if (progress.bytes_total && progress.bytes_per_second > 0.0)
+    {
+        const u64 bytes_left = progress.bytes_total - ftic_min(progress.bytes_done, progress.bytes_total);
+        progress.seconds_left = bytes_left / progress.bytes_per_second;
+    }
+    else if (!progress.bytes_total && progress.files_done && progress.files_total)
+    {
+        // Moves and deletes do not know their size, estimate from the items.
+        const u32 files_left = progress.files_total - ftic_min(progress.files_done, progress.files_total);
+        progress.seconds_left = (elapsed / progress.files_done) * files_left;
+    }
+    return progress;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include "define.h"
+#include "thread_queue.h"
+#include "sync.h"
+
+// Files at or above this size are copied unbuffered and get a batch of their
+// own, smaller files are grouped so each task moves a reasonable amount.
+#define FILE_OPERATION_LARGE_FILE_SIZE (256ULL * 1024 * 1024)
+#define FILE_OPERATION_BATCH_SIZE (32ULL * 1024 * 1024)
+#define FILE_OPERATION_BATCH_MAX_FILES 128
+// Paths handed to the recycle bin in one shell call.
+#define FILE_OPERATION_RECYCLE_BATCH 64
+
+typedef enum FileOperationType
+{
+    FILE_OPERATION_COPY,
+    FILE_OPERATION_MOVE,
+    FILE_OPERATION_DELETE,
+} FileOperationType;
+
+typedef enum FileOperationState
+{
+    FILE_OPERATION_RUNNING = 0,
+    FILE_OPERATION_PAUSED,
+    FILE_OPERATION_CANCELLED,
+} FileOperationState;
+
+typedef struct FileCopyEntry
+{
+    char* source;
+    char* destination;
+    u64 size;
+    u32 path_index; // The planned path it is part of
+} FileCopyEntry;
+
+typedef struct FileCopyEntryArray
+{
+    u32 size;
+    u32 capacity;
+    FileCopyEntry* data;
+} FileCopyEntryArray;
+
+typedef struct FileCopyBatch
+{
+    u32 first;
+    u32 count;
+} FileCopyBatch;
+
+typedef struct FileCopyBatchArray
+{
+    u32 size;
+    u32 capacity;
+    FileCopyBatch* data;
+} FileCopyBatchArray;
+
+// A folder in a permanent delete. pending counts its own listing plus every
+// child folder still alive, the folder is removed when it reaches zero, so
+// deletion runs bottom up without a separate pass.
+typedef struct DeleteNode DeleteNode;
+struct DeleteNode
+{
+    char* path;
+    DeleteNode* parent;
+    FTicAtomic pending;
+};
+
+typedef struct DeleteNodePtrArray
+{
+    u32 size;
+    u32 capacity;
+    DeleteNode** data;
+} DeleteNodePtrArray;
+
+typedef struct FileOperation
+{
+    FileOperationType type;
+    CharPtrArray paths;
+    char* destination;
+    ThreadTaskQueue* task_queue;
+
+    // Written by the planning task before any copy task is pushed.
+    FileCopyEntryArray entries;
+    FileCopyBatchArray batches;
+    FTicAtomic* path_failed; // Per planned path, set when a part of it was not copied
+    FTicAtomic next_batch;
+    u32 next_path; // Moves and recycles run as one task
+
+    // Workers that found the operation paused and went back to the pool.
+    // They still count in pending_tasks and are pushed again on resume or
+    // cancel, parked copy workers leave what was left of their batch.
+    SyncMutex park_mutex;
+    ThreadTask parked_task;
+    u32 parked_count;
+    FileCopyBatchArray parked_batches;
+
+    // Sources of a move on another volume, borrowed from paths. They are
+    // copied and then deleted, each only if all of it was copied.
+    CharPtrArray volume_paths;
+    FTicAtomic copy_workers;
+
+    b8 permanent;
+    FTicMutex delete_mutex;
+    DeleteNodePtrArray delete_stack;
+    FTicAtomic listings_pending;
+    SyncEventCount delete_event; // A listing done or the operation paused
+
+    FTicAtomic state;
+    FTicAtomic pending_tasks;
+    FTicAtomic files_done;
+    FTicAtomic files_total;
+    FTicAtomic failed_count;
+    FTicAtomic64 bytes_done;
+    FTicAtomic64 bytes_total;
+
+    f64 start_time;
+    f64 pause_time;
+    f64 paused_duration;
+} FileOperation;
+
+typedef struct FileOperationPtrArray
+{
+    u32 size;
+    u32 capacity;
+    FileOperation** data;
+} FileOperationPtrArray;
+
+typedef struct FileOperationQueue
+{
+    ThreadTaskQueue* task_queue;
+    FileOperationPtrArray operations;
+} FileOperationQueue;
+
+typedef struct FileOperationProgress
+{
+    u64 bytes_done;
+    u64 bytes_total;
+    u32 files_done;
+    u32 files_total;
+    f64 bytes_per_second;
+    f64 seconds_left; // Negative until there is enough to estimate from
+    b8 paused;
+} FileOperationProgress;
+
+void file_operation_queue_create(ThreadTaskQueue* task_queue, FileOperationQueue* queue);
+void file_operation_queue_destroy(FileOperationQueue* queue);
+b8 file_operation_queue_update(FileOperationQueue* queue);
+b8 file_operation_queue_progress(const FileOperationQueue* queue, FileOperationProgress* progress);
+void file_operation_queue_pause(FileOperationQueue* queue, b8 pause);
+void file_operation_queue_cancel(FileOperationQueue* queue);
+
+FileOperation* file_operation_copy(FileOperationQueue* queue, const CharPtrArray* paths, const char* destination);
+FileOperation* file_operation_move(FileOperationQueue* queue, const CharPtrArray* paths, const char* destination);
+FileOperation* file_operation_delete(FileOperationQueue* queue, const CharPtrArray* paths, b8 permanent);
+b8 file_operation_done(FileOperation* operation);
+void file_operation_pause(FileOperation* operation, b8 pause);
+void file_operation_cancel(FileOperation* operation);
+FileOperationProgress file_operation_get_progress(FileOperation* operation);
@@ -0,0 +1,247 @@
+#include "folder_size.h"
+#include "hash.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct FolderSizeWalk
+{
+    FolderSizeService* service;
+    FolderSize* entry;
+    char* path;
+} FolderSizeWalk;
+
+internal b8 folder_size_stopped(FolderSizeService* service)
+{
+    return ftic_atomic_load(&service->stop) != 0;
+}
+
+internal THREAD_TASK_ENTRY_POINT(folder_size_walk)
+{
+    FolderSizeWalk* walk = (FolderSizeWalk*)data;
+    FolderSize* entry = walk->entry;
+
+    // Listened to before the walk, so a change while it runs is not missed.
+    // A new listener also covers folders made since the last one.
+    if (entry->change_handle)
+    {
+        directory_unlisten_to_directory_changes(entry->change_handle);
+        entry->change_handle = NULL;
+    }
+    if (entry->listen && !folder_size_stopped(walk->service))
+    {
+        entry->change_handle = directory_listen_to_tree_changes(walk->path);
+    }
+
+    CharPtrArray stack = { 0 };
+    array_create(&stack, 32);
+    array_push(&stack, walk->path);
+
+    PlatformFileEntryArray entries = { 0 };
+    array_create(&entries, 64);
+
+    ftic_atomic_store64(&entry->partial_size, 0);
+    i64 unpublished = 0;
+    i64 total = 0;
+    u32 folders_since_publish = 0;
+    while (stack.size && !folder_size_stopped(walk->service))
+    {
+        char* path = stack.data[--stack.size];
+        entries.size = 0;
+        platform_list_directory_entries(path, &entries);
+        free(path);
+
+        for (u32 i = 0; i < entries.size; ++i)
+        {
+            PlatformFileEntry* child = entries.data + i;
+            if (child->directory && !child->link)
+            {
+                array_push(&stack, child->path);
+            }
+            else
+            {
+                unpublished += (i64)child->size;
+                free(child->path);
+            }
+        }
+        if (++folders_since_publish >= 16)
+        {
+            ftic_atomic_add64(&entry->partial_size, unpublished);
+            total += unpublished;
+            unpublished = 0;
+            folders_since_publish = 0;
+        }
+    }
+    ftic_atomic_add64(&entry->partial_size, unpublished);
+    total += unpublished;
+
+    if (!folder_size_stopped(walk->service))
+    {
+        ftic_atomic_store64(&entry->size, total);
+    }
+    for (u32 i = 0; i < stack.size; ++i)
+    {
+        free(stack.data[i]);
+    }
+    free(stack.data);
+    free(entries.data);
+
+    ftic_atomic_store(&entry->state, FOLDER_SIZE_IDLE);
+    ftic_atomic_add(&walk->service->pending, -1);
+    free(walk);
+}
+
+internal FolderSize* folder_size_get(FolderSizeService* service, const FticGUID* id)
+{
+    // The generated tables have no guid to integer variant, the guid hash is
+    // the key and the entry keeps the full id to catch collisions.
+    const u64 key = hash_guid(id, sizeof(FticGUID), 0);
+    u64* index = hash_table_get_uu64(&service->index, key);
+    if (index && guid_compare(service->entries.data[*index]->id, *id) == 0)
+    {
+        return service->entries.data[*index];
+    }
+    FolderSize* entry = (FolderSize*)calloc(1, sizeof(FolderSize));
+    entry->id = *id;
+    entry->size = -1;
+    array_push(&service->entries, entry);
+    hash_table_insert_uu64(&service->index, key, service->entries.size - 1);
+    return entry;
+}
+
+void folder_size_service_create(ThreadTaskQueue* task_queue, FolderSizeService* service)
+{
+    service->task_queue = task_queue;
+    service->index = hash_table_create_uu64(256, hash_u64);
+    array_create(&service->entries, 256);
+    array_create(&service->listening, FOLDER_SIZE_MAX_LISTENERS);
+}
+
+void folder_size_service_destroy(FolderSizeService* service)
+{
+    ftic_atomic_store(&service->stop, 1);
+    while (ftic_atomic_load(&service->pending))
+    {
+        platform_sleep(1);
+    }
+    for (u32 i = 0; i < service->entries.size; ++i)
+    {
+        if (service->entries.data[i]->change_handle)
+        {
+            directory_unlisten_to_directory_changes(service->entries.data[i]->change_handle);
+        }
+        free(service->entries.data[i]);
+    }
+    free(service->entries.data);
+    free(service->listening.data);
+    hash_table_free_uu64(&service->index);
+}
+
+b8 folder_size_service_update(FolderSizeService* service, DirectoryItemArray* items)
+{
+    const f64 now = platform_get_time();
+    const b8 publish_partial = now - service->last_publish_time >= FOLDER_SIZE_PUBLISH_INTERVAL;
+    if (publish_partial)
+    {
+        service->last_publish_time = now;
+    }
+
+    // Walks are started a few at a time so a folder with thousands of
+    // sub folders does not flood the queue, nor take the threads listing,
+    // thumbnails and search need.
+    const long pending = ftic_atomic_load(&service->pending);
+    i32 walks_left =
+        (i32)ftic_max(global_thread_count / FOLDER_SIZE_POOL_SHARE, 1) - (i32)pending;
+
+    ++service->update_count;
+    b8 changed = false;
+    for (u32 i = 0; i < items->size; ++i)
+    {
+        DirectoryItem* item = items->data + i;
+        if (item->type != FOLDER_DEFAULT)
+        {
+            continue;
+        }
+        FolderSize* entry = folder_size_get(service, &item->id);
+        entry->seen_update = service->update_count;
+        if (entry->last_write_time != item->last_write_time)
+        {
+            entry->last_write_time = item->last_write_time;
+            entry->validated_time = 0.0;
+        }
+
+        const long state = ftic_atomic_load(&entry->state);
+        if (state == FOLDER_SIZE_IDLE && publish_partial && entry->change_handle &&
+            directory_look_for_directory_change(entry->change_handle))
+        {
+            entry->validated_time = 0.0;
+        }
+        const b8 expired = !entry->listen && now - entry->validated_time > FOLDER_SIZE_MAX_AGE;
+        if (state == FOLDER_SIZE_IDLE && walks_left > 0 &&
+            (entry->validated_time == 0.0 || expired))
+        {
+            if (!entry->listen && service->listening.size < FOLDER_SIZE_MAX_LISTENERS)
+            {
+                entry->listen = true;
+                array_push(&service->listening, entry);
+            }
+            entry->validated_time = now;
+            ftic_atomic_store(&entry->state, FOLDER_SIZE_RUNNING);
+            ftic_atomic_add(&service->pending, 1);
+            --walks_left;
+
+            FolderSizeWalk* walk = (FolderSizeWalk*)calloc(1, sizeof(FolderSizeWalk));
+            walk->service = service;
+            walk->entry = entry;
+            walk->path = string_copy_d(item->path);
+            ThreadTask task = thread_task(folder_size_walk, walk);
+            if (!thread_tasks_push(service->task_queue, &task, 1, NULL))
+            {
+                // The queue is full, walked in a later update.
+                free(walk->path);
+                free(walk);
+                entry->validated_time = 0.0;
+                ftic_atomic_store(&entry->state, FOLDER_SIZE_IDLE);
+                ftic_atomic_add(&service->pending, -1);
+            }
+        }
+
+        // The last complete size is shown while a new walk runs, a folder
+        // that was never completed shows how far its walk has come.
+        i64 size = ftic_atomic_load64(&entry->size);
+        if (size < 0)
+        {
+            if (!publish_partial)
+            {
+                continue;
+            }
+            size = ftic_atomic_load64(&entry->partial_size);
+        }
+        if ((u64)size != item->size)
+        {
+            item->size = (u64)size;
+            changed = true;
+        }
+    }
+
+    // Folders out of view, or where listening failed, give their listener
+    // back and fall back to the modified time.
+    for (u32 i = 0; i < service->listening.size;)
+    {
+        FolderSize* entry = service->listening.data[i];
+        if (ftic_atomic_load(&entry->state) == FOLDER_SIZE_IDLE &&
+            (entry->seen_update != service->update_count || !entry->change_handle))
+        {
+            if (entry->change_handle)
+            {
+                directory_unlisten_to_directory_changes(entry->change_handle);
+                entry->change_handle = NULL;
+            }
+            entry->listen = false;
+            service->listening.data[i] = service->listening.data[--service->listening.size];
+            continue;
+        }
+        ++i;
+    }
+    return changed;
+}
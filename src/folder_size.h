@@ -0,0 +1,63 @@
+#pragma once
+#include "define.h"
+#include "hash_table.h"
+#include "thread_queue.h"
+#include "platform/platform.h"
+
+// A walk listens to changes below its folder, a displayed folder is walked
+// again when one comes in. Folders without a listener, over the limit or
+// where listening failed, fall back to the modified time, which only catches
+// changes to direct children, and a walk once this old.
+#define FOLDER_SIZE_MAX_AGE 60.0
+#define FOLDER_SIZE_MAX_LISTENERS 32
+// How often sizes of folders still being walked are written to the items,
+// and how often listeners are checked for changes.
+#define FOLDER_SIZE_PUBLISH_INTERVAL 0.25
+// Walks take at most this share of the pool, one at the least.
+#define FOLDER_SIZE_POOL_SHARE 4
+
+typedef enum FolderSizeState
+{
+    FOLDER_SIZE_IDLE = 0,
+    FOLDER_SIZE_RUNNING,
+} FolderSizeState;
+
+typedef struct FolderSize
+{
+    FticGUID id;
+    u64 last_write_time;
+    f64 validated_time;
+    u32 seen_update;
+    b8 complete;
+    b8 listen; // Set by the service for the next walk
+
+    // Owned by the walk while it runs, by the service otherwise.
+    void* change_handle;
+
+    FTicAtomic state;
+    FTicAtomic64 partial_size;
+    FTicAtomic64 size;
+} FolderSize;
+
+typedef struct FolderSizePtrArray
+{
+    u32 size;
+    u32 capacity;
+    FolderSize** data;
+} FolderSizePtrArray;
+
+typedef struct FolderSizeService
+{
+    ThreadTaskQueue* task_queue;
+    HashTableUU64 index;
+    FolderSizePtrArray entries;
+    FolderSizePtrArray listening; // Entries that have or will get a listener
+    u32 update_count;
+    f64 last_publish_time;
+    FTicAtomic pending;
+    FTicAtomic stop;
+} FolderSizeService;
+
+void folder_size_service_create(ThreadTaskQueue* task_queue, FolderSizeService* service);
+void folder_size_service_destroy(FolderSizeService* service);
+b8 folder_size_service_update(FolderSizeService* service, DirectoryItemArray* items);
@@ -1,8 +1,543 @@
 #include "font.h"
 #include "opengl_util.h"
-#include <stb/stb_truetype.h>
+#include "texture.h"
+#include "platform/platform.h"
+#include <glad/glad.h>
 #include <string.h>
 
+typedef struct GlyphRasterizeData
+{
+    GlyphAtlas* atlas;
+    GlyphEntry* entry;
+    f32 scale;
+} GlyphRasterizeData;
+
+u32 utf8_decode(const char* text, u32 text_len, u32* codepoint)
+{
+    const u8* bytes = (const u8*)text;
+    const u8 lead = bytes[0];
+    u32 length = 1;
+    u32 result = lead;
+    if (lead >= 0xF0 && lead < 0xF8)
+    {
+        length = 4;
+        result = lead & 0x07;
+    }
+    else if (lead >= 0xE0)
+    {
+        length = 3;
+        result = lead & 0x0F;
+    }
+    else if (lead >= 0xC0)
+    {
+        length = 2;
+        result = lead & 0x1F;
+    }
+    else if (lead >= 0x80)
+    {
+        *codepoint = 0xFFFD;
+        return 1;
+    }
+    if (length > text_len)
+    {
+        *codepoint = 0xFFFD;
+        return 1;
+    }
+    for (u32 i = 1; i < length; ++i)
+    {
+        if ((bytes[i] & 0xC0) != 0x80)
+        {
+            *codepoint = 0xFFFD;
+            return i;
+        }
+        result = (result << 6) | (bytes[i] & 0x3F);
+    }
+    *codepoint = result;
+    return length;
+}
+
+internal u32 glyph_key(const u32 codepoint, const f32 pixel_height)
+{
+    // Codepoints are at most 21 bits, the rest is used for the size.
+    return (codepoint & 0x1FFFFF) | (((u32)pixel_height) << 21);
+}
+
+internal u32 glyph_slot(const u32 key)
+{
+    return (key * 2654435761u) & (GLYPH_ATLAS_MAX_GLYPHS - 1);
+}
+
+internal long glyph_state(GlyphEntry* entry)
+{
+    return ftic_atomic_load(&entry->state);
+}
+
+internal void glyph_rasterize(const GlyphAtlas* atlas, const f32 scale, GlyphEntry* entry)
+{
+    const u32 bitmap_size = entry->width * entry->height;
+    u8* coverage = (u8*)calloc(bitmap_size, sizeof(u8));
+    if (atlas->mode == GLYPH_ATLAS_SDF)
+    {
+        i32 width = 0, height = 0, x_offset = 0, y_offset = 0;
+        u8* sdf = stbtt_GetGlyphSDF(&atlas->font_info, scale, entry->glyph_index,
+                                    GLYPH_ATLAS_SDF_PADDING, GLYPH_ATLAS_SDF_ON_EDGE,
+                                    (f32)GLYPH_ATLAS_SDF_ON_EDGE / GLYPH_ATLAS_SDF_PADDING,
+                                    &width, &height, &x_offset, &y_offset);
+        if (sdf)
+        {
+            const i32 copy_width = min(width, (i32)entry->width);
+            const i32 copy_height = min(height, (i32)entry->height);
+            for (i32 y = 0; y < copy_height; ++y)
+            {
+                memcpy(coverage + (y * entry->width), sdf + (y * width), copy_width);
+            }
+            stbtt_FreeSDF(sdf, NULL);
+        }
+    }
+    else
+    {
+        stbtt_MakeGlyphBitmap(&atlas->font_info, coverage, entry->width, entry->height,
+                              entry->width, scale, scale, entry->glyph_index);
+    }
+
+    u8* bitmap = (u8*)malloc(bitmap_size * 4 * sizeof(u8));
+    memset(bitmap, UINT8_MAX, bitmap_size * 4 * sizeof(u8));
+    for (u32 i = 0, j = 3; i < bitmap_size; ++i, j += 4)
+    {
+        bitmap[j] = coverage[i];
+    }
+    free(coverage);
+    entry->bitmap = bitmap;
+}
+
+internal THREAD_TASK_ENTRY_POINT(glyph_rasterize_task)
+{
+    GlyphRasterizeData* arguments = (GlyphRasterizeData*)data;
+    glyph_rasterize(arguments->atlas, arguments->scale, arguments->entry);
+    ftic_atomic_store(&arguments->entry->state, GLYPH_RASTERIZED);
+    free(arguments);
+}
+
+internal void glyph_atlas_wait_for_rasterization(GlyphAtlas* atlas)
+{
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        GlyphEntry* entry = atlas->entries + i;
+        while (glyph_state(entry) == GLYPH_RASTERIZING)
+        {
+            platform_sleep(1);
+        }
+    }
+}
+
+internal void glyph_atlas_clear(GlyphAtlas* atlas)
+{
+    glyph_atlas_wait_for_rasterization(atlas);
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        free(atlas->entries[i].bitmap);
+    }
+    memset(atlas->entries, 0, GLYPH_ATLAS_MAX_GLYPHS * sizeof(GlyphEntry));
+    atlas->entry_count = 0;
+    atlas->shelf_count = 0;
+    atlas->requests.size = 0;
+    atlas->evict = false;
+}
+
+internal int compare_glyph_last_used(const void* first, const void* second)
+{
+    const u32 first_frame = (*(const GlyphEntry**)first)->last_used_frame;
+    const u32 second_frame = (*(const GlyphEntry**)second)->last_used_frame;
+    return first_frame < second_frame ? -1 : first_frame > second_frame;
+}
+
+// Drops the least recently used glyphs, leaving the ones drawn this frame,
+// until the table is half full. The rest are moved into a new table, so the
+// rasterization tasks are waited for and the requests gathered again.
+internal void glyph_atlas_evict(GlyphAtlas* atlas)
+{
+    glyph_atlas_wait_for_rasterization(atlas);
+    GlyphEntry* old_entries = atlas->entries;
+    GlyphEntry** by_last_used = (GlyphEntry**)malloc(atlas->entry_count * sizeof(GlyphEntry*));
+    u32 count = 0;
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        if (old_entries[i].occupied)
+        {
+            by_last_used[count++] = old_entries + i;
+        }
+    }
+    qsort(by_last_used, count, sizeof(GlyphEntry*), compare_glyph_last_used);
+
+    const u32 evict_count =
+        count > GLYPH_ATLAS_MAX_GLYPHS / 2 ? count - GLYPH_ATLAS_MAX_GLYPHS / 2 : 0;
+    atlas->entries = (GlyphEntry*)calloc(GLYPH_ATLAS_MAX_GLYPHS, sizeof(GlyphEntry));
+    atlas->entry_count = 0;
+    atlas->requests.size = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        GlyphEntry* entry = by_last_used[i];
+        if (i < evict_count && entry->last_used_frame != atlas->frame)
+        {
+            free(entry->bitmap);
+            continue;
+        }
+        u32 slot = glyph_slot(entry->key);
+        while (atlas->entries[slot].occupied)
+        {
+            slot = (slot + 1) & (GLYPH_ATLAS_MAX_GLYPHS - 1);
+        }
+        GlyphEntry* moved = atlas->entries + slot;
+        *moved = *entry;
+        atlas->entry_count++;
+        if (glyph_state(moved) == GLYPH_REQUESTED)
+        {
+            array_push(&atlas->requests, moved);
+        }
+    }
+    free(by_last_used);
+    free(old_entries);
+    atlas->evict = false;
+}
+
+b8 glyph_atlas_set_font(GlyphAtlas* atlas, const char* font_file_path)
+{
+    FileAttrib file = file_read_full_path(font_file_path);
+    stbtt_fontinfo font_info = { 0 };
+    if (!file.buffer ||
+        !stbtt_InitFont(&font_info, file.buffer, stbtt_GetFontOffsetForIndex(file.buffer, 0)))
+    {
+        free(file.buffer);
+        return false;
+    }
+    glyph_atlas_clear(atlas);
+    free(atlas->font_file.buffer);
+    atlas->font_file = file;
+    atlas->font_info = font_info;
+    return true;
+}
+
+b8 glyph_atlas_create(u16 width, u16 height, GlyphAtlasMode mode, const char* font_file_path,
+                      ThreadTaskQueue* task_queue, GlyphAtlas* atlas)
+{
+    *atlas = (GlyphAtlas){ 0 };
+    atlas->mode = mode;
+    atlas->width = width;
+    atlas->height = height;
+    atlas->task_queue = task_queue;
+    atlas->entries = (GlyphEntry*)calloc(GLYPH_ATLAS_MAX_GLYPHS, sizeof(GlyphEntry));
+    array_create(&atlas->requests, 128);
+
+    TextureProperties texture_properties = {
+        .width = width,
+        .height = height,
+        .bytes = (u8*)calloc(width * height * 4, sizeof(u8)),
+    };
+    atlas->texture = texture_create(&texture_properties, GL_RGBA8, GL_RGBA,
+                                    mode == GLYPH_ATLAS_SDF ? GL_LINEAR : GL_NEAREST);
+    free(texture_properties.bytes);
+
+    return glyph_atlas_set_font(atlas, font_file_path);
+}
+
+void glyph_atlas_destroy(GlyphAtlas* atlas)
+{
+    glyph_atlas_clear(atlas);
+    free(atlas->entries);
+    array_free(&atlas->requests);
+    free(atlas->font_file.buffer);
+    texture_delete(atlas->texture);
+    *atlas = (GlyphAtlas){ 0 };
+}
+
+internal GlyphEntry* glyph_atlas_find_or_insert(GlyphAtlas* atlas, const u32 codepoint,
+                                                const f32 pixel_height)
+{
+    const u32 key = glyph_key(codepoint, pixel_height);
+    u32 slot = glyph_slot(key);
+    for (;;)
+    {
+        GlyphEntry* entry = atlas->entries + slot;
+        if (!entry->occupied)
+        {
+            break;
+        }
+        if (entry->key == key)
+        {
+            return entry;
+        }
+        slot = (slot + 1) & (GLYPH_ATLAS_MAX_GLYPHS - 1);
+    }
+
+    // The least recently used glyphs are evicted in the next update once the
+    // table is three quarters full. Until then it takes a few more, what
+    // does not fit is drawn when there is room again.
+    if (atlas->entry_count >= (GLYPH_ATLAS_MAX_GLYPHS / 4) * 3)
+    {
+        atlas->evict = true;
+        if (atlas->entry_count >= (GLYPH_ATLAS_MAX_GLYPHS / 8) * 7)
+        {
+            return NULL;
+        }
+    }
+
+    GlyphEntry* entry = atlas->entries + slot;
+    *entry = (GlyphEntry){ 0 };
+    entry->occupied = true;
+    entry->key = key;
+    entry->shelf_index = -1;
+    atlas->entry_count++;
+
+    const stbtt_fontinfo* font_info = &atlas->font_info;
+    const f32 scale = stbtt_ScaleForPixelHeight(font_info, pixel_height);
+    entry->glyph_index = stbtt_FindGlyphIndex(font_info, (int)codepoint);
+
+    i32 advance = 0;
+    i32 left_side_bearing = 0;
+    stbtt_GetGlyphHMetrics(font_info, entry->glyph_index, &advance, &left_side_bearing);
+
+    i32 x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    stbtt_GetGlyphBitmapBox(font_info, entry->glyph_index, scale, scale, &x0, &y0, &x1, &y1);
+
+    entry->character.x_advance = advance * scale;
+    if (atlas->mode == GLYPH_ATLAS_SDF)
+    {
+        // Same box as stbtt_GetGlyphSDF, the advance is rounded after scaling.
+        if (x0 != x1 && y0 != y1)
+        {
+            x0 -= GLYPH_ATLAS_SDF_PADDING;
+            y0 -= GLYPH_ATLAS_SDF_PADDING;
+            x1 += GLYPH_ATLAS_SDF_PADDING;
+            y1 += GLYPH_ATLAS_SDF_PADDING;
+        }
+    }
+    else
+    {
+        entry->character.x_advance = round_f32(entry->character.x_advance);
+    }
+
+    entry->width = (u16)(x1 - x0);
+    entry->height = (u16)(y1 - y0);
+    entry->character.dimensions = v2f((f32)entry->width, (f32)entry->height);
+    entry->character.offset = v2f((f32)x0, (f32)y0);
+    if (!entry->width || !entry->height)
+    {
+        // Nothing to rasterize, e.g. white space.
+        entry->state = GLYPH_RESIDENT;
+    }
+    return entry;
+}
+
+internal b8 font_get_character(const FontTTF* font, const u32 codepoint,
+                              CharacterTTF* character, b8* resident)
+{
+    *resident = false;
+    if (!font->atlas)
+    {
+        if (!closed_interval(0, ((i32)codepoint - 32), 96))
+        {
+            return false;
+        }
+        *character = font->chars[codepoint - 32];
+        *resident = true;
+        return true;
+    }
+
+    GlyphAtlas* atlas = font->atlas;
+    if (!atlas->font_file.buffer)
+    {
+        return false;
+    }
+    const b8 sdf = atlas->mode == GLYPH_ATLAS_SDF;
+    const f32 lookup_height = sdf ? GLYPH_ATLAS_SDF_PIXEL_HEIGHT : font->pixel_height;
+    GlyphEntry* entry = glyph_atlas_find_or_insert(atlas, codepoint, lookup_height);
+    if (!entry)
+    {
+        return false;
+    }
+    entry->last_used_frame = atlas->frame;
+    if (entry->shelf_index >= 0)
+    {
+        atlas->shelves[entry->shelf_index].last_used_frame = atlas->frame;
+    }
+    if (entry->state == GLYPH_EMPTY)
+    {
+        entry->state = GLYPH_REQUESTED;
+        array_push(&atlas->requests, entry);
+    }
+    *resident = entry->state == GLYPH_RESIDENT && entry->width && entry->height;
+    *character = entry->character;
+    if (sdf)
+    {
+        // The distance field is rendered at one size and scaled to the
+        // requested one, the shader keeps the edges sharp.
+        const f32 factor = font->pixel_height / GLYPH_ATLAS_SDF_PIXEL_HEIGHT;
+        character->dimensions = v2_s_multi(character->dimensions, factor);
+        character->offset = v2_s_multi(character->offset, factor);
+        character->x_advance = round_f32(character->x_advance * factor);
+    }
+    return true;
+}
+
+internal void glyph_atlas_evict_shelf(GlyphAtlas* atlas, const u32 shelf_index)
+{
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        GlyphEntry* entry = atlas->entries + i;
+        if (entry->occupied && entry->shelf_index == (i16)shelf_index)
+        {
+            entry->shelf_index = -1;
+            entry->state = GLYPH_EMPTY;
+        }
+    }
+    atlas->shelves[shelf_index].x = 0;
+}
+
+internal b8 glyph_atlas_allocate(GlyphAtlas* atlas, const u16 width, const u16 height,
+                                 u16* x, u16* y, i16* shelf_index)
+{
+    // One pixel of padding so neighbours do not bleed into each other.
+    const u16 padded_width = width + 1;
+    const u16 padded_height = height + 1;
+
+    i32 best_shelf = -1;
+    for (u32 i = 0; i < atlas->shelf_count; ++i)
+    {
+        GlyphShelf* shelf = atlas->shelves + i;
+        if (shelf->height >= padded_height && shelf->x + padded_width <= atlas->width &&
+            (best_shelf == -1 || shelf->height < atlas->shelves[best_shelf].height))
+        {
+            best_shelf = i;
+        }
+    }
+
+    if (best_shelf == -1 || atlas->shelves[best_shelf].height > padded_height * 2)
+    {
+        const GlyphShelf* last =
+            atlas->shelf_count ? atlas->shelves + (atlas->shelf_count - 1) : NULL;
+        const u16 next_y = last ? last->y + last->height : 0;
+        if (atlas->shelf_count < GLYPH_ATLAS_MAX_SHELVES &&
+            next_y + padded_height <= atlas->height)
+        {
+            best_shelf = atlas->shelf_count++;
+            atlas->shelves[best_shelf] = (GlyphShelf){
+                .y = next_y,
+                .height = padded_height,
+            };
+        }
+    }
+
+    if (best_shelf == -1)
+    {
+        // Evict the least recently used shelf that is tall enough and was not
+        // used this frame.
+        for (u32 i = 0; i < atlas->shelf_count; ++i)
+        {
+            GlyphShelf* shelf = atlas->shelves + i;
+            if (shelf->height >= padded_height && shelf->last_used_frame != atlas->frame &&
+                (best_shelf == -1 ||
+                 shelf->last_used_frame < atlas->shelves[best_shelf].last_used_frame))
+            {
+                best_shelf = i;
+            }
+        }
+        if (best_shelf == -1)
+        {
+            return false;
+        }
+        glyph_atlas_evict_shelf(atlas, best_shelf);
+    }
+
+    GlyphShelf* shelf = atlas->shelves + best_shelf;
+    *x = shelf->x;
+    *y = shelf->y;
+    *shelf_index = (i16)best_shelf;
+    shelf->x += padded_width;
+    shelf->last_used_frame = atlas->frame;
+    return true;
+}
+
+internal void glyph_atlas_upload(GlyphAtlas* atlas, GlyphEntry* entry)
+{
+    u16 x = 0;
+    u16 y = 0;
+    i16 shelf_index = -1;
+    if (!glyph_atlas_allocate(atlas, entry->width, entry->height, &x, &y, &shelf_index))
+    {
+        // Try again next frame when the glyphs in use might have changed.
+        return;
+    }
+    texture_update_sub_image(atlas->texture, x, y, entry->width, entry->height, GL_RGBA,
+                             entry->bitmap);
+    free(entry->bitmap);
+    entry->bitmap = NULL;
+    entry->shelf_index = shelf_index;
+    entry->character.text_coords =
+        v4f((f32)x / atlas->width, (f32)y / atlas->height,
+            (f32)(x + entry->width) / atlas->width, (f32)(y + entry->height) / atlas->height);
+    entry->state = GLYPH_RESIDENT;
+}
+
+void glyph_atlas_update(GlyphAtlas* atlas)
+{
+    if (atlas->evict)
+    {
+        glyph_atlas_evict(atlas);
+    }
+
+    for (u32 i = 0; i < GLYPH_ATLAS_MAX_GLYPHS; ++i)
+    {
+        GlyphEntry* entry = atlas->entries + i;
+        if (entry->occupied && glyph_state(entry) == GLYPH_RASTERIZED)
+        {
+            glyph_atlas_upload(atlas, entry);
+        }
+    }
+
+    for (u32 i = 0; i < atlas->requests.size; ++i)
+    {
+        GlyphEntry* entry = atlas->requests.data[i];
+        const f32 pixel_height = (f32)(entry->key >> 21);
+        const f32 scale = stbtt_ScaleForPixelHeight(&atlas->font_info, pixel_height);
+        if (atlas->task_queue)
+        {
+            GlyphRasterizeData* arguments =
+                (GlyphRasterizeData*)calloc(1, sizeof(GlyphRasterizeData));
+            arguments->atlas = atlas;
+            arguments->entry = entry;
+            arguments->scale = scale;
+            // Set before the push, the task may be done before it returns.
+            entry->state = GLYPH_RASTERIZING;
+            ThreadTask task = thread_task(glyph_rasterize_task, arguments);
+            if (!thread_tasks_push(atlas->task_queue, &task, 1, NULL))
+            {
+                // The queue is full, requested again the next time it is drawn.
+                free(arguments);
+                entry->state = GLYPH_EMPTY;
+            }
+        }
+        else
+        {
+            glyph_rasterize(atlas, scale, entry);
+            entry->state = GLYPH_RASTERIZED;
+            glyph_atlas_upload(atlas, entry);
+        }
+    }
+    atlas->requests.size = 0;
+    atlas->frame++;
+}
+
+void font_create_from_atlas(GlyphAtlas* atlas, f32 texture_index, f32 pixel_height,
+                            FontTTF* font_out)
+{
+    *font_out = (FontTTF){
+        .tex_index = texture_index,
+        .line_height = pixel_height,
+        .pixel_height = pixel_height,
+        .atlas = atlas,
+    };
+}
+
 void init_ttf_atlas(i32 width_atlas, i32 height_atlas, f32 pixel_height,
                     u32 glyph_count, u32 glyph_offset,
                     const char* font_file_path, u8* bitmap, FontTTF* font_out)
@@ -34,67 +569,83 @@ void init_ttf_atlas(i32 width_atlas, i32 height_atlas, f32 pixel_height,
     free(file.buffer);
 }
 
-internal b8 render_character(const char character, const CharacterTTF* c_ttf,
-                             const float texture_index, const f32 line_height,
-                             const f32 start_x, const V4 color, u32* new_lines,
-                             f32* x_max_advance, u32* count, V2* pos,
-                             SelectionCharacterArray* selection_chars,
-                             VertexArray* array)
+internal b8 render_character(const u32 codepoint, const char* bytes, const u32 byte_count,
+                             const FontTTF* font, const float texture_index,
+                             const f32 line_height, const f32 start_x, const V4 color,
+                             u32* new_lines, f32* x_max_advance, u32* count, V2* pos,
+                             SelectionCharacterArray* selection_chars, QuadArray* array)
 {
-    if (character == '\n')
+    if (codepoint == '\n')
     {
         pos->y += line_height;
         pos->x = start_x;
         *new_lines += 1;
         return false;
     }
-    else if (character == '\t')
+    else if (codepoint == '\t')
     {
-        const CharacterTTF* c = c_ttf + (' ' - 32);
-        pos->x += c->x_advance * 4;
+        b8 resident = false;
+        CharacterTTF c = { 0 };
+        if (font_get_character(font, ' ', &c, &resident))
+        {
+            pos->x += c.x_advance * 4;
+        }
     }
-    else if (closed_interval(0, (character - 32), 96))
+    else if (codepoint >= 32)
     {
-        const CharacterTTF* c = c_ttf + (character - 32);
+        b8 resident = false;
+        CharacterTTF c = { 0 };
+        if (!font_get_character(font, codepoint, &c, &resident))
+        {
+            return true;
+        }
 
-        V2 size = c->dimensions;
-        V2 curr_pos = v2_add(*pos, c->offset);
-        AABB aabb = quad_co(array, curr_pos, size, color, c->text_coords,
-                            texture_index);
+        V2 size = c.dimensions;
+        V2 curr_pos = v2_add(*pos, c.offset);
+        AABB aabb = { .min = curr_pos, .size = size };
+        if (resident)
+        {
+            aabb = quad_co(array, curr_pos, size, color, c.text_coords, texture_index);
+            *count += 1;
+        }
 
         // TODO: do a check for every character is slow.
         if (selection_chars)
         {
-            SelectionCharacter selection_char = {
-                .character = character,
-                .aabb = aabb,
-            };
-            array_push(selection_chars, selection_char);
+            // One entry per byte so the indices line up with the text buffer.
+            for (u32 i = 0; i < byte_count; ++i)
+            {
+                SelectionCharacter selection_char = {
+                    .character = bytes[i],
+                    .aabb = aabb,
+                };
+                array_push(selection_chars, selection_char);
+            }
         }
-        pos->x += c->x_advance;
+        pos->x += c.x_advance;
         *x_max_advance = max(*x_max_advance, pos->x);
-        *count += 1;
     }
     return true;
 }
 
-u32 text_generation_color(const CharacterTTF* c_ttf, const char* text,
-                          float texture_index, V2 pos, f32 scale,
-                          f32 line_height, V4 color, u32* new_lines_count,
-                          f32* x_advance,
-                          SelectionCharacterArray* selection_chars,
-                          VertexArray* array)
+u32 text_generation_color(const FontTTF* font, const char* text, float texture_index, V2 pos,
+                          f32 scale, f32 line_height, V4 color, u32* new_lines_count,
+                          f32* x_advance, SelectionCharacterArray* selection_chars,
+                          QuadArray* array)
 {
     u32 count = 0;
     f32 start_x = pos.x;
     u32 new_lines = 0;
     f32 x_max_advance = 0.0f;
-    for (; *text; text++)
+    u32 text_len = (u32)strlen(text);
+    while (text_len)
     {
-        char current_char = *text;
-        render_character(current_char, c_ttf, texture_index, line_height,
-                         start_x, color, &new_lines, &x_max_advance, &count,
-                         &pos, selection_chars, array);
+        u32 codepoint = 0;
+        const u32 byte_count = utf8_decode(text, text_len, &codepoint);
+        render_character(codepoint, text, byte_count, font, texture_index, line_height, start_x,
+                         color, &new_lines, &x_max_advance, &count, &pos, selection_chars, array);
+        text += byte_count;
+        text_len -= byte_count;
     }
     if (new_lines_count)
     {
@@ -107,38 +658,34 @@ u32 text_generation_color(const CharacterTTF* c_ttf, const char* text,
     return count * 6;
 }
 
-internal void add_line_number(const char* buffer, const i32 buffer_length,
-                              const i32 digits, const CharacterTTF* c_ttf,
-                              const float texture_index, const f32 line_height,
-                              const f32 start_x, u32* new_lines,
+internal void add_line_number(const char* buffer, const i32 buffer_length, const i32 digits,
+                              const FontTTF* font, const float texture_index,
+                              const f32 line_height, const f32 start_x, u32* new_lines,
                               f32* x_max_advance, u32* count, V2* pos,
-                              SelectionCharacterArray* selection_chars,
-                              VertexArray* array)
+                              SelectionCharacterArray* selection_chars, QuadArray* array)
 {
+    const char space = ' ';
+    const char tab = '\t';
     for (i32 j = 0; j < buffer_length; ++j)
     {
-        render_character(buffer[j], c_ttf, texture_index, line_height, start_x,
-                         v4ic(1.0f), new_lines, x_max_advance, count, pos,
-                         selection_chars, array);
+        render_character(buffer[j], buffer + j, 1, font, texture_index, line_height, start_x,
+                         v4ic(1.0f), new_lines, x_max_advance, count, pos, selection_chars,
+                         array);
     }
     for (i32 j = 0; j < (digits - buffer_length); ++j)
     {
-        render_character(' ', c_ttf, texture_index, line_height, start_x,
-                         v4ic(1.0f), new_lines, x_max_advance, count, pos,
-                         selection_chars, array);
+        render_character(space, &space, 1, font, texture_index, line_height, start_x,
+                         v4ic(1.0f), new_lines, x_max_advance, count, pos, selection_chars,
+                         array);
     }
-    render_character('\t', c_ttf, texture_index, line_height, start_x,
-                     v4ic(1.0f), new_lines, x_max_advance, count, pos,
-                     selection_chars, array);
+    render_character(tab, &tab, 1, font, texture_index, line_height, start_x, v4ic(1.0f),
+                     new_lines, x_max_advance, count, pos, selection_chars, array);
 }
 
-u32 text_generation_colored_char(const CharacterTTF* c_ttf,
-                                 const ColoredCharacterArray* text,
-                                 float texture_index, V2 pos, f32 scale,
-                                 f32 line_height, u32* new_lines_count,
-                                 f32* x_advance,
-                                 SelectionCharacterArray* selection_chars,
-                                 VertexArray* array)
+u32 text_generation_colored_char(const FontTTF* font, const ColoredCharacterArray* text,
+                                 float texture_index, V2 pos, f32 scale, f32 line_height,
+                                 u32* new_lines_count, f32* x_advance,
+                                 SelectionCharacterArray* selection_chars, QuadArray* array)
 {
     u32 total_new_lines = 0;
     for (u32 i = 0; i < text->size; ++i)
@@ -159,24 +706,32 @@ u32 text_generation_colored_char(const CharacterTTF* c_ttf,
     if (text->size)
     {
         char zero = '0';
-        add_line_number(&zero, 1, digits, c_ttf, texture_index, line_height,
-                        start_x, &new_lines, &x_max_advance, &count, &pos,
-                        selection_chars, array);
+        add_line_number(&zero, 1, digits, font, texture_index, line_height, start_x,
+                        &new_lines, &x_max_advance, &count, &pos, selection_chars, array);
     }
-    for (u32 i = 0; i < text->size; ++i)
+    for (u32 i = 0; i < text->size;)
     {
         ColoredCharacter* current = text->data + i;
-        if (!render_character(current->character, c_ttf, texture_index,
-                              line_height, start_x, current->color, &new_lines,
-                              &x_max_advance, &count, &pos, selection_chars,
-                              array))
+
+        char bytes[4] = { 0 };
+        const u32 available = min(text->size - i, 4);
+        for (u32 j = 0; j < available; ++j)
+        {
+            bytes[j] = text->data[i + j].character;
+        }
+        u32 codepoint = 0;
+        const u32 byte_count = utf8_decode(bytes, available, &codepoint);
+        i += byte_count;
+
+        if (!render_character(codepoint, bytes, byte_count, font, texture_index, line_height,
+                              start_x, current->color, &new_lines, &x_max_advance, &count, &pos,
+                              selection_chars, array))
         {
             char buffer[256] = { 0 };
             value_to_string(buffer, "%u", new_lines);
-            add_line_number(buffer, (i32)strlen(buffer), digits, c_ttf,
-                            texture_index, line_height, start_x, &new_lines,
-                            &x_max_advance, &count, &pos, selection_chars,
-                            array);
+            add_line_number(buffer, (i32)strlen(buffer), digits, font, texture_index,
+                            line_height, start_x, &new_lines, &x_max_advance, &count, &pos,
+                            selection_chars, array);
         }
     }
     if (new_lines_count)
@@ -190,39 +745,48 @@ u32 text_generation_colored_char(const CharacterTTF* c_ttf,
     return count * 6;
 }
 
-f32 text_x_advance(const CharacterTTF* c_ttf, const char* text, u32 text_len,
-                   f32 scale)
+f32 text_x_advance(const FontTTF* font, const char* text, u32 text_len, f32 scale)
 {
     f32 result = 0;
-    for (u32 i = 0; i < text_len; ++i)
+    for (u32 i = 0; i < text_len;)
     {
-        char current_char = text[i];
-        if (closed_interval(0, (current_char - 32), 96))
+        u32 codepoint = 0;
+        i += utf8_decode(text + i, text_len - i, &codepoint);
+        if (codepoint >= 32)
         {
-            const CharacterTTF* c = c_ttf + (current_char - 32);
-            result += c->x_advance * scale;
+            b8 resident = false;
+            CharacterTTF c = { 0 };
+            if (font_get_character(font, codepoint, &c, &resident))
+            {
+                result += c.x_advance * scale;
+            }
         }
     }
     return result;
 }
 
-i32 text_check_length_within_boundary(const CharacterTTF* c_ttf,
-                                      const char* text, u32 text_len, f32 scale,
-                                      float boundary)
+i32 text_check_length_within_boundary(const FontTTF* font, const char* text, u32 text_len,
+                                      f32 scale, float boundary)
 {
     f32 x_advance = 0;
-    for (i32 i = 0; i < (i32)text_len; ++i)
+    for (u32 i = 0; i < text_len;)
     {
-        char current_char = text[i];
-        if (closed_interval(0, (current_char - 32), 96))
+        u32 codepoint = 0;
+        const u32 byte_count = utf8_decode(text + i, text_len - i, &codepoint);
+        if (codepoint >= 32)
         {
-            const CharacterTTF* c = c_ttf + (current_char - 32);
-            x_advance += c->x_advance * scale;
-            if (x_advance > boundary)
+            b8 resident = false;
+            CharacterTTF c = { 0 };
+            if (font_get_character(font, codepoint, &c, &resident))
             {
-                return i;
+                x_advance += c.x_advance * scale;
+                if (x_advance > boundary)
+                {
+                    return (i32)i;
+                }
             }
         }
+        i += byte_count;
     }
     return -1;
 }
@@ -3,6 +3,8 @@
 #include "math/ftic_math.h"
 #include "util.h"
 #include "collision.h"
+#include "thread_queue.h"
+#include <stb/stb_truetype.h>
 
 typedef struct CharacterTTF
 {
@@ -12,6 +14,82 @@ typedef struct CharacterTTF
     f32 x_advance;
 } CharacterTTF;
 
+#define GLYPH_ATLAS_MAX_GLYPHS 4096
+#define GLYPH_ATLAS_MAX_SHELVES 128
+
+// Distance fields are rendered once at this size and scaled in the shader.
+#define GLYPH_ATLAS_SDF_PIXEL_HEIGHT 48.0f
+#define GLYPH_ATLAS_SDF_PADDING 6
+#define GLYPH_ATLAS_SDF_ON_EDGE 128
+
+typedef enum GlyphAtlasMode
+{
+    GLYPH_ATLAS_BITMAP = 0,
+    GLYPH_ATLAS_SDF,
+} GlyphAtlasMode;
+
+typedef enum GlyphState
+{
+    GLYPH_EMPTY = 0,
+    GLYPH_REQUESTED,
+    GLYPH_RASTERIZING,
+    GLYPH_RASTERIZED,
+    GLYPH_RESIDENT,
+} GlyphState;
+
+typedef struct GlyphEntry
+{
+    CharacterTTF character;
+    u8* bitmap;
+    u32 key;
+    u32 last_used_frame;
+    i32 glyph_index;
+    u16 width;
+    u16 height;
+    i16 shelf_index;
+    b8 occupied;
+    FTicAtomic state;
+} GlyphEntry;
+
+typedef struct GlyphShelf
+{
+    u16 y;
+    u16 height;
+    u16 x;
+    u32 last_used_frame;
+} GlyphShelf;
+
+typedef struct GlyphEntryPtrArray
+{
+    u32 size;
+    u32 capacity;
+    GlyphEntry** data;
+} GlyphEntryPtrArray;
+
+// Shelf packed atlas that is filled on demand. Glyphs are keyed on codepoint
+// and pixel height, rasterized on the thread queue and uploaded with sub
+// texture updates in glyph_atlas_update. When the atlas is full the least
+// recently used shelf is evicted, and when the table of glyphs fills up the
+// least recently used glyphs are. In GLYPH_ATLAS_SDF mode glyphs are stored as
+// signed distance fields at one size and shared by every font size.
+typedef struct GlyphAtlas
+{
+    stbtt_fontinfo font_info;
+    FileAttrib font_file;
+    ThreadTaskQueue* task_queue;
+    GlyphEntry* entries;
+    GlyphEntryPtrArray requests;
+    GlyphShelf shelves[GLYPH_ATLAS_MAX_SHELVES];
+    GlyphAtlasMode mode;
+    u32 shelf_count;
+    u32 entry_count;
+    u32 texture;
+    u32 frame;
+    u16 width;
+    u16 height;
+    b8 evict;
+} GlyphAtlas;
+
 typedef struct FontTTF
 {
     f32 tex_index;
@@ -19,6 +97,7 @@ typedef struct FontTTF
     f32 pixel_height;
     u32 char_count;
     CharacterTTF* chars;
+    GlyphAtlas* atlas;
 } FontTTF;
 
 typedef struct SelectionCharacter
@@ -46,10 +125,18 @@ typedef struct ColoredCharacterArray
     ColoredCharacter* data;
 }ColoredCharacterArray;
 
+u32 utf8_decode(const char* text, u32 text_len, u32* codepoint);
+
+b8 glyph_atlas_create(u16 width, u16 height, GlyphAtlasMode mode, const char* font_file_path, ThreadTaskQueue* task_queue, GlyphAtlas* atlas);
+b8 glyph_atlas_set_font(GlyphAtlas* atlas, const char* font_file_path);
+void glyph_atlas_update(GlyphAtlas* atlas);
+void glyph_atlas_destroy(GlyphAtlas* atlas);
+void font_create_from_atlas(GlyphAtlas* atlas, f32 texture_index, f32 pixel_height, FontTTF* font_out);
+
 void init_ttf_atlas(i32 width_atlas, i32 height_atlas, f32 pixel_height, u32 glyph_count, u32 glyph_offset, const char* font_file_path, u8* bitmap, FontTTF* font_out);
 
-#define text_generation(c_ttf, text, texture_index, pos, scale, line_height, new_lines_count, x_advance, aabbs, array) text_generation_color(c_ttf, text, texture_index, pos, scale, line_height, global_get_text_color(), new_lines_count, x_advance, aabbs, array)
-u32 text_generation_color(const CharacterTTF* c_ttf, const char* text, float texture_index, V2 pos, f32 scale, f32 line_height, V4 color, u32* new_lines_count, f32* x_advance, SelectionCharacterArray* selection_chars, VertexArray* array);
-u32 text_generation_colored_char(const CharacterTTF* c_ttf, const ColoredCharacterArray* text, float texture_index, V2 pos, f32 scale, f32 line_height, u32* new_lines_count, f32* x_advance, SelectionCharacterArray* selection_chars, VertexArray* array);
-f32 text_x_advance(const CharacterTTF* c_ttf, const char* text, u32 text_len, f32 scale);
-i32 text_check_length_within_boundary(const CharacterTTF* c_ttf, const char* text, u32 text_len, f32 scale, float boundary);
+#define text_generation(font, text, texture_index, pos, scale, line_height, new_lines_count, x_advance, aabbs, array) text_generation_color(font, text, texture_index, pos, scale, line_height, global_get_text_color(), new_lines_count, x_advance, aabbs, array)
+u32 text_generation_color(const FontTTF* font, const char* text, float texture_index, V2 pos, f32 scale, f32 line_height, V4 color, u32* new_lines_count, f32* x_advance, SelectionCharacterArray* selection_chars, QuadArray* array);
+u32 text_generation_colored_char(const FontTTF* font, const ColoredCharacterArray* text, float texture_index, V2 pos, f32 scale, f32 line_height, u32* new_lines_count, f32* x_advance, SelectionCharacterArray* selection_chars, QuadArray* array);
+f32 text_x_advance(const FontTTF* font, const char* text, u32 text_len, f32 scale);
+i32 text_check_length_within_boundary(const FontTTF* font, const char* text, u32 text_len, f32 scale, float boundary);
@@ -0,0 +1,174 @@
+#pragma once
+#include "define.h"
+
+// Atomic counters and flags. C11 atomics where the compiler has them, the
+// Interlocked intrinsics on MSVC, which only has stdatomic.h behind an
+// experimental flag. Every operation is sequentially consistent, like the
+// defaults of stdatomic.h. FTicAtomic32 is the word the futex based
+// primitives in sync.h wait on.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+typedef volatile long FTicAtomic;
+typedef volatile long FTicAtomic32;
+typedef volatile i64 FTicAtomic64;
+
+static inline long ftic_atomic_load(FTicAtomic* target)
+{
+    return _InterlockedCompareExchange(target, 0, 0);
+}
+
+static inline void ftic_atomic_store(FTicAtomic* target, long value)
+{
+    _InterlockedExchange(target, value);
+}
+
+static inline long ftic_atomic_exchange(FTicAtomic* target, long value)
+{
+    return _InterlockedExchange(target, value);
+}
+
+// Returns the value before the add.
+static inline long ftic_atomic_add(FTicAtomic* target, long value)
+{
+    return _InterlockedExchangeAdd(target, value);
+}
+
+// Returns the value target had, value was stored if that equals compare.
+static inline long ftic_atomic_compare_exchange(FTicAtomic* target, long value, long compare)
+{
+    return _InterlockedCompareExchange(target, value, compare);
+}
+
+static inline u32 ftic_atomic_load32(FTicAtomic32* target)
+{
+    return (u32)_InterlockedCompareExchange(target, 0, 0);
+}
+
+static inline void ftic_atomic_store32(FTicAtomic32* target, u32 value)
+{
+    _InterlockedExchange(target, (long)value);
+}
+
+static inline u32 ftic_atomic_exchange32(FTicAtomic32* target, u32 value)
+{
+    return (u32)_InterlockedExchange(target, (long)value);
+}
+
+static inline u32 ftic_atomic_add32(FTicAtomic32* target, u32 value)
+{
+    return (u32)_InterlockedExchangeAdd(target, (long)value);
+}
+
+static inline u32 ftic_atomic_compare_exchange32(FTicAtomic32* target, u32 value, u32 compare)
+{
+    return (u32)_InterlockedCompareExchange(target, (long)value, (long)compare);
+}
+
+static inline i64 ftic_atomic_load64(FTicAtomic64* target)
+{
+    return _InterlockedCompareExchange64(target, 0, 0);
+}
+
+static inline void ftic_atomic_store64(FTicAtomic64* target, i64 value)
+{
+    _InterlockedExchange64(target, value);
+}
+
+static inline i64 ftic_atomic_add64(FTicAtomic64* target, i64 value)
+{
+    return _InterlockedExchangeAdd64(target, value);
+}
+
+static inline void ftic_atomic_pause(void)
+{
+    _mm_pause();
+}
+
+#else
+#include <stdatomic.h>
+
+typedef _Atomic long FTicAtomic;
+typedef _Atomic u32 FTicAtomic32;
+typedef _Atomic i64 FTicAtomic64;
+
+static inline long ftic_atomic_load(FTicAtomic* target)
+{
+    return atomic_load(target);
+}
+
+static inline void ftic_atomic_store(FTicAtomic* target, long value)
+{
+    atomic_store(target, value);
+}
+
+static inline long ftic_atomic_exchange(FTicAtomic* target, long value)
+{
+    return atomic_exchange(target, value);
+}
+
+// Returns the value before the add.
+static inline long ftic_atomic_add(FTicAtomic* target, long value)
+{
+    return atomic_fetch_add(target, value);
+}
+
+// Returns the value target had, value was stored if that equals compare.
+static inline long ftic_atomic_compare_exchange(FTicAtomic* target, long value, long compare)
+{
+    atomic_compare_exchange_strong(target, &compare, value);
+    return compare;
+}
+
+static inline u32 ftic_atomic_load32(FTicAtomic32* target)
+{
+    return atomic_load(target);
+}
+
+static inline void ftic_atomic_store32(FTicAtomic32* target, u32 value)
+{
+    atomic_store(target, value);
+}
+
+static inline u32 ftic_atomic_exchange32(FTicAtomic32* target, u32 value)
+{
+    return atomic_exchange(target, value);
+}
+
+static inline u32 ftic_atomic_add32(FTicAtomic32* target, u32 value)
+{
+    return atomic_fetch_add(target, value);
+}
+
+static inline u32 ftic_atomic_compare_exchange32(FTicAtomic32* target, u32 value, u32 compare)
+{
+    atomic_compare_exchange_strong(target, &compare, value);
+    return compare;
+}
+
+static inline i64 ftic_atomic_load64(FTicAtomic64* target)
+{
+    return atomic_load(target);
+}
+
+static inline void ftic_atomic_store64(FTicAtomic64* target, i64 value)
+{
+    atomic_store(target, value);
+}
+
+static inline i64 ftic_atomic_add64(FTicAtomic64* target, i64 value)
+{
+    return atomic_fetch_add(target, value);
+}
+
+static inline void ftic_atomic_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 #include "define.h"
 
+// Like the char* hash tables pass it, key points at the string pointer and
+// not at the characters.
 u64 hash_murmur(const void* key, u32 len, u64 seed);
 u64 hash_djb2(const void* key, u32 len, u64 seed);
 u64 hash_u64(const void* key, u32 len, u64 seed);
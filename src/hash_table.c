@@ -1,4 +1,5 @@
 #include "hash_table.h"
+#include <stdlib.h>
 #include <string.h>
 // @save
 
@@ -25,38 +26,152 @@ internal u32 round_up_power_of_two(u32 capacity)
     return capacity + 1;
 }
 
+// Control bytes, see hash_table_gen.h. A cell is full when the high bit is
+// clear, the low 7 bits then hold the bits of the hash not used for the index.
+#define CONTROL_EMPTY 0x80
+#define CONTROL_GROUP_SIZE 16
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTROL_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+internal u8* control_create(u32 capacity)
+{
+    u8* control = (u8*)malloc(capacity + CONTROL_GROUP_SIZE - 1);
+    memset(control, CONTROL_EMPTY, capacity + CONTROL_GROUP_SIZE - 1);
+    return control;
+}
+
+// Grow at 7/8 full, group probing keeps the runs cheap to scan.
+internal u32 control_max_load(u32 capacity)
+{
+    return capacity - (capacity >> 3);
+}
+
+internal b8 control_is_full(u8 control)
+{
+    return (control & CONTROL_EMPTY) == 0;
+}
+
+internal u8 control_tag(u64 hash)
+{
+    return (u8)(hash & 0x7F);
+}
+
+internal u32 control_home(u64 hash, u32 capacity_mask)
+{
+    return (u32)(hash >> 7) & capacity_mask;
+}
+
+internal void control_set(u8* control, u32 index, u8 value, u32 capacity)
+{
+    control[index] = value;
+    if (index < CONTROL_GROUP_SIZE - 1)
+    {
+        control[capacity + index] = value;
+    }
+}
+
+// Bit i is set when group[i] equals tag.
+internal u32 control_match(const u8* group, u8 tag)
+{
+#ifdef CONTROL_SSE2
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)tag)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < CONTROL_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+internal u32 control_match_empty(const u8* group)
+{
+#ifdef CONTROL_SSE2
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < CONTROL_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+internal u32 control_first_bit(u32 mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctz(mask);
+#endif
+}
+
+internal void control_prefetch(const void* address)
+{
+#ifdef CONTROL_SSE2
+    _mm_prefetch((const char*)address, _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+internal u32 control_find_empty(const u8* control, u32 index, u32 capacity_mask)
+{
+    for (;;)
+    {
+        const u32 empty = control_match_empty(control + index);
+        if (empty)
+        {
+            return (index + control_first_bit(empty)) & capacity_mask;
+        }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+}
+
 // @end
 
-HashTableUU64 hash_table_create_uu64(u32 capacity,
-                                     u64 (*hash_function)(const void* key, u32 len, u64 seed))
+HashTableUU64 hash_table_create_uu64(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
 {
     capacity = max(round_up_power_of_two(capacity), 32);
     HashTableUU64 out = {
         .cells = (CellUU64*)calloc(capacity, sizeof(CellUU64)),
+        .control = control_create(capacity),
         .capacity = capacity,
         .hash_function = hash_function,
     };
     return out;
 }
 
-HashTableCharU32 hash_table_create_char_u32(u32 capacity, u64 (*hash_function)(const void* key,
-                                                                               u32 len, u64 seed))
+HashTableCharU32 hash_table_create_char_u32(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
 {
     capacity = max(round_up_power_of_two(capacity), 32);
     HashTableCharU32 out = {
         .cells = (CellCharU32*)calloc(capacity, sizeof(CellCharU32)),
+        .control = control_create(capacity),
         .capacity = capacity,
         .hash_function = hash_function,
     };
     return out;
 }
 
-HashTableGuid hash_table_create_guid(u32 capacity,
-                                     u64 (*hash_function)(const void* key, u32 len, u64 seed))
+HashTableGuid hash_table_create_guid(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
 {
     capacity = max(round_up_power_of_two(capacity), 32);
     HashTableGuid out = {
         .cells = (CellGuid*)calloc(capacity, sizeof(CellGuid)),
+        .control = control_create(capacity),
         .capacity = capacity,
         .hash_function = hash_function,
     };
@@ -65,373 +180,379 @@ HashTableGuid hash_table_create_guid(u32 capacity,
 
 void hash_table_clear_uu64(HashTableUU64* hash_table)
 {
-    memset(hash_table->cells, 0, hash_table->capacity * sizeof(hash_table->cells[0]));
+    memset(hash_table->control, CONTROL_EMPTY, hash_table->capacity + CONTROL_GROUP_SIZE - 1);
+    hash_table->size = 0;
 }
 
 void hash_table_clear_char_u32(HashTableCharU32* hash_table)
 {
-    memset(hash_table->cells, 0, hash_table->capacity * sizeof(hash_table->cells[0]));
+    memset(hash_table->control, CONTROL_EMPTY, hash_table->capacity + CONTROL_GROUP_SIZE - 1);
+    hash_table->size = 0;
 }
 
 void hash_table_clear_guid(HashTableGuid* hash_table)
 {
-    memset(hash_table->cells, 0, hash_table->capacity * sizeof(hash_table->cells[0]));
+    memset(hash_table->control, CONTROL_EMPTY, hash_table->capacity + CONTROL_GROUP_SIZE - 1);
+    hash_table->size = 0;
 }
 
-void hash_table_insert_uu64(HashTableUU64* table, u64 key, u64 value)
+void hash_table_free_uu64(HashTableUU64* hash_table)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
+    free(hash_table->cells);
+    free(hash_table->control);
+    hash_table->cells = NULL;
+    hash_table->control = NULL;
+    hash_table->size = 0;
+    hash_table->capacity = 0;
+}
+
+void hash_table_free_char_u32(HashTableCharU32* hash_table)
+{
+    free(hash_table->cells);
+    free(hash_table->control);
+    hash_table->cells = NULL;
+    hash_table->control = NULL;
+    hash_table->size = 0;
+    hash_table->capacity = 0;
+}
+
+void hash_table_free_guid(HashTableGuid* hash_table)
+{
+    free(hash_table->cells);
+    free(hash_table->control);
+    hash_table->cells = NULL;
+    hash_table->control = NULL;
+    hash_table->size = 0;
+    hash_table->capacity = 0;
+}
 
-    CellUU64* cell = table->cells + hashed_index;
-    if (cell->active)
+void hash_table_insert_uu64(HashTableUU64* table, u64 key, u64 value)
+{
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 index = hash_table_find_uu64(table, key, hash);
+    if (index < table->capacity)
     {
-        if (value_cmp(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 1; i < table->size && cell->active; ++i)
-            {
-                if (value_cmp(cell->key, key) == 0)
-                {
-                    goto add_node;
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else
-        {
-            goto add_node;
-        }
+        table->cells[index].value = value;
+        return;
     }
-    cell->active = true;
-    cell->deleted = false;
-    cell->key = key;
-add_node:
-    cell->value = value;
-    if (table->size++ >= (u32)(table->capacity * 0.4f))
+
+    if (table->size + 1 > control_max_load(table->capacity))
     {
-        u32 old_capacity = table->capacity;
-        CellUU64* old_storage = table->cells;
+        const u32 old_capacity = table->capacity;
+        CellUU64* old_cells = table->cells;
+        u8* old_control = table->control;
 
-        table->size = 0;
         table->capacity *= 2;
         table->cells = (CellUU64*)calloc(table->capacity, sizeof(CellUU64));
+        table->control = control_create(table->capacity);
 
-        for (u32 i = 0; i < old_capacity; i++)
+        const u32 capacity_mask = table->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
         {
-            cell = old_storage + i;
-            if (cell->active)
+            if (control_is_full(old_control[i]))
             {
-                hash_table_insert_uu64(table, cell->key, cell->value);
+                CellUU64* cell = old_cells + i;
+                const u64 cell_hash =
+                    table->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(table->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(table->control, empty, control_tag(cell_hash), table->capacity);
+                table->cells[empty] = *cell;
             }
         }
-        free(old_storage);
+        free(old_cells);
+        free(old_control);
     }
+
+    const u32 capacity_mask = table->capacity - 1;
+    index = control_find_empty(table->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(table->control, index, control_tag(hash), table->capacity);
+    table->cells[index].key = key;
+    table->cells[index].value = value;
+    table->size++;
 }
 
 void hash_table_insert_char_u32(HashTableCharU32* table, char* key, u32 value)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask;
-
-    CellCharU32* cell = table->cells + hashed_index;
-    if (cell->active)
+    const u64 hash = table->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    u32 index = hash_table_find_char_u32(table, key, hash);
+    if (index < table->capacity)
     {
-        if (strcmp(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 1; i < table->size && cell->active; ++i)
-            {
-                if (strcmp(cell->key, key) == 0)
-                {
-                    goto add_node;
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else
-        {
-            goto add_node;
-        }
+        table->cells[index].value = value;
+        return;
     }
-    cell->active = true;
-    cell->deleted = false;
-    cell->key = key;
-add_node:
-    cell->value = value;
-    if (table->size++ >= (u32)(table->capacity * 0.4f))
+
+    if (table->size + 1 > control_max_load(table->capacity))
     {
-        u32 old_capacity = table->capacity;
-        CellCharU32* old_storage = table->cells;
+        const u32 old_capacity = table->capacity;
+        CellCharU32* old_cells = table->cells;
+        u8* old_control = table->control;
 
-        table->size = 0;
         table->capacity *= 2;
         table->cells = (CellCharU32*)calloc(table->capacity, sizeof(CellCharU32));
+        table->control = control_create(table->capacity);
 
-        for (u32 i = 0; i < old_capacity; i++)
+        const u32 capacity_mask = table->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
         {
-            cell = old_storage + i;
-            if (cell->active)
+            if (control_is_full(old_control[i]))
             {
-                hash_table_insert_char_u32(table, cell->key, cell->value);
+                CellCharU32* cell = old_cells + i;
+                const u64 cell_hash =
+                    table->hash_function(&cell->key, (u32)strlen(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(table->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(table->control, empty, control_tag(cell_hash), table->capacity);
+                table->cells[empty] = *cell;
             }
         }
-        free(old_storage);
+        free(old_cells);
+        free(old_control);
     }
+
+    const u32 capacity_mask = table->capacity - 1;
+    index = control_find_empty(table->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(table->control, index, control_tag(hash), table->capacity);
+    table->cells[index].key = key;
+    table->cells[index].value = value;
+    table->size++;
 }
 
 void hash_table_insert_guid(HashTableGuid* table, FticGUID key, char* value)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
-
-    CellGuid* cell = table->cells + hashed_index;
-    if (cell->active)
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 index = hash_table_find_guid(table, key, hash);
+    if (index < table->capacity)
     {
-        if (guid_compare(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 1; i < table->size && cell->active; ++i)
-            {
-                if (guid_compare(cell->key, key) == 0)
-                {
-                    goto add_node;
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else
-        {
-            goto add_node;
-        }
+        table->cells[index].value = value;
+        return;
     }
-    cell->active = true;
-    cell->deleted = false;
-    cell->key = key;
-add_node:
-    cell->value = value;
-    if (table->size++ >= (u32)(table->capacity * 0.4f))
+
+    if (table->size + 1 > control_max_load(table->capacity))
     {
-        u32 old_capacity = table->capacity;
-        CellGuid* old_storage = table->cells;
+        const u32 old_capacity = table->capacity;
+        CellGuid* old_cells = table->cells;
+        u8* old_control = table->control;
 
-        table->size = 0;
         table->capacity *= 2;
         table->cells = (CellGuid*)calloc(table->capacity, sizeof(CellGuid));
+        table->control = control_create(table->capacity);
 
-        for (u32 i = 0; i < old_capacity; i++)
+        const u32 capacity_mask = table->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
         {
-            cell = old_storage + i;
-            if (cell->active)
+            if (control_is_full(old_control[i]))
             {
-                hash_table_insert_guid(table, cell->key, cell->value);
+                CellGuid* cell = old_cells + i;
+                const u64 cell_hash =
+                    table->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(table->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(table->control, empty, control_tag(cell_hash), table->capacity);
+                table->cells[empty] = *cell;
             }
         }
-        free(old_storage);
+        free(old_cells);
+        free(old_control);
     }
+
+    const u32 capacity_mask = table->capacity - 1;
+    index = control_find_empty(table->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(table->control, index, control_tag(hash), table->capacity);
+    table->cells[index].key = key;
+    table->cells[index].value = value;
+    table->size++;
 }
 
-u64* hash_table_get_uu64(HashTableUU64* table, const u64 key)
+u32 hash_table_find_uu64(HashTableUU64* table, const u64 key, const u64 hash)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
-
-    CellUU64* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(table->cells + index);
+    for (u32 probed = 0; probed < table->capacity; probed += CONTROL_GROUP_SIZE)
     {
-        if (value_cmp(cell->key, key) != 0)
+        const u8* group = table->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
         {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (value_cmp(table->cells[candidate].key, key) == 0)
             {
-                if (cell->active)
-                {
-                    if (value_cmp(cell->key, key) == 0)
-                    {
-                        return &cell->value;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
+                return candidate;
             }
         }
-        else if (cell->active)
+        if (control_match_empty(group))
         {
-            return &cell->value;
+            break;
         }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
     }
-    return NULL;
+    return table->capacity;
 }
 
-u32* hash_table_get_char_u32(HashTableCharU32* table, const char* key)
+u32 hash_table_find_char_u32(HashTableCharU32* table, const char* key, const u64 hash)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask;
-
-    CellCharU32* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(table->cells + index);
+    for (u32 probed = 0; probed < table->capacity; probed += CONTROL_GROUP_SIZE)
     {
-        if (strcmp(cell->key, key) != 0)
+        const u8* group = table->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
         {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (strcmp(table->cells[candidate].key, key) == 0)
             {
-                if (cell->active)
-                {
-                    if (strcmp(cell->key, key) == 0)
-                    {
-                        return &cell->value;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
+                return candidate;
             }
         }
-        else if (cell->active)
+        if (control_match_empty(group))
         {
-            return &cell->value;
+            break;
         }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
     }
-    return NULL;
+    return table->capacity;
 }
 
-char** hash_table_get_guid(HashTableGuid* table, const FticGUID key)
+u32 hash_table_find_guid(HashTableGuid* table, const FticGUID key, const u64 hash)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
-
-    CellGuid* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(table->cells + index);
+    for (u32 probed = 0; probed < table->capacity; probed += CONTROL_GROUP_SIZE)
     {
-        if (guid_compare(cell->key, key) != 0)
+        const u8* group = table->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
         {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (guid_compare(table->cells[candidate].key, key) == 0)
             {
-                if (cell->active)
-                {
-                    if (guid_compare(cell->key, key) == 0)
-                    {
-                        return &cell->value;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
+                return candidate;
             }
         }
-        else if (cell->active)
+        if (control_match_empty(group))
         {
-            return &cell->value;
+            break;
         }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
     }
-    return NULL;
+    return table->capacity;
+}
+
+u64* hash_table_get_uu64(HashTableUU64* table, const u64 key)
+{
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    const u32 index = hash_table_find_uu64(table, key, hash);
+    return index < table->capacity ? &table->cells[index].value : NULL;
+}
+
+u32* hash_table_get_char_u32(HashTableCharU32* table, const char* key)
+{
+    const u64 hash = table->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    const u32 index = hash_table_find_char_u32(table, key, hash);
+    return index < table->capacity ? &table->cells[index].value : NULL;
+}
+
+char** hash_table_get_guid(HashTableGuid* table, const FticGUID key)
+{
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    const u32 index = hash_table_find_guid(table, key, hash);
+    return index < table->capacity ? &table->cells[index].value : NULL;
 }
 
 CellUU64* hash_table_remove_uu64(HashTableUU64* table, const u64 key)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 hole = hash_table_find_uu64(table, key, hash);
+    if (hole == table->capacity)
+    {
+        return NULL;
+    }
+    table->removed = table->cells[hole];
 
-    CellUU64* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(table->control[next]);
+         next = (next + 1) & capacity_mask)
     {
-        if (value_cmp(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (value_cmp(cell->key, key) == 0)
-                    {
-                        cell->active = false;
-                        cell->deleted = true;
-                        table->size--;
-                        return cell;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if (cell->active)
+        CellUU64* cell = table->cells + next;
+        const u64 cell_hash = table->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
         {
-            cell->active = false;
-            cell->deleted = true;
-            table->size--;
-            return cell;
+            table->cells[hole] = *cell;
+            control_set(table->control, hole, table->control[next], table->capacity);
+            hole = next;
         }
     }
-    return NULL;
+    control_set(table->control, hole, CONTROL_EMPTY, table->capacity);
+    table->size--;
+    return &table->removed;
 }
 
 CellCharU32* hash_table_remove_char_u32(HashTableCharU32* table, const char* key)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask;
+    const u64 hash = table->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    u32 hole = hash_table_find_char_u32(table, key, hash);
+    if (hole == table->capacity)
+    {
+        return NULL;
+    }
+    table->removed = table->cells[hole];
 
-    CellCharU32* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(table->control[next]);
+         next = (next + 1) & capacity_mask)
     {
-        if (strcmp(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (strcmp(cell->key, key) == 0)
-                    {
-                        cell->active = false;
-                        cell->deleted = true;
-                        table->size--;
-                        return cell;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if (cell->active)
+        CellCharU32* cell = table->cells + next;
+        const u64 cell_hash = table->hash_function(&cell->key, (u32)strlen(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
         {
-            cell->active = false;
-            cell->deleted = true;
-            table->size--;
-            return cell;
+            table->cells[hole] = *cell;
+            control_set(table->control, hole, table->control[next], table->capacity);
+            hole = next;
         }
     }
-    return NULL;
+    control_set(table->control, hole, CONTROL_EMPTY, table->capacity);
+    table->size--;
+    return &table->removed;
 }
 
 CellGuid* hash_table_remove_guid(HashTableGuid* table, const FticGUID key)
 {
-    u32 capacity_mask = table->capacity - 1;
-    u64 hashed_index = table->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask;
+    const u64 hash = table->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 hole = hash_table_find_guid(table, key, hash);
+    if (hole == table->capacity)
+    {
+        return NULL;
+    }
+    table->removed = table->cells[hole];
 
-    CellGuid* cell = table->cells + hashed_index;
-    if (cell->active || cell->deleted)
+    const u32 capacity_mask = table->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(table->control[next]);
+         next = (next + 1) & capacity_mask)
     {
-        if (guid_compare(cell->key, key) != 0)
-        {
-            cell = table->cells + (++hashed_index & capacity_mask);
-            for (u32 i = 0; i < table->capacity && (cell->active || cell->deleted); ++i)
-            {
-                if (cell->active)
-                {
-                    if (guid_compare(cell->key, key) == 0)
-                    {
-                        cell->active = false;
-                        cell->deleted = true;
-                        table->size--;
-                        return cell;
-                    }
-                }
-                cell = table->cells + (++hashed_index & capacity_mask);
-            }
-        }
-        else if (cell->active)
+        CellGuid* cell = table->cells + next;
+        const u64 cell_hash = table->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
         {
-            cell->active = false;
-            cell->deleted = true;
-            table->size--;
-            return cell;
+            table->cells[hole] = *cell;
+            control_set(table->control, hole, table->control[next], table->capacity);
+            hole = next;
         }
     }
-    return NULL;
+    control_set(table->control, hole, CONTROL_EMPTY, table->capacity);
+    table->size--;
+    return &table->removed;
 }
 
@@ -9,56 +9,62 @@
 // @end
 
 typedef struct CellUU64
-{ 
-    u64 key; 
-    u64 value; 
-    bool active; 
-    bool deleted; 
- 
+{
+    u64 key;
+    u64 value;
+
 } CellUU64;
 
 typedef struct CellCharU32
-{ 
-    char* key; 
-    u32 value; 
-    bool active; 
-    bool deleted; 
- 
+{
+    char* key;
+    u32 value;
+
 } CellCharU32;
 
 typedef struct CellGuid
-{ 
-    FticGUID key; 
-    char* value; 
-    bool active; 
-    bool deleted; 
+{
+    FticGUID key;
+    char* value;
 } CellGuid;
 
 typedef struct HashTableUU64
-{ 
-    CellUU64* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    CellUU64* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    CellUU64 removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } HashTableUU64;
 
 typedef struct HashTableCharU32
-{ 
-    CellCharU32* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    CellCharU32* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    CellCharU32 removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } HashTableCharU32;
 
 typedef struct HashTableGuid
-{ 
-    CellGuid* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    CellGuid* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    CellGuid removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } HashTableGuid;
 
 HashTableUU64 hash_table_create_uu64(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed));
@@ -73,12 +79,24 @@ void hash_table_clear_char_u32(HashTableCharU32* hash_table);
 
 void hash_table_clear_guid(HashTableGuid* hash_table);
 
+void hash_table_free_uu64(HashTableUU64* hash_table);
+
+void hash_table_free_char_u32(HashTableCharU32* hash_table);
+
+void hash_table_free_guid(HashTableGuid* hash_table);
+
 void hash_table_insert_uu64(HashTableUU64* table, u64 key, u64 value);
 
 void hash_table_insert_char_u32(HashTableCharU32* table, char* key, u32 value);
 
 void hash_table_insert_guid(HashTableGuid* table, FticGUID key, char* value);
 
+u32 hash_table_find_uu64(HashTableUU64* table, const u64 key, const u64 hash);
+
+u32 hash_table_find_char_u32(HashTableCharU32* table, const char* key, const u64 hash);
+
+u32 hash_table_find_guid(HashTableGuid* table, const FticGUID key, const u64 hash);
+
 u64* hash_table_get_uu64(HashTableUU64* table, const u64 key);
 
 u32* hash_table_get_char_u32(HashTableCharU32* table, const char* key);
@@ -1,4 +1,5 @@
 #pragma once
+#include <stddef.h>
 
 char* concatinate(const char* first, const size_t first_length, const char* second, const size_t second_length, const char delim_between, const size_t extra_length, size_t* result_length);
 void  _log_message(const char* prefix, const size_t prefix_len, const char* message, const size_t message_len);
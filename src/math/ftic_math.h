@@ -1,4 +1,28 @@
 #pragma once
+#include <math.h>
+
+// SSE is used whenever the compiler targets it, which is always the case on
+// x64. AVX is only used by the batch functions and only when the build turns
+// it on (/arch:AVX, -mavx). FTIC_MATH_NO_SIMD forces the scalar code.
+#if !defined(FTIC_MATH_NO_SIMD) &&                                             \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FTIC_MATH_SSE
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define FTIC_MATH_AVX
+#include <immintrin.h>
+#endif
+#endif
+
+// 32 bit MSVC can not pass over aligned structs by value, which every M4
+// function does.
+#if defined(_MSC_VER) && !defined(_M_IX86)
+#define FTIC_MATH_ALIGN(n) __declspec(align(n))
+#elif defined(__GNUC__) || defined(__clang__)
+#define FTIC_MATH_ALIGN(n) __attribute__((aligned(n)))
+#else
+#define FTIC_MATH_ALIGN(n)
+#endif
 
 #define V2_FMT(v) "(x: %f, y: %f)", (v).x, (v).y
 #define V3_FMT(v) "(x: %f, y: %f, z: %f)", (v).x, (v).y, (v).z
@@ -77,6 +101,8 @@ struct V3
     };
 };
 
+// Not over aligned, V4 is part of QuadInstance and Vertex3D and would pad
+// both out. The SIMD code uses unaligned loads.
 typedef struct V4 V4;
 struct V4
 {
@@ -110,7 +136,8 @@ typedef struct Mat3f
     float data[3][3];
 } Mat3f, M3;
 
-typedef struct Mat4f
+// Column major, data[column][row]. Each column is one SSE register.
+typedef struct FTIC_MATH_ALIGN(16) Mat4f
 {
     float data[4][4];
 } Mat4f, M4;
@@ -270,8 +297,48 @@ M4 perspective(float fov, float aspect, float sy_near, float sy_far);
 M4 inverse(M4 m);
 M4 rotate_z(float rad);
 
+// Batch versions for many values at once, out may be the same as the input.
+// The _scalar versions are always the plain C code, for comparison.
+void m4_v4_multi_batch(const M4* m, const V4* in, V4* out, unsigned int count);
+// Positions, w is 1 like in m4_v3_multi.
+void m4_v3_multi_batch(const M4* m, const V3* in, V3* out, unsigned int count);
+void v4_lerp_batch(const V4* from, const V4* to, float t, V4* out, unsigned int count);
+// Clamps to [0, 1] and packs to 8 bit rgba with r in the lowest byte.
+void v4_pack_unorm8_batch(const V4* colors, unsigned int* out, unsigned int count);
+
+M4 m4_multi_scalar(M4 m1, M4 m2);
+void m4_v4_multi_batch_scalar(const M4* m, const V4* in, V4* out, unsigned int count);
+void m4_v3_multi_batch_scalar(const M4* m, const V3* in, V3* out, unsigned int count);
+void v4_lerp_batch_scalar(const V4* from, const V4* to, float t, V4* out, unsigned int count);
+void v4_pack_unorm8_batch_scalar(const V4* colors, unsigned int* out, unsigned int count);
+
 #ifdef FTIC_MATH_IMPLEMENTATION
 
+#ifdef FTIC_MATH_SSE
+static inline __m128 v4_load(V4 v)
+{
+    return _mm_loadu_ps(&v.x);
+}
+
+static inline V4 v4_store(__m128 value)
+{
+    V4 out;
+    _mm_storeu_ps(&out.x, value);
+    return out;
+}
+
+// Column c of m1 * m2 is m1 times column c of m2.
+static inline __m128 m4_column_multi(__m128 c0, __m128 c1, __m128 c2, __m128 c3,
+                                     __m128 v)
+{
+    __m128 out = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    out = _mm_add_ps(out, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+    out = _mm_add_ps(out, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+    out = _mm_add_ps(out, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+    return out;
+}
+#endif
+
 V2 v2d(void)
 {
     V2 res = { 0 };
@@ -433,7 +500,11 @@ V3 v3_add(V3 v1, V3 v2)
 
 V4 v4_add(V4 v1, V4 v2)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_add_ps(v4_load(v1), v4_load(v2)));
+#else
     return v4f(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w);
+#endif
 }
 
 V2 v2_sub(V2 v1, V2 v2)
@@ -448,7 +519,11 @@ V3 v3_sub(V3 v1, V3 v2)
 
 V4 v4_sub(V4 v1, V4 v2)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_sub_ps(v4_load(v1), v4_load(v2)));
+#else
     return v4f(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w);
+#endif
 }
 
 V2 v2_div(V2 v1, V2 v2)
@@ -463,7 +538,11 @@ V3 v3_div(V3 v1, V3 v2)
 
 V4 v4_div(V4 v1, V4 v2)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_div_ps(v4_load(v1), v4_load(v2)));
+#else
     return v4f(v1.x / v2.x, v1.y / v2.y, v1.z / v2.z, v1.w / v2.w);
+#endif
 }
 
 V2 v2_s_add(V2 v1, float s)
@@ -478,7 +557,11 @@ V3 v3_s_add(V3 v1, float s)
 
 V4 v4_s_add(V4 v1, float s)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_add_ps(v4_load(v1), _mm_set1_ps(s)));
+#else
     return v4f(v1.x + s, v1.y + s, v1.z + s, v1.w + s);
+#endif
 }
 
 V2 v2_s_sub(V2 v1, float s)
@@ -493,7 +576,11 @@ V3 v3_s_sub(V3 v1, float s)
 
 V4 v4_s_sub(V4 v1, float s)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_sub_ps(v4_load(v1), _mm_set1_ps(s)));
+#else
     return v4f(v1.x - s, v1.y - s, v1.z - s, v1.w - s);
+#endif
 }
 
 V2 v2_s_multi(V2 v1, float s)
@@ -508,7 +595,11 @@ V3 v3_s_multi(V3 v1, float s)
 
 V4 v4_s_multi(V4 v1, float s)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_mul_ps(v4_load(v1), _mm_set1_ps(s)));
+#else
     return v4f(v1.x * s, v1.y * s, v1.z * s, v1.w * s);
+#endif
 }
 
 V2 v2_neg(V2 v)
@@ -538,7 +629,11 @@ V3 v3_multi(V3 v1, V3 v2)
 
 V4 v4_multi(V4 v1, V4 v2)
 {
-    return v4f(v1.x * v2.x, v1.y * v2.y, v1.x * v2.y, v1.z);
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_mul_ps(v4_load(v1), v4_load(v2)));
+#else
+    return v4f(v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w);
+#endif
 }
 
 V2 v2_s_div(V2 v1, float s)
@@ -553,7 +648,11 @@ V3 v3_s_div(V3 v1, float s)
 
 V4 v4_s_div(V4 v1, float s)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(_mm_div_ps(v4_load(v1), _mm_set1_ps(s)));
+#else
     return v4f(v1.x / s, v1.y / s, v1.z / s, v1.w / s);
+#endif
 }
 
 void v2_add_equal(V2* v1, V2 v2)
@@ -1028,6 +1127,14 @@ M3 m3_add(M3 m1, M3 m2)
 
 M4 m4_add(M4 m1, M4 m2)
 {
+#ifdef FTIC_MATH_SSE
+    for (int c = 0; c < 4; c++)
+    {
+        _mm_storeu_ps(m1.data[c],
+                      _mm_add_ps(_mm_loadu_ps(m1.data[c]), _mm_loadu_ps(m2.data[c])));
+    }
+    return m1;
+#else
     m1.data[0][0] += m2.data[0][0];
     m1.data[0][1] += m2.data[0][1];
     m1.data[0][2] += m2.data[0][2];
@@ -1049,6 +1156,7 @@ M4 m4_add(M4 m1, M4 m2)
     m1.data[3][3] += m2.data[3][3];
 
     return m1;
+#endif
 }
 
 M2 m2_sub(M2 m1, M2 m2)
@@ -1081,6 +1189,14 @@ M3 m3_sub(M3 m1, M3 m2)
 
 M4 m4_sub(M4 m1, M4 m2)
 {
+#ifdef FTIC_MATH_SSE
+    for (int c = 0; c < 4; c++)
+    {
+        _mm_storeu_ps(m1.data[c],
+                      _mm_sub_ps(_mm_loadu_ps(m1.data[c]), _mm_loadu_ps(m2.data[c])));
+    }
+    return m1;
+#else
     m1.data[0][0] -= m2.data[0][0];
     m1.data[0][1] -= m2.data[0][1];
     m1.data[0][2] -= m2.data[0][2];
@@ -1102,6 +1218,7 @@ M4 m4_sub(M4 m1, M4 m2)
     m1.data[3][3] -= m2.data[3][3];
 
     return m1;
+#endif
 }
 
 M2 m2_s_multi(M2 m, float s)
@@ -1134,6 +1251,14 @@ M3 m3_s_multi(M3 m, float s)
 
 M4 m4_s_multi(M4 m, float s)
 {
+#ifdef FTIC_MATH_SSE
+    const __m128 scalar = _mm_set1_ps(s);
+    for (int c = 0; c < 4; c++)
+    {
+        _mm_storeu_ps(m.data[c], _mm_mul_ps(_mm_loadu_ps(m.data[c]), scalar));
+    }
+    return m;
+#else
     m.data[0][0] *= s;
     m.data[0][1] *= s;
     m.data[0][2] *= s;
@@ -1155,6 +1280,7 @@ M4 m4_s_multi(M4 m, float s)
     m.data[3][3] *= s;
 
     return m;
+#endif
 }
 
 V2 m2_v2_multi(M2 m, V2 v)
@@ -1176,6 +1302,14 @@ V3 m3_v3_multi(M3 m, V3 v)
 
 V3 m4_v3_multi(M4 m, V3 v)
 {
+#ifdef FTIC_MATH_SSE
+    const __m128 out = m4_column_multi(_mm_loadu_ps(m.data[0]), _mm_loadu_ps(m.data[1]),
+                                       _mm_loadu_ps(m.data[2]), _mm_loadu_ps(m.data[3]),
+                                       _mm_setr_ps(v.x, v.y, v.z, 1.0f));
+    float result[4];
+    _mm_storeu_ps(result, out);
+    return v3f(result[0], result[1], result[2]);
+#else
     V3 out;
     out.x = (m.data[0][0] * v.x) + (m.data[1][0] * v.y) + (m.data[2][0] * v.z) +
             (m.data[3][0] * 1.0f);
@@ -1187,10 +1321,16 @@ V3 m4_v3_multi(M4 m, V3 v)
             (m.data[3][2] * 1.0f);
 
     return out;
+#endif
 }
 
 V4 m4_v4_multi(M4 m, V4 v)
 {
+#ifdef FTIC_MATH_SSE
+    return v4_store(m4_column_multi(_mm_loadu_ps(m.data[0]), _mm_loadu_ps(m.data[1]),
+                                    _mm_loadu_ps(m.data[2]), _mm_loadu_ps(m.data[3]),
+                                    v4_load(v)));
+#else
     V4 out;
     out.x = (m.data[0][0] * v.x) + (m.data[1][0] * v.y) + (m.data[2][0] * v.z) +
             (m.data[3][0] * v.w);
@@ -1204,6 +1344,7 @@ V4 m4_v4_multi(M4 m, V4 v)
     out.w = (m.data[0][3] * v.x) + (m.data[1][3] * v.y) + (m.data[2][3] * v.z) +
             (m.data[3][3] * v.w);
     return out;
+#endif
 }
 
 M2 m2_multi(M2 m1, M2 m2)
@@ -1244,7 +1385,7 @@ M3 m3_multi(M3 m1, M3 m2)
     return out;
 }
 
-M4 m4_multi(M4 m1, M4 m2)
+M4 m4_multi_scalar(M4 m1, M4 m2)
 {
     M4 out =
         m4f(m1.data[0][0] * m2.data[0][0] + m1.data[1][0] * m2.data[0][1] +
@@ -1286,8 +1427,34 @@ M4 m4_multi(M4 m1, M4 m2)
     return out;
 }
 
+M4 m4_multi(M4 m1, M4 m2)
+{
+#ifdef FTIC_MATH_SSE
+    const __m128 c0 = _mm_loadu_ps(m1.data[0]);
+    const __m128 c1 = _mm_loadu_ps(m1.data[1]);
+    const __m128 c2 = _mm_loadu_ps(m1.data[2]);
+    const __m128 c3 = _mm_loadu_ps(m1.data[3]);
+    M4 out;
+    for (int c = 0; c < 4; c++)
+    {
+        _mm_storeu_ps(out.data[c], m4_column_multi(c0, c1, c2, c3, _mm_loadu_ps(m2.data[c])));
+    }
+    return out;
+#else
+    return m4_multi_scalar(m1, m2);
+#endif
+}
+
 M4 m4_s_div(M4 m, float s)
 {
+#ifdef FTIC_MATH_SSE
+    const __m128 scalar = _mm_set1_ps(s);
+    for (int c = 0; c < 4; c++)
+    {
+        _mm_storeu_ps(m.data[c], _mm_div_ps(_mm_loadu_ps(m.data[c]), scalar));
+    }
+    return m;
+#else
     M4 out;
     out.data[0][0] = m.data[0][0] / s;
     out.data[0][1] = m.data[0][1] / s;
@@ -1309,6 +1476,7 @@ M4 m4_s_div(M4 m, float s)
     out.data[3][2] = m.data[3][2] / s;
     out.data[3][3] = m.data[3][3] / s;
     return out;
+#endif
 }
 long m2_equal(M2 m1, M2 m2)
 {
@@ -1388,6 +1556,19 @@ M3 m3_transpose(M3 m3)
 
 M4 m4_transpose(M4 m4)
 {
+#ifdef FTIC_MATH_SSE
+    __m128 c0 = _mm_loadu_ps(m4.data[0]);
+    __m128 c1 = _mm_loadu_ps(m4.data[1]);
+    __m128 c2 = _mm_loadu_ps(m4.data[2]);
+    __m128 c3 = _mm_loadu_ps(m4.data[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    M4 out;
+    _mm_storeu_ps(out.data[0], c0);
+    _mm_storeu_ps(out.data[1], c1);
+    _mm_storeu_ps(out.data[2], c2);
+    _mm_storeu_ps(out.data[3], c3);
+    return out;
+#else
     M4 out;
 
     out.data[0][0] = m4.data[0][0];
@@ -1411,6 +1592,7 @@ M4 m4_transpose(M4 m4)
     out.data[3][3] = m4.data[3][3];
 
     return out;
+#endif
 }
 
 M3 m3_translate(V2 v)
@@ -1599,4 +1781,167 @@ M4 rotate_z(float rad)
     return res;
 }
 
+void m4_v4_multi_batch_scalar(const M4* m, const V4* in, V4* out, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = m4_v4_multi(*m, in[i]);
+    }
+}
+
+void m4_v3_multi_batch_scalar(const M4* m, const V3* in, V3* out, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const V3 v = in[i];
+        out[i].x = (m->data[0][0] * v.x) + (m->data[1][0] * v.y) + (m->data[2][0] * v.z) +
+                   m->data[3][0];
+        out[i].y = (m->data[0][1] * v.x) + (m->data[1][1] * v.y) + (m->data[2][1] * v.z) +
+                   m->data[3][1];
+        out[i].z = (m->data[0][2] * v.x) + (m->data[1][2] * v.y) + (m->data[2][2] * v.z) +
+                   m->data[3][2];
+    }
+}
+
+void v4_lerp_batch_scalar(const V4* from, const V4* to, float t, V4* out, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i].x = from[i].x + (t * (to[i].x - from[i].x));
+        out[i].y = from[i].y + (t * (to[i].y - from[i].y));
+        out[i].z = from[i].z + (t * (to[i].z - from[i].z));
+        out[i].w = from[i].w + (t * (to[i].w - from[i].w));
+    }
+}
+
+static inline unsigned int unorm8(float value)
+{
+    value = value < 0.0f ? 0.0f : value;
+    value = value > 1.0f ? 1.0f : value;
+    return (unsigned int)(value * 255.0f + 0.5f);
+}
+
+void v4_pack_unorm8_batch_scalar(const V4* colors, unsigned int* out, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = unorm8(colors[i].r) | (unorm8(colors[i].g) << 8) |
+                 (unorm8(colors[i].b) << 16) | (unorm8(colors[i].a) << 24);
+    }
+}
+
+void m4_v4_multi_batch(const M4* m, const V4* in, V4* out, unsigned int count)
+{
+#ifdef FTIC_MATH_SSE
+    unsigned int i = 0;
+#ifdef FTIC_MATH_AVX
+    // Two vectors per register, the shuffles stay within each 128 bit lane.
+    const __m256 c0 = _mm256_broadcast_ps((const __m128*)m->data[0]);
+    const __m256 c1 = _mm256_broadcast_ps((const __m128*)m->data[1]);
+    const __m256 c2 = _mm256_broadcast_ps((const __m128*)m->data[2]);
+    const __m256 c3 = _mm256_broadcast_ps((const __m128*)m->data[3]);
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m256 v = _mm256_loadu_ps(&in[i].x);
+        __m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm256_storeu_ps(&out[i].x, r);
+    }
+#endif
+    const __m128 m0 = _mm_loadu_ps(m->data[0]);
+    const __m128 m1 = _mm_loadu_ps(m->data[1]);
+    const __m128 m2 = _mm_loadu_ps(m->data[2]);
+    const __m128 m3 = _mm_loadu_ps(m->data[3]);
+    for (; i < count; i++)
+    {
+        _mm_storeu_ps(&out[i].x, m4_column_multi(m0, m1, m2, m3, _mm_loadu_ps(&in[i].x)));
+    }
+#else
+    m4_v4_multi_batch_scalar(m, in, out, count);
+#endif
+}
+
+void m4_v3_multi_batch(const M4* m, const V3* in, V3* out, unsigned int count)
+{
+#ifdef FTIC_MATH_SSE
+    const __m128 c0 = _mm_loadu_ps(m->data[0]);
+    const __m128 c1 = _mm_loadu_ps(m->data[1]);
+    const __m128 c2 = _mm_loadu_ps(m->data[2]);
+    const __m128 c3 = _mm_loadu_ps(m->data[3]);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        __m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(in[i].x)));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+        // V3 is 12 bytes, a full store would write into the next element.
+        _mm_storel_pi((__m64*)&out[i].x, r);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+    }
+#else
+    m4_v3_multi_batch_scalar(m, in, out, count);
+#endif
+}
+
+void v4_lerp_batch(const V4* from, const V4* to, float t, V4* out, unsigned int count)
+{
+#ifdef FTIC_MATH_SSE
+    unsigned int i = 0;
+#ifdef FTIC_MATH_AVX
+    const __m256 t8 = _mm256_set1_ps(t);
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m256 a = _mm256_loadu_ps(&from[i].x);
+        const __m256 b = _mm256_loadu_ps(&to[i].x);
+        _mm256_storeu_ps(&out[i].x, _mm256_add_ps(a, _mm256_mul_ps(t8, _mm256_sub_ps(b, a))));
+    }
+#endif
+    const __m128 t4 = _mm_set1_ps(t);
+    for (; i < count; i++)
+    {
+        const __m128 a = _mm_loadu_ps(&from[i].x);
+        const __m128 b = _mm_loadu_ps(&to[i].x);
+        _mm_storeu_ps(&out[i].x, _mm_add_ps(a, _mm_mul_ps(t4, _mm_sub_ps(b, a))));
+    }
+#else
+    v4_lerp_batch_scalar(from, to, t, out, count);
+#endif
+}
+
+#ifdef FTIC_MATH_SSE
+// Truncating after adding a half rounds the same way as the scalar code.
+static inline __m128i v4_unorm8(__m128 color)
+{
+    color = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    color = _mm_add_ps(_mm_mul_ps(color, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(color);
+}
+#endif
+
+void v4_pack_unorm8_batch(const V4* colors, unsigned int* out, unsigned int count)
+{
+#ifdef FTIC_MATH_SSE
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i c0 = v4_unorm8(_mm_loadu_ps(&colors[i + 0].x));
+        const __m128i c1 = v4_unorm8(_mm_loadu_ps(&colors[i + 1].x));
+        const __m128i c2 = v4_unorm8(_mm_loadu_ps(&colors[i + 2].x));
+        const __m128i c3 = v4_unorm8(_mm_loadu_ps(&colors[i + 3].x));
+        const __m128i bytes =
+            _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+        _mm_storeu_si128((__m128i*)(out + i), bytes);
+    }
+    for (; i < count; i++)
+    {
+        const __m128i c = v4_unorm8(_mm_loadu_ps(&colors[i].x));
+        const __m128i packed = _mm_packs_epi32(c, c);
+        out[i] = (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+    }
+#else
+    v4_pack_unorm8_batch_scalar(colors, out, count);
+#endif
+}
+
 #endif
@@ -2,32 +2,81 @@
 #include "texture.h"
 #include <glad/glad.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
-AABB set_up_verticies_color(VertexArray* vertex_array, V2 position, V2 size, V4 color[4],
+u32 pack_color(const V4 color)
+{
+    const u32 r = (u32)(ftic_clamp_high(ftic_clamp_low(color.r, 0.0f), 1.0f) * 255.0f + 0.5f);
+    const u32 g = (u32)(ftic_clamp_high(ftic_clamp_low(color.g, 0.0f), 1.0f) * 255.0f + 0.5f);
+    const u32 b = (u32)(ftic_clamp_high(ftic_clamp_low(color.b, 0.0f), 1.0f) * 255.0f + 0.5f);
+    const u32 a = (u32)(ftic_clamp_high(ftic_clamp_low(color.a, 0.0f), 1.0f) * 255.0f + 0.5f);
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+QuadInstance* quad_array_reserve(QuadArray* quads, const u32 count)
+{
+    if (quads->size + count > quads->capacity)
+    {
+        // Spill out of the mapped segment into heap memory. The render grows
+        // its stream buffer to fit before the next upload.
+        u32 new_capacity = quads->capacity ? quads->capacity * 2 : 64;
+        new_capacity = max(new_capacity, quads->size + count);
+        if (quads->mapped)
+        {
+            QuadInstance* data = (QuadInstance*)malloc(new_capacity * sizeof(QuadInstance));
+            memcpy(data, quads->data, quads->size * sizeof(QuadInstance));
+            quads->data = data;
+            quads->mapped = false;
+        }
+        else
+        {
+            quads->data =
+                (QuadInstance*)realloc(quads->data, new_capacity * sizeof(QuadInstance));
+        }
+        quads->capacity = new_capacity;
+    }
+    QuadInstance* result = quads->data + quads->size;
+    quads->size += count;
+    return result;
+}
+
+internal void quad_array_push(QuadArray* quads, const QuadInstance* quad)
+{
+    if (quads->hash_content)
+    {
+        // FNV-1a, a word at a time.
+        u64 hash = quads->content_hash;
+        const u32* words = (const u32*)quad;
+        for (u32 i = 0; i < sizeof(QuadInstance) / sizeof(u32); ++i)
+        {
+            hash = (hash ^ words[i]) * 0x100000001B3ULL;
+        }
+        quads->content_hash = hash;
+    }
+    *quad_array_reserve(quads, 1) = *quad;
+}
+
+AABB set_up_verticies_color(QuadArray* quads, V2 position, V2 size, V4 color[4],
                             f32 texture_index, TextureCoordinates texture_coordinates)
 {
     position = round_v2(position);
     size = round_v2(size);
 
-    Vertex vertex = {
+    // Only the first and the third corner are needed, the other two are
+    // always the mixed combination of them.
+    QuadInstance quad = {
         .position = position,
-        .texture_coordinates = texture_coordinates.coordinates[0],
-        .color = color[0],
+        .edge_x = v2f(size.x, 0.0f),
+        .edge_y = v2f(0.0f, size.y),
+        .texture_coordinates = v4f(texture_coordinates.coordinates[0].x,
+                                   texture_coordinates.coordinates[0].y,
+                                   texture_coordinates.coordinates[2].x,
+                                   texture_coordinates.coordinates[2].y),
         .texture_index = texture_index,
     };
-    array_push(vertex_array, vertex);
-    vertex.position.y += size.y;
-    vertex.texture_coordinates = texture_coordinates.coordinates[1];
-    vertex.color = color[1];
-    array_push(vertex_array, vertex);
-    vertex.position.x += size.x;
-    vertex.texture_coordinates = texture_coordinates.coordinates[2];
-    vertex.color = color[2];
-    array_push(vertex_array, vertex);
-    vertex.position.y -= size.y;
-    vertex.texture_coordinates = texture_coordinates.coordinates[3];
-    vertex.color = color[3];
-    array_push(vertex_array, vertex);
+    v4_pack_unorm8_batch(color, quad.colors, 4);
+    quad_array_push(quads, &quad);
 
     AABB out;
     out.min = position;
@@ -35,11 +84,11 @@ AABB set_up_verticies_color(VertexArray* vertex_array, V2 position, V2 size, V4
     return out;
 }
 
-AABB set_up_verticies(VertexArray* vertex_array, V2 position, V2 size, V4 color, f32 texture_index,
+AABB set_up_verticies(QuadArray* quads, V2 position, V2 size, V4 color, f32 texture_index,
                       TextureCoordinates texture_coordinates)
 {
     V4 colors[4] = { color, color, color, color };
-    return set_up_verticies_color(vertex_array, position, size, colors, texture_index,
+    return set_up_verticies_color(quads, position, size, colors, texture_index,
                                   texture_coordinates);
 }
 
@@ -54,104 +103,64 @@ V4 quad_get_gradiant_texture_coordinates()
     return texture_coordinates;
 }
 
-AABB quad_co(VertexArray* vertex_array, V2 position, V2 size, V4 color, V4 texture_coordinates,
+AABB quad_co(QuadArray* quads, V2 position, V2 size, V4 color, V4 texture_coordinates,
              f32 texture_index)
 {
     TextureCoordinates _tex_coords = { v2_v4(texture_coordinates),
                                        v2f(texture_coordinates.x, texture_coordinates.w),
                                        v2f(texture_coordinates.z, texture_coordinates.w),
                                        v2f(texture_coordinates.z, texture_coordinates.y) };
-    return set_up_verticies(vertex_array, position, size, color, texture_index, _tex_coords);
+    return set_up_verticies(quads, position, size, color, texture_index, _tex_coords);
 }
 
-AABB quad(VertexArray* vertex_array, V2 position, V2 size, V4 color, f32 texture_index)
+AABB quad(QuadArray* quads, V2 position, V2 size, V4 color, f32 texture_index)
 {
     TextureCoordinates texture_coordinates = { v2d(), v2f(0.0f, 1.0f), v2f(1.0f, 1.0f),
                                                v2f(1.0f, 0.0f) };
-    return set_up_verticies(vertex_array, position, size, color, texture_index,
+    return set_up_verticies(quads, position, size, color, texture_index,
                             texture_coordinates);
 }
 
-AABB quad_shadow(VertexArray* vertex_array, V2 position, V2 size, V4 color, f32 texture_index)
+AABB quad_shadow(QuadArray* quads, V2 position, V2 size, V4 color, f32 texture_index)
 {
     V4 shadow_color = v4ic(0.0f);
     V4 end_color = shadow_color;
     end_color.a = 0.6f;
     V2 shadow_position = v2_s_add(position, 2.5f);
-    quad_gradiant_tl_br(vertex_array, shadow_position, size, shadow_color, end_color, 0.0f);
-    return quad(vertex_array, position, size, color, texture_index);
+    quad_gradiant_tl_br(quads, shadow_position, size, shadow_color, end_color, 0.0f);
+    return quad(quads, position, size, color, texture_index);
 }
 
-void generate_indicies(IndexArray* array, u32 offset, u32 indices_count)
-{
-    const u32 INDEX_TABLE[] = { 0, 1, 2, 2, 3, 0 };
-    for (u32 i = 0; i < indices_count; i++)
-    {
-        for (u32 j = 0; j < 6; j++)
-        {
-            array_push(array, ((INDEX_TABLE[j] + (4 * i)) + offset));
-        }
-    }
-}
-
-internal AABB quad_gradiant_internal(VertexArray* vertex_array, V2 position, V2 size,
+internal AABB quad_gradiant_internal(QuadArray* quads, V2 position, V2 size,
                                      V4 corner_colors[4], f32 texture_index)
 {
-    TextureCoordinates texture_coordinates = { v2d(), v2f(0.0f, 1.0f), v2f(1.0f, 1.0f),
-                                               v2f(1.0f, 0.0f) };
-
-    position = round_v2(position);
-    size = round_v2(size);
-    Vertex vertex = {
-        .position = position,
-        .texture_coordinates = texture_coordinates.coordinates[0],
-        .color = corner_colors[0],
-        .texture_index = texture_index,
-    };
-    array_push(vertex_array, vertex);
-    vertex.position.y += size.y;
-    vertex.texture_coordinates = texture_coordinates.coordinates[1];
-    vertex.color = corner_colors[1];
-    array_push(vertex_array, vertex);
-    vertex.position.x += size.x;
-    vertex.texture_coordinates = texture_coordinates.coordinates[2];
-    vertex.color = corner_colors[2];
-    array_push(vertex_array, vertex);
-    vertex.position.y -= size.y;
-    vertex.texture_coordinates = texture_coordinates.coordinates[3];
-    vertex.color = corner_colors[3];
-    array_push(vertex_array, vertex);
-
-    AABB out = {
-        .min = position,
-        .size = size,
-    };
-    return out;
+    return set_up_verticies_color(quads, position, size, corner_colors, texture_index,
+                                  default_texture_coordinates());
 }
 
-AABB quad_gradiant_l_r(VertexArray* vertex_array, V2 position, V2 size, V4 left_color,
+AABB quad_gradiant_l_r(QuadArray* quads, V2 position, V2 size, V4 left_color,
                        V4 right_color, f32 texture_index)
 {
     V4 corner_colors[] = { left_color, left_color, right_color, right_color };
-    return quad_gradiant_internal(vertex_array, position, size, corner_colors, texture_index);
+    return quad_gradiant_internal(quads, position, size, corner_colors, texture_index);
 }
 
-AABB quad_gradiant_t_b(VertexArray* vertex_array, V2 position, V2 size, V4 top_color,
+AABB quad_gradiant_t_b(QuadArray* quads, V2 position, V2 size, V4 top_color,
                        V4 bottom_color, f32 texture_index)
 {
     V4 corner_colors[] = { top_color, bottom_color, bottom_color, top_color };
-    return quad_gradiant_internal(vertex_array, position, size, corner_colors, texture_index);
+    return quad_gradiant_internal(quads, position, size, corner_colors, texture_index);
 }
 
-AABB quad_gradiant_tl_br(VertexArray* vertex_array, V2 position, V2 size, V4 top_color,
+AABB quad_gradiant_tl_br(QuadArray* quads, V2 position, V2 size, V4 top_color,
                          V4 bottom_color, f32 texture_index)
 {
     V4 half_color = v4_lerp(top_color, bottom_color, 0.5f);
     V4 corner_colors[] = { top_color, half_color, bottom_color, half_color };
-    return quad_gradiant_internal(vertex_array, position, size, corner_colors, texture_index);
+    return quad_gradiant_internal(quads, position, size, corner_colors, texture_index);
 }
 
-AABB quad_border_gradiant(VertexArray* vertex_array, u32* num_indices, V2 top_left, V2 size,
+AABB quad_border_gradiant(QuadArray* quads, u32* num_indices, V2 top_left, V2 size,
                           V4 border_color_top_left, V4 border_color_bottom_right, f32 thickness,
                           f32 texture_index)
 {
@@ -159,16 +168,16 @@ AABB quad_border_gradiant(VertexArray* vertex_array, u32* num_indices, V2 top_le
     V2 v_size = v2f(thickness, size.y);
 
     V4 border_color_top_right = v4_lerp(border_color_top_left, border_color_bottom_right, 0.5f);
-    quad_gradiant_l_r(vertex_array, top_left, h_size, border_color_top_left, border_color_top_right,
+    quad_gradiant_l_r(quads, top_left, h_size, border_color_top_left, border_color_top_right,
                       texture_index);
 
-    quad_gradiant_l_r(vertex_array, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size,
+    quad_gradiant_l_r(quads, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size,
                       border_color_top_right, border_color_bottom_right, texture_index);
 
-    quad_gradiant_t_b(vertex_array, top_left, v_size, border_color_top_left, border_color_top_right,
+    quad_gradiant_t_b(quads, top_left, v_size, border_color_top_left, border_color_top_right,
                       texture_index);
 
-    quad_gradiant_t_b(vertex_array, v2f(top_left.x + h_size.x - thickness, top_left.y), v_size,
+    quad_gradiant_t_b(quads, v2f(top_left.x + h_size.x - thickness, top_left.y), v_size,
                       border_color_top_right, border_color_bottom_right, texture_index);
 
     if (num_indices)
@@ -181,20 +190,20 @@ AABB quad_border_gradiant(VertexArray* vertex_array, u32* num_indices, V2 top_le
     return out;
 }
 
-AABB quad_border(VertexArray* vertex_array, u32* num_indices, V2 top_left, V2 size, V4 color,
+AABB quad_border(QuadArray* quads, u32* num_indices, V2 top_left, V2 size, V4 color,
                  f32 thickness, f32 texture_index)
 {
     V2 h_size = v2f(size.x, thickness);
     V2 v_size = v2f(thickness, size.y);
 
-    quad(vertex_array, top_left, h_size, color, texture_index);
+    quad(quads, top_left, h_size, color, texture_index);
 
-    quad(vertex_array, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size, color,
+    quad(quads, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size, color,
          texture_index);
 
-    quad(vertex_array, top_left, v_size, color, texture_index);
+    quad(quads, top_left, v_size, color, texture_index);
 
-    quad(vertex_array, v2f(top_left.x + h_size.x - thickness, top_left.y), v_size, color,
+    quad(quads, v2f(top_left.x + h_size.x - thickness, top_left.y), v_size, color,
          texture_index);
 
     if (num_indices)
@@ -207,13 +216,13 @@ AABB quad_border(VertexArray* vertex_array, u32* num_indices, V2 top_left, V2 si
     return out;
 }
 
-V2 get_position(VertexArray* vertex_array, const V2 focal, const f32 half_size, const f32 thickness,
+V2 get_position(QuadArray* quads, const V2 focal, const f32 half_size, const f32 thickness,
                 const f32 degree)
 {
     return v2d();
 }
 
-AABB quad_border_rounded(VertexArray* vertex_array, u32* num_indices, V2 top_left, V2 size,
+AABB quad_border_rounded(QuadArray* quads, u32* num_indices, V2 top_left, V2 size,
                          V4 color, f32 thickness, f32 roundness, u32 samples_per_side,
                          f32 texture_index)
 {
@@ -231,16 +240,15 @@ AABB quad_border_rounded(VertexArray* vertex_array, u32* num_indices, V2 top_lef
     V2 pivot_point_down = v2f(top_left.x, top_left.y + v_size.y);
     pivot_point_down.y -= pivot_offset;
 
-    quad(vertex_array, top_left, h_size, color, texture_index);
+    quad(quads, top_left, h_size, color, texture_index);
 
-    quad(vertex_array, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size, color,
+    quad(quads, v2f(top_left.x, top_left.y + v_size.y - thickness), h_size, color,
          texture_index);
 
-    quad(vertex_array, v2f(pivot_point_up.x - pivot_offset, pivot_point_up.y),
+    quad(quads, v2f(pivot_point_up.x - pivot_offset, pivot_point_up.y),
          v2f(thickness, pivot_point_down.y - pivot_point_up.y), color, texture_index);
 
-    TextureCoordinates texture_coordinates = { v2d(), v2f(0.0f, 1.0f), v2f(1.0f, 1.0f),
-                                               v2f(1.0f, 0.0f) };
+    const u32 packed_color = pack_color(color);
 
     V2* start_pivot = &pivot_point_up;
     V2* end_pivot = &pivot_point_down;
@@ -253,37 +261,31 @@ AABB quad_border_rounded(VertexArray* vertex_array, u32* num_indices, V2 top_lef
         {
             for (u32 k = 0; k < samples_per_side; ++k)
             {
+                V2 outer = pivot_point;
+                outer.x += cosf(degree) * pivot_offset;
+                outer.y -= sinf(degree) * pivot_offset;
 
-                Vertex vertex = {
-                    .position = v2d(),
-                    .texture_coordinates = texture_coordinates.coordinates[0],
-                    .color = color,
-                    .texture_index = texture_index,
-                };
-                vertex.position = pivot_point;
-                vertex.position.x += cosf(degree) * pivot_offset;
-                vertex.position.y -= sinf(degree) * pivot_offset;
-                array_push(vertex_array, vertex);
-
-                vertex.position = pivot_point;
-                vertex.position.x += cosf(degree) * (pivot_offset - thickness);
-                vertex.position.y -= sinf(degree) * (pivot_offset - thickness);
-                vertex.texture_coordinates = texture_coordinates.coordinates[1];
-                array_push(vertex_array, vertex);
+                V2 inner = pivot_point;
+                inner.x += cosf(degree) * (pivot_offset - thickness);
+                inner.y -= sinf(degree) * (pivot_offset - thickness);
 
                 degree += degree_increase;
 
-                vertex.position = pivot_point;
-                vertex.position.x += cosf(degree) * pivot_offset;
-                vertex.position.y -= sinf(degree) * pivot_offset;
-                vertex.texture_coordinates = texture_coordinates.coordinates[2];
-                array_push(vertex_array, vertex);
-
-                vertex.position = pivot_point;
-                vertex.position.x += cosf(degree) * (pivot_offset - thickness);
-                vertex.position.y -= sinf(degree) * (pivot_offset - thickness);
-                vertex.texture_coordinates = texture_coordinates.coordinates[3];
-                array_push(vertex_array, vertex);
+                V2 next_outer = pivot_point;
+                next_outer.x += cosf(degree) * pivot_offset;
+                next_outer.y -= sinf(degree) * pivot_offset;
+
+                // The segment is drawn as a parallelogram, the missing inner
+                // corner is off by less than a pixel for small steps.
+                QuadInstance segment = {
+                    .position = outer,
+                    .edge_x = v2_sub(next_outer, outer),
+                    .edge_y = v2_sub(inner, outer),
+                    .texture_coordinates = v4f(0.0f, 0.0f, 1.0f, 1.0f),
+                    .colors = { packed_color, packed_color, packed_color, packed_color },
+                    .texture_index = texture_index,
+                };
+                quad_array_push(quads, &segment);
             }
             pivot_point = *end_pivot;
         }
@@ -297,7 +299,7 @@ AABB quad_border_rounded(VertexArray* vertex_array, u32* num_indices, V2 top_lef
     }
     pivot_point_up.x -= h_size.x;
 
-    quad(vertex_array, v2f(pivot_point_up.x + pivot_offset - thickness, pivot_point_up.y),
+    quad(quads, v2f(pivot_point_up.x + pivot_offset - thickness, pivot_point_up.y),
          v2f(thickness, pivot_point_down.y - pivot_point_up.y), color, texture_index);
 
     if (num_indices)
@@ -1,69 +1,201 @@
 #include "particle_system.h"
-#include "util.h"
+#include <string.h>
 
-void particle_buffer_create(UnorderedCircularParticleBuffer* buffer,
-                            u32 capacity)
+// Number of f32 arrays in ParticleBuffer, they share one allocation.
+#define PARTICLE_FLOAT_ARRAY_COUNT 15
+
+void particle_buffer_create(ParticleBuffer* buffer, u32 capacity)
 {
+    // Rounded up so that every array starts 16 byte aligned.
+    capacity = (capacity + 3) & ~3u;
+    f32* memory = (f32*)calloc(capacity * PARTICLE_FLOAT_ARRAY_COUNT, sizeof(f32));
     buffer->index = 0;
     buffer->size = 0;
     buffer->capacity = capacity;
-    buffer->data = (Particle*)calloc(capacity, sizeof(Particle));
+    buffer->position_x = memory;
+    buffer->position_y = buffer->position_x + capacity;
+    buffer->velocity_x = buffer->position_y + capacity;
+    buffer->velocity_y = buffer->velocity_x + capacity;
+    buffer->acceleration_x = buffer->velocity_y + capacity;
+    buffer->acceleration_y = buffer->acceleration_x + capacity;
+    buffer->width = buffer->acceleration_y + capacity;
+    buffer->height = buffer->width + capacity;
+    buffer->start_width = buffer->height + capacity;
+    buffer->start_height = buffer->start_width + capacity;
+    buffer->life = buffer->start_height + capacity;
+    buffer->life_time = buffer->life + capacity;
+    buffer->alpha = buffer->life_time + capacity;
+    buffer->size_change = buffer->alpha + capacity;
+    buffer->alpha_change = buffer->size_change + capacity;
+    buffer->color = (u32*)calloc(capacity, sizeof(u32));
 }
 
-Particle* particle_buffer_get_next(UnorderedCircularParticleBuffer* buffer)
+void particle_buffer_free(ParticleBuffer* buffer)
 {
-    return buffer->data + buffer->index;
+    free(buffer->position_x);
+    free(buffer->color);
+    memset(buffer, 0, sizeof(ParticleBuffer));
 }
 
-void particle_buffer_set_next(UnorderedCircularParticleBuffer* buffer,
-                              const Particle* particle)
+void particle_buffer_emit(ParticleBuffer* buffer, const Particle* particle)
 {
-    buffer->data[buffer->index++].start_dimensions = particle->dimension;
+    const u32 i = buffer->index++;
+    buffer->position_x[i] = particle->position.x;
+    buffer->position_y[i] = particle->position.y;
+    buffer->velocity_x[i] = particle->velocity.x;
+    buffer->velocity_y[i] = particle->velocity.y;
+    buffer->acceleration_x[i] = particle->acceleration.x;
+    buffer->acceleration_y[i] = particle->acceleration.y;
+    buffer->width[i] = particle->dimension.width;
+    buffer->height[i] = particle->dimension.height;
+    buffer->start_width[i] = particle->dimension.width;
+    buffer->start_height[i] = particle->dimension.height;
+    buffer->life[i] = particle->life;
+    buffer->life_time[i] = particle->life;
+    buffer->alpha[i] = particle->color.a;
+    buffer->size_change[i] = particle->size_change ? 1.0f : 0.0f;
+    buffer->alpha_change[i] = particle->alpha_change ? 1.0f : 0.0f;
+
+    V4 color = particle->color;
+    color.a = 0.0f;
+    v4_pack_unorm8_batch(&color, buffer->color + i, 1);
+
     buffer->size = min(buffer->size + 1, buffer->capacity);
     buffer->index %= buffer->capacity;
 }
 
-void particle_update(Particle* particle, const f64 delta_time)
+internal void particle_update_scalar(ParticleBuffer* buffer, const u32 i, const f32 delta_time)
 {
-    particle->velocity =
-        v2_add(particle->velocity,
-               v2_s_multi(particle->acceleration, (f32)delta_time));
-    particle->position = v2_add(
-        particle->position, v2_s_multi(particle->velocity, (f32)delta_time));
+    buffer->velocity_x[i] += buffer->acceleration_x[i] * delta_time;
+    buffer->velocity_y[i] += buffer->acceleration_y[i] * delta_time;
+    buffer->position_x[i] += buffer->velocity_x[i] * delta_time;
+    buffer->position_y[i] += buffer->velocity_y[i] * delta_time;
+    buffer->life[i] = max(buffer->life[i] - delta_time, 0.0f);
+
+    const f32 life_remaining = buffer->life[i] / buffer->life_time[i];
+    const f32 size_change = buffer->size_change[i];
+    buffer->width[i] +=
+        ((buffer->start_width[i] * life_remaining) - buffer->width[i]) * size_change;
+    buffer->height[i] +=
+        ((buffer->start_height[i] * life_remaining) - buffer->height[i]) * size_change;
+    buffer->alpha[i] += (life_remaining - buffer->alpha[i]) * buffer->alpha_change[i];
 }
 
-void particle_buffer_update(UnorderedCircularParticleBuffer* buffer,
-                            const f64 delta_time)
+#ifdef FTIC_MATH_SSE
+internal void particle_update_sse(ParticleBuffer* buffer, const u32 i, const __m128 delta_time)
 {
-    for (u32 i = 0; i < buffer->size; ++i)
+    __m128 velocity_x = _mm_load_ps(buffer->velocity_x + i);
+    __m128 velocity_y = _mm_load_ps(buffer->velocity_y + i);
+    velocity_x =
+        _mm_add_ps(velocity_x, _mm_mul_ps(_mm_load_ps(buffer->acceleration_x + i), delta_time));
+    velocity_y =
+        _mm_add_ps(velocity_y, _mm_mul_ps(_mm_load_ps(buffer->acceleration_y + i), delta_time));
+    _mm_store_ps(buffer->velocity_x + i, velocity_x);
+    _mm_store_ps(buffer->velocity_y + i, velocity_y);
+    _mm_store_ps(buffer->position_x + i, _mm_add_ps(_mm_load_ps(buffer->position_x + i),
+                                                    _mm_mul_ps(velocity_x, delta_time)));
+    _mm_store_ps(buffer->position_y + i, _mm_add_ps(_mm_load_ps(buffer->position_y + i),
+                                                    _mm_mul_ps(velocity_y, delta_time)));
+
+    const __m128 life =
+        _mm_max_ps(_mm_sub_ps(_mm_load_ps(buffer->life + i), delta_time), _mm_setzero_ps());
+    _mm_store_ps(buffer->life + i, life);
+    const __m128 life_remaining = _mm_div_ps(life, _mm_load_ps(buffer->life_time + i));
+
+    const __m128 size_change = _mm_load_ps(buffer->size_change + i);
+    const __m128 width = _mm_load_ps(buffer->width + i);
+    const __m128 height = _mm_load_ps(buffer->height + i);
+    const __m128 target_width = _mm_mul_ps(_mm_load_ps(buffer->start_width + i), life_remaining);
+    const __m128 target_height =
+        _mm_mul_ps(_mm_load_ps(buffer->start_height + i), life_remaining);
+    _mm_store_ps(buffer->width + i,
+                 _mm_add_ps(width, _mm_mul_ps(_mm_sub_ps(target_width, width), size_change)));
+    _mm_store_ps(buffer->height + i,
+                 _mm_add_ps(height, _mm_mul_ps(_mm_sub_ps(target_height, height), size_change)));
+
+    const __m128 alpha = _mm_load_ps(buffer->alpha + i);
+    _mm_store_ps(buffer->alpha + i,
+                 _mm_add_ps(alpha, _mm_mul_ps(_mm_sub_ps(life_remaining, alpha),
+                                              _mm_load_ps(buffer->alpha_change + i))));
+}
+#endif
+
+internal void particle_move(ParticleBuffer* buffer, const u32 to, const u32 from)
+{
+    f32* arrays = buffer->position_x;
+    for (u32 i = 0; i < PARTICLE_FLOAT_ARRAY_COUNT; ++i)
     {
-        Particle* particle = buffer->data + i;
-        if (particle->life.x > 0.0f)
+        f32* array = arrays + (i * buffer->capacity);
+        array[to] = array[from];
+    }
+    buffer->color[to] = buffer->color[from];
+}
+
+// Dead particles are swapped with the last one, same as before the split.
+internal void particle_buffer_remove_dead(ParticleBuffer* buffer)
+{
+    for (u32 i = 0; i < buffer->size;)
+    {
+        if (buffer->life[i] > 0.0f)
         {
-            particle_update(particle, delta_time);
-            particle->life.x -= (f32)delta_time;
-            particle->life.x = max(particle->life.x, 0.0f);
-            const f32 life_remaining = particle->life.x / particle->life.y;
-            if (particle->size_change)
-            {
-                particle->dimension =
-                    v2_s_multi(particle->start_dimensions, life_remaining);
-            }
-            if (particle->alpha_change)
-            {
-                particle->color.a = life_remaining;
-            }
+            ++i;
+            continue;
         }
-        else
+        if (i != buffer->size - 1)
         {
-            if (i != buffer->size - 1)
-            {
-                buffer->data[i] = buffer->data[buffer->size - 1];
-            }
-            buffer->size--;
-            buffer->index = buffer->size;
-            --i;
+            particle_move(buffer, i, buffer->size - 1);
         }
+        buffer->size--;
+        buffer->index = buffer->size;
     }
 }
 
+void particle_buffer_update(ParticleBuffer* buffer, const f64 delta_time)
+{
+    particle_buffer_remove_dead(buffer);
+
+    u32 i = 0;
+#ifdef FTIC_MATH_SSE
+    // The capacity is a multiple of four and the slots past size are only
+    // ever overwritten by emit, so the last partial group can be done too.
+    const __m128 delta_time_4 = _mm_set1_ps((f32)delta_time);
+    for (; i < buffer->size; i += 4)
+    {
+        particle_update_sse(buffer, i, delta_time_4);
+    }
+#endif
+    for (; i < buffer->size; ++i)
+    {
+        particle_update_scalar(buffer, i, (f32)delta_time);
+    }
+}
+
+void particle_buffer_update_scalar(ParticleBuffer* buffer, const f64 delta_time)
+{
+    particle_buffer_remove_dead(buffer);
+    for (u32 i = 0; i < buffer->size; ++i)
+    {
+        particle_update_scalar(buffer, i, (f32)delta_time);
+    }
+}
+
+void particle_buffer_write_quads(const ParticleBuffer* buffer, const f32 texture_index,
+                                 QuadInstance* out)
+{
+    const V4 texture_coordinates = v4f(0.0f, 0.0f, 1.0f, 1.0f);
+    for (u32 i = 0; i < buffer->size; ++i)
+    {
+        const f32 alpha = ftic_clamp_high(ftic_clamp_low(buffer->alpha[i], 0.0f), 1.0f);
+        const u32 color = buffer->color[i] | ((u32)(alpha * 255.0f + 0.5f) << 24);
+        QuadInstance* quad = out + i;
+        quad->position = v2f(round_f32(buffer->position_x[i]), round_f32(buffer->position_y[i]));
+        quad->edge_x = v2f(round_f32(buffer->width[i]), 0.0f);
+        quad->edge_y = v2f(0.0f, round_f32(buffer->height[i]));
+        quad->texture_coordinates = texture_coordinates;
+        quad->colors[0] = color;
+        quad->colors[1] = color;
+        quad->colors[2] = color;
+        quad->colors[3] = color;
+        quad->texture_index = texture_index;
+    }
+}
@@ -1,30 +1,52 @@
 #pragma once
 #include "define.h"
 #include "math/ftic_math.h"
+#include "util.h"
 
+// What a new particle starts with, the buffer only keeps it split up.
 typedef struct Particle
 {
     V2 position;
     V2 velocity;
     V2 acceleration;
     V2 dimension;
-    V2 life;
-    V2 start_dimensions;
+    f32 life;
     V4 color;
     b8 size_change;
     b8 alpha_change;
 } Particle;
 
-typedef struct UnorderedCircularParticleBuffer
+// Structure of arrays, every field is its own array so the update can work on
+// four particles at a time. The flags are stored as 0.0f or 1.0f to be able
+// to blend with them instead of branching. When the buffer is full new
+// particles overwrite old ones, in no particular order.
+typedef struct ParticleBuffer
 {
     u32 index;
     u32 size;
     u32 capacity;
-    Particle* data;
-} UnorderedCircularParticleBuffer;
+    f32* position_x;
+    f32* position_y;
+    f32* velocity_x;
+    f32* velocity_y;
+    f32* acceleration_x;
+    f32* acceleration_y;
+    f32* width;
+    f32* height;
+    f32* start_width;
+    f32* start_height;
+    f32* life;
+    f32* life_time;
+    f32* alpha;
+    f32* size_change;
+    f32* alpha_change;
+    u32* color; // Packed RGB, the alpha byte comes from alpha.
+} ParticleBuffer;
 
-void particle_buffer_create(UnorderedCircularParticleBuffer* buffer, u32 capacity);
-Particle* particle_buffer_get_next(UnorderedCircularParticleBuffer* buffer);
-void particle_buffer_set_next(UnorderedCircularParticleBuffer* buffer, const Particle* particle);
-void particle_update(Particle* particle, const f64 delta_time);
-void particle_buffer_update(UnorderedCircularParticleBuffer* buffer, const f64 delta_time);
+void particle_buffer_create(ParticleBuffer* buffer, u32 capacity);
+void particle_buffer_free(ParticleBuffer* buffer);
+void particle_buffer_emit(ParticleBuffer* buffer, const Particle* particle);
+void particle_buffer_update(ParticleBuffer* buffer, const f64 delta_time);
+void particle_buffer_update_scalar(ParticleBuffer* buffer, const f64 delta_time);
+void particle_buffer_write_quads(const ParticleBuffer* buffer, const f32 texture_index,
+                                 QuadInstance* out);
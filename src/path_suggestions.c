@@ -0,0 +1,495 @@
+#include "path_suggestions.h"
+#include "hash.h"
+#include "util.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every prefix match ranks above every match that only has the characters
+// in order.
+#define SUGGESTION_PREFIX_SCORE (1LL << 50)
+
+typedef struct SuggestionScore
+{
+    i64 score;
+    u32 entry;
+} SuggestionScore;
+
+typedef struct PathSuggestionLoad
+{
+    PathSuggestionService* service;
+    u64 key;
+    char* directory;
+    u32 directory_length;
+} PathSuggestionLoad;
+
+internal int suggestion_entry_compare(const void* first, const void* second)
+{
+    const SuggestionEntry* first_entry = (const SuggestionEntry*)first;
+    const SuggestionEntry* second_entry = (const SuggestionEntry*)second;
+    const int result = strcmp(first_entry->key, second_entry->key);
+    if (result)
+    {
+        return result;
+    }
+    return (first_entry->item_index > second_entry->item_index) -
+           (first_entry->item_index < second_entry->item_index);
+}
+
+internal const char* suggestion_label(const PathSuggestionSnapshot* snapshot,
+                                      const SuggestionTrieNode* node)
+{
+    return snapshot->entries[node->first_entry].key + node->label_offset;
+}
+
+internal i32 suggestion_trie_add_node(PathSuggestionSnapshot* snapshot, const u32 label_offset,
+                                      const u32 label_length, const u32 entry)
+{
+    const SuggestionTrieNode node = {
+        .label_offset = label_offset,
+        .label_length = label_length,
+        .first_child = -1,
+        .last_child = -1,
+        .next_sibling = -1,
+        .first_entry = entry,
+        .entry_count = 1,
+    };
+    array_push(&snapshot->nodes, node);
+    return (i32)snapshot->nodes.size - 1;
+}
+
+// The entries are inserted in sorted order, so only the last child of a node
+// can share a prefix with the new key and new children are always appended.
+internal void suggestion_trie_insert(PathSuggestionSnapshot* snapshot, const u32 entry)
+{
+    const SuggestionEntry* suggestion_entry = snapshot->entries + entry;
+    const char* key = suggestion_entry->key;
+    const u32 key_length = suggestion_entry->key_length;
+
+    i32 node_index = 0;
+    snapshot->nodes.data[0].entry_count++;
+    u32 position = 0;
+    while (position < key_length)
+    {
+        const i32 child_index = snapshot->nodes.data[node_index].last_child;
+        if (child_index < 0 ||
+            suggestion_label(snapshot, snapshot->nodes.data + child_index)[0] != key[position])
+        {
+            const i32 leaf = suggestion_trie_add_node(snapshot, position,
+                                                      key_length - position, entry);
+            SuggestionTrieNode* node = snapshot->nodes.data + node_index;
+            if (node->last_child >= 0)
+            {
+                snapshot->nodes.data[node->last_child].next_sibling = leaf;
+            }
+            else
+            {
+                node->first_child = leaf;
+            }
+            node->last_child = leaf;
+            return;
+        }
+
+        SuggestionTrieNode* child = snapshot->nodes.data + child_index;
+        const char* label = suggestion_label(snapshot, child);
+        u32 common = 1;
+        while (common < child->label_length && position + common < key_length &&
+               label[common] == key[position + common])
+        {
+            ++common;
+        }
+        if (common < child->label_length)
+        {
+            // The child keeps its slot and becomes the shared part, what is
+            // left of its label moves into a new node below it.
+            const i32 rest = suggestion_trie_add_node(snapshot, 0, 0, 0);
+            child = snapshot->nodes.data + child_index;
+            SuggestionTrieNode* rest_node = snapshot->nodes.data + rest;
+            *rest_node = *child;
+            rest_node->label_offset += common;
+            rest_node->label_length -= common;
+            rest_node->next_sibling = -1;
+            child->label_length = common;
+            child->first_child = rest;
+            child->last_child = rest;
+        }
+        child->entry_count++;
+        position += common;
+        node_index = child_index;
+    }
+}
+
+PathSuggestionSnapshot* path_suggestion_snapshot_create(DirectoryItemArray* items)
+{
+    PathSuggestionSnapshot* snapshot =
+        (PathSuggestionSnapshot*)calloc(1, sizeof(PathSuggestionSnapshot));
+    snapshot->items = *items;
+    *items = (DirectoryItemArray){ 0 };
+    snapshot->created_time = platform_get_time();
+
+    snapshot->entry_count = snapshot->items.size;
+    snapshot->entries =
+        (SuggestionEntry*)calloc(ftic_max(snapshot->entry_count, 1), sizeof(SuggestionEntry));
+    for (u32 i = 0; i < snapshot->entry_count; ++i)
+    {
+        const char* name = item_namec(snapshot->items.data + i);
+        SuggestionEntry* entry = snapshot->entries + i;
+        entry->key_length = (u32)strlen(name);
+        entry->key = string_copy(name, entry->key_length, 0);
+        entry->item_index = i;
+        for (u32 j = 0; j < entry->key_length; ++j)
+        {
+            entry->key[j] = (char)tolower((unsigned char)entry->key[j]);
+        }
+    }
+    qsort(snapshot->entries, snapshot->entry_count, sizeof(SuggestionEntry),
+          suggestion_entry_compare);
+
+    array_create(&snapshot->nodes, snapshot->entry_count * 2 + 1);
+    suggestion_trie_add_node(snapshot, 0, 0, 0);
+    snapshot->nodes.data[0].entry_count = 0;
+    for (u32 i = 0; i < snapshot->entry_count; ++i)
+    {
+        suggestion_trie_insert(snapshot, i);
+    }
+    return snapshot;
+}
+
+void path_suggestion_snapshot_free(PathSuggestionSnapshot* snapshot)
+{
+    if (!snapshot)
+    {
+        return;
+    }
+    for (u32 i = 0; i < snapshot->entry_count; ++i)
+    {
+        free(snapshot->entries[i].key);
+    }
+    for (u32 i = 0; i < snapshot->items.size; ++i)
+    {
+        free(snapshot->items.data[i].path);
+    }
+    free(snapshot->entries);
+    array_free(&snapshot->items);
+    array_free(&snapshot->nodes);
+    free(snapshot);
+}
+
+internal void suggestion_heap_swap(SuggestionScore* first, SuggestionScore* second)
+{
+    const SuggestionScore temp = *first;
+    *first = *second;
+    *second = temp;
+}
+
+internal void suggestion_heap_sift_down(SuggestionScore* heap, const u32 size, u32 index)
+{
+    for (;;)
+    {
+        const u32 left = index * 2 + 1;
+        const u32 right = left + 1;
+        u32 smallest = index;
+        if (left < size && heap[left].score < heap[smallest].score) smallest = left;
+        if (right < size && heap[right].score < heap[smallest].score) smallest = right;
+        if (smallest == index)
+        {
+            return;
+        }
+        suggestion_heap_swap(heap + index, heap + smallest);
+        index = smallest;
+    }
+}
+
+// Min heap holding the best capacity scores seen, the worst of them on top.
+internal void suggestion_heap_push(SuggestionScore* heap, u32* size, const u32 capacity,
+                                   const SuggestionScore value)
+{
+    if (*size < capacity)
+    {
+        u32 index = (*size)++;
+        heap[index] = value;
+        while (index && heap[(index - 1) / 2].score > heap[index].score)
+        {
+            suggestion_heap_swap(heap + index, heap + (index - 1) / 2);
+            index = (index - 1) / 2;
+        }
+    }
+    else if (value.score > heap[0].score)
+    {
+        heap[0] = value;
+        suggestion_heap_sift_down(heap, *size, 0);
+    }
+}
+
+// Fewer skipped characters between the matched ones is better, then an
+// earlier first match. Returns -1 if the characters are not all in the key.
+internal i64 suggestion_fuzzy_score(const SuggestionEntry* entry, const char* query,
+                                    const u32 query_length, const u32 entry_index)
+{
+    i32 first_match = -1;
+    u32 gaps = 0;
+    u32 position = 0;
+    for (u32 i = 0; i < query_length; ++i)
+    {
+        const char* match = memchr(entry->key + position, query[i], entry->key_length - position);
+        if (!match)
+        {
+            return -1;
+        }
+        const u32 match_position = (u32)(match - entry->key);
+        if (first_match < 0)
+        {
+            first_match = (i32)match_position;
+        }
+        else
+        {
+            gaps += match_position - position;
+        }
+        position = match_position + 1;
+    }
+    return ((i64)(0xFFFF - ftic_min(gaps, 0xFFFF)) << 32) |
+           ((i64)(0xFF - ftic_min((u32)first_match, 0xFF)) << 24) |
+           (i64)(0xFFFFFF - ftic_min(entry_index, 0xFFFFFF));
+}
+
+u32 path_suggestion_snapshot_query(const PathSuggestionSnapshot* snapshot, const char* query,
+                                   u32* result, const u32 result_capacity)
+{
+    if (!result_capacity)
+    {
+        return 0;
+    }
+    char lower_query[FTIC_MAX_PATH] = { 0 };
+    u32 query_length = 0;
+    for (; query[query_length] && query_length < FTIC_MAX_PATH - 1; ++query_length)
+    {
+        lower_query[query_length] = (char)tolower((unsigned char)query[query_length]);
+    }
+
+    i32 node_index = 0;
+    for (u32 position = 0; position < query_length;)
+    {
+        i32 child_index = snapshot->nodes.data[node_index].first_child;
+        while (child_index >= 0 &&
+               suggestion_label(snapshot, snapshot->nodes.data + child_index)[0] !=
+                   lower_query[position])
+        {
+            child_index = snapshot->nodes.data[child_index].next_sibling;
+        }
+        if (child_index < 0)
+        {
+            node_index = -1;
+            break;
+        }
+        const SuggestionTrieNode* child = snapshot->nodes.data + child_index;
+        const u32 length = ftic_min(child->label_length, query_length - position);
+        if (memcmp(suggestion_label(snapshot, child), lower_query + position, length))
+        {
+            node_index = -1;
+            break;
+        }
+        position += length;
+        node_index = child_index;
+    }
+
+    SuggestionScore* heap = (SuggestionScore*)calloc(result_capacity, sizeof(SuggestionScore));
+    u32 heap_size = 0;
+    u32 prefix_first = 0;
+    u32 prefix_count = 0;
+    if (node_index >= 0)
+    {
+        prefix_first = snapshot->nodes.data[node_index].first_entry;
+        prefix_count = snapshot->nodes.data[node_index].entry_count;
+        for (u32 i = prefix_first; i < prefix_first + prefix_count; ++i)
+        {
+            // Shorter names are closer to what is typed, with nothing typed
+            // the listing is shown in order.
+            const i64 length_penalty =
+                query_length ? (i64)snapshot->entries[i].key_length << 24 : 0;
+            const SuggestionScore value = {
+                .score = SUGGESTION_PREFIX_SCORE - length_penalty - (i64)i,
+                .entry = i,
+            };
+            suggestion_heap_push(heap, &heap_size, result_capacity, value);
+        }
+    }
+    if (query_length && prefix_count < result_capacity)
+    {
+        for (u32 i = 0; i < snapshot->entry_count; ++i)
+        {
+            if (i >= prefix_first && i < prefix_first + prefix_count)
+            {
+                continue;
+            }
+            const i64 score =
+                suggestion_fuzzy_score(snapshot->entries + i, lower_query, query_length, i);
+            if (score >= 0)
+            {
+                suggestion_heap_push(heap, &heap_size, result_capacity,
+                                     (SuggestionScore){ .score = score, .entry = i });
+            }
+        }
+    }
+
+    const u32 count = heap_size;
+    while (heap_size)
+    {
+        result[heap_size - 1] = snapshot->entries[heap[0].entry].item_index;
+        heap[0] = heap[--heap_size];
+        suggestion_heap_sift_down(heap, heap_size, 0);
+    }
+    free(heap);
+    return count;
+}
+
+internal PathSuggestionCacheEntry* path_suggestion_find(PathSuggestionService* service,
+                                                        const u64 key, const char* directory,
+                                                        const u32 directory_length)
+{
+    for (u32 i = 0; i < PATH_SUGGESTION_CACHE_SIZE; ++i)
+    {
+        PathSuggestionCacheEntry* entry = service->entries + i;
+        if (entry->directory && entry->key == key &&
+            strlen(entry->directory) == directory_length &&
+            memcmp(entry->directory, directory, directory_length) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+internal THREAD_TASK_ENTRY_POINT(path_suggestion_load)
+{
+    PathSuggestionLoad* load = (PathSuggestionLoad*)data;
+    PathSuggestionService* service = load->service;
+
+    DirectoryItemArray items = { 0 };
+    if (platform_directory_exists(load->directory))
+    {
+        // The listing takes the search pattern, like the directory pages.
+        char* pattern = string_copy(load->directory, load->directory_length, 3);
+        pattern[load->directory_length] = '\\';
+        pattern[load->directory_length + 1] = '*';
+        Directory directory = platform_get_directory(pattern, load->directory_length + 2, false);
+        items = directory.items;
+        free(directory.parent);
+        free(pattern);
+    }
+    PathSuggestionSnapshot* snapshot = path_suggestion_snapshot_create(&items);
+
+    platform_mutex_lock(&service->mutex);
+    PathSuggestionCacheEntry* entry =
+        path_suggestion_find(service, load->key, load->directory, load->directory_length);
+    if (entry)
+    {
+        PathSuggestionSnapshot* old_snapshot = entry->snapshot;
+        entry->snapshot = snapshot;
+        entry->loading = false;
+        snapshot = old_snapshot;
+    }
+    platform_mutex_unlock(&service->mutex);
+
+    path_suggestion_snapshot_free(snapshot);
+    ftic_atomic_add(&service->generation, 1);
+    ftic_atomic_add(&service->pending, -1);
+    free(load->directory);
+    free(load);
+}
+
+void path_suggestion_service_create(ThreadTaskQueue* task_queue, PathSuggestionService* service)
+{
+    *service = (PathSuggestionService){ 0 };
+    service->task_queue = task_queue;
+    service->mutex = platform_mutex_create();
+}
+
+void path_suggestion_service_destroy(PathSuggestionService* service)
+{
+    while (ftic_atomic_load(&service->pending))
+    {
+        platform_sleep(1);
+    }
+    for (u32 i = 0; i < PATH_SUGGESTION_CACHE_SIZE; ++i)
+    {
+        path_suggestion_snapshot_free(service->entries[i].snapshot);
+        free(service->entries[i].directory);
+    }
+    platform_mutex_destroy(&service->mutex);
+}
+
+b8 path_suggestion_service_query(PathSuggestionService* service, const char* directory,
+                                 const u32 directory_length, const char* query,
+                                 DirectoryItemArray* result, const u32 count)
+{
+    if (directory_length == 0 || directory_length >= FTIC_MAX_PATH)
+    {
+        return false;
+    }
+    const u64 key = hash_murmur(&directory, directory_length, 0);
+    const f64 now = platform_get_time();
+
+    platform_mutex_lock(&service->mutex);
+    PathSuggestionCacheEntry* entry =
+        path_suggestion_find(service, key, directory, directory_length);
+    if (!entry)
+    {
+        // Replace the least recently used listing, one that is still being
+        // loaded is left alone so the load has somewhere to go.
+        for (u32 i = 0; i < PATH_SUGGESTION_CACHE_SIZE; ++i)
+        {
+            PathSuggestionCacheEntry* candidate = service->entries + i;
+            if (!candidate->loading && (!entry || candidate->used_time < entry->used_time))
+            {
+                entry = candidate;
+            }
+        }
+        if (!entry)
+        {
+            platform_mutex_unlock(&service->mutex);
+            return false;
+        }
+        path_suggestion_snapshot_free(entry->snapshot);
+        free(entry->directory);
+        *entry = (PathSuggestionCacheEntry){
+            .key = key,
+            .directory = string_copy(directory, directory_length, 0),
+        };
+    }
+    entry->used_time = now;
+
+    if (!entry->loading &&
+        (!entry->snapshot || now - entry->snapshot->created_time > PATH_SUGGESTION_MAX_AGE))
+    {
+        entry->loading = true;
+        ftic_atomic_add(&service->pending, 1);
+        PathSuggestionLoad* load = (PathSuggestionLoad*)calloc(1, sizeof(PathSuggestionLoad));
+        load->service = service;
+        load->key = key;
+        load->directory = string_copy(directory, directory_length, 0);
+        load->directory_length = directory_length;
+        ThreadTask task = thread_task(path_suggestion_load, load);
+        thread_tasks_push(service->task_queue, &task, 1, NULL);
+    }
+
+    const PathSuggestionSnapshot* snapshot = entry->snapshot;
+    if (snapshot)
+    {
+        u32* indices = (u32*)calloc(ftic_max(count, 1), sizeof(u32));
+        const u32 found = path_suggestion_snapshot_query(snapshot, query, indices, count);
+        for (u32 i = 0; i < found; ++i)
+        {
+            DirectoryItem item = snapshot->items.data[indices[i]];
+            item.path = string_copy_d(item.path);
+            array_push(result, item);
+        }
+        free(indices);
+    }
+    platform_mutex_unlock(&service->mutex);
+    return snapshot != NULL;
+}
+
+long path_suggestion_service_generation(PathSuggestionService* service)
+{
+    return ftic_atomic_load(&service->generation);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "define.h"
+#include "thread_queue.h"
+#include "platform/platform.h"
+
+// Directories whose children are kept for the address bar suggestions.
+#define PATH_SUGGESTION_CACHE_SIZE 8
+// A cached listing older than this is still answered from, but refreshed
+// in the background.
+#define PATH_SUGGESTION_MAX_AGE 2.0
+
+// Children of one directory in a compressed trie over their lower case
+// names. The entries are sorted, so every node covers a contiguous range
+// of them and a prefix query only has to find the node.
+typedef struct SuggestionTrieNode
+{
+    u32 label_offset; // Into the key of entry first_entry
+    u32 label_length;
+    i32 first_child;
+    i32 last_child;
+    i32 next_sibling;
+    u32 first_entry;
+    u32 entry_count;
+} SuggestionTrieNode;
+
+typedef struct SuggestionTrieNodeArray
+{
+    u32 size;
+    u32 capacity;
+    SuggestionTrieNode* data;
+} SuggestionTrieNodeArray;
+
+typedef struct SuggestionEntry
+{
+    char* key; // Lower case name
+    u32 key_length;
+    u32 item_index;
+} SuggestionEntry;
+
+typedef struct PathSuggestionSnapshot
+{
+    DirectoryItemArray items;
+    SuggestionEntry* entries;
+    u32 entry_count;
+    SuggestionTrieNodeArray nodes;
+    f64 created_time;
+} PathSuggestionSnapshot;
+
+typedef struct PathSuggestionCacheEntry
+{
+    u64 key;
+    char* directory;
+    PathSuggestionSnapshot* snapshot;
+    f64 used_time;
+    b8 loading;
+} PathSuggestionCacheEntry;
+
+typedef struct PathSuggestionService
+{
+    ThreadTaskQueue* task_queue;
+    FTicMutex mutex;
+    PathSuggestionCacheEntry entries[PATH_SUGGESTION_CACHE_SIZE];
+    FTicAtomic generation;
+    FTicAtomic pending;
+} PathSuggestionService;
+
+// Takes ownership of the items.
+PathSuggestionSnapshot* path_suggestion_snapshot_create(DirectoryItemArray* items);
+void path_suggestion_snapshot_free(PathSuggestionSnapshot* snapshot);
+// Writes the indices of the best matches into result, best first. Names
+// starting with query come before names only containing its characters in
+// order.
+u32 path_suggestion_snapshot_query(const PathSuggestionSnapshot* snapshot, const char* query,
+                                   u32* result, const u32 result_capacity);
+
+void path_suggestion_service_create(ThreadTaskQueue* task_queue, PathSuggestionService* service);
+void path_suggestion_service_destroy(PathSuggestionService* service);
+// Never touches the disk, a directory that is not cached yet is listed on
+// the thread pool and answers empty until then. The generation changes when
+// a listing has been loaded, query again to pick it up. Returns false if
+// the directory has not been loaded.
+b8 path_suggestion_service_query(PathSuggestionService* service, const char* directory,
+                                 const u32 directory_length, const char* query,
+                                 DirectoryItemArray* result, const u32 count);
+long path_suggestion_service_generation(PathSuggestionService* service);
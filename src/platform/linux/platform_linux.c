@@ -0,0 +1,1043 @@
+// The headless part of the platform layer: directories, files, threads and
+// time. Window, OpenGL context, clipboard and shell integration only exist on
+// Windows so far, this is enough for the benchmarks to run on Linux.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "platform/platform.h"
+#include "logging.h"
+#include "texture.h"
+#include "hash.h"
+#include "profiler.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <linux/fs.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Seconds between 1601 and 1970. Write times are stored in 100 ns ticks from
+// 1601 like a Windows FILETIME so both platforms sort the same way.
+#define UNIX_EPOCH_IN_FILETIME_SECONDS 11644473600ULL
+// Bytes handed to the kernel per call when copying, progress is reported in
+// between.
+#define COPY_CHUNK_SIZE (8ULL * 1024 * 1024)
+
+global b8 g_show_hidden_files = true;
+global b8 g_filter = false;
+global b8 g_folder_filter = true;
+global HashTableCharU32 g_filter_options = { 0 };
+global char g_executable_dir[FTIC_MAX_PATH] = { 0 };
+global u32 g_executable_dir_length = 0;
+
+typedef struct LinuxThread
+{
+    pthread_t thread;
+    void* data;
+    thread_return_value (*thread_function)(void* data);
+} LinuxThread;
+
+char* item_name(DirectoryItem* item)
+{
+    return item->path + item->name_offset;
+}
+
+const char* item_namec(const DirectoryItem* item)
+{
+    return item->path + item->name_offset;
+}
+
+void platform_set_executable_directory()
+{
+    const ssize_t size = readlink("/proc/self/exe", g_executable_dir, sizeof(g_executable_dir) - 1);
+    for (i32 i = (i32)size; i >= 0; --i)
+    {
+        if (g_executable_dir[i] == '/')
+        {
+            g_executable_dir[i + 1] = '\0';
+            g_executable_dir_length = i + 1;
+            break;
+        }
+    }
+}
+
+const char* platform_get_executable_directory()
+{
+    return g_executable_dir;
+}
+
+u32 platform_get_executable_directory_length()
+{
+    return g_executable_dir_length;
+}
+
+i32 platform_time_compare(const PlatformTime* first, const PlatformTime* second)
+{
+    if (first->year != second->year) return first->year - second->year;
+    if (first->month != second->month) return first->month - second->month;
+    if (first->day != second->day) return first->day - second->day;
+    if (first->hour != second->hour) return first->hour - second->hour;
+    if (first->minute != second->minute) return first->minute - second->minute;
+    if (first->second != second->second) return first->second - second->second;
+    return first->milliseconds - second->milliseconds;
+}
+
+char* platform_get_last_error()
+{
+    if (!errno) return "";
+
+    const char* message = strerror(errno);
+    return string_copy(message, (u32)strlen(message), 0);
+}
+
+void platform_print_string(const char* string)
+{
+    fputs(string, stderr);
+}
+
+void platform_local_free(void* memory)
+{
+    free(memory);
+}
+
+b8 platform_directory_exists(const char* directory_path)
+{
+    struct stat info;
+    return stat(directory_path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+b8 platform_is_link(const char* path)
+{
+    struct stat info;
+    return lstat(path, &info) == 0 && S_ISLNK(info.st_mode);
+}
+
+b8 platform_map_file(const char* path, PlatformFileMapping* mapping)
+{
+    *mapping = (PlatformFileMapping){ 0 };
+    const int file = open(path, O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    b8 result = fstat(file, &info) == 0 && S_ISREG(info.st_mode);
+    if (result && info.st_size > 0)
+    {
+        void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        result = data != MAP_FAILED;
+        if (result)
+        {
+            madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+            mapping->data = (const u8*)data;
+            mapping->size = (u64)info.st_size;
+        }
+    }
+    close(file);
+    return result;
+}
+
+void platform_unmap_file(PlatformFileMapping* mapping)
+{
+    if (mapping->data)
+    {
+        munmap((void*)mapping->data, (size_t)mapping->size);
+    }
+    *mapping = (PlatformFileMapping){ 0 };
+}
+
+// Device and inode identify a file for as long as it exists, which is what
+// the object id is used for on Windows.
+internal FticGUID id_from_stat(const struct stat* info)
+{
+    u8 bytes[16] = { 0 };
+    const u64 device = (u64)info->st_dev;
+    const u64 inode = (u64)info->st_ino;
+    memcpy(bytes, &device, sizeof(device));
+    memcpy(bytes + sizeof(device), &inode, sizeof(inode));
+    return guid_copy_bytes(bytes);
+}
+
+b8 platform_get_id_from_path(const char* path, FticGUID* id)
+{
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return false;
+    }
+    *id = id_from_stat(&info);
+    return true;
+}
+
+internal u64 write_time_from_stat(const struct stat* info)
+{
+    return ((u64)info->st_mtim.tv_sec + UNIX_EPOCH_IN_FILETIME_SECONDS) * 10000000ULL +
+           (u64)info->st_mtim.tv_nsec / 100;
+}
+
+internal void insert_directory_item(const u32 directory_len, const struct stat* info,
+                                    const DirectoryItemType type, char* path,
+                                    DirectoryItemArray* items)
+{
+    DirectoryItem item = {
+        .id = id_from_stat(info),
+        .size = type == FOLDER_DEFAULT ? 0 : (u64)info->st_size,
+        .last_write_time = write_time_from_stat(info),
+        .path = path,
+        .name_offset = (u16)(directory_len - 1),
+        .type = type,
+    };
+    array_push(items, item);
+}
+
+void platform_show_hidden_files(b8 show)
+{
+    g_show_hidden_files = show;
+}
+
+void platform_set_filter(b8 on)
+{
+    g_filter = on;
+}
+
+void platform_initialize_filter()
+{
+    g_filter_options = hash_table_create_char_u32(100, hash_murmur);
+}
+
+void platform_insert_filter_value(char* value, b8 selected)
+{
+    hash_table_insert_char_u32(&g_filter_options, value, selected);
+}
+
+void platform_set_filter_on(const char* value, b8 selected)
+{
+    u32* val = hash_table_get_char_u32(&g_filter_options, value);
+    if (val)
+    {
+        *val = selected;
+    }
+}
+
+void platform_set_folder_filter(b8 on)
+{
+    g_folder_filter = on;
+}
+
+internal DirectoryItemType get_file_type_based_on_extension(const char* name, const u32 name_length,
+                                                            u32* include)
+{
+    DirectoryItemType result = FILE_DEFAULT;
+    const char* extension = file_get_extension(name, name_length);
+    if (extension)
+    {
+        if (strcmp(extension, "png") == 0)
+        {
+            result = FILE_PNG;
+        }
+        else if (strcmp(extension, "jpg") == 0)
+        {
+            result = FILE_JPG;
+        }
+        else if (strcmp(extension, "pdf") == 0)
+        {
+            result = FILE_PDF;
+        }
+        else if (strcmp(extension, "cpp") == 0)
+        {
+            result = FILE_CPP;
+        }
+        else if (strcmp(extension, "c") == 0 || strcmp(extension, "h") == 0)
+        {
+            result = FILE_C;
+        }
+        else if (strcmp(extension, "java") == 0)
+        {
+            result = FILE_JAVA;
+        }
+        else if (strcmp(extension, "obj") == 0)
+        {
+            result = FILE_OBJ;
+        }
+        if (g_filter)
+        {
+            u32* exist = hash_table_get_char_u32(&g_filter_options, extension);
+            *include = exist != NULL ? *exist : true;
+        }
+    }
+    return result;
+}
+
+// directory_path has the same "<dir>\*" form as on Windows, the last two
+// characters are dropped and the items are joined with '/'.
+void platform_get_directory_chunked(const char* directory_path, const u32 directory_len,
+                                    b8 get_files, const u32 chunk_size,
+                                    PlatformDirectoryChunkCallback callback, void* data)
+{
+    PROFILE_FUNCTION_BEGIN();
+    DirectoryItemArray chunk = { 0 };
+    array_create(&chunk, chunk_size);
+
+    char* parent = (char*)calloc(directory_len + 1, sizeof(char));
+    memcpy(parent, directory_path, directory_len - 2);
+
+    b8 keep_going = true;
+    DIR* dir = opendir(parent);
+    if (dir)
+    {
+        const int dir_fd = dirfd(dir);
+        struct dirent* entry = NULL;
+        while (keep_going && (entry = readdir(dir)))
+        {
+            if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            {
+                continue;
+            }
+            if (!g_show_hidden_files && entry->d_name[0] == '.')
+            {
+                continue;
+            }
+            struct stat info;
+            if (fstatat(dir_fd, entry->d_name, &info, 0) != 0)
+            {
+                continue;
+            }
+
+            const u32 name_length = (u32)strlen(entry->d_name);
+            if (S_ISDIR(info.st_mode))
+            {
+                if (g_folder_filter || !g_filter)
+                {
+                    char* path = concatinate(directory_path, directory_len - 2, entry->d_name,
+                                             name_length, '/', 2, NULL);
+                    insert_directory_item(directory_len, &info, FOLDER_DEFAULT, path, &chunk);
+                }
+            }
+            else if (get_files && S_ISREG(info.st_mode))
+            {
+                u32 include = true;
+                DirectoryItemType type =
+                    get_file_type_based_on_extension(entry->d_name, name_length, &include);
+
+                if (include)
+                {
+                    char* path = concatinate(directory_path, directory_len - 2, entry->d_name,
+                                             name_length, '/', 2, NULL);
+                    insert_directory_item(directory_len, &info, type, path, &chunk);
+                }
+            }
+
+            if (chunk.size >= chunk_size)
+            {
+                keep_going = callback(&chunk, data);
+                chunk.size = 0;
+            }
+        }
+        closedir(dir);
+    }
+    if (keep_going && chunk.size)
+    {
+        callback(&chunk, data);
+    }
+    free(parent);
+    array_free(&chunk);
+    PROFILE_END();
+}
+
+typedef struct ListedItems
+{
+    DirectoryItemArray folders;
+    DirectoryItemArray files;
+} ListedItems;
+
+internal b8 listed_items_add_chunk(DirectoryItemArray* chunk, void* data)
+{
+    ListedItems* listed = (ListedItems*)data;
+    for (u32 i = 0; i < chunk->size; ++i)
+    {
+        DirectoryItem* item = chunk->data + i;
+        array_push(item->type == FOLDER_DEFAULT ? &listed->folders : &listed->files, *item);
+    }
+    return true;
+}
+
+Directory platform_get_directory(const char* directory_path, const u32 directory_len, b8 get_files)
+{
+    PROFILE_FUNCTION_BEGIN();
+    ListedItems listed = { 0 };
+    array_create(&listed.folders, 10);
+    array_create(&listed.files, 10);
+    platform_get_directory_chunked(directory_path, directory_len, get_files,
+                                   PLATFORM_DIRECTORY_CHUNK_SIZE, listed_items_add_chunk,
+                                   &listed);
+
+    Directory directory = { 0 };
+    directory.parent = (char*)calloc(directory_len + 1, sizeof(char));
+    memcpy(directory.parent, directory_path, directory_len - 2);
+    platform_get_id_from_path(directory.parent, &directory.parent_id);
+
+    array_create(&directory.items, listed.folders.size + listed.files.size);
+    for (u32 i = 0; i < listed.folders.size; ++i)
+    {
+        array_push(&directory.items, listed.folders.data[i]);
+    }
+    for (u32 i = 0; i < listed.files.size; ++i)
+    {
+        array_push(&directory.items, listed.files.data[i]);
+    }
+    array_free(&listed.folders);
+    array_free(&listed.files);
+    PROFILE_END();
+    return directory;
+}
+
+void platform_reset_directory(Directory* directory, b8 delete_textures)
+{
+    for (u32 i = 0; i < directory->items.size; ++i)
+    {
+        DirectoryItem* item = directory->items.data + i;
+        free(item->path);
+        if (delete_textures && item->texture_id)
+        {
+            texture_delete(item->texture_id);
+        }
+    }
+    array_free(&directory->items);
+    free(directory->parent);
+    directory->items = (DirectoryItemArray){ 0 };
+}
+
+FTicMutex platform_mutex_create(void)
+{
+    pthread_mutex_t* mutex = (pthread_mutex_t*)calloc(1, sizeof(pthread_mutex_t));
+    pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+void platform_mutex_lock(FTicMutex* mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t*)*mutex);
+}
+
+void platform_mutex_unlock(FTicMutex* mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t*)*mutex);
+}
+
+void platform_mutex_destroy(FTicMutex* mutex)
+{
+    pthread_mutex_destroy((pthread_mutex_t*)*mutex);
+    free(*mutex);
+}
+
+// max_count is not enforced, nothing releases more than it waits for.
+FTicSemaphore platform_semaphore_create(i32 initial_count, i32 max_count)
+{
+    sem_t* sem = (sem_t*)calloc(1, sizeof(sem_t));
+    sem_init(sem, 0, (unsigned int)initial_count);
+    return sem;
+}
+
+void platform_semaphore_increment(FTicSemaphore* sem, long* previous_count)
+{
+    if (previous_count)
+    {
+        int value = 0;
+        sem_getvalue((sem_t*)*sem, &value);
+        *previous_count = value;
+    }
+    sem_post((sem_t*)*sem);
+}
+
+void platform_semaphore_wait_and_decrement(FTicSemaphore* sem)
+{
+    while (sem_wait((sem_t*)*sem) != 0 && errno == EINTR)
+    {
+    }
+}
+
+void platform_semaphore_destroy(FTicSemaphore* sem)
+{
+    sem_destroy((sem_t*)*sem);
+    free(*sem);
+}
+
+internal void* thread_start(void* data)
+{
+    LinuxThread* thread = (LinuxThread*)data;
+    thread->thread_function(thread->data);
+    return NULL;
+}
+
+// creation_flag is ignored, the thread starts right away.
+FTicThreadHandle platform_thread_create(void* data,
+                                        thread_return_value (*thread_function)(void* data),
+                                        unsigned long creation_flag, unsigned long* thread_id)
+{
+    LinuxThread* thread = (LinuxThread*)calloc(1, sizeof(LinuxThread));
+    thread->data = data;
+    thread->thread_function = thread_function;
+    if (pthread_create(&thread->thread, NULL, thread_start, thread) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+    if (thread_id)
+    {
+        *thread_id = (unsigned long)thread->thread;
+    }
+    return thread;
+}
+
+void platform_thread_join(FTicThreadHandle handle)
+{
+    pthread_join(((LinuxThread*)handle)->thread, NULL);
+}
+
+// Only valid after the thread has been joined.
+void platform_thread_close(FTicThreadHandle handle)
+{
+    free(handle);
+}
+
+void platform_thread_terminate(FTicThreadHandle handle)
+{
+    pthread_cancel(((LinuxThread*)handle)->thread);
+}
+
+void platform_futex_wait(FTicAtomic32* address, u32 expected)
+{
+    syscall(SYS_futex, (u32*)address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void platform_futex_wake_one(FTicAtomic32* address)
+{
+    syscall(SYS_futex, (u32*)address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void platform_futex_wake_all(FTicAtomic32* address)
+{
+    syscall(SYS_futex, (u32*)address, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+u32 platform_get_core_count(void)
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+f64 platform_get_time(void)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec + (now.tv_nsec * 0.000000001);
+}
+
+void platform_sleep(u64 milli)
+{
+    struct timespec duration = {
+        .tv_sec = (time_t)(milli / 1000),
+        .tv_nsec = (long)((milli % 1000) * 1000000),
+    };
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR)
+    {
+    }
+}
+
+b8 platform_copy_file(const char* source, const char* destination, b8 unbuffered,
+                      PlatformCopyProgressCallback callback, void* data)
+{
+    const int source_file = open(source, O_RDONLY | O_CLOEXEC);
+    if (source_file < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(source_file, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(source_file);
+        return false;
+    }
+    const int destination_file =
+        open(destination, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 07777);
+    if (destination_file < 0)
+    {
+        close(source_file);
+        return false;
+    }
+
+    const u64 size = (u64)info.st_size;
+    b8 result = true;
+    if (ioctl(destination_file, FICLONE, source_file) == 0)
+    {
+        // Btrfs and XFS share the blocks, nothing is copied.
+        result = !callback || callback(size, data);
+    }
+    else
+    {
+        if (unbuffered)
+        {
+            posix_fadvise(source_file, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+        // copy_file_range stays in the kernel and copies server side on NFS
+        // and SMB, sendfile is the fallback across file systems on older
+        // kernels.
+        b8 copy_range = true;
+        u64 copied = 0;
+        while (result && copied < size)
+        {
+            const size_t chunk = (size_t)ftic_min(size - copied, COPY_CHUNK_SIZE);
+            ssize_t written = 0;
+            if (copy_range)
+            {
+                written = copy_file_range(source_file, NULL, destination_file, NULL, chunk, 0);
+                if (written < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+                                    errno == EOPNOTSUPP))
+                {
+                    copy_range = false;
+                    continue;
+                }
+            }
+            else
+            {
+                written = sendfile(destination_file, source_file, NULL, chunk);
+            }
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                // Zero if the source got shorter since it was opened.
+                result = written == 0;
+                break;
+            }
+            copied += (u64)written;
+            result = !callback || callback((u64)written, data);
+        }
+        if (unbuffered)
+        {
+            // Like unbuffered IO on Windows, a huge copy should not push
+            // everything else out of the page cache.
+            posix_fadvise(source_file, 0, 0, POSIX_FADV_DONTNEED);
+        }
+    }
+    close(source_file);
+    if (close(destination_file) != 0)
+    {
+        result = false;
+    }
+    if (!result)
+    {
+        unlink(destination);
+    }
+    return result;
+}
+
+// Same volume moves only, a move across volumes is copied and deleted by the
+// file operations instead.
+void platform_move_to_directory(const CharPtrArray* paths, const char* directory_path)
+{
+    const u32 directory_length = (u32)strlen(directory_path);
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        const char* path = paths->data[i];
+        const u32 path_length = (u32)strlen(path);
+        const u32 name_offset = get_path_length(path, path_length);
+        char* destination = concatinate(directory_path, directory_length, path + name_offset,
+                                        path_length - name_offset, '/', 0, NULL);
+        if (!platform_path_exists(destination))
+        {
+            rename(path, destination);
+        }
+        free(destination);
+    }
+}
+
+// Percent encodes everything but unreserved characters and '/', as the
+// Path key of a .trashinfo file wants it.
+internal void trash_encode_path(const char* path, char* out, const u32 out_size)
+{
+    const char* hex = "0123456789ABCDEF";
+    u32 length = 0;
+    for (const u8* at = (const u8*)path; *at && length + 4 < out_size; ++at)
+    {
+        const u8 character = *at;
+        if ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+            (character >= '0' && character <= '9') || strchr("/-_.~", character))
+        {
+            out[length++] = (char)character;
+        }
+        else
+        {
+            out[length++] = '%';
+            out[length++] = hex[character >> 4];
+            out[length++] = hex[character & 0xF];
+        }
+    }
+    out[length] = '\0';
+}
+
+// Moves the paths to the home trash of the freedesktop.org trash
+// specification, which is where file managers on Linux look for them. Paths
+// on another file system than the home folder are left where they are.
+void platform_delete_files(const CharPtrArray* paths)
+{
+    char trash[PATH_MAX] = { 0 };
+    const char* data_home = getenv("XDG_DATA_HOME");
+    const char* home = getenv("HOME");
+    if (data_home && data_home[0])
+    {
+        snprintf(trash, sizeof(trash), "%s/Trash", data_home);
+    }
+    else if (home && home[0])
+    {
+        snprintf(trash, sizeof(trash), "%s/.local/share/Trash", home);
+    }
+    else
+    {
+        return;
+    }
+    char files[PATH_MAX + 8] = { 0 };
+    char info[PATH_MAX + 8] = { 0 };
+    snprintf(files, sizeof(files), "%s/files", trash);
+    snprintf(info, sizeof(info), "%s/info", trash);
+    if (home && home[0] && !data_home)
+    {
+        char local[PATH_MAX] = { 0 };
+        snprintf(local, sizeof(local), "%s/.local", home);
+        mkdir(local, 0700);
+        snprintf(local, sizeof(local), "%s/.local/share", home);
+        mkdir(local, 0700);
+    }
+    mkdir(trash, 0700);
+    mkdir(files, 0700);
+    mkdir(info, 0700);
+
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        char absolute[PATH_MAX] = { 0 };
+        if (!realpath(paths->data[i], absolute))
+        {
+            continue;
+        }
+        const char* name = strrchr(absolute, '/');
+        name = name && name[1] ? name + 1 : absolute;
+
+        // The info file is created first and exclusively, it reserves the
+        // name in the trash.
+        char info_path[PATH_MAX * 2] = { 0 };
+        char trashed_path[PATH_MAX * 2] = { 0 };
+        int info_file = -1;
+        for (u32 attempt = 1; info_file < 0 && attempt < 10000; ++attempt)
+        {
+            if (attempt == 1)
+            {
+                snprintf(info_path, sizeof(info_path), "%s/%s.trashinfo", info, name);
+                snprintf(trashed_path, sizeof(trashed_path), "%s/%s", files, name);
+            }
+            else
+            {
+                snprintf(info_path, sizeof(info_path), "%s/%s.%u.trashinfo", info, name, attempt);
+                snprintf(trashed_path, sizeof(trashed_path), "%s/%s.%u", files, name, attempt);
+            }
+            info_file = open(info_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (info_file < 0 && errno != EEXIST)
+            {
+                break;
+            }
+        }
+        if (info_file < 0)
+        {
+            continue;
+        }
+
+        char encoded[PATH_MAX * 3] = { 0 };
+        trash_encode_path(absolute, encoded, sizeof(encoded));
+        char date[32] = { 0 };
+        const time_t now = time(NULL);
+        struct tm local_time;
+        localtime_r(&now, &local_time);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local_time);
+        char content[PATH_MAX * 3 + 96] = { 0 };
+        const int content_length =
+            snprintf(content, sizeof(content), "[Trash Info]\nPath=%s\nDeletionDate=%s\n",
+                     encoded, date);
+        const b8 written = content_length > 0 &&
+                           write(info_file, content, (size_t)content_length) == content_length;
+        close(info_file);
+        if (!written || rename(absolute, trashed_path) != 0)
+        {
+            unlink(info_path);
+        }
+    }
+}
+
+void platform_delete_directory_files(const char* directory_path, CharPtrArray* folders,
+                                     PlatformDeleteProgressCallback callback, void* data)
+{
+    const int directory = open(directory_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory < 0)
+    {
+        return;
+    }
+    DIR* dir = fdopendir(directory);
+    if (!dir)
+    {
+        close(directory);
+        return;
+    }
+    const u32 directory_length = (u32)strlen(directory_path);
+    u32 deleted = 0;
+    u32 failed = 0;
+    b8 keep_going = true;
+    struct dirent* entry = NULL;
+    while (keep_going && (entry = readdir(dir)))
+    {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+        {
+            continue;
+        }
+        b8 is_directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            struct stat info;
+            is_directory = fstatat(directory, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) == 0 &&
+                           S_ISDIR(info.st_mode);
+        }
+        if (is_directory)
+        {
+            array_push(folders, concatinate(directory_path, directory_length, entry->d_name,
+                                            strlen(entry->d_name), '/', 0, NULL));
+            continue;
+        }
+        // Relative to the open folder, the path is not looked up again for
+        // every file.
+        if (unlinkat(directory, entry->d_name, 0) == 0)
+        {
+            ++deleted;
+        }
+        else
+        {
+            ++failed;
+        }
+        if (callback && deleted + failed >= PLATFORM_DELETE_PROGRESS_STEP)
+        {
+            keep_going = callback(deleted, failed, data);
+            deleted = 0;
+            failed = 0;
+        }
+    }
+    closedir(dir);
+    if (callback && (deleted || failed))
+    {
+        callback(deleted, failed, data);
+    }
+}
+
+b8 platform_create_directory(const char* path)
+{
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+b8 platform_remove_directory(const char* path)
+{
+    return rmdir(path) == 0;
+}
+
+b8 platform_remove_link(const char* path)
+{
+    return unlink(path) == 0;
+}
+
+b8 platform_delete_file(const char* path)
+{
+    return unlink(path) == 0;
+}
+
+b8 platform_rename(const char* path, const char* new_path)
+{
+    return rename(path, new_path) == 0;
+}
+
+b8 platform_same_volume(const char* first, const char* second)
+{
+    struct stat first_info;
+    struct stat second_info;
+    if (stat(first, &first_info) != 0 || stat(second, &second_info) != 0)
+    {
+        return false;
+    }
+    return first_info.st_dev == second_info.st_dev;
+}
+
+b8 platform_path_exists(const char* path)
+{
+    struct stat info;
+    return lstat(path, &info) == 0;
+}
+
+u64 platform_get_file_size(const char* path)
+{
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        return 0;
+    }
+    return (u64)info.st_size;
+}
+
+void platform_list_directory_entries(const char* directory_path, PlatformFileEntryArray* entries)
+{
+    DIR* dir = opendir(directory_path);
+    if (!dir)
+    {
+        return;
+    }
+    const u32 directory_length = (u32)strlen(directory_path);
+    const int dir_fd = dirfd(dir);
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir)))
+    {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+        {
+            continue;
+        }
+        struct stat info;
+        if (fstatat(dir_fd, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            continue;
+        }
+        PlatformFileEntry file_entry = {
+            .path = concatinate(directory_path, directory_length, entry->d_name,
+                                strlen(entry->d_name), '/', 0, NULL),
+            .size = (u64)info.st_size,
+            .last_write_time = write_time_from_stat(&info),
+            .directory = S_ISDIR(info.st_mode),
+            .link = S_ISLNK(info.st_mode),
+        };
+        array_push(entries, file_entry);
+    }
+    closedir(dir);
+}
+
+#define CHANGE_NOTIFY_MASK                                                                 \
+    (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_CLOSE_WRITE |       \
+     IN_DELETE_SELF | IN_MOVE_SELF)
+
+// The handle is the inotify descriptor plus one, so a failure can be NULL.
+internal void* change_handle_from_fd(int fd)
+{
+    return (void*)(intptr_t)(fd + 1);
+}
+
+void* directory_listen_to_directory_changes(const char* path)
+{
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (inotify_add_watch(fd, path, CHANGE_NOTIFY_MASK) < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    return change_handle_from_fd(fd);
+}
+
+// inotify watches a single directory, every folder in the tree gets a watch.
+// A folder created later is seen as a change in its parent.
+void* directory_listen_to_tree_changes(const char* path)
+{
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (inotify_add_watch(fd, path, CHANGE_NOTIFY_MASK) < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    CharPtrArray stack = { 0 };
+    array_create(&stack, 32);
+    array_push(&stack, string_copy_d(path));
+    PlatformFileEntryArray entries = { 0 };
+    array_create(&entries, 64);
+    while (stack.size)
+    {
+        char* directory = stack.data[--stack.size];
+        entries.size = 0;
+        platform_list_directory_entries(directory, &entries);
+        free(directory);
+        for (u32 i = 0; i < entries.size; ++i)
+        {
+            PlatformFileEntry* entry = entries.data + i;
+            if (entry->directory && !entry->link &&
+                inotify_add_watch(fd, entry->path, CHANGE_NOTIFY_MASK) >= 0)
+            {
+                array_push(&stack, entry->path);
+            }
+            else
+            {
+                free(entry->path);
+            }
+        }
+    }
+    free(stack.data);
+    free(entries.data);
+    return change_handle_from_fd(fd);
+}
+
+void directory_unlisten_to_directory_changes(void* handle)
+{
+    close((int)(intptr_t)handle - 1);
+}
+
+b8 directory_look_for_directory_change(void* handle)
+{
+    const int fd = (int)(intptr_t)handle - 1;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    b8 changed = false;
+    while (read(fd, buffer, sizeof(buffer)) > 0)
+    {
+        changed = true;
+    }
+    return changed;
+}
+
+PlatformTime platform_time_from_u64(u64 time)
+{
+    const u64 ticks_per_second = 10000000ULL;
+    const time_t seconds =
+        (time_t)(time / ticks_per_second) - (time_t)UNIX_EPOCH_IN_FILETIME_SECONDS;
+    struct tm tm = { 0 };
+    gmtime_r(&seconds, &tm);
+
+    PlatformTime result = {
+        .year = (u16)(tm.tm_year + 1900),
+        .month = (u16)(tm.tm_mon + 1),
+        .dayOfWeek = (u16)tm.tm_wday,
+        .day = (u16)tm.tm_mday,
+        .hour = (u16)tm.tm_hour,
+        .minute = (u16)tm.tm_min,
+        .second = (u16)tm.tm_sec,
+        .milliseconds = (u16)((time % ticks_per_second) / 10000),
+    };
+    return result;
+}
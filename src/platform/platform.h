@@ -2,6 +2,7 @@
 #include "define.h"
 #include "util.h"
 #include "ftic_guid.h"
+#include "ftic_atomic.h"
 
 typedef enum DirectoryItemType
 {
@@ -118,6 +119,51 @@ typedef struct DirectoryChangeData
     b8 changed;
 }DirectoryChangeData;
 
+typedef struct PlatformFileEntry
+{
+    char* path;
+    u64 size;
+    u64 last_write_time;
+    b8 directory;
+    b8 link; // Junction or symbolic link, walking into it can loop
+} PlatformFileEntry;
+
+typedef struct PlatformFileEntryArray
+{
+    u32 size;
+    u32 capacity;
+    PlatformFileEntry* data;
+} PlatformFileEntryArray;
+
+// Read only view of a whole file. An empty file maps to no data.
+typedef struct PlatformFileMapping
+{
+    const u8* data;
+    u64 size;
+} PlatformFileMapping;
+
+#define PLATFORM_DIRECTORY_CHUNK_SIZE 1024
+
+// What the platform layer puts between the parts of the paths it builds.
+#ifdef LINUX
+#define PLATFORM_PATH_SEPARATOR '/'
+#define PLATFORM_PATH_SEPARATOR_STRING "/"
+#else
+#define PLATFORM_PATH_SEPARATOR '\\'
+#define PLATFORM_PATH_SEPARATOR_STRING "\\"
+#endif
+typedef b8 (*PlatformDirectoryChunkCallback)(DirectoryItemArray* chunk, void* data);
+
+// Called with the number of bytes copied since the last call. Returning false
+// cancels the copy and removes the partial destination.
+typedef b8 (*PlatformCopyProgressCallback)(u64 bytes_copied, void* data);
+
+#define PLATFORM_DELETE_PROGRESS_STEP 64
+// Called every PLATFORM_DELETE_PROGRESS_STEP entries and once at the end,
+// with what was removed and what failed since the last call. Returning false
+// stops the deletion.
+typedef b8 (*PlatformDeleteProgressCallback)(u32 deleted, u32 failed, void* data);
+
 i32 platform_time_compare(const PlatformTime* first, const PlatformTime* second);
 
 void platform_init(const char* title, u16 width, u16 height, Platform** platform);
@@ -155,7 +201,14 @@ void platform_event_set_on_key_stroke(Platform* platform, OnKeyStrokeCallback_ c
 void platform_change_cursor(Platform* platform, u32 cursor_id);
 
 b8 platform_directory_exists(const char* directory_path);
+b8 platform_is_link(const char* path);
+b8 platform_map_file(const char* path, PlatformFileMapping* mapping);
+void platform_unmap_file(PlatformFileMapping* mapping);
 Directory platform_get_directory(const char* directory_path, const u32 directory_len, b8 files);
+// Lists the directory like platform_get_directory but hands the items over
+// chunk_size at a time as they are found, in the order they are found. The
+// callback takes the items out of the chunk and returns false to stop.
+void platform_get_directory_chunked(const char* directory_path, const u32 directory_len, b8 files, const u32 chunk_size, PlatformDirectoryChunkCallback callback, void* data);
 void platform_reset_directory(Directory* directory, b8 delete_textures);
 
 FTicMutex platform_mutex_create(void);
@@ -172,9 +225,10 @@ FTicThreadHandle platform_thread_create(void* data, thread_return_value (*thread
 void platform_thread_join(FTicThreadHandle handle);
 void platform_thread_close(FTicThreadHandle handle);
 void platform_thread_terminate(FTicThreadHandle handle);
-void platform_interlock_exchange(volatile long* target, long value);
-long platform_interlock_compare_exchange(volatile long* dest, long value,
-                                         long compare);
+// Sleeps while *address holds expected, may wake without a wake call.
+void platform_futex_wait(FTicAtomic32* address, u32 expected);
+void platform_futex_wake_one(FTicAtomic32* address);
+void platform_futex_wake_all(FTicAtomic32* address);
 
 u32 platform_get_core_count(void);
 f64 platform_get_time(void);
@@ -187,6 +241,21 @@ void platform_paste_from_clipboard(CharPtrArray* paths);
 void platform_paste_to_directory(const CharPtrArray* paths, const char* directory_path);
 void platform_move_to_directory(const CharPtrArray* paths, const char* directory_path);
 void platform_delete_files(const CharPtrArray* paths);
+b8 platform_copy_file(const char* source, const char* destination, b8 unbuffered, PlatformCopyProgressCallback callback, void* data);
+// Removes everything directly in directory_path that is not a folder, links
+// and junctions to folders included, and appends the paths of the sub folders
+// to folders.
+void platform_delete_directory_files(const char* directory_path, CharPtrArray* folders, PlatformDeleteProgressCallback callback, void* data);
+b8 platform_create_directory(const char* path);
+b8 platform_remove_directory(const char* path);
+// Removes a junction or symbolic link without touching what it points to.
+b8 platform_remove_link(const char* path);
+b8 platform_delete_file(const char* path);
+b8 platform_rename(const char* path, const char* new_path);
+b8 platform_same_volume(const char* first, const char* second);
+b8 platform_path_exists(const char* path);
+u64 platform_get_file_size(const char* path);
+void platform_list_directory_entries(const char* directory_path, PlatformFileEntryArray* entries);
 void platform_rename_file(const char* path, char* new_name, const u32 name_length);
 void platform_show_properties(i32 x, i32 y, const char* file_path);
 
@@ -204,6 +273,8 @@ void platform_open_context(void* window, const char* path);
 void platform_open_background_context(void* window, const char* path);
 
 void* directory_listen_to_directory_changes(const char* path);
+// Like directory_listen_to_directory_changes but for everything below path.
+void* directory_listen_to_tree_changes(const char* path);
 void directory_unlisten_to_directory_changes(void* handle);
 b8 directory_look_for_directory_change(void* handle);
 void platform_show_hidden_files(b8 show);
@@ -3,6 +3,7 @@
 #include "logging.h"
 #include "texture.h"
 #include "hash.h"
+#include "profiler.h"
 
 #include <stdio.h>
 #include <Windows.h>
@@ -549,6 +550,51 @@ b8 platform_directory_exists(const char* directory_path)
             (file_attributes & FILE_ATTRIBUTE_DIRECTORY));
 }
 
+b8 platform_is_link(const char* path)
+{
+    DWORD file_attributes = GetFileAttributes(path);
+    return (file_attributes != INVALID_FILE_ATTRIBUTES &&
+            (file_attributes & FILE_ATTRIBUTE_REPARSE_POINT));
+}
+
+b8 platform_map_file(const char* path, PlatformFileMapping* mapping)
+{
+    *mapping = (PlatformFileMapping){ 0 };
+    HANDLE file = CreateFile(path, GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size = { 0 };
+    b8 result = GetFileSizeEx(file, &size);
+    if (result && size.QuadPart > 0)
+    {
+        // The view keeps the file mapped after both handles are closed.
+        HANDLE file_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        result = file_mapping != NULL;
+        if (result)
+        {
+            mapping->data = (const u8*)MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+            mapping->size = mapping->data ? (u64)size.QuadPart : 0;
+            result = mapping->data != NULL;
+            CloseHandle(file_mapping);
+        }
+    }
+    CloseHandle(file);
+    return result;
+}
+
+void platform_unmap_file(PlatformFileMapping* mapping)
+{
+    if (mapping->data)
+    {
+        UnmapViewOfFile(mapping->data);
+    }
+    *mapping = (PlatformFileMapping){ 0 };
+}
+
 b8 platform_get_id_from_path(const char* path, FticGUID* id)
 {
     b8 result = false;
@@ -669,13 +715,15 @@ internal DirectoryItemType get_file_type_based_on_extension(const char* name, co
     return result;
 }
 
-Directory platform_get_directory(const char* directory_path, const u32 directory_len, b8 get_files)
+void platform_get_directory_chunked(const char* directory_path, const u32 directory_len,
+                                    b8 get_files, const u32 chunk_size,
+                                    PlatformDirectoryChunkCallback callback, void* data)
 {
-    DirectoryItemArray folders = { 0 };
-    DirectoryItemArray files = { 0 };
-    array_create(&folders, 10);
-    array_create(&files, 10);
+    PROFILE_FUNCTION_BEGIN();
+    DirectoryItemArray chunk = { 0 };
+    array_create(&chunk, chunk_size);
 
+    b8 keep_going = true;
     WIN32_FIND_DATA ffd = { 0 };
     HANDLE file_handle = FindFirstFile(directory_path, &ffd);
     if (file_handle != INVALID_HANDLE_VALUE)
@@ -708,7 +756,11 @@ Directory platform_get_directory(const char* directory_path, const u32 directory
                 if (g_folder_filter || !g_filter)
                 {
                     insert_directory_item(directory_len, 0, last_write_time, FOLDER_DEFAULT, path,
-                                          &folders);
+                                          &chunk);
+                }
+                else
+                {
+                    free(path);
                 }
             }
             else if (get_files)
@@ -721,7 +773,11 @@ Directory platform_get_directory(const char* directory_path, const u32 directory
                 {
                     insert_directory_item(directory_len,
                                           (ffd.nFileSizeHigh * (MAXDWORD + 1)) + ffd.nFileSizeLow,
-                                          last_write_time, type, path, &files);
+                                          last_write_time, type, path, &chunk);
+                }
+                else
+                {
+                    free(path);
                 }
             }
             else
@@ -729,25 +785,66 @@ Directory platform_get_directory(const char* directory_path, const u32 directory
                 free(path);
             }
 
-        } while (FindNextFile(file_handle, &ffd));
+            if (chunk.size >= chunk_size)
+            {
+                keep_going = callback(&chunk, data);
+                chunk.size = 0;
+            }
+        } while (keep_going && FindNextFile(file_handle, &ffd));
         FindClose(file_handle);
     }
+    if (keep_going && chunk.size)
+    {
+        callback(&chunk, data);
+    }
+    array_free(&chunk);
+    PROFILE_END();
+}
+
+typedef struct ListedItems
+{
+    DirectoryItemArray folders;
+    DirectoryItemArray files;
+} ListedItems;
+
+internal b8 listed_items_add_chunk(DirectoryItemArray* chunk, void* data)
+{
+    ListedItems* listed = (ListedItems*)data;
+    for (u32 i = 0; i < chunk->size; ++i)
+    {
+        DirectoryItem* item = chunk->data + i;
+        array_push(item->type == FOLDER_DEFAULT ? &listed->folders : &listed->files, *item);
+    }
+    return true;
+}
+
+Directory platform_get_directory(const char* directory_path, const u32 directory_len, b8 get_files)
+{
+    PROFILE_FUNCTION_BEGIN();
+    ListedItems listed = { 0 };
+    array_create(&listed.folders, 10);
+    array_create(&listed.files, 10);
+    platform_get_directory_chunked(directory_path, directory_len, get_files,
+                                   PLATFORM_DIRECTORY_CHUNK_SIZE, listed_items_add_chunk,
+                                   &listed);
+
     Directory directory = { 0 };
     directory.parent = (char*)calloc(directory_len + 1, sizeof(char));
     memcpy(directory.parent, directory_path, directory_len - 2);
     platform_get_id_from_path(directory.parent, &directory.parent_id);
 
-    array_create(&directory.items, folders.size + files.size);
-    for (u32 i = 0; i < folders.size; ++i)
+    array_create(&directory.items, listed.folders.size + listed.files.size);
+    for (u32 i = 0; i < listed.folders.size; ++i)
     {
-        array_push(&directory.items, folders.data[i]);
+        array_push(&directory.items, listed.folders.data[i]);
     }
-    for (u32 i = 0; i < files.size; ++i)
+    for (u32 i = 0; i < listed.files.size; ++i)
     {
-        array_push(&directory.items, files.data[i]);
+        array_push(&directory.items, listed.files.data[i]);
     }
-    array_free(&folders);
-    array_free(&files);
+    array_free(&listed.folders);
+    array_free(&listed.files);
+    PROFILE_END();
     return directory;
 }
 
@@ -829,14 +926,19 @@ void platform_thread_terminate(FTicThreadHandle handle)
     TerminateThread(handle, 0);
 }
 
-void platform_interlock_exchange(volatile long* target, long value)
+void platform_futex_wait(FTicAtomic32* address, u32 expected)
 {
-    InterlockedExchange(target, value);
+    WaitOnAddress(address, &expected, sizeof(expected), INFINITE);
 }
 
-long platform_interlock_compare_exchange(volatile long* dest, long value, long compare)
+void platform_futex_wake_one(FTicAtomic32* address)
 {
-    return InterlockedCompareExchange(dest, value, compare);
+    WakeByAddressSingle((PVOID)address);
+}
+
+void platform_futex_wake_all(FTicAtomic32* address)
+{
+    WakeByAddressAll((PVOID)address);
 }
 
 u32 platform_get_core_count(void)
@@ -1157,18 +1259,29 @@ void platform_move_to_directory(const CharPtrArray* paths, const char* directory
 #if 1
 void platform_delete_files(const CharPtrArray* paths)
 {
+    // One shell call for all of them, pFrom takes a double null terminated
+    // list of paths.
+    size_t total_length = 1;
     for (u32 i = 0; i < paths->size; ++i)
     {
-        const char* path = paths->data[i];
-
-        SHFILEOPSTRUCT file_op = {
-            .wFunc = FO_DELETE,
-            .pFrom = path,
-            .fFlags = FOF_ALLOWUNDO | FOF_NO_UI,
-        };
-
-        int result = SHFileOperation(&file_op);
+        total_length += strlen(paths->data[i]) + 1;
     }
+    char* from = (char*)calloc(total_length, sizeof(char));
+    char* at = from;
+    for (u32 i = 0; i < paths->size; ++i)
+    {
+        const size_t length = strlen(paths->data[i]);
+        memcpy(at, paths->data[i], length);
+        at += length + 1;
+    }
+
+    SHFILEOPSTRUCT file_op = {
+        .wFunc = FO_DELETE,
+        .pFrom = from,
+        .fFlags = FOF_ALLOWUNDO | FOF_NO_UI,
+    };
+    SHFileOperation(&file_op);
+    free(from);
 }
 
 #else
@@ -1197,6 +1310,200 @@ void platform_delete_files(const CharPtrArray* paths)
 }
 #endif
 
+typedef struct CopyProgressData
+{
+    PlatformCopyProgressCallback callback;
+    void* data;
+    u64 last_transferred;
+} CopyProgressData;
+
+internal DWORD CALLBACK copy_file_progress_routine(
+    LARGE_INTEGER TotalFileSize, LARGE_INTEGER TotalBytesTransferred, LARGE_INTEGER StreamSize,
+    LARGE_INTEGER StreamBytesTransferred, DWORD dwStreamNumber, DWORD dwCallbackReason,
+    HANDLE hSourceFile, HANDLE hDestinationFile, LPVOID lpData)
+{
+    CopyProgressData* progress = (CopyProgressData*)lpData;
+    const u64 transferred = (u64)TotalBytesTransferred.QuadPart;
+    const u64 bytes_copied = transferred - progress->last_transferred;
+    progress->last_transferred = transferred;
+    return progress->callback(bytes_copied, progress->data) ? PROGRESS_CONTINUE : PROGRESS_CANCEL;
+}
+
+b8 platform_copy_file(const char* source, const char* destination, b8 unbuffered,
+                      PlatformCopyProgressCallback callback, void* data)
+{
+    // CopyFileEx lets the file system do the copy, which clones blocks on
+    // ReFS and copies server side on network shares.
+    DWORD flags = COPY_FILE_FAIL_IF_EXISTS;
+    if (unbuffered)
+    {
+        flags |= COPY_FILE_NO_BUFFERING;
+    }
+    CopyProgressData progress = { .callback = callback, .data = data };
+    return CopyFileExA(source, destination, callback ? copy_file_progress_routine : NULL,
+                       &progress, NULL, flags) != 0;
+}
+
+b8 platform_create_directory(const char* path)
+{
+    return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+b8 platform_remove_directory(const char* path)
+{
+    return RemoveDirectoryA(path) != 0;
+}
+
+// Links to folders are folders themselves and go with RemoveDirectory, links
+// to files are files.
+b8 platform_remove_link(const char* path)
+{
+    const DWORD attributes = GetFileAttributesA(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+    {
+        return false;
+    }
+    return (attributes & FILE_ATTRIBUTE_DIRECTORY) ? RemoveDirectoryA(path) != 0
+                                                   : DeleteFileA(path) != 0;
+}
+
+b8 platform_delete_file(const char* path)
+{
+    if (DeleteFileA(path))
+    {
+        return true;
+    }
+    const DWORD attributes = GetFileAttributesA(path);
+    if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_READONLY))
+    {
+        SetFileAttributesA(path, attributes & ~FILE_ATTRIBUTE_READONLY);
+        return DeleteFileA(path) != 0;
+    }
+    return false;
+}
+
+b8 platform_rename(const char* path, const char* new_path)
+{
+    return MoveFileExA(path, new_path, 0) != 0;
+}
+
+b8 platform_same_volume(const char* first, const char* second)
+{
+    char first_volume[MAX_PATH] = { 0 };
+    char second_volume[MAX_PATH] = { 0 };
+    if (!GetVolumePathNameA(first, first_volume, MAX_PATH) ||
+        !GetVolumePathNameA(second, second_volume, MAX_PATH))
+    {
+        return false;
+    }
+    return string_compare_case_insensitive(first_volume, second_volume) == 0;
+}
+
+b8 platform_path_exists(const char* path)
+{
+    return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+u64 platform_get_file_size(const char* path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes = { 0 };
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+    {
+        return 0;
+    }
+    return ((u64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+}
+
+void platform_list_directory_entries(const char* directory_path, PlatformFileEntryArray* entries)
+{
+    const u32 directory_length = (u32)strlen(directory_path);
+    char* search_path = concatinate(directory_path, directory_length, "*", 1, '\\', 0, NULL);
+
+    WIN32_FIND_DATA ffd = { 0 };
+    HANDLE file_handle = FindFirstFile(search_path, &ffd);
+    free(search_path);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        if (!strcmp(ffd.cFileName, ".") || !strcmp(ffd.cFileName, ".."))
+        {
+            continue;
+        }
+        const u32 name_length = (u32)strlen(ffd.cFileName);
+        PlatformFileEntry entry = {
+            .path = concatinate(directory_path, directory_length, ffd.cFileName, name_length,
+                                '\\', 0, NULL),
+            .size = ((u64)ffd.nFileSizeHigh << 32) | ffd.nFileSizeLow,
+            .last_write_time =
+                ((u64)ffd.ftLastWriteTime.dwHighDateTime << 32) | ffd.ftLastWriteTime.dwLowDateTime,
+            .directory = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0,
+            .link = (ffd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0,
+        };
+        array_push(entries, entry);
+    } while (FindNextFile(file_handle, &ffd));
+    FindClose(file_handle);
+}
+
+void platform_delete_directory_files(const char* directory_path, CharPtrArray* folders,
+                                     PlatformDeleteProgressCallback callback, void* data)
+{
+    const u32 directory_length = (u32)strlen(directory_path);
+    char* search_path = concatinate(directory_path, directory_length, "*", 1, '\\', 0, NULL);
+
+    WIN32_FIND_DATA ffd = { 0 };
+    HANDLE file_handle = FindFirstFile(search_path, &ffd);
+    free(search_path);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    u32 deleted = 0;
+    u32 failed = 0;
+    b8 keep_going = true;
+    do
+    {
+        if (!strcmp(ffd.cFileName, ".") || !strcmp(ffd.cFileName, ".."))
+        {
+            continue;
+        }
+        char* path = concatinate(directory_path, directory_length, ffd.cFileName,
+                                 (u32)strlen(ffd.cFileName), '\\', 0, NULL);
+        const DWORD attributes = ffd.dwFileAttributes;
+        if ((attributes & FILE_ATTRIBUTE_DIRECTORY) &&
+            !(attributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        {
+            array_push(folders, path);
+            continue;
+        }
+        // Only a junction itself goes, never what it points at.
+        const b8 removed = (attributes & FILE_ATTRIBUTE_DIRECTORY) ? RemoveDirectoryA(path) != 0
+                                                                   : platform_delete_file(path);
+        free(path);
+        if (removed)
+        {
+            ++deleted;
+        }
+        else
+        {
+            ++failed;
+        }
+        if (callback && deleted + failed >= PLATFORM_DELETE_PROGRESS_STEP)
+        {
+            keep_going = callback(deleted, failed, data);
+            deleted = 0;
+            failed = 0;
+        }
+    } while (keep_going && FindNextFile(file_handle, &ffd));
+    FindClose(file_handle);
+    if (callback && (deleted || failed))
+    {
+        callback(deleted, failed, data);
+    }
+}
+
 void platform_rename_file(const char* path, char* new_name, const u32 name_length)
 {
     u32 path_length = get_path_length(path, (u32)strlen(path));
@@ -1761,6 +2068,15 @@ void* directory_listen_to_directory_changes(const char* path)
     return handle;
 }
 
+void* directory_listen_to_tree_changes(const char* path)
+{
+    HANDLE handle =
+        FindFirstChangeNotification(path, TRUE,
+                                    FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                                        FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    return handle == INVALID_HANDLE_VALUE ? NULL : handle;
+}
+
 void directory_unlisten_to_directory_changes(void* handle)
 {
     FindCloseChangeNotification(handle);
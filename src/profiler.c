@@ -0,0 +1,293 @@
+#include "profiler.h"
+#include "platform/platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROFILER_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#define thread_local_storage __declspec(thread)
+#else
+#define thread_local_storage _Thread_local
+#endif
+
+typedef struct Profiler
+{
+    ProfileThread* threads[PROFILER_MAX_THREADS];
+    FTicAtomic thread_count;
+    FTicAtomic enabled;
+    u32 generation;
+
+    ProfileFrame frames[PROFILER_FRAME_HISTORY];
+    u64 frame_count;
+    u64 frame_start;
+
+    u64 base_ticks;
+    f64 base_time;
+    f64 ticks_per_second;
+} Profiler;
+
+global Profiler profiler;
+
+// The generation catches a thread still pointing into a profiler that has
+// been uninitialized and created again.
+thread_local_storage ProfileThread* profile_thread;
+thread_local_storage u32 profile_thread_generation;
+
+u64 profiler_timestamp(void)
+{
+#ifdef PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return (u64)(platform_get_time() * 1000000000.0);
+#endif
+}
+
+internal void profiler_calibrate(void)
+{
+    const f64 elapsed = platform_get_time() - profiler.base_time;
+    if (elapsed > 0.0005)
+    {
+        profiler.ticks_per_second = (f64)(profiler_timestamp() - profiler.base_ticks) / elapsed;
+    }
+}
+
+internal ProfileThread* profiler_register_thread(void)
+{
+    long index = profiler.thread_count;
+    for (;;)
+    {
+        if (index >= PROFILER_MAX_THREADS)
+        {
+            return NULL;
+        }
+        const long previous =
+            ftic_atomic_compare_exchange(&profiler.thread_count, index + 1, index);
+        if (previous == index)
+        {
+            break;
+        }
+        index = previous;
+    }
+    ProfileThread* thread = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+    thread->events = (ProfileEvent*)calloc(PROFILER_EVENT_CAPACITY, sizeof(ProfileEvent));
+    thread->index = (u16)index;
+    profiler.threads[index] = thread;
+
+    profile_thread = thread;
+    profile_thread_generation = profiler.generation;
+    return thread;
+}
+
+void profiler_initialize(void)
+{
+    const u32 generation = profiler.generation + 1;
+    memset(&profiler, 0, sizeof(profiler));
+    profiler.generation = generation;
+    profiler.base_time = platform_get_time();
+    profiler.base_ticks = profiler_timestamp();
+    profiler_register_thread();
+}
+
+void profiler_uninitialize(void)
+{
+    for (u32 i = 0; i < PROFILER_MAX_THREADS; ++i)
+    {
+        ProfileThread* thread = profiler.threads[i];
+        if (thread)
+        {
+            free(thread->events);
+            free(thread);
+            profiler.threads[i] = NULL;
+        }
+    }
+    profiler.thread_count = 0;
+    profiler.enabled = false;
+    ++profiler.generation;
+}
+
+void profiler_set_enabled(b8 enabled)
+{
+    ftic_atomic_store(&profiler.enabled, enabled);
+}
+
+b8 profiler_is_enabled(void)
+{
+    return profiler.enabled != 0;
+}
+
+void profile_begin(const char* name)
+{
+    if (!profiler.enabled)
+    {
+        return;
+    }
+    ProfileThread* thread = profile_thread;
+    if (!thread || profile_thread_generation != profiler.generation)
+    {
+        thread = profiler_register_thread();
+        if (!thread)
+        {
+            return;
+        }
+    }
+    if (thread->depth < PROFILER_MAX_DEPTH)
+    {
+        thread->open_names[thread->depth] = name;
+        thread->open_starts[thread->depth] = profiler_timestamp();
+    }
+    ++thread->depth;
+}
+
+// Does not look at enabled, a scope begun before recording was turned off
+// still gets closed. One begun before it was turned on finds depth zero.
+void profile_end(void)
+{
+    ProfileThread* thread = profile_thread;
+    if (!thread || profile_thread_generation != profiler.generation || thread->depth == 0)
+    {
+        return;
+    }
+    const u32 depth = --thread->depth;
+    if (depth >= PROFILER_MAX_DEPTH)
+    {
+        return;
+    }
+    const i64 written = thread->written;
+    ProfileEvent* event = thread->events + (written & (PROFILER_EVENT_CAPACITY - 1));
+    event->name = thread->open_names[depth];
+    event->start = thread->open_starts[depth];
+    event->end = profiler_timestamp();
+    event->depth = (u16)depth;
+    event->thread = thread->index;
+    thread->written = written + 1;
+}
+
+f64 profiler_ticks_to_ms(u64 ticks)
+{
+    if (profiler.ticks_per_second == 0.0)
+    {
+        profiler_calibrate();
+        if (profiler.ticks_per_second == 0.0)
+        {
+            return 0.0;
+        }
+    }
+    return ((f64)ticks * 1000.0) / profiler.ticks_per_second;
+}
+
+void profiler_frame_begin(void)
+{
+    profiler.frame_start = profiler_timestamp();
+}
+
+void profiler_frame_end(void)
+{
+    ProfileFrame* frame = profiler.frames + (profiler.frame_count++ % PROFILER_FRAME_HISTORY);
+    frame->start = profiler.frame_start;
+    frame->end = profiler_timestamp();
+    profiler_calibrate();
+}
+
+b8 profiler_get_frame(u32 frames_ago, ProfileFrame* frame)
+{
+    if (frames_ago >= PROFILER_FRAME_HISTORY || frames_ago >= profiler.frame_count)
+    {
+        return false;
+    }
+    *frame = profiler.frames[(profiler.frame_count - 1 - frames_ago) % PROFILER_FRAME_HISTORY];
+    return true;
+}
+
+u32 profiler_thread_count(void)
+{
+    return (u32)ftic_min(profiler.thread_count, PROFILER_MAX_THREADS);
+}
+
+void profiler_collect(u64 start, u64 end, ProfileEventArray* events)
+{
+    const u32 thread_count = profiler_thread_count();
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        const ProfileThread* thread = profiler.threads[i];
+        if (!thread)
+        {
+            continue;
+        }
+        // Only the newer half of the ring is read, the writer would have to
+        // lap it while it is copied for a slot to change underneath.
+        const i64 written = thread->written;
+        const i64 first = ftic_max(written - (PROFILER_EVENT_CAPACITY / 2), 0);
+        const u32 size_before = events->size;
+        for (i64 j = first; j < written; ++j)
+        {
+            const ProfileEvent* event = thread->events + (j & (PROFILER_EVENT_CAPACITY - 1));
+            if (event->end >= start && event->start <= end)
+            {
+                array_push(events, *event);
+            }
+        }
+        if (thread->written - PROFILER_EVENT_CAPACITY >= first)
+        {
+            events->size = size_before;
+        }
+    }
+}
+
+internal void profiler_write_escaped(FILE* file, const char* text)
+{
+    for (; *text; ++text)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*text, file);
+    }
+}
+
+b8 profiler_export_chrome_trace(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    profiler_calibrate();
+    const f64 ticks_to_us = profiler_ticks_to_ms(1) * 1000.0;
+
+    ProfileEventArray events = { 0 };
+    array_create(&events, 1024);
+    profiler_collect(0, UINT64_MAX, &events);
+
+    fprintf(file, "{\"traceEvents\":[");
+    const u32 thread_count = profiler_thread_count();
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        fprintf(file,
+                "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                "\"args\":{\"name\":\"%s %u\"}}",
+                i ? "," : "", i, i == 0 ? "Main" : "Worker", i);
+    }
+    for (u32 i = 0; i < events.size; ++i)
+    {
+        const ProfileEvent* event = events.data + i;
+        const u64 start = event->start > profiler.base_ticks ? event->start - profiler.base_ticks : 0;
+        fprintf(file, "%s\n{\"name\":\"", thread_count || i ? "," : "");
+        profiler_write_escaped(file, event->name);
+        fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                event->thread, start * ticks_to_us, (event->end - event->start) * ticks_to_us);
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    array_free(&events);
+    return true;
+}
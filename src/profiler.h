@@ -0,0 +1,81 @@
+#pragma once
+#include "define.h"
+#include "ftic_atomic.h"
+
+// Events kept per thread, older ones are overwritten. Has to be a power of two.
+#define PROFILER_EVENT_CAPACITY (1 << 14)
+// Scopes nested deeper than this are counted but not recorded.
+#define PROFILER_MAX_DEPTH 32
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_FRAME_HISTORY 256
+
+// Names are stored as pointers, so they have to outlive the profiler. String
+// literals and __func__ are fine.
+#ifdef FTIC_NO_PROFILER
+#define PROFILE_BEGIN(name)
+#define PROFILE_FUNCTION_BEGIN()
+#define PROFILE_END()
+#else
+#define PROFILE_BEGIN(name) profile_begin(name)
+#define PROFILE_FUNCTION_BEGIN() profile_begin(__func__)
+#define PROFILE_END() profile_end()
+#endif
+
+typedef struct ProfileEvent
+{
+    const char* name;
+    u64 start;
+    u64 end;
+    u16 depth;
+    u16 thread;
+} ProfileEvent;
+
+typedef struct ProfileEventArray
+{
+    u32 size;
+    u32 capacity;
+    ProfileEvent* data;
+} ProfileEventArray;
+
+typedef struct ProfileFrame
+{
+    u64 start;
+    u64 end;
+} ProfileFrame;
+
+// Only the owning thread writes to it. written is bumped after the event is
+// in place, readers copy and then check that the slot was not reused.
+typedef struct ProfileThread
+{
+    ProfileEvent* events;
+    FTicAtomic64 written;
+
+    const char* open_names[PROFILER_MAX_DEPTH];
+    u64 open_starts[PROFILER_MAX_DEPTH];
+    u32 depth;
+    u16 index;
+} ProfileThread;
+
+// Call from the main thread, it is registered as thread 0.
+void profiler_initialize(void);
+// Only after every thread that recorded has been joined.
+void profiler_uninitialize(void);
+
+void profiler_set_enabled(b8 enabled);
+b8 profiler_is_enabled(void);
+
+void profile_begin(const char* name);
+void profile_end(void);
+
+u64 profiler_timestamp(void);
+f64 profiler_ticks_to_ms(u64 ticks);
+
+void profiler_frame_begin(void);
+void profiler_frame_end(void);
+// frames_ago 0 is the last completed frame. False if it is not recorded.
+b8 profiler_get_frame(u32 frames_ago, ProfileFrame* frame);
+
+u32 profiler_thread_count(void);
+// Appends every recorded event overlapping [start, end].
+void profiler_collect(u64 start, u64 end, ProfileEventArray* events);
+b8 profiler_export_chrome_trace(const char* path);
@@ -0,0 +1,94 @@
+#include "render_target.h"
+#include "texture.h"
+#include <glad/glad.h>
+#include <string.h>
+
+b8 render_target_create(const i32 width, const i32 height, RenderTarget* render_target)
+{
+    memset(render_target, 0, sizeof(RenderTarget));
+
+    const TextureProperties texture_properties = { .width = width, .height = height };
+    render_target->texture = texture_create(&texture_properties, GL_RGBA8, GL_RGBA, GL_LINEAR);
+
+    glCreateFramebuffers(1, &render_target->framebuffer);
+    glNamedFramebufferTexture(render_target->framebuffer, GL_COLOR_ATTACHMENT0,
+                              render_target->texture, 0);
+    if (glCheckNamedFramebufferStatus(render_target->framebuffer, GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE)
+    {
+        render_target_destroy(render_target);
+        return false;
+    }
+    render_target->width = width;
+    render_target->height = height;
+    return true;
+}
+
+void render_target_destroy(RenderTarget* render_target)
+{
+    if (render_target->framebuffer)
+    {
+        glDeleteFramebuffers(1, &render_target->framebuffer);
+    }
+    if (render_target->texture)
+    {
+        texture_delete(render_target->texture);
+    }
+    memset(render_target, 0, sizeof(RenderTarget));
+}
+
+void render_target_bind(const RenderTarget* render_target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, render_target->framebuffer);
+    glViewport(0, 0, render_target->width, render_target->height);
+}
+
+void render_target_unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+b8 render_target_pool_resize(RenderTargetPool* pool, const i32 width, const i32 height,
+                             u32 level_count)
+{
+    level_count = min(level_count, RENDER_TARGET_POOL_MAX_LEVELS);
+    if (pool->full.framebuffer && pool->width == width && pool->height == height &&
+        pool->level_count == level_count)
+    {
+        return true;
+    }
+    render_target_pool_destroy(pool);
+
+    if (!render_target_create(width, height, &pool->full))
+    {
+        return false;
+    }
+    i32 level_width = width;
+    i32 level_height = height;
+    for (u32 i = 0; i < level_count; ++i)
+    {
+        level_width = max(level_width / 2, 1);
+        level_height = max(level_height / 2, 1);
+        if (!render_target_create(level_width, level_height, pool->levels + i))
+        {
+            render_target_pool_destroy(pool);
+            return false;
+        }
+        pool->level_count++;
+    }
+    pool->width = width;
+    pool->height = height;
+    return true;
+}
+
+void render_target_pool_destroy(RenderTargetPool* pool)
+{
+    for (u32 i = 0; i < pool->level_count; ++i)
+    {
+        render_target_destroy(pool->levels + i);
+    }
+    render_target_destroy(&pool->full);
+    pool->level_count = 0;
+    pool->width = 0;
+    pool->height = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "define.h"
+
+typedef struct RenderTarget
+{
+    u32 framebuffer;
+    u32 texture;
+    i32 width;
+    i32 height;
+} RenderTarget;
+
+#define RENDER_TARGET_POOL_MAX_LEVELS 6
+
+// A full size target followed by a chain where every level is half the size of
+// the one before it. The targets are kept between frames and only recreated
+// when the size changes.
+typedef struct RenderTargetPool
+{
+    RenderTarget full;
+    RenderTarget levels[RENDER_TARGET_POOL_MAX_LEVELS];
+    u32 level_count;
+    i32 width;
+    i32 height;
+} RenderTargetPool;
+
+b8 render_target_create(const i32 width, const i32 height, RenderTarget* render_target);
+void render_target_destroy(RenderTarget* render_target);
+void render_target_bind(const RenderTarget* render_target);
+void render_target_unbind();
+
+b8 render_target_pool_resize(RenderTargetPool* pool, const i32 width, const i32 height,
+                             u32 level_count);
+void render_target_pool_destroy(RenderTargetPool* pool);
@@ -3,6 +3,8 @@
 #include "texture.h"
 #include <glad/glad.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 Render render_create(const u32 shader_id, const U32Array textures,
                      const VertexBufferLayout* vertex_buffer_layout,
@@ -34,43 +36,78 @@ void render_destroy(Render* render)
     free(render->textures.data);
 }
 
-void rendering_properties_clear(RenderingProperties* rendering_properties)
+void rendering_properties_create(const u32 shader_id, const U32Array textures,
+                                 const u32 quad_capacity,
+                                 RenderingProperties* rendering_properties)
 {
-    rendering_properties->vertices.size = 0;
+    rendering_properties->vertex_buffer_layout = quad_instance_buffer_layout();
+    rendering_properties->stream_buffer =
+        stream_buffer_create(quad_capacity * sizeof(QuadInstance));
+    rendering_properties->render = render_create(
+        shader_id, textures, &rendering_properties->vertex_buffer_layout,
+        rendering_properties->stream_buffer.buffer_id, 0);
+    rendering_properties->vertices = (QuadArray){ 0 };
+    rendering_properties_clear(rendering_properties);
 }
 
-void rendering_properties_check_and_grow_vertex_buffer(
-    RenderingProperties* rendering_properties)
+void rendering_properties_destroy(RenderingProperties* rendering_properties)
 {
-    if (rendering_properties->vertices.size >
-        rendering_properties->vertex_buffer_capacity)
+    if (!rendering_properties->vertices.mapped)
     {
-        vertex_buffer_orphan(rendering_properties->render.vertex_buffer_id,
-                             rendering_properties->vertices.capacity *
-                                 sizeof(Vertex),
-                             GL_STREAM_DRAW, NULL);
-        rendering_properties->vertex_buffer_capacity =
-            rendering_properties->vertices.capacity;
+        free(rendering_properties->vertices.data);
     }
+    rendering_properties->vertices = (QuadArray){ 0 };
+    stream_buffer_destroy(&rendering_properties->stream_buffer);
+    rendering_properties->render.vertex_buffer_id = 0;
+    render_destroy(&rendering_properties->render);
+    array_free(&rendering_properties->vertex_buffer_layout.items);
 }
 
-void rendering_properties_check_and_grow_index_buffer(
-    RenderingProperties* rendering_properties, const u32 total_index_count)
+void rendering_properties_clear(RenderingProperties* rendering_properties)
 {
-    if (total_index_count > rendering_properties->indices.size)
+    QuadArray* vertices = &rendering_properties->vertices;
+    if (!vertices->mapped)
     {
-        rendering_properties->indices.size = 0;
-        rendering_properties->indices.capacity *= 2;
-        rendering_properties->indices.data =
-            (u32*)calloc(rendering_properties->indices.capacity, sizeof(u32));
-        generate_indicies(&rendering_properties->indices, 0,
-                          rendering_properties->indices.capacity * 6);
-        index_buffer_orphan(rendering_properties->render.index_buffer_id,
-                            rendering_properties->indices.capacity *
-                                sizeof(u32),
-                            GL_STATIC_DRAW, rendering_properties->indices.data);
-        free(rendering_properties->indices.data);
+        free(vertices->data);
     }
+    StreamBuffer* stream_buffer = &rendering_properties->stream_buffer;
+    vertices->data = (QuadInstance*)stream_buffer_begin(stream_buffer);
+    vertices->capacity =
+        (u32)(stream_buffer->segment_size / sizeof(QuadInstance));
+    vertices->size = 0;
+    vertices->mapped = true;
+    vertices->content_hash = 0xCBF29CE484222325ULL;
+}
+
+void rendering_properties_upload(RenderingProperties* rendering_properties)
+{
+    QuadArray* vertices = &rendering_properties->vertices;
+    StreamBuffer* stream_buffer = &rendering_properties->stream_buffer;
+    if (!vertices->mapped)
+    {
+        // The quads spilled out of the segment this frame. Make the ring big
+        // enough for them and copy them over once.
+        QuadInstance* spilled = vertices->data;
+        stream_buffer_destroy(stream_buffer);
+        *stream_buffer =
+            stream_buffer_create(vertices->capacity * sizeof(QuadInstance));
+        rendering_properties->render.vertex_buffer_id = stream_buffer->buffer_id;
+
+        vertices->data = (QuadInstance*)stream_buffer_begin(stream_buffer);
+        memcpy(vertices->data, spilled, vertices->size * sizeof(QuadInstance));
+        free(spilled);
+        vertices->mapped = true;
+    }
+    vertex_array_add_buffer_offset(rendering_properties->render.vertex_array_id,
+                                   stream_buffer->buffer_id,
+                                   &rendering_properties->vertex_buffer_layout,
+                                   stream_buffer_offset(stream_buffer));
+    vertex_array_unbind();
+}
+
+void rendering_properties_submit(RenderingProperties* rendering_properties)
+{
+    stream_buffer_end(&rendering_properties->stream_buffer);
 }
 
 void render_begin_draw_shader(const Render* render, const u32 shader,
@@ -121,6 +158,25 @@ void render_draw(const u32 index_offset, const u32 index_count,
     }
 }
 
+void render_draw_quads(const u32 index_offset, const u32 index_count,
+                       const AABB* scissor)
+{
+    // Offsets and counts are kept in indices, six per quad, so the callers
+    // can keep their bookkeeping. Every quad is one instance.
+    if (index_count)
+    {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor((int)round_f32(scissor->min.x), (int)round_f32(scissor->min.y),
+                  (int)round_f32(scissor->size.width),
+                  (int)round_f32(scissor->size.height));
+
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, index_count / 6,
+                                          index_offset / 6);
+
+        glDisable(GL_SCISSOR_TEST);
+    }
+}
+
 void render_end_draw(const Render* render)
 {
     for (u32 i = 0; i < render->textures.size; ++i)
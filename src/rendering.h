@@ -18,17 +18,20 @@ typedef struct Render
 typedef struct RenderingProperties
 {
     Render render;
-    IndexArray indices;
-    VertexArray vertices;
-    u32 vertex_buffer_capacity;
+    QuadArray vertices;
+    StreamBuffer stream_buffer;
+    VertexBufferLayout vertex_buffer_layout;
 } RenderingProperties;
 
 Render render_create(const u32 shader_id, const U32Array textures, const VertexBufferLayout* vertex_buffer_layout, const u32 vertex_buffer_id, const u32 index_buffer_id);
 void render_destroy(Render* render);
+void rendering_properties_create(const u32 shader_id, const U32Array textures, const u32 quad_capacity, RenderingProperties* rendering_properties);
+void rendering_properties_destroy(RenderingProperties* rendering_properties);
 void rendering_properties_clear(RenderingProperties* rendering_properties);
-void rendering_properties_check_and_grow_vertex_buffer(RenderingProperties* rendering_properties);
-void rendering_properties_check_and_grow_index_buffer( RenderingProperties* rendering_properties, const u32 total_index_count);
+void rendering_properties_upload(RenderingProperties* rendering_properties);
+void rendering_properties_submit(RenderingProperties* rendering_properties);
 void render_begin_draw_shader(const Render* render, const u32 shader, const MVP* mvp);
 void render_begin_draw(const Render* render, const u32 shader, const MVP* mvp);
 void render_draw(const u32 index_offset, const u32 index_count, const AABB* scissor);
+void render_draw_quads(const u32 index_offset, const u32 index_count, const AABB* scissor);
 void render_end_draw(const Render* render);
@@ -0,0 +1,274 @@
+#include "search.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ContentHitContext
+{
+    const ContentSearchBatch* batch;
+    DirectoryItem* file;
+    u32 hit_count;
+} ContentHitContext;
+
+internal void add_directory_item(const DirectoryItem* item, FindingCallbackAttribute* arguments)
+{
+    const char* name = item_namec(item);
+    char* path = item->path;
+    if (string_contains_case_insensitive(name, arguments->string_to_match))
+    {
+        const u32 name_length = (u32)strlen(name);
+        const u32 path_length = (u32)strlen(path);
+
+        SearchResult result = { .item = *item, .running_id = arguments->running_id };
+        result.item.path = string_copy(path, path_length, 2);
+        result.item.name_offset = (u16)(path_length - name_length);
+        if (!thread_channel_push(arguments->results, &result, 1))
+        {
+            free(result.item.path);
+        }
+    }
+}
+
+// Files found through the index have no id yet, it is looked up on the first
+// hit so files without any do not cost a lookup.
+internal b8 add_content_hit(u32 line, const char* text, u32 text_length, void* data)
+{
+    ContentHitContext* context = (ContentHitContext*)data;
+    const ContentSearchBatch* batch = context->batch;
+    if (!batch->running_callbacks[batch->running_id])
+    {
+        return false;
+    }
+    DirectoryItem* file = context->file;
+    const FticGUID no_id = { 0 };
+    if (context->hit_count == 0 && guid_compare(file->id, no_id) == 0)
+    {
+        platform_get_id_from_path(file->path, &file->id);
+    }
+    const char* name = item_namec(file);
+    const u32 name_length = (u32)strlen(name);
+    const u32 path_length = (u32)strlen(file->path);
+    char line_number[16] = { 0 };
+    const u32 line_number_length =
+        (u32)sprintf_s(line_number, sizeof(line_number), ":%u: ", line);
+
+    const u32 label_length = name_length + line_number_length + text_length;
+    char* label = (char*)malloc(label_length + 1);
+    memcpy(label, name, name_length);
+    memcpy(label + name_length, line_number, line_number_length);
+    char* label_text = label + name_length + line_number_length;
+    for (u32 i = 0; i < text_length; ++i)
+    {
+        label_text[i] = (u8)text[i] < ' ' ? ' ' : text[i];
+    }
+    label[label_length] = '\0';
+
+    SearchResult result = { .item = *file, .label = label, .running_id = batch->running_id };
+    result.item.path = string_copy(file->path, path_length, 0);
+    result.item.size = 0;
+    if (!thread_channel_push(batch->results, &result, 1))
+    {
+        free(result.item.path);
+        free(label);
+        return false;
+    }
+    return ++context->hit_count < CONTENT_SEARCH_MAX_FILE_HITS;
+}
+
+void content_search_callback(void* data)
+{
+    ContentSearchBatch* batch = (ContentSearchBatch*)data;
+    PROFILE_FUNCTION_BEGIN();
+
+    for (u32 i = 0; i < batch->files.size; ++i)
+    {
+        DirectoryItem* file = batch->files.data + i;
+        if (batch->running_callbacks[batch->running_id])
+        {
+            ContentHitContext context = { .batch = batch, .file = file };
+            content_search_file(file->path, &batch->matcher, add_content_hit, &context, NULL);
+        }
+        free(file->path);
+    }
+    array_free(&batch->files);
+    thread_channel_release(batch->results);
+    free(batch);
+    PROFILE_END();
+}
+
+internal ContentSearchBatch* content_search_batch_create(const FindingCallbackAttribute* arguments,
+                                                         const ContentMatcher* matcher)
+{
+    ContentSearchBatch* batch = (ContentSearchBatch*)calloc(1, sizeof(ContentSearchBatch));
+    batch->matcher = *matcher;
+    array_create(&batch->files, 16);
+    batch->results = arguments->results;
+    thread_channel_retain(arguments->results);
+    batch->running_callbacks = arguments->running_callbacks;
+    batch->running_id = arguments->running_id;
+    return batch;
+}
+
+internal void content_search_batch_push(ContentSearchBatch* batch, ThreadTaskQueue* thread_queue)
+{
+    ThreadTask task = thread_task(content_search_callback, batch);
+    thread_tasks_push(thread_queue, &task, 1, NULL);
+}
+
+void finding_callback(void* data)
+{
+    FindingCallbackAttribute* arguments = (FindingCallbackAttribute*)data;
+    PROFILE_FUNCTION_BEGIN();
+
+    b8 should_free_directory = false;
+    b8 running = arguments->running_callbacks[arguments->running_id];
+    ContentMatcher matcher = { 0 };
+    if (arguments->match_contents)
+    {
+        running &= content_matcher_create(arguments->string_to_match,
+                                          arguments->string_to_match_length, &matcher);
+    }
+    ContentSearchBatch* batch = NULL;
+    u64 batch_bytes = 0;
+    Directory directory = { 0 };
+    if (running)
+    {
+        directory = platform_get_directory(arguments->start_directory,
+                                           arguments->start_directory_length, true);
+        should_free_directory = true;
+    }
+
+    for (u32 i = 0; i < directory.items.size && running; ++i)
+    {
+        DirectoryItem* item = directory.items.data + i;
+        if (item->type == FOLDER_DEFAULT)
+        {
+            if (!arguments->match_contents)
+            {
+                add_directory_item(item, arguments);
+            }
+
+            FindingCallbackAttribute* next_arguments =
+                (FindingCallbackAttribute*)calloc(1, sizeof(FindingCallbackAttribute));
+
+            char* path = item->path;
+            size_t directory_name_length = strlen(path);
+
+            next_arguments->start_directory = string_copy(path, (u32)directory_name_length, 2);
+            next_arguments->start_directory[directory_name_length++] = '\\';
+            next_arguments->start_directory[directory_name_length++] = '*';
+            next_arguments->results = arguments->results;
+            thread_channel_retain(arguments->results);
+            next_arguments->thread_queue = arguments->thread_queue;
+            next_arguments->start_directory_length = (u32)directory_name_length;
+            next_arguments->string_to_match = arguments->string_to_match;
+            next_arguments->string_to_match_length = arguments->string_to_match_length;
+            next_arguments->running_id = arguments->running_id;
+            next_arguments->running_callbacks = arguments->running_callbacks;
+            next_arguments->match_contents = arguments->match_contents;
+
+            ThreadTask task = thread_task(finding_callback, next_arguments);
+            thread_tasks_push(next_arguments->thread_queue, &task, 1, NULL);
+        }
+        else if (arguments->match_contents)
+        {
+            if (!batch)
+            {
+                batch = content_search_batch_create(arguments, &matcher);
+                batch_bytes = 0;
+            }
+            DirectoryItem file = *item;
+            file.path = string_copy(item->path, (u32)strlen(item->path), 0);
+            array_push(&batch->files, file);
+            batch_bytes += item->size;
+            if (batch_bytes >= CONTENT_SEARCH_BATCH_BYTES ||
+                batch->files.size == CONTENT_SEARCH_BATCH_FILES)
+            {
+                content_search_batch_push(batch, arguments->thread_queue);
+                batch = NULL;
+            }
+        }
+        else
+        {
+            add_directory_item(item, arguments);
+        }
+    }
+    if (batch)
+    {
+        content_search_batch_push(batch, arguments->thread_queue);
+    }
+    if (should_free_directory)
+    {
+        platform_reset_directory(&directory, true);
+    }
+    thread_channel_release(arguments->results);
+    free(arguments->start_directory);
+    free(data);
+    PROFILE_END();
+}
+
+b8 indexed_content_search(const ContentIndex* index, FindingCallbackAttribute* arguments)
+{
+    ContentMatcher matcher = { 0 };
+    if (!content_matcher_create(arguments->string_to_match, arguments->string_to_match_length,
+                                &matcher))
+    {
+        return false;
+    }
+    PROFILE_FUNCTION_BEGIN();
+
+    // Without the "\*" of the start directory.
+    u32 directory_length = arguments->start_directory_length;
+    if (directory_length >= 2 && arguments->start_directory[directory_length - 1] == '*')
+    {
+        directory_length -= 2;
+    }
+    char* directory = string_copy(arguments->start_directory, directory_length, 0);
+    U32Array candidates = { 0 };
+    array_create(&candidates, 64);
+    const b8 indexed = content_index_query(index, directory, arguments->string_to_match,
+                                           arguments->string_to_match_length, &candidates);
+    if (indexed)
+    {
+        ContentSearchBatch* batch = NULL;
+        u64 batch_bytes = 0;
+        for (u32 i = 0; i < candidates.size; ++i)
+        {
+            if (!batch)
+            {
+                batch = content_search_batch_create(arguments, &matcher);
+                batch_bytes = 0;
+            }
+            const ContentIndexFile* entry = index->files + candidates.data[i];
+            const char* path = content_index_file_path(index, candidates.data[i]);
+            const u32 path_length = (u32)strlen(path);
+            DirectoryItem file = {
+                .size = entry->size,
+                .last_write_time = entry->last_write_time,
+                .path = string_copy(path, path_length, 0),
+                .name_offset = (u16)get_path_length(path, path_length),
+                .type = FILE_DEFAULT,
+            };
+            array_push(&batch->files, file);
+            batch_bytes += entry->size;
+            if (batch_bytes >= CONTENT_SEARCH_BATCH_BYTES ||
+                batch->files.size == CONTENT_SEARCH_BATCH_FILES)
+            {
+                content_search_batch_push(batch, arguments->thread_queue);
+                batch = NULL;
+            }
+        }
+        if (batch)
+        {
+            content_search_batch_push(batch, arguments->thread_queue);
+        }
+        thread_channel_release(arguments->results);
+        free(arguments->start_directory);
+        free(arguments);
+    }
+    free(directory);
+    array_free(&candidates);
+    PROFILE_END();
+    return indexed;
+}
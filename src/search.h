@@ -0,0 +1,58 @@
+#pragma once
+#include "define.h"
+#include "platform/platform.h"
+#include "thread_queue.h"
+#include "content_search.h"
+#include "content_index.h"
+
+#define SEARCH_RESULT_CHANNEL_CAPACITY 4096
+// Files of a folder are searched for content in tasks of about this size.
+#define CONTENT_SEARCH_BATCH_BYTES (4 * 1024 * 1024)
+#define CONTENT_SEARCH_BATCH_FILES 64
+// Matching lines reported per file.
+#define CONTENT_SEARCH_MAX_FILE_HITS 1000
+
+// A match, tagged with the search it was found by so the results of a
+// search that has been replaced can be told apart. A content match is the
+// file it was found in, with the line shown in the list as its label.
+typedef struct SearchResult
+{
+    DirectoryItem item;
+    char* label; // "<name>:<line>: <text>" for content matches, NULL otherwise
+    u32 running_id;
+} SearchResult;
+
+typedef struct FindingCallbackAttribute
+{
+    ThreadTaskQueue* thread_queue;
+    char* start_directory;
+    const char* string_to_match;
+    u32 start_directory_length;
+    u32 string_to_match_length;
+    u32 running_id;
+    ThreadChannel* results; // SearchResult, referenced by every task
+    b8* running_callbacks;
+    b8 match_contents; // Search inside the files instead of their names
+} FindingCallbackAttribute;
+
+typedef struct ContentSearchBatch
+{
+    ContentMatcher matcher;
+    DirectoryItemArray files; // Own their paths
+    ThreadChannel* results;
+    b8* running_callbacks;
+    u32 running_id;
+} ContentSearchBatch;
+
+// Searches start_directory ("<dir>\*") and pushes a task for every sub folder.
+// Takes ownership of data and its start_directory, both are freed when done,
+// and of its reference to results. With match_contents the files are handed
+// to content_search_callback tasks in batches instead.
+void finding_callback(void* data);
+// Takes ownership of data, a ContentSearchBatch.
+void content_search_callback(void* data);
+// A content search that only scans the files under the start directory the
+// index can not rule out. Takes ownership of arguments like finding_callback
+// unless it returns false, which it does for patterns the index can not
+// narrow down.
+b8 indexed_content_search(const ContentIndex* index, FindingCallbackAttribute* arguments);
@@ -1,4 +1,5 @@
 #include "set.h"
+#include <stdlib.h>
 #include <string.h>
 // @save
 
@@ -25,425 +26,524 @@ internal u32 round_up_power_of_two(u32 capacity)
     return capacity + 1;
 }
 
+// Control bytes, see hash_table_gen.h. A cell is full when the high bit is
+// clear, the low 7 bits then hold the bits of the hash not used for the index.
+#define CONTROL_EMPTY 0x80
+#define CONTROL_GROUP_SIZE 16
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTROL_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+internal u8* control_create(u32 capacity)
+{
+    u8* control = (u8*)malloc(capacity + CONTROL_GROUP_SIZE - 1);
+    memset(control, CONTROL_EMPTY, capacity + CONTROL_GROUP_SIZE - 1);
+    return control;
+}
+
+// Grow at 7/8 full, group probing keeps the runs cheap to scan.
+internal u32 control_max_load(u32 capacity)
+{
+    return capacity - (capacity >> 3);
+}
+
+internal b8 control_is_full(u8 control)
+{
+    return (control & CONTROL_EMPTY) == 0;
+}
+
+internal u8 control_tag(u64 hash)
+{
+    return (u8)(hash & 0x7F);
+}
+
+internal u32 control_home(u64 hash, u32 capacity_mask)
+{
+    return (u32)(hash >> 7) & capacity_mask;
+}
+
+internal void control_set(u8* control, u32 index, u8 value, u32 capacity)
+{
+    control[index] = value;
+    if (index < CONTROL_GROUP_SIZE - 1)
+    {
+        control[capacity + index] = value;
+    }
+}
+
+// Bit i is set when group[i] equals tag.
+internal u32 control_match(const u8* group, u8 tag)
+{
+#ifdef CONTROL_SSE2
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)tag)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < CONTROL_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+internal u32 control_match_empty(const u8* group)
+{
+#ifdef CONTROL_SSE2
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < CONTROL_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+internal u32 control_first_bit(u32 mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctz(mask);
+#endif
+}
+
+internal void control_prefetch(const void* address)
+{
+#ifdef CONTROL_SSE2
+    _mm_prefetch((const char*)address, _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+internal u32 control_find_empty(const u8* control, u32 index, u32 capacity_mask)
+{
+    for (;;)
+    {
+        const u32 empty = control_match_empty(control + index);
+        if (empty)
+        {
+            return (index + control_first_bit(empty)) & capacity_mask;
+        }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+}
+
 // @end
 
 SetU64 set_create_u64(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
-{ 
-    capacity = max(round_up_power_of_two(capacity), 32); 
-    SetU64 out = { 
-        .cells = (SetCellU64*)calloc(capacity, sizeof(SetCellU64)), 
-        .capacity = capacity, 
-        .hash_function = hash_function, 
-    }; 
-    return out; 
+{
+    capacity = max(round_up_power_of_two(capacity), 32);
+    SetU64 out = {
+        .cells = (SetCellU64*)calloc(capacity, sizeof(SetCellU64)),
+        .control = control_create(capacity),
+        .capacity = capacity,
+        .hash_function = hash_function,
+    };
+    return out;
 }
 
 SetCharPtr set_create_char_ptr(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
-{ 
-    capacity = max(round_up_power_of_two(capacity), 32); 
-    SetCharPtr out = { 
-        .cells = (SetCellCharPtr*)calloc(capacity, sizeof(SetCellCharPtr)), 
-        .capacity = capacity, 
-        .hash_function = hash_function, 
-    }; 
-    return out; 
+{
+    capacity = max(round_up_power_of_two(capacity), 32);
+    SetCharPtr out = {
+        .cells = (SetCellCharPtr*)calloc(capacity, sizeof(SetCellCharPtr)),
+        .control = control_create(capacity),
+        .capacity = capacity,
+        .hash_function = hash_function,
+    };
+    return out;
 }
 
 SetGuid set_create_guid(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed))
-{ 
-    capacity = max(round_up_power_of_two(capacity), 32); 
-    SetGuid out = { 
-        .cells = (SetCellGuid*)calloc(capacity, sizeof(SetCellGuid)), 
-        .capacity = capacity, 
-        .hash_function = hash_function, 
-    }; 
-    return out; 
+{
+    capacity = max(round_up_power_of_two(capacity), 32);
+    SetGuid out = {
+        .cells = (SetCellGuid*)calloc(capacity, sizeof(SetCellGuid)),
+        .control = control_create(capacity),
+        .capacity = capacity,
+        .hash_function = hash_function,
+    };
+    return out;
 }
 
 void set_clear_u64(SetU64* set)
-{ 
-    memset(set->cells, 0, set->capacity * sizeof(set->cells[0])); 
+{
+    memset(set->control, CONTROL_EMPTY, set->capacity + CONTROL_GROUP_SIZE - 1);
+    set->size = 0;
 }
 
 void set_clear_char_ptr(SetCharPtr* set)
-{ 
-    memset(set->cells, 0, set->capacity * sizeof(set->cells[0])); 
+{
+    memset(set->control, CONTROL_EMPTY, set->capacity + CONTROL_GROUP_SIZE - 1);
+    set->size = 0;
 }
 
 void set_clear_guid(SetGuid* set)
-{ 
-    memset(set->cells, 0, set->capacity * sizeof(set->cells[0])); 
+{
+    memset(set->control, CONTROL_EMPTY, set->capacity + CONTROL_GROUP_SIZE - 1);
+    set->size = 0;
+}
+
+void set_free_u64(SetU64* set)
+{
+    free(set->cells);
+    free(set->control);
+    set->cells = NULL;
+    set->control = NULL;
+    set->size = 0;
+    set->capacity = 0;
+}
+
+void set_free_char_ptr(SetCharPtr* set)
+{
+    free(set->cells);
+    free(set->control);
+    set->cells = NULL;
+    set->control = NULL;
+    set->size = 0;
+    set->capacity = 0;
+}
+
+void set_free_guid(SetGuid* set)
+{
+    free(set->cells);
+    free(set->control);
+    set->cells = NULL;
+    set->control = NULL;
+    set->size = 0;
+    set->capacity = 0;
 }
 
 void set_insert_u64(SetU64* set, u64 key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellU64* cell = set->cells + hashed_index; 
-    if (cell->active) 
-    { 
-        if (value_cmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 1; i < set->size && cell->active; ++i) 
-            { 
-                if (value_cmp(cell->key, key) == 0) 
-                { 
-                    goto add_node; 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else 
-        { 
-            goto add_node; 
-        } 
-    } 
-    cell->active = true; 
-    cell->deleted = false; 
-    cell->key = key; 
-add_node: 
-    if (set->size++ >= (u32)(set->capacity * 0.4f)) 
-    { 
-        u32 old_capacity = set->capacity; 
-        SetCellU64* old_storage = set->cells; 
- 
-        set->size = 0; 
-        set->capacity *= 2; 
-        set->cells = (SetCellU64*)calloc(set->capacity, 
-                                                 sizeof(SetCellU64)); 
- 
-        for (u32 i = 0; i < old_capacity; i++) 
-        { 
-            cell = old_storage + i; 
-            if (cell->active) 
-            { 
-                set_insert_u64(set, cell->key); 
-            } 
-        } 
-        free(old_storage); 
-    } 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    if (set_find_u64(set, key, hash) < set->capacity)
+    {
+        return;
+    }
+
+    if (set->size + 1 > control_max_load(set->capacity))
+    {
+        const u32 old_capacity = set->capacity;
+        SetCellU64* old_cells = set->cells;
+        u8* old_control = set->control;
+
+        set->capacity *= 2;
+        set->cells = (SetCellU64*)calloc(set->capacity, sizeof(SetCellU64));
+        set->control = control_create(set->capacity);
+
+        const u32 capacity_mask = set->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
+        {
+            if (control_is_full(old_control[i]))
+            {
+                SetCellU64* cell = old_cells + i;
+                const u64 cell_hash =
+                    set->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(set->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(set->control, empty, control_tag(cell_hash), set->capacity);
+                set->cells[empty] = *cell;
+            }
+        }
+        free(old_cells);
+        free(old_control);
+    }
+
+    const u32 capacity_mask = set->capacity - 1;
+    const u32 index =
+        control_find_empty(set->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(set->control, index, control_tag(hash), set->capacity);
+    set->cells[index].key = key;
+    set->size++;
 }
 
 void set_insert_char_ptr(SetCharPtr* set, char* key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellCharPtr* cell = set->cells + hashed_index; 
-    if (cell->active) 
-    { 
-        if (strcmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 1; i < set->size && cell->active; ++i) 
-            { 
-                if (strcmp(cell->key, key) == 0) 
-                { 
-                    goto add_node; 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else 
-        { 
-            goto add_node; 
-        } 
-    } 
-    cell->active = true; 
-    cell->deleted = false; 
-    cell->key = key; 
-add_node: 
-    if (set->size++ >= (u32)(set->capacity * 0.4f)) 
-    { 
-        u32 old_capacity = set->capacity; 
-        SetCellCharPtr* old_storage = set->cells; 
- 
-        set->size = 0; 
-        set->capacity *= 2; 
-        set->cells = (SetCellCharPtr*)calloc(set->capacity, 
-                                                 sizeof(SetCellCharPtr)); 
- 
-        for (u32 i = 0; i < old_capacity; i++) 
-        { 
-            cell = old_storage + i; 
-            if (cell->active) 
-            { 
-                set_insert_char_ptr(set, cell->key); 
-            } 
-        } 
-        free(old_storage); 
-    } 
+{
+    const u64 hash = set->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    if (set_find_char_ptr(set, key, hash) < set->capacity)
+    {
+        return;
+    }
+
+    if (set->size + 1 > control_max_load(set->capacity))
+    {
+        const u32 old_capacity = set->capacity;
+        SetCellCharPtr* old_cells = set->cells;
+        u8* old_control = set->control;
+
+        set->capacity *= 2;
+        set->cells = (SetCellCharPtr*)calloc(set->capacity, sizeof(SetCellCharPtr));
+        set->control = control_create(set->capacity);
+
+        const u32 capacity_mask = set->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
+        {
+            if (control_is_full(old_control[i]))
+            {
+                SetCellCharPtr* cell = old_cells + i;
+                const u64 cell_hash =
+                    set->hash_function(&cell->key, (u32)strlen(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(set->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(set->control, empty, control_tag(cell_hash), set->capacity);
+                set->cells[empty] = *cell;
+            }
+        }
+        free(old_cells);
+        free(old_control);
+    }
+
+    const u32 capacity_mask = set->capacity - 1;
+    const u32 index =
+        control_find_empty(set->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(set->control, index, control_tag(hash), set->capacity);
+    set->cells[index].key = key;
+    set->size++;
 }
 
 void set_insert_guid(SetGuid* set, FticGUID key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellGuid* cell = set->cells + hashed_index; 
-    if (cell->active) 
-    { 
-        if (guid_compare(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 1; i < set->size && cell->active; ++i) 
-            { 
-                if (guid_compare(cell->key, key) == 0) 
-                { 
-                    goto add_node; 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else 
-        { 
-            goto add_node; 
-        } 
-    } 
-    cell->active = true; 
-    cell->deleted = false; 
-    cell->key = key; 
-add_node: 
-    if (set->size++ >= (u32)(set->capacity * 0.4f)) 
-    { 
-        u32 old_capacity = set->capacity; 
-        SetCellGuid* old_storage = set->cells; 
- 
-        set->size = 0; 
-        set->capacity *= 2; 
-        set->cells = (SetCellGuid*)calloc(set->capacity, 
-                                                 sizeof(SetCellGuid)); 
- 
-        for (u32 i = 0; i < old_capacity; i++) 
-        { 
-            cell = old_storage + i; 
-            if (cell->active) 
-            { 
-                set_insert_guid(set, cell->key); 
-            } 
-        } 
-        free(old_storage); 
-    } 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    if (set_find_guid(set, key, hash) < set->capacity)
+    {
+        return;
+    }
+
+    if (set->size + 1 > control_max_load(set->capacity))
+    {
+        const u32 old_capacity = set->capacity;
+        SetCellGuid* old_cells = set->cells;
+        u8* old_control = set->control;
+
+        set->capacity *= 2;
+        set->cells = (SetCellGuid*)calloc(set->capacity, sizeof(SetCellGuid));
+        set->control = control_create(set->capacity);
+
+        const u32 capacity_mask = set->capacity - 1;
+        for (u32 i = 0; i < old_capacity; ++i)
+        {
+            if (control_is_full(old_control[i]))
+            {
+                SetCellGuid* cell = old_cells + i;
+                const u64 cell_hash =
+                    set->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+                const u32 empty =
+                    control_find_empty(set->control, control_home(cell_hash, capacity_mask),
+                                       capacity_mask);
+                control_set(set->control, empty, control_tag(cell_hash), set->capacity);
+                set->cells[empty] = *cell;
+            }
+        }
+        free(old_cells);
+        free(old_control);
+    }
+
+    const u32 capacity_mask = set->capacity - 1;
+    const u32 index =
+        control_find_empty(set->control, control_home(hash, capacity_mask), capacity_mask);
+    control_set(set->control, index, control_tag(hash), set->capacity);
+    set->cells[index].key = key;
+    set->size++;
+}
+
+u32 set_find_u64(SetU64* set, const u64 key, const u64 hash)
+{
+    const u32 capacity_mask = set->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(set->cells + index);
+    for (u32 probed = 0; probed < set->capacity; probed += CONTROL_GROUP_SIZE)
+    {
+        const u8* group = set->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
+        {
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (value_cmp(set->cells[candidate].key, key) == 0)
+            {
+                return candidate;
+            }
+        }
+        if (control_match_empty(group))
+        {
+            break;
+        }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+    return set->capacity;
+}
+
+u32 set_find_char_ptr(SetCharPtr* set, const char* key, const u64 hash)
+{
+    const u32 capacity_mask = set->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(set->cells + index);
+    for (u32 probed = 0; probed < set->capacity; probed += CONTROL_GROUP_SIZE)
+    {
+        const u8* group = set->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
+        {
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (strcmp(set->cells[candidate].key, key) == 0)
+            {
+                return candidate;
+            }
+        }
+        if (control_match_empty(group))
+        {
+            break;
+        }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+    return set->capacity;
+}
+
+u32 set_find_guid(SetGuid* set, const FticGUID key, const u64 hash)
+{
+    const u32 capacity_mask = set->capacity - 1;
+    const u8 tag = control_tag(hash);
+    u32 index = control_home(hash, capacity_mask);
+    // Most keys sit in their home cell, start loading it with the control bytes.
+    control_prefetch(set->cells + index);
+    for (u32 probed = 0; probed < set->capacity; probed += CONTROL_GROUP_SIZE)
+    {
+        const u8* group = set->control + index;
+        for (u32 matches = control_match(group, tag); matches; matches &= matches - 1)
+        {
+            const u32 candidate = (index + control_first_bit(matches)) & capacity_mask;
+            if (guid_compare(set->cells[candidate].key, key) == 0)
+            {
+                return candidate;
+            }
+        }
+        if (control_match_empty(group))
+        {
+            break;
+        }
+        index = (index + CONTROL_GROUP_SIZE) & capacity_mask;
+    }
+    return set->capacity;
 }
 
 b8 set_contains_u64(SetU64* set, const u64 key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellU64* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (value_cmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (value_cmp(cell->key, key) == 0) 
-                    { 
-                        return true; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            return true; 
-        } 
-    } 
-    return false; 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    return set_find_u64(set, key, hash) < set->capacity;
 }
 
 b8 set_contains_char_ptr(SetCharPtr* set, const char* key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellCharPtr* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (strcmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (strcmp(cell->key, key) == 0) 
-                    { 
-                        return true; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            return true; 
-        } 
-    } 
-    return false; 
+{
+    const u64 hash = set->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    return set_find_char_ptr(set, key, hash) < set->capacity;
 }
 
 b8 set_contains_guid(SetGuid* set, const FticGUID key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellGuid* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (guid_compare(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (guid_compare(cell->key, key) == 0) 
-                    { 
-                        return true; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            return true; 
-        } 
-    } 
-    return false; 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    return set_find_guid(set, key, hash) < set->capacity;
 }
 
 SetCellU64* set_remove_u64(SetU64* set, const u64 key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellU64* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (value_cmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (value_cmp(cell->key, key) == 0) 
-                    { 
-                        cell->active = false; 
-                        cell->deleted = true; 
-                        set->size--; 
-                        return cell; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            cell->active = false; 
-            cell->deleted = true; 
-            set->size--; 
-            return cell; 
-        } 
-    } 
-    return NULL; 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 hole = set_find_u64(set, key, hash);
+    if (hole == set->capacity)
+    {
+        return NULL;
+    }
+    set->removed = set->cells[hole];
+
+    const u32 capacity_mask = set->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(set->control[next]);
+         next = (next + 1) & capacity_mask)
+    {
+        SetCellU64* cell = set->cells + next;
+        const u64 cell_hash = set->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
+        {
+            set->cells[hole] = *cell;
+            control_set(set->control, hole, set->control[next], set->capacity);
+            hole = next;
+        }
+    }
+    control_set(set->control, hole, CONTROL_EMPTY, set->capacity);
+    set->size--;
+    return &set->removed;
 }
 
 SetCellCharPtr* set_remove_char_ptr(SetCharPtr* set, const char* key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)strlen(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellCharPtr* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (strcmp(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (strcmp(cell->key, key) == 0) 
-                    { 
-                        cell->active = false; 
-                        cell->deleted = true; 
-                        set->size--; 
-                        return cell; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            cell->active = false; 
-            cell->deleted = true; 
-            set->size--; 
-            return cell; 
-        } 
-    } 
-    return NULL; 
+{
+    const u64 hash = set->hash_function(&key, (u32)strlen(key), HASH_SEED);
+    u32 hole = set_find_char_ptr(set, key, hash);
+    if (hole == set->capacity)
+    {
+        return NULL;
+    }
+    set->removed = set->cells[hole];
+
+    const u32 capacity_mask = set->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(set->control[next]);
+         next = (next + 1) & capacity_mask)
+    {
+        SetCellCharPtr* cell = set->cells + next;
+        const u64 cell_hash = set->hash_function(&cell->key, (u32)strlen(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
+        {
+            set->cells[hole] = *cell;
+            control_set(set->control, hole, set->control[next], set->capacity);
+            hole = next;
+        }
+    }
+    control_set(set->control, hole, CONTROL_EMPTY, set->capacity);
+    set->size--;
+    return &set->removed;
 }
 
 SetCellGuid* set_remove_guid(SetGuid* set, const FticGUID key)
-{ 
-    u32 capacity_mask = set->capacity - 1; 
-    u64 hashed_index = 
-        set->hash_function(&key, (u32)sizeof(key), HASH_SEED) & capacity_mask; 
- 
-    SetCellGuid* cell = set->cells + hashed_index; 
-    if (cell->active || cell->deleted) 
-    { 
-        if (guid_compare(cell->key, key) != 0) 
-        { 
-            cell = set->cells + (++hashed_index & capacity_mask); 
-            for (u32 i = 0; 
-                 i < set->capacity && (cell->active || cell->deleted); ++i) 
-            { 
-                if (cell->active) 
-                { 
-                    if (guid_compare(cell->key, key) == 0) 
-                    { 
-                        cell->active = false; 
-                        cell->deleted = true; 
-                        set->size--; 
-                        return cell; 
-                    } 
-                } 
-                cell = set->cells + (++hashed_index & capacity_mask); 
-            } 
-        } 
-        else if(cell->active) 
-        { 
-            cell->active = false; 
-            cell->deleted = true; 
-            set->size--; 
-            return cell; 
-        } 
-    } 
-    return NULL; 
+{
+    const u64 hash = set->hash_function(&key, (u32)sizeof(key), HASH_SEED);
+    u32 hole = set_find_guid(set, key, hash);
+    if (hole == set->capacity)
+    {
+        return NULL;
+    }
+    set->removed = set->cells[hole];
+
+    const u32 capacity_mask = set->capacity - 1;
+    for (u32 next = (hole + 1) & capacity_mask; control_is_full(set->control[next]);
+         next = (next + 1) & capacity_mask)
+    {
+        SetCellGuid* cell = set->cells + next;
+        const u64 cell_hash = set->hash_function(&cell->key, (u32)sizeof(cell->key), HASH_SEED);
+        const u32 home = control_home(cell_hash, capacity_mask);
+        if (((next - home) & capacity_mask) >= ((next - hole) & capacity_mask))
+        {
+            set->cells[hole] = *cell;
+            control_set(set->control, hole, set->control[next], set->capacity);
+            hole = next;
+        }
+    }
+    control_set(set->control, hole, CONTROL_EMPTY, set->capacity);
+    set->size--;
+    return &set->removed;
 }
 
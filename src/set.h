@@ -9,51 +9,57 @@
 // @end
 
 typedef struct SetCellU64
-{ 
-    u64 key; 
-    bool active; 
-    bool deleted; 
+{
+    u64 key;
 } SetCellU64;
 
 typedef struct SetCellCharPtr
-{ 
-    char* key; 
-    bool active; 
-    bool deleted; 
+{
+    char* key;
 } SetCellCharPtr;
 
 typedef struct SetCellGuid
-{ 
-    FticGUID key; 
-    bool active; 
-    bool deleted; 
+{
+    FticGUID key;
 } SetCellGuid;
 
 typedef struct SetU64
-{ 
-    SetCellU64* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    SetCellU64* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    SetCellU64 removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } SetU64;
 
 typedef struct SetCharPtr
-{ 
-    SetCellCharPtr* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    SetCellCharPtr* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    SetCellCharPtr removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } SetCharPtr;
 
 typedef struct SetGuid
-{ 
-    SetCellGuid* cells; 
-    u32 size; 
-    u32 capacity; 
- 
-    u64 (*hash_function)(const void* key, u32 len, u64 seed); 
+{
+    SetCellGuid* cells;
+    u8* control;
+    u32 size;
+    u32 capacity;
+
+    // Copy of the last removed cell, the slot itself is reused on removal.
+    SetCellGuid removed;
+
+    u64 (*hash_function)(const void* key, u32 len, u64 seed);
 } SetGuid;
 
 SetU64 set_create_u64(u32 capacity, u64 (*hash_function)(const void* key, u32 len, u64 seed));
@@ -68,12 +74,24 @@ void set_clear_char_ptr(SetCharPtr* set);
 
 void set_clear_guid(SetGuid* set);
 
+void set_free_u64(SetU64* set);
+
+void set_free_char_ptr(SetCharPtr* set);
+
+void set_free_guid(SetGuid* set);
+
 void set_insert_u64(SetU64* set, u64 key);
 
 void set_insert_char_ptr(SetCharPtr* set, char* key);
 
 void set_insert_guid(SetGuid* set, FticGUID key);
 
+u32 set_find_u64(SetU64* set, const u64 key, const u64 hash);
+
+u32 set_find_char_ptr(SetCharPtr* set, const char* key, const u64 hash);
+
+u32 set_find_guid(SetGuid* set, const FticGUID key, const u64 hash);
+
 b8 set_contains_u64(SetU64* set, const u64 key);
 
 b8 set_contains_char_ptr(SetCharPtr* set, const char* key);
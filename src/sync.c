@@ -0,0 +1,122 @@
+#include "sync.h"
+#include "platform/platform.h"
+
+#define SYNC_FREE 0
+#define SYNC_LOCKED 1
+#define SYNC_SLEEPERS 2
+
+void sync_mutex_lock(SyncMutex* mutex)
+{
+    u32 state = ftic_atomic_compare_exchange32(&mutex->state, SYNC_LOCKED, SYNC_FREE);
+    if (state == SYNC_FREE)
+    {
+        return;
+    }
+
+    // The lock is usually held for a short while, so spin before sleeping.
+    // No point once there are sleepers, the lock goes to one of them.
+    const u32 spin = ftic_atomic_load32(&mutex->spin);
+    const u32 spin_limit = ftic_min(spin * 2 + 16, (u32)SYNC_MUTEX_MAX_SPIN);
+    u32 spun = 0;
+    for (; spun < spin_limit && state == SYNC_LOCKED; ++spun)
+    {
+        ftic_atomic_pause();
+        state = ftic_atomic_load32(&mutex->state);
+        if (state == SYNC_FREE)
+        {
+            state = ftic_atomic_compare_exchange32(&mutex->state, SYNC_LOCKED, SYNC_FREE);
+            if (state == SYNC_FREE)
+            {
+                ftic_atomic_store32(&mutex->spin, spin + ((i32)(spun - spin) / 8));
+                return;
+            }
+        }
+    }
+    ftic_atomic_store32(&mutex->spin, spin + ((i32)(spun - spin) / 8));
+
+    // Whoever unlocks a mutex marked with sleepers wakes one of them. A woken
+    // thread marks it again, it can not know if it was the last one.
+    if (state != SYNC_SLEEPERS)
+    {
+        state = ftic_atomic_exchange32(&mutex->state, SYNC_SLEEPERS);
+    }
+    while (state != SYNC_FREE)
+    {
+        platform_futex_wait(&mutex->state, SYNC_SLEEPERS);
+        state = ftic_atomic_exchange32(&mutex->state, SYNC_SLEEPERS);
+    }
+}
+
+b8 sync_mutex_try_lock(SyncMutex* mutex)
+{
+    return ftic_atomic_compare_exchange32(&mutex->state, SYNC_LOCKED, SYNC_FREE) == SYNC_FREE;
+}
+
+void sync_mutex_unlock(SyncMutex* mutex)
+{
+    if (ftic_atomic_exchange32(&mutex->state, SYNC_FREE) == SYNC_SLEEPERS)
+    {
+        platform_futex_wake_one(&mutex->state);
+    }
+}
+
+// A signal bumps the sequence, so a waiter that read it before unlocking
+// either sees the change and does not sleep or is woken.
+void sync_condition_wait(SyncCondition* condition, SyncMutex* mutex)
+{
+    const u32 sequence = ftic_atomic_load32(&condition->sequence);
+    ftic_atomic_add32(&condition->waiters, 1);
+    sync_mutex_unlock(mutex);
+    platform_futex_wait(&condition->sequence, sequence);
+    ftic_atomic_add32(&condition->waiters, (u32)-1);
+    sync_mutex_lock(mutex);
+}
+
+void sync_condition_signal(SyncCondition* condition)
+{
+    ftic_atomic_add32(&condition->sequence, 1);
+    if (ftic_atomic_load32(&condition->waiters))
+    {
+        platform_futex_wake_one(&condition->sequence);
+    }
+}
+
+void sync_condition_broadcast(SyncCondition* condition)
+{
+    ftic_atomic_add32(&condition->sequence, 1);
+    if (ftic_atomic_load32(&condition->waiters))
+    {
+        platform_futex_wake_all(&condition->sequence);
+    }
+}
+
+u32 sync_event_count_prepare_wait(SyncEventCount* event_count)
+{
+    ftic_atomic_add32(&event_count->waiters, 1);
+    return ftic_atomic_load32(&event_count->epoch);
+}
+
+void sync_event_count_cancel_wait(SyncEventCount* event_count)
+{
+    ftic_atomic_add32(&event_count->waiters, (u32)-1);
+}
+
+void sync_event_count_wait(SyncEventCount* event_count, u32 key)
+{
+    while (ftic_atomic_load32(&event_count->epoch) == key)
+    {
+        platform_futex_wait(&event_count->epoch, key);
+    }
+    ftic_atomic_add32(&event_count->waiters, (u32)-1);
+}
+
+// The waiter registers before it checks the state and the notifier changes
+// the state before it checks for waiters, so one of them sees the other.
+void sync_event_count_notify(SyncEventCount* event_count)
+{
+    if (ftic_atomic_load32(&event_count->waiters))
+    {
+        ftic_atomic_add32(&event_count->epoch, 1);
+        platform_futex_wake_all(&event_count->epoch);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "define.h"
+#include "ftic_atomic.h"
+
+// Times a contended lock checks the mutex before it sleeps, the limit moves
+// towards what it took to get the lock the last times.
+#define SYNC_MUTEX_MAX_SPIN 256
+
+// Futex based mutex. Taking a free lock is one compare exchange and the
+// kernel is only entered when a thread has to sleep or wake a sleeper.
+typedef struct SyncMutex
+{
+    FTicAtomic32 state; // 0 free, 1 locked, 2 locked with sleepers
+    FTicAtomic32 spin;  // Adaptive spin limit, only a hint
+} SyncMutex;
+
+typedef struct SyncCondition
+{
+    FTicAtomic32 sequence;
+    FTicAtomic32 waiters;
+} SyncCondition;
+
+// Lets a thread sleep until some lock free state changes:
+//
+//     u32 key = sync_event_count_prepare_wait(&event_count);
+//     if (ready()) sync_event_count_cancel_wait(&event_count);
+//     else sync_event_count_wait(&event_count, key);
+//
+// The thread making ready() true calls sync_event_count_notify after it,
+// which costs one load when nobody waits.
+typedef struct SyncEventCount
+{
+    FTicAtomic32 epoch;
+    FTicAtomic32 waiters;
+} SyncEventCount;
+
+void sync_mutex_lock(SyncMutex* mutex);
+b8 sync_mutex_try_lock(SyncMutex* mutex);
+void sync_mutex_unlock(SyncMutex* mutex);
+
+// Unlocks the mutex while waiting, may return without a signal.
+void sync_condition_wait(SyncCondition* condition, SyncMutex* mutex);
+void sync_condition_signal(SyncCondition* condition);
+void sync_condition_broadcast(SyncCondition* condition);
+
+u32 sync_event_count_prepare_wait(SyncEventCount* event_count);
+void sync_event_count_cancel_wait(SyncEventCount* event_count);
+void sync_event_count_wait(SyncEventCount* event_count, u32 key);
+void sync_event_count_notify(SyncEventCount* event_count);
@@ -76,6 +76,12 @@ u32 texture_create(const TextureProperties* texture_properties, int internal_for
     return texture;
 }
 
+void texture_update_sub_image(u32 texture, i32 x, i32 y, i32 width, i32 height, u32 format,
+                              const u8* bytes)
+{
+    glTextureSubImage2D(texture, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, bytes);
+}
+
 void texture_bind(u32 texture, int slot)
 {
     // glActiveTexture(GL_TEXTURE0 + slot);
@@ -22,17 +22,12 @@ typedef struct IdTexturePropertiesArray
     IdTextureProperties* data;
 }IdTexturePropertiesArray;
 
-typedef struct SafeIdTexturePropertiesArray
-{
-    IdTexturePropertiesArray array;
-    FTicMutex mutex;
-} SafeIdTexturePropertiesArray;
-
 void texture_load_full_path(const char* file_path, TextureProperties* texture_properties);
 void texture_load(const char* file_path, TextureProperties* texture_properties);
 void texture_scale_down(i32 width, i32 height, i32* new_width, i32* new_height);
 void texture_resize(TextureProperties* texture_properties, int box_width, int box_height);
 u32 texture_create(const TextureProperties* texture_properties, int internal_format, u32 format, int param);
+void texture_update_sub_image(u32 texture, i32 x, i32 y, i32 width, i32 height, u32 format, const u8* bytes);
 void texture_bind(u32 texture, int slot);
 void texture_unbind(int slot);
 void texture_delete(u32 texture);
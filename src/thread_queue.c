@@ -2,16 +2,108 @@
 #include "platform/platform.h"
 #include "logging.h"
 #include "hash.h"
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
 u32 global_thread_count = 0;
 
-ThreadTask thread_task(void (*task_callback)(void* data), void* data)
+ThreadTask thread_task_(void (*task_callback)(void* data), void* data, const char* name)
 {
-    ThreadTask task = { .task_callback = task_callback, .data = data };
+    ThreadTask task = { .task_callback = task_callback, .data = data, .name = name };
     return task;
 }
 
+internal void thread_histogram_add(ThreadHistogram* histogram, const i64 us)
+{
+    u32 bucket = 0;
+    while (bucket < THREAD_HISTOGRAM_BUCKETS - 1 && (1LL << bucket) <= us)
+    {
+        ++bucket;
+    }
+    ftic_atomic_add(&histogram->buckets[bucket], 1);
+    ftic_atomic_add(&histogram->count, 1);
+    ftic_atomic_add64(&histogram->total_us, us);
+
+    const long value = (long)ftic_min(us, (i64)LONG_MAX);
+    long max = ftic_atomic_load(&histogram->max_us);
+    while (value > max)
+    {
+        const long previous = ftic_atomic_compare_exchange(&histogram->max_us, value, max);
+        if (previous == max)
+        {
+            break;
+        }
+        max = previous;
+    }
+}
+
+f64 thread_histogram_mean_us(const ThreadHistogram* histogram)
+{
+    return histogram->count ? (f64)histogram->total_us / histogram->count : 0.0;
+}
+
+f64 thread_histogram_percentile_us(const ThreadHistogram* histogram, f64 fraction)
+{
+    const f64 target = fraction * histogram->count;
+    f64 seen = 0.0;
+    for (u32 i = 0; i < THREAD_HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= target && seen > 0.0)
+        {
+            return (f64)(1LL << i);
+        }
+    }
+    return (f64)histogram->max_us;
+}
+
+// Called with the queue mutex held, so only readers race with the insert and
+// kind_count is bumped after the entry is filled in.
+internal u32 thread_telemetry_kind(ThreadTelemetry* telemetry, const ThreadTask* task)
+{
+    const u32 kind_count = (u32)telemetry->kind_count;
+    for (u32 i = 0; i < kind_count; ++i)
+    {
+        if (telemetry->kinds[i].task_callback == task->task_callback)
+        {
+            return i;
+        }
+    }
+    if (kind_count == THREAD_TASK_KIND_CAPACITY)
+    {
+        return THREAD_TASK_KIND_CAPACITY - 1;
+    }
+    ThreadTaskKind* kind = telemetry->kinds + kind_count;
+    if (kind_count == THREAD_TASK_KIND_CAPACITY - 1)
+    {
+        kind->name = "other";
+    }
+    else
+    {
+        kind->task_callback = task->task_callback;
+        kind->name = task->name ? task->name : "unnamed";
+    }
+    ftic_atomic_store(&telemetry->kind_count, (long)kind_count + 1);
+    return kind_count;
+}
+
+internal void thread_telemetry_record(ThreadTelemetry* telemetry, ThreadWorkerStats* worker,
+                                      const ThreadTaskInternal* task, const f64 start,
+                                      const f64 end)
+{
+    const i64 wait_us = (i64)((start - task->push_time) * 1000000.0);
+    const i64 run_us = (i64)((end - start) * 1000000.0);
+    ThreadTaskKind* kind = telemetry->kinds + task->kind;
+    thread_histogram_add(&kind->wait, wait_us);
+    thread_histogram_add(&kind->run, run_us);
+    thread_histogram_add(&telemetry->wait, wait_us);
+    thread_histogram_add(&telemetry->run, run_us);
+    ftic_atomic_add(&telemetry->completed, 1);
+    ftic_atomic_add64(&worker->busy_us, run_us);
+    ftic_atomic_add(&worker->tasks_run, 1);
+}
+
 void semaphore_counter_wait(SemaphoreCounter* semaphore_counter)
 {
     if (semaphore_counter->count)
@@ -32,31 +124,38 @@ void semaphore_counter_wait_and_free(SemaphoreCounter* semaphore_counter)
     free(semaphore_counter->semaphore);
 }
 
-void thread_task_push_(ThreadTaskQueue* task_queue, ThreadTask task, FTicSemaphore* semaphore)
+// Called with the queue mutex held. False if the queue is full and the task
+// was dropped.
+internal b8 thread_task_push(ThreadTaskQueue* task_queue, ThreadTask task,
+                             FTicSemaphore* semaphore)
 {
-    platform_semaphore_wait_and_decrement(&task_queue->mutex);
-
-    // static u32 value = 0;
-    // log_u64(" ", value++);
-
     // TODO: make it growing or something else
+    ThreadTelemetry* telemetry = &task_queue->telemetry;
     if (task_queue->size < task_queue->capacity)
     {
         task_queue->tail %= task_queue->capacity;
-        task_queue->tasks[task_queue->tail] =
-            (ThreadTaskInternal){ .task = task, .semaphore = semaphore };
+        task_queue->tasks[task_queue->tail] = (ThreadTaskInternal){
+            .task = task,
+            .semaphore = semaphore,
+            .push_time = platform_get_time(),
+            .kind = thread_telemetry_kind(telemetry, &task),
+        };
 
         task_queue->tail++;
         task_queue->size++;
+        ftic_atomic_add(&telemetry->pushed, 1);
+        if ((long)task_queue->size > ftic_atomic_load(&telemetry->max_depth))
+        {
+            ftic_atomic_store(&telemetry->max_depth, (long)task_queue->size);
+        }
+        return true;
     }
-
-    platform_semaphore_increment(&task_queue->start_semaphore, NULL);
-
-    platform_semaphore_increment(&task_queue->mutex, NULL);
+    ftic_atomic_add(&telemetry->dropped, 1);
+    return false;
 }
 
-void thread_tasks_push(ThreadTaskQueue* task_queue, ThreadTask* tasks, u32 task_count,
-                       SemaphoreCounter* semaphore_counter)
+u32 thread_tasks_push(ThreadTaskQueue* task_queue, ThreadTask* tasks, u32 task_count,
+                      SemaphoreCounter* semaphore_counter)
 {
     if (semaphore_counter)
     {
@@ -67,53 +166,68 @@ void thread_tasks_push(ThreadTaskQueue* task_queue, ThreadTask* tasks, u32 task_
         }
         semaphore_counter->count = task_count;
     }
+    sync_mutex_lock(&task_queue->mutex);
+    u32 pushed = 0;
     for (u32 i = 0; i < task_count; i++)
     {
-        thread_task_push_(task_queue, tasks[i],
-                          semaphore_counter ? semaphore_counter->semaphore : NULL);
+        pushed += thread_task_push(task_queue, tasks[i],
+                                   semaphore_counter ? semaphore_counter->semaphore : NULL);
+    }
+    sync_mutex_unlock(&task_queue->mutex);
+    if (semaphore_counter)
+    {
+        // Only the tasks that made it into the queue will signal.
+        semaphore_counter->count = pushed;
+    }
+
+    // Without sleeping workers a signal is an add and a load.
+    for (u32 i = 0; i < pushed; i++)
+    {
+        sync_condition_signal(&task_queue->task_pushed);
     }
+    return pushed;
 }
 
+// Called with the queue mutex held and at least one task queued.
 internal ThreadTaskInternal thread_task_pop(ThreadTaskQueue* task_queue)
 {
-    platform_semaphore_wait_and_decrement(&task_queue->mutex);
-    ThreadTaskInternal task = { 0 };
-    if (task_queue->size)
-    {
-        task_queue->head %= task_queue->capacity;
-        task = task_queue->tasks[task_queue->head];
+    task_queue->head %= task_queue->capacity;
+    ThreadTaskInternal task = task_queue->tasks[task_queue->head];
 
-        task_queue->head++;
-        task_queue->size--;
-    }
-    platform_semaphore_increment(&task_queue->mutex, NULL);
+    task_queue->head++;
+    task_queue->size--;
     return task;
 }
 
 thread_return_value thread_loop(void* data)
 {
     ThreadAttrib* attrib = (ThreadAttrib*)data;
+    ThreadTaskQueue* task_queue = attrib->queue;
 
     for (;;)
     {
         // TODO: one more mutex that can be used to pause the threads
-        if (platform_interlock_compare_exchange(&attrib->stop_flag, 0, 0))
+        sync_mutex_lock(&task_queue->mutex);
+        while (!task_queue->size && !ftic_atomic_load(&attrib->stop_flag))
         {
-            break;
+            sync_condition_wait(&task_queue->task_pushed, &task_queue->mutex);
+            if (!task_queue->size)
+            {
+                ftic_atomic_add(&task_queue->telemetry.empty_wakeups, 1);
+            }
         }
-
-        platform_semaphore_wait_and_decrement(attrib->start_semaphore);
-
-        if (platform_interlock_compare_exchange(&attrib->stop_flag, 0, 0))
+        if (ftic_atomic_load(&attrib->stop_flag))
         {
+            sync_mutex_unlock(&task_queue->mutex);
             break;
         }
+        ThreadTaskInternal task = thread_task_pop(task_queue);
+        sync_mutex_unlock(&task_queue->mutex);
 
-        ThreadTaskInternal task = thread_task_pop(attrib->queue);
-        if (task.task.task_callback)
-        {
-            task.task.task_callback(task.task.data);
-        }
+        const f64 start = platform_get_time();
+        task.task.task_callback(task.task.data);
+        thread_telemetry_record(&task_queue->telemetry, attrib->stats, &task, start,
+                                platform_get_time());
 
         if (task.semaphore)
         {
@@ -125,24 +239,201 @@ thread_return_value thread_loop(void* data)
 
 u64 thread_get_task_count(ThreadTaskQueue* task_queue, u64 id)
 {
-    platform_semaphore_wait_and_decrement(&task_queue->mutex);
+    sync_mutex_lock(&task_queue->mutex);
+    u64 count = 0;
+    for (u32 i = 0; i < task_queue->size; ++i)
+    {
+        const u32 index = (task_queue->head + i) % task_queue->capacity;
+        count += task_queue->tasks[index].task.id == id;
+    }
+    sync_mutex_unlock(&task_queue->mutex);
 
-    platform_semaphore_increment(&task_queue->mutex, NULL);
+    return count;
+}
 
-    return 0;
+ThreadChannel* thread_channel_create(u32 element_size, u32 capacity,
+                                     void (*free_element)(void* element))
+{
+    u32 power_of_two = 1;
+    while (power_of_two < capacity)
+    {
+        power_of_two <<= 1;
+    }
+    capacity = power_of_two;
+
+    ThreadChannel* channel = (ThreadChannel*)calloc(
+        1, sizeof(ThreadChannel) + capacity * (sizeof(FTicAtomic) + (u64)element_size));
+    channel->sequences = (FTicAtomic*)(channel + 1);
+    channel->data = (u8*)(channel->sequences + capacity);
+    channel->free_element = free_element;
+    channel->element_size = element_size;
+    channel->capacity = capacity;
+    ftic_atomic_store(&channel->reference_count, 1);
+    // A slot is free for position p when its sequence is p and holds the
+    // element of p when it is p + 1.
+    for (u32 i = 0; i < capacity; ++i)
+    {
+        ftic_atomic_store(&channel->sequences[i], (long)i);
+    }
+    return channel;
 }
 
-void thread_tasks_clear(ThreadQueue* thread_queue)
+void thread_channel_retain(ThreadChannel* channel)
+{
+    ftic_atomic_add(&channel->reference_count, 1);
+}
+
+void thread_channel_release(ThreadChannel* channel)
 {
-    platform_semaphore_wait_and_decrement(&thread_queue->task_queue.mutex);
-    for (i32 i = 0; i < ((i32)thread_queue->task_queue.size) - ((i32)thread_queue->pool_size); ++i)
+    if (ftic_atomic_add(&channel->reference_count, -1) != 1)
     {
-        platform_semaphore_wait_and_decrement(thread_queue->task_queue.start_semaphore);
+        return;
     }
+    if (channel->free_element)
+    {
+        void* element = malloc(channel->element_size);
+        while (thread_channel_drain(channel, element, 1))
+        {
+            channel->free_element(element);
+        }
+        free(element);
+    }
+    free(channel);
+}
 
-    thread_queue->task_queue.head = 0;
-    thread_queue->task_queue.size = 0;
-    platform_semaphore_increment(&thread_queue->task_queue.mutex, NULL);
+// Producers waiting for space wake up and see it closed.
+void thread_channel_close(ThreadChannel* channel)
+{
+    ftic_atomic_store(&channel->closed, 1);
+    sync_event_count_notify(&channel->space);
+}
+
+b8 thread_channel_push(ThreadChannel* channel, const void* elements, u32 count)
+{
+    const u8* from = (const u8*)elements;
+    const u32 mask = channel->capacity - 1;
+    while (count)
+    {
+        const u32 batch = ftic_min(count, channel->capacity);
+        u32 position = 0;
+        for (;;)
+        {
+            if (ftic_atomic_load(&channel->closed))
+            {
+                return false;
+            }
+            position = (u32)ftic_atomic_load(&channel->tail);
+
+            // The consumer frees the slots in order, so when the last slot of
+            // the batch is free all of them are.
+            const u32 last = position + batch - 1;
+            const u32 sequence = (u32)ftic_atomic_load(&channel->sequences[last & mask]);
+            const i32 difference = (i32)(sequence - last);
+            if (difference == 0)
+            {
+                if ((u32)ftic_atomic_compare_exchange(&channel->tail, (long)(position + batch),
+                                                      (long)position) == position)
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Full. Sleep until the consumer frees the slot, which it only
+                // announces to registered waiters, so look again after
+                // registering.
+                const u32 key = sync_event_count_prepare_wait(&channel->space);
+                if ((u32)ftic_atomic_load(&channel->tail) == position &&
+                    (i32)((u32)ftic_atomic_load(&channel->sequences[last & mask]) - last) < 0 &&
+                    !ftic_atomic_load(&channel->closed))
+                {
+                    sync_event_count_wait(&channel->space, key);
+                }
+                else
+                {
+                    sync_event_count_cancel_wait(&channel->space);
+                }
+            }
+        }
+        for (u32 i = 0; i < batch; ++i)
+        {
+            const u32 slot = (position + i) & mask;
+            memcpy(channel->data + (u64)slot * channel->element_size,
+                   from + (u64)i * channel->element_size, channel->element_size);
+            ftic_atomic_store(&channel->sequences[slot], (long)(position + i + 1));
+        }
+        from += (u64)batch * channel->element_size;
+        count -= batch;
+    }
+    return true;
+}
+
+u32 thread_channel_drain(ThreadChannel* channel, void* elements, u32 max_count)
+{
+    u8* to = (u8*)elements;
+    const u32 mask = channel->capacity - 1;
+    u32 position = channel->head;
+    u32 count = 0;
+    for (; count < max_count; ++count, ++position)
+    {
+        const u32 slot = position & mask;
+        const u32 sequence = (u32)ftic_atomic_load(&channel->sequences[slot]);
+        if (sequence != position + 1)
+        {
+            break;
+        }
+        memcpy(to + (u64)count * channel->element_size,
+               channel->data + (u64)slot * channel->element_size, channel->element_size);
+        ftic_atomic_store(&channel->sequences[slot], (long)(position + channel->capacity));
+    }
+    channel->head = position;
+    if (count)
+    {
+        sync_event_count_notify(&channel->space);
+    }
+    return count;
+}
+
+u32 thread_get_queue_depth(ThreadTaskQueue* task_queue)
+{
+    sync_mutex_lock(&task_queue->mutex);
+    const u32 size = task_queue->size;
+    sync_mutex_unlock(&task_queue->mutex);
+    return size;
+}
+
+// Kinds are kept, queued tasks refer to them by index.
+void thread_telemetry_reset(ThreadTaskQueue* task_queue)
+{
+    sync_mutex_lock(&task_queue->mutex);
+    ThreadTelemetry* telemetry = &task_queue->telemetry;
+    for (u32 i = 0; i < THREAD_TASK_KIND_CAPACITY; ++i)
+    {
+        memset(&telemetry->kinds[i].wait, 0, sizeof(ThreadHistogram));
+        memset(&telemetry->kinds[i].run, 0, sizeof(ThreadHistogram));
+    }
+    memset(&telemetry->wait, 0, sizeof(ThreadHistogram));
+    memset(&telemetry->run, 0, sizeof(ThreadHistogram));
+    ftic_atomic_store(&telemetry->pushed, 0);
+    ftic_atomic_store(&telemetry->completed, 0);
+    ftic_atomic_store(&telemetry->dropped, 0);
+    ftic_atomic_store(&telemetry->cleared, 0);
+    ftic_atomic_store(&telemetry->empty_wakeups, 0);
+    ftic_atomic_store(&telemetry->max_depth, (long)task_queue->size);
+    memset(telemetry->workers, 0, telemetry->worker_count * sizeof(ThreadWorkerStats));
+    telemetry->start_time = platform_get_time();
+    sync_mutex_unlock(&task_queue->mutex);
+}
+
+void thread_tasks_clear(ThreadQueue* thread_queue)
+{
+    ThreadTaskQueue* task_queue = &thread_queue->task_queue;
+    sync_mutex_lock(&task_queue->mutex);
+    ftic_atomic_add(&task_queue->telemetry.cleared, (long)task_queue->size);
+    task_queue->head = 0;
+    task_queue->tail = 0;
+    task_queue->size = 0;
+    sync_mutex_unlock(&task_queue->mutex);
 }
 
 void thread_initialize(u32 capacity, u32 thread_count, ThreadQueue* queue)
@@ -153,19 +444,19 @@ void thread_initialize(u32 capacity, u32 thread_count, ThreadQueue* queue)
     queue->attribs = (ThreadAttrib*)calloc(thread_count, sizeof(ThreadAttrib));
     global_thread_count = thread_count;
 
-    FTicSemaphore start_semaphore = platform_semaphore_create(0, capacity);
-    FTicSemaphore mutex = platform_semaphore_create(1, capacity);
-    queue->task_queue.start_semaphore = start_semaphore;
-    queue->task_queue.mutex = mutex;
     queue->task_queue.capacity = capacity;
     queue->task_queue.tasks =
         (ThreadTaskInternal*)calloc(queue->task_queue.capacity, sizeof(ThreadTaskInternal));
+    queue->task_queue.telemetry.workers =
+        (ThreadWorkerStats*)calloc(thread_count, sizeof(ThreadWorkerStats));
+    queue->task_queue.telemetry.worker_count = thread_count;
+    queue->task_queue.telemetry.start_time = platform_get_time();
 
     for (u32 i = 0; i < thread_count; i++)
     {
         ThreadAttrib* ta = queue->attribs + i;
-        ta->start_semaphore = &queue->task_queue.start_semaphore;
         ta->queue = &queue->task_queue;
+        ta->stats = queue->task_queue.telemetry.workers + i;
         ta->stop_flag = 0;
         ta->id = i;
         queue->pool[i] = platform_thread_create(ta, thread_loop, 0, NULL);
@@ -175,14 +466,15 @@ void thread_initialize(u32 capacity, u32 thread_count, ThreadQueue* queue)
 void threads_uninitialize(ThreadQueue* queue)
 {
     const u32 thread_count = queue->pool_size;
+    // Under the mutex, a worker checks the flag and goes to sleep atomically
+    // with respect to it.
+    sync_mutex_lock(&queue->task_queue.mutex);
     for (u32 i = 0; i < thread_count; i++)
     {
-        platform_interlock_exchange(&queue->attribs[i].stop_flag, 1);
-    }
-    for (u32 i = 0; i < thread_count; i++)
-    {
-        platform_semaphore_increment(&queue->task_queue.start_semaphore, NULL);
+        ftic_atomic_store(&queue->attribs[i].stop_flag, 1);
     }
+    sync_condition_broadcast(&queue->task_queue.task_pushed);
+    sync_mutex_unlock(&queue->task_queue.mutex);
     for (u32 i = 0; i < thread_count; i++)
     {
         // TODO: This might not be a good idea. Should only be called on program
@@ -194,6 +486,5 @@ void threads_uninitialize(ThreadQueue* queue)
     free(queue->pool);
     free(queue->attribs);
     free(queue->task_queue.tasks);
-    platform_semaphore_destroy(&queue->task_queue.start_semaphore);
-    platform_semaphore_destroy(&queue->task_queue.mutex);
+    free(queue->task_queue.telemetry.workers);
 }
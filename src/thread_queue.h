@@ -1,43 +1,98 @@
 #pragma once
 #include "define.h"
 #include "hash_table.h"
+#include "sync.h"
+
+// Histogram buckets are powers of two in microseconds, bucket i counts
+// samples below 2^i us. The last one takes everything longer.
+#define THREAD_HISTOGRAM_BUCKETS 24
+// Task kinds are told apart by callback, later ones share the last entry.
+#define THREAD_TASK_KIND_CAPACITY 32
 
 typedef struct ThreadTask
 {
     u64 id;
     void (*task_callback)(void* data);
     void* data;
+    const char* name;
 } ThreadTask;
 
 typedef struct ThreadTaskInternal
 {
     ThreadTask task;
     FTicSemaphore* semaphore;
+    f64 push_time;
+    u32 kind;
 } ThreadTaskInternal;
 
+typedef struct ThreadHistogram
+{
+    FTicAtomic buckets[THREAD_HISTOGRAM_BUCKETS];
+    FTicAtomic count;
+    FTicAtomic max_us;
+    FTicAtomic64 total_us;
+} ThreadHistogram;
+
+typedef struct ThreadTaskKind
+{
+    const char* name;
+    void (*task_callback)(void* data);
+    ThreadHistogram wait;
+    ThreadHistogram run;
+} ThreadTaskKind;
+
+// Only written by its own worker.
+typedef struct ThreadWorkerStats
+{
+    FTicAtomic64 busy_us;
+    FTicAtomic tasks_run;
+} ThreadWorkerStats;
+
+// Counters since thread_initialize or the last reset. Wait is the time from
+// push until a worker starts the task, run is the callback itself.
+typedef struct ThreadTelemetry
+{
+    ThreadTaskKind kinds[THREAD_TASK_KIND_CAPACITY];
+    FTicAtomic kind_count;
+    ThreadHistogram wait;
+    ThreadHistogram run;
+
+    FTicAtomic pushed;
+    FTicAtomic completed;
+    FTicAtomic dropped;
+    FTicAtomic cleared;
+    FTicAtomic empty_wakeups;
+    FTicAtomic max_depth;
+
+    ThreadWorkerStats* workers;
+    u32 worker_count;
+    f64 start_time;
+} ThreadTelemetry;
+
 typedef struct SemaphoreCounter
 {
     FTicSemaphore* semaphore;
     u32 count;
 } SemaphoreCounter;
 
+// The ring is guarded by mutex, idle workers sleep on task_pushed.
 typedef struct ThreadTaskQueue
 {
-    FTicSemaphore mutex;
-    FTicSemaphore start_semaphore;
+    SyncMutex mutex;
+    SyncCondition task_pushed;
     ThreadTaskInternal* tasks;
     u32 capacity;
-    volatile u32 size;
-    volatile u32 head;
-    volatile u32 tail;
-    volatile u32 previous_count;
+    u32 size;
+    u32 head;
+    u32 tail;
+    ThreadTelemetry telemetry;
 } ThreadTaskQueue;
 
 typedef struct ThreadAttrib
 {
-    FTicSemaphore* start_semaphore;
     ThreadTaskQueue* queue;
-    volatile long stop_flag;
+    ThreadWorkerStats* stats;
+    FTicAtomic stop_flag;
     u32 id;
 } ThreadAttrib;
 
@@ -49,14 +104,59 @@ typedef struct ThreadQueue
     ThreadTaskQueue task_queue;
 } ThreadQueue;
 
+// Bounded ring that any number of threads publish into and one thread, the
+// UI, drains. Nothing takes a lock: a producer claims its slots with a
+// compare exchange on tail and marks every written slot in its sequence, the
+// consumer only reads slots that have been marked. A producer sleeps on space
+// while the ring is full, the consumer never waits.
+//
+// Reference counted, every task that publishes holds a reference. The owner
+// closes the channel when it stops draining, later pushes fail and whatever
+// is left is handed to free_element when the last reference goes.
+typedef struct ThreadChannel
+{
+    u8* data;
+    FTicAtomic* sequences;
+    void (*free_element)(void* element);
+    u32 element_size;
+    u32 capacity; // Power of two
+    u32 head;     // Only touched by the consumer
+    FTicAtomic tail;
+    FTicAtomic closed;
+    FTicAtomic reference_count;
+    SyncEventCount space;
+} ThreadChannel;
+
 #define THREAD_TASK_ENTRY_POINT(function_name) void function_name(void* data)
-ThreadTask thread_task(void (*task_callback)(void* data), void* data);
+// The callback name becomes the task name shown in the telemetry.
+#define thread_task(task_callback, data) thread_task_((task_callback), (data), #task_callback)
+ThreadTask thread_task_(void (*task_callback)(void* data), void* data, const char* name);
 void semaphore_counter_wait(SemaphoreCounter* semaphore_counter);
 void semaphore_counter_wait_and_free(SemaphoreCounter* semaphore_counter);
 void thread_tasks_clear(ThreadQueue* thread_queue);
-void thread_tasks_push(ThreadTaskQueue* task_queue, ThreadTask* tasks, u32 task_count, SemaphoreCounter* semaphore_counter);
+// Returns how many of the tasks were queued. When the queue is full the rest
+// are dropped, in order, and counted in the telemetry.
+u32 thread_tasks_push(ThreadTaskQueue* task_queue, ThreadTask* tasks, u32 task_count, SemaphoreCounter* semaphore_counter);
 u64 thread_get_task_count(ThreadTaskQueue* task_queue, u64 id);
 void thread_initialize(u32 capacity, u32 thread_count, ThreadQueue* queue);
 void threads_uninitialize(ThreadQueue* queue);
 
+ThreadChannel* thread_channel_create(u32 element_size, u32 capacity,
+                                     void (*free_element)(void* element));
+void thread_channel_retain(ThreadChannel* channel);
+void thread_channel_release(ThreadChannel* channel);
+void thread_channel_close(ThreadChannel* channel);
+// Publishes count elements in order. Returns false if the channel is closed,
+// the elements are then still owned by the caller.
+b8 thread_channel_push(ThreadChannel* channel, const void* elements, u32 count);
+// Copies up to max_count published elements into elements. Only one thread
+// may drain a channel.
+u32 thread_channel_drain(ThreadChannel* channel, void* elements, u32 max_count);
+
+u32 thread_get_queue_depth(ThreadTaskQueue* task_queue);
+void thread_telemetry_reset(ThreadTaskQueue* task_queue);
+f64 thread_histogram_mean_us(const ThreadHistogram* histogram);
+// Upper bound of the bucket holding the given fraction of the samples.
+f64 thread_histogram_percentile_us(const ThreadHistogram* histogram, f64 fraction);
+
 extern u32 global_thread_count;
@@ -0,0 +1,206 @@
+#include "thumbnail_cache.h"
+#include "platform/platform.h"
+#include "profiler.h"
+#include <string.h>
+#include <stdio.h>
+
+typedef struct ThumbnailCacheHeader
+{
+    u32 magic;
+    u32 version;
+    u32 width;
+    u32 height;
+    u64 key;
+    u32 word_count;
+    u32 pad;
+} ThumbnailCacheHeader;
+
+// The pixels are stored as a stream of u32 words. Each packet starts with a
+// count, if THUMBNAIL_CACHE_REPEAT is set the next pixel is repeated count
+// times, otherwise count pixels follow as they are.
+#define THUMBNAIL_CACHE_REPEAT 0x80000000u
+
+global char thumbnail_cache_directory[FTIC_MAX_PATH] = { 0 };
+
+void thumbnail_cache_initialize(const char* directory)
+{
+    const size_t length = strlen(directory);
+    if (length + 32 >= sizeof(thumbnail_cache_directory))
+    {
+        thumbnail_cache_directory[0] = '\0';
+        return;
+    }
+    memcpy(thumbnail_cache_directory, directory, length + 1);
+    if (!platform_directory_exists(thumbnail_cache_directory))
+    {
+        platform_create_directory(thumbnail_cache_directory);
+    }
+}
+
+u64 thumbnail_cache_key(const char* path, const u64 last_write_time, const u64 size)
+{
+    // FNV-1a
+    u64 hash = 0xCBF29CE484222325ULL;
+    for (; *path; ++path)
+    {
+        hash = (hash ^ (u8)*path) * 0x100000001B3ULL;
+    }
+    hash = (hash ^ last_write_time) * 0x100000001B3ULL;
+    hash = (hash ^ size) * 0x100000001B3ULL;
+    return hash;
+}
+
+internal b8 thumbnail_cache_path(const u64 key, char* buffer, const u32 buffer_size)
+{
+    if (!thumbnail_cache_directory[0])
+    {
+        return false;
+    }
+    sysprintf(buffer, buffer_size, "%s/%016llx.thumb", thumbnail_cache_directory,
+              (unsigned long long)key);
+    return true;
+}
+
+internal b8 thumbnail_cache_decode(const u32* words, const u32 word_count, u32* pixels,
+                                   const u32 pixel_count)
+{
+    u32 at = 0;
+    for (u32 i = 0; i < word_count;)
+    {
+        const u32 count = words[i] & ~THUMBNAIL_CACHE_REPEAT;
+        const b8 repeat = (words[i++] & THUMBNAIL_CACHE_REPEAT) != 0;
+        const u32 words_needed = repeat ? 1 : count;
+        if (count > pixel_count - at || words_needed > word_count - i)
+        {
+            return false;
+        }
+        for (u32 j = 0; j < count; ++j)
+        {
+            pixels[at++] = repeat ? words[i] : words[i + j];
+        }
+        i += words_needed;
+    }
+    return at == pixel_count;
+}
+
+internal u32 thumbnail_cache_encode(const u32* pixels, const u32 pixel_count, u32* words)
+{
+    u32 word_count = 0;
+    for (u32 i = 0; i < pixel_count;)
+    {
+        u32 run = 1;
+        while (i + run < pixel_count && pixels[i + run] == pixels[i])
+        {
+            ++run;
+        }
+        if (run >= 2)
+        {
+            words[word_count++] = THUMBNAIL_CACHE_REPEAT | run;
+            words[word_count++] = pixels[i];
+            i += run;
+            continue;
+        }
+        u32 literal_count = 1;
+        while (i + literal_count < pixel_count &&
+               !(i + literal_count + 1 < pixel_count &&
+                 pixels[i + literal_count] == pixels[i + literal_count + 1]))
+        {
+            ++literal_count;
+        }
+        words[word_count++] = literal_count;
+        memcpy(words + word_count, pixels + i, literal_count * sizeof(u32));
+        word_count += literal_count;
+        i += literal_count;
+    }
+    return word_count;
+}
+
+b8 thumbnail_cache_load(const u64 key, TextureProperties* texture_properties)
+{
+    char path[FTIC_MAX_PATH] = { 0 };
+    if (!thumbnail_cache_path(key, path, sizeof(path)))
+    {
+        return false;
+    }
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    b8 result = false;
+    ThumbnailCacheHeader header = { 0 };
+    if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == THUMBNAIL_CACHE_MAGIC &&
+        header.version == THUMBNAIL_CACHE_VERSION && header.key == key && header.width &&
+        header.height && header.width <= 4096 && header.height <= 4096 &&
+        header.word_count <= header.width * header.height * 2)
+    {
+        const u32 pixel_count = header.width * header.height;
+        u32* words = (u32*)malloc(header.word_count * sizeof(u32));
+        u32* pixels = (u32*)malloc(pixel_count * sizeof(u32));
+        if (fread(words, sizeof(u32), header.word_count, file) == header.word_count &&
+            thumbnail_cache_decode(words, header.word_count, pixels, pixel_count))
+        {
+            texture_properties->width = (int)header.width;
+            texture_properties->height = (int)header.height;
+            texture_properties->channels = 4;
+            texture_properties->bytes = (u8*)pixels;
+            result = true;
+        }
+        else
+        {
+            free(pixels);
+        }
+        free(words);
+    }
+    fclose(file);
+    return result;
+}
+
+b8 thumbnail_cache_save(const u64 key, const TextureProperties* texture_properties)
+{
+    char path[FTIC_MAX_PATH] = { 0 };
+    if (!texture_properties->bytes || !thumbnail_cache_path(key, path, sizeof(path)))
+    {
+        return false;
+    }
+
+    const u32 pixel_count = (u32)(texture_properties->width * texture_properties->height);
+    // Worst case is a count word in front of every pixel.
+    u32* words = (u32*)malloc(pixel_count * 2 * sizeof(u32));
+    const u32 word_count =
+        thumbnail_cache_encode((const u32*)texture_properties->bytes, pixel_count, words);
+
+    b8 result = false;
+    FILE* file = fopen(path, "wb");
+    if (file)
+    {
+        const ThumbnailCacheHeader header = {
+            .magic = THUMBNAIL_CACHE_MAGIC,
+            .version = THUMBNAIL_CACHE_VERSION,
+            .width = (u32)texture_properties->width,
+            .height = (u32)texture_properties->height,
+            .key = key,
+            .word_count = word_count,
+        };
+        result = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(words, sizeof(u32), word_count, file) == word_count;
+        fclose(file);
+        if (!result)
+        {
+            platform_delete_file(path);
+        }
+    }
+    free(words);
+    return result;
+}
+
+void thumbnail_cache_save_task(void* data)
+{
+    ThumbnailCacheSaveData* arguments = (ThumbnailCacheSaveData*)data;
+    PROFILE_FUNCTION_BEGIN();
+    thumbnail_cache_save(arguments->key, &arguments->texture_properties);
+    free(arguments->texture_properties.bytes);
+    free(arguments);
+    PROFILE_END();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "define.h"
+#include "texture.h"
+
+// Rendered thumbnails are stored as run length encoded RGBA, one file per
+// thumbnail, named after a hash of the path, write time and size of the file
+// they were made from. Changing the file changes the key, stale entries are
+// simply never read again.
+#define THUMBNAIL_CACHE_MAGIC 0x48545446 // "FTTH"
+#define THUMBNAIL_CACHE_VERSION 1
+
+typedef struct ThumbnailCacheSaveData
+{
+    u64 key;
+    TextureProperties texture_properties;
+} ThumbnailCacheSaveData;
+
+void thumbnail_cache_initialize(const char* directory);
+u64 thumbnail_cache_key(const char* path, const u64 last_write_time, const u64 size);
+b8 thumbnail_cache_load(const u64 key, TextureProperties* texture_properties);
+b8 thumbnail_cache_save(const u64 key, const TextureProperties* texture_properties);
+
+// Thread task, takes ownership of the ThumbnailCacheSaveData and its bytes.
+void thumbnail_cache_save_task(void* data);
@@ -0,0 +1,197 @@
+#include "thumbnail_renderer.h"
+#include "thumbnail_cache.h"
+#include "opengl_util.h"
+#include "texture.h"
+#include "camera.h"
+#include "buffers.h"
+#include "profiler.h"
+#include <glad/glad.h>
+#include <string.h>
+
+void thumbnail_renderer_create(const u32 shader, ThreadTaskQueue* task_queue,
+                               ThumbnailRenderer* renderer)
+{
+    memset(renderer, 0, sizeof(ThumbnailRenderer));
+    renderer->task_queue = task_queue;
+
+    glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &renderer->multisample_texture);
+    glTextureStorage2DMultisample(renderer->multisample_texture, 4, GL_RGBA8,
+                                  THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE, GL_TRUE);
+    glCreateRenderbuffers(1, &renderer->depth_renderbuffer);
+    glNamedRenderbufferStorageMultisample(renderer->depth_renderbuffer, 4, GL_DEPTH_COMPONENT24,
+                                          THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE);
+    glCreateFramebuffers(1, &renderer->multisample_framebuffer);
+    glNamedFramebufferTexture(renderer->multisample_framebuffer, GL_COLOR_ATTACHMENT0,
+                              renderer->multisample_texture, 0);
+    glNamedFramebufferRenderbuffer(renderer->multisample_framebuffer, GL_DEPTH_ATTACHMENT,
+                                   GL_RENDERBUFFER, renderer->depth_renderbuffer);
+    if (glCheckNamedFramebufferStatus(renderer->multisample_framebuffer, GL_FRAMEBUFFER) !=
+            GL_FRAMEBUFFER_COMPLETE ||
+        !render_target_create(THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE, &renderer->resolve))
+    {
+        glDeleteFramebuffers(1, &renderer->multisample_framebuffer);
+        renderer->multisample_framebuffer = 0;
+    }
+
+    renderer->light_dir_location = glGetUniformLocation(shader, "light_dir");
+    ftic_assert(renderer->light_dir_location != -1);
+
+    VertexBufferLayout vertex_buffer_layout = default_vertex_3d_buffer_layout();
+    U32Array textures = { 0 };
+    array_create(&textures, 2);
+    array_push(&textures, create_default_texture());
+    renderer->render = render_create(shader, textures, &vertex_buffer_layout,
+                                     vertex_buffer_create(), index_buffer_create());
+    array_free(&vertex_buffer_layout.items);
+}
+
+void thumbnail_renderer_destroy(ThumbnailRenderer* renderer)
+{
+    render_target_destroy(&renderer->resolve);
+    glDeleteFramebuffers(1, &renderer->multisample_framebuffer);
+    glDeleteRenderbuffers(1, &renderer->depth_renderbuffer);
+    texture_delete(renderer->multisample_texture);
+    render_destroy(&renderer->render);
+    memset(renderer, 0, sizeof(ThumbnailRenderer));
+}
+
+internal void upload_meshes(ThumbnailRenderer* renderer, const ObjectThumbnail* objects,
+                            const u32 count)
+{
+    u64 vertex_size = 0;
+    u64 index_size = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        vertex_size += objects[i].mesh.vertices.size * sizeof(Vertex3D);
+        index_size += objects[i].mesh.indices.size * sizeof(u32);
+    }
+    if (vertex_size > renderer->vertex_capacity)
+    {
+        renderer->vertex_capacity = max(vertex_size, renderer->vertex_capacity * 2);
+        glNamedBufferData(renderer->render.vertex_buffer_id, (GLsizeiptr)renderer->vertex_capacity,
+                          NULL, GL_DYNAMIC_DRAW);
+    }
+    if (index_size > renderer->index_capacity)
+    {
+        renderer->index_capacity = max(index_size, renderer->index_capacity * 2);
+        glNamedBufferData(renderer->render.index_buffer_id, (GLsizeiptr)renderer->index_capacity,
+                          NULL, GL_DYNAMIC_DRAW);
+    }
+
+    u64 vertex_offset = 0;
+    u64 index_offset = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const Mesh3D* mesh = &objects[i].mesh;
+        const u64 mesh_vertex_size = mesh->vertices.size * sizeof(Vertex3D);
+        const u64 mesh_index_size = mesh->indices.size * sizeof(u32);
+        glNamedBufferSubData(renderer->render.vertex_buffer_id, (GLintptr)vertex_offset,
+                             (GLsizeiptr)mesh_vertex_size, mesh->vertices.data);
+        glNamedBufferSubData(renderer->render.index_buffer_id, (GLintptr)index_offset,
+                             (GLsizeiptr)mesh_index_size, mesh->indices.data);
+        vertex_offset += mesh_vertex_size;
+        index_offset += mesh_index_size;
+    }
+}
+
+internal void push_cache_save(ThumbnailRenderer* renderer, const u64 key, const i32 x,
+                              const i32 y)
+{
+    const u32 byte_count = THUMBNAIL_SIZE * THUMBNAIL_SIZE * 4;
+    ThumbnailCacheSaveData* save_data =
+        (ThumbnailCacheSaveData*)calloc(1, sizeof(ThumbnailCacheSaveData));
+    save_data->key = key;
+    save_data->texture_properties = (TextureProperties){
+        .width = THUMBNAIL_SIZE,
+        .height = THUMBNAIL_SIZE,
+        .channels = 4,
+        .bytes = (u8*)malloc(byte_count),
+    };
+    glGetTextureSubImage(renderer->resolve.texture, 0, x, y, 0, THUMBNAIL_SIZE, THUMBNAIL_SIZE,
+                         1, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)byte_count,
+                         save_data->texture_properties.bytes);
+    ThreadTask task = thread_task(thumbnail_cache_save_task, save_data);
+    thread_tasks_push(renderer->task_queue, &task, 1, NULL);
+}
+
+u32 thumbnail_renderer_render(ThumbnailRenderer* renderer, const ObjectThumbnail* objects,
+                              u32 count, u32* textures)
+{
+    count = min(count, THUMBNAIL_ATLAS_TILE_COUNT);
+    memset(textures, 0, count * sizeof(u32));
+    if (!renderer->multisample_framebuffer || !count)
+    {
+        return count;
+    }
+    PROFILE_FUNCTION_BEGIN();
+
+    upload_meshes(renderer, objects, count);
+
+    GLint viewport[4] = { 0 };
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer->multisample_framebuffer);
+    glViewport(0, 0, THUMBNAIL_ATLAS_SIZE, THUMBNAIL_ATLAS_SIZE);
+    glEnable(GL_DEPTH_TEST);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    const MVP identity = { .model = m4d(), .view = m4d(), .projection = m4d() };
+    render_begin_draw(&renderer->render, renderer->render.shader_properties.shader, &identity);
+
+    const M4 projection = perspective(PI * 0.5f, 1.0f, 0.1f, 100.0f);
+    u64 index_offset = 0;
+    i32 vertex_offset = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+        const ObjectThumbnail* object = objects + i;
+        const i32 x = (i32)(i % THUMBNAIL_ATLAS_TILES_PER_SIDE) * THUMBNAIL_SIZE;
+        const i32 y = (i32)(i / THUMBNAIL_ATLAS_TILES_PER_SIDE) * THUMBNAIL_SIZE;
+        glViewport(x, y, THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+
+        Camera camera = camera_create_default();
+        camera_set_based_on_mesh_aabb(&camera, &object->mesh_aabb);
+        const MVP mvp = {
+            .model = m4d(),
+            .view = view(camera.position, v3_add(camera.position, camera.orientation), camera.up),
+            .projection = projection,
+        };
+        shader_set_mvp(&renderer->render.shader_properties, &mvp);
+        glUniform3f(renderer->light_dir_location, -camera.orientation.x, -camera.orientation.y,
+                    -camera.orientation.z);
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)object->mesh.indices.size,
+                                 GL_UNSIGNED_INT, (void*)index_offset, vertex_offset);
+        index_offset += object->mesh.indices.size * sizeof(u32);
+        vertex_offset += (i32)object->mesh.vertices.size;
+    }
+    render_end_draw(&renderer->render);
+    glDisable(GL_DEPTH_TEST);
+
+    const i32 used_height =
+        (i32)((count + THUMBNAIL_ATLAS_TILES_PER_SIDE - 1) / THUMBNAIL_ATLAS_TILES_PER_SIDE) *
+        THUMBNAIL_SIZE;
+    glBlitNamedFramebuffer(renderer->multisample_framebuffer, renderer->resolve.framebuffer, 0, 0,
+                           THUMBNAIL_ATLAS_SIZE, used_height, 0, 0, THUMBNAIL_ATLAS_SIZE,
+                           used_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        const i32 x = (i32)(i % THUMBNAIL_ATLAS_TILES_PER_SIDE) * THUMBNAIL_SIZE;
+        const i32 y = (i32)(i / THUMBNAIL_ATLAS_TILES_PER_SIDE) * THUMBNAIL_SIZE;
+        const TextureProperties texture_properties = {
+            .width = THUMBNAIL_SIZE,
+            .height = THUMBNAIL_SIZE,
+        };
+        textures[i] = texture_create(&texture_properties, GL_RGBA8, GL_RGBA, GL_LINEAR);
+        glCopyImageSubData(renderer->resolve.texture, GL_TEXTURE_2D, 0, x, y, 0, textures[i],
+                           GL_TEXTURE_2D, 0, 0, 0, 0, THUMBNAIL_SIZE, THUMBNAIL_SIZE, 1);
+        if (objects[i].cache_key)
+        {
+            push_cache_save(renderer, objects[i].cache_key, x, y);
+        }
+    }
+    PROFILE_END();
+    return count;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "define.h"
+#include "rendering.h"
+#include "render_target.h"
+#include "thread_queue.h"
+#include "util.h"
+
+#define THUMBNAIL_SIZE 256
+#define THUMBNAIL_ATLAS_TILES_PER_SIDE 4
+#define THUMBNAIL_ATLAS_TILE_COUNT                                                                 \
+    (THUMBNAIL_ATLAS_TILES_PER_SIDE * THUMBNAIL_ATLAS_TILES_PER_SIDE)
+#define THUMBNAIL_ATLAS_SIZE (THUMBNAIL_SIZE * THUMBNAIL_ATLAS_TILES_PER_SIDE)
+// Time spent on rendering object thumbnails each frame, at least one batch is
+// always rendered.
+#define THUMBNAIL_FRAME_BUDGET 0.004
+
+// Renders object thumbnails in batches. Every mesh in a batch gets a tile in a
+// multisampled atlas, the atlas is resolved once and the tiles are copied out
+// to their own textures. The framebuffers and the vertex and index buffers are
+// created once and only grown when a batch does not fit.
+typedef struct ThumbnailRenderer
+{
+    u32 multisample_framebuffer;
+    u32 multisample_texture;
+    u32 depth_renderbuffer;
+    RenderTarget resolve;
+
+    Render render;
+    i32 light_dir_location;
+    u64 vertex_capacity;
+    u64 index_capacity;
+
+    ThreadTaskQueue* task_queue;
+} ThumbnailRenderer;
+
+void thumbnail_renderer_create(const u32 shader, ThreadTaskQueue* task_queue,
+                               ThumbnailRenderer* renderer);
+void thumbnail_renderer_destroy(ThumbnailRenderer* renderer);
+
+// Renders up to THUMBNAIL_ATLAS_TILE_COUNT objects, one texture per object is
+// written to textures (0 on failure). Objects with a cache key are also saved
+// to the thumbnail cache on the task queue. Returns the number of objects
+// that were consumed.
+u32 thumbnail_renderer_render(ThumbnailRenderer* renderer, const ObjectThumbnail* objects,
+                              u32 count, u32* textures);
@@ -9,6 +9,9 @@
 #include "globals.h"
 #include "particle_system.h"
 #include "random.h"
+#include "profiler.h"
+#include "render_target.h"
+#include "thumbnail_cache.h"
 #include <string.h>
 #include <stdio.h>
 #include <glad/glad.h>
@@ -18,6 +21,11 @@ global u32 random_seed = 0;
 
 #define MAX_PATH 260
 
+// Number of halvings in the frosted glass blur chain, and the blur amount that
+// gives a Kawase offset of one.
+#define FROSTED_BLUR_LEVELS 4
+#define FROSTED_DEFAULT_BLUR_AMOUNT 0.00132f
+
 typedef struct UiWindowArray
 {
     u32 size;
@@ -120,11 +128,15 @@ typedef struct UiContext
     WindowRenderDataArray last_frame_overlay_windows;
     WindowRenderDataArray current_frame_overlay_windows;
 
+    // The first frosted quad covers the whole screen and is used for the blur
+    // passes, the rest are the overlay window backgrounds.
     RenderingProperties frosted_render;
+    RenderTargetPool frosted_targets;
+    u32 frosted_down_shader;
     f32 frosted_blur_amount;
-    i32 frosted_samples;
-    i32 frosted_blur_amount_location;
-    i32 frosted_samples_location;
+    i32 frosted_down_offset_location;
+    i32 frosted_up_offset_location;
+    u64 frosted_backdrop_hash;
 
     U32Array id_to_index;
     U32Array free_indices;
@@ -148,7 +160,7 @@ typedef struct UiContext
     u32 extra_index_offset;
     u32 extra_index_count;
 
-    UnorderedCircularParticleBuffer particles;
+    ParticleBuffer particles;
     u32 particles_index_offset;
 
     i32 dock_side_hit;
@@ -163,6 +175,7 @@ typedef struct UiContext
     AABB mouse_drag_box;
 
     FontTTF font;
+    GlyphAtlas glyph_atlas;
 
     V4 docking_color;
 
@@ -473,7 +486,7 @@ internal f32 add_text_selection_chars(UiWindow* window, const V2 position, const
 {
     f32 x_advance = 0.0f;
     ui_context.current_window_index_count += text_generation_color(
-        ui_context.font.chars, buffer, UI_FONT_TEXTURE, position, 1.0f, ui_context.font.line_height,
+        &ui_context.font, buffer, UI_FONT_TEXTURE, position, 1.0f, ui_context.font.line_height,
         add_window_alpha(window, global_get_text_color()), NULL, &x_advance, selection_chars,
         &ui_context.render.vertices);
     return x_advance;
@@ -1294,48 +1307,22 @@ internal void set_resize_cursor(u8 resize)
     }
 }
 
-internal u32 load_font_texture(const f32 pixel_height)
+void ui_context_set_font_path(const char* new_path)
 {
-    ui_context.font = (FontTTF){ 0 };
-    const i32 width_atlas = 256;
-    const i32 height_atlas = 256;
-    const u32 bitmap_size = width_atlas * height_atlas;
-    u8* font_bitmap_temp = (u8*)calloc(bitmap_size, sizeof(u8));
-    init_ttf_atlas(width_atlas, height_atlas, pixel_height, 96, 32, ui_context.font_path,
-                   font_bitmap_temp, &ui_context.font);
-
-    u8* font_bitmap = (u8*)malloc(bitmap_size * 4 * sizeof(u8));
-    memset(font_bitmap, UINT8_MAX, bitmap_size * 4 * sizeof(u8));
-    for (u32 i = 0, j = 3; i < bitmap_size; ++i, j += 4)
+    if (glyph_atlas_set_font(&ui_context.glyph_atlas, new_path))
     {
-        font_bitmap[j] = font_bitmap_temp[i];
+        memset(ui_context.font_path, 0, sizeof(ui_context.font_path));
+        memcpy(ui_context.font_path, new_path, strlen(new_path));
     }
-    free(font_bitmap_temp);
-
-    TextureProperties texture_properties = {
-        .width = width_atlas,
-        .height = height_atlas,
-        .bytes = font_bitmap,
-    };
-    u32 font_texture = texture_create(&texture_properties, GL_RGBA8, GL_RGBA, GL_NEAREST);
-    free(texture_properties.bytes);
-
-    return font_texture;
-}
-
-void ui_context_set_font_path(const char* new_path)
-{
-    memset(ui_context.font_path, 0, sizeof(ui_context.font_path));
-    memcpy(ui_context.font_path, new_path, strlen(new_path));
 }
 
 void ui_context_change_font_pixel_height(const f32 pixel_height)
 {
     if (closed_interval(12.0f, pixel_height, 26.0f))
     {
-        texture_delete(ui_context.render.render.textures.data[1]);
-        ui_context.render.render.textures.data[(u32)UI_FONT_TEXTURE] =
-            load_font_texture(pixel_height);
+        // The distance field atlas serves every size, nothing is rebaked.
+        font_create_from_atlas(&ui_context.glyph_atlas, UI_FONT_TEXTURE, pixel_height,
+                               &ui_context.font);
     }
 }
 
@@ -1344,7 +1331,7 @@ const char* ui_context_get_font_path()
     return ui_context.font_path;
 }
 
-void ui_context_create()
+void ui_context_create(ThreadTaskQueue* task_queue)
 {
     array_create(&ui_context.id_to_index, 100);
     array_create(&ui_context.free_indices, 100);
@@ -1376,20 +1363,32 @@ void ui_context_create()
     }
     ui_context.dock_side_hit = -1;
 
-    VertexBufferLayout vertex_buffer_layout = default_vertex_buffer_layout();
 
-    u32 shader = shader_create("res/shaders/vertex.glsl", "res/shaders/fragment.glsl");
+    u32 shader = shader_create("res/shaders/vertex_quad.glsl", "res/shaders/fragment_sdf.glsl");
 
-    u32 frosted_shader = shader_create("res/shaders/vertex.glsl", "res/shaders/fragment_blur.glsl");
+    u32 frosted_shader =
+        shader_create("res/shaders/vertex_quad.glsl", "res/shaders/fragment_kawase_up.glsl");
+    ui_context.frosted_down_shader =
+        shader_create("res/shaders/vertex_quad.glsl", "res/shaders/fragment_kawase_down.glsl");
 
     ftic_assert(shader);
     ftic_assert(frosted_shader);
+    ftic_assert(ui_context.frosted_down_shader);
 
     char* font_path = "C:/Windows/Fonts/arial.ttf";
     memset(ui_context.font_path, 0, sizeof(ui_context.font_path));
     memcpy(ui_context.font_path, font_path, strlen(font_path));
 
-    u32 font_texture = load_font_texture(16);
+    glyph_atlas_create(1024, 1024, GLYPH_ATLAS_SDF, ui_context.font_path, task_queue,
+                       &ui_context.glyph_atlas);
+
+    shader_bind(shader);
+    glUniform1f(glGetUniformLocation(shader, "sdfTextureIndex"), UI_FONT_TEXTURE);
+    glUniform1f(glGetUniformLocation(shader, "sdfEdge"), GLYPH_ATLAS_SDF_ON_EDGE / 255.0f);
+    shader_unbind();
+
+    font_create_from_atlas(&ui_context.glyph_atlas, UI_FONT_TEXTURE, 16, &ui_context.font);
+    u32 font_texture = ui_context.glyph_atlas.texture;
 
     // TODO: make all of these icons into a sprite sheet.
     u32 default_texture = create_default_texture();
@@ -1468,56 +1467,24 @@ void ui_context_create()
     array_push(&textures, file_c_icon_big_texture);
     array_push(&textures, file_obj_icon_texture);
 
-    array_create(&ui_context.render.vertices, 100 * 4);
-    u32 vertex_buffer_id = vertex_buffer_create();
-    vertex_buffer_orphan(vertex_buffer_id, ui_context.render.vertices.capacity * sizeof(Vertex),
-                         GL_STREAM_DRAW, NULL);
-    ui_context.render.vertex_buffer_capacity = ui_context.render.vertices.capacity;
-
-    array_create(&ui_context.render.indices, 100 * 6);
-    generate_indicies(&ui_context.render.indices, 0, 100);
-    u32 index_buffer_id = index_buffer_create();
-    index_buffer_orphan(index_buffer_id, ui_context.render.indices.size * sizeof(u32),
-                        GL_STATIC_DRAW, ui_context.render.indices.data);
-    free(ui_context.render.indices.data);
-
-    ui_context.render.render =
-        render_create(shader, textures, &vertex_buffer_layout, vertex_buffer_id, index_buffer_id);
+    rendering_properties_create(shader, textures, 4096, &ui_context.render);
 
     ui_context.default_textures_offset = textures.size;
 
     {
-        ui_context.frosted_blur_amount = 0.00132f;
-        ui_context.frosted_samples = 14;
+        ui_context.frosted_blur_amount = FROSTED_DEFAULT_BLUR_AMOUNT;
 
-        ui_context.frosted_blur_amount_location =
-            glGetUniformLocation(frosted_shader, "blurAmount");
-        ftic_assert(ui_context.frosted_blur_amount_location != -1);
-        ui_context.frosted_samples_location = glGetUniformLocation(frosted_shader, "samples");
-        ftic_assert(ui_context.frosted_samples_location != -1);
+        ui_context.frosted_down_offset_location =
+            glGetUniformLocation(ui_context.frosted_down_shader, "offset");
+        ftic_assert(ui_context.frosted_down_offset_location != -1);
+        ui_context.frosted_up_offset_location = glGetUniformLocation(frosted_shader, "offset");
+        ftic_assert(ui_context.frosted_up_offset_location != -1);
 
         U32Array frosted_textures = { 0 };
         array_create(&frosted_textures, 2);
 
-        array_create(&ui_context.frosted_render.vertices, 10 * 4);
-        u32 frosted_vertex_buffer_id = vertex_buffer_create();
-        vertex_buffer_orphan(frosted_vertex_buffer_id,
-                             ui_context.frosted_render.vertices.capacity * sizeof(Vertex),
-                             GL_STREAM_DRAW, NULL);
-        ui_context.frosted_render.vertex_buffer_capacity =
-            ui_context.frosted_render.vertices.capacity;
-
-        array_create(&ui_context.frosted_render.indices, 10 * 6);
-        generate_indicies(&ui_context.frosted_render.indices, 0, 10);
-        u32 frosted_index_buffer_id = index_buffer_create();
-        index_buffer_orphan(frosted_index_buffer_id,
-                            ui_context.frosted_render.indices.size * sizeof(u32), GL_STATIC_DRAW,
-                            ui_context.frosted_render.indices.data);
-        free(ui_context.frosted_render.indices.data);
-
-        ui_context.frosted_render.render =
-            render_create(frosted_shader, frosted_textures, &vertex_buffer_layout,
-                          frosted_vertex_buffer_id, frosted_index_buffer_id);
+        rendering_properties_create(frosted_shader, frosted_textures, 16,
+                                    &ui_context.frosted_render);
     }
 
     particle_buffer_create(&ui_context.particles, 1000);
@@ -1839,7 +1806,9 @@ void ui_context_begin(const V2 dimensions, const AABB* dock_space, const f64 del
     ui_context.mvp.view = m4d();
     ui_context.mvp.model = m4d();
 
-    ui_context.render.vertices.size = 0;
+    rendering_properties_clear(&ui_context.render);
+    ui_context.render.vertices.hash_content =
+        ui_frosted_glass && ui_context.last_frame_overlay_windows.size;
     ui_context.current_index_offset = 0;
 
     for (u32 i = 0; i < ui_context.generated_textures.size; ++i)
@@ -2039,17 +2008,18 @@ internal void emit_aabb_particles(const AABB* aabb, const V4 color, const V2 siz
             default: break;
         }
 
-        Particle* particle = particle_buffer_get_next(&ui_context.particles);
-        particle->position = current;
-        particle->velocity = v2f(random_f32s(random_seed, -20.0f, 20.0f),
-                                 random_f32s(random_seed + 1, -20.0f, 20.0f));
-        particle->acceleration = v2f(particle->velocity.x, particle->velocity.y);
-        particle->dimension = v2i(random_f32s(random_seed + 2, size_min_max.min, size_min_max.max));
-        particle->life = v2i(random_f32s(random_seed + 3, 0.6f, 0.8f));
-        particle->color = color;
-        particle->alpha_change = false;
-        particle->size_change = true;
-        particle_buffer_set_next(&ui_context.particles, particle);
+        Particle particle = {
+            .position = current,
+            .velocity = v2f(random_f32s(random_seed, -20.0f, 20.0f),
+                            random_f32s(random_seed + 1, -20.0f, 20.0f)),
+            .dimension = v2i(random_f32s(random_seed + 2, size_min_max.min, size_min_max.max)),
+            .life = random_f32s(random_seed + 3, 0.6f, 0.8f),
+            .color = color,
+            .alpha_change = false,
+            .size_change = true,
+        };
+        particle.acceleration = particle.velocity;
+        particle_buffer_emit(&ui_context.particles, &particle);
 
         random_seed += 4;
     }
@@ -2188,20 +2158,26 @@ internal u32 display_text_and_truncate_if_necissary(const V2 position, const f32
 {
     const u32 text_len = (u32)strlen(text);
     const i32 i =
-        text_check_length_within_boundary(ui_context.font.chars, text, text_len, 1.0f, total_width);
+        text_check_length_within_boundary(&ui_context.font, text, text_len, 1.0f, total_width);
     const b8 too_long = i >= 3;
     char saved_name[4] = "...";
+    i32 j = i - 3;
     if (too_long)
     {
-        i32 j = i - 3;
+        // Not in the middle of a UTF-8 sequence, skip back over the
+        // continuation bytes.
+        while (j > 0 && (text[j] & 0xC0) == 0x80)
+        {
+            --j;
+        }
         string_swap(text + j, saved_name); // Truncate
     }
     u32 index_count = text_generation_color(
-        ui_context.font.chars, text, UI_FONT_TEXTURE, position, 1.0f, ui_context.font.pixel_height,
+        &ui_context.font, text, UI_FONT_TEXTURE, position, 1.0f, ui_context.font.pixel_height,
         v4a(global_get_text_color(), alpha), NULL, NULL, NULL, &ui_context.render.vertices);
     if (too_long)
     {
-        memcpy(text + (i - 3), saved_name, sizeof(saved_name));
+        memcpy(text + j, saved_name, sizeof(saved_name));
     }
     return index_count;
 }
@@ -2419,9 +2395,9 @@ internal void draw_dock_spaces(const WindowRenderDataArray* windows,
     {
         const WindowRenderData* render_data = windows->data + i;
         AABB scissor = get_window_scissor(&render_data->aabb);
-        render_draw(render_data->index_offset, render_data->index_count, &scissor);
+        render_draw_quads(render_data->index_offset, render_data->index_count, &scissor);
         UU32 index_offset_and_count = dock_spaces_index_offsets_and_counts->data[i];
-        render_draw(index_offset_and_count.first, index_offset_and_count.second, &scissor);
+        render_draw_quads(index_offset_and_count.first, index_offset_and_count.second, &scissor);
     }
 }
 
@@ -2437,16 +2413,124 @@ internal void render_ui(const WindowRenderDataArray* docked_windows,
 
     draw_dock_spaces(docked_windows, dock_spaces_index_offsets_and_counts_docked);
 
-    render_draw(ui_context.extra_index_offset, ui_context.extra_index_count, &whole_screen_scissor);
-    render_draw(ui_context.particles_index_offset, ui_context.particles.size * 6,
-                &whole_screen_scissor);
+    render_draw_quads(ui_context.extra_index_offset, ui_context.extra_index_count, &whole_screen_scissor);
+    render_draw_quads(ui_context.particles_index_offset, ui_context.particles.size * 6,
+                      &whole_screen_scissor);
 
     draw_dock_spaces(windows, dock_spaces_index_offsets_and_counts);
 
     render_end_draw(&ui_context.render.render);
 }
 
-internal void render_overlay_ui(const u32 index_offset, const u32 index_count)
+internal void frosted_blur_pass(const u32 shader, const i32 offset_location,
+                               const RenderTarget* source, const RenderTarget* destination)
+{
+    const AABB target_scissor = {
+        .size = v2f((f32)destination->width, (f32)destination->height),
+    };
+    render_target_bind(destination);
+    ui_context.frosted_render.render.textures.data[0] = source->texture;
+    render_begin_draw(&ui_context.frosted_render.render, shader, &ui_context.mvp);
+    glUniform1f(offset_location, ui_context.frosted_blur_amount / FROSTED_DEFAULT_BLUR_AMOUNT);
+    render_draw_quads(0, 6, &target_scissor);
+    render_end_draw(&ui_context.frosted_render.render);
+}
+
+internal u64 frosted_backdrop_hash()
+{
+    if (!ui_context.render.vertices.hash_content || ui_context.particles.size)
+    {
+        return 0;
+    }
+    u64 hash = ui_context.render.vertices.content_hash;
+    const U32Array* textures = &ui_context.render.render.textures;
+    for (u32 i = 0; i < textures->size; ++i)
+    {
+        hash = (hash ^ textures->data[i]) * 0x100000001B3ULL;
+    }
+    u32 blur_amount = 0;
+    memcpy(&blur_amount, &ui_context.frosted_blur_amount, sizeof(blur_amount));
+    hash = (hash ^ blur_amount) * 0x100000001B3ULL;
+    hash = (hash ^ (u64)ui_context.dimensions.width) * 0x100000001B3ULL;
+    hash = (hash ^ (u64)ui_context.dimensions.height) * 0x100000001B3ULL;
+    return hash ? hash : 1;
+}
+
+// Renders what is behind the overlay windows into the pool and blurs it with a
+// dual Kawase down and up chain. The result is kept in the first level and
+// reused for as long as nothing under the overlays changes. Returns false if
+// there is nothing to show.
+internal b8 update_frosted_backdrop(const WindowRenderDataArray* docked_windows,
+                                    const UU32Array* docked_index_offsets_and_counts,
+                                    const WindowRenderDataArray* windows,
+                                    const UU32Array* index_offsets_and_counts)
+{
+    RenderTargetPool* pool = &ui_context.frosted_targets;
+    const i32 width = (i32)round_f32(ui_context.dimensions.width);
+    const i32 height = (i32)round_f32(ui_context.dimensions.height);
+    if (width <= 0 || height <= 0)
+    {
+        return false;
+    }
+    if (pool->width != width || pool->height != height)
+    {
+        ui_context.frosted_backdrop_hash = 0;
+    }
+    if (!render_target_pool_resize(pool, width, height, FROSTED_BLUR_LEVELS))
+    {
+        return false;
+    }
+
+    set_up_verticies(&ui_context.frosted_render.vertices, v2d(), ui_context.dimensions,
+                     v4ic(1.0f), 0.0f, flip_texture_coordinates());
+    for (u32 i = 0; i < ui_context.last_frame_overlay_windows.size; ++i)
+    {
+        const AABB* window_aabb = &ui_context.last_frame_overlay_windows.data[i].aabb;
+        add_frosted_background(window_aabb->min, window_aabb->size, 0);
+    }
+    rendering_properties_upload(&ui_context.frosted_render);
+    ui_context.frosted_render.render.textures.size = 1;
+
+    const u64 hash = frosted_backdrop_hash();
+    if (!hash || hash != ui_context.frosted_backdrop_hash)
+    {
+        ui_context.frosted_backdrop_hash = hash;
+
+        GLint viewport[4] = { 0 };
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        render_target_bind(&pool->full);
+        glClear(GL_COLOR_BUFFER_BIT);
+        render_ui(docked_windows, docked_index_offsets_and_counts, windows,
+                  index_offsets_and_counts);
+
+        const u32 up_shader = ui_context.frosted_render.render.shader_properties.shader;
+        const RenderTarget* source = &pool->full;
+        for (u32 i = 0; i < pool->level_count; ++i)
+        {
+            frosted_blur_pass(ui_context.frosted_down_shader,
+                              ui_context.frosted_down_offset_location, source, pool->levels + i);
+            source = pool->levels + i;
+        }
+        for (i32 i = (i32)pool->level_count - 2; i >= 0; --i)
+        {
+            frosted_blur_pass(up_shader, ui_context.frosted_up_offset_location, source,
+                              pool->levels + i);
+            source = pool->levels + i;
+        }
+        render_target_unbind();
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    ui_context.frosted_render.render.textures.data[0] = pool->levels[0].texture;
+    shader_bind(ui_context.frosted_render.render.shader_properties.shader);
+    glUniform1f(ui_context.frosted_up_offset_location,
+                ui_context.frosted_blur_amount / FROSTED_DEFAULT_BLUR_AMOUNT);
+    shader_unbind();
+    return true;
+}
+
+internal void render_overlay_ui(const u32 index_offset, const u32 index_count, const b8 frosted)
 {
     AABB whole_screen_scissor = { .size = ui_context.dimensions };
     render_begin_draw(&ui_context.render.render, ui_context.render.render.shader_properties.shader,
@@ -2455,18 +2539,18 @@ internal void render_overlay_ui(const u32 index_offset, const u32 index_count)
     {
         const WindowRenderData* render_data = ui_context.last_frame_overlay_windows.data + i;
         AABB scissor = get_window_scissor(&render_data->aabb);
-        if (ui_frosted_glass)
+        if (frosted)
         {
             const u32 shader = ui_context.frosted_render.render.shader_properties.shader;
             render_begin_draw(&ui_context.frosted_render.render, shader, &ui_context.mvp);
-            render_draw(j++ * 6, 6, &whole_screen_scissor);
+            render_draw_quads(++j * 6, 6, &whole_screen_scissor);
             render_end_draw(&ui_context.frosted_render.render);
 
             render_begin_draw(&ui_context.render.render,
                               ui_context.render.render.shader_properties.shader, &ui_context.mvp);
         }
-        render_draw(render_data->index_offset, render_data->index_count, &scissor);
-        render_draw(index_offset + (index_count * i), index_count, &scissor);
+        render_draw_quads(render_data->index_offset, render_data->index_count, &scissor);
+        render_draw_quads(index_offset + (index_count * i), index_count, &scissor);
     }
     render_end_draw(&ui_context.render.render);
 }
@@ -2493,6 +2577,7 @@ internal void handle_tab_change_or_close(TabChange tab_change)
 
 void ui_context_end()
 {
+    PROFILE_FUNCTION_BEGIN();
     ui_context.extra_index_offset = ui_context.current_index_offset;
     ui_context.extra_index_count = 0;
 
@@ -2527,6 +2612,7 @@ void ui_context_end()
 
     if (ui_context.dimensions.y == 0.0f)
     {
+        PROFILE_END();
         return;
     }
 
@@ -2540,11 +2626,9 @@ void ui_context_end()
 
     ui_context.particles_index_offset = ui_context.current_index_offset;
     particle_buffer_update(&ui_context.particles, ui_context.delta_time);
-    for (u32 i = 0; i < ui_context.particles.size; ++i)
-    {
-        Particle* particle = ui_context.particles.data + i;
-        add_circle(particle->position, particle->dimension, particle->color);
-    }
+    particle_buffer_write_quads(
+        &ui_context.particles, UI_CIRCLE_TEXTURE,
+        quad_array_reserve(&ui_context.render.vertices, ui_context.particles.size));
     ui_context.current_index_offset += ui_context.particles.size * 6;
 
     u32 overlay_index_offset = ui_context.current_index_offset;
@@ -2560,77 +2644,31 @@ void ui_context_end()
     ui_context.current_index_offset +=
         overlay_index_count * ui_context.last_frame_overlay_windows.size;
 
-    rendering_properties_check_and_grow_vertex_buffer(&ui_context.render);
-    rendering_properties_check_and_grow_index_buffer(&ui_context.render,
-                                                     ui_context.current_index_offset);
+    glyph_atlas_update(&ui_context.glyph_atlas);
 
-    buffer_set_sub_data(ui_context.render.render.vertex_buffer_id, GL_ARRAY_BUFFER, 0,
-                        sizeof(Vertex) * ui_context.render.vertices.size,
-                        ui_context.render.vertices.data);
+    rendering_properties_upload(&ui_context.render);
 
-    ui_context.frosted_render.vertices.size = 0;
+    rendering_properties_clear(&ui_context.frosted_render);
     ui_context.frosted_render.render.textures.size = 0;
-    u32 fbo = 0;
-    u32 fbo_texture = 0;
+    b8 frosted = false;
     if (ui_frosted_glass && overlay_windows->size)
     {
-        glGenFramebuffers(1, &fbo);
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-        glGenTextures(1, &fbo_texture);
-        glBindTexture(GL_TEXTURE_2D, fbo_texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)ui_context.dimensions.width,
-                     (GLsizei)ui_context.dimensions.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fbo_texture, 0);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
-        {
-            render_ui(docked_windows, &docked_index_offsets_and_counts, floating_windows,
-                      &index_offsets_and_counts);
-        }
-        else
-        {
-            texture_delete(fbo_texture);
-            fbo_texture = 0;
-        }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        if (fbo_texture)
-        {
-            ui_context.frosted_render.render.textures.size = 1;
-            ui_context.frosted_render.render.textures.data[0] = fbo_texture;
-            for (u32 i = 0; i < ui_context.last_frame_overlay_windows.size; ++i)
-            {
-                const AABB* window_aabb = &ui_context.last_frame_overlay_windows.data[i].aabb;
-                add_frosted_background(window_aabb->min, window_aabb->size, 0);
-            }
-            buffer_set_sub_data(ui_context.frosted_render.render.vertex_buffer_id, GL_ARRAY_BUFFER,
-                                0, sizeof(Vertex) * ui_context.frosted_render.vertices.size,
-                                ui_context.frosted_render.vertices.data);
-        }
-
-        shader_bind(ui_context.frosted_render.render.shader_properties.shader);
-        glUniform1f(ui_context.frosted_blur_amount_location, ui_context.frosted_blur_amount);
-        glUniform1i(ui_context.frosted_samples_location, ui_context.frosted_samples);
-        shader_unbind();
+        frosted = update_frosted_backdrop(docked_windows, &docked_index_offsets_and_counts,
+                                          floating_windows, &index_offsets_and_counts);
+    }
+    else
+    {
+        ui_context.frosted_backdrop_hash = 0;
     }
     render_ui(docked_windows, &docked_index_offsets_and_counts, floating_windows,
               &index_offsets_and_counts);
 
-    AABB whole_screen_scissor = { .size = ui_context.dimensions };
-
     if (overlay_windows->size)
     {
-        render_overlay_ui(overlay_index_offset, overlay_index_count);
-        if (fbo_texture)
-        {
-            texture_delete(fbo_texture);
-        }
-        glDeleteFramebuffers(1, &fbo);
+        render_overlay_ui(overlay_index_offset, overlay_index_count, frosted);
     }
+    rendering_properties_submit(&ui_context.render);
+    rendering_properties_submit(&ui_context.frosted_render);
     if (tab_change_docked.dock_space)
     {
         handle_tab_change_or_close(tab_change_docked);
@@ -2642,11 +2680,20 @@ void ui_context_end()
 
     array_free(&docked_index_offsets_and_counts);
     array_free(&index_offsets_and_counts);
+    PROFILE_END();
 }
 
 void ui_context_destroy()
 {
     save_layout();
+    glyph_atlas_destroy(&ui_context.glyph_atlas);
+    // The frosted textures belong to the pool, not the render.
+    ui_context.frosted_render.render.textures.size = 0;
+    rendering_properties_destroy(&ui_context.frosted_render);
+    render_target_pool_destroy(&ui_context.frosted_targets);
+    shader_destroy(ui_context.frosted_down_shader);
+    rendering_properties_destroy(&ui_context.render);
+    particle_buffer_free(&ui_context.particles);
 }
 
 void ui_context_set_window_in_focus(const u32 window_id)
@@ -2688,6 +2735,11 @@ const UiWindow* ui_window_get(const u32 window_id)
     return ui_window_get_(window_id);
 }
 
+V2 ui_window_get_first_item_position()
+{
+    return ui_context.current_window_first_item_position;
+}
+
 void ui_window_set_end_scroll_offset(const u32 window_id, const f32 offset)
 {
     ui_window_get_(window_id)->end_scroll_offset = offset;
@@ -3173,7 +3225,7 @@ internal void render_input(UiWindow* window, const f64 delta_time, const V2 text
         if (input->time >= 0.4f)
         {
             const f32 x_advance =
-                text_x_advance(ui_context.font.chars, input->buffer.data, input->input_index, 1.0f);
+                text_x_advance(&ui_context.font, input->buffer.data, input->input_index, 1.0f);
 
             add_default_quad(v2f(text_position.x + x_advance + 1.0f, text_position.y + 1.0f),
                              v2f(1.0f, ui_context.font.pixel_height), v4i(1.0f));
@@ -3252,7 +3304,7 @@ internal b8 add_from_key_buffer(const f32 width, InputBuffer* input)
         {
             array_push(&input->buffer, current_char);
             f32 x_advance =
-                text_x_advance(ui_context.font.chars, input->buffer.data, input->buffer.size, 1.0f);
+                text_x_advance(&ui_context.font, input->buffer.data, input->buffer.size, 1.0f);
 
             input->buffer.data[--input->buffer.size] = '\0';
             if (x_advance >= width)
@@ -3402,7 +3454,7 @@ void ui_window_add_text_c(V2 position, V4 color, const char* text, b8 scrolling,
     u32 new_lines = 0;
     f32 x_advance = 0.0f;
     ui_context.current_window_index_count +=
-        text_generation_color(ui_context.font.chars, text, UI_FONT_TEXTURE,
+        text_generation_color(&ui_context.font, text, UI_FONT_TEXTURE,
                               get_text_position(position), 1.0f, ui_context.font.line_height, color,
                               &new_lines, &x_advance, NULL, &ui_context.render.vertices);
 
@@ -3427,7 +3479,7 @@ void ui_window_add_text_colored(V2 position, const ColoredCharacterArray* text,
     u32 new_lines = 0;
     f32 x_advance = 0.0f;
     ui_context.current_window_index_count += text_generation_colored_char(
-        ui_context.font.chars, text, UI_FONT_TEXTURE, get_text_position(position), 1.0f,
+        &ui_context.font, text, UI_FONT_TEXTURE, get_text_position(position), 1.0f,
         ui_context.font.line_height, &new_lines, &x_advance, NULL, &ui_context.render.vertices);
 
     text_set_scrolling_and_layout(window, layout, relative_position, new_lines + 1, x_advance,
@@ -3461,7 +3513,7 @@ V2 ui_window_get_button_dimensions(V2 dimensions, const char* text, f32* x_advan
     f32 pixel_height = 10.0f;
     if (text)
     {
-        x_advance += text_x_advance(ui_context.font.chars, text, (u32)strlen(text), 1.0f);
+        x_advance += text_x_advance(&ui_context.font, text, (u32)strlen(text), 1.0f);
         pixel_height += ui_context.font.pixel_height;
 
         if (x_advance_out)
@@ -3524,7 +3576,7 @@ b8 ui_window_add_button(V2 position, V2* dimensions, const V4* color, const char
         V2 text_position = v2f(position.x + middle(end_dimensions.width, x_advance),
                                position.y + ui_context.font.pixel_height + 2.0f);
         ui_context.current_window_index_count += text_generation(
-            ui_context.font.chars, text, UI_FONT_TEXTURE, text_position, 1.0f,
+            &ui_context.font, text, UI_FONT_TEXTURE, text_position, 1.0f,
             ui_context.font.line_height, NULL, NULL, NULL, &ui_context.render.vertices);
     }
     ui_layout_set_width_and_height(layout, button_aabb.size.width, button_aabb.size.height);
@@ -4255,7 +4307,7 @@ internal AABB directory_item_render_icon(const V2 position, const V2 size, const
 }
 
 internal b8 directory_item(V2 starting_position, V2 item_dimensions, const i32 item_index,
-                           DirectoryItem* item, i32* hit_index, List* list)
+                           DirectoryItem* item, char* label, i32* hit_index, List* list)
 {
     const u32 window_index = ui_context.id_to_index.data[ui_context.current_window_id];
     UiWindow* window = ui_context.windows.data + window_index;
@@ -4285,21 +4337,21 @@ internal b8 directory_item(V2 starting_position, V2 item_dimensions, const i32 i
     {
         char buffer[100] = { 0 };
         file_format_size(item->size, buffer, 100);
-        x_advance = text_x_advance(ui_context.font.chars, buffer, (u32)strlen(buffer), 1.0f);
+        x_advance = text_x_advance(&ui_context.font, buffer, (u32)strlen(buffer), 1.0f);
         V2 size_text_position = text_position;
         size_text_position.x = starting_position.x + item_dimensions.width - x_advance - 10.0f;
         add_text(window, size_text_position, buffer);
     }
     ui_context.current_window_index_count += display_text_and_truncate_if_necissary(
         text_position, (item_dimensions.width - icon_aabb.size.x - 20.0f - x_advance),
-        window->alpha, item_name(item));
+        window->alpha, label ? label : item_name(item));
 
     return hit && hover_clicked_index.double_clicked;
 }
 
 internal b8 directory_item_grid(V2 starting_position, V2 item_dimensions, const i32 item_index,
-                                ThreadTaskQueue* task_queue, SafeIdTexturePropertiesArray* textures,
-                                SafeObjectThumbnailArray* objects, DirectoryItem* item,
+                                ThreadTaskQueue* task_queue, ThreadChannel* textures,
+                                ThreadChannel* objects, DirectoryItem* item,
                                 i32* hit_index, List* list)
 {
     const u32 window_index = ui_context.id_to_index.data[ui_context.current_window_id];
@@ -4366,13 +4418,11 @@ internal b8 directory_item_grid(V2 starting_position, V2 item_dimensions, const
                 LoadThumpnailData* thumbnail_data =
                     (LoadThumpnailData*)calloc(1, sizeof(LoadThumpnailData));
                 thumbnail_data->file_id = guid_copy(&item->id);
-                thumbnail_data->array = textures;
+                thumbnail_data->textures = textures;
                 thumbnail_data->file_path = string_copy_d(item->path);
                 thumbnail_data->size = 256;
-                ThreadTask task = {
-                    .data = thumbnail_data,
-                    .task_callback = load_thumpnails,
-                };
+                thread_channel_retain(textures);
+                ThreadTask task = thread_task(load_thumpnails, thumbnail_data);
                 thread_tasks_push(task_queue, &task, 1, NULL);
                 item->reload_thumbnail = true;
             }
@@ -4381,15 +4431,17 @@ internal b8 directory_item_grid(V2 starting_position, V2 item_dimensions, const
                 ObjectThumbnailData* thumbnail_data =
                     (ObjectThumbnailData*)calloc(1, sizeof(ObjectThumbnailData));
                 thumbnail_data->file_id = guid_copy(&item->id);
-                thumbnail_data->array = objects;
+                thumbnail_data->cache_key =
+                    thumbnail_cache_key(item->path, item->last_write_time, item->size);
+                thumbnail_data->objects = objects;
+                thumbnail_data->textures = textures;
                 thumbnail_data->file_path = string_copy_d(item->path);
+                thread_channel_retain(objects);
+                thread_channel_retain(textures);
 
                 item->texture_width = 256;
                 item->texture_height = item->texture_width;
-                ThreadTask task = {
-                    .data = thumbnail_data,
-                    .task_callback = object_load_thumbnail,
-                };
+                ThreadTask task = thread_task(object_load_thumbnail, thumbnail_data);
                 thread_tasks_push(task_queue, &task, 1, NULL);
                 item->reload_thumbnail = true;
             }
@@ -4410,7 +4462,7 @@ internal b8 directory_item_grid(V2 starting_position, V2 item_dimensions, const
     const f32 total_available_width_for_text = item_dimensions.width;
 
     f32 x_advance =
-        text_x_advance(ui_context.font.chars, item_name(item), (u32)strlen(item_name(item)), 1.0f);
+        text_x_advance(&ui_context.font, item_name(item), (u32)strlen(item_name(item)), 1.0f);
 
     x_advance = ftic_min(x_advance, total_available_width_for_text);
 
@@ -4424,7 +4476,7 @@ internal b8 directory_item_grid(V2 starting_position, V2 item_dimensions, const
     return hit && hover_clicked_index.double_clicked;
 }
 
-internal void increase_index(i32 what_to_increase, DirectoryItemArray* items, List* list)
+internal b8 increase_index(i32 what_to_increase, DirectoryItemArray* items, List* list)
 {
     const i32 high = (i32)items->size - 1;
     const i32 low = 0;
@@ -4453,6 +4505,42 @@ internal void increase_index(i32 what_to_increase, DirectoryItemArray* items, Li
             item = items->data + (list->last_selected_index - what_to_increase);
             directory_remove_selected_item(&list->selected_item_values, item->id);
         }
+        return true;
+    }
+    return false;
+}
+
+internal void visible_row_range(const f32 first_row_y, const f32 row_height, const f32 row_stride,
+                                const i32 row_count, const UiWindow* window, i32* first_row,
+                                i32* last_row)
+{
+    // Same bounds as item_in_view, solved for the row index.
+    const f32 top = window->position.y - row_height;
+    const f32 bottom = window->position.y + window->size.height;
+    *first_row = ftic_max((i32)ceilf((top - first_row_y) / row_stride), 0);
+    *last_row = ftic_min((i32)floorf((bottom - first_row_y) / row_stride), row_count - 1);
+}
+
+internal void scroll_row_into_view(UiWindow* window, const f32 first_row_y, const i32 row,
+                                   const f32 row_height, const f32 row_stride)
+{
+    const f32 row_y = first_row_y + (row * row_stride) + window->end_scroll_offset;
+    const f32 top = window->position.y;
+    const f32 bottom = window->position.y + window->size.height;
+    f32 offset = window->end_scroll_offset;
+    if (row_y < top)
+    {
+        offset += top - row_y;
+    }
+    else if (row_y + row_height > bottom)
+    {
+        offset -= (row_y + row_height) - bottom;
+    }
+    if (offset != window->end_scroll_offset)
+    {
+        window->scroll_x = 0.0f;
+        window->start_scroll_offset = window->current_scroll_offset;
+        window->end_scroll_offset = offset;
     }
 }
 
@@ -4482,54 +4570,68 @@ internal void check_and_open_input_for_rename(const V2 position, const V2 size,
 }
 
 i32 ui_window_add_directory_item_list(V2 position, const f32 item_height, DirectoryItemArray* items,
-                                      List* list, i32* hit_index, UiLayout* layout)
+                                      const CharPtrArray* labels, List* list, i32* hit_index,
+                                      UiLayout* layout)
 {
     const u32 window_index = ui_context.id_to_index.data[ui_context.current_window_id];
     UiWindow* window = ui_context.windows.data + window_index;
     V2 relative_position = position;
+    const f32 first_item_y = add_first_item_offset(position).y;
     position = add_scroll_offset(window, add_first_item_offset(position));
 
     V2 item_dimensions = v2f(window->size.width - relative_position.x, item_height);
+    const f32 item_stride = item_height + ui_list_padding;
 
     const b8 enter_presssed = event_is_key_pressed_once(FTIC_KEY_ENTER);
 
     if (list && window_index == ui_context.window_in_focus && items->size)
     {
+        b8 moved = false;
         if (event_is_key_pressed_repeat(FTIC_KEY_DOWN))
         {
-            increase_index(1, items, list);
+            moved = increase_index(1, items, list);
         }
         else if (event_is_key_pressed_repeat(FTIC_KEY_UP))
         {
-            increase_index(-1, items, list);
+            moved = increase_index(-1, items, list);
+        }
+        if (moved)
+        {
+            scroll_row_into_view(window, first_item_y, list->last_selected_index, item_height,
+                                 item_stride);
         }
     }
 
+    // Only the rows that intersect the window are touched, the rest of the
+    // list is accounted for by its height.
+    i32 first_visible = 0;
+    i32 last_visible = -1;
+    visible_row_range(position.y, item_dimensions.height, item_stride, (i32)items->size, window,
+                      &first_visible, &last_visible);
+
     if (list) list->input_index = -1;
     i32 double_clicked_index = -1;
-    f32 height = 0.0f;
-    for (i32 i = 0; i < (i32)items->size; ++i)
+    for (i32 i = first_visible; i <= last_visible; ++i)
     {
-        if (item_in_view(position.y, item_dimensions.height, window->position.y,
-                         window->size.height))
+        const V2 item_position = v2f(position.x, position.y + (i * item_stride));
+        DirectoryItem* item = items->data + i;
+        char* label = labels ? labels->data[i] : NULL;
+        if (directory_item(item_position, item_dimensions, i, item, label, hit_index, list))
         {
-            DirectoryItem* item = items->data + i;
-            if (directory_item(position, item_dimensions, i, item, hit_index, list))
-            {
-                double_clicked_index = i;
-            }
-            const f32 icon_size = 24.0f;
-            V2 input_field_position = v2f(relative_position.x + icon_size + 20.0f,
-                                          relative_position.y + window->current_scroll_offset);
-            check_and_open_input_for_rename(
-                input_field_position,
-                v2f((item_dimensions.width * 0.9f) - (icon_size + 20.0f), item_dimensions.height),
-                enter_presssed, item, list);
+            double_clicked_index = i;
         }
-        height += item_height + ui_list_padding;
-        position.y += item_height + ui_list_padding;
-        relative_position.y += item_height + ui_list_padding;
-    }
+        const f32 icon_size = 24.0f;
+        V2 input_field_position =
+            v2f(relative_position.x + icon_size + 20.0f,
+                relative_position.y + (i * item_stride) + window->current_scroll_offset);
+        check_and_open_input_for_rename(
+            input_field_position,
+            v2f((item_dimensions.width * 0.9f) - (icon_size + 20.0f), item_dimensions.height),
+            enter_presssed, item, list);
+    }
+    const f32 height = items->size * item_stride;
+    relative_position.y += height;
+
     // TODO: add this for all components.
     ui_context.current_window_total_height =
         ftic_max(ui_context.current_window_total_height, relative_position.y + item_height);
@@ -4540,24 +4642,25 @@ i32 ui_window_add_directory_item_list(V2 position, const f32 item_height, Direct
 
 i32 ui_window_add_directory_item_grid(V2 position, DirectoryItemArray* items,
                                       ThreadTaskQueue* task_queue,
-                                      SafeIdTexturePropertiesArray* textures,
-                                      SafeObjectThumbnailArray* objects, i32* hit_index, List* list)
+                                      ThreadChannel* textures, ThreadChannel* objects,
+                                      i32* hit_index, List* list)
 {
     const u32 window_index = ui_context.id_to_index.data[ui_context.current_window_id];
     UiWindow* window = ui_context.windows.data + window_index;
     V2 relative_position = position;
+    const f32 first_item_y = add_first_item_offset(position).y;
     position = add_scroll_offset(window, add_first_item_offset(position));
 
     V2 item_dimensions = v2i(ui_big_icon_size);
     item_dimensions.height += (ui_context.font.pixel_height + 5.0f);
 
-    const u32 item_count = items->size;
+    const i32 item_count = (i32)items->size;
     const f32 grid_padding = 10.0f + ui_list_padding;
     const f32 total_area_space = window->size.width - relative_position.x;
     const i32 columns =
         ftic_max((i32)(total_area_space / (item_dimensions.width + grid_padding)), 1);
-    const i32 rows = item_count / columns;
-    const i32 last_row = item_count % columns;
+    const i32 rows = (item_count + columns - 1) / columns;
+    const f32 row_stride = item_dimensions.height + grid_padding;
 
     const f32 total_items_width = columns * item_dimensions.width;
     const f32 remaining_space = total_area_space - total_items_width;
@@ -4568,67 +4671,60 @@ i32 ui_window_add_directory_item_grid(V2 position, DirectoryItemArray* items,
 
     if (list && window_index == ui_context.window_in_focus && items->size)
     {
+        b8 moved = false;
         if (event_is_key_pressed_repeat(FTIC_KEY_RIGHT))
         {
-            increase_index(1, items, list);
+            moved = increase_index(1, items, list);
         }
         else if (event_is_key_pressed_repeat(FTIC_KEY_LEFT))
         {
-            increase_index(-1, items, list);
+            moved = increase_index(-1, items, list);
         }
         else if (event_is_key_pressed_repeat(FTIC_KEY_UP))
         {
-            increase_index(-columns, items, list);
+            moved = increase_index(-columns, items, list);
         }
         else if (event_is_key_pressed_repeat(FTIC_KEY_DOWN))
         {
-            increase_index(columns, items, list);
+            moved = increase_index(columns, items, list);
+        }
+        if (moved)
+        {
+            scroll_row_into_view(window, first_item_y, list->last_selected_index / columns,
+                                 item_dimensions.height, row_stride);
         }
     }
 
+    i32 first_visible_row = 0;
+    i32 last_visible_row = -1;
+    visible_row_range(position.y, item_dimensions.height, row_stride, rows, window,
+                      &first_visible_row, &last_visible_row);
+
     if (list) list->input_index = -1;
     i32 selected_index = -1;
-    for (i32 row = 0; row < rows; ++row)
+    for (i32 row = first_visible_row; row <= last_visible_row; ++row)
     {
-        if (item_in_view(position.y, item_dimensions.height, window->position.y,
-                         window->size.height))
+        V2 item_position = v2f(start_x, position.y + (row * row_stride));
+        const i32 row_columns = ftic_min(columns, item_count - (row * columns));
+        for (i32 column = 0; column < row_columns; ++column)
         {
-            for (i32 column = 0; column < columns; ++column)
+            const i32 index = (row * columns) + column;
+            DirectoryItem* item = items->data + index;
+            if (directory_item_grid(item_position, item_dimensions, index, task_queue, textures,
+                                    objects, item, hit_index, list))
             {
-                const i32 index = (row * columns) + column;
-                DirectoryItem* item = items->data + index;
-                if (directory_item_grid(position, item_dimensions, index, task_queue, textures,
-                                        objects, item, hit_index, list))
-                {
-                    selected_index = index;
-                }
-                if (item->rename && list && list->inputs.data[list->input_index].active)
-                {
-                    InputBuffer* input = list->inputs.data + list->input_index;
-                    input->active = false;
-                    item->rename = false;
-                }
-                position.x += item_dimensions.width + grid_padding_width;
+                selected_index = index;
             }
-            position.x = start_x;
-        }
-        position.y += item_dimensions.height + grid_padding;
-        relative_position.y += item_dimensions.height + grid_padding;
-    }
-    if (item_in_view(position.y, item_dimensions.height, window->position.y, window->size.height))
-    {
-        for (i32 column = 0; column < last_row; ++column)
-        {
-            const i32 index = (rows * columns) + column;
-            if (directory_item_grid(position, item_dimensions, index, task_queue, textures, objects,
-                                    items->data + index, hit_index, list))
+            if (item->rename && list && list->inputs.data[list->input_index].active)
             {
-                selected_index = index;
+                InputBuffer* input = list->inputs.data + list->input_index;
+                input->active = false;
+                item->rename = false;
             }
-            position.x += item_dimensions.width + grid_padding_width;
+            item_position.x += item_dimensions.width + grid_padding_width;
         }
     }
-    relative_position.y += (item_dimensions.height + grid_padding) * (last_row > 0);
+    relative_position.y += rows * row_stride;
 
     ui_context.current_window_total_height =
         ftic_max(ui_context.current_window_total_height,
@@ -228,7 +228,7 @@ char* ui_input_buffer_get_selection_as_string(InputBuffer* input);
 void ui_input_buffer_copy_selection_to_clipboard(InputBuffer* input);
 void ui_input_buffer_erase_from_selection(InputBuffer* input);
 
-void ui_context_create();
+void ui_context_create(ThreadTaskQueue* task_queue);
 void ui_context_begin(const V2 dimensions, const AABB* dock_space, const f64 delta_time, const b8 check_collisions);
 void ui_context_end();
 void ui_context_destroy();
@@ -260,6 +260,8 @@ void ui_context_set_window_bottom_color(V4 color);
 
 u32 ui_window_create();
 const UiWindow* ui_window_get(const u32 window_id);
+// Screen position that item positions are relative to, between begin and end.
+V2 ui_window_get_first_item_position();
 u32 ui_window_in_focus();
 b8 ui_window_begin(u32 window_id, const char* title, u8 flags);
 b8 ui_window_end();
@@ -309,5 +311,7 @@ void ui_window_add_radio_button(V2 position, const V2 size, b8* selected, UiLayo
 
 // (NOTE): this is very specific for this project and maybe should be implemented outside this ui.
 b8 ui_window_add_movable_list(V2 position, DirectoryItemArray* items, i32* hit_index, MovableList* list);
-i32 ui_window_add_directory_item_list(V2 position, const f32 item_height, DirectoryItemArray* items, List* list, i32* hit_index, UiLayout* layout);
-i32 ui_window_add_directory_item_grid(V2 position, DirectoryItemArray* items, ThreadTaskQueue* task_queue, SafeIdTexturePropertiesArray* textures, SafeObjectThumbnailArray* objects, i32* hit_index, List* list);
+// labels, when given, holds a name per item to show instead of its own, NULL
+// entries keep the item name.
+i32 ui_window_add_directory_item_list(V2 position, const f32 item_height, DirectoryItemArray* items, const CharPtrArray* labels, List* list, i32* hit_index, UiLayout* layout);
+i32 ui_window_add_directory_item_grid(V2 position, DirectoryItemArray* items, ThreadTaskQueue* task_queue, ThreadChannel* textures, ThreadChannel* objects, i32* hit_index, List* list);
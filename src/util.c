@@ -2,6 +2,8 @@
 #include "logging.h"
 #include "object_load.h"
 #include "platform/platform.h"
+#include "profiler.h"
+#include "thumbnail_cache.h"
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
@@ -429,24 +431,34 @@ AABB3D mesh_3d_load(Mesh3D* mesh, const char* object_path,
 void object_load_thumbnail(void* data)
 {
     ObjectThumbnailData* arguments = (ObjectThumbnailData*)data;
+    PROFILE_FUNCTION_BEGIN();
 
-    ObjectThumbnail thumbnail = { .id = guid_copy(&arguments->file_id) };
-    thumbnail.mesh_aabb =
-        mesh_3d_load(&thumbnail.mesh, arguments->file_path, 0.0f);
-
-    platform_mutex_lock(&arguments->array->mutex);
-    if (arguments->array->array.data == NULL)
+    IdTextureProperties cached = { .id = guid_copy(&arguments->file_id) };
+    if (thumbnail_cache_load(arguments->cache_key, &cached.texture_properties))
+    {
+        if (!thread_channel_push(arguments->textures, &cached, 1))
+        {
+            free(cached.texture_properties.bytes);
+        }
+    }
+    else
     {
-        array_free(&thumbnail.mesh.vertices);
-        array_free(&thumbnail.mesh.indices);
-        free(arguments->file_path);
-        free(arguments);
-        return;
+        ObjectThumbnail thumbnail = {
+            .id = guid_copy(&arguments->file_id),
+            .cache_key = arguments->cache_key,
+        };
+        thumbnail.mesh_aabb = mesh_3d_load(&thumbnail.mesh, arguments->file_path, 0.0f);
+        if (!thread_channel_push(arguments->objects, &thumbnail, 1))
+        {
+            array_free(&thumbnail.mesh.vertices);
+            array_free(&thumbnail.mesh.indices);
+        }
     }
-    array_push(&arguments->array->array, thumbnail);
-    platform_mutex_unlock(&arguments->array->mutex);
+    thread_channel_release(arguments->objects);
+    thread_channel_release(arguments->textures);
     free(arguments->file_path);
     free(arguments);
+    PROFILE_END();
 }
 
 u32 append_full_path(const char* path, char* destination)
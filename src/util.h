@@ -3,6 +3,8 @@
 #include "math/ftic_math.h"
 #include "hash_table.h"
 #include "collision.h"
+#include "texture.h"
+#include "thread_queue.h"
 
 typedef struct Vertex
 {
@@ -12,6 +14,19 @@ typedef struct Vertex
     f32 texture_index;
 } Vertex;
 
+// One 2D quad, expanded to its corners in vertex_quad.glsl. The corners are
+// position, position + edge_y, position + edge_x + edge_y and position + edge_x,
+// which for plain rectangles means edge_x = (width, 0) and edge_y = (0, height).
+typedef struct QuadInstance
+{
+    V2 position;
+    V2 edge_x;
+    V2 edge_y;
+    V4 texture_coordinates;
+    u32 colors[4];
+    f32 texture_index;
+} QuadInstance;
+
 typedef struct Vertex3D
 {
     V4 color;
@@ -41,12 +56,20 @@ typedef struct IndexArray
     u32* data;
 } IndexArray, U32Array;
 
-typedef struct VertexArray
+typedef struct QuadArray
 {
     u32 size;
     u32 capacity;
-    Vertex* data;
-} VertexArray;
+    QuadInstance* data;
+    // Set when data points into a mapped stream buffer, it is then never
+    // reallocated in place.
+    b8 mapped;
+    // When set every pushed quad is folded into content_hash, to be able to
+    // tell if this frame looks the same as the last one. The mapped memory is
+    // write only, so it can not be hashed afterwards.
+    b8 hash_content;
+    u64 content_hash;
+} QuadArray;
 
 typedef struct Vertex3DArray
 {
@@ -93,6 +116,7 @@ typedef struct Mesh3D
 typedef struct ObjectThumbnail
 {
     FticGUID id;
+    u64 cache_key;
     Mesh3D mesh;
     AABB3D mesh_aabb;
 } ObjectThumbnail;
@@ -104,17 +128,16 @@ typedef struct ObjectThumbnailArray
     ObjectThumbnail* data;
 } ObjectThumbnailArray;
 
-typedef struct SafeObjectThumbnailArray
-{
-    ObjectThumbnailArray array;
-    FTicMutex mutex;
-} SafeObjectThumbnailArray;
-
+// A thumbnail found in the cache goes to textures, like an image thumbnail,
+// otherwise the mesh is loaded and goes to objects to be rendered. The task
+// holds a reference to both channels.
 typedef struct ObjectThumbnailData
 {
     FticGUID file_id;
+    u64 cache_key;
     char* file_path;
-    SafeObjectThumbnailArray* array;
+    ThreadChannel* objects;  // ObjectThumbnail
+    ThreadChannel* textures; // IdTextureProperties
 } ObjectThumbnailData;
 
 FileAttrib file_read(const char* file_path);
@@ -4,6 +4,7 @@
 #define EQUALS_FORMAT_FLOAT "Expected: %f, Actual: %f\n"
 #define EQUALS_FORMAT_U32 "Expected: %u, Actual: %u\n"
 #define EQUALS_FORMAT_I32 "Expected: %d, Actual: %d\n"
+#define EQUALS_FORMAT_U64 "Expected: %llu, Actual: %llu\n"
 #define EQUALS_FORMAT_PTR "Expected: %p, Actual: %p\n"
 
 #define FILE_LINE_FORMAT "%s:%d: \n", file, line
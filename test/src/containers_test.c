@@ -0,0 +1,403 @@
+#include "containers_test.h"
+#include "containers.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <stdlib.h>
+// @save
+
+// This code is generated
+
+global u32 g_total_test_failed_count = 0;
+
+#define CONTAINERS_TEST_ROUNDS 10000
+
+void containers_test_begin()
+{
+    printf("Containers tests:\n");
+}
+
+void containers_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void containers_test_print(const char* name, const f64 start, const u32 operations)
+{
+    const f64 seconds = platform_get_time() - start;
+    printf("\t%s: %.2f ns/op\n", name, (seconds * 1e9) / operations);
+}
+
+// @end
+
+void small_vector_test_u32()
+{
+    SmallVectorU32 vector;
+    small_vector_init_u32(&vector);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        small_vector_push_u32(&vector, (u32)i);
+    }
+    u32* data = small_vector_data_u32(&vector);
+    ASSERT_TRUE(vector.heap == NULL);
+    ASSERT_TRUE(data == vector.inline_data);
+
+    small_vector_push_u32(&vector, (u32)16);
+    data = small_vector_data_u32(&vector);
+    ASSERT_TRUE(vector.heap != NULL);
+    ASSERT_TRUE(data == vector.heap);
+    ASSERT_EQUALS(16 * 2, vector.capacity, EQUALS_FORMAT_U32);
+    for (u32 i = 16 + 1; i < 16 * 4 + 1; ++i)
+    {
+        small_vector_push_u32(&vector, (u32)i);
+    }
+    ASSERT_EQUALS(16 * 4 + 1, vector.size, EQUALS_FORMAT_U32);
+    data = small_vector_data_u32(&vector);
+    b8 kept = true;
+    for (u32 i = 0; i < vector.size; ++i)
+    {
+        kept &= data[i] == (u32)i;
+    }
+    ASSERT_TRUE(kept);
+
+    small_vector_free_u32(&vector);
+    ASSERT_TRUE(vector.heap == NULL);
+    ASSERT_EQUALS(0, vector.size, EQUALS_FORMAT_U32);
+}
+
+void small_vector_benchmark_u32()
+{
+    u64 sum = 0;
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        SmallVectorU32 vector;
+        small_vector_init_u32(&vector);
+        for (u32 i = 0; i < 16; ++i)
+        {
+            small_vector_push_u32(&vector, (u32)i);
+        }
+        u32* data = small_vector_data_u32(&vector);
+        for (u32 i = 0; i < vector.size; ++i)
+        {
+            sum += (u64)data[i];
+        }
+        small_vector_free_u32(&vector);
+    }
+    containers_test_print("small vector push inline", start, CONTAINERS_TEST_ROUNDS * 16);
+    ASSERT_EQUALS((u64)CONTAINERS_TEST_ROUNDS * (16 * (16 - 1) / 2), sum, EQUALS_FORMAT_U64);
+}
+
+void ring_buffer_test_u32()
+{
+    RingBufferU32 ring = ring_buffer_create_u32(4);
+    ASSERT_EQUALS(4, ring.capacity, EQUALS_FORMAT_U32);
+    u32 pushed = 0;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        pushed += ring_buffer_push_u32(&ring, (u32)i);
+    }
+    ASSERT_EQUALS(4, pushed, EQUALS_FORMAT_U32);
+    b8 result = ring_buffer_push_u32(&ring, (u32)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    u32 size = ring_buffer_size_u32(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+
+    // Two out and two more in, the tail wraps to the front of the array.
+    u32 value;
+    b8 in_order = true;
+    for (u32 i = 0; i < 2; ++i)
+    {
+        result = ring_buffer_pop_u32(&ring, &value);
+        in_order &= result && value == (u32)i;
+    }
+    pushed = ring_buffer_push_u32(&ring, (u32)4);
+    pushed += ring_buffer_push_u32(&ring, (u32)5);
+    ASSERT_EQUALS(2, pushed, EQUALS_FORMAT_U32);
+    result = ring_buffer_push_u32(&ring, (u32)6);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    for (u32 i = 2; i < 6; ++i)
+    {
+        result = ring_buffer_pop_u32(&ring, &value);
+        in_order &= result && value == (u32)i;
+    }
+    ASSERT_TRUE(in_order);
+    result = ring_buffer_pop_u32(&ring, &value);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+
+    // The free running head and tail overflow without losing the size.
+    ring.head = 0xFFFFFFFEu;
+    ring.tail = 0xFFFFFFFEu;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        ring_buffer_push_u32(&ring, (u32)i);
+    }
+    size = ring_buffer_size_u32(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+    result = ring_buffer_push_u32(&ring, (u32)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    in_order = true;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        result = ring_buffer_pop_u32(&ring, &value);
+        in_order &= result && value == (u32)i;
+    }
+    ASSERT_TRUE(in_order);
+    size = ring_buffer_size_u32(&ring);
+    ASSERT_EQUALS(0, size, EQUALS_FORMAT_U32);
+    ring_buffer_free_u32(&ring);
+}
+
+void ring_buffer_test_u64()
+{
+    RingBufferU64 ring = ring_buffer_create_u64(4);
+    ASSERT_EQUALS(4, ring.capacity, EQUALS_FORMAT_U32);
+    u32 pushed = 0;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        pushed += ring_buffer_push_u64(&ring, (u64)i);
+    }
+    ASSERT_EQUALS(4, pushed, EQUALS_FORMAT_U32);
+    b8 result = ring_buffer_push_u64(&ring, (u64)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    u32 size = ring_buffer_size_u64(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+
+    // Two out and two more in, the tail wraps to the front of the array.
+    u64 value;
+    b8 in_order = true;
+    for (u32 i = 0; i < 2; ++i)
+    {
+        result = ring_buffer_pop_u64(&ring, &value);
+        in_order &= result && value == (u64)i;
+    }
+    pushed = ring_buffer_push_u64(&ring, (u64)4);
+    pushed += ring_buffer_push_u64(&ring, (u64)5);
+    ASSERT_EQUALS(2, pushed, EQUALS_FORMAT_U32);
+    result = ring_buffer_push_u64(&ring, (u64)6);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    for (u32 i = 2; i < 6; ++i)
+    {
+        result = ring_buffer_pop_u64(&ring, &value);
+        in_order &= result && value == (u64)i;
+    }
+    ASSERT_TRUE(in_order);
+    result = ring_buffer_pop_u64(&ring, &value);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+
+    // The free running head and tail overflow without losing the size.
+    ring.head = 0xFFFFFFFEu;
+    ring.tail = 0xFFFFFFFEu;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        ring_buffer_push_u64(&ring, (u64)i);
+    }
+    size = ring_buffer_size_u64(&ring);
+    ASSERT_EQUALS(4, size, EQUALS_FORMAT_U32);
+    result = ring_buffer_push_u64(&ring, (u64)4);
+    ASSERT_EQUALS(false, result, EQUALS_FORMAT_U32);
+    in_order = true;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        result = ring_buffer_pop_u64(&ring, &value);
+        in_order &= result && value == (u64)i;
+    }
+    ASSERT_TRUE(in_order);
+    size = ring_buffer_size_u64(&ring);
+    ASSERT_EQUALS(0, size, EQUALS_FORMAT_U32);
+    ring_buffer_free_u64(&ring);
+}
+
+void ring_buffer_benchmark_u32()
+{
+    RingBufferU32 ring = ring_buffer_create_u32(1024);
+    u64 sum = 0;
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 1024; ++i)
+        {
+            ring_buffer_push_u32(&ring, (u32)i);
+        }
+        u32 value;
+        while (ring_buffer_pop_u32(&ring, &value))
+        {
+            sum += (u64)value;
+        }
+    }
+    containers_test_print("ring buffer push and pop", start, CONTAINERS_TEST_ROUNDS * 1024);
+    ASSERT_EQUALS((u64)CONTAINERS_TEST_ROUNDS * (1024 * 1023 / 2), sum, EQUALS_FORMAT_U64);
+    ring_buffer_free_u32(&ring);
+}
+
+void ring_buffer_benchmark_u64()
+{
+    RingBufferU64 ring = ring_buffer_create_u64(1024);
+    u64 sum = 0;
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 1024; ++i)
+        {
+            ring_buffer_push_u64(&ring, (u64)i);
+        }
+        u64 value;
+        while (ring_buffer_pop_u64(&ring, &value))
+        {
+            sum += (u64)value;
+        }
+    }
+    containers_test_print("ring buffer push and pop", start, CONTAINERS_TEST_ROUNDS * 1024);
+    ASSERT_EQUALS((u64)CONTAINERS_TEST_ROUNDS * (1024 * 1023 / 2), sum, EQUALS_FORMAT_U64);
+    ring_buffer_free_u64(&ring);
+}
+
+void pool_list_test_u64()
+{
+    PoolListU64 list = pool_list_create_u64(16);
+    u32 handles[5];
+    for (u32 i = 0; i < 5; ++i)
+    {
+        handles[i] = pool_list_push_back_u64(&list, (u64)i);
+    }
+
+    // From the middle, then the head, then the tail. The links have to hold
+    // walking both ways.
+    pool_list_remove_u64(&list, handles[2]);
+    pool_list_remove_u64(&list, handles[0]);
+    pool_list_remove_u64(&list, handles[4]);
+    ASSERT_EQUALS(2, list.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[1], list.head, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[3], list.tail, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.nodes[list.head].prev, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[3], list.nodes[list.head].next, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(handles[1], list.nodes[list.tail].prev, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.nodes[list.tail].next, EQUALS_FORMAT_U32);
+
+    // The last freed node is used first.
+    const u32 handle = pool_list_push_back_u64(&list, (u64)5);
+    ASSERT_EQUALS(handles[4], handle, EQUALS_FORMAT_U32);
+
+    // Growing the pool keeps the handles.
+    for (u32 i = 0; i < 40; ++i)
+    {
+        pool_list_push_back_u64(&list, (u64)(i + 6));
+    }
+    ASSERT_TRUE(list.capacity > 16);
+    ASSERT_TRUE(list.nodes[handles[1]].value == (u64)1);
+    ASSERT_TRUE(list.nodes[handles[3]].value == (u64)3);
+    ASSERT_TRUE(list.nodes[handles[4]].value == (u64)5);
+    u32 count = 0;
+    for (u32 node = list.head; node != POOL_LIST_NONE; node = list.nodes[node].next)
+    {
+        ++count;
+    }
+    ASSERT_EQUALS(list.size, count, EQUALS_FORMAT_U32);
+    pool_list_free_u64(&list);
+}
+
+void pool_list_benchmark_u64()
+{
+    PoolListU64 list = pool_list_create_u64(16);
+    u32* handles = (u32*)malloc(1024 * sizeof(u32));
+    const f64 start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 1024; ++i)
+        {
+            handles[i] = pool_list_push_back_u64(&list, (u64)i);
+        }
+        for (u32 i = 0; i < 1024; i += 2)
+        {
+            pool_list_remove_u64(&list, handles[i]);
+        }
+        for (u32 i = 1; i < 1024; i += 2)
+        {
+            pool_list_remove_u64(&list, handles[i]);
+        }
+    }
+    containers_test_print("pool list push and remove", start, CONTAINERS_TEST_ROUNDS * 1024);
+    ASSERT_EQUALS(0, list.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(POOL_LIST_NONE, list.head, EQUALS_FORMAT_U32);
+    free(handles);
+    pool_list_free_u64(&list);
+}
+
+void flat_map_test_u64_u32()
+{
+    FlatMapU64U32 map = flat_map_create_u64_u32(16);
+    flat_map_insert_u64_u32(&map, (u64)5, (u32)50);
+    flat_map_insert_u64_u32(&map, (u64)1, (u32)10);
+    flat_map_insert_u64_u32(&map, (u64)3, (u32)30);
+    ASSERT_EQUALS(3, map.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(map.keys[0] == (u64)1 && map.keys[1] == (u64)3 && map.keys[2] == (u64)5);
+
+    // An existing key gets the new value, not a second entry.
+    flat_map_insert_u64_u32(&map, (u64)3, (u32)33);
+    ASSERT_EQUALS(3, map.size, EQUALS_FORMAT_U32);
+    u32* value = flat_map_get_u64_u32(&map, (u64)3);
+    ASSERT_TRUE(value && *value == (u32)33);
+
+    u32 removed = flat_map_remove_u64_u32(&map, (u64)3);
+    removed += flat_map_remove_u64_u32(&map, (u64)3);
+    removed += flat_map_remove_u64_u32(&map, (u64)4);
+    ASSERT_EQUALS(1, removed, EQUALS_FORMAT_U32);
+    value = flat_map_get_u64_u32(&map, (u64)3);
+    ASSERT_TRUE(value == NULL);
+    ASSERT_EQUALS(2, map.size, EQUALS_FORMAT_U32);
+    value = flat_map_get_u64_u32(&map, (u64)5);
+    ASSERT_TRUE(value && *value == (u32)50);
+
+    // First and last.
+    removed = flat_map_remove_u64_u32(&map, (u64)1);
+    removed += flat_map_remove_u64_u32(&map, (u64)5);
+    ASSERT_EQUALS(2, removed, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, map.size, EQUALS_FORMAT_U32);
+
+    // Inserted backwards past the first capacity, still sorted.
+    for (u32 i = 40; i > 0; --i)
+    {
+        flat_map_insert_u64_u32(&map, (u64)i, (u32)(i * 10));
+    }
+    ASSERT_EQUALS(40, map.size, EQUALS_FORMAT_U32);
+    b8 sorted = true;
+    for (u32 i = 0; i < map.size; ++i)
+    {
+        sorted &= map.keys[i] == (u64)(i + 1) && map.values[i] == (u32)((i + 1) * 10);
+    }
+    ASSERT_TRUE(sorted);
+    flat_map_free_u64_u32(&map);
+}
+
+void flat_map_benchmark_u64_u32()
+{
+    FlatMapU64U32 map = flat_map_create_u64_u32(16);
+    const f64 start = platform_get_time();
+    for (u32 i = 0; i < 4096; ++i)
+    {
+        // Spread the keys so inserts land all over the map.
+        flat_map_insert_u64_u32(&map, (u64)((i * 2654435761u) & 0xFFFF), (u32)i);
+    }
+    containers_test_print("flat map insert", start, 4096);
+
+    u32 found = 0;
+    const f64 lookup_start = platform_get_time();
+    for (u32 round = 0; round < CONTAINERS_TEST_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < 256; ++i)
+        {
+            found += flat_map_get_u64_u32(&map, (u64)((i * 2654435761u) & 0xFFFF)) != NULL;
+        }
+    }
+    containers_test_print("flat map lookup", lookup_start, CONTAINERS_TEST_ROUNDS * 256);
+    ASSERT_EQUALS(CONTAINERS_TEST_ROUNDS * 256, found, EQUALS_FORMAT_U32);
+    flat_map_free_u64_u32(&map);
+}
+
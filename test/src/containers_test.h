@@ -0,0 +1,34 @@
+#pragma once
+#include "define.h"
+// @save
+
+// This code is generated, add types in code_generation/src/main.c
+
+void containers_test_begin();
+void containers_test_end();
+void containers_test_run();
+// Timed, only run when the tests are started with --benchmarks.
+void containers_test_run_benchmarks();
+
+// @end
+
+void small_vector_test_u32();
+
+void small_vector_benchmark_u32();
+
+void ring_buffer_test_u32();
+
+void ring_buffer_test_u64();
+
+void ring_buffer_benchmark_u32();
+
+void ring_buffer_benchmark_u64();
+
+void pool_list_test_u64();
+
+void pool_list_benchmark_u64();
+
+void flat_map_test_u64_u32();
+
+void flat_map_benchmark_u64_u32();
+
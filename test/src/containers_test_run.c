@@ -0,0 +1,27 @@
+#include "containers_test.h"
+#include <stdio.h>
+
+// This code is generated, add types in code_generation/src/main.c
+
+void containers_test_run()
+{
+    small_vector_test_u32();
+    ring_buffer_test_u32();
+    ring_buffer_test_u64();
+    pool_list_test_u64();
+    flat_map_test_u64_u32();
+}
+
+void containers_test_run_benchmarks()
+{
+    printf("\tSmallVectorU32\n");
+    small_vector_benchmark_u32();
+    printf("\tRingBufferU32\n");
+    ring_buffer_benchmark_u32();
+    printf("\tRingBufferU64\n");
+    ring_buffer_benchmark_u64();
+    printf("\tPoolListU64\n");
+    pool_list_benchmark_u64();
+    printf("\tFlatMapU64U32\n");
+    flat_map_benchmark_u64_u32();
+}
@@ -0,0 +1,369 @@
+#include "content_index_test.h"
+#include "content_index.h"
+#include "content_search.h"
+#include "platform/platform.h"
+#include "random.h"
+#include "thread_queue.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_DIRECTORY "content_index_test"
+#define TEST_SUB_DIRECTORY "content_index_test/sub"
+#define TEST_INDEX "content_index_test.index"
+#define TEST_NEXT_INDEX "content_index_test_next.index"
+#define TEST_SERVICE_DIRECTORY "content_index_test_service"
+#define TEST_RANDOM_FILE_COUNT 24
+
+global const char* g_test_files[] = {
+    TEST_DIRECTORY "/alpha.txt",     TEST_DIRECTORY "/beta.c",
+    TEST_DIRECTORY "/image.bin",     TEST_SUB_DIRECTORY "/gamma.txt",
+    TEST_SUB_DIRECTORY "/delta.txt", TEST_SUB_DIRECTORY "/epsilon.txt",
+};
+
+void content_index_test_begin()
+{
+    printf("Content index tests:\n");
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_SUB_DIRECTORY);
+}
+
+void content_index_test_end()
+{
+    platform_remove_directory(TEST_SUB_DIRECTORY);
+    platform_remove_directory(TEST_DIRECTORY);
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void write_test_file(const char* path, const char* content, u64 size)
+{
+    FILE* file = fopen(path, "wb");
+    if (file)
+    {
+        fwrite(content, 1, (size_t)size, file);
+        fclose(file);
+    }
+}
+
+internal void write_test_files()
+{
+    const char binary[] = "fox\0fox\0";
+    write_test_file(g_test_files[0], "The quick brown Fox\njumps over\n", 31);
+    write_test_file(g_test_files[1], "int fox_count = 0;\n", 19);
+    write_test_file(g_test_files[2], binary, sizeof(binary) - 1);
+    write_test_file(g_test_files[3], "nothing to see here\n", 20);
+    write_test_file(g_test_files[4], "FOX in a sub folder\n", 20);
+}
+
+internal void delete_test_files()
+{
+    for (u32 i = 0; i < static_array_size(g_test_files); ++i)
+    {
+        platform_delete_file(g_test_files[i]);
+    }
+    platform_delete_file(TEST_INDEX);
+    platform_delete_file(TEST_NEXT_INDEX);
+}
+
+internal b8 has_candidate(const ContentIndex* index, const U32Array* candidates, const char* name)
+{
+    const size_t name_length = strlen(name);
+    for (u32 i = 0; i < candidates->size; ++i)
+    {
+        const char* path = content_index_file_path(index, candidates->data[i]);
+        const size_t path_length = strlen(path);
+        if (path_length > name_length && strcmp(path + path_length - name_length, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+internal u32 query_count(const ContentIndex* index, const char* directory, const char* pattern)
+{
+    U32Array candidates = { 0 };
+    array_create(&candidates, 8);
+    content_index_query(index, directory, pattern, (u32)strlen(pattern), &candidates);
+    const u32 count = candidates.size;
+    array_free(&candidates);
+    return count;
+}
+
+void content_index_test_query()
+{
+    write_test_files();
+    FTicAtomic stop = 0;
+    ContentIndexBuildStats stats = { 0 };
+    ASSERT_TRUE(content_index_build(TEST_DIRECTORY, NULL, TEST_INDEX, &stop, &stats));
+    ASSERT_EQUALS(5, stats.file_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(5, stats.files_read, EQUALS_FORMAT_U32);
+
+    ContentIndex index = { 0 };
+    ASSERT_TRUE(content_index_open(TEST_INDEX, &index));
+
+    // Case insensitive, and the binary file never comes up.
+    U32Array candidates = { 0 };
+    array_create(&candidates, 8);
+    ASSERT_TRUE(content_index_query(&index, NULL, "fOx", 3, &candidates));
+    ASSERT_EQUALS(3, candidates.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(has_candidate(&index, &candidates, "alpha.txt"));
+    ASSERT_TRUE(has_candidate(&index, &candidates, "beta.c"));
+    ASSERT_TRUE(has_candidate(&index, &candidates, "delta.txt"));
+
+    ASSERT_EQUALS(1, query_count(&index, NULL, "quick brown"), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, query_count(&index, NULL, "zebra"), EQUALS_FORMAT_U32);
+    candidates.size = 0;
+    ASSERT_TRUE(!content_index_query(&index, NULL, "fo", 2, &candidates));
+
+    // Only below the folder, which is not the same as the prefix of a path.
+    ASSERT_EQUALS(3, query_count(&index, TEST_DIRECTORY, "fox"), EQUALS_FORMAT_U32);
+    candidates.size = 0;
+    content_index_query(&index, NULL, "sub folder", 10, &candidates);
+    ASSERT_EQUALS(1, candidates.size, EQUALS_FORMAT_U32);
+    if (candidates.size == 1)
+    {
+        const char* path = content_index_file_path(&index, candidates.data[0]);
+        char sub_directory[FTIC_MAX_PATH] = { 0 };
+        memcpy(sub_directory, path, get_path_length(path, (u32)strlen(path)) - 1);
+        ASSERT_EQUALS(1, query_count(&index, sub_directory, "fox"), EQUALS_FORMAT_U32);
+        sub_directory[strlen(sub_directory) - 1] = '\0';
+        ASSERT_EQUALS(0, query_count(&index, sub_directory, "fox"), EQUALS_FORMAT_U32);
+    }
+
+    array_free(&candidates);
+    content_index_close(&index);
+    delete_test_files();
+}
+
+void content_index_test_incremental()
+{
+    write_test_files();
+    FTicAtomic stop = 0;
+    ContentIndexBuildStats stats = { 0 };
+    content_index_build(TEST_DIRECTORY, NULL, TEST_INDEX, &stop, &stats);
+    ContentIndex previous = { 0 };
+    ASSERT_TRUE(content_index_open(TEST_INDEX, &previous));
+
+    // One file changed, one added and one deleted. Only the first two are
+    // read again.
+    write_test_file(g_test_files[1], "int count = 0;\n", 15);
+    write_test_file(g_test_files[5], "a fox again\n", 12);
+    platform_delete_file(g_test_files[0]);
+    ASSERT_TRUE(content_index_build(TEST_DIRECTORY, &previous, TEST_NEXT_INDEX, &stop, &stats));
+    ASSERT_EQUALS(5, stats.file_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(2, stats.files_read, EQUALS_FORMAT_U32);
+    content_index_close(&previous);
+
+    ContentIndex index = { 0 };
+    ASSERT_TRUE(content_index_open(TEST_NEXT_INDEX, &index));
+    U32Array candidates = { 0 };
+    array_create(&candidates, 8);
+    content_index_query(&index, NULL, "fox", 3, &candidates);
+    ASSERT_EQUALS(2, candidates.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(has_candidate(&index, &candidates, "delta.txt"));
+    ASSERT_TRUE(has_candidate(&index, &candidates, "epsilon.txt"));
+    ASSERT_EQUALS(1, query_count(&index, NULL, "count"), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, query_count(&index, NULL, "quick"), EQUALS_FORMAT_U32);
+
+    // A stopped build leaves no index.
+    platform_delete_file(TEST_INDEX);
+    ftic_atomic_store(&stop, 1);
+    ASSERT_TRUE(!content_index_build(TEST_DIRECTORY, &index, TEST_INDEX, &stop, &stats));
+    ASSERT_TRUE(!platform_path_exists(TEST_INDEX));
+
+    array_free(&candidates);
+    content_index_close(&index);
+    delete_test_files();
+}
+
+internal b8 count_hit(u32 line, const char* text, u32 text_length, void* data)
+{
+    ++*(u32*)data;
+    return false;
+}
+
+// The index may give files that turn out not to match, but never leave out
+// one that does.
+void content_index_test_matches_scan()
+{
+    const char* words[] = { "tic", "file", "Index", "trigram", "needle", "search", "fox", "\n" };
+    char paths[TEST_RANDOM_FILE_COUNT][64] = { 0 };
+    char content[2048] = { 0 };
+    u32 seed = 7;
+    for (u32 i = 0; i < TEST_RANDOM_FILE_COUNT; ++i)
+    {
+        u32 length = 0;
+        const u32 word_count = random_u32ss(seed++, 1, 200);
+        for (u32 j = 0; j < word_count; ++j)
+        {
+            const char* word = words[random_u32s(seed++) % static_array_size(words)];
+            const u32 word_length = (u32)strlen(word);
+            memcpy(content + length, word, word_length);
+            length += word_length;
+            content[length++] = (char)('a' + random_u32s(seed++) % 26);
+        }
+        sprintf_s(paths[i], sizeof(paths[i]), "%s/random_%u.txt",
+                  i % 2 ? TEST_SUB_DIRECTORY : TEST_DIRECTORY, i);
+        write_test_file(paths[i], content, length);
+    }
+
+    FTicAtomic stop = 0;
+    content_index_build(TEST_DIRECTORY, NULL, TEST_INDEX, &stop, NULL);
+    ContentIndex index = { 0 };
+    ASSERT_TRUE(content_index_open(TEST_INDEX, &index));
+
+    const char* patterns[] = { "fox", "needlefox", "ticfile", "xyz", "index\nt", "Trigram",
+                               "searchne", "ilefox", "tic", "eed" };
+    b8 all_found = true;
+    u32 total_candidates = 0;
+    U32Array candidates = { 0 };
+    array_create(&candidates, TEST_RANDOM_FILE_COUNT);
+    for (u32 i = 0; i < static_array_size(patterns); ++i)
+    {
+        const u32 length = (u32)strlen(patterns[i]);
+        ContentMatcher matcher = { 0 };
+        content_matcher_create(patterns[i], length, &matcher);
+        candidates.size = 0;
+        content_index_query(&index, NULL, patterns[i], length, &candidates);
+        total_candidates += candidates.size;
+        for (u32 j = 0; j < index.header->file_count; ++j)
+        {
+            u32 hits = 0;
+            content_search_file(content_index_file_path(&index, j), &matcher, count_hit, &hits,
+                                NULL);
+            b8 candidate = false;
+            for (u32 k = 0; k < candidates.size; ++k)
+            {
+                candidate |= candidates.data[k] == j;
+            }
+            all_found &= !hits || candidate;
+        }
+    }
+    ASSERT_TRUE(all_found);
+    ASSERT_TRUE(total_candidates < static_array_size(patterns) * TEST_RANDOM_FILE_COUNT);
+
+    array_free(&candidates);
+    content_index_close(&index);
+    for (u32 i = 0; i < TEST_RANDOM_FILE_COUNT; ++i)
+    {
+        platform_delete_file(paths[i]);
+    }
+    platform_delete_file(TEST_INDEX);
+}
+
+internal const ContentIndex* update_until_indexed(ContentIndexService* service,
+                                                  const DirectoryItemArray* items)
+{
+    const f64 start = platform_get_time();
+    while (platform_get_time() - start < 10.0)
+    {
+        content_index_service_update(service, items);
+        const ContentIndex* index = content_index_service_find(service, TEST_DIRECTORY);
+        if (index)
+        {
+            return index;
+        }
+        platform_sleep(1);
+    }
+    return NULL;
+}
+
+void content_index_test_service()
+{
+    write_test_files();
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(64, 1, &thread_queue);
+    ContentIndexService service = { 0 };
+    content_index_service_create(&thread_queue.task_queue, TEST_SERVICE_DIRECTORY, &service);
+
+    DirectoryItem item = { .type = FOLDER_DEFAULT, .path = TEST_DIRECTORY };
+    DirectoryItemArray items = { .size = 1, .capacity = 1, .data = &item };
+    const ContentIndex* index = update_until_indexed(&service, &items);
+    ASSERT_TRUE(index != NULL);
+    if (index)
+    {
+        ASSERT_EQUALS(3, query_count(index, NULL, "fox"), EQUALS_FORMAT_U32);
+    }
+
+    // Once the folder changed the index is not used until the build that
+    // follows the delay has been swapped in.
+    write_test_file(g_test_files[5], "a fox again\n", 12);
+    content_index_service_update(&service, &items);
+    ASSERT_TRUE(content_index_service_find(&service, TEST_DIRECTORY) == NULL);
+    service.roots.data[0]->last_build_time -= CONTENT_INDEX_REBUILD_DELAY;
+    index = update_until_indexed(&service, &items);
+    ASSERT_TRUE(index != NULL);
+    if (index)
+    {
+        ASSERT_EQUALS(4, query_count(index, NULL, "fox"), EQUALS_FORMAT_U32);
+    }
+
+    // The index is kept for the next run, where it is opened but not used
+    // before it has been checked against the folder.
+    char index_path[FTIC_MAX_PATH] = { 0 };
+    memcpy(index_path, service.roots.data[0]->index_path, sizeof(index_path));
+    content_index_service_destroy(&service);
+    ASSERT_TRUE(platform_path_exists(index_path));
+    content_index_service_create(&thread_queue.task_queue, TEST_SERVICE_DIRECTORY, &service);
+    content_index_service_update(&service, &items);
+    ASSERT_EQUALS(1, service.roots.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(service.roots.data[0]->index.header != NULL);
+    ASSERT_TRUE(content_index_service_find(&service, TEST_DIRECTORY) == NULL);
+    index = update_until_indexed(&service, &items);
+    ASSERT_TRUE(index != NULL);
+    if (index)
+    {
+        ASSERT_EQUALS(4, query_count(index, NULL, "fox"), EQUALS_FORMAT_U32);
+    }
+
+    // A folder that is no longer pinned has its index deleted.
+    items.size = 0;
+    content_index_service_update(&service, &items);
+    ASSERT_EQUALS(0, service.roots.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(!platform_path_exists(index_path));
+    ASSERT_TRUE(content_index_service_find(&service, TEST_DIRECTORY) == NULL);
+
+    content_index_service_destroy(&service);
+    threads_uninitialize(&thread_queue);
+    platform_remove_directory(TEST_SERVICE_DIRECTORY);
+    delete_test_files();
+}
+
+internal THREAD_TASK_ENTRY_POINT(queued_task)
+{
+}
+
+// A build that does not fit in the queue is not waited for, neither by the
+// next update nor when the service is destroyed.
+void content_index_test_service_full_queue()
+{
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1, 0, &thread_queue);
+    ThreadTask task = thread_task(queued_task, NULL);
+    thread_tasks_push(&thread_queue.task_queue, &task, 1, NULL);
+    ContentIndexService service = { 0 };
+    content_index_service_create(&thread_queue.task_queue, TEST_SERVICE_DIRECTORY, &service);
+
+    DirectoryItem item = { .type = FOLDER_DEFAULT, .path = TEST_DIRECTORY };
+    DirectoryItemArray items = { .size = 1, .capacity = 1, .data = &item };
+    content_index_service_update(&service, &items);
+    ASSERT_EQUALS(0, ftic_atomic_load(&service.building), "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(CONTENT_INDEX_IDLE, ftic_atomic_load(&service.roots.data[0]->state),
+                  "Expected: %d, Actual: %ld\n");
+    ASSERT_TRUE(service.roots.data[0]->dirty);
+
+    content_index_service_destroy(&service);
+    threads_uninitialize(&thread_queue);
+    platform_remove_directory(TEST_SERVICE_DIRECTORY);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+void content_index_test_begin();
+void content_index_test_end();
+void content_index_test_query();
+void content_index_test_incremental();
+void content_index_test_matches_scan();
+void content_index_test_service();
+void content_index_test_service_full_queue();
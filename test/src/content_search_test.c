@@ -0,0 +1,203 @@
+#include "content_search_test.h"
+#include "content_search.h"
+#include "platform/platform.h"
+#include "random.h"
+#include "asserts.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_TEXT_FILE "content_search_test.txt"
+#define TEST_BINARY_FILE "content_search_test.bin"
+
+void content_search_test_begin()
+{
+    printf("Content search tests:\n");
+}
+
+void content_search_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal u64 naive_find(const u8* data, u64 size, const char* pattern, u32 length, u64 from)
+{
+    for (u64 i = from; i + length <= size; ++i)
+    {
+        u32 j = 0;
+        while (j < length && tolower(data[i + j]) == tolower((u8)pattern[j]))
+        {
+            ++j;
+        }
+        if (j == length)
+        {
+            return i;
+        }
+    }
+    return size;
+}
+
+internal void write_test_file(const char* path, const char* content, u64 size)
+{
+    FILE* file = fopen(path, "wb");
+    if (file)
+    {
+        fwrite(content, 1, (size_t)size, file);
+        fclose(file);
+    }
+}
+
+typedef struct TestHits
+{
+    u32 lines[8];
+    char texts[8][64];
+    u32 count;
+} TestHits;
+
+internal b8 collect_hit(u32 line, const char* text, u32 text_length, void* data)
+{
+    TestHits* hits = (TestHits*)data;
+    if (hits->count < static_array_size(hits->lines))
+    {
+        hits->lines[hits->count] = line;
+        memcpy(hits->texts[hits->count], text, ftic_min(text_length, 63u));
+    }
+    return ++hits->count < 100;
+}
+
+void content_search_test_matcher_limits()
+{
+    ContentMatcher matcher = { 0 };
+    char long_pattern[CONTENT_SEARCH_MAX_PATTERN + 1];
+    memset(long_pattern, 'a', sizeof(long_pattern));
+    ASSERT_TRUE(!content_matcher_create("", 0, &matcher));
+    ASSERT_TRUE(!content_matcher_create(long_pattern, sizeof(long_pattern), &matcher));
+    ASSERT_TRUE(content_matcher_create(long_pattern, CONTENT_SEARCH_MAX_PATTERN, &matcher));
+}
+
+// Every start offset in a buffer made of a few letters, so the patterns
+// match often and land on every position of a block.
+void content_search_test_find_matches_naive()
+{
+    u8 data[301];
+    const char letters[] = "aAbB_`@";
+    for (u32 i = 0; i < sizeof(data); ++i)
+    {
+        data[i] = (u8)letters[random_u32s(i) % (sizeof(letters) - 1)];
+    }
+    const char* patterns[] = { "a", "ab", "Ba", "aab", "@a", "`", "abab", "ba_ab", "BBBB",
+                               "a`b@a_" };
+    b8 same = true;
+    for (u32 p = 0; p < static_array_size(patterns); ++p)
+    {
+        const u32 length = (u32)strlen(patterns[p]);
+        ContentMatcher matcher = { 0 };
+        content_matcher_create(patterns[p], length, &matcher);
+        for (u64 size = 0; size <= sizeof(data); size += 13)
+        {
+            for (u64 from = 0; from <= size; from += 7)
+            {
+                same &= content_matcher_find(&matcher, data, size, from) ==
+                        naive_find(data, size, patterns[p], length, from);
+            }
+        }
+    }
+    ASSERT_TRUE(same);
+}
+
+void content_search_test_lines()
+{
+    const char* text = "alpha\r\n  Beta gamma\nbeta beta\nnone\n\txBETAx";
+    ContentMatcher matcher = { 0 };
+    content_matcher_create("beta", 4, &matcher);
+    TestHits hits = { 0 };
+    const u32 count = content_search_buffer(&matcher, (const u8*)text, strlen(text), collect_hit,
+                                            &hits);
+
+    // One hit per line, indentation and \r left out of the preview.
+    ASSERT_EQUALS(3, count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(2, hits.lines[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(3, hits.lines[1], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(5, hits.lines[2], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, strcmp(hits.texts[0], "Beta gamma"), EQUALS_FORMAT_I32);
+    ASSERT_EQUALS(0, strcmp(hits.texts[1], "beta beta"), EQUALS_FORMAT_I32);
+    ASSERT_EQUALS(0, strcmp(hits.texts[2], "xBETAx"), EQUALS_FORMAT_I32);
+}
+
+void content_search_test_files()
+{
+    const char text[] = "first line\nsecond Needle line\n";
+    const char binary[] = "needle\0needle\n";
+    write_test_file(TEST_TEXT_FILE, text, sizeof(text) - 1);
+    write_test_file(TEST_BINARY_FILE, binary, sizeof(binary) - 1);
+
+    ContentMatcher matcher = { 0 };
+    content_matcher_create("needle", 6, &matcher);
+    TestHits hits = { 0 };
+    u64 scanned = 0;
+    ASSERT_EQUALS(1, content_search_file(TEST_TEXT_FILE, &matcher, collect_hit, &hits, &scanned),
+                  EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(2, hits.lines[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(sizeof(text) - 1, scanned, EQUALS_FORMAT_U64);
+
+    // Binary files are skipped, missing ones are not an error.
+    ASSERT_EQUALS(0, content_search_file(TEST_BINARY_FILE, &matcher, collect_hit, &hits, &scanned),
+                  EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, scanned, EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(0, content_search_file("content_search_missing.txt", &matcher, collect_hit,
+                                         &hits, NULL),
+                  EQUALS_FORMAT_U32);
+
+    remove(TEST_TEXT_FILE);
+    remove(TEST_BINARY_FILE);
+}
+
+// Matches across the end of a read block, both in a line that is carried
+// over to the next block and in a line longer than a block.
+void content_search_test_file_blocks()
+{
+    const u64 size = CONTENT_SEARCH_READ_SIZE * 2 + 50;
+    char* text = (char*)malloc(size);
+    memset(text, 'x', size);
+    for (u64 i = 99; i < size; i += 100)
+    {
+        text[i] = '\n';
+    }
+    const u64 cut = CONTENT_SEARCH_READ_SIZE - 3;
+    memcpy(text + cut, "needle", 6);
+    write_test_file(TEST_TEXT_FILE, text, size);
+
+    ContentMatcher matcher = { 0 };
+    content_matcher_create("needle", 6, &matcher);
+    TestHits hits = { 0 };
+    u64 scanned = 0;
+    ASSERT_EQUALS(1, content_search_file(TEST_TEXT_FILE, &matcher, collect_hit, &hits, &scanned),
+                  EQUALS_FORMAT_U32);
+    ASSERT_EQUALS((u32)(cut / 100) + 1, hits.lines[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(size, scanned, EQUALS_FORMAT_U64);
+
+    memset(text, 'x', size);
+    memcpy(text + cut, "needle", 6);
+    text[size - 1] = '\n';
+    memcpy(text + size - 7, "needle", 6);
+    write_test_file(TEST_TEXT_FILE, text, size);
+    hits = (TestHits){ 0 };
+    ASSERT_EQUALS(2, content_search_file(TEST_TEXT_FILE, &matcher, collect_hit, &hits, &scanned),
+                  EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1, hits.lines[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1, hits.lines[1], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(size, scanned, EQUALS_FORMAT_U64);
+
+    free(text);
+    remove(TEST_TEXT_FILE);
+}
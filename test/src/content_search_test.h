@@ -0,0 +1,9 @@
+#pragma once
+
+void content_search_test_begin();
+void content_search_test_end();
+void content_search_test_matcher_limits();
+void content_search_test_find_matches_naive();
+void content_search_test_lines();
+void content_search_test_files();
+void content_search_test_file_blocks();
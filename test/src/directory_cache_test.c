@@ -0,0 +1,216 @@
+#include "directory_cache_test.h"
+#include "directory_cache.h"
+#include "directory.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define SEPARATOR PLATFORM_PATH_SEPARATOR_STRING
+#define TEST_DIRECTORY "directory_cache_test"
+#define TEST_PATTERN TEST_DIRECTORY SEPARATOR "*"
+
+global ThreadQueue thread_queue = { 0 };
+
+void directory_cache_test_begin()
+{
+    printf("Directory cache tests:\n");
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_DIRECTORY SEPARATOR "a");
+    platform_create_directory(TEST_DIRECTORY SEPARATOR "b");
+    thread_initialize(1024, ftic_max(platform_get_core_count() - 1, 1), &thread_queue);
+    directory_cache_initialize(&thread_queue.task_queue);
+}
+
+void directory_cache_test_end()
+{
+    directory_cache_uninitialize();
+    threads_uninitialize(&thread_queue);
+    platform_remove_directory(TEST_DIRECTORY SEPARATOR "a");
+    platform_remove_directory(TEST_DIRECTORY SEPARATOR "b");
+    platform_remove_directory(TEST_DIRECTORY);
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal DirectoryListing* wait_until_listed(DirectoryListing* listing)
+{
+    const f64 start = platform_get_time();
+    while (listing->load && platform_get_time() - start < 10.0)
+    {
+        directory_cache_update();
+        platform_sleep(1);
+    }
+    return listing;
+}
+
+internal DirectoryListing* acquire_test_directory()
+{
+    return wait_until_listed(directory_cache_acquire(TEST_PATTERN, (u32)strlen(TEST_PATTERN)));
+}
+
+void directory_cache_test_shared_listing()
+{
+    DirectoryListing* first = acquire_test_directory();
+    DirectoryListing* second = acquire_test_directory();
+    ASSERT_TRUE(first == second);
+    ASSERT_EQUALS(2, first->reference_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(2, first->directory.items.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1, directory_cache_size(), EQUALS_FORMAT_U32);
+
+    // Kept for the next page that opens the folder.
+    directory_cache_release(first);
+    directory_cache_release(second);
+    ASSERT_EQUALS(1, directory_cache_size(), EQUALS_FORMAT_U32);
+    ASSERT_TRUE(acquire_test_directory() == first);
+    directory_cache_release(first);
+
+    directory_cache_invalidate_all();
+    ASSERT_EQUALS(0, directory_cache_size(), EQUALS_FORMAT_U32);
+}
+
+void directory_cache_test_invalidate()
+{
+    DirectoryListing* old_listing = acquire_test_directory();
+    platform_create_directory(TEST_DIRECTORY SEPARATOR "c");
+    directory_cache_invalidate(old_listing);
+    ASSERT_TRUE(old_listing->stale);
+
+    // The page still using the old listing can read it until it lets go.
+    DirectoryListing* new_listing = acquire_test_directory();
+    ASSERT_TRUE(new_listing != old_listing);
+    ASSERT_EQUALS(2, old_listing->directory.items.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(3, new_listing->directory.items.size, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(acquire_test_directory() == new_listing);
+
+    directory_cache_release(old_listing);
+    directory_cache_release(new_listing);
+    directory_cache_release(new_listing);
+    platform_remove_directory(TEST_DIRECTORY SEPARATOR "c");
+    directory_cache_invalidate_all();
+}
+
+void directory_cache_test_evict_unused()
+{
+    const u32 folder_count = DIRECTORY_CACHE_UNUSED_CAPACITY + 4;
+    char pattern[64] = { 0 };
+    for (u32 i = 0; i < folder_count; ++i)
+    {
+        value_to_string(pattern, TEST_DIRECTORY SEPARATOR "a" SEPARATOR "%u", i);
+        platform_create_directory(pattern);
+        const u32 length = (u32)strlen(pattern);
+        pattern[length] = PLATFORM_PATH_SEPARATOR;
+        pattern[length + 1] = '*';
+        directory_cache_release(wait_until_listed(directory_cache_acquire(pattern, length + 2)));
+    }
+    ASSERT_EQUALS(DIRECTORY_CACHE_UNUSED_CAPACITY, directory_cache_size(), EQUALS_FORMAT_U32);
+
+    // The one opened first was the first to go.
+    value_to_string(pattern, TEST_DIRECTORY SEPARATOR "a" SEPARATOR "0" SEPARATOR "*");
+    DirectoryListing* listing =
+        wait_until_listed(directory_cache_acquire(pattern, (u32)strlen(pattern)));
+    ASSERT_EQUALS(1, listing->reference_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(DIRECTORY_CACHE_UNUSED_CAPACITY + 1, directory_cache_size(), EQUALS_FORMAT_U32);
+    directory_cache_release(listing);
+
+    directory_cache_invalidate_all();
+    for (u32 i = 0; i < folder_count; ++i)
+    {
+        value_to_string(pattern, TEST_DIRECTORY SEPARATOR "a" SEPARATOR "%u", i);
+        platform_remove_directory(pattern);
+    }
+}
+
+void directory_cache_test_sorted_merge()
+{
+    // Three chunks arriving one at a time end up in the same order as
+    // sorting everything at once.
+    const u64 sizes[] = { 7, 3, 9, 1, 8, 2, 6, 0, 5, 4, 9, 1 };
+    const u32 size_count = static_array_size(sizes);
+    DirectoryPage page = { .sort_by = SORT_SIZE, .sort_count = 1 };
+    array_create(&page.directory.items, 4);
+    for (u32 i = 0; i < size_count; i += 4)
+    {
+        DirectoryItemArray chunk = { 0 };
+        array_create(&chunk, 4);
+        for (u32 j = i; j < i + 4; ++j)
+        {
+            DirectoryItem item = { .type = FILE_DEFAULT, .size = sizes[j] };
+            array_push(&chunk, item);
+        }
+        directory_sort_merge(&page, &chunk);
+        array_free(&chunk);
+    }
+    ASSERT_EQUALS(size_count, page.directory.items.size, EQUALS_FORMAT_U32);
+    b8 sorted = true;
+    for (u32 i = 1; i < page.directory.items.size; ++i)
+    {
+        sorted &= page.directory.items.data[i - 1].size <= page.directory.items.data[i].size;
+    }
+    ASSERT_TRUE(sorted);
+
+    page.sort_count = 2;
+    DirectoryItemArray chunk = { 0 };
+    array_create(&chunk, 1);
+    DirectoryItem item = { .type = FILE_DEFAULT, .size = 10 };
+    array_push(&chunk, item);
+    directory_flip_array(&page.directory.items);
+    directory_sort_merge(&page, &chunk);
+    ASSERT_EQUALS(10, page.directory.items.data[0].size, EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(0, page.directory.items.data[size_count].size, EQUALS_FORMAT_U64);
+    array_free(&chunk);
+    array_free(&page.directory.items);
+}
+
+internal void push_sized_items(DirectoryListing* listing, const u32 count, u64 size)
+{
+    for (u32 i = 0; i < count; ++i, size = size * 7 % 13)
+    {
+        DirectoryItem item = { .type = FILE_DEFAULT, .size = size };
+        array_push(&listing->directory.items, item);
+    }
+}
+
+void directory_cache_test_deferred_merge()
+{
+    // Only read for being set, the page never touches the load itself.
+    DirectoryListingLoad load = { 0 };
+    DirectoryListing listing = { .load = &load };
+    array_create(&listing.directory.items, 16);
+    DirectoryPage page = { .sort_by = SORT_SIZE, .sort_count = 1, .listing = &listing };
+    array_create(&page.directory.items, 4);
+
+    push_sized_items(&listing, 4, 5);
+    directory_page_update(&page);
+    ASSERT_EQUALS(4, page.directory.items.size, EQUALS_FORMAT_U32);
+
+    // Fewer new items than the page shows wait for more.
+    push_sized_items(&listing, 3, 11);
+    directory_page_update(&page);
+    ASSERT_EQUALS(4, page.directory.items.size, EQUALS_FORMAT_U32);
+    push_sized_items(&listing, 1, 2);
+    directory_page_update(&page);
+    ASSERT_EQUALS(8, page.directory.items.size, EQUALS_FORMAT_U32);
+
+    // The rest comes in when the load is done.
+    push_sized_items(&listing, 2, 3);
+    listing.load = NULL;
+    directory_page_update(&page);
+    ASSERT_EQUALS(10, page.directory.items.size, EQUALS_FORMAT_U32);
+    b8 sorted = true;
+    for (u32 i = 1; i < page.directory.items.size; ++i)
+    {
+        sorted &= page.directory.items.data[i - 1].size <= page.directory.items.data[i].size;
+    }
+    ASSERT_TRUE(sorted);
+
+    array_free(&page.directory.items);
+    array_free(&listing.directory.items);
+}
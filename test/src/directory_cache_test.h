@@ -0,0 +1,9 @@
+#pragma once
+
+void directory_cache_test_begin();
+void directory_cache_test_end();
+void directory_cache_test_shared_listing();
+void directory_cache_test_invalidate();
+void directory_cache_test_evict_unused();
+void directory_cache_test_sorted_merge();
+void directory_cache_test_deferred_merge();
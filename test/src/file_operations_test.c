@@ -0,0 +1,402 @@
+#include "file_operations_test.h"
+#include "file_operations.c"
+#include "asserts.h"
+#include <stdio.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_DIRECTORY "file_operations_test"
+#define SEPARATOR PLATFORM_PATH_SEPARATOR_STRING
+#define TEST_SOURCE TEST_DIRECTORY SEPARATOR "source"
+#define TEST_DESTINATION TEST_DIRECTORY SEPARATOR "destination"
+#define TEST_FILE_COUNT 48
+#define TEST_TIMEOUT 10.0
+
+void file_operations_test_begin()
+{
+    printf("File operations tests:\n");
+}
+
+void file_operations_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void write_test_file(const char* path, const u64 size)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+    u8 chunk[4096] = { 0 };
+    for (u32 i = 0; i < static_array_size(chunk); ++i)
+    {
+        chunk[i] = (u8)i;
+    }
+    for (u64 written = 0; written < size;)
+    {
+        const u64 to_write = ftic_min(size - written, (u64)sizeof(chunk));
+        fwrite(chunk, 1, to_write, file);
+        written += to_write;
+    }
+    fclose(file);
+}
+
+internal void remove_test_tree(const char* path)
+{
+    PlatformFileEntryArray entries = { 0 };
+    array_create(&entries, 16);
+    platform_list_directory_entries(path, &entries);
+    for (u32 i = 0; i < entries.size; ++i)
+    {
+        if (entries.data[i].directory)
+        {
+            remove_test_tree(entries.data[i].path);
+        }
+        else
+        {
+            remove(entries.data[i].path);
+        }
+        free(entries.data[i].path);
+    }
+    free(entries.data);
+    platform_remove_directory(path);
+}
+
+void file_operations_test_progress()
+{
+    FileOperation operation = { 0 };
+    operation.bytes_total = 1000;
+    operation.bytes_done = 250;
+    operation.files_total = 4;
+    operation.files_done = 1;
+    operation.start_time = platform_get_time() - 10.0;
+
+    FileOperationProgress progress = file_operation_get_progress(&operation);
+    ASSERT_EQUALS(250, (u32)progress.bytes_done, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1000, (u32)progress.bytes_total, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS_WITHIN(25.0, progress.bytes_per_second, 0.5, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS_WITHIN(30.0, progress.seconds_left, 0.5, EQUALS_FORMAT_FLOAT);
+
+    // Moves and deletes estimate from the item count instead.
+    operation.bytes_total = 0;
+    operation.bytes_done = 0;
+    progress = file_operation_get_progress(&operation);
+    ASSERT_EQUALS_WITHIN(30.0, progress.seconds_left, 0.5, EQUALS_FORMAT_FLOAT);
+}
+
+void file_operations_test_progress_paused()
+{
+    FileOperation operation = { 0 };
+    operation.bytes_total = 1000;
+    operation.bytes_done = 500;
+    operation.start_time = platform_get_time() - 10.0;
+
+    file_operation_pause(&operation, true);
+    ASSERT_EQUALS(FILE_OPERATION_PAUSED, (u32)operation.state, EQUALS_FORMAT_U32);
+    operation.pause_time = operation.start_time + 5.0;
+
+    FileOperationProgress progress = file_operation_get_progress(&operation);
+    ASSERT_EQUALS(true, progress.paused, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS_WITHIN(100.0, progress.bytes_per_second, 0.5, EQUALS_FORMAT_FLOAT);
+
+    file_operation_cancel(&operation);
+    file_operation_pause(&operation, false);
+    ASSERT_EQUALS(FILE_OPERATION_CANCELLED, (u32)operation.state, EQUALS_FORMAT_U32);
+}
+
+void file_operations_test_unique_destination_path()
+{
+    platform_create_directory(TEST_DIRECTORY);
+    write_test_file(TEST_DIRECTORY SEPARATOR "a.txt", 1);
+
+    char* path = unique_destination_path(TEST_DIRECTORY, "b.txt", 5);
+    ASSERT_EQUALS(0, strcmp(path, TEST_DIRECTORY SEPARATOR "b.txt"), EQUALS_FORMAT_I32);
+    free(path);
+
+    path = unique_destination_path(TEST_DIRECTORY, "a.txt", 5);
+    ASSERT_EQUALS(0, strcmp(path, TEST_DIRECTORY SEPARATOR "a - Copy.txt"), EQUALS_FORMAT_I32);
+    write_test_file(path, 1);
+    free(path);
+
+    path = unique_destination_path(TEST_DIRECTORY, "a.txt", 5);
+    ASSERT_EQUALS(0, strcmp(path, TEST_DIRECTORY SEPARATOR "a - Copy (2).txt"), EQUALS_FORMAT_I32);
+    free(path);
+
+    remove_test_tree(TEST_DIRECTORY);
+}
+
+internal u32 parked_count(FileOperation* operation)
+{
+    sync_mutex_lock(&operation->park_mutex);
+    const u32 count = operation->parked_count;
+    sync_mutex_unlock(&operation->park_mutex);
+    return count;
+}
+
+// True once every worker still pending has gone back to the pool.
+internal b8 wait_until_parked(FileOperation* operation)
+{
+    const f64 start = platform_get_time();
+    while (platform_get_time() - start < TEST_TIMEOUT)
+    {
+        const u32 parked = parked_count(operation);
+        if (parked && parked == (u32)ftic_atomic_load(&operation->pending_tasks))
+        {
+            return true;
+        }
+        platform_sleep(1);
+    }
+    return false;
+}
+
+internal b8 wait_until_done(FileOperation* operation)
+{
+    const f64 start = platform_get_time();
+    while (!file_operation_done(operation))
+    {
+        if (platform_get_time() - start > TEST_TIMEOUT)
+        {
+            return false;
+        }
+        platform_sleep(1);
+    }
+    return true;
+}
+
+internal THREAD_TASK_ENTRY_POINT(mark_task)
+{
+    ftic_atomic_store((FTicAtomic*)data, 1);
+}
+
+internal THREAD_TASK_ENTRY_POINT(block_task)
+{
+    while (!ftic_atomic_load((FTicAtomic*)data))
+    {
+        platform_sleep(1);
+    }
+}
+
+// Holds both pool threads until the operation is paused, so no file is
+// copied before the pause.
+internal FileOperation* copy_paused(FileOperationQueue* queue, ThreadQueue* thread_queue,
+                                    const CharPtrArray* paths, FTicAtomic* release)
+{
+    ThreadTask blockers[2] = { thread_task(block_task, release),
+                               thread_task(block_task, release) };
+    thread_tasks_push(&thread_queue->task_queue, blockers, 2, NULL);
+    FileOperation* operation = file_operation_copy(queue, paths, TEST_DESTINATION);
+    file_operation_pause(operation, true);
+    ftic_atomic_store(release, 1);
+    return operation;
+}
+
+void file_operations_test_pause_returns_workers()
+{
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_SOURCE);
+    platform_create_directory(TEST_DESTINATION);
+    for (u32 i = 0; i < TEST_FILE_COUNT; ++i)
+    {
+        char path[128] = { 0 };
+        sprintf_s(path, sizeof(path), TEST_SOURCE SEPARATOR "file_%u.bin", i);
+        write_test_file(path, 64 * 1024 + i);
+    }
+
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1024, 2, &thread_queue);
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue.task_queue, &queue);
+
+    char* source = TEST_SOURCE;
+    CharPtrArray paths = { .size = 1, .capacity = 1, .data = &source };
+    FTicAtomic release = 0;
+    FileOperation* operation = copy_paused(&queue, &thread_queue, &paths, &release);
+    ASSERT_TRUE(wait_until_parked(operation));
+    ASSERT_EQUALS(0, (u32)operation->files_done, EQUALS_FORMAT_U32);
+
+    // Nothing of the copy is holding the pool.
+    FTicAtomic ran = 0;
+    ThreadTask task = thread_task(mark_task, &ran);
+    thread_tasks_push(&thread_queue.task_queue, &task, 1, NULL);
+    const f64 start = platform_get_time();
+    while (!ftic_atomic_load(&ran) && platform_get_time() - start < TEST_TIMEOUT)
+    {
+        platform_sleep(1);
+    }
+    ASSERT_TRUE(ftic_atomic_load(&ran));
+
+    file_operation_pause(operation, false);
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_EQUALS(TEST_FILE_COUNT, (u32)operation->files_done, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    u64 expected_bytes = 0;
+    b8 all_copied = true;
+    for (u32 i = 0; i < TEST_FILE_COUNT; ++i)
+    {
+        char path[128] = { 0 };
+        sprintf_s(path, sizeof(path), TEST_DESTINATION SEPARATOR "source" SEPARATOR "file_%u.bin",
+                  i);
+        all_copied &= platform_get_file_size(path) == 64 * 1024 + i;
+        expected_bytes += 64 * 1024 + i;
+    }
+    ASSERT_TRUE(all_copied);
+    ASSERT_EQUALS(expected_bytes, (u64)operation->bytes_done, EQUALS_FORMAT_U64);
+
+    // Cancelling a paused operation finishes it, the parked workers come
+    // back to see the cancel.
+    FTicAtomic release_again = 0;
+    operation = copy_paused(&queue, &thread_queue, &paths, &release_again);
+    ASSERT_TRUE(wait_until_parked(operation));
+    file_operation_cancel(operation);
+    ASSERT_TRUE(wait_until_done(operation));
+
+    file_operation_queue_destroy(&queue);
+    threads_uninitialize(&thread_queue);
+    remove_test_tree(TEST_DIRECTORY);
+}
+
+void file_operations_test_permanent_delete()
+{
+    const u32 folder_count = 8;
+    const u32 files_per_folder = 40;
+    platform_create_directory(TEST_DIRECTORY);
+    for (u32 i = 0; i < folder_count; ++i)
+    {
+        char path[128] = { 0 };
+        sprintf_s(path, sizeof(path), TEST_DIRECTORY SEPARATOR "folder_%u", i);
+        platform_create_directory(path);
+        sprintf_s(path, sizeof(path), TEST_DIRECTORY SEPARATOR "folder_%u" SEPARATOR "nested", i);
+        platform_create_directory(path);
+        for (u32 j = 0; j < files_per_folder; ++j)
+        {
+            sprintf_s(path, sizeof(path),
+                      TEST_DIRECTORY SEPARATOR "folder_%u" SEPARATOR "nested" SEPARATOR
+                      "file_%u.txt",
+                      i, j);
+            write_test_file(path, 64);
+        }
+    }
+
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1024, 4, &thread_queue);
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue.task_queue, &queue);
+
+    char* root = TEST_DIRECTORY;
+    CharPtrArray paths = { .size = 1, .capacity = 1, .data = &root };
+    FileOperation* operation = file_operation_delete(&queue, &paths, true);
+    ASSERT_TRUE(wait_until_done(operation));
+
+    // Every file, both folders per top folder and the root itself.
+    const u32 expected = folder_count * (files_per_folder + 2) + 1;
+    ASSERT_EQUALS(expected, (u32)operation->files_done, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(expected, (u32)operation->files_total, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(false, platform_path_exists(TEST_DIRECTORY), EQUALS_FORMAT_U32);
+
+    file_operation_queue_destroy(&queue);
+    threads_uninitialize(&thread_queue);
+}
+
+void file_operations_test_move()
+{
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_SOURCE);
+    platform_create_directory(TEST_DESTINATION);
+    write_test_file(TEST_SOURCE SEPARATOR "file.bin", 1024);
+
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1024, 2, &thread_queue);
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue.task_queue, &queue);
+
+    char* source = TEST_SOURCE;
+    CharPtrArray paths = { .size = 1, .capacity = 1, .data = &source };
+    FileOperation* operation = file_operation_move(&queue, &paths, TEST_DESTINATION);
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_EQUALS(0, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(false, platform_path_exists(TEST_SOURCE), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1024,
+                  platform_get_file_size(TEST_DESTINATION SEPARATOR "source" SEPARATOR
+                                                          "file.bin"),
+                  EQUALS_FORMAT_U64);
+
+    // A folder can not be moved into itself, that is a failure and not
+    // something to skip quietly.
+    char* moved = TEST_DESTINATION SEPARATOR "source";
+    paths.data = &moved;
+    operation = file_operation_move(&queue, &paths, TEST_DESTINATION SEPARATOR "source");
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_EQUALS(1, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    platform_create_directory(TEST_DESTINATION SEPARATOR "source" SEPARATOR "inner");
+    operation = file_operation_move(&queue, &paths,
+                                    TEST_DESTINATION SEPARATOR "source" SEPARATOR "inner");
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_EQUALS(1, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(true, platform_path_exists(moved), EQUALS_FORMAT_U32);
+
+    file_operation_queue_destroy(&queue);
+    threads_uninitialize(&thread_queue);
+    remove_test_tree(TEST_DIRECTORY);
+}
+
+// Hands the source to the move as if it was on another volume, so it is
+// copied and deleted instead of renamed.
+internal FileOperation* move_across_volumes(FileOperationQueue* queue, char* source,
+                                            const char* destination)
+{
+    CharPtrArray paths = { .size = 1, .capacity = 1, .data = &source };
+    FileOperation* operation =
+        file_operation_create(queue, FILE_OPERATION_MOVE, &paths, destination);
+    operation->next_path = paths.size;
+    array_push(&operation->volume_paths, operation->paths.data[0]);
+    ThreadTask task = thread_task(file_move, operation);
+    thread_tasks_push(queue->task_queue, &task, 1, NULL);
+    return operation;
+}
+
+void file_operations_test_move_across_volumes()
+{
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_SOURCE);
+    platform_create_directory(TEST_SOURCE SEPARATOR "sub");
+    platform_create_directory(TEST_DESTINATION);
+    write_test_file(TEST_SOURCE SEPARATOR "sub" SEPARATOR "file.bin", 1024);
+
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1024, 2, &thread_queue);
+    FileOperationQueue queue = { 0 };
+    file_operation_queue_create(&thread_queue.task_queue, &queue);
+
+    // The folder can not be created below a file. Nothing was copied, so
+    // nothing is deleted.
+    write_test_file(TEST_DIRECTORY SEPARATOR "blocking.bin", 16);
+    FileOperation* operation =
+        move_across_volumes(&queue, TEST_SOURCE, TEST_DIRECTORY SEPARATOR "blocking.bin");
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_TRUE(operation->failed_count > 0);
+    ASSERT_EQUALS(1024, platform_get_file_size(TEST_SOURCE SEPARATOR "sub" SEPARATOR "file.bin"),
+                  EQUALS_FORMAT_U64);
+
+    operation = move_across_volumes(&queue, TEST_SOURCE, TEST_DESTINATION);
+    ASSERT_TRUE(wait_until_done(operation));
+    ASSERT_EQUALS(0, (u32)operation->failed_count, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(false, platform_path_exists(TEST_SOURCE), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(1024,
+                  platform_get_file_size(TEST_DESTINATION SEPARATOR "source" SEPARATOR
+                                         "sub" SEPARATOR "file.bin"),
+                  EQUALS_FORMAT_U64);
+
+    file_operation_queue_destroy(&queue);
+    threads_uninitialize(&thread_queue);
+    remove_test_tree(TEST_DIRECTORY);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+void file_operations_test_begin();
+void file_operations_test_end();
+void file_operations_test_progress();
+void file_operations_test_progress_paused();
+void file_operations_test_unique_destination_path();
+void file_operations_test_pause_returns_workers();
+void file_operations_test_permanent_delete();
+void file_operations_test_move();
+void file_operations_test_move_across_volumes();
@@ -0,0 +1,112 @@
+#include "folder_size_test.h"
+#include "folder_size.c"
+#include "asserts.h"
+#include <stdio.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_DIRECTORY "folder_size_test"
+#define SEPARATOR PLATFORM_PATH_SEPARATOR_STRING
+
+void folder_size_test_begin()
+{
+    printf("Folder size tests:\n");
+}
+
+void folder_size_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void write_sized_file(const char* path, const u64 size)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+    u8 chunk[1024] = { 0 };
+    for (u64 written = 0; written < size;)
+    {
+        const u64 to_write = ftic_min(size - written, (u64)sizeof(chunk));
+        fwrite(chunk, 1, to_write, file);
+        written += to_write;
+    }
+    fclose(file);
+}
+
+internal b8 update_until_sized(FolderSizeService* service, DirectoryItemArray* items,
+                               const u64 expected)
+{
+    const f64 start = platform_get_time();
+    while (platform_get_time() - start < 10.0)
+    {
+        folder_size_service_update(service, items);
+        if (items->data[0].size == expected)
+        {
+            return true;
+        }
+        platform_sleep(1);
+    }
+    return false;
+}
+
+void folder_size_test_recursive_size()
+{
+    platform_create_directory(TEST_DIRECTORY);
+    platform_create_directory(TEST_DIRECTORY SEPARATOR "a");
+    platform_create_directory(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b");
+    write_sized_file(TEST_DIRECTORY SEPARATOR "top.bin", 1000);
+    write_sized_file(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "middle.bin", 2500);
+    write_sized_file(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b" SEPARATOR "bottom.bin", 4096);
+    const u64 expected = 1000 + 2500 + 4096;
+
+    ThreadQueue thread_queue = { 0 };
+    thread_initialize(1024, ftic_max(platform_get_core_count() - 1, 1), &thread_queue);
+    FolderSizeService service = { 0 };
+    folder_size_service_create(&thread_queue.task_queue, &service);
+
+    DirectoryItem item = { .type = FOLDER_DEFAULT, .path = TEST_DIRECTORY };
+    platform_get_id_from_path(TEST_DIRECTORY, &item.id);
+    DirectoryItemArray items = { .size = 1, .capacity = 1, .data = &item };
+
+    ASSERT_EQUALS(true, update_until_sized(&service, &items, expected), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(expected, item.size, EQUALS_FORMAT_U64);
+
+    // A reloaded listing starts at zero and gets the cached size back
+    // without another walk.
+    item.size = 0;
+    folder_size_service_update(&service, &items);
+    ASSERT_EQUALS(expected, item.size, EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(0, (u32)service.pending, EQUALS_FORMAT_U32);
+
+    // A file added deep down leaves the modified time of the folder as it
+    // was and the size is far from old enough to walk again, only the
+    // listener brings it in.
+    ASSERT_EQUALS(1, service.listening.size, EQUALS_FORMAT_U32);
+    write_sized_file(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b" SEPARATOR "new.bin", 300);
+    ASSERT_EQUALS(true, update_until_sized(&service, &items, expected + 300), EQUALS_FORMAT_U32);
+
+    // Out of view, the listener is given back.
+    items.size = 0;
+    folder_size_service_update(&service, &items);
+    ASSERT_EQUALS(0, service.listening.size, EQUALS_FORMAT_U32);
+
+    folder_size_service_destroy(&service);
+    threads_uninitialize(&thread_queue);
+
+    remove(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b" SEPARATOR "bottom.bin");
+    remove(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b" SEPARATOR "new.bin");
+    remove(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "middle.bin");
+    remove(TEST_DIRECTORY SEPARATOR "top.bin");
+    platform_remove_directory(TEST_DIRECTORY SEPARATOR "a" SEPARATOR "b");
+    platform_remove_directory(TEST_DIRECTORY SEPARATOR "a");
+    platform_remove_directory(TEST_DIRECTORY);
+}
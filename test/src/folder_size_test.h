@@ -0,0 +1,5 @@
+#pragma once
+
+void folder_size_test_begin();
+void folder_size_test_end();
+void folder_size_test_recursive_size();
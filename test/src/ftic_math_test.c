@@ -0,0 +1,230 @@
+#include "ftic_math_test.h"
+#include "define.h"
+#include "math/ftic_math.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define MATH_TEST_COUNT 1027
+#define BENCHMARK_BATCH_COUNT 1000000
+#define MATH_EPSILON 0.0001f
+
+void ftic_math_test_begin()
+{
+    printf("Math tests:\n");
+#ifdef FTIC_MATH_AVX
+    printf("\tPath: AVX\n");
+#elif defined(FTIC_MATH_SSE)
+    printf("\tPath: SSE2\n");
+#else
+    printf("\tPath: scalar\n");
+#endif
+}
+
+void ftic_math_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal f32 random_f32(f32 low, f32 high)
+{
+    return low + ((f32)rand() / (f32)RAND_MAX) * (high - low);
+}
+
+internal V4 random_v4(f32 low, f32 high)
+{
+    return v4f(random_f32(low, high), random_f32(low, high), random_f32(low, high),
+               random_f32(low, high));
+}
+
+internal M4 random_m4()
+{
+    M4 result;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        for (u32 j = 0; j < 4; ++j)
+        {
+            result.data[i][j] = random_f32(-10.0f, 10.0f);
+        }
+    }
+    return result;
+}
+
+internal void assert_v4_equals(V4 expected, V4 actual)
+{
+    ASSERT_EQUALS_WITHIN(expected.x, actual.x, MATH_EPSILON, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS_WITHIN(expected.y, actual.y, MATH_EPSILON, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS_WITHIN(expected.z, actual.z, MATH_EPSILON, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS_WITHIN(expected.w, actual.w, MATH_EPSILON, EQUALS_FORMAT_FLOAT);
+}
+
+void ftic_math_test_m4_multi()
+{
+    srand(1);
+    for (u32 i = 0; i < 64; ++i)
+    {
+        const M4 first = random_m4();
+        const M4 second = random_m4();
+        const M4 expected = m4_multi_scalar(first, second);
+        const M4 actual = m4_multi(first, second);
+        for (u32 column = 0; column < 4; ++column)
+        {
+            for (u32 row = 0; row < 4; ++row)
+            {
+                ASSERT_EQUALS_WITHIN(expected.data[column][row], actual.data[column][row],
+                                     MATH_EPSILON * 10.0f, EQUALS_FORMAT_FLOAT);
+            }
+        }
+    }
+
+    const M4 matrix = random_m4();
+    const M4 transposed = m4_transpose(matrix);
+    for (u32 column = 0; column < 4; ++column)
+    {
+        for (u32 row = 0; row < 4; ++row)
+        {
+            ASSERT_EQUALS(matrix.data[column][row], transposed.data[row][column],
+                          EQUALS_FORMAT_FLOAT);
+        }
+    }
+}
+
+void ftic_math_test_v4_multi()
+{
+    const V4 result = v4_multi(v4f(1.0f, 2.0f, 3.0f, 4.0f), v4f(5.0f, 6.0f, 7.0f, 8.0f));
+    assert_v4_equals(v4f(5.0f, 12.0f, 21.0f, 32.0f), result);
+}
+
+void ftic_math_test_batches()
+{
+    srand(2);
+    V4* from = (V4*)malloc(MATH_TEST_COUNT * sizeof(V4));
+    V4* to = (V4*)malloc(MATH_TEST_COUNT * sizeof(V4));
+    V4* expected = (V4*)malloc(MATH_TEST_COUNT * sizeof(V4));
+    V4* actual = (V4*)malloc(MATH_TEST_COUNT * sizeof(V4));
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        from[i] = random_v4(-100.0f, 100.0f);
+        to[i] = random_v4(-100.0f, 100.0f);
+    }
+    const M4 matrix = random_m4();
+
+    m4_v4_multi_batch_scalar(&matrix, from, expected, MATH_TEST_COUNT);
+    m4_v4_multi_batch(&matrix, from, actual, MATH_TEST_COUNT);
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        const V4 single = m4_v4_multi(matrix, from[i]);
+        ASSERT_EQUALS_WITHIN(expected[i].x, actual[i].x, 0.01f, EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(expected[i].w, actual[i].w, 0.01f, EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(single.y, actual[i].y, 0.01f, EQUALS_FORMAT_FLOAT);
+    }
+
+    v4_lerp_batch_scalar(from, to, 0.3f, expected, MATH_TEST_COUNT);
+    v4_lerp_batch(from, to, 0.3f, actual, MATH_TEST_COUNT);
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        assert_v4_equals(expected[i], actual[i]);
+    }
+
+    // The V3 batch is tested in place, the output must not run past each element.
+    V3* points = (V3*)malloc((MATH_TEST_COUNT + 1) * sizeof(V3));
+    V3* expected_points = (V3*)malloc(MATH_TEST_COUNT * sizeof(V3));
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        points[i] = v3f(from[i].x, from[i].y, from[i].z);
+    }
+    points[MATH_TEST_COUNT] = v3f(1.0f, 2.0f, 3.0f);
+    m4_v3_multi_batch_scalar(&matrix, points, expected_points, MATH_TEST_COUNT);
+    m4_v3_multi_batch(&matrix, points, points, MATH_TEST_COUNT);
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        ASSERT_EQUALS_WITHIN(expected_points[i].x, points[i].x, 0.01f, EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(expected_points[i].y, points[i].y, 0.01f, EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(expected_points[i].z, points[i].z, 0.01f, EQUALS_FORMAT_FLOAT);
+    }
+    ASSERT_EQUALS(3.0f, points[MATH_TEST_COUNT].z, EQUALS_FORMAT_FLOAT);
+
+    free(expected_points);
+    free(points);
+    free(actual);
+    free(expected);
+    free(to);
+    free(from);
+}
+
+void ftic_math_test_pack_unorm8()
+{
+    srand(3);
+    V4 colors[MATH_TEST_COUNT];
+    u32 expected[MATH_TEST_COUNT];
+    u32 actual[MATH_TEST_COUNT];
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        // Outside of [0, 1] to test the clamping.
+        colors[i] = random_v4(-0.2f, 1.2f);
+    }
+    colors[0] = v4f(0.0f, 1.0f, 0.5f, 1.0f / 255.0f);
+    v4_pack_unorm8_batch_scalar(colors, expected, MATH_TEST_COUNT);
+    v4_pack_unorm8_batch(colors, actual, MATH_TEST_COUNT);
+    for (u32 i = 0; i < MATH_TEST_COUNT; ++i)
+    {
+        ASSERT_EQUALS(expected[i], actual[i], EQUALS_FORMAT_U32);
+    }
+    ASSERT_EQUALS(0x0180FF00, actual[0], EQUALS_FORMAT_U32);
+}
+
+void ftic_math_test_benchmark_batches()
+{
+    V4* from = (V4*)malloc(BENCHMARK_BATCH_COUNT * sizeof(V4));
+    V4* to = (V4*)malloc(BENCHMARK_BATCH_COUNT * sizeof(V4));
+    V4* out = (V4*)malloc(BENCHMARK_BATCH_COUNT * sizeof(V4));
+    u32* packed = (u32*)malloc(BENCHMARK_BATCH_COUNT * sizeof(u32));
+    for (u32 i = 0; i < BENCHMARK_BATCH_COUNT; ++i)
+    {
+        from[i] = random_v4(0.0f, 1.0f);
+        to[i] = random_v4(0.0f, 1.0f);
+    }
+    const M4 matrix = random_m4();
+
+    f64 start = platform_get_time();
+    m4_v4_multi_batch_scalar(&matrix, from, out, BENCHMARK_BATCH_COUNT);
+    const f64 transform_scalar = platform_get_time() - start;
+    start = platform_get_time();
+    m4_v4_multi_batch(&matrix, from, out, BENCHMARK_BATCH_COUNT);
+    const f64 transform_simd = platform_get_time() - start;
+
+    start = platform_get_time();
+    v4_lerp_batch_scalar(from, to, 0.5f, out, BENCHMARK_BATCH_COUNT);
+    const f64 lerp_scalar = platform_get_time() - start;
+    start = platform_get_time();
+    v4_lerp_batch(from, to, 0.5f, out, BENCHMARK_BATCH_COUNT);
+    const f64 lerp_simd = platform_get_time() - start;
+
+    start = platform_get_time();
+    v4_pack_unorm8_batch_scalar(from, packed, BENCHMARK_BATCH_COUNT);
+    const f64 pack_scalar = platform_get_time() - start;
+    start = platform_get_time();
+    v4_pack_unorm8_batch(from, packed, BENCHMARK_BATCH_COUNT);
+    const f64 pack_simd = platform_get_time() - start;
+
+    const f64 to_ns = 1e9 / BENCHMARK_BATCH_COUNT;
+    printf("\tTransform scalar: %.2f ns, batch: %.2f ns\n", transform_scalar * to_ns,
+           transform_simd * to_ns);
+    printf("\tLerp scalar: %.2f ns, batch: %.2f ns\n", lerp_scalar * to_ns, lerp_simd * to_ns);
+    printf("\tPack scalar: %.2f ns, batch: %.2f ns\n", pack_scalar * to_ns, pack_simd * to_ns);
+
+    free(packed);
+    free(out);
+    free(to);
+    free(from);
+}
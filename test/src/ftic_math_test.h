@@ -0,0 +1,9 @@
+#pragma once
+
+void ftic_math_test_begin();
+void ftic_math_test_end();
+void ftic_math_test_m4_multi();
+void ftic_math_test_v4_multi();
+void ftic_math_test_batches();
+void ftic_math_test_pack_unorm8();
+void ftic_math_test_benchmark_batches();
@@ -0,0 +1,253 @@
+#include "hash_table_test.h"
+#include "hash_table.h"
+#include "set.h"
+#include "hash.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define BENCHMARK_KEY_COUNT (1024 * 1024)
+
+void hash_table_test_begin()
+{
+    printf("Hash table tests:\n");
+}
+
+void hash_table_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+// Every key lands on the same home cell, so all of them share one probe run.
+internal u64 hash_constant(const void* key, u32 len, u64 seed)
+{
+    return 0;
+}
+
+internal u64 split_mix(u64* state)
+{
+    u64 z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void hash_table_test_insert_get_remove()
+{
+    HashTableUU64 table = hash_table_create_uu64(8, hash_u64);
+    for (u64 i = 0; i < 1000; ++i)
+    {
+        hash_table_insert_uu64(&table, i, i * 3);
+    }
+    hash_table_insert_uu64(&table, 10, 7);
+    ASSERT_EQUALS(1000, table.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(7, (u32)*hash_table_get_uu64(&table, 10), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(NULL, (void*)hash_table_get_uu64(&table, 1000), EQUALS_FORMAT_PTR);
+
+    for (u64 i = 0; i < 1000; i += 2)
+    {
+        CellUU64* removed = hash_table_remove_uu64(&table, i);
+        ASSERT_EQUALS((u32)i, (u32)removed->key, EQUALS_FORMAT_U32);
+    }
+    ASSERT_EQUALS(500, table.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(NULL, (void*)hash_table_remove_uu64(&table, 0), EQUALS_FORMAT_PTR);
+
+    u32 found = 0;
+    for (u64 i = 1; i < 1000; i += 2)
+    {
+        u64* value = hash_table_get_uu64(&table, i);
+        found += value && *value == i * 3;
+    }
+    ASSERT_EQUALS(500, found, EQUALS_FORMAT_U32);
+    hash_table_free_uu64(&table);
+}
+
+void hash_table_test_remove_keeps_probe_runs()
+{
+    HashTableUU64 table = hash_table_create_uu64(64, hash_constant);
+    for (u64 i = 0; i < 40; ++i)
+    {
+        hash_table_insert_uu64(&table, i, i);
+    }
+    for (u64 i = 5; i < 40; i += 3)
+    {
+        hash_table_remove_uu64(&table, i);
+    }
+
+    u32 found = 0;
+    u32 missing = 0;
+    for (u64 i = 0; i < 40; ++i)
+    {
+        const b8 removed = i >= 5 && (i - 5) % 3 == 0;
+        u64* value = hash_table_get_uu64(&table, i);
+        if (removed)
+        {
+            missing += value == NULL;
+        }
+        else
+        {
+            found += value && *value == i;
+        }
+    }
+    ASSERT_EQUALS(28, found, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(12, missing, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(28, table.size, EQUALS_FORMAT_U32);
+    hash_table_free_uu64(&table);
+}
+
+void hash_table_test_clear()
+{
+    HashTableGuid table = hash_table_create_guid(32, hash_guid);
+    FticGUID id = { 0 };
+    for (u8 i = 0; i < 100; ++i)
+    {
+        id.bytes[0] = i;
+        hash_table_insert_guid(&table, id, NULL);
+    }
+    hash_table_clear_guid(&table);
+    ASSERT_EQUALS(0, table.size, EQUALS_FORMAT_U32);
+    id.bytes[0] = 42;
+    ASSERT_EQUALS(NULL, (void*)hash_table_get_guid(&table, id), EQUALS_FORMAT_PTR);
+    hash_table_free_guid(&table);
+}
+
+void hash_table_test_set()
+{
+    SetU64 set = set_create_u64(8, hash_u64);
+    for (u64 i = 0; i < 300; ++i)
+    {
+        set_insert_u64(&set, i);
+        set_insert_u64(&set, i);
+    }
+    ASSERT_EQUALS(300, set.size, EQUALS_FORMAT_U32);
+    set_remove_u64(&set, 150);
+    ASSERT_EQUALS(false, set_contains_u64(&set, 150), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(true, set_contains_u64(&set, 151), EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(299, set.size, EQUALS_FORMAT_U32);
+    set_free_u64(&set);
+}
+
+internal void print_benchmark(const char* name, const f64 seconds)
+{
+    printf("\t%s: %.1f ns/op\n", name, (seconds * 1e9) / BENCHMARK_KEY_COUNT);
+}
+
+void hash_table_test_benchmark_u64()
+{
+    u64* keys = (u64*)malloc(BENCHMARK_KEY_COUNT * sizeof(u64));
+    u64* misses = (u64*)malloc(BENCHMARK_KEY_COUNT * sizeof(u64));
+    u64 state = 1;
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        // Odd keys are inserted, even keys are only looked up.
+        keys[i] = split_mix(&state) | 1;
+        misses[i] = keys[i] - 1;
+    }
+
+    HashTableUU64 table = hash_table_create_uu64(32, hash_u64);
+    f64 start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        hash_table_insert_uu64(&table, keys[i], i);
+    }
+    print_benchmark("u64 insert 1M", platform_get_time() - start);
+
+    u64 sum = 0;
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        sum += *hash_table_get_uu64(&table, keys[i]);
+    }
+    print_benchmark("u64 lookup hit", platform_get_time() - start);
+
+    u32 found = 0;
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        found += hash_table_get_uu64(&table, misses[i]) != NULL;
+    }
+    print_benchmark("u64 lookup miss", platform_get_time() - start);
+
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        hash_table_remove_uu64(&table, keys[i]);
+    }
+    print_benchmark("u64 erase", platform_get_time() - start);
+
+    ASSERT_EQUALS((u64)BENCHMARK_KEY_COUNT * (BENCHMARK_KEY_COUNT - 1) / 2, sum,
+                  EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(0, found, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, table.size, EQUALS_FORMAT_U32);
+
+    hash_table_free_uu64(&table);
+    free(keys);
+    free(misses);
+}
+
+void hash_table_test_benchmark_guid()
+{
+    FticGUID* keys = (FticGUID*)malloc(BENCHMARK_KEY_COUNT * sizeof(FticGUID));
+    FticGUID* misses = (FticGUID*)malloc(BENCHMARK_KEY_COUNT * sizeof(FticGUID));
+    u64 state = 7;
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        u64 halves[4] = { 0 };
+        for (u32 j = 0; j < static_array_size(halves); ++j)
+        {
+            halves[j] = split_mix(&state);
+        }
+        memcpy(keys[i].bytes, halves, sizeof(FticGUID));
+        memcpy(misses[i].bytes, halves + 2, sizeof(FticGUID));
+    }
+
+    HashTableGuid table = hash_table_create_guid(32, hash_guid);
+    f64 start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        hash_table_insert_guid(&table, keys[i], NULL);
+    }
+    print_benchmark("guid insert 1M", platform_get_time() - start);
+
+    u32 found = 0;
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        found += hash_table_get_guid(&table, keys[i]) != NULL;
+    }
+    print_benchmark("guid lookup hit", platform_get_time() - start);
+
+    u32 missed = 0;
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        missed += hash_table_get_guid(&table, misses[i]) == NULL;
+    }
+    print_benchmark("guid lookup miss", platform_get_time() - start);
+
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_KEY_COUNT; ++i)
+    {
+        hash_table_remove_guid(&table, keys[i]);
+    }
+    print_benchmark("guid erase", platform_get_time() - start);
+
+    ASSERT_EQUALS(BENCHMARK_KEY_COUNT, found, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(BENCHMARK_KEY_COUNT, missed, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, table.size, EQUALS_FORMAT_U32);
+
+    hash_table_free_guid(&table);
+    free(keys);
+    free(misses);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+void hash_table_test_begin();
+void hash_table_test_end();
+void hash_table_test_insert_get_remove();
+void hash_table_test_remove_keeps_probe_runs();
+void hash_table_test_clear();
+void hash_table_test_set();
+void hash_table_test_benchmark_u64();
+void hash_table_test_benchmark_guid();
@@ -1,9 +1,30 @@
 #include "ui_test.h"
 #include "collision_test.h"
+#include "file_operations_test.h"
+#include "folder_size_test.h"
+#include "hash_table_test.h"
+#include "containers_test.h"
+#include "profiler_test.h"
+#include "thread_queue_test.h"
+#include "ftic_math_test.h"
+#include "particle_system_test.h"
+#include "thumbnail_cache_test.h"
+#include "path_suggestions_test.h"
+#include "directory_cache_test.h"
+#include "sync_test.h"
+#include "content_search_test.h"
+#include "content_index_test.h"
 #include <stdio.h>
+#include <string.h>
 
 int main(int argc, char** argv)
 {
+    b8 run_benchmarks = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        run_benchmarks |= strcmp(argv[i], "--benchmarks") == 0;
+    }
+
     ui_test_begin();
     {
         ui_test_set_scroll_offset();
@@ -45,4 +66,153 @@ int main(int argc, char** argv)
         collision_test_aabb_equal();
     }
     collision_test_end();
+
+    file_operations_test_begin();
+    {
+        file_operations_test_progress();
+        file_operations_test_progress_paused();
+        file_operations_test_unique_destination_path();
+        file_operations_test_pause_returns_workers();
+        file_operations_test_permanent_delete();
+        file_operations_test_move();
+        file_operations_test_move_across_volumes();
+    }
+    file_operations_test_end();
+
+    folder_size_test_begin();
+    {
+        folder_size_test_recursive_size();
+    }
+    folder_size_test_end();
+
+    hash_table_test_begin();
+    {
+        hash_table_test_insert_get_remove();
+        hash_table_test_remove_keeps_probe_runs();
+        hash_table_test_clear();
+        hash_table_test_set();
+        if (run_benchmarks)
+        {
+            hash_table_test_benchmark_u64();
+            hash_table_test_benchmark_guid();
+        }
+    }
+    hash_table_test_end();
+
+    containers_test_begin();
+    {
+        containers_test_run();
+        if (run_benchmarks)
+        {
+            containers_test_run_benchmarks();
+        }
+    }
+    containers_test_end();
+
+    profiler_test_begin();
+    {
+        profiler_test_nesting();
+        profiler_test_disabled();
+        profiler_test_export_chrome_trace();
+        if (run_benchmarks)
+        {
+            profiler_test_benchmark_scope();
+        }
+    }
+    profiler_test_end();
+
+    thread_queue_test_begin();
+    {
+        thread_queue_test_telemetry();
+        thread_queue_test_drops();
+        thread_queue_test_task_count();
+        thread_queue_test_histogram();
+        thread_queue_test_channel();
+        thread_queue_test_channel_producers();
+    }
+    thread_queue_test_end();
+
+    sync_test_begin();
+    {
+        sync_test_mutex_try_lock();
+        sync_test_mutex_counter();
+        sync_test_condition_ping_pong();
+        sync_test_event_count();
+    }
+    sync_test_end();
+
+    content_search_test_begin();
+    {
+        content_search_test_matcher_limits();
+        content_search_test_find_matches_naive();
+        content_search_test_lines();
+        content_search_test_files();
+        content_search_test_file_blocks();
+    }
+    content_search_test_end();
+
+    content_index_test_begin();
+    {
+        content_index_test_query();
+        content_index_test_incremental();
+        content_index_test_matches_scan();
+        content_index_test_service();
+        content_index_test_service_full_queue();
+    }
+    content_index_test_end();
+
+    ftic_math_test_begin();
+    {
+        ftic_math_test_m4_multi();
+        ftic_math_test_v4_multi();
+        ftic_math_test_batches();
+        ftic_math_test_pack_unorm8();
+        if (run_benchmarks)
+        {
+            ftic_math_test_benchmark_batches();
+        }
+    }
+    ftic_math_test_end();
+
+    particle_system_test_begin();
+    {
+        particle_system_test_update_matches_scalar();
+        particle_system_test_remove_dead();
+        particle_system_test_write_quads();
+        if (run_benchmarks)
+        {
+            particle_system_test_benchmark_update();
+        }
+    }
+    particle_system_test_end();
+
+    thumbnail_cache_test_begin();
+    {
+        thumbnail_cache_test_round_trip();
+        thumbnail_cache_test_key();
+        thumbnail_cache_test_rejects_bad_files();
+    }
+    thumbnail_cache_test_end();
+
+    path_suggestions_test_begin();
+    {
+        path_suggestions_test_prefix();
+        path_suggestions_test_fuzzy();
+        path_suggestions_test_matches_linear_scan();
+        if (run_benchmarks)
+        {
+            path_suggestions_test_benchmark_query();
+        }
+    }
+    path_suggestions_test_end();
+
+    directory_cache_test_begin();
+    {
+        directory_cache_test_shared_listing();
+        directory_cache_test_invalidate();
+        directory_cache_test_evict_unused();
+        directory_cache_test_sorted_merge();
+        directory_cache_test_deferred_merge();
+    }
+    directory_cache_test_end();
 }
@@ -0,0 +1,192 @@
+#include "particle_system_test.h"
+#include "particle_system.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define PARTICLE_TEST_COUNT 1001
+#define BENCHMARK_PARTICLE_COUNT 100000
+#define BENCHMARK_FRAME_COUNT 100
+
+void particle_system_test_begin()
+{
+    printf("Particle system tests:\n");
+}
+
+void particle_system_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal f32 random_f32_between(f32 low, f32 high)
+{
+    return low + ((f32)rand() / (f32)RAND_MAX) * (high - low);
+}
+
+internal void emit_random(ParticleBuffer* buffer, u32 count)
+{
+    for (u32 i = 0; i < count; ++i)
+    {
+        Particle particle = {
+            .position = v2f(random_f32_between(0.0f, 1000.0f), random_f32_between(0.0f, 1000.0f)),
+            .velocity = v2f(random_f32_between(-20.0f, 20.0f), random_f32_between(-20.0f, 20.0f)),
+            .acceleration = v2f(random_f32_between(-5.0f, 5.0f), random_f32_between(-5.0f, 5.0f)),
+            .dimension = v2i(random_f32_between(2.0f, 4.0f)),
+            .life = random_f32_between(0.1f, 0.8f),
+            .color = v4f(0.2f, 0.4f, 0.6f, 1.0f),
+            .size_change = (i % 2) == 0,
+            .alpha_change = (i % 3) == 0,
+        };
+        particle_buffer_emit(buffer, &particle);
+    }
+}
+
+void particle_system_test_update_matches_scalar()
+{
+    ParticleBuffer simd = { 0 };
+    ParticleBuffer scalar = { 0 };
+    particle_buffer_create(&simd, PARTICLE_TEST_COUNT);
+    particle_buffer_create(&scalar, PARTICLE_TEST_COUNT);
+    srand(1);
+    emit_random(&simd, PARTICLE_TEST_COUNT);
+    srand(1);
+    emit_random(&scalar, PARTICLE_TEST_COUNT);
+
+    for (u32 frame = 0; frame < 20; ++frame)
+    {
+        particle_buffer_update(&simd, 0.016);
+        particle_buffer_update_scalar(&scalar, 0.016);
+    }
+    ASSERT_EQUALS(scalar.size, simd.size, EQUALS_FORMAT_U32);
+    for (u32 i = 0; i < min(simd.size, scalar.size); ++i)
+    {
+        ASSERT_EQUALS_WITHIN(scalar.position_x[i], simd.position_x[i], 0.001f,
+                             EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(scalar.position_y[i], simd.position_y[i], 0.001f,
+                             EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(scalar.width[i], simd.width[i], 0.001f, EQUALS_FORMAT_FLOAT);
+        ASSERT_EQUALS_WITHIN(scalar.alpha[i], simd.alpha[i], 0.001f, EQUALS_FORMAT_FLOAT);
+    }
+    particle_buffer_free(&scalar);
+    particle_buffer_free(&simd);
+}
+
+void particle_system_test_remove_dead()
+{
+    ParticleBuffer buffer = { 0 };
+    particle_buffer_create(&buffer, 8);
+    Particle particle = { .life = 1.0f, .dimension = v2i(4.0f), .size_change = true };
+    particle_buffer_emit(&buffer, &particle);
+    particle.life = 0.1f;
+    particle_buffer_emit(&buffer, &particle);
+    particle.life = 2.0f;
+    particle_buffer_emit(&buffer, &particle);
+    ASSERT_EQUALS(3, buffer.size, EQUALS_FORMAT_U32);
+
+    // Dead particles are removed on the update after they reached zero.
+    particle_buffer_update(&buffer, 0.5);
+    ASSERT_EQUALS(3, buffer.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS_WITHIN(2.0f, buffer.width[0], 0.001f, EQUALS_FORMAT_FLOAT);
+    particle_buffer_update(&buffer, 0.1);
+    ASSERT_EQUALS(2, buffer.size, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(2, buffer.index, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS_WITHIN(1.4f, buffer.life[1], 0.001f, EQUALS_FORMAT_FLOAT);
+
+    // A full buffer overwrites instead of growing.
+    for (u32 i = 0; i < 20; ++i)
+    {
+        particle_buffer_emit(&buffer, &particle);
+    }
+    ASSERT_EQUALS(buffer.capacity, buffer.size, EQUALS_FORMAT_U32);
+    particle_buffer_free(&buffer);
+}
+
+void particle_system_test_write_quads()
+{
+    ParticleBuffer buffer = { 0 };
+    particle_buffer_create(&buffer, 4);
+    Particle particle = {
+        .position = v2f(10.2f, 20.7f),
+        .dimension = v2f(3.0f, 5.0f),
+        .life = 1.0f,
+        .color = v4f(1.0f, 0.0f, 1.0f, 0.5f),
+        .alpha_change = true,
+    };
+    particle_buffer_emit(&buffer, &particle);
+
+    QuadInstance quad = { 0 };
+    particle_buffer_write_quads(&buffer, 3.0f, &quad);
+    ASSERT_EQUALS(10.0f, quad.position.x, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(21.0f, quad.position.y, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(3.0f, quad.edge_x.x, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(5.0f, quad.edge_y.y, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(3.0f, quad.texture_index, EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(0x80FF00FF, quad.colors[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(quad.colors[0], quad.colors[3], EQUALS_FORMAT_U32);
+
+    particle_buffer_update(&buffer, 0.75);
+    particle_buffer_write_quads(&buffer, 3.0f, &quad);
+    ASSERT_EQUALS(0x40FF00FF, quad.colors[0], EQUALS_FORMAT_U32);
+    particle_buffer_free(&buffer);
+}
+
+internal void benchmark_update(b8 simd, QuadInstance* quads, f64* update_ns, f64* write_ns)
+{
+    ParticleBuffer buffer = { 0 };
+    particle_buffer_create(&buffer, BENCHMARK_PARTICLE_COUNT);
+    srand(2);
+    emit_random(&buffer, BENCHMARK_PARTICLE_COUNT);
+    for (u32 i = 0; i < buffer.size; ++i)
+    {
+        // Long enough that nothing dies during the benchmark.
+        buffer.life[i] = buffer.life_time[i] = 100.0f;
+    }
+
+    f64 update_seconds = 0.0;
+    f64 write_seconds = 0.0;
+    for (u32 frame = 0; frame < BENCHMARK_FRAME_COUNT; ++frame)
+    {
+        f64 start = platform_get_time();
+        if (simd)
+        {
+            particle_buffer_update(&buffer, 0.016);
+        }
+        else
+        {
+            particle_buffer_update_scalar(&buffer, 0.016);
+        }
+        update_seconds += platform_get_time() - start;
+
+        start = platform_get_time();
+        particle_buffer_write_quads(&buffer, 1.0f, quads);
+        write_seconds += platform_get_time() - start;
+    }
+    particle_buffer_free(&buffer);
+
+    const f64 to_ns = 1e9 / ((f64)BENCHMARK_PARTICLE_COUNT * BENCHMARK_FRAME_COUNT);
+    *update_ns = update_seconds * to_ns;
+    *write_ns = write_seconds * to_ns;
+}
+
+void particle_system_test_benchmark_update()
+{
+    QuadInstance* quads = (QuadInstance*)malloc(BENCHMARK_PARTICLE_COUNT * sizeof(QuadInstance));
+    f64 scalar_update = 0.0;
+    f64 simd_update = 0.0;
+    f64 write = 0.0;
+    benchmark_update(false, quads, &scalar_update, &write);
+    benchmark_update(true, quads, &simd_update, &write);
+    printf("\tUpdate per particle, scalar: %.2f ns, simd: %.2f ns\n", scalar_update, simd_update);
+    printf("\tInstance write per particle: %.2f ns\n", write);
+    free(quads);
+}
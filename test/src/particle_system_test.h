@@ -0,0 +1,8 @@
+#pragma once
+
+void particle_system_test_begin();
+void particle_system_test_end();
+void particle_system_test_update_matches_scalar();
+void particle_system_test_remove_dead();
+void particle_system_test_write_quads();
+void particle_system_test_benchmark_update();
@@ -0,0 +1,213 @@
+#include "path_suggestions_test.h"
+#include "path_suggestions.h"
+#include "util.h"
+#include "asserts.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_PARENT "C:\\test\\"
+#define BENCHMARK_ENTRY_COUNT 10000
+#define BENCHMARK_QUERY_COUNT 2000
+
+void path_suggestions_test_begin()
+{
+    printf("Path suggestions tests:\n");
+}
+
+void path_suggestions_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal PathSuggestionSnapshot* make_snapshot(const char** names, const u32 name_count)
+{
+    DirectoryItemArray items = { 0 };
+    array_create(&items, name_count);
+    const u32 parent_length = (u32)strlen(TEST_PARENT);
+    for (u32 i = 0; i < name_count; ++i)
+    {
+        const u32 name_length = (u32)strlen(names[i]);
+        DirectoryItem item = { 0 };
+        item.path = string_copy(TEST_PARENT, parent_length, name_length);
+        memcpy(item.path + parent_length, names[i], name_length);
+        item.name_offset = (u16)parent_length;
+        array_push(&items, item);
+    }
+    return path_suggestion_snapshot_create(&items);
+}
+
+internal const char* result_name(const PathSuggestionSnapshot* snapshot, const u32* result,
+                                 const u32 index)
+{
+    return item_namec(snapshot->items.data + result[index]);
+}
+
+global const char* g_names[] = {
+    "Documents", "Downloads", "Desktop", "Music", "docs", "Dropbox", "Pictures", "Videos",
+};
+
+void path_suggestions_test_prefix()
+{
+    PathSuggestionSnapshot* snapshot = make_snapshot(g_names, static_array_size(g_names));
+    u32 result[6] = { 0 };
+
+    // Shorter names first, then in name order.
+    u32 count = path_suggestion_snapshot_query(snapshot, "Do", result, 3);
+    ASSERT_EQUALS(3, count, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 0), "docs") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 1), "Documents") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 2), "Downloads") == 0);
+
+    count = path_suggestion_snapshot_query(snapshot, "MUS", result, 6);
+    ASSERT_EQUALS(1, count, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 0), "Music") == 0);
+
+    // Nothing typed lists the children in order.
+    count = path_suggestion_snapshot_query(snapshot, "", result, 6);
+    ASSERT_EQUALS(6, count, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 0), "Desktop") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 5), "Music") == 0);
+
+    count = path_suggestion_snapshot_query(snapshot, "xyz", result, 6);
+    ASSERT_EQUALS(0, count, EQUALS_FORMAT_U32);
+
+    path_suggestion_snapshot_free(snapshot);
+}
+
+void path_suggestions_test_fuzzy()
+{
+    PathSuggestionSnapshot* snapshot = make_snapshot(g_names, static_array_size(g_names));
+    u32 result[6] = { 0 };
+
+    // The prefix matches come first, the rest is filled with names that have
+    // the characters in order, fewest skipped characters first and then the
+    // earliest first match.
+    const u32 count = path_suggestion_snapshot_query(snapshot, "do", result, 6);
+    ASSERT_EQUALS(6, count, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 0), "docs") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 3), "Dropbox") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 4), "Videos") == 0);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 5), "Desktop") == 0);
+
+    const u32 only_fuzzy = path_suggestion_snapshot_query(snapshot, "pcs", result, 6);
+    ASSERT_EQUALS(1, only_fuzzy, EQUALS_FORMAT_U32);
+    ASSERT_TRUE(strcmp(result_name(snapshot, result, 0), "Pictures") == 0);
+
+    path_suggestion_snapshot_free(snapshot);
+}
+
+internal char* random_name(char* buffer, const u32 buffer_size)
+{
+    // A small alphabet so the names share long prefixes and the trie splits.
+    const u32 length = 1 + rand() % (buffer_size - 2);
+    for (u32 i = 0; i < length; ++i)
+    {
+        buffer[i] = "abcAB"[rand() % 5];
+    }
+    buffer[length] = '\0';
+    return buffer;
+}
+
+internal b8 has_prefix_case_insensitive(const char* name, const char* prefix)
+{
+    for (; *prefix; ++name, ++prefix)
+    {
+        if (tolower((unsigned char)*name) != tolower((unsigned char)*prefix))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void path_suggestions_test_matches_linear_scan()
+{
+    srand(5);
+    const u32 name_count = 500;
+    char** names = (char**)calloc(name_count, sizeof(char*));
+    char buffer[10] = { 0 };
+    for (u32 i = 0; i < name_count; ++i)
+    {
+        names[i] = string_copy_d(random_name(buffer, sizeof(buffer)));
+    }
+    PathSuggestionSnapshot* snapshot = make_snapshot((const char**)names, name_count);
+    u32* result = (u32*)calloc(name_count, sizeof(u32));
+
+    u32 failed = 0;
+    for (u32 query = 0; query < 200; ++query)
+    {
+        char prefix[5] = { 0 };
+        random_name(prefix, sizeof(prefix));
+
+        u32 expected = 0;
+        for (u32 i = 0; i < name_count; ++i)
+        {
+            expected += has_prefix_case_insensitive(names[i], prefix);
+        }
+        const u32 count = path_suggestion_snapshot_query(snapshot, prefix, result, name_count);
+        for (u32 i = 0; i < expected && i < count; ++i)
+        {
+            failed += !has_prefix_case_insensitive(result_name(snapshot, result, i), prefix);
+        }
+        failed += count < expected;
+    }
+    ASSERT_EQUALS(0, failed, EQUALS_FORMAT_U32);
+
+    free(result);
+    path_suggestion_snapshot_free(snapshot);
+    for (u32 i = 0; i < name_count; ++i)
+    {
+        free(names[i]);
+    }
+    free(names);
+}
+
+void path_suggestions_test_benchmark_query()
+{
+    srand(7);
+    char** names = (char**)calloc(BENCHMARK_ENTRY_COUNT, sizeof(char*));
+    char buffer[24] = { 0 };
+    for (u32 i = 0; i < BENCHMARK_ENTRY_COUNT; ++i)
+    {
+        const u32 length = 4 + rand() % 16;
+        for (u32 j = 0; j < length; ++j)
+        {
+            buffer[j] = (char)('a' + rand() % 26);
+        }
+        buffer[length] = '\0';
+        names[i] = string_copy_d(buffer);
+    }
+
+    f64 start = platform_get_time();
+    PathSuggestionSnapshot* snapshot =
+        make_snapshot((const char**)names, BENCHMARK_ENTRY_COUNT);
+    const f64 build_ms = (platform_get_time() - start) * 1000.0;
+
+    u32 result[6] = { 0 };
+    start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i)
+    {
+        char query[3] = { names[i][0], names[i][1], '\0' };
+        path_suggestion_snapshot_query(snapshot, query, result, 6);
+    }
+    const f64 query_us = (platform_get_time() - start) * 1e6 / BENCHMARK_QUERY_COUNT;
+    printf("\t%u entries, build: %.2f ms, query: %.2f us\n", BENCHMARK_ENTRY_COUNT, build_ms,
+           query_us);
+
+    path_suggestion_snapshot_free(snapshot);
+    for (u32 i = 0; i < BENCHMARK_ENTRY_COUNT; ++i)
+    {
+        free(names[i]);
+    }
+    free(names);
+}
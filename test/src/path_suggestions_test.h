@@ -0,0 +1,8 @@
+#pragma once
+
+void path_suggestions_test_begin();
+void path_suggestions_test_end();
+void path_suggestions_test_prefix();
+void path_suggestions_test_fuzzy();
+void path_suggestions_test_matches_linear_scan();
+void path_suggestions_test_benchmark_query();
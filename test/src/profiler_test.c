@@ -0,0 +1,160 @@
+#include "profiler_test.h"
+#include "profiler.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define BENCHMARK_SCOPE_COUNT 1000000
+
+void profiler_test_begin()
+{
+    printf("Profiler tests:\n");
+}
+
+void profiler_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void collect_all(ProfileEventArray* events)
+{
+    events->size = 0;
+    profiler_collect(0, UINT64_MAX, events);
+}
+
+void profiler_test_nesting()
+{
+    profiler_initialize();
+    profiler_set_enabled(true);
+
+    profile_begin("outer");
+    profile_begin("inner");
+    profile_end();
+    profile_begin("inner");
+    profile_end();
+    profile_end();
+
+    ProfileEventArray events = { 0 };
+    array_create(&events, 8);
+    collect_all(&events);
+    ASSERT_EQUALS(3, events.size, EQUALS_FORMAT_U32);
+    if (events.size == 3)
+    {
+        // Events are written when they end, so the children come first.
+        ASSERT_EQUALS(1, (u32)events.data[0].depth, EQUALS_FORMAT_U32);
+        ASSERT_EQUALS(1, (u32)events.data[1].depth, EQUALS_FORMAT_U32);
+        ASSERT_EQUALS(0, (u32)events.data[2].depth, EQUALS_FORMAT_U32);
+        ASSERT_EQUALS(0, strcmp(events.data[2].name, "outer"), EQUALS_FORMAT_I32);
+        ASSERT_TRUE(events.data[2].start <= events.data[0].start);
+        ASSERT_TRUE(events.data[2].end >= events.data[1].end);
+        ASSERT_EQUALS(0, (u32)events.data[2].thread, EQUALS_FORMAT_U32);
+    }
+
+    // An unmatched end is ignored.
+    profile_end();
+    collect_all(&events);
+    ASSERT_EQUALS(3, events.size, EQUALS_FORMAT_U32);
+
+    array_free(&events);
+    profiler_uninitialize();
+}
+
+void profiler_test_disabled()
+{
+    profiler_initialize();
+
+    profile_begin("skipped");
+    profiler_set_enabled(true);
+    profile_begin("recorded");
+    profile_end();
+    // Closes nothing, skipped was never opened.
+    profile_end();
+    profiler_set_enabled(false);
+    profile_begin("skipped");
+    profile_end();
+
+    ProfileEventArray events = { 0 };
+    array_create(&events, 8);
+    collect_all(&events);
+    ASSERT_EQUALS(1, events.size, EQUALS_FORMAT_U32);
+    if (events.size == 1)
+    {
+        ASSERT_EQUALS(0, strcmp(events.data[0].name, "recorded"), EQUALS_FORMAT_I32);
+    }
+
+    array_free(&events);
+    profiler_uninitialize();
+}
+
+void profiler_test_export_chrome_trace()
+{
+    const char* path = "profiler_test_trace.json";
+    profiler_initialize();
+    profiler_set_enabled(true);
+    profiler_frame_begin();
+    profile_begin("frame \"quoted\"");
+    platform_sleep(1);
+    profile_end();
+    profiler_frame_end();
+
+    ASSERT_TRUE(profiler_export_chrome_trace(path));
+
+    char buffer[1024] = { 0 };
+    FILE* file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    if (file)
+    {
+        fread(buffer, 1, sizeof(buffer) - 1, file);
+        fclose(file);
+    }
+    ASSERT_EQUALS(0, strncmp(buffer, "{\"traceEvents\":[", 16), EQUALS_FORMAT_I32);
+    ASSERT_TRUE(strstr(buffer, "\"name\":\"frame \\\"quoted\\\"\",\"ph\":\"X\"") != NULL);
+    ASSERT_TRUE(strstr(buffer, "\"thread_name\"") != NULL);
+    ASSERT_TRUE(strstr(buffer, "]}") != NULL);
+
+    ProfileFrame frame = { 0 };
+    ASSERT_TRUE(profiler_get_frame(0, &frame));
+    ASSERT_FALSE(profiler_get_frame(1, &frame));
+    ASSERT_TRUE(profiler_ticks_to_ms(frame.end - frame.start) >= 0.5);
+
+    remove(path);
+    profiler_uninitialize();
+}
+
+void profiler_test_benchmark_scope()
+{
+    profiler_initialize();
+    profiler_set_enabled(true);
+
+    const f64 start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_SCOPE_COUNT; ++i)
+    {
+        profile_begin("benchmark");
+        profile_end();
+    }
+    const f64 enabled_seconds = platform_get_time() - start;
+
+    profiler_set_enabled(false);
+    const f64 disabled_start = platform_get_time();
+    for (u32 i = 0; i < BENCHMARK_SCOPE_COUNT; ++i)
+    {
+        profile_begin("benchmark");
+        profile_end();
+    }
+    const f64 disabled_seconds = platform_get_time() - disabled_start;
+
+    printf("\tScope enabled: %.1f ns, disabled: %.1f ns\n",
+           (enabled_seconds * 1e9) / BENCHMARK_SCOPE_COUNT,
+           (disabled_seconds * 1e9) / BENCHMARK_SCOPE_COUNT);
+    profiler_uninitialize();
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+void profiler_test_begin();
+void profiler_test_end();
+void profiler_test_nesting();
+void profiler_test_disabled();
+void profiler_test_export_chrome_trace();
+void profiler_test_benchmark_scope();
@@ -0,0 +1,203 @@
+#include "sync_test.h"
+#include "sync.h"
+#include "thread_queue.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+
+global u32 g_total_test_failed_count = 0;
+
+void sync_test_begin()
+{
+    printf("Sync tests:\n");
+}
+
+void sync_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+void sync_test_mutex_try_lock()
+{
+    SyncMutex mutex = { 0 };
+    ASSERT_TRUE(sync_mutex_try_lock(&mutex));
+    ASSERT_TRUE(!sync_mutex_try_lock(&mutex));
+    sync_mutex_unlock(&mutex);
+    ASSERT_TRUE(sync_mutex_try_lock(&mutex));
+    sync_mutex_unlock(&mutex);
+}
+
+#define SYNC_TEST_THREAD_COUNT 4
+#define SYNC_TEST_INCREMENTS 100000
+
+typedef struct SyncTestCounter
+{
+    SyncMutex mutex;
+    u64 value; // Only touched with the mutex held
+    FTicAtomic done;
+} SyncTestCounter;
+
+internal THREAD_TASK_ENTRY_POINT(increment_task)
+{
+    SyncTestCounter* counter = (SyncTestCounter*)data;
+    for (u32 i = 0; i < SYNC_TEST_INCREMENTS; ++i)
+    {
+        sync_mutex_lock(&counter->mutex);
+        counter->value++;
+        sync_mutex_unlock(&counter->mutex);
+    }
+    ftic_atomic_add(&counter->done, 1);
+}
+
+internal void wait_for_done(FTicAtomic* done, const long expected)
+{
+    const f64 start = platform_get_time();
+    while (ftic_atomic_load(done) < expected && platform_get_time() - start < 10.0)
+    {
+        platform_sleep(1);
+    }
+}
+
+void sync_test_mutex_counter()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(16, SYNC_TEST_THREAD_COUNT, &queue);
+
+    SyncTestCounter counter = { 0 };
+    ThreadTask tasks[SYNC_TEST_THREAD_COUNT] = { 0 };
+    for (u32 i = 0; i < SYNC_TEST_THREAD_COUNT; ++i)
+    {
+        tasks[i] = thread_task(increment_task, &counter);
+    }
+    thread_tasks_push(&queue.task_queue, tasks, SYNC_TEST_THREAD_COUNT, NULL);
+    wait_for_done(&counter.done, SYNC_TEST_THREAD_COUNT);
+
+    sync_mutex_lock(&counter.mutex);
+    ASSERT_EQUALS((u64)SYNC_TEST_THREAD_COUNT * SYNC_TEST_INCREMENTS, counter.value,
+                  EQUALS_FORMAT_U64);
+    sync_mutex_unlock(&counter.mutex);
+    threads_uninitialize(&queue);
+}
+
+#define SYNC_TEST_ROUNDS 2000
+
+typedef struct SyncTestPingPong
+{
+    SyncMutex mutex;
+    SyncCondition changed;
+    u32 turn; // Only touched with the mutex held
+    u32 rounds[2];
+    FTicAtomic done;
+} SyncTestPingPong;
+
+typedef struct SyncTestPlayer
+{
+    SyncTestPingPong* game;
+    u32 player;
+} SyncTestPlayer;
+
+internal THREAD_TASK_ENTRY_POINT(ping_pong_task)
+{
+    SyncTestPlayer* player = (SyncTestPlayer*)data;
+    SyncTestPingPong* game = player->game;
+    for (u32 i = 0; i < SYNC_TEST_ROUNDS; ++i)
+    {
+        sync_mutex_lock(&game->mutex);
+        while (game->turn != player->player)
+        {
+            sync_condition_wait(&game->changed, &game->mutex);
+        }
+        game->rounds[player->player]++;
+        game->turn = !player->player;
+        sync_condition_broadcast(&game->changed);
+        sync_mutex_unlock(&game->mutex);
+    }
+    ftic_atomic_add(&game->done, 1);
+}
+
+void sync_test_condition_ping_pong()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(4, 2, &queue);
+
+    SyncTestPingPong game = { 0 };
+    SyncTestPlayer players[2] = { { &game, 0 }, { &game, 1 } };
+    ThreadTask tasks[2] = {
+        thread_task(ping_pong_task, players + 0),
+        thread_task(ping_pong_task, players + 1),
+    };
+    thread_tasks_push(&queue.task_queue, tasks, 2, NULL);
+    wait_for_done(&game.done, 2);
+
+    sync_mutex_lock(&game.mutex);
+    ASSERT_EQUALS(SYNC_TEST_ROUNDS, game.rounds[0], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(SYNC_TEST_ROUNDS, game.rounds[1], EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, game.turn, EQUALS_FORMAT_U32);
+    sync_mutex_unlock(&game.mutex);
+    threads_uninitialize(&queue);
+}
+
+typedef struct SyncTestMailbox
+{
+    SyncEventCount event_count;
+    FTicAtomic value;
+    FTicAtomic received;
+} SyncTestMailbox;
+
+// Waits for every value from 1 to SYNC_TEST_ROUNDS, the sender only moves on
+// once the previous one has been seen.
+internal THREAD_TASK_ENTRY_POINT(receive_task)
+{
+    SyncTestMailbox* mailbox = (SyncTestMailbox*)data;
+    for (long expected = 1; expected <= SYNC_TEST_ROUNDS; ++expected)
+    {
+        for (;;)
+        {
+            const u32 key = sync_event_count_prepare_wait(&mailbox->event_count);
+            if (ftic_atomic_load(&mailbox->value) >= expected)
+            {
+                sync_event_count_cancel_wait(&mailbox->event_count);
+                break;
+            }
+            sync_event_count_wait(&mailbox->event_count, key);
+        }
+        ftic_atomic_store(&mailbox->received, expected);
+        sync_event_count_notify(&mailbox->event_count);
+    }
+}
+
+void sync_test_event_count()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(4, 1, &queue);
+
+    SyncTestMailbox mailbox = { 0 };
+    ThreadTask task = thread_task(receive_task, &mailbox);
+    thread_tasks_push(&queue.task_queue, &task, 1, NULL);
+
+    for (long value = 1; value <= SYNC_TEST_ROUNDS; ++value)
+    {
+        ftic_atomic_store(&mailbox.value, value);
+        sync_event_count_notify(&mailbox.event_count);
+        for (;;)
+        {
+            const u32 key = sync_event_count_prepare_wait(&mailbox.event_count);
+            if (ftic_atomic_load(&mailbox.received) == value)
+            {
+                sync_event_count_cancel_wait(&mailbox.event_count);
+                break;
+            }
+            sync_event_count_wait(&mailbox.event_count, key);
+        }
+    }
+    ASSERT_EQUALS(SYNC_TEST_ROUNDS, ftic_atomic_load(&mailbox.received),
+                  "Expected: %d, Actual: %ld\n");
+    threads_uninitialize(&queue);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+void sync_test_begin();
+void sync_test_end();
+void sync_test_mutex_try_lock();
+void sync_test_mutex_counter();
+void sync_test_condition_ping_pong();
+void sync_test_event_count();
@@ -0,0 +1,261 @@
+#include "thread_queue_test.h"
+#include "thread_queue.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+void thread_queue_test_begin()
+{
+    printf("Thread queue tests:\n");
+}
+
+void thread_queue_test_end()
+{
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal THREAD_TASK_ENTRY_POINT(sleeping_task)
+{
+    platform_sleep(2);
+}
+
+internal THREAD_TASK_ENTRY_POINT(counting_task)
+{
+    ftic_atomic_add((FTicAtomic*)data, 1);
+}
+
+internal void wait_for_completed(ThreadTaskQueue* task_queue, const long expected)
+{
+    const f64 start = platform_get_time();
+    while (task_queue->telemetry.completed < expected && platform_get_time() - start < 10.0)
+    {
+        platform_sleep(1);
+    }
+}
+
+void thread_queue_test_telemetry()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(100, 2, &queue);
+
+    FTicAtomic counter = 0;
+    ThreadTask tasks[8] = { 0 };
+    for (u32 i = 0; i < 4; ++i)
+    {
+        tasks[i] = thread_task(sleeping_task, NULL);
+        tasks[i + 4] = thread_task(counting_task, (void*)&counter);
+    }
+    thread_tasks_push(&queue.task_queue, tasks, static_array_size(tasks), NULL);
+    wait_for_completed(&queue.task_queue, 8);
+
+    const ThreadTelemetry* telemetry = &queue.task_queue.telemetry;
+    ASSERT_EQUALS(8, telemetry->pushed, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(8, telemetry->completed, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(4, counter, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(2, telemetry->kind_count, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(0, strcmp(telemetry->kinds[0].name, "sleeping_task"), EQUALS_FORMAT_I32);
+    ASSERT_EQUALS(0, strcmp(telemetry->kinds[1].name, "counting_task"), EQUALS_FORMAT_I32);
+    ASSERT_EQUALS(4, telemetry->kinds[0].run.count, "Expected: %d, Actual: %ld\n");
+    // Two workers and four sleeping tasks, so some of them had to wait.
+    ASSERT_TRUE(telemetry->kinds[0].run.max_us >= 1000);
+    ASSERT_TRUE(telemetry->wait.max_us >= 1000);
+
+    long tasks_run = 0;
+    for (u32 i = 0; i < telemetry->worker_count; ++i)
+    {
+        tasks_run += telemetry->workers[i].tasks_run;
+    }
+    ASSERT_EQUALS(8, tasks_run, "Expected: %d, Actual: %ld\n");
+
+    thread_telemetry_reset(&queue.task_queue);
+    ASSERT_EQUALS(0, telemetry->completed, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(0, telemetry->kinds[0].run.count, "Expected: %d, Actual: %ld\n");
+    ASSERT_EQUALS(2, telemetry->kind_count, "Expected: %d, Actual: %ld\n");
+
+    threads_uninitialize(&queue);
+}
+
+void thread_queue_test_drops()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(4, 1, &queue);
+
+    ThreadTask tasks[16] = { 0 };
+    for (u32 i = 0; i < static_array_size(tasks); ++i)
+    {
+        tasks[i] = thread_task(sleeping_task, NULL);
+    }
+    const u32 pushed =
+        thread_tasks_push(&queue.task_queue, tasks, static_array_size(tasks), NULL);
+
+    const ThreadTelemetry* telemetry = &queue.task_queue.telemetry;
+    ASSERT_TRUE(telemetry->dropped > 0);
+    ASSERT_EQUALS((long)pushed, telemetry->pushed, "Expected: %ld, Actual: %ld\n");
+    ASSERT_EQUALS(16, telemetry->pushed + telemetry->dropped, "Expected: %d, Actual: %ld\n");
+    ASSERT_TRUE(telemetry->max_depth <= 4);
+    wait_for_completed(&queue.task_queue, telemetry->pushed);
+    ASSERT_EQUALS(telemetry->pushed, telemetry->completed, "Expected: %ld, Actual: %ld\n");
+
+    threads_uninitialize(&queue);
+}
+
+void thread_queue_test_task_count()
+{
+    // No workers, so everything pushed stays queued.
+    ThreadQueue queue = { 0 };
+    thread_initialize(16, 0, &queue);
+
+    ThreadTask tasks[5] = { 0 };
+    for (u32 i = 0; i < static_array_size(tasks); ++i)
+    {
+        tasks[i] = thread_task(sleeping_task, NULL);
+        tasks[i].id = i % 2;
+    }
+    thread_tasks_push(&queue.task_queue, tasks, static_array_size(tasks), NULL);
+
+    ASSERT_EQUALS(3ULL, thread_get_task_count(&queue.task_queue, 0), EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(2ULL, thread_get_task_count(&queue.task_queue, 1), EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(0ULL, thread_get_task_count(&queue.task_queue, 7), EQUALS_FORMAT_U64);
+    ASSERT_EQUALS(5, thread_get_queue_depth(&queue.task_queue), EQUALS_FORMAT_U32);
+
+    threads_uninitialize(&queue);
+}
+
+void thread_queue_test_histogram()
+{
+    ThreadHistogram histogram = { 0 };
+    // Bucket i counts samples below 2^i us.
+    histogram.buckets[0] = 10;
+    histogram.buckets[4] = 80;
+    histogram.buckets[10] = 10;
+    histogram.count = 100;
+    histogram.total_us = 10 * 0 + 80 * 10 + 10 * 1000;
+    histogram.max_us = 1000;
+
+    ASSERT_EQUALS(16.0, thread_histogram_percentile_us(&histogram, 0.5), EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(1024.0, thread_histogram_percentile_us(&histogram, 0.95), EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(1.0, thread_histogram_percentile_us(&histogram, 0.05), EQUALS_FORMAT_FLOAT);
+    ASSERT_EQUALS(108.0, thread_histogram_mean_us(&histogram), EQUALS_FORMAT_FLOAT);
+}
+
+global FTicAtomic freed_elements = 0;
+
+internal void count_freed_element(void* element)
+{
+    ftic_atomic_add(&freed_elements, 1);
+}
+
+void thread_queue_test_channel()
+{
+    ThreadChannel* channel = thread_channel_create(sizeof(u32), 6, count_freed_element);
+    ASSERT_EQUALS(8, channel->capacity, EQUALS_FORMAT_U32);
+
+    // Several laps around the ring, pushed and drained in uneven batches.
+    u32 values[5] = { 0 };
+    u32 drained[8] = { 0 };
+    u32 next_value = 0;
+    u32 next_expected = 0;
+    b8 in_order = true;
+    for (u32 lap = 0; lap < 10; ++lap)
+    {
+        const u32 push_count = 3 + lap % 3;
+        for (u32 i = 0; i < push_count; ++i)
+        {
+            values[i] = next_value++;
+        }
+        ASSERT_TRUE(thread_channel_push(channel, values, push_count));
+        const u32 count = thread_channel_drain(channel, drained, static_array_size(drained));
+        for (u32 i = 0; i < count; ++i)
+        {
+            in_order &= drained[i] == next_expected++;
+        }
+    }
+    ASSERT_TRUE(in_order);
+    ASSERT_EQUALS(next_value, next_expected, EQUALS_FORMAT_U32);
+    ASSERT_EQUALS(0, thread_channel_drain(channel, drained, 8), EQUALS_FORMAT_U32);
+
+    // What is left when the last reference goes is freed.
+    ASSERT_TRUE(thread_channel_push(channel, values, 3));
+    thread_channel_close(channel);
+    ASSERT_TRUE(!thread_channel_push(channel, values, 1));
+    thread_channel_release(channel);
+    ASSERT_EQUALS(3, freed_elements, "Expected: %d, Actual: %ld\n");
+}
+
+#define CHANNEL_PRODUCER_COUNT 4
+#define CHANNEL_VALUES_PER_PRODUCER 20000
+
+typedef struct ChannelProducer
+{
+    ThreadChannel* channel;
+    u32 producer;
+} ChannelProducer;
+
+internal THREAD_TASK_ENTRY_POINT(channel_producer_task)
+{
+    ChannelProducer* producer = (ChannelProducer*)data;
+    u32 batch[7] = { 0 };
+    for (u32 i = 0; i < CHANNEL_VALUES_PER_PRODUCER;)
+    {
+        const u32 count = ftic_min(1 + i % 7, CHANNEL_VALUES_PER_PRODUCER - i);
+        for (u32 j = 0; j < count; ++j, ++i)
+        {
+            batch[j] = (producer->producer << 24) | i;
+        }
+        thread_channel_push(producer->channel, batch, count);
+    }
+    thread_channel_release(producer->channel);
+}
+
+void thread_queue_test_channel_producers()
+{
+    ThreadQueue queue = { 0 };
+    thread_initialize(16, CHANNEL_PRODUCER_COUNT, &queue);
+
+    // Small enough that the producers keep running into a full ring.
+    ThreadChannel* channel = thread_channel_create(sizeof(u32), 64, NULL);
+    ChannelProducer producers[CHANNEL_PRODUCER_COUNT] = { 0 };
+    ThreadTask tasks[CHANNEL_PRODUCER_COUNT] = { 0 };
+    for (u32 i = 0; i < CHANNEL_PRODUCER_COUNT; ++i)
+    {
+        producers[i] = (ChannelProducer){ .channel = channel, .producer = i };
+        thread_channel_retain(channel);
+        tasks[i] = thread_task(channel_producer_task, producers + i);
+    }
+    thread_tasks_push(&queue.task_queue, tasks, CHANNEL_PRODUCER_COUNT, NULL);
+
+    // Every producer's values arrive in the order it pushed them.
+    u32 next[CHANNEL_PRODUCER_COUNT] = { 0 };
+    u32 total = 0;
+    b8 in_order = true;
+    u32 drained[32] = { 0 };
+    const f64 start = platform_get_time();
+    while (total < CHANNEL_PRODUCER_COUNT * CHANNEL_VALUES_PER_PRODUCER &&
+           platform_get_time() - start < 10.0)
+    {
+        const u32 count = thread_channel_drain(channel, drained, static_array_size(drained));
+        for (u32 i = 0; i < count; ++i)
+        {
+            const u32 producer = drained[i] >> 24;
+            in_order &= producer < CHANNEL_PRODUCER_COUNT &&
+                        (drained[i] & 0xffffff) == next[producer]++;
+        }
+        total += count;
+    }
+    ASSERT_TRUE(in_order);
+    ASSERT_EQUALS(CHANNEL_PRODUCER_COUNT * CHANNEL_VALUES_PER_PRODUCER, total, EQUALS_FORMAT_U32);
+
+    wait_for_completed(&queue.task_queue, CHANNEL_PRODUCER_COUNT);
+    thread_channel_release(channel);
+    threads_uninitialize(&queue);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+void thread_queue_test_begin();
+void thread_queue_test_end();
+void thread_queue_test_telemetry();
+void thread_queue_test_drops();
+void thread_queue_test_task_count();
+void thread_queue_test_histogram();
+void thread_queue_test_channel();
+void thread_queue_test_channel_producers();
@@ -0,0 +1,141 @@
+#include "thumbnail_cache_test.h"
+#include "thumbnail_cache.h"
+#include "platform/platform.h"
+#include "asserts.h"
+#include <stdio.h>
+#include <string.h>
+
+global u32 g_total_test_failed_count = 0;
+
+#define TEST_DIRECTORY "thumbnail_cache_test"
+#define TEST_SIZE 64
+
+void thumbnail_cache_test_begin()
+{
+    printf("Thumbnail cache tests:\n");
+    platform_create_directory(TEST_DIRECTORY);
+    thumbnail_cache_initialize(TEST_DIRECTORY);
+}
+
+void thumbnail_cache_test_end()
+{
+    platform_remove_directory(TEST_DIRECTORY);
+    if (g_total_test_failed_count)
+    {
+        printf("\tTotal failed tests: %u\n", g_total_test_failed_count);
+    }
+    else
+    {
+        printf("\tNo failed tests\n");
+    }
+}
+
+internal void cache_file_path(const u64 key, char* buffer, const u32 buffer_size)
+{
+    sysprintf(buffer, buffer_size, "%s/%016llx.thumb", TEST_DIRECTORY, (unsigned long long)key);
+}
+
+internal TextureProperties make_thumbnail()
+{
+    // A background with a block in the middle, like a rendered mesh.
+    TextureProperties texture_properties = {
+        .width = TEST_SIZE,
+        .height = TEST_SIZE,
+        .channels = 4,
+        .bytes = (u8*)malloc(TEST_SIZE * TEST_SIZE * 4),
+    };
+    u32* pixels = (u32*)texture_properties.bytes;
+    for (u32 y = 0; y < TEST_SIZE; ++y)
+    {
+        for (u32 x = 0; x < TEST_SIZE; ++x)
+        {
+            const b8 inside = x >= 16 && x < 48 && y >= 16 && y < 48;
+            pixels[y * TEST_SIZE + x] = inside ? (0xFF000000 | (x << 8) | y) : 0xFF202020;
+        }
+    }
+    return texture_properties;
+}
+
+void thumbnail_cache_test_round_trip()
+{
+    const u64 key = thumbnail_cache_key("C:\\models\\teapot.obj", 1234, 5678);
+    TextureProperties saved = make_thumbnail();
+    ASSERT_TRUE(thumbnail_cache_save(key, &saved));
+
+    TextureProperties loaded = { 0 };
+    ASSERT_TRUE(thumbnail_cache_load(key, &loaded));
+    ASSERT_EQUALS(TEST_SIZE, loaded.width, EQUALS_FORMAT_I32);
+    ASSERT_EQUALS(TEST_SIZE, loaded.height, EQUALS_FORMAT_I32);
+    if (loaded.bytes)
+    {
+        ASSERT_EQUALS(0, memcmp(saved.bytes, loaded.bytes, TEST_SIZE * TEST_SIZE * 4),
+                      EQUALS_FORMAT_I32);
+    }
+
+    char path[FTIC_MAX_PATH] = { 0 };
+    cache_file_path(key, path, sizeof(path));
+    // The background compresses, the file is much smaller than the pixels.
+    ASSERT_TRUE(platform_get_file_size(path) < (TEST_SIZE * TEST_SIZE * 4) / 2);
+    platform_delete_file(path);
+
+    free(loaded.bytes);
+    free(saved.bytes);
+}
+
+void thumbnail_cache_test_key()
+{
+    const u64 key = thumbnail_cache_key("C:\\models\\teapot.obj", 1234, 5678);
+    ASSERT_EQUALS(key, thumbnail_cache_key("C:\\models\\teapot.obj", 1234, 5678),
+                  EQUALS_FORMAT_U64);
+    ASSERT_TRUE(key != thumbnail_cache_key("C:\\models\\teapot.obj", 1235, 5678));
+    ASSERT_TRUE(key != thumbnail_cache_key("C:\\models\\teapot.obj", 1234, 5679));
+    ASSERT_TRUE(key != thumbnail_cache_key("C:\\models\\teapots.obj", 1234, 5678));
+
+    TextureProperties missing = { 0 };
+    ASSERT_TRUE(!thumbnail_cache_load(key + 1, &missing));
+}
+
+void thumbnail_cache_test_rejects_bad_files()
+{
+    const u64 key = thumbnail_cache_key("C:\\models\\cube.obj", 1, 2);
+    TextureProperties saved = make_thumbnail();
+    thumbnail_cache_save(key, &saved);
+
+    char path[FTIC_MAX_PATH] = { 0 };
+    cache_file_path(key, path, sizeof(path));
+    const u64 size = platform_get_file_size(path);
+
+    // Cut in half, as if the save was interrupted.
+    FILE* file = fopen(path, "rb");
+    u8* bytes = (u8*)malloc(size);
+    if (file)
+    {
+        fread(bytes, 1, size, file);
+        fclose(file);
+    }
+    file = fopen(path, "wb");
+    if (file)
+    {
+        fwrite(bytes, 1, size / 2, file);
+        fclose(file);
+    }
+    TextureProperties loaded = { 0 };
+    ASSERT_TRUE(!thumbnail_cache_load(key, &loaded));
+
+    // A file saved under another key is not accepted either.
+    const u64 other_key = thumbnail_cache_key("C:\\models\\sphere.obj", 1, 2);
+    char other_path[FTIC_MAX_PATH] = { 0 };
+    cache_file_path(other_key, other_path, sizeof(other_path));
+    file = fopen(other_path, "wb");
+    if (file)
+    {
+        fwrite(bytes, 1, size, file);
+        fclose(file);
+    }
+    ASSERT_TRUE(!thumbnail_cache_load(other_key, &loaded));
+
+    platform_delete_file(other_path);
+    platform_delete_file(path);
+    free(bytes);
+    free(saved.bytes);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+void thumbnail_cache_test_begin();
+void thumbnail_cache_test_end();
+void thumbnail_cache_test_round_trip();
+void thumbnail_cache_test_key();
+void thumbnail_cache_test_rejects_bad_files();
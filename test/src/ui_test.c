@@ -1456,7 +1456,7 @@ void ui_test_check_dock_space_resize()
     array_free(&ui_context.window_hover_clicked_indices);
     array_free(&ui_context.render.vertices);
     array_free(&ui_context.animation_x);
-    free(ui_context.particles.data);
+    particle_buffer_free(&ui_context.particles);
 }
 
 void ui_test_sync_current_frame_windows()